@@ -101,3 +101,9 @@ if (ENABLE_ASAN)
 
     add_compile_flags("C;CXX" -fsanitize=address -fsanitize-blacklist=${CMAKE_SOURCE_DIR}/asan/asan.supp)
 endif()
+
+option(ENABLE_HEAP_AUDIT "Enable counting of heap allocations made inside allocation-budgeted scopes, see lib/core/heap_audit.h (requires a GNU-compatible linker)" OFF)
+if (ENABLE_HEAP_AUDIT)
+    set(CMAKE_EXE_LINKER_FLAGS
+        "${CMAKE_EXE_LINKER_FLAGS} -Wl,--wrap=malloc -Wl,--wrap=calloc -Wl,--wrap=realloc")
+endif()
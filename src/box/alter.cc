@@ -4423,6 +4423,8 @@ on_alter_sequence_rollback(struct trigger *trigger, void * /* event */)
 	assert(seq != NULL);
 	free(seq->def);
 	seq->def = def;
+	/* The preallocated range follows the old definition. */
+	seq->cache_count = 0;
 	if (trigger_run(&on_alter_sequence, seq) != 0)
 		return -1;
 	return 0;
@@ -4520,6 +4522,8 @@ on_replace_dd_sequence(struct trigger * /* trigger */, void *event)
 		if (on_commit == NULL || on_rollback == NULL)
 			return -1;
 		seq->def = new_def;
+		/* The preallocated range follows the old definition. */
+		seq->cache_count = 0;
 		txn_stmt_on_commit(stmt, on_commit);
 		txn_stmt_on_rollback(stmt, on_rollback);
 	}
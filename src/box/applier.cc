@@ -153,6 +153,7 @@ applier_writer_f(va_list ap)
 	struct applier *applier = va_arg(ap, struct applier *);
 	struct ev_io io;
 	coio_create(&io, applier->io.fd);
+	double last_ack_time = 0;
 
 	while (!fiber_is_cancelled()) {
 		/*
@@ -167,6 +168,17 @@ applier_writer_f(va_list ap)
 			else
 				fiber_cond_wait_timeout(&applier->writer_cond,
 							replication_timeout);
+		} else if (replication_ack_period > 0) {
+			/*
+			 * Pace the sends so that a burst of applied
+			 * transactions is confirmed with a single
+			 * cumulative vclock message instead of one
+			 * message per transaction.
+			 */
+			double elapsed = ev_monotonic_now(loop()) -
+					 last_ack_time;
+			if (elapsed < replication_ack_period)
+				fiber_sleep(replication_ack_period - elapsed);
 		}
 		/*
 		 * A writer fiber is going to be awaken after a commit or
@@ -185,6 +197,7 @@ applier_writer_f(va_list ap)
 			struct xrow_header xrow;
 			xrow_encode_vclock(&xrow, &replicaset.vclock);
 			coio_write_xrow(&io, &xrow);
+			last_ack_time = ev_monotonic_now(loop());
 			ERROR_INJECT(ERRINJ_APPLIER_SLOW_ACK, {
 				fiber_sleep(0.01);
 			});
@@ -620,7 +633,7 @@ struct applier_tx_row {
 };
 
 static struct applier_tx_row *
-applier_read_tx_row(struct applier *applier)
+applier_read_tx_row(struct applier *applier, double timeout)
 {
 	struct ev_io *coio = &applier->io;
 	struct ibuf *ibuf = &applier->ibuf;
@@ -633,7 +646,6 @@ applier_read_tx_row(struct applier *applier)
 
 	struct xrow_header *row = &tx_row->row;
 
-	double timeout = replication_disconnect_timeout();
 	/*
 	 * Tarantool < 1.7.7 does not send periodic heartbeat
 	 * messages so we can't assume that if we haven't heard
@@ -644,9 +656,6 @@ applier_read_tx_row(struct applier *applier)
 		coio_read_xrow(coio, ibuf, row);
 	else
 		coio_read_xrow_timeout_xc(coio, ibuf, row, timeout);
-
-	applier->lag = ev_now(loop()) - row->tm;
-	applier->last_row_time = ev_monotonic_now(loop());
 	return tx_row;
 }
 
@@ -661,11 +670,14 @@ static void
 applier_read_tx(struct applier *applier, struct stailq *rows)
 {
 	int64_t tsn = 0;
+	double timeout = replication_disconnect_timeout();
+	struct xrow_header *row = NULL;
 
 	stailq_create(rows);
 	do {
-		struct applier_tx_row *tx_row = applier_read_tx_row(applier);
-		struct xrow_header *row = &tx_row->row;
+		struct applier_tx_row *tx_row =
+			applier_read_tx_row(applier, timeout);
+		row = &tx_row->row;
 
 		if (iproto_type_is_error(row->type))
 			xrow_decode_error_xc(row);
@@ -722,6 +734,14 @@ applier_read_tx(struct applier *applier, struct stailq *rows)
 
 	} while (!stailq_last_entry(rows, struct applier_tx_row,
 				    next)->row.is_commit);
+
+	/*
+	 * Update replication lag once per transaction rather than
+	 * on every row - the intermediate values are overwritten
+	 * anyway and the clock reads add up on wide transactions.
+	 */
+	applier->lag = ev_now(loop()) - row->tm;
+	applier->last_row_time = ev_monotonic_now(loop());
 }
 
 static void
@@ -1125,7 +1145,9 @@ applier_subscribe(struct applier *applier)
 	 */
 	uint32_t id_filter = box_is_orphan() ? 0 : 1 << instance_id;
 	xrow_encode_subscribe_xc(&row, &REPLICASET_UUID, &INSTANCE_UUID,
-				 &vclock, replication_anon, id_filter);
+				 &vclock, replication_anon, id_filter,
+				 replication_space_filter,
+				 replication_space_filter_count);
 	coio_write_xrow(coio, &row);
 
 	/* Read SUBSCRIBE response */
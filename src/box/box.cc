@@ -39,6 +39,7 @@
 #include "identifier.h"
 #include "iproto.h"
 #include "iproto_constants.h"
+#include "clock.h"
 #include "recovery.h"
 #include "wal.h"
 #include "relay.h"
@@ -56,6 +57,7 @@
 #include "blackhole.h"
 #include "service_engine.h"
 #include "vinyl.h"
+#include "vy_run.h"
 #include "space.h"
 #include "index.h"
 #include "port.h"
@@ -64,6 +66,7 @@
 #include "user.h"
 #include "cfg.h"
 #include "coio.h"
+#include "cpu_pin.h"
 #include "replication.h" /* replica */
 #include "title.h"
 #include "xrow.h"
@@ -78,6 +81,7 @@
 #include "crash.h"
 #include "func.h"
 #include "sequence.h"
+#include "assoc.h"
 #include "sql_stmt_cache.h"
 #include "msgpack.h"
 #include "raft.h"
@@ -521,6 +525,63 @@ box_check_replication_timeout(void)
 	return timeout;
 }
 
+static double
+box_check_replication_ack_period(void)
+{
+	double period = cfg_getd("replication_ack_period");
+	if (period < 0) {
+		tnt_raise(ClientError, ER_CFG, "replication_ack_period",
+			  "the value must be greater or equal to 0");
+	}
+	return period;
+}
+
+static void
+box_check_replication_space_filter(void)
+{
+	int count = cfg_getarr_size("replication_space_filter");
+	for (int i = 0; i < count; i++) {
+		const char *str = cfg_getarr_elem("replication_space_filter",
+						  i);
+		char *end;
+		long long id = strtoll(str, &end, 10);
+		if (*end != '\0' || id <= BOX_SYSTEM_ID_MAX ||
+		    id > BOX_SPACE_MAX) {
+			tnt_raise(ClientError, ER_CFG,
+				  "replication_space_filter",
+				  "the value must be a list of "
+				  "non-system space ids");
+		}
+	}
+}
+
+/**
+ * Rebuild the replication space filter from the configuration.
+ * The new value is sent to masters on (re)subscribe, it does not
+ * affect already established subscriptions.
+ */
+static void
+box_set_replication_space_filter(void)
+{
+	int count = cfg_getarr_size("replication_space_filter");
+	uint32_t *filter = NULL;
+	if (count > 0) {
+		filter = (uint32_t *)calloc(count, sizeof(*filter));
+		if (filter == NULL) {
+			tnt_raise(OutOfMemory, count * sizeof(*filter),
+				  "malloc", "space filter");
+		}
+		for (int i = 0; i < count; i++) {
+			filter[i] = strtoll(cfg_getarr_elem(
+					"replication_space_filter", i),
+					NULL, 10);
+		}
+	}
+	free(replication_space_filter);
+	replication_space_filter = filter;
+	replication_space_filter_count = count;
+}
+
 static double
 box_check_replication_connect_timeout(void)
 {
@@ -838,6 +899,17 @@ box_check_vinyl_options(void)
 	}
 }
 
+static void
+box_check_iproto_threads(int iproto_threads)
+{
+	if (iproto_threads < 1 || iproto_threads > IPROTO_THREADS_MAX) {
+		tnt_raise(ClientError, ER_CFG, "iproto_threads",
+			  tt_sprintf("must be greater than or equal to 1"
+				     " and less than or equal to %d",
+				     IPROTO_THREADS_MAX));
+	}
+}
+
 static int
 box_check_sql_cache_size(int size)
 {
@@ -863,6 +935,8 @@ box_check_config(void)
 		diag_raise();
 	box_check_replication();
 	box_check_replication_timeout();
+	box_check_replication_ack_period();
+	box_check_replication_space_filter();
 	box_check_replication_connect_timeout();
 	box_check_replication_connect_quorum();
 	box_check_replication_sync_lag();
@@ -879,6 +953,7 @@ box_check_config(void)
 		diag_raise();
 	box_check_memtx_min_tuple_size(cfg_geti64("memtx_min_tuple_size"));
 	box_check_vinyl_options();
+	box_check_iproto_threads(cfg_geti("iproto_threads"));
 	if (box_check_sql_cache_size(cfg_geti("sql_cache_size")) != 0)
 		diag_raise();
 }
@@ -991,6 +1066,12 @@ box_set_replication_timeout(void)
 	raft_cfg_death_timeout(box_raft(), replication_disconnect_timeout());
 }
 
+void
+box_set_replication_ack_period(void)
+{
+	replication_ack_period = box_check_replication_ack_period();
+}
+
 void
 box_set_replication_connect_timeout(void)
 {
@@ -1349,6 +1430,29 @@ box_set_snap_io_rate_limit(void)
 			cfg_getd("snap_io_rate_limit"));
 }
 
+void
+box_set_snap_io_backoff_latency(void)
+{
+	struct memtx_engine *memtx;
+	memtx = (struct memtx_engine *)engine_by_name("memtx");
+	assert(memtx != NULL);
+	memtx_engine_set_snap_io_backoff_latency(memtx,
+			cfg_getd("snap_io_backoff_latency"));
+}
+
+void
+box_set_checkpoint_threads(void)
+{
+	int threads = cfg_geti("checkpoint_threads");
+	if (threads < 1)
+		tnt_raise(ClientError, ER_CFG, "checkpoint_threads",
+			  "the value must not be less than one");
+	struct memtx_engine *memtx;
+	memtx = (struct memtx_engine *)engine_by_name("memtx");
+	assert(memtx != NULL);
+	memtx_engine_set_checkpoint_threads(memtx, threads);
+}
+
 void
 box_set_memtx_memory(void)
 {
@@ -1371,6 +1475,16 @@ box_set_memtx_max_tuple_size(void)
 			cfg_geti("memtx_max_tuple_size"));
 }
 
+void
+box_set_memtx_compaction(void)
+{
+	struct memtx_engine *memtx;
+	memtx = (struct memtx_engine *)engine_by_name("memtx");
+	assert(memtx != NULL);
+	memtx_engine_set_compaction(memtx,
+			cfg_geti("memtx_compaction") != 0);
+}
+
 void
 box_set_too_long_threshold(void)
 {
@@ -1411,6 +1525,47 @@ box_set_checkpoint_wal_threshold(void)
 	wal_set_checkpoint_threshold(threshold);
 }
 
+void
+box_set_checkpoint_min_wal_size(void)
+{
+	int64_t size = cfg_geti64("checkpoint_min_wal_size");
+	if (size < 0) {
+		tnt_raise(ClientError, ER_CFG, "checkpoint_min_wal_size",
+			  "the value must not be negative");
+	}
+	gc_set_checkpoint_min_wal_size(size);
+}
+
+void
+box_set_gc_unlink_rate(void)
+{
+	int rate = cfg_geti("gc_unlink_rate");
+	if (rate < 0) {
+		tnt_raise(ClientError, ER_CFG, "gc_unlink_rate",
+			  "the value must not be negative");
+	}
+	gc_set_unlink_rate(rate);
+}
+
+void
+box_set_wal_sync_size(void)
+{
+	int64_t size = cfg_geti64("wal_sync_size");
+	if (size <= 0) {
+		tnt_raise(ClientError, ER_CFG, "wal_sync_size",
+			  "the value must be greater than 0");
+	}
+	wal_set_sync_size(size);
+}
+
+void
+box_set_wal_hiccup_threshold(void)
+{
+	double threshold = cfg_getd("wal_hiccup_threshold");
+	wal_set_hiccup_threshold(threshold);
+	vy_run_hiccup_threshold = threshold;
+}
+
 void
 box_set_vinyl_memory(void)
 {
@@ -1457,6 +1612,24 @@ box_set_net_msg_max(void)
 				IPROTO_FIBER_POOL_SIZE_FACTOR);
 }
 
+void
+box_set_net_flush_interval(void)
+{
+	iproto_set_flush_interval(cfg_getd("net_flush_interval"));
+}
+
+void
+box_set_net_class_msg_max(void)
+{
+	iproto_set_class_msg_max(cfg_geti("net_class_msg_max"));
+}
+
+void
+box_set_net_zerocopy(void)
+{
+	iproto_set_zerocopy(cfg_geti("net_zerocopy") != 0);
+}
+
 int
 box_set_prepared_stmt_cache_size(void)
 {
@@ -1561,6 +1734,18 @@ box_return_mp(box_function_ctx_t *ctx, const char *mp, const char *mp_end)
 	return port_c_add_mp(ctx->port, mp, mp_end);
 }
 
+API_EXPORT char *
+box_return_mp_reserve(box_function_ctx_t *ctx, size_t size)
+{
+	return port_c_reserve_mp(ctx->port, size);
+}
+
+API_EXPORT int
+box_return_mp_commit(box_function_ctx_t *ctx, size_t size)
+{
+	return port_c_commit_mp(ctx->port, size);
+}
+
 /* schema_find_id()-like method using only public API */
 API_EXPORT uint32_t
 box_space_id_by_name(const char *name, uint32_t len)
@@ -1648,13 +1833,20 @@ box_process1(struct request *request, box_tuple_t **result)
 }
 
 API_EXPORT int
-box_select(uint32_t space_id, uint32_t index_id,
-	   int iterator, uint32_t offset, uint32_t limit,
-	   const char *key, const char *key_end,
-	   struct port *port)
+box_select_after(uint32_t space_id, uint32_t index_id,
+		 int iterator, uint32_t offset, uint32_t limit,
+		 const char *key, const char *key_end,
+		 const char *after_pos, uint32_t after_pos_size,
+		 bool fetch_pos, const char **pos, uint32_t *pos_size,
+		 struct port *port)
 {
 	(void)key_end;
 
+	if (fetch_pos) {
+		*pos = NULL;
+		*pos_size = 0;
+	}
+
 	rmean_collect(rmean_box, IPROTO_SELECT, 1);
 
 	if (iterator < 0 || iterator >= iterator_type_MAX) {
@@ -1694,15 +1886,25 @@ box_select(uint32_t space_id, uint32_t index_id,
 		txn_rollback_stmt(txn);
 		return -1;
 	}
+	if (after_pos != NULL &&
+	    iterator_position_restore(it, after_pos, after_pos_size) != 0) {
+		iterator_delete(it);
+		txn_rollback_stmt(txn);
+		return -1;
+	}
 
 	int rc = 0;
 	uint32_t found = 0;
 	struct tuple *tuple;
+	bool has_expire = space_has_expire(space);
+	double now = has_expire ? fiber_time() : 0;
 	port_c_create(port);
 	while (found < limit) {
 		rc = iterator_next(it, &tuple);
 		if (rc != 0 || tuple == NULL)
 			break;
+		if (has_expire && space_tuple_is_expired(space, tuple, now))
+			continue;
 		if (offset > 0) {
 			offset--;
 			continue;
@@ -1712,6 +1914,13 @@ box_select(uint32_t space_id, uint32_t index_id,
 			break;
 		found++;
 	}
+	/*
+	 * The position of the last returned tuple is saved while
+	 * the iterator is still alive. If the scan is exhausted
+	 * *pos stays NULL: there is nothing to continue from.
+	 */
+	if (rc == 0 && fetch_pos)
+		rc = iterator_position(it, pos, pos_size);
 	iterator_delete(it);
 
 	if (rc != 0) {
@@ -1723,6 +1932,17 @@ box_select(uint32_t space_id, uint32_t index_id,
 	return 0;
 }
 
+API_EXPORT int
+box_select(uint32_t space_id, uint32_t index_id,
+	   int iterator, uint32_t offset, uint32_t limit,
+	   const char *key, const char *key_end,
+	   struct port *port)
+{
+	return box_select_after(space_id, index_id, iterator, offset, limit,
+				key, key_end, NULL, 0, false, NULL, NULL,
+				port);
+}
+
 API_EXPORT int
 box_insert(uint32_t space_id, const char *tuple, const char *tuple_end,
 	   box_tuple_t **result)
@@ -1913,11 +2133,38 @@ box_sequence_next(uint32_t seq_id, int64_t *result)
 		return -1;
 	if (access_check_sequence(seq) != 0)
 		return -1;
-	int64_t value;
-	if (sequence_next(seq, &value) != 0)
+	/* Serve from the preallocated range, if any. */
+	if (seq->cache_count > 0) {
+		*result = seq->cache_value;
+		/*
+		 * The last value of a range cut at the min/max
+		 * boundary may sit right at INT64_MIN/INT64_MAX,
+		 * so stepping past it would overflow. Advance
+		 * only while there is something left to serve.
+		 */
+		if (--seq->cache_count > 0)
+			seq->cache_value += seq->def->step;
+		return 0;
+	}
+	int64_t count = seq->def->cache > 1 ? seq->def->cache : 1;
+	int64_t value, last, issued;
+	if (sequence_next_batch(seq, count, &value, &last, &issued) != 0)
 		return -1;
-	if (sequence_data_update(seq_id, value) != 0)
+	if (sequence_data_update(seq_id, last) != 0)
 		return -1;
+	/*
+	 * The replace into _sequence_data fires a trigger that
+	 * calls sequence_set() and hence discards the range, so
+	 * set it up only once the replace has succeeded. Recovery
+	 * and replicas replay the same row and thus start past
+	 * the whole range - preallocated values are never issued
+	 * twice, though skipping some of them on restart is
+	 * possible, just like with plain SQL sequence caching.
+	 */
+	if (issued > 1) {
+		seq->cache_value = value + seq->def->step;
+		seq->cache_count = issued - 1;
+	}
 	*result = value;
 	return 0;
 }
@@ -2334,8 +2581,14 @@ box_process_subscribe(struct ev_io *io, struct xrow_header *header)
 	vclock_create(&replica_clock);
 	bool anon;
 	uint32_t id_filter;
+	uint32_t *space_filter = NULL;
+	uint32_t space_filter_count = 0;
 	xrow_decode_subscribe_xc(header, NULL, &replica_uuid, &replica_clock,
-				 &replica_version_id, &anon, &id_filter);
+				 &replica_version_id, &anon, &id_filter,
+				 &space_filter, &space_filter_count);
+	auto space_filter_guard = make_scoped_guard([=] {
+		free(space_filter);
+	});
 
 	/* Forbid connection to itself */
 	if (tt_uuid_is_equal(&replica_uuid, &INSTANCE_UUID))
@@ -2464,7 +2717,8 @@ box_process_subscribe(struct ev_io *io, struct xrow_header *header)
 	 * indefinitely).
 	 */
 	relay_subscribe(replica, io->fd, header->sync, &replica_clock,
-			replica_version_id, id_filter);
+			replica_version_id, id_filter, space_filter,
+			space_filter_count);
 }
 
 void
@@ -2541,6 +2795,7 @@ engine_init()
 				    cfg_getd("memtx_memory"),
 				    cfg_geti("memtx_min_tuple_size"),
 				    cfg_geti("strip_core"),
+				    cfg_geti("memtx_use_hugepages"),
 				    cfg_getd("slab_alloc_factor"));
 	engine_register((struct engine *)memtx);
 	box_set_memtx_max_tuple_size();
@@ -2901,6 +3156,272 @@ on_wal_checkpoint_threshold(void)
 	gc_trigger_checkpoint();
 }
 
+/* {{{ TTL purge */
+
+enum {
+	/** Max tuples scanned per space per purge iteration. */
+	TTL_PURGE_SCAN_BATCH = 1000,
+	/** Max expired tuples deleted per space per iteration. */
+	TTL_PURGE_DELETE_BATCH = 100,
+};
+
+/** Interval between TTL purge wakeups, in seconds. */
+static const double TTL_PURGE_INTERVAL = 1.0;
+
+static struct fiber *ttl_purge_fiber = NULL;
+
+/** Saved scan position of one TTL space, see ttl_purge_pos. */
+struct ttl_purge_cursor {
+	/** Size of the packed primary key, in bytes. */
+	uint32_t key_size;
+	/** Primary key of the last scanned tuple, an MP_ARRAY. */
+	char key[0];
+};
+
+/**
+ * Maps a space id to the malloc'ed struct ttl_purge_cursor of
+ * the last purge scan, so that successive wakeups continue
+ * deeper into the primary index via ITER_GT instead of
+ * rescanning the same head tuples: with a scan budget per
+ * wakeup, restarting from the first tuple every time would
+ * never reach expired tuples hiding behind a long alive prefix.
+ * A cursor is dropped when the scan wraps around, the space
+ * loses its TTL field or the saved key no longer matches the
+ * primary key definition.
+ */
+static struct mh_i32ptr_t *ttl_purge_pos = NULL;
+
+/** Forget the saved scan position of a space, if any. */
+static void
+ttl_purge_pos_forget(uint32_t space_id)
+{
+	if (ttl_purge_pos == NULL)
+		return;
+	mh_int_t k = mh_i32ptr_find(ttl_purge_pos, space_id, NULL);
+	if (k != mh_end(ttl_purge_pos)) {
+		free(mh_i32ptr_node(ttl_purge_pos, k)->val);
+		mh_i32ptr_del(ttl_purge_pos, k, NULL);
+	}
+}
+
+/**
+ * Save the primary key of the last scanned tuple so that the
+ * next wakeup continues right after it. Best-effort: on OOM the
+ * next scan simply restarts from the head.
+ */
+static void
+ttl_purge_pos_save(uint32_t space_id, struct tuple *tuple,
+		   struct key_def *key_def)
+{
+	uint32_t key_size;
+	char *key = tuple_extract_key(tuple, key_def, MULTIKEY_NONE,
+				      &key_size);
+	if (key == NULL) {
+		diag_log();
+		return;
+	}
+	struct ttl_purge_cursor *cur = (struct ttl_purge_cursor *)
+		malloc(sizeof(*cur) + key_size);
+	if (cur == NULL)
+		return;
+	cur->key_size = key_size;
+	memcpy(cur->key, key, key_size);
+	ttl_purge_pos_forget(space_id);
+	if (ttl_purge_pos == NULL)
+		ttl_purge_pos = mh_i32ptr_new();
+	struct mh_i32ptr_node_t node = { space_id, cur };
+	if (mh_i32ptr_put(ttl_purge_pos, &node, NULL, NULL) ==
+	    mh_end(ttl_purge_pos))
+		free(cur);
+}
+
+/**
+ * Look up the saved scan position of a space and check that it
+ * is still a valid key of the current primary index - the space
+ * id may have been reused or the key definition altered since
+ * the position was saved. An invalid position is dropped.
+ * Returns the number of key parts and sets *key, or 0 with
+ * *key == NULL to scan from the head.
+ */
+static uint32_t
+ttl_purge_pos_find(uint32_t space_id, struct index *pk, const char **key)
+{
+	*key = NULL;
+	if (ttl_purge_pos == NULL)
+		return 0;
+	mh_int_t k = mh_i32ptr_find(ttl_purge_pos, space_id, NULL);
+	if (k == mh_end(ttl_purge_pos))
+		return 0;
+	struct ttl_purge_cursor *cur = (struct ttl_purge_cursor *)
+		mh_i32ptr_node(ttl_purge_pos, k)->val;
+	const char *pos = cur->key;
+	uint32_t part_count = mp_decode_array(&pos);
+	const char *pos_end;
+	if (part_count != pk->def->key_def->part_count ||
+	    key_validate_parts(pk->def->key_def, pos, part_count, false,
+			       &pos_end) != 0) {
+		diag_clear(diag_get());
+		ttl_purge_pos_forget(space_id);
+		return 0;
+	}
+	*key = pos;
+	return part_count;
+}
+
+struct ttl_space_ids {
+	/** Ids of spaces that have an expiration field. */
+	uint32_t *ids;
+	uint32_t count;
+};
+
+static int
+ttl_purge_count_cb(struct space *space, void *udata)
+{
+	uint32_t *count = (uint32_t *)udata;
+	if (space_has_expire(space))
+		(*count)++;
+	return 0;
+}
+
+static int
+ttl_purge_collect_cb(struct space *space, void *udata)
+{
+	struct ttl_space_ids *set = (struct ttl_space_ids *)udata;
+	if (space_has_expire(space))
+		set->ids[set->count++] = space_id(space);
+	return 0;
+}
+
+/**
+ * Delete a batch of expired tuples from a TTL space. Keys are
+ * extracted before the first yield, because the deletions go
+ * through WAL and the scanned tuples may be freed while the
+ * fiber waits for it.
+ */
+static void
+ttl_purge_space(uint32_t space_id)
+{
+	struct space *space = space_by_id(space_id);
+	if (space == NULL || !space_has_expire(space)) {
+		ttl_purge_pos_forget(space_id);
+		return;
+	}
+	struct index *pk = space_index(space, 0);
+	if (pk == NULL) {
+		ttl_purge_pos_forget(space_id);
+		return;
+	}
+	struct txn *txn;
+	struct txn_ro_savepoint svp;
+	if (txn_begin_ro_stmt(space, &txn, &svp) != 0) {
+		diag_log();
+		return;
+	}
+	/* Continue where the previous wakeup left off, if known. */
+	const char *pos_key;
+	uint32_t pos_part_count = ttl_purge_pos_find(space_id, pk, &pos_key);
+	struct iterator *it = index_create_iterator(pk,
+			pos_key != NULL ? ITER_GT : ITER_ALL,
+			pos_key, pos_part_count);
+	if (it == NULL) {
+		txn_rollback_stmt(txn);
+		diag_log();
+		return;
+	}
+	txn_commit_ro_stmt(txn, &svp);
+	double now = fiber_time();
+	const char *keys[TTL_PURGE_DELETE_BATCH];
+	const char *key_ends[TTL_PURGE_DELETE_BATCH];
+	uint32_t key_count = 0;
+	struct tuple *tuple;
+	int rc = 0;
+	for (int scanned = 0; scanned < TTL_PURGE_SCAN_BATCH &&
+	     key_count < TTL_PURGE_DELETE_BATCH; scanned++) {
+		rc = iterator_next(it, &tuple);
+		if (rc != 0 || tuple == NULL)
+			break;
+		if (!space_tuple_is_expired(space, tuple, now))
+			continue;
+		uint32_t key_size;
+		char *key = tuple_extract_key(tuple, pk->def->key_def,
+					      MULTIKEY_NONE, &key_size);
+		if (key == NULL) {
+			rc = -1;
+			break;
+		}
+		keys[key_count] = key;
+		key_ends[key_count] = key + key_size;
+		key_count++;
+	}
+	/*
+	 * Remember where the scan stopped so that the next
+	 * wakeup makes progress through the whole space instead
+	 * of rescanning the head; wrap around once the index is
+	 * exhausted. Saved before the deletions below: they go
+	 * through WAL and yield. On a scan error keep the old
+	 * position.
+	 */
+	if (rc == 0) {
+		if (tuple != NULL)
+			ttl_purge_pos_save(space_id, tuple,
+					   pk->def->key_def);
+		else
+			ttl_purge_pos_forget(space_id);
+	}
+	iterator_delete(it);
+	if (rc != 0)
+		diag_log();
+	for (uint32_t i = 0; i < key_count; i++) {
+		if (box_delete(space_id, 0, keys[i], key_ends[i],
+			       NULL) != 0) {
+			diag_log();
+			break;
+		}
+	}
+}
+
+static int
+ttl_purge_fiber_f(va_list ap)
+{
+	(void)ap;
+	fiber_set_user(fiber(), &admin_credentials);
+	while (!fiber_is_cancelled()) {
+		fiber_sleep(TTL_PURGE_INTERVAL);
+		if (box_is_ro()) {
+			/*
+			 * Expired tuples are deleted on the master
+			 * and the deletions are replicated. Reads
+			 * are filtered meanwhile.
+			 */
+			continue;
+		}
+		struct region *region = &fiber()->gc;
+		size_t region_svp = region_used(region);
+		uint32_t count = 0;
+		space_foreach(ttl_purge_count_cb, &count);
+		if (count == 0)
+			continue;
+		struct ttl_space_ids set;
+		set.count = 0;
+		size_t size = count * sizeof(*set.ids);
+		set.ids = (uint32_t *)region_alloc(region, size);
+		if (set.ids == NULL) {
+			diag_set(OutOfMemory, size, "region", "ids");
+			diag_log();
+			continue;
+		}
+		space_foreach(ttl_purge_collect_cb, &set);
+		for (uint32_t i = 0; i < set.count; i++) {
+			ttl_purge_space(set.ids[i]);
+			fiber_sleep(0);
+		}
+		region_truncate(region, region_svp);
+	}
+	return 0;
+}
+
+/* }}} TTL purge */
+
 void
 box_init(void)
 {
@@ -2932,9 +3453,38 @@ box_is_configured(void)
 	return is_box_configured;
 }
 
+const char *box_startup_stage_strs[] = {
+	"init",
+	"recovery",
+	"sync",
+	"total",
+};
+
+/** Wall-clock startup stage durations, see box_startup_duration(). */
+static double startup_durations[box_startup_stage_MAX];
+
+double
+box_startup_duration(enum box_startup_stage stage)
+{
+	assert(stage < box_startup_stage_MAX);
+	return startup_durations[stage];
+}
+
 static void
 box_cfg_xc(void)
 {
+	double start_time = clock_monotonic();
+	const char *cpu_affinity = cfg_gets("cpu_affinity");
+	if (cpu_affinity != NULL) {
+		/*
+		 * Install the spec before any worker threads are
+		 * started so that every cord gets pinned on
+		 * creation, and pin the tx thread itself.
+		 */
+		if (cpu_pin_set_spec(cpu_affinity) != 0)
+			diag_raise();
+		cpu_pin_thread("main");
+	}
 	/* Join the cord interconnect as "tx" endpoint. */
 	fiber_pool_create(&tx_fiber_pool, "tx",
 			  IPROTO_MSG_MAX_MIN * IPROTO_FIBER_POOL_SIZE_FACTOR,
@@ -2950,13 +3500,15 @@ box_cfg_xc(void)
 	schema_init();
 	replication_init();
 	port_init();
-	iproto_init();
+	iproto_set_iouring(cfg_geti("net_iouring") != 0);
+	iproto_init(cfg_geti("iproto_threads"));
 	sql_init();
 
 	int64_t wal_max_size = box_check_wal_max_size(cfg_geti64("wal_max_size"));
 	enum wal_mode wal_mode = box_check_wal_mode(cfg_gets("wal_mode"));
 	if (wal_init(wal_mode, cfg_gets("wal_dir"), wal_max_size,
-		     &INSTANCE_UUID, on_wal_garbage_collection,
+		     cfg_geti("wal_direct") != 0, &INSTANCE_UUID,
+		     on_wal_garbage_collection,
 		     on_wal_checkpoint_threshold) != 0) {
 		diag_raise();
 	}
@@ -2970,9 +3522,15 @@ box_cfg_xc(void)
 	if (box_set_prepared_stmt_cache_size() != 0)
 		diag_raise();
 	box_set_net_msg_max();
+	box_set_net_flush_interval();
+	box_set_net_class_msg_max();
+	box_set_net_zerocopy();
 	box_set_readahead();
 	box_set_too_long_threshold();
+	box_set_wal_hiccup_threshold();
 	box_set_replication_timeout();
+	box_set_replication_ack_period();
+	box_set_replication_space_filter();
 	box_set_replication_connect_timeout();
 	box_set_replication_connect_quorum();
 	box_set_replication_sync_lag();
@@ -3009,6 +3567,8 @@ box_cfg_xc(void)
 		journal_set(NULL);
 	});
 
+	startup_durations[BOX_STARTUP_INIT] = clock_monotonic() - start_time;
+
 	bool is_bootstrap_leader = false;
 	if (checkpoint != NULL) {
 		/* Recover the instance from the local directory */
@@ -3020,6 +3580,8 @@ box_cfg_xc(void)
 			  &is_bootstrap_leader);
 	}
 	fiber_gc();
+	startup_durations[BOX_STARTUP_RECOVERY] = clock_monotonic() -
+		start_time - startup_durations[BOX_STARTUP_INIT];
 
 	bootstrap_journal_guard.is_active = false;
 	assert(current_journal != &bootstrap_journal);
@@ -3047,6 +3609,11 @@ box_cfg_xc(void)
 
 	fiber_gc();
 	is_box_configured = true;
+
+	ttl_purge_fiber = fiber_new("ttl_purge", ttl_purge_fiber_f);
+	if (ttl_purge_fiber == NULL)
+		panic("failed to start the TTL purge fiber");
+	fiber_start(ttl_purge_fiber);
 	/*
 	 * Fill in leader election parameters after bootstrap. Before it is not
 	 * possible - there may be relevant data to recover from WAL and
@@ -3083,6 +3650,17 @@ box_cfg_xc(void)
 		raft_new_term(box_raft());
 	}
 
+	double total = clock_monotonic() - start_time;
+	startup_durations[BOX_STARTUP_SYNC] = total -
+		startup_durations[BOX_STARTUP_INIT] -
+		startup_durations[BOX_STARTUP_RECOVERY];
+	startup_durations[BOX_STARTUP_TOTAL] = total;
+	say_info("startup took %.3f sec (init %.3f, recovery %.3f, "
+		 "sync %.3f)", total,
+		 startup_durations[BOX_STARTUP_INIT],
+		 startup_durations[BOX_STARTUP_RECOVERY],
+		 startup_durations[BOX_STARTUP_SYNC]);
+
 	/* box.cfg.read_only is not read yet. */
 	assert(box_is_ro());
 	/* If anyone is waiting for ro mode. */
@@ -176,6 +176,33 @@ box_backup_stop(void);
  */
 const char *box_status(void);
 
+/**
+ * Startup stages timed by box_cfg() and reported via
+ * box.info.startup:
+ * - init: subsystem and engine initialization, up to the
+ *   point where recovery begins;
+ * - recovery: local recovery or bootstrap/join;
+ * - sync: following the replicas and syncing with them;
+ * - total: the whole box_cfg() call.
+ */
+enum box_startup_stage {
+	BOX_STARTUP_INIT,
+	BOX_STARTUP_RECOVERY,
+	BOX_STARTUP_SYNC,
+	BOX_STARTUP_TOTAL,
+	box_startup_stage_MAX,
+};
+
+/** Startup stage names, used as box.info.startup keys. */
+extern const char *box_startup_stage_strs[];
+
+/**
+ * Duration of a startup stage, in seconds.
+ * Returns 0 until the stage has completed.
+ */
+double
+box_startup_duration(enum box_startup_stage stage);
+
 /**
  * Reset box statistics.
  */
@@ -234,13 +261,20 @@ void box_set_log_level(void);
 void box_set_log_format(void);
 void box_set_io_collect_interval(void);
 void box_set_snap_io_rate_limit(void);
+void box_set_snap_io_backoff_latency(void);
+void box_set_checkpoint_threads(void);
 void box_set_too_long_threshold(void);
 void box_set_readahead(void);
 void box_set_checkpoint_count(void);
 void box_set_checkpoint_interval(void);
 void box_set_checkpoint_wal_threshold(void);
+void box_set_checkpoint_min_wal_size(void);
+void box_set_gc_unlink_rate(void);
+void box_set_wal_sync_size(void);
+void box_set_wal_hiccup_threshold(void);
 void box_set_memtx_memory(void);
 void box_set_memtx_max_tuple_size(void);
+void box_set_memtx_compaction(void);
 void box_set_vinyl_memory(void);
 void box_set_vinyl_max_tuple_size(void);
 void box_set_vinyl_cache(void);
@@ -248,6 +282,7 @@ void box_set_vinyl_timeout(void);
 int box_set_election_mode(void);
 int box_set_election_timeout(void);
 void box_set_replication_timeout(void);
+void box_set_replication_ack_period(void);
 void box_set_replication_connect_timeout(void);
 void box_set_replication_connect_quorum(void);
 void box_set_replication_sync_lag(void);
@@ -258,6 +293,9 @@ void box_set_replication_sync_timeout(void);
 void box_set_replication_skip_conflict(void);
 void box_set_replication_anon(void);
 void box_set_net_msg_max(void);
+void box_set_net_flush_interval(void);
+void box_set_net_class_msg_max(void);
+void box_set_net_zerocopy(void);
 int box_set_crash(void);
 
 int
@@ -278,6 +316,22 @@ box_select(uint32_t space_id, uint32_t index_id,
 	   const char *key, const char *key_end,
 	   struct port *port);
 
+/*
+ * Like box_select(), but with stateless pagination: the scan may
+ * continue right after a previously saved position (@a after_pos
+ * may be NULL) and, if @a fetch_pos is set, the position of the
+ * last returned tuple is saved into @a pos / @a pos_size on the
+ * fiber region (*pos == NULL if the scan is exhausted). Private
+ * and used only by Lua.
+ */
+API_EXPORT int
+box_select_after(uint32_t space_id, uint32_t index_id,
+		 int iterator, uint32_t offset, uint32_t limit,
+		 const char *key, const char *key_end,
+		 const char *after_pos, uint32_t after_pos_size,
+		 bool fetch_pos, const char **pos, uint32_t *pos_size,
+		 struct port *port);
+
 /** \cond public */
 
 /*
@@ -318,6 +372,46 @@ box_return_tuple(box_function_ctx_t *ctx, box_tuple_t *tuple);
 API_EXPORT int
 box_return_mp(box_function_ctx_t *ctx, const char *mp, const char *mp_end);
 
+/**
+ * Reserve \a size bytes of contiguous memory in the result
+ * buffer of a stored C procedure, so a MessagePack value can be
+ * encoded right in place instead of being encoded in a procedure
+ * owned buffer and copied by box_return_mp().
+ *
+ * The reservation stays valid until the next reserve or return
+ * call on \a ctx. It is allowed to reserve more than is actually
+ * encoded and to abandon a reservation by simply not committing
+ * it.
+ *
+ * \param ctx An opaque structure passed to the stored C
+ *        procedure by Tarantool.
+ * \param size Number of bytes to reserve.
+ * \retval not NULL Pointer to the reserved memory.
+ * \retval NULL Error (perhaps, out of memory; check
+ *         box_error_last()).
+ */
+API_EXPORT char *
+box_return_mp_reserve(box_function_ctx_t *ctx, size_t size);
+
+/**
+ * Return the first \a size bytes of the memory obtained with
+ * box_return_mp_reserve() from a stored C procedure without
+ * copying them.
+ *
+ * The memory must contain a single encoded MessagePack value.
+ * Like with box_return_mp(), the MessagePack is not validated,
+ * for the sake of speed.
+ *
+ * \param ctx An opaque structure passed to the stored C
+ *        procedure by Tarantool.
+ * \param size Size of the encoded value, must not exceed the
+ *        reserved size.
+ * \retval -1 Error.
+ * \retval 0 Success.
+ */
+API_EXPORT int
+box_return_mp_commit(box_function_ctx_t *ctx, size_t size);
+
 /**
  * Find space id by name.
  *
@@ -105,8 +105,13 @@ port_sql_destroy(struct port *base)
 {
 	port_c_vtab.destroy(base);
 	struct port_sql *port_sql = (struct port_sql *) base;
-	if (port_sql->do_finalize)
+	if (port_sql->do_finalize) {
 		sql_stmt_finalize(((struct port_sql *)base)->stmt);
+	} else if (port_sql->do_unref) {
+		const char *sql_str = sql_stmt_query_str(port_sql->stmt);
+		sql_stmt_unref(sql_stmt_calculate_id(sql_str,
+						     strlen(sql_str)));
+	}
 }
 
 const struct port_vtab port_sql_vtab = {
@@ -129,6 +134,7 @@ port_sql_create(struct port *port, struct sql_stmt *stmt,
 	port_sql->stmt = stmt;
 	port_sql->serialization_format = format;
 	port_sql->do_finalize = do_finalize;
+	port_sql->do_unref = false;
 }
 
 /**
@@ -577,6 +583,34 @@ port_sql_dump_msgpack(struct port *port, struct obuf *out)
 	return 0;
 }
 
+int
+port_sql_dump_msgpack_tail(struct port *port, struct obuf *out,
+			   struct port_c_entry **pe, int count)
+{
+	assert(port->vtab == &port_sql_vtab);
+	struct port_sql *sql_port = (struct port_sql *)port;
+	assert(sql_port->serialization_format == DQL_EXECUTE);
+	struct sql_stmt *stmt = sql_port->stmt;
+	int size = mp_sizeof_map(2);
+	char *pos = (char *) obuf_alloc(out, size);
+	if (pos == NULL) {
+		diag_set(OutOfMemory, size, "obuf_alloc", "pos");
+		return -1;
+	}
+	pos = mp_encode_map(pos, 2);
+	if (sql_get_metadata(stmt, out, sql_column_count(stmt)) != 0)
+		return -1;
+	size = mp_sizeof_uint(IPROTO_DATA) + mp_sizeof_array(count);
+	pos = (char *) obuf_alloc(out, size);
+	if (pos == NULL) {
+		diag_set(OutOfMemory, size, "obuf_alloc", "pos");
+		return -1;
+	}
+	pos = mp_encode_uint(pos, IPROTO_DATA);
+	pos = mp_encode_array(pos, count);
+	return port_c_dump_msgpack_16_chunk(pe, out, count) < 0 ? -1 : 0;
+}
+
 static bool
 sql_stmt_schema_version_is_valid(struct sql_stmt *stmt)
 {
@@ -733,11 +767,266 @@ sql_execute_prepared(uint32_t stmt_id, const struct sql_bind *bind,
 	return 0;
 }
 
+/**
+ * The maximum number of literals lifted into bound variables by
+ * auto-parameterization. Further literals stay inline.
+ */
+enum { SQL_AUTOPARAM_MAX = 64 };
+
+/**
+ * Auto-parameterization of a statement with inline literals.
+ *
+ * Statements which inline literal constants ("WHERE id = 12345")
+ * never hit the prepared statement cache: every distinct literal
+ * makes a textually unique statement which is re-compiled from
+ * scratch. Rewrite such a statement into a parameterized form
+ * before compilation: literals used as direct operands of a
+ * comparison are replaced with '?' and their values are collected
+ * into a bind array. The rewritten text is compiled and cached as
+ * an ordinary prepared statement, so repeated queries differing
+ * only in literal values reuse the compiled program.
+ *
+ * Only SELECT statements without user parameters are rewritten,
+ * and only literals immediately following a comparison operator
+ * are lifted: literals elsewhere (LIMIT bounds, ORDER BY
+ * ordinals, CAST arguments and the like) can change the meaning
+ * of the statement or the produced plan and stay inline.
+ *
+ * @param sql Original statement text.
+ * @param len Length of @a sql.
+ * @param region Allocator for the rewritten text and bind array.
+ * @param[out] normalized Rewritten statement text.
+ * @param[out] normalized_len Length of @a normalized.
+ * @param[out] binds Values of the lifted literals.
+ *
+ * @retval > 0 Number of lifted literals.
+ * @retval 0   Statement is left as is.
+ * @retval -1  Memory error.
+ */
+static int
+sql_auto_parameterize(const char *sql, int len, struct region *region,
+		      const char **normalized, int *normalized_len,
+		      struct sql_bind **binds)
+{
+	size_t svp = region_used(region);
+	/*
+	 * sql_token() needs a terminated string; the input may be
+	 * a slice of a network buffer.
+	 */
+	char *src = region_alloc(region, len + 1);
+	/* A '?' is never longer than the literal it replaces. */
+	char *dst = region_alloc(region, len + 1);
+	size_t bind_size;
+	struct sql_bind *bind = region_alloc_array(region, typeof(bind[0]),
+						   SQL_AUTOPARAM_MAX,
+						   &bind_size);
+	if (src == NULL || dst == NULL || bind == NULL) {
+		diag_set(OutOfMemory, len + 1, "region_alloc", "src");
+		return -1;
+	}
+	memcpy(src, sql, len);
+	src[len] = '\0';
+	int pos = 0;
+	int dst_len = 0;
+	int count = 0;
+	int prev = TK_SPACE;
+	bool is_select = false;
+	while (pos < len) {
+		int type;
+		bool unused;
+		int n = sql_token(src + pos, &type, &unused);
+		if (n <= 0 || pos + n > len)
+			goto skip;
+		bool lift = false;
+		switch (type) {
+		case TK_SPACE:
+		case TK_LINEFEED:
+			break;
+		case TK_VARIABLE:
+		case TK_ILLEGAL:
+			/*
+			 * Lifting literals next to explicit
+			 * parameters would renumber them; a broken
+			 * token is the parser's business.
+			 */
+			goto skip;
+		case TK_INTEGER:
+		case TK_FLOAT:
+		case TK_STRING:
+			if (!is_select)
+				goto skip;
+			lift = prev == TK_EQ || prev == TK_NE ||
+			       prev == TK_LT || prev == TK_LE ||
+			       prev == TK_GT || prev == TK_GE;
+			break;
+		default:
+			if (!is_select) {
+				if (type != TK_SELECT)
+					goto skip;
+				is_select = true;
+			}
+			break;
+		}
+		/*
+		 * Hex literals stay inline: their overflow rules
+		 * differ from decimal ones and they are rare.
+		 */
+		if (lift && type == TK_INTEGER && src[pos] == '0' &&
+		    (src[pos + 1] == 'x' || src[pos + 1] == 'X'))
+			lift = false;
+		if (lift && count < SQL_AUTOPARAM_MAX) {
+			struct sql_bind *p = &bind[count];
+			memset(p, 0, sizeof(*p));
+			if (type == TK_INTEGER) {
+				int64_t value;
+				bool is_neg;
+				if (sql_atoi64(src + pos, &value, &is_neg,
+					       n) != 0)
+					goto skip;
+				assert(!is_neg);
+				p->type = MP_UINT;
+				p->u64 = (uint64_t) value;
+				p->bytes = sizeof(uint64_t);
+			} else if (type == TK_FLOAT) {
+				double r;
+				if (sqlAtoF(src + pos, &r, n) == 0)
+					goto skip;
+				p->type = MP_DOUBLE;
+				p->d = r;
+				p->bytes = sizeof(double);
+			} else {
+				char *str = region_alloc(region, n + 1);
+				if (str == NULL) {
+					diag_set(OutOfMemory, n + 1,
+						 "region_alloc", "str");
+					return -1;
+				}
+				memcpy(str, src + pos, n);
+				str[n] = '\0';
+				sqlDequote(str);
+				p->type = MP_STR;
+				p->s = str;
+				p->bytes = strlen(str);
+			}
+			dst[dst_len++] = '?';
+			count++;
+		} else {
+			memcpy(dst + dst_len, src + pos, n);
+			dst_len += n;
+		}
+		if (type != TK_SPACE && type != TK_LINEFEED)
+			prev = type;
+		pos += n;
+	}
+	if (count == 0)
+		goto skip;
+	*normalized = dst;
+	*normalized_len = dst_len;
+	*binds = bind;
+	return count;
+skip:
+	region_truncate(region, svp);
+	return 0;
+}
+
+/**
+ * Execute an auto-parameterized statement: look up the rewritten
+ * text in the prepared statement cache, compile and cache it on a
+ * miss, bind the lifted literal values and execute. The cache
+ * entry is referenced until the port is destroyed so that cache
+ * pressure can not evict a statement which is still in use.
+ */
+static int
+sql_execute_parameterized(const char *sql, int len,
+			  const struct sql_bind *bind, uint32_t bind_count,
+			  struct port *port, struct region *region)
+{
+	uint32_t stmt_id = sql_stmt_calculate_id(sql, len);
+	struct sql_stmt *stmt = sql_stmt_cache_find(stmt_id);
+	if (stmt == NULL) {
+		if (sql_stmt_compile(sql, len, NULL, &stmt, NULL) != 0)
+			return -1;
+		if (sql_stmt_cache_insert(stmt) != 0) {
+			/*
+			 * The cache may be disabled (sql_cache_size
+			 * = 0) or full of session-referenced
+			 * statements. That must not fail the query:
+			 * run the already-compiled statement
+			 * privately, mirroring the busy-statement
+			 * fallback below.
+			 */
+			diag_clear(diag_get());
+			enum sql_serialization_format format =
+				sql_column_count(stmt) > 0 ? DQL_EXECUTE :
+							     DML_EXECUTE;
+			port_sql_create(port, stmt, format, true);
+			if (sql_bind(stmt, bind, bind_count) == 0 &&
+			    sql_execute(stmt, port, region) == 0)
+				return 0;
+			port_destroy(port);
+			return -1;
+		}
+	} else {
+		if (sql_stmt_busy(stmt)) {
+			/*
+			 * The cached program is executing in a
+			 * concurrent fiber: run a private copy.
+			 * A non-zero bind count prevents a second
+			 * auto-parameterization pass.
+			 */
+			return sql_prepare_and_execute(sql, len, bind,
+						       bind_count, port,
+						       region);
+		}
+		if (!sql_stmt_schema_version_is_valid(stmt)) {
+			if (sql_reprepare(&stmt) != 0)
+				return -1;
+		}
+		/*
+		 * Clear all set from previous execution cycle
+		 * values to be bound.
+		 */
+		sql_unbind(stmt);
+	}
+	sql_stmt_ref(stmt_id);
+	if (sql_bind(stmt, bind, bind_count) != 0) {
+		sql_stmt_unref(stmt_id);
+		return -1;
+	}
+	enum sql_serialization_format format = sql_column_count(stmt) > 0 ?
+					       DQL_EXECUTE : DML_EXECUTE;
+	port_sql_create(port, stmt, format, false);
+	((struct port_sql *) port)->do_unref = true;
+	if (sql_execute(stmt, port, region) != 0) {
+		sql_stmt_reset(stmt);
+		port_destroy(port);
+		return -1;
+	}
+	sql_stmt_reset(stmt);
+	return 0;
+}
+
 int
 sql_prepare_and_execute(const char *sql, int len, const struct sql_bind *bind,
 			uint32_t bind_count, struct port *port,
 			struct region *region)
 {
+	if (bind_count == 0) {
+		const char *normalized;
+		int normalized_len;
+		struct sql_bind *auto_bind;
+		int lifted = sql_auto_parameterize(sql, len, region,
+						   &normalized,
+						   &normalized_len,
+						   &auto_bind);
+		if (lifted < 0)
+			return -1;
+		if (lifted > 0)
+			return sql_execute_parameterized(normalized,
+							 normalized_len,
+							 auto_bind, lifted,
+							 port, region);
+	}
 	struct sql_stmt *stmt;
 	if (sql_stmt_compile(sql, len, NULL, &stmt, NULL) != 0)
 		return -1;
@@ -113,10 +113,31 @@ struct port_sql {
 	 * statement remains in cache and will be deleted later.
 	 */
 	bool do_finalize;
+	/**
+	 * The statement lives in the prepared statement cache and
+	 * is referenced for as long as the port may access it:
+	 * the reference is dropped on destroy. Used by
+	 * auto-parameterized statements which are cached without
+	 * a session reference.
+	 */
+	bool do_unref;
 };
 
 extern const struct port_vtab port_sql_vtab;
 
+struct obuf;
+struct port_c_entry;
+
+/**
+ * Dump the tail of a streamed DQL response into @a out: the
+ * response metadata followed by IPROTO_DATA with @a count rows
+ * starting from @a pe. Used by iproto when the head of the result
+ * set has already been sent in IPROTO_CHUNK packets.
+ */
+int
+port_sql_dump_msgpack_tail(struct port *port, struct obuf *out,
+			   struct port_c_entry **pe, int count);
+
 int
 sql_stmt_finalize(struct sql_stmt *stmt);
 
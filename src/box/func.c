@@ -395,18 +395,42 @@ module_reload(const char *package, const char *package_end, struct module **modu
 		func->module = new_module;
 		rlist_move(&new_module->funcs, &func->item);
 	}
-	module_cache_del(package, package_end);
+	/*
+	 * Replace the old module with the new one in the module
+	 * cache. The key is the same package name, so a single
+	 * put overwrites the entry in place and the cache can
+	 * never end up without an entry for the package.
+	 */
 	if (module_cache_put(new_module) != 0)
 		goto restore;
+	/*
+	 * The old generation is retired asynchronously: if there
+	 * are calls still running inside the old dso, the last
+	 * of them drops it on return, see func_c_call().
+	 */
 	module_gc(old_module);
 	*module = new_module;
 	return 0;
 restore:
 	/*
-	 * Some old-dso func can't be load from new module, restore old
-	 * functions.
+	 * Some old-dso func can't be loaded from the new module,
+	 * restore all the functions that have already been
+	 * re-routed to the new one. The failing function itself
+	 * is still on the old module's list, but its symbol has
+	 * been reset, so walk the old list first.
 	 */
-	do {
+	rlist_foreach_entry(func, &old_module->funcs, item) {
+		if (func->func != NULL)
+			continue;
+		struct func_name name;
+		func_split_name(func->base.def->name, &name);
+		func->func = module_sym(old_module, name.sym);
+		if (func->func == NULL) {
+			panic("Can't restore module function, "
+			      "server state is inconsistent");
+		}
+	}
+	rlist_foreach_entry_safe(func, &new_module->funcs, item, tmp_func) {
 		struct func_name name;
 		func_split_name(func->base.def->name, &name);
 		func->func = module_sym(old_module, name.sym);
@@ -420,8 +444,7 @@ restore:
 		}
 		func->module = old_module;
 		rlist_move(&old_module->funcs, &func->item);
-	} while (func != rlist_first_entry(&old_module->funcs,
-					   struct func_c, item));
+	}
 	assert(rlist_empty(&new_module->funcs));
 	module_delete(new_module);
 	return -1;
@@ -152,6 +152,48 @@ gc_free(void)
 	}
 }
 
+/** Number of WAL files removed per paced cleanup step. */
+enum { GC_UNLINK_BATCH = 10 };
+
+/**
+ * If the most recent WAL fdatasync() took longer than this,
+ * consider the disk busy and slow the paced cleanup down.
+ */
+static const double GC_DISK_BUSY_SYNC_SEC = 0.01;
+
+/**
+ * Remove obsolete WAL files in batches of GC_UNLINK_BATCH,
+ * sleeping in between so that at most gc.unlink_rate files are
+ * unlinked per second. When the WAL reports a slow recent
+ * fdatasync(), the pause is doubled to yield the disk to the
+ * write path. With pacing disabled (rate 0) everything is
+ * deleted in one go, as before.
+ */
+static void
+gc_paced_wal_cleanup(void)
+{
+	if (gc.unlink_rate <= 0) {
+		wal_collect_garbage(&gc.vclock);
+		return;
+	}
+	while (!fiber_is_cancelled()) {
+		/*
+		 * Re-read gc.vclock on every step: consumers may
+		 * have advanced it while we were sleeping, it
+		 * never moves backwards.
+		 */
+		int backlog = wal_collect_garbage_step(&gc.vclock,
+						       GC_UNLINK_BATCH);
+		gc.wal_cleanup_backlog = backlog;
+		if (backlog == 0)
+			break;
+		double delay = (double)GC_UNLINK_BATCH / gc.unlink_rate;
+		if (wal_sync_recent_duration() > GC_DISK_BUSY_SYNC_SEC)
+			delay *= 2;
+		fiber_sleep(delay);
+	}
+}
+
 /**
  * Invoke garbage collection in order to remove files left
  * from old checkpoints. The number of checkpoints saved by
@@ -231,7 +273,7 @@ gc_run_cleanup(void)
 	if (run_engine_gc)
 		engine_collect_garbage(&checkpoint->vclock);
 	if (run_wal_gc)
-		wal_collect_garbage(&min_vclock);
+		gc_paced_wal_cleanup();
 }
 
 static int
@@ -325,6 +367,18 @@ gc_set_min_checkpoint_count(int min_checkpoint_count)
 	gc.min_checkpoint_count = min_checkpoint_count;
 }
 
+void
+gc_set_checkpoint_min_wal_size(int64_t min_wal_size)
+{
+	gc.checkpoint_min_wal_size = min_wal_size;
+}
+
+void
+gc_set_unlink_rate(int rate)
+{
+	gc.unlink_rate = rate;
+}
+
 void
 gc_set_checkpoint_interval(double interval)
 {
@@ -525,6 +579,23 @@ gc_checkpoint_fiber_f(va_list ap)
 			 */
 			continue;
 		}
+		if (gc.checkpoint_min_wal_size > 0 &&
+		    !rlist_empty(&gc.checkpoints) &&
+		    wal_checkpoint_wal_size() < gc.checkpoint_min_wal_size) {
+			/*
+			 * Almost nothing was written since the
+			 * last checkpoint. Rewriting all data
+			 * files would waste disk bandwidth -
+			 * keep relying on the WAL until enough
+			 * data has changed. Checkpoints
+			 * triggered by checkpoint_wal_threshold
+			 * or box.snapshot() are never skipped.
+			 */
+			say_info("skipping scheduled checkpoint: "
+				 "WAL size since the last checkpoint is "
+				 "below checkpoint_min_wal_size");
+			continue;
+		}
 		if (gc_do_checkpoint(true) != 0)
 			diag_log();
 	}
@@ -116,6 +116,14 @@ struct gc_state {
 	 * be in use by replication or backup.
 	 */
 	int checkpoint_count;
+	/**
+	 * A scheduled checkpoint is skipped while the amount of
+	 * WAL data written since the last checkpoint is below
+	 * this value, so that low write churn doesn't cost a
+	 * full data file rewrite. 0 disables the heuristic.
+	 * Configured by box.cfg.checkpoint_min_wal_size.
+	 */
+	int64_t checkpoint_min_wal_size;
 	/**
 	 * List of preserved checkpoints. New checkpoints are added
 	 * to the tail. Linked by gc_checkpoint::in_checkpoints.
@@ -156,6 +164,21 @@ struct gc_state {
 	 * a checkpoint as soon as possible despite the schedule.
 	 */
 	bool checkpoint_is_pending;
+	/**
+	 * Max number of obsolete WAL files unlinked per second.
+	 * After a checkpoint hundreds of files may become
+	 * obsolete at once, and dropping them in one go causes
+	 * a filesystem latency burst that hits WAL writes on
+	 * the same volume. 0 means no pacing - delete
+	 * everything at once. Configured by
+	 * box.cfg.gc_unlink_rate.
+	 */
+	int unlink_rate;
+	/**
+	 * Number of obsolete WAL files not yet unlinked by the
+	 * paced cleanup. Shown in box.info.gc().
+	 */
+	int wal_cleanup_backlog;
 };
 extern struct gc_state gc;
 
@@ -224,6 +247,14 @@ gc_advance(const struct vclock *vclock);
 void
 gc_set_min_checkpoint_count(int min_checkpoint_count);
 
+/**
+ * Update the minimal amount of WAL data that must be written
+ * since the last checkpoint for a scheduled checkpoint to be
+ * made. Called when box.cfg.checkpoint_min_wal_size is updated.
+ */
+void
+gc_set_checkpoint_min_wal_size(int64_t min_wal_size);
+
 /**
  * Set the time interval between checkpoints, in seconds.
  * Setting the interval to 0 disables periodic checkpointing.
@@ -231,6 +262,14 @@ gc_set_min_checkpoint_count(int min_checkpoint_count);
 void
 gc_set_checkpoint_interval(double interval);
 
+/**
+ * Set the max number of obsolete WAL files unlinked per second.
+ * 0 disables pacing. Called when box.cfg.gc_unlink_rate is
+ * updated.
+ */
+void
+gc_set_unlink_rate(int rate);
+
 /**
  * Track an existing checkpoint in the garbage collector state.
  * Note, this function may trigger garbage collection to remove
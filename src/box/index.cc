@@ -246,6 +246,9 @@ box_index_get(uint32_t space_id, uint32_t index_id, const char *key,
 		txn_rollback_stmt(txn);
 		return -1;
 	}
+	if (*result != NULL && space_has_expire(space) &&
+	    space_tuple_is_expired(space, *result, fiber_time()))
+		*result = NULL;
 	txn_commit_ro_stmt(txn, &svp);
 	/* Count statistics. */
 	rmean_collect(rmean_box, IPROTO_SELECT, 1);
@@ -254,6 +257,34 @@ box_index_get(uint32_t space_id, uint32_t index_id, const char *key,
 	return 0;
 }
 
+/**
+ * Find the first tuple of a TTL space that has not expired yet,
+ * scanning from the border requested by @a type (ITER_GE for
+ * min(), ITER_LE for max()).
+ */
+static int
+index_first_alive(struct space *space, struct index *index,
+		  enum iterator_type type, const char *key,
+		  uint32_t part_count, struct tuple **result)
+{
+	struct iterator *it = index_create_iterator(index, type,
+						    key, part_count);
+	if (it == NULL)
+		return -1;
+	double now = fiber_time();
+	struct tuple *tuple;
+	int rc;
+	while ((rc = iterator_next(it, &tuple)) == 0 && tuple != NULL) {
+		if (!space_tuple_is_expired(space, tuple, now))
+			break;
+	}
+	iterator_delete(it);
+	if (rc != 0)
+		return -1;
+	*result = tuple;
+	return 0;
+}
+
 int
 box_index_min(uint32_t space_id, uint32_t index_id, const char *key,
 	      const char *key_end, box_tuple_t **result)
@@ -277,7 +308,14 @@ box_index_min(uint32_t space_id, uint32_t index_id, const char *key,
 	struct txn_ro_savepoint svp;
 	if (txn_begin_ro_stmt(space, &txn, &svp) != 0)
 		return -1;
-	if (index_min(index, key, part_count, result) != 0) {
+	int rc;
+	if (space_has_expire(space)) {
+		rc = index_first_alive(space, index, ITER_GE, key,
+				       part_count, result);
+	} else {
+		rc = index_min(index, key, part_count, result);
+	}
+	if (rc != 0) {
 		txn_rollback_stmt(txn);
 		return -1;
 	}
@@ -310,7 +348,14 @@ box_index_max(uint32_t space_id, uint32_t index_id, const char *key,
 	struct txn_ro_savepoint svp;
 	if (txn_begin_ro_stmt(space, &txn, &svp) != 0)
 		return -1;
-	if (index_max(index, key, part_count, result) != 0) {
+	int rc;
+	if (space_has_expire(space)) {
+		rc = index_first_alive(space, index, ITER_LE, key,
+				       part_count, result);
+	} else {
+		rc = index_max(index, key, part_count, result);
+	}
+	if (rc != 0) {
 		txn_rollback_stmt(txn);
 		return -1;
 	}
@@ -398,6 +443,16 @@ box_iterator_next(box_iterator_t *itr, box_tuple_t **result)
 	assert(result != NULL);
 	if (iterator_next(itr, result) != 0)
 		return -1;
+	struct space *space = space_by_id(itr->space_id);
+	if (*result != NULL && space != NULL && space_has_expire(space)) {
+		/* Skip tuples that expired but are not purged yet. */
+		double now = fiber_time();
+		while (*result != NULL &&
+		       space_tuple_is_expired(space, *result, now)) {
+			if (iterator_next(itr, result) != 0)
+				return -1;
+		}
+	}
 	if (*result != NULL)
 		tuple_bless(*result);
 	return 0;
@@ -445,6 +500,8 @@ iterator_create(struct iterator *it, struct index *index)
 {
 	it->next = NULL;
 	it->free = NULL;
+	it->position = NULL;
+	it->position_restore = NULL;
 	it->space_cache_version = space_cache_version;
 	it->space_id = index->def->space_id;
 	it->index_id = index->def->iid;
@@ -475,6 +532,29 @@ invalidate:
 	return 0;
 }
 
+int
+iterator_position(struct iterator *it, const char **pos, uint32_t *pos_size)
+{
+	if (it->position == NULL) {
+		diag_set(UnsupportedIndexFeature, it->index->def,
+			 "pagination");
+		return -1;
+	}
+	return it->position(it, pos, pos_size);
+}
+
+int
+iterator_position_restore(struct iterator *it, const char *pos,
+			  uint32_t pos_size)
+{
+	if (it->position_restore == NULL) {
+		diag_set(UnsupportedIndexFeature, it->index->def,
+			 "pagination");
+		return -1;
+	}
+	return it->position_restore(it, pos, pos_size);
+}
+
 void
 iterator_delete(struct iterator *it)
 {
@@ -756,9 +836,9 @@ generic_index_build_next(struct index *index, struct tuple *tuple)
 {
 	struct tuple *unused;
 	/*
-	 * Note this is not no-op call in case of rtee index:
-	 * reserving 0 bytes is required during rtree recovery.
-	 * For details see memtx_rtree_index_reserve().
+	 * Give the engine a chance to guarantee that the
+	 * following replace will not fail with an out of
+	 * memory error.
 	 */
 	if (index_reserve(index, 0) != 0)
 		return -1;
@@ -245,6 +245,22 @@ struct iterator {
 	int (*next)(struct iterator *it, struct tuple **ret);
 	/** Destroy the iterator. */
 	void (*free)(struct iterator *);
+	/**
+	 * Save the position of the last returned tuple into an
+	 * opaque binary token, see iterator_position().
+	 * Optional: NULL if the index does not support
+	 * stateless pagination.
+	 */
+	int (*position)(struct iterator *it, const char **pos,
+			uint32_t *pos_size);
+	/**
+	 * Continue iteration right after a previously saved
+	 * position, see iterator_position_restore().
+	 * Optional: NULL if the index does not support
+	 * stateless pagination.
+	 */
+	int (*position_restore)(struct iterator *it, const char *pos,
+				uint32_t pos_size);
 	/** Space cache version at the time of the last index lookup. */
 	uint32_t space_cache_version;
 	/** ID of the space the iterator is for. */
@@ -278,6 +294,38 @@ iterator_create(struct iterator *it, struct index *index);
 int
 iterator_next(struct iterator *it, struct tuple **ret);
 
+/**
+ * Save the position of the last tuple returned by the iterator
+ * into an opaque binary token. A new iterator of the same type
+ * over the same key restored from the token continues the scan
+ * right after that tuple, so a client can paginate a space in
+ * fixed-size chunks without keeping the iterator open between
+ * requests.
+ *
+ * The token is allocated on the fiber region; the caller must
+ * copy it before the region is truncated. *pos is set to NULL
+ * and *pos_size to 0 if the iterator has not returned any
+ * tuples yet or is exhausted - there is nothing to continue
+ * from.
+ *
+ * Returns -1 and sets diag if the index does not support
+ * positions (only memtx TREE indexes do) or on OOM.
+ */
+int
+iterator_position(struct iterator *it, const char **pos, uint32_t *pos_size);
+
+/**
+ * Position a freshly created iterator right after the tuple a
+ * position token was saved at, see iterator_position(). Must be
+ * called before the first iterator_next() call.
+ *
+ * Returns -1 and sets diag if the index does not support
+ * positions or the token is malformed.
+ */
+int
+iterator_position_restore(struct iterator *it, const char *pos,
+			  uint32_t pos_size);
+
 /**
  * Destroy an iterator instance and free associated memory.
  */
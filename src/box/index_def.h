@@ -153,6 +153,10 @@ struct index_opts {
 	double run_size_ratio;
 	/* Bloom filter false positive rate. */
 	double bloom_fpr;
+	/**
+	 * Zstd compression level used for run files.
+	 */
+	int64_t zstd_level;
 	/**
 	 * LSN from the time of index creation.
 	 */
@@ -213,6 +217,8 @@ index_opts_cmp(const struct index_opts *o1, const struct index_opts *o2)
 		return o1->run_size_ratio < o2->run_size_ratio ? -1 : 1;
 	if (o1->bloom_fpr != o2->bloom_fpr)
 		return o1->bloom_fpr < o2->bloom_fpr ? -1 : 1;
+	if (o1->zstd_level != o2->zstd_level)
+		return o1->zstd_level < o2->zstd_level ? -1 : 1;
 	if (o1->func_id != o2->func_id)
 		return o1->func_id - o2->func_id;
 	if (o1->hint != o2->hint)
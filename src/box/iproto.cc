@@ -32,10 +32,12 @@
 #include <string.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #include <msgpuck.h>
 #include <small/ibuf.h>
 #include <small/obuf.h>
+#include <zstd.h>
 #include "third_party/base64.h"
 
 #include "version.h"
@@ -43,8 +45,15 @@
 #include "cbus.h"
 #include "say.h"
 #include "sio.h"
+#include "heap_audit.h"
+#include "flightrec.h"
+#include "probes.h"
 #include "evio.h"
 #include "coio.h"
+#include "iouring.h"
+#if defined(ENABLE_IOURING)
+#include <sys/eventfd.h>
+#endif
 #include "scoped_guard.h"
 #include "memory.h"
 #include "random.h"
@@ -60,6 +69,9 @@
 #include "replication.h" /* instance_uuid */
 #include "iproto_constants.h"
 #include "rmean.h"
+#include "histogram.h"
+#include "hdr_histogram.h"
+#include "trigger.h"
 #include "execute.h"
 #include "errinj.h"
 #include "tt_static.h"
@@ -67,6 +79,29 @@
 enum {
 	IPROTO_SALT_SIZE = 32,
 	IPROTO_PACKET_SIZE_MAX = 2UL * 1024 * 1024 * 1024,
+	/**
+	 * zstd level used for negotiated connection compression,
+	 * same default as xlog compression.
+	 */
+	IPROTO_ZSTD_LEVEL = 3,
+	/**
+	 * Flushes smaller than this are always sent with a plain
+	 * writev(): pinning pages and reaping completions costs
+	 * more than copying a few kilobytes.
+	 */
+	IPROTO_ZEROCOPY_THRESHOLD = 64 * 1024,
+	/**
+	 * How many zerocopy sends may await a kernel completion
+	 * per connection. When the queue is full, further flushes
+	 * fall back to copying.
+	 */
+	IPROTO_ZEROCOPY_QUEUE_MAX = 32,
+	/**
+	 * Submission queue depth of the per-thread io_uring used
+	 * to batch socket reads. Also bounds the number of reads
+	 * in flight per thread.
+	 */
+	IPROTO_IOURING_ENTRIES = 256,
 };
 
 /**
@@ -129,6 +164,53 @@ unsigned iproto_readahead = 16320;
 /* The maximal number of iproto messages in fly. */
 static int iproto_msg_max = IPROTO_MSG_MAX_MIN;
 
+/**
+ * How long (in seconds) a network thread may keep decoded requests
+ * staged for the tx thread before flushing them to the bus, see
+ * iproto_flush_input(). Allowing requests from several event loop
+ * iterations to coalesce into one batch trades a little latency
+ * for fewer cross-thread wakeups. 0 means flush once per event
+ * loop iteration, as before. Assigned in the tx thread and read in
+ * the network threads without synchronization, like
+ * iproto_readahead: a stale value only affects the next flush.
+ */
+static double iproto_flush_interval = 0;
+
+/**
+ * How many requests of one data class (DML, select, call) a
+ * network thread may keep in flight before shedding further
+ * requests of that class with ER_REQUEST_QUEUE_FULL. 0 means no
+ * per-class limit, only the common net_msg_max one. Assigned in
+ * the tx thread and read in the network threads without
+ * synchronization, like iproto_readahead.
+ */
+static int iproto_class_msg_max = 0;
+
+/**
+ * Whether new connections should try MSG_ZEROCOPY sends for
+ * large responses. Opt-in, because zerocopy pins the output
+ * buffers until the kernel confirms transmission and pays off
+ * only with sufficiently large replies. Assigned in the tx
+ * thread and read in the network threads without
+ * synchronization: it is only looked at when a connection is
+ * established.
+ */
+static bool iproto_zerocopy = false;
+
+/**
+ * Whether the network threads should batch socket reads through
+ * an io_uring instead of issuing one read() per ready socket.
+ * Static, read once at thread start, see iproto_set_iouring().
+ */
+static bool iproto_use_iouring = false;
+
+const char *iproto_class_strings[] = {
+	"CONTROL",
+	"DML",
+	"SELECT",
+	"CALL",
+};
+
 /**
  * Address the iproto listens for, stored in TX
  * thread. Is kept in TX to be shown in box.info.
@@ -197,6 +279,8 @@ struct iproto_msg
 		struct auth_request auth;
 		/* SQL request, if this is the EXECUTE/PREPARE request. */
 		struct sql_request sql;
+		/** ID request, if this is an IPROTO_ID. */
+		struct id_request id;
 		/** In case of iproto parse error, saved diagnostics. */
 		struct diag diag;
 	};
@@ -212,6 +296,19 @@ struct iproto_msg
 	 * ibuf object.
 	 */
 	size_t len;
+	/**
+	 * Priority class of the request, assigned when it is
+	 * decoded. Determines which pipe carries the message to
+	 * the tx thread and which latency histogram and depth
+	 * counter account it.
+	 */
+	enum iproto_msg_class msg_class;
+	/**
+	 * Event loop time the message was created at, to account
+	 * the request round trip time in the class latency
+	 * histogram, see net_send_msg().
+	 */
+	double enqueue_time;
 	/**
 	 * Position in the connection output buffer. When sending a
 	 * message to the tx thread, iproto sets it to its current
@@ -234,46 +331,23 @@ struct iproto_msg
 	bool close_connection;
 };
 
-static struct mempool iproto_msg_pool;
+struct iproto_thread;
 
 static struct iproto_msg *
 iproto_msg_new(struct iproto_connection *con);
 
 /**
- * Resume stopped connections, if any.
+ * Resume stopped connections of the given thread, if any.
  */
 static void
-iproto_resume(void);
+iproto_resume(struct iproto_thread *iproto_thread);
 
 static void
 iproto_msg_decode(struct iproto_msg *msg, const char **pos, const char *reqend,
 		  bool *stop_input);
 
 static inline void
-iproto_msg_delete(struct iproto_msg *msg)
-{
-	mempool_free(&iproto_msg_pool, msg);
-	iproto_resume();
-}
-
-/**
- * A single global queue for all requests in all connections. All
- * requests from all connections are processed concurrently.
- * Is also used as a queue for just established connections and to
- * execute disconnect triggers. A few notes about these triggers:
- * - they need to be run in a fiber
- * - unlike an ordinary request failure, on_connect trigger
- *   failure must lead to connection close.
- * - on_connect trigger must be processed before any other
- *   request on this connection.
- */
-static struct cpipe tx_pipe;
-static struct cpipe net_pipe;
-
-/**
- * Network thread.
- */
-static struct cord net_cord;
+iproto_msg_delete(struct iproto_msg *msg);
 
 /**
  * Slab cache used for allocating memory for output network buffers
@@ -281,13 +355,12 @@ static struct cord net_cord;
  */
 static struct slab_cache net_slabc;
 
-struct rmean *rmean_net;
-
 enum rmean_net_name {
 	IPROTO_SENT,
 	IPROTO_RECEIVED,
 	IPROTO_CONNECTIONS,
 	IPROTO_REQUESTS,
+	IPROTO_SHED,
 	IPROTO_LAST,
 };
 
@@ -296,30 +369,7 @@ const char *rmean_net_strings[IPROTO_LAST] = {
 	"RECEIVED",
 	"CONNECTIONS",
 	"REQUESTS",
-};
-
-static void
-tx_process_destroy(struct cmsg *m);
-
-static void
-net_finish_destroy(struct cmsg *m);
-
-static const struct cmsg_hop destroy_route[] = {
-	{ tx_process_destroy, &net_pipe },
-	{ net_finish_destroy, NULL },
-};
-
-/** Fire on_disconnect triggers in the tx thread. */
-static void
-tx_process_disconnect(struct cmsg *m);
-
-/** Send destroy message to tx thread. */
-static void
-net_finish_disconnect(struct cmsg *m);
-
-static const struct cmsg_hop disconnect_route[] = {
-	{ tx_process_disconnect, &net_pipe },
-	{ net_finish_disconnect, NULL }
+	"SHED",
 };
 
 /**
@@ -339,11 +389,142 @@ iproto_process_push(struct cmsg *m);
 static void
 tx_end_push(struct cmsg *m);
 
-static const struct cmsg_hop push_route[] = {
-	{ iproto_process_push, &tx_pipe },
-	{ tx_end_push, NULL }
+/**
+ * Context of a single network thread. Each thread runs its own
+ * event loop and owns its own cbus endpoint, memory pools,
+ * statistics and stopped connection list, so the threads never
+ * share any mutable state. Connections are distributed between
+ * the threads round-robin by accept order, see
+ * iproto_on_accept().
+ */
+struct iproto_thread {
+	/** Ordinal number of the thread, used in endpoint names. */
+	int id;
+	/** The network thread execution unit. */
+	struct cord net_cord;
+	/**
+	 * A single queue for all requests in all connections of
+	 * this thread. All requests are processed concurrently.
+	 * Is also used as a queue for just established connections and to
+	 * execute disconnect triggers. A few notes about these triggers:
+	 * - they need to be run in a fiber
+	 * - unlike an ordinary request failure, on_connect trigger
+	 *   failure must lead to connection close.
+	 * - on_connect trigger must be processed before any other
+	 *   request on this connection.
+	 */
+	struct cpipe tx_pipe;
+	/**
+	 * A second pipe to the tx thread, reserved for
+	 * IPROTO_CLASS_CONTROL requests. It is flushed right away
+	 * instead of waiting for net_flush_interval, so pings and
+	 * other cheap control traffic reach the tx thread ahead
+	 * of the batched data requests.
+	 */
+	struct cpipe tx_prio_pipe;
+	/** A pipe from the tx thread to this thread. */
+	struct cpipe net_pipe;
+	/**
+	 * A pipe from the first thread to this one, used to hand
+	 * over accepted sockets. The listening socket lives in the
+	 * first thread, which dispatches new connections to their
+	 * threads via this pipe. Unused in the first thread itself.
+	 */
+	struct cpipe accept_pipe;
+	/** Memory pool for this thread's iproto_msg objects. */
+	struct mempool iproto_msg_pool;
+	/** Memory pool for this thread's iproto_connection objects. */
+	struct mempool iproto_connection_pool;
+	/**
+	 * Connections which input was stopped because the msg limit
+	 * was reached, in strict FIFO order for fairness.
+	 */
+	struct rlist stopped_connections;
+	/**
+	 * This thread's acceptor socket. When SO_REUSEPORT is
+	 * supported and the listen address is not a unix domain
+	 * socket, every thread binds its own acceptor to the same
+	 * address and the kernel balances incoming connections
+	 * between the accept queues. Otherwise only the first
+	 * thread listens and distributes connections round-robin,
+	 * see iproto_on_accept().
+	 */
+	struct evio_service binary;
+	/** Network statistics of this thread. */
+	struct rmean *rmean;
+	/**
+	 * Fires when requests staged into tx_pipe have been
+	 * waiting for iproto_flush_interval, see
+	 * iproto_flush_input().
+	 */
+	struct ev_timer flush_timer;
+	/** Sizes of tx_pipe batches, collected at flush. */
+	struct histogram *flush_hist;
+	/** Runs on every tx_pipe flush to collect flush_hist. */
+	struct trigger on_flush;
+	/**
+	 * How many requests of each class are in flight in this
+	 * thread. A request is accounted from iproto_msg_new()
+	 * until iproto_msg_delete(), both called in this thread.
+	 */
+	int class_depth[IPROTO_CLASS_MAX];
+	/**
+	 * Request round trip times in microseconds, one HDR
+	 * histogram per priority class, collected in
+	 * net_send_msg() and read by the tx thread.
+	 */
+	struct hdr_histogram *class_hist[IPROTO_CLASS_MAX];
+#if defined(ENABLE_IOURING)
+	/**
+	 * io_uring used to batch the socket reads of this thread's
+	 * connections into a single submission syscall per event
+	 * loop iteration. Created only when net_iouring is set and
+	 * the kernel cooperates, see iproto_thread_ring_start().
+	 */
+	struct iouring ring;
+	/** True if the ring is created and reads go through it. */
+	bool ring_active;
+	/** eventfd the kernel signals on posted completions. */
+	int ring_eventfd;
+	/** Watches ring_eventfd to reap completions. */
+	struct ev_io ring_input;
+	/**
+	 * Runs at the end of every loop iteration to publish the
+	 * reads staged during it, see iproto_ring_prepare_cb().
+	 */
+	struct ev_prepare ring_prepare;
+	/** Connections with a read staged but not yet submitted. */
+	struct rlist read_queue;
+#endif
+	/*
+	 * Each message must come back to the thread that created
+	 * it, so the cmsg routes can not be static - each thread
+	 * keeps its own copies referencing its own pipes. See
+	 * iproto_thread_init_routes().
+	 */
+	struct cmsg_hop destroy_route[2];
+	struct cmsg_hop disconnect_route[2];
+	struct cmsg_hop push_route[2];
+	struct cmsg_hop misc_route[2];
+	struct cmsg_hop call_route[2];
+	struct cmsg_hop select_route[2];
+	struct cmsg_hop process1_route[2];
+	struct cmsg_hop sql_route[2];
+	struct cmsg_hop join_route[2];
+	struct cmsg_hop subscribe_route[2];
+	struct cmsg_hop error_route[2];
+	struct cmsg_hop connect_route[2];
+	/** Request routes, by request type. */
+	const struct cmsg_hop *dml_route[IPROTO_TYPE_STAT_MAX];
 };
 
+static struct iproto_thread *iproto_threads;
+int iproto_threads_count;
+/**
+ * Counter used by the first thread to distribute accepted
+ * connections between the threads round-robin.
+ */
+static int iproto_accept_counter;
 
 /* }}} */
 
@@ -516,6 +697,94 @@ struct iproto_connection
 	 *                          ...
 	 */
 	struct iproto_kharon kharon;
+	/**
+	 * Streaming decompression context. Non-NULL only after the
+	 * client has negotiated IPROTO_FEATURE_COMPRESSION with an
+	 * IPROTO_ID request. Used exclusively by the iproto thread.
+	 */
+	ZSTD_DStream *zstd_in;
+	/** Streaming compression context, @sa zstd_in. */
+	ZSTD_CStream *zstd_out;
+	/**
+	 * Staging buffer for compressed input: raw socket data is
+	 * read here and decompressed into the current ibuf.
+	 */
+	struct ibuf zin;
+	/**
+	 * Staging buffer for compressed output: output buffer
+	 * contents are compressed here before being written to the
+	 * socket.
+	 */
+	struct ibuf zout;
+	/**
+	 * Position in the output buffer right after the ID reply
+	 * which granted compression. Everything before it is sent
+	 * as is, everything after it is compressed. Valid only
+	 * when is_compress_output is set.
+	 */
+	struct iproto_wpos compress_wpos;
+	/** True if output compression has been negotiated. */
+	bool is_compress_output;
+	/**
+	 * True once everything preceding compress_wpos has been
+	 * flushed and the output has switched to the compressed
+	 * framing.
+	 */
+	bool is_compress_active;
+	/**
+	 * True if SO_ZEROCOPY is enabled on the socket and large
+	 * flushes are sent with MSG_ZEROCOPY.
+	 */
+	bool is_zerocopy;
+	/**
+	 * Sequence number of the next zerocopy send. The kernel
+	 * numbers them from 0 per socket and reports completions
+	 * with these numbers via the socket error queue.
+	 */
+	uint32_t zc_sent;
+	/** All zerocopy sends with seq < zc_acked are complete. */
+	uint32_t zc_acked;
+	/**
+	 * In-flight zerocopy sends, a FIFO ring. Each entry
+	 * remembers the flush position right after its send: once
+	 * the kernel acknowledges the send, everything before
+	 * that position may be recycled.
+	 */
+	struct {
+		uint32_t seq;
+		struct iproto_wpos wpos;
+	} zc_queue[IPROTO_ZEROCOPY_QUEUE_MAX];
+	/** Index of the oldest zc_queue entry. */
+	int zc_begin;
+	/** Number of zc_queue entries in use. */
+	int zc_count;
+	/**
+	 * The flush position reported to the tx thread for buffer
+	 * recycling instead of wpos while zerocopy sends are in
+	 * flight: the data between zc_wpos and wpos may still be
+	 * read by the kernel and must stay intact.
+	 */
+	struct iproto_wpos zc_wpos;
+#if defined(ENABLE_IOURING)
+	/**
+	 * True while a read submitted to the thread's io_uring has
+	 * not completed. The connection and the destination buffer
+	 * must stay intact until the completion arrives, even
+	 * across a close: the kernel holds a reference to the file
+	 * and posts the completion after close(2). See
+	 * iproto_connection_read_done().
+	 */
+	bool read_pending;
+	/** Link in iproto_thread::read_queue while staged. */
+	struct rlist in_read_queue;
+	/** Destination buffer of the staged read. */
+	struct ibuf *read_buf;
+	/**
+	 * The iovec handed over to the kernel. Must stay valid
+	 * until the completion, hence a connection field.
+	 */
+	struct iovec read_iov;
+#endif
 	/**
 	 * The following fields are used exclusively by the tx thread.
 	 * Align them to prevent false-sharing.
@@ -532,31 +801,55 @@ struct iproto_connection
 		 */
 		bool is_push_pending;
 	} tx;
+	/** The thread this connection is served by. */
+	struct iproto_thread *iproto_thread;
 	/** Authentication salt. */
 	char salt[IPROTO_SALT_SIZE];
 };
 
-static struct mempool iproto_connection_pool;
-static RLIST_HEAD(stopped_connections);
-
 /**
  * Return true if we have not enough spare messages
  * in the message pool.
  */
 static inline bool
-iproto_check_msg_max(void)
+iproto_check_msg_max(struct iproto_thread *iproto_thread)
 {
-	size_t request_count = mempool_count(&iproto_msg_pool);
+	size_t request_count = mempool_count(&iproto_thread->iproto_msg_pool);
 	return request_count > (size_t) iproto_msg_max;
 }
 
+static inline void
+iproto_msg_delete(struct iproto_msg *msg)
+{
+	struct iproto_thread *iproto_thread = msg->connection->iproto_thread;
+	assert(iproto_thread->class_depth[msg->msg_class] > 0);
+	iproto_thread->class_depth[msg->msg_class]--;
+	mempool_free(&iproto_thread->iproto_msg_pool, msg);
+	iproto_resume(iproto_thread);
+}
+
+/**
+ * Move a message into another priority class, keeping the
+ * per-class depth counters consistent.
+ */
+static inline void
+iproto_msg_set_class(struct iproto_msg *msg, enum iproto_msg_class msg_class)
+{
+	struct iproto_thread *iproto_thread = msg->connection->iproto_thread;
+	assert(iproto_thread->class_depth[msg->msg_class] > 0);
+	iproto_thread->class_depth[msg->msg_class]--;
+	msg->msg_class = msg_class;
+	iproto_thread->class_depth[msg_class]++;
+}
+
 static struct iproto_msg *
 iproto_msg_new(struct iproto_connection *con)
 {
+	struct mempool *pool = &con->iproto_thread->iproto_msg_pool;
 	struct iproto_msg *msg =
-		(struct iproto_msg *) mempool_alloc(&iproto_msg_pool);
+		(struct iproto_msg *) mempool_alloc(pool);
 	ERROR_INJECT(ERRINJ_TESTING, {
-		mempool_free(&iproto_msg_pool, msg);
+		mempool_free(pool, msg);
 		msg = NULL;
 	});
 	if (msg == NULL) {
@@ -567,7 +860,14 @@ iproto_msg_new(struct iproto_connection *con)
 	}
 	msg->close_connection = false;
 	msg->connection = con;
-	rmean_collect(rmean_net, IPROTO_REQUESTS, 1);
+	/*
+	 * Until the request is decoded it is control traffic:
+	 * connect and disconnect messages never leave this class.
+	 */
+	msg->msg_class = IPROTO_CLASS_CONTROL;
+	msg->enqueue_time = ev_monotonic_now(con->loop);
+	con->iproto_thread->class_depth[IPROTO_CLASS_CONTROL]++;
+	rmean_collect(con->iproto_thread->rmean, IPROTO_REQUESTS, 1);
 	return msg;
 }
 
@@ -589,6 +889,11 @@ iproto_msg_new(struct iproto_connection *con)
 static inline bool
 iproto_connection_is_idle(struct iproto_connection *con)
 {
+#if defined(ENABLE_IOURING)
+	/* The kernel still writes into the connection buffers. */
+	if (con->read_pending)
+		return false;
+#endif
 	return con->long_poll_count == 0 &&
 	       ibuf_used(&con->ibuf[0]) == 0 &&
 	       ibuf_used(&con->ibuf[1]) == 0;
@@ -622,7 +927,8 @@ iproto_connection_stop_msg_max_limit(struct iproto_connection *con)
 	 * Important to add to tail and fetch from head to ensure
 	 * strict lifo order (fairness) for stopped connections.
 	 */
-	rlist_add_tail(&stopped_connections, &con->in_stop_list);
+	rlist_add_tail(&con->iproto_thread->stopped_connections,
+		       &con->in_stop_list);
 }
 
 /**
@@ -651,7 +957,45 @@ iproto_connection_try_to_start_destroy(struct iproto_connection *con)
 	 * other parts of the connection.
 	 */
 	con->state = IPROTO_CONNECTION_DESTROYED;
-	cpipe_push(&tx_pipe, &con->destroy_msg);
+	cpipe_push(&con->iproto_thread->tx_pipe, &con->destroy_msg);
+}
+
+/**
+ * The flush position it is safe to report to the tx thread for
+ * output buffer recycling. Plain sends complete as soon as
+ * write() returns, zerocopy sends only when the kernel
+ * acknowledges them, see iproto_connection_reap_zerocopy().
+ */
+static inline struct iproto_wpos *
+iproto_connection_safe_wpos(struct iproto_connection *con)
+{
+	return con->zc_count > 0 ? &con->zc_wpos : &con->wpos;
+}
+
+/**
+ * Pop zerocopy send completions from the socket error queue and
+ * advance zc_wpos over the sends the kernel has released.
+ */
+static void
+iproto_connection_reap_zerocopy(struct iproto_connection *con)
+{
+	uint32_t lo, hi;
+	while (con->zc_count > 0 &&
+	       sio_zerocopy_completion(con->output.fd, &lo, &hi) > 0) {
+		con->zc_acked = hi + 1;
+		while (con->zc_count > 0) {
+			uint32_t seq = con->zc_queue[con->zc_begin].seq;
+			/* Mind the sequence number wraparound. */
+			if ((int32_t) (seq - con->zc_acked) >= 0)
+				break;
+			con->zc_wpos = con->zc_queue[con->zc_begin].wpos;
+			con->zc_begin = (con->zc_begin + 1) %
+					IPROTO_ZEROCOPY_QUEUE_MAX;
+			con->zc_count--;
+		}
+	}
+	if (con->zc_count == 0)
+		con->zc_wpos = con->wpos;
 }
 
 /**
@@ -667,9 +1011,36 @@ iproto_connection_close(struct iproto_connection *con)
 		ev_io_stop(con->loop, &con->input);
 		ev_io_stop(con->loop, &con->output);
 
+#if defined(ENABLE_IOURING)
+		/*
+		 * A staged but not yet submitted read will never
+		 * complete - drop it. A submitted one is left
+		 * pending and delays the destroy until its
+		 * completion arrives.
+		 */
+		if (!rlist_empty(&con->in_read_queue)) {
+			rlist_del(&con->in_read_queue);
+			con->read_pending = false;
+		}
+#endif
+		if (con->zc_count > 0)
+			iproto_connection_reap_zerocopy(con);
 		int fd = con->input.fd;
 		/* Make evio_has_fd() happy */
 		con->input.fd = con->output.fd = -1;
+		if (con->zc_count > 0) {
+			/*
+			 * The kernel still reads the output
+			 * buffers of this connection, but they
+			 * are about to be recycled. Abort the
+			 * connection so that the kernel drops the
+			 * references instead of transmitting
+			 * whatever lands in that memory later.
+			 */
+			struct linger ling = { 1, 0 };
+			setsockopt(fd, SOL_SOCKET, SO_LINGER, &ling,
+				   sizeof(ling));
+		}
 		close(fd);
 		/*
 		 * Discard unparsed data, to recycle the
@@ -678,7 +1049,7 @@ iproto_connection_close(struct iproto_connection *con)
 		 * is done only once.
 		 */
 		con->p_ibuf->wpos -= con->parse_size;
-		cpipe_push(&tx_pipe, &con->disconnect_msg);
+		cpipe_push(&con->iproto_thread->tx_pipe, &con->disconnect_msg);
 		assert(con->state == IPROTO_CONNECTION_ALIVE);
 		con->state = IPROTO_CONNECTION_CLOSED;
 	} else if (con->state == IPROTO_CONNECTION_PENDING_DESTROY) {
@@ -793,6 +1164,58 @@ iproto_connection_input_buffer(struct iproto_connection *con)
 	return new_ibuf;
 }
 
+/** Flush the request batch the flush timer has been armed for. */
+static void
+iproto_flush_timer_cb(ev_loop *loop, struct ev_timer *watcher, int events)
+{
+	(void) loop;
+	(void) events;
+	struct iproto_thread *iproto_thread =
+		(struct iproto_thread *) watcher->data;
+	cpipe_flush_input(&iproto_thread->tx_pipe);
+}
+
+/**
+ * A tx_pipe on_flush trigger: account the achieved batch size
+ * and disarm the flush timer - its batch is on the bus now.
+ */
+static int
+iproto_on_flush_cb(struct trigger *trigger, void *event)
+{
+	struct iproto_thread *iproto_thread =
+		(struct iproto_thread *) trigger->data;
+	struct cpipe *pipe = (struct cpipe *) event;
+	assert(pipe == &iproto_thread->tx_pipe);
+	histogram_collect(iproto_thread->flush_hist, pipe->n_input);
+	ev_timer_stop(loop(), &iproto_thread->flush_timer);
+	return 0;
+}
+
+/**
+ * Flush the requests staged into tx_pipe. When a flush interval
+ * is set, the flush is deferred until the interval has passed
+ * since the first request was staged, so that requests read on
+ * subsequent event loop iterations coalesce into one cross-thread
+ * wakeup. cpipe_push_input() still delivers right away when the
+ * staged input outgrows the pipe limit, so the deferral can not
+ * pile up more than max_input requests.
+ */
+static void
+iproto_flush_input(struct iproto_thread *iproto_thread)
+{
+	/* Control traffic is never deferred. */
+	cpipe_flush_input(&iproto_thread->tx_prio_pipe);
+	if (iproto_flush_interval <= 0) {
+		cpipe_flush_input(&iproto_thread->tx_pipe);
+		return;
+	}
+	if (iproto_thread->tx_pipe.n_input == 0 ||
+	    ev_is_active(&iproto_thread->flush_timer))
+		return;
+	ev_timer_set(&iproto_thread->flush_timer, iproto_flush_interval, 0.);
+	ev_timer_start(loop(), &iproto_thread->flush_timer);
+}
+
 /**
  * Enqueue all requests which were read up. If a request limit is
  * reached - stop the connection input even if not the whole batch
@@ -808,13 +1231,14 @@ static inline int
 iproto_enqueue_batch(struct iproto_connection *con, struct ibuf *in)
 {
 	assert(rlist_empty(&con->in_stop_list));
+	struct iproto_thread *iproto_thread = con->iproto_thread;
 	int n_requests = 0;
 	bool stop_input = false;
 	const char *errmsg;
 	while (con->parse_size != 0 && !stop_input) {
-		if (iproto_check_msg_max()) {
+		if (iproto_check_msg_max(iproto_thread)) {
 			iproto_connection_stop_msg_max_limit(con);
-			cpipe_flush_input(&tx_pipe);
+			iproto_flush_input(iproto_thread);
 			return 0;
 		}
 		const char *reqstart = in->wpos - con->parse_size;
@@ -823,7 +1247,7 @@ iproto_enqueue_batch(struct iproto_connection *con, struct ibuf *in)
 		if (mp_typeof(*pos) != MP_UINT) {
 			errmsg = "packet length";
 err_msgpack:
-			cpipe_flush_input(&tx_pipe);
+			iproto_flush_input(iproto_thread);
 			diag_set(ClientError, ER_INVALID_MSGPACK,
 				 errmsg);
 			return -1;
@@ -850,16 +1274,23 @@ err_msgpack:
 			return 0;
 		}
 		msg->p_ibuf = con->p_ibuf;
-		msg->wpos = con->wpos;
+		msg->wpos = *iproto_connection_safe_wpos(con);
 
 		msg->len = reqend - reqstart; /* total request length */
 
 		iproto_msg_decode(msg, &pos, reqend, &stop_input);
 		/*
 		 * This can't throw, but should not be
-		 * done in case of exception.
+		 * done in case of exception. Control requests
+		 * travel via the priority pipe, which is flushed
+		 * ahead of the batched data traffic.
 		 */
-		cpipe_push_input(&tx_pipe, &msg->base);
+		if (msg->msg_class == IPROTO_CLASS_CONTROL) {
+			cpipe_push_input(&iproto_thread->tx_prio_pipe,
+					 &msg->base);
+		} else {
+			cpipe_push_input(&iproto_thread->tx_pipe, &msg->base);
+		}
 		n_requests++;
 		/* Request is parsed */
 		assert(reqend > reqstart);
@@ -877,12 +1308,15 @@ err_msgpack:
 		 */
 		ev_io_stop(con->loop, &con->output);
 		ev_io_stop(con->loop, &con->input);
-	} else if (n_requests != 1 || con->parse_size != 0) {
+	} else if (n_requests != 1 || con->parse_size != 0 ||
+		   ibuf_used(&con->zin) != 0) {
 		/*
 		 * Keep reading input, as long as the socket
 		 * supplies data, but don't waste CPU on an extra
 		 * read() if dealing with a blocking client, it
-		 * has nothing in the socket for us.
+		 * has nothing in the socket for us. Compressed
+		 * input pending in the staging buffer is treated
+		 * the same as unparsed data.
 		 *
 		 * We look at the amount of enqueued requests
 		 * and presence of a partial request in the
@@ -897,7 +1331,7 @@ err_msgpack:
 		 */
 		ev_feed_event(con->loop, &con->input, EV_READ);
 	}
-	cpipe_flush_input(&tx_pipe);
+	iproto_flush_input(iproto_thread);
 	return 0;
 }
 
@@ -909,7 +1343,7 @@ err_msgpack:
 static void
 iproto_connection_resume(struct iproto_connection *con)
 {
-	assert(! iproto_check_msg_max());
+	assert(! iproto_check_msg_max(con->iproto_thread));
 	rlist_del(&con->in_stop_list);
 	/*
 	 * Enqueue_batch() stops the connection again, if the
@@ -933,21 +1367,82 @@ iproto_connection_resume(struct iproto_connection *con)
  * necessary to use up the limit.
  */
 static void
-iproto_resume(void)
+iproto_resume(struct iproto_thread *iproto_thread)
 {
-	while (!iproto_check_msg_max() && !rlist_empty(&stopped_connections)) {
+	while (!iproto_check_msg_max(iproto_thread) &&
+	       !rlist_empty(&iproto_thread->stopped_connections)) {
 		/*
 		 * Shift from list head to ensure strict FIFO
 		 * (fairness) for resumed connections.
 		 */
 		struct iproto_connection *con =
-			rlist_first_entry(&stopped_connections,
+			rlist_first_entry(&iproto_thread->stopped_connections,
 					  struct iproto_connection,
 					  in_stop_list);
 		iproto_connection_resume(con);
 	}
 }
 
+/**
+ * Decompress as much of the staged compressed input as fits into
+ * the current input buffer. Advances parse_size over the
+ * produced bytes so that they can be parsed as usual.
+ *
+ * @retval >= 0 Number of bytes produced.
+ * @retval   -1 The compressed stream is corrupt.
+ */
+static ssize_t
+iproto_decompress_input(struct iproto_connection *con, struct ibuf *in)
+{
+	ssize_t total = 0;
+	while (ibuf_used(&con->zin) > 0 && ibuf_unused(in) > 0) {
+		ZSTD_inBuffer src = { con->zin.rpos, ibuf_used(&con->zin), 0 };
+		ZSTD_outBuffer dst = { in->wpos, ibuf_unused(in), 0 };
+		size_t rc = ZSTD_decompressStream(con->zstd_in, &dst, &src);
+		if (ZSTD_isError(rc)) {
+			diag_set(ClientError, ER_DECOMPRESSION,
+				 ZSTD_getErrorName(rc));
+			return -1;
+		}
+		if (src.pos == 0 && dst.pos == 0)
+			break;
+		con->zin.rpos += src.pos;
+		in->wpos += dst.pos;
+		con->parse_size += dst.pos;
+		total += dst.pos;
+	}
+	if (ibuf_used(&con->zin) == 0)
+		ibuf_reset(&con->zin);
+	return total;
+}
+
+#if defined(ENABLE_IOURING)
+/**
+ * Stage a read for submission at the end of this event loop
+ * iteration instead of issuing a read() right away. All reads
+ * staged during one iteration reach the kernel with a single
+ * io_uring_enter(), see iproto_ring_prepare_cb().
+ */
+static void
+iproto_connection_stage_read(struct iproto_connection *con, struct ibuf *in)
+{
+	assert(!con->read_pending);
+	struct ibuf *buf = in;
+	if (con->zstd_in != NULL) {
+		/* Compressed input is read into the staging buffer. */
+		if (ibuf_reserve(&con->zin, iproto_readahead) == NULL)
+			tnt_raise(OutOfMemory, iproto_readahead,
+				  "ibuf_reserve", "zin");
+		buf = &con->zin;
+	}
+	con->read_buf = buf;
+	con->read_iov.iov_base = buf->wpos;
+	con->read_iov.iov_len = ibuf_unused(buf);
+	con->read_pending = true;
+	rlist_add_tail(&con->iproto_thread->read_queue, &con->in_read_queue);
+}
+#endif
+
 static void
 iproto_connection_on_input(ev_loop *loop, struct ev_io *watcher,
 			   int /* revents */)
@@ -958,12 +1453,17 @@ iproto_connection_on_input(ev_loop *loop, struct ev_io *watcher,
 	assert(fd >= 0);
 	assert(rlist_empty(&con->in_stop_list));
 	assert(loop == con->loop);
+#if defined(ENABLE_IOURING)
+	/* The completion of the pending read drives the input. */
+	if (con->read_pending)
+		return;
+#endif
 	/*
 	 * Throttle if there are too many pending requests,
 	 * otherwise we might deplete the fiber pool in tx
 	 * thread and deadlock.
 	 */
-	if (iproto_check_msg_max()) {
+	if (iproto_check_msg_max(con->iproto_thread)) {
 		iproto_connection_stop_msg_max_limit(con);
 		return;
 	}
@@ -975,24 +1475,140 @@ iproto_connection_on_input(ev_loop *loop, struct ev_io *watcher,
 			iproto_connection_stop_readahead_limit(con);
 			return;
 		}
-		/* Read input. */
-		int nrd = sio_read(fd, in->wpos, ibuf_unused(in));
-		if (nrd < 0) {                  /* Socket is not ready. */
-			if (! sio_wouldblock(errno))
-				diag_raise();
-			ev_io_start(loop, &con->input);
+#if defined(ENABLE_IOURING)
+		if (con->iproto_thread->ring_active) {
+			iproto_connection_stage_read(con, in);
 			return;
 		}
-		if (nrd == 0) {                 /* EOF */
+#endif
+		if (con->zstd_in == NULL) {
+			/* Read input. */
+			int nrd = sio_read(fd, in->wpos, ibuf_unused(in));
+			if (nrd < 0) {          /* Socket is not ready. */
+				if (! sio_wouldblock(errno))
+					diag_raise();
+				ev_io_start(loop, &con->input);
+				return;
+			}
+			if (nrd == 0) {         /* EOF */
+				iproto_connection_close(con);
+				return;
+			}
+			/* Count statistics */
+			rmean_collect(con->iproto_thread->rmean,
+				      IPROTO_RECEIVED, nrd);
+
+			/* Update the read position and connection state. */
+			in->wpos += nrd;
+			con->parse_size += nrd;
+		} else {
+			/*
+			 * Read the compressed stream into the
+			 * staging buffer and decompress it into the
+			 * input buffer.
+			 */
+			if (ibuf_reserve(&con->zin, iproto_readahead) == NULL)
+				tnt_raise(OutOfMemory, iproto_readahead,
+					  "ibuf_reserve", "zin");
+			int nrd = sio_read(fd, con->zin.wpos,
+					   ibuf_unused(&con->zin));
+			if (nrd < 0 && ! sio_wouldblock(errno))
+				diag_raise();
+			if (nrd == 0) {         /* EOF */
+				iproto_connection_close(con);
+				return;
+			}
+			if (nrd > 0) {
+				rmean_collect(con->iproto_thread->rmean,
+					      IPROTO_RECEIVED, nrd);
+				con->zin.wpos += nrd;
+			}
+			ssize_t ndec = iproto_decompress_input(con, in);
+			if (ndec < 0)
+				diag_raise();
+			if (nrd < 0 && ndec == 0) {
+				/* No new data whatsoever. */
+				ev_io_start(loop, &con->input);
+				return;
+			}
+		}
+		/* Enqueue all requests which are fully read up. */
+		if (iproto_enqueue_batch(con, in) != 0)
+			diag_raise();
+	} catch (Exception *e) {
+		/* Best effort at sending the error message to the client. */
+		iproto_write_error(fd, e, ::schema_version, 0);
+		e->log();
+		iproto_connection_close(con);
+	}
+}
+
+#if defined(ENABLE_IOURING)
+/**
+ * Completion of a submitted read, the io_uring counterpart of
+ * iproto_connection_on_input() after its sio_read(). @a res is
+ * the readv() result, a negated errno on failure.
+ */
+static void
+iproto_connection_read_done(struct iproto_connection *con, int res)
+{
+	assert(con->read_pending);
+	con->read_pending = false;
+	struct ibuf *buf = con->read_buf;
+	con->read_buf = NULL;
+	if (con->state != IPROTO_CONNECTION_ALIVE) {
+		/*
+		 * Closed while the read was in flight. Drop the
+		 * result and let the delayed destroy proceed.
+		 */
+		if (con->state == IPROTO_CONNECTION_PENDING_DESTROY)
+			iproto_connection_try_to_start_destroy(con);
+		return;
+	}
+	int fd = con->input.fd;
+	/*
+	 * Kernels which predate io_uring readiness polling may
+	 * complete a read of an empty socket with EAGAIN - fall
+	 * back to waiting on the input watcher then.
+	 */
+	bool again = res == -EAGAIN || res == -EWOULDBLOCK || res == -EINTR;
+	try {
+		if (res < 0 && !again) {
+			errno = -res;
+			tnt_raise(SocketError, sio_socketname(fd), "readv");
+		}
+		if (res == 0) {		/* EOF */
 			iproto_connection_close(con);
 			return;
 		}
-		/* Count statistics */
-		rmean_collect(rmean_net, IPROTO_RECEIVED, nrd);
-
-		/* Update the read position and connection state. */
-		in->wpos += nrd;
-		con->parse_size += nrd;
+		if (res > 0) {
+			rmean_collect(con->iproto_thread->rmean,
+				      IPROTO_RECEIVED, res);
+			buf->wpos += res;
+		}
+		struct ibuf *in;
+		if (buf == &con->zin) {
+			in = iproto_connection_input_buffer(con);
+			if (in == NULL) {
+				iproto_connection_stop_readahead_limit(con);
+				return;
+			}
+			ssize_t ndec = iproto_decompress_input(con, in);
+			if (ndec < 0)
+				diag_raise();
+			if (res < 0 && ndec == 0) {
+				/* No new data whatsoever. */
+				ev_io_start(con->loop, &con->input);
+				return;
+			}
+		} else {
+			in = buf;
+			if (res < 0) {
+				ev_io_start(con->loop, &con->input);
+				return;
+			}
+			con->parse_size += res;
+		}
 		/* Enqueue all requests which are fully read up. */
 		if (iproto_enqueue_batch(con, in) != 0)
 			diag_raise();
@@ -1004,6 +1620,169 @@ iproto_connection_on_input(ev_loop *loop, struct ev_io *watcher,
 	}
 }
 
+/** Reap and process all posted read completions. */
+static void
+iproto_ring_reap(struct iproto_thread *iproto_thread)
+{
+	struct io_uring_cqe *cqe;
+	while ((cqe = iouring_peek_cqe(&iproto_thread->ring)) != NULL) {
+		struct iproto_connection *con = (struct iproto_connection *)
+			(uintptr_t) cqe->user_data;
+		int res = cqe->res;
+		iouring_cqe_seen(&iproto_thread->ring);
+		iproto_connection_read_done(con, res);
+	}
+}
+
+/** The ring eventfd is readable - completions have been posted. */
+static void
+iproto_ring_on_event(ev_loop *loop, struct ev_io *watcher, int /* revents */)
+{
+	(void) loop;
+	struct iproto_thread *iproto_thread =
+		(struct iproto_thread *) watcher->data;
+	uint64_t count;
+	while (read(watcher->fd, &count, sizeof(count)) > 0)
+		;
+	iproto_ring_reap(iproto_thread);
+}
+
+/**
+ * Runs at the end of every event loop iteration: publish all
+ * reads staged during the iteration with a single
+ * io_uring_enter() and process the completions which are already
+ * there - a read from a socket with pending data completes
+ * inline, without waiting for the eventfd roundtrip.
+ */
+static void
+iproto_ring_prepare_cb(ev_loop *loop, struct ev_prepare *watcher,
+		       int /* revents */)
+{
+	(void) loop;
+	struct iproto_thread *iproto_thread =
+		(struct iproto_thread *) watcher->data;
+	if (rlist_empty(&iproto_thread->read_queue))
+		return;
+	struct iproto_connection *con;
+	while (!rlist_empty(&iproto_thread->read_queue)) {
+		con = rlist_first_entry(&iproto_thread->read_queue,
+					struct iproto_connection,
+					in_read_queue);
+		if (iouring_prep_readv(&iproto_thread->ring, con->input.fd,
+				       &con->read_iov, 1,
+				       (uint64_t) (uintptr_t) con) != 0) {
+			/*
+			 * The ring is full. The rest stays staged:
+			 * reaping the inevitable completions frees
+			 * submission entries and wakes the loop up
+			 * for another pass.
+			 */
+			break;
+		}
+		rlist_del(&con->in_read_queue);
+	}
+	if (iouring_submit(&iproto_thread->ring) < 0) {
+		/*
+		 * Must not happen with a sane ring. Fall back to
+		 * plain reads for good rather than spin on a
+		 * broken submission queue.
+		 */
+		diag_log();
+		say_warn("io_uring submission failed, falling back to "
+			 "plain socket reads");
+		iproto_thread->ring_active = false;
+		while (!rlist_empty(&iproto_thread->read_queue)) {
+			con = rlist_first_entry(&iproto_thread->read_queue,
+						struct iproto_connection,
+						in_read_queue);
+			rlist_del(&con->in_read_queue);
+			con->read_pending = false;
+			ev_feed_event(con->loop, &con->input, EV_READ);
+		}
+		return;
+	}
+	iproto_ring_reap(iproto_thread);
+}
+#endif /* defined(ENABLE_IOURING) */
+
+/**
+ * Write the compressed output staging buffer to the socket.
+ * @retval  0 The buffer is fully flushed.
+ * @retval -1 The socket is not ready, try again later.
+ */
+static int
+iproto_flush_zout(struct iproto_connection *con)
+{
+	struct ibuf *zout = &con->zout;
+	ssize_t nwr = sio_write(con->output.fd, zout->rpos, ibuf_used(zout));
+	if (nwr > 0) {
+		/* Count statistics */
+		rmean_collect(con->iproto_thread->rmean, IPROTO_SENT, nwr);
+		zout->rpos += nwr;
+		if (ibuf_used(zout) == 0) {
+			ibuf_reset(zout);
+			return 0;
+		}
+	} else if (nwr < 0 && ! sio_wouldblock(errno)) {
+		diag_raise();
+	}
+	return -1;
+}
+
+/**
+ * Compress a range of output buffer data, given as an iovec,
+ * into the compressed output staging buffer. The zstd stream is
+ * flushed afterwards so that the client can decode every
+ * complete reply it receives.
+ *
+ * @retval  0 Success.
+ * @retval -1 Memory or compression error.
+ */
+static int
+iproto_compress_obuf(struct iproto_connection *con, struct iovec *iov,
+		     int iovcnt)
+{
+	struct ibuf *zout = &con->zout;
+	for (int i = 0; i < iovcnt; i++) {
+		ZSTD_inBuffer src = { iov[i].iov_base, iov[i].iov_len, 0 };
+		while (src.pos < src.size) {
+			size_t bound = ZSTD_compressBound(src.size - src.pos);
+			if (ibuf_reserve(zout, bound) == NULL) {
+				diag_set(OutOfMemory, bound, "ibuf_reserve",
+					 "zout");
+				return -1;
+			}
+			ZSTD_outBuffer dst = { zout->wpos,
+					       ibuf_unused(zout), 0 };
+			size_t rc = ZSTD_compressStream(con->zstd_out,
+							&dst, &src);
+			if (ZSTD_isError(rc)) {
+				diag_set(ClientError, ER_COMPRESSION,
+					 ZSTD_getErrorName(rc));
+				return -1;
+			}
+			zout->wpos += dst.pos;
+		}
+	}
+	size_t rc;
+	do {
+		size_t bound = ZSTD_compressBound(0);
+		if (ibuf_reserve(zout, bound) == NULL) {
+			diag_set(OutOfMemory, bound, "ibuf_reserve", "zout");
+			return -1;
+		}
+		ZSTD_outBuffer dst = { zout->wpos, ibuf_unused(zout), 0 };
+		rc = ZSTD_flushStream(con->zstd_out, &dst);
+		if (ZSTD_isError(rc)) {
+			diag_set(ClientError, ER_COMPRESSION,
+				 ZSTD_getErrorName(rc));
+			return -1;
+		}
+		zout->wpos += dst.pos;
+	} while (rc > 0);
+	return 0;
+}
+
 /** writev() to the socket and handle the result. */
 
 static int
@@ -1014,6 +1793,13 @@ iproto_flush(struct iproto_connection *con)
 	struct obuf_svp obuf_end = obuf_create_svp(obuf);
 	struct obuf_svp *begin = &con->wpos.svp;
 	struct obuf_svp *end = &con->wend.svp;
+	if (con->zc_count > 0)
+		iproto_connection_reap_zerocopy(con);
+	if (con->is_compress_active && ibuf_used(&con->zout) > 0) {
+		/* Finish writing already compressed data first. */
+		if (iproto_flush_zout(con) != 0)
+			return -1;
+	}
 	if (con->wend.obuf != obuf) {
 		/*
 		 * Flush the current buffer before
@@ -1026,6 +1812,24 @@ iproto_flush(struct iproto_connection *con)
 			end = &obuf_end;
 		}
 	}
+	if (con->is_compress_output && !con->is_compress_active) {
+		if (obuf != con->compress_wpos.obuf) {
+			/*
+			 * The buffer holding the ID reply is left
+			 * behind, hence fully flushed. Since there
+			 * are only two rotating buffers, it can
+			 * not be ahead of the flush position.
+			 */
+			if (obuf == con->wend.obuf)
+				con->is_compress_active = true;
+		} else if (begin->used >= con->compress_wpos.svp.used) {
+			/* The ID reply has been sent as is. */
+			con->is_compress_active = true;
+		} else if (end->used > con->compress_wpos.svp.used) {
+			/* Send everything up to the ID reply as is. */
+			end = &con->compress_wpos.svp;
+		}
+	}
 	if (begin->used == end->used) {
 		/* Nothing to do. */
 		return 1;
@@ -1043,22 +1847,63 @@ iproto_flush(struct iproto_connection *con)
 	/* *Overwrite* iov_len of the last pos as it may be garbage. */
 	iov[iovcnt-1].iov_len = end->iov_len - begin->iov_len * (iovcnt == 1);
 
-	ssize_t nwr = sio_writev(fd, iov, iovcnt);
+	if (con->is_compress_active) {
+		if (iproto_compress_obuf(con, iov, iovcnt) != 0)
+			diag_raise();
+		/*
+		 * The raw bytes are consumed into zout - advance
+		 * the flush position over them right away.
+		 */
+		*begin = *end;
+		return iproto_flush_zout(con);
+	}
+
+	/*
+	 * Large flushes may be sent without copying into the
+	 * socket buffers. The sent range then must stay intact
+	 * until the kernel acknowledges the transmission, which
+	 * is what the zc_queue entry recorded below ensures.
+	 */
+	bool zerocopy = con->is_zerocopy &&
+		end->used - begin->used >= IPROTO_ZEROCOPY_THRESHOLD &&
+		con->zc_count < IPROTO_ZEROCOPY_QUEUE_MAX;
+	ssize_t nwr;
+	if (zerocopy) {
+		nwr = sio_writev_zerocopy(fd, iov, iovcnt);
+		if (nwr < 0 && errno == ENOBUFS) {
+			/* The kernel can not pin more pages. */
+			zerocopy = false;
+			nwr = sio_writev(fd, iov, iovcnt);
+		}
+	} else {
+		nwr = sio_writev(fd, iov, iovcnt);
+	}
 
 	if (nwr > 0) {
 		/* Count statistics */
-		rmean_collect(rmean_net, IPROTO_SENT, nwr);
+		rmean_collect(con->iproto_thread->rmean, IPROTO_SENT, nwr);
+		int rc = -1;
 		if (begin->used + nwr == end->used) {
 			*begin = *end;
-			return 0;
+			rc = 0;
+		} else {
+			size_t offset = 0;
+			int advance = 0;
+			advance = sio_move_iov(iov, nwr, &offset);
+			begin->used += nwr;     /* advance write position */
+			begin->iov_len = advance == 0 ?
+					 begin->iov_len + offset : offset;
+			begin->pos += advance;
+			assert(begin->pos <= end->pos);
+		}
+		if (zerocopy) {
+			int i = (con->zc_begin + con->zc_count) %
+				IPROTO_ZEROCOPY_QUEUE_MAX;
+			con->zc_queue[i].seq = con->zc_sent++;
+			con->zc_queue[i].wpos = con->wpos;
+			con->zc_count++;
 		}
-		size_t offset = 0;
-		int advance = 0;
-		advance = sio_move_iov(iov, nwr, &offset);
-		begin->used += nwr;             /* advance write position */
-		begin->iov_len = advance == 0 ? begin->iov_len + offset: offset;
-		begin->pos += advance;
-		assert(begin->pos <= end->pos);
+		return rc;
 	} else if (nwr < 0 && ! sio_wouldblock(errno)) {
 		diag_raise();
 	}
@@ -1092,14 +1937,15 @@ iproto_connection_on_output(ev_loop *loop, struct ev_io *watcher,
 }
 
 static struct iproto_connection *
-iproto_connection_new(int fd)
+iproto_connection_new(struct iproto_thread *iproto_thread, int fd)
 {
 	struct iproto_connection *con = (struct iproto_connection *)
-		mempool_alloc(&iproto_connection_pool);
+		mempool_alloc(&iproto_thread->iproto_connection_pool);
 	if (con == NULL) {
 		diag_set(OutOfMemory, sizeof(*con), "mempool_alloc", "con");
 		return NULL;
 	}
+	con->iproto_thread = iproto_thread;
 	con->input.data = con->output.data = con;
 	con->loop = loop();
 	ev_io_init(&con->input, iproto_connection_on_input, fd, EV_READ);
@@ -1108,21 +1954,38 @@ iproto_connection_new(int fd)
 	ibuf_create(&con->ibuf[1], cord_slab_cache(), iproto_readahead);
 	obuf_create(&con->obuf[0], &net_slabc, iproto_readahead);
 	obuf_create(&con->obuf[1], &net_slabc, iproto_readahead);
+	ibuf_create(&con->zin, cord_slab_cache(), iproto_readahead);
+	ibuf_create(&con->zout, cord_slab_cache(), iproto_readahead);
+	con->zstd_in = NULL;
+	con->zstd_out = NULL;
+	con->is_compress_output = false;
+	con->is_compress_active = false;
+	con->is_zerocopy = iproto_zerocopy && sio_enable_zerocopy(fd) == 0;
+	con->zc_sent = 0;
+	con->zc_acked = 0;
+	con->zc_begin = 0;
+	con->zc_count = 0;
 	con->p_ibuf = &con->ibuf[0];
 	con->tx.p_obuf = &con->obuf[0];
 	iproto_wpos_create(&con->wpos, con->tx.p_obuf);
 	iproto_wpos_create(&con->wend, con->tx.p_obuf);
+	iproto_wpos_create(&con->zc_wpos, con->tx.p_obuf);
 	con->parse_size = 0;
 	con->long_poll_count = 0;
 	con->session = NULL;
 	rlist_create(&con->in_stop_list);
+#if defined(ENABLE_IOURING)
+	con->read_pending = false;
+	con->read_buf = NULL;
+	rlist_create(&con->in_read_queue);
+#endif
 	/* It may be very awkward to allocate at close. */
-	cmsg_init(&con->destroy_msg, destroy_route);
-	cmsg_init(&con->disconnect_msg, disconnect_route);
+	cmsg_init(&con->destroy_msg, iproto_thread->destroy_route);
+	cmsg_init(&con->disconnect_msg, iproto_thread->disconnect_route);
 	con->state = IPROTO_CONNECTION_ALIVE;
 	con->tx.is_push_pending = false;
 	con->tx.is_push_sent = false;
-	rmean_collect(rmean_net, IPROTO_CONNECTIONS, 1);
+	rmean_collect(iproto_thread->rmean, IPROTO_CONNECTIONS, 1);
 	return con;
 }
 
@@ -1141,11 +2004,15 @@ iproto_connection_delete(struct iproto_connection *con)
 	 */
 	ibuf_destroy(&con->ibuf[0]);
 	ibuf_destroy(&con->ibuf[1]);
+	ibuf_destroy(&con->zin);
+	ibuf_destroy(&con->zout);
+	ZSTD_freeDStream(con->zstd_in);
+	ZSTD_freeCStream(con->zstd_out);
 	assert(con->obuf[0].pos == 0 &&
 	       con->obuf[0].iov[0].iov_base == NULL);
 	assert(con->obuf[1].pos == 0 &&
 	       con->obuf[1].iov[0].iov_base == NULL);
-	mempool_free(&iproto_connection_pool, con);
+	mempool_free(&con->iproto_thread->iproto_connection_pool, con);
 }
 
 /* }}} iproto_connection */
@@ -1188,72 +2055,67 @@ net_end_join(struct cmsg *msg);
 static void
 net_end_subscribe(struct cmsg *msg);
 
-static const struct cmsg_hop misc_route[] = {
-	{ tx_process_misc, &net_pipe },
-	{ net_send_msg, NULL },
-};
-
-static const struct cmsg_hop call_route[] = {
-	{ tx_process_call, &net_pipe },
-	{ net_send_msg, NULL },
-};
-
-static const struct cmsg_hop select_route[] = {
-	{ tx_process_select, &net_pipe },
-	{ net_send_msg, NULL },
-};
-
-static const struct cmsg_hop process1_route[] = {
-	{ tx_process1, &net_pipe },
-	{ net_send_msg, NULL },
-};
-
-static const struct cmsg_hop sql_route[] = {
-	{ tx_process_sql, &net_pipe },
-	{ net_send_msg, NULL },
-};
-
-static const struct cmsg_hop *dml_route[IPROTO_TYPE_STAT_MAX] = {
-	NULL,                                   /* IPROTO_OK */
-	select_route,                           /* IPROTO_SELECT */
-	process1_route,                         /* IPROTO_INSERT */
-	process1_route,                         /* IPROTO_REPLACE */
-	process1_route,                         /* IPROTO_UPDATE */
-	process1_route,                         /* IPROTO_DELETE */
-	call_route,                             /* IPROTO_CALL_16 */
-	misc_route,                             /* IPROTO_AUTH */
-	call_route,                             /* IPROTO_EVAL */
-	process1_route,                         /* IPROTO_UPSERT */
-	call_route,                             /* IPROTO_CALL */
-	sql_route,                              /* IPROTO_EXECUTE */
-	NULL,                                   /* IPROTO_NOP */
-	sql_route,                              /* IPROTO_PREPARE */
-};
-
-static const struct cmsg_hop join_route[] = {
-	{ tx_process_replication, &net_pipe },
-	{ net_end_join, NULL },
-};
-
-static const struct cmsg_hop subscribe_route[] = {
-	{ tx_process_replication, &net_pipe },
-	{ net_end_subscribe, NULL },
-};
-
-static const struct cmsg_hop error_route[] = {
-	{ tx_reply_iproto_error, &net_pipe },
-	{ net_send_error, NULL },
-};
+/**
+ * Turn on streaming compression for a connection which has
+ * negotiated it. Called right after the ID request is parsed:
+ * everything the client sends after that request belongs to the
+ * compressed stream, so the bytes already read past @a reqend
+ * are moved into the compressed input staging buffer.
+ *
+ * @retval  0 Success.
+ * @retval -1 Memory error, the feature must not be granted.
+ */
+static int
+iproto_connection_enable_compression(struct iproto_connection *con,
+				     const char *reqend)
+{
+	if (con->zstd_in != NULL)
+		return 0;
+	con->zstd_in = ZSTD_createDStream();
+	con->zstd_out = ZSTD_createCStream();
+	if (con->zstd_in == NULL || con->zstd_out == NULL) {
+		ZSTD_freeDStream(con->zstd_in);
+		ZSTD_freeCStream(con->zstd_out);
+		con->zstd_in = NULL;
+		con->zstd_out = NULL;
+		diag_set(ClientError, ER_COMPRESSION,
+			 "failed to create context");
+		return -1;
+	}
+	ZSTD_initDStream(con->zstd_in);
+	ZSTD_initCStream(con->zstd_out, IPROTO_ZSTD_LEVEL);
+	struct ibuf *in = con->p_ibuf;
+	size_t trailing = in->wpos - reqend;
+	if (trailing > 0) {
+		void *dst = ibuf_alloc(&con->zin, trailing);
+		if (dst == NULL) {
+			ZSTD_freeDStream(con->zstd_in);
+			ZSTD_freeCStream(con->zstd_out);
+			con->zstd_in = NULL;
+			con->zstd_out = NULL;
+			diag_set(OutOfMemory, trailing, "ibuf_alloc", "zin");
+			return -1;
+		}
+		memcpy(dst, reqend, trailing);
+		in->wpos -= trailing;
+		assert(con->parse_size >= trailing);
+		con->parse_size -= trailing;
+	}
+	return 0;
+}
 
 static void
 iproto_msg_decode(struct iproto_msg *msg, const char **pos, const char *reqend,
 		  bool *stop_input)
 {
+	struct iproto_thread *iproto_thread = msg->connection->iproto_thread;
 	uint8_t type;
 
 	if (xrow_header_decode(&msg->header, pos, reqend, true))
 		goto error;
 	assert(*pos == reqend);
+	flightrec_record(FLIGHTREC_IPROTO_RECV, msg->header.sync, msg->len);
+	TNT_PROBE2(request_recv, msg->header.sync, msg->len);
 
 	type = msg->header.type;
 
@@ -1272,56 +2134,99 @@ iproto_msg_decode(struct iproto_msg *msg, const char **pos, const char *reqend,
 		if (xrow_decode_dml(&msg->header, &msg->dml,
 				    dml_request_key_map(type)))
 			goto error;
-		assert(type < sizeof(dml_route)/sizeof(*dml_route));
-		cmsg_init(&msg->base, dml_route[type]);
+		assert(type < sizeof(iproto_thread->dml_route) /
+			      sizeof(*iproto_thread->dml_route));
+		cmsg_init(&msg->base, iproto_thread->dml_route[type]);
+		iproto_msg_set_class(msg, type == IPROTO_SELECT ?
+					  IPROTO_CLASS_SELECT :
+					  IPROTO_CLASS_DML);
 		break;
 	case IPROTO_CALL_16:
 	case IPROTO_CALL:
 	case IPROTO_EVAL:
 		if (xrow_decode_call(&msg->header, &msg->call))
 			goto error;
-		cmsg_init(&msg->base, call_route);
+		cmsg_init(&msg->base, iproto_thread->call_route);
+		iproto_msg_set_class(msg, IPROTO_CLASS_CALL);
 		break;
 	case IPROTO_EXECUTE:
 	case IPROTO_PREPARE:
 		if (xrow_decode_sql(&msg->header, &msg->sql) != 0)
 			goto error;
-		cmsg_init(&msg->base, sql_route);
+		cmsg_init(&msg->base, iproto_thread->sql_route);
+		/* SQL may be arbitrarily expensive, like a call. */
+		iproto_msg_set_class(msg, IPROTO_CLASS_CALL);
 		break;
 	case IPROTO_PING:
-		cmsg_init(&msg->base, misc_route);
+		cmsg_init(&msg->base, iproto_thread->misc_route);
 		break;
 	case IPROTO_JOIN:
 	case IPROTO_FETCH_SNAPSHOT:
 	case IPROTO_REGISTER:
-		cmsg_init(&msg->base, join_route);
+		cmsg_init(&msg->base, iproto_thread->join_route);
 		*stop_input = true;
 		break;
 	case IPROTO_SUBSCRIBE:
-		cmsg_init(&msg->base, subscribe_route);
+		cmsg_init(&msg->base, iproto_thread->subscribe_route);
 		*stop_input = true;
 		break;
 	case IPROTO_VOTE_DEPRECATED:
 	case IPROTO_VOTE:
-		cmsg_init(&msg->base, misc_route);
+		cmsg_init(&msg->base, iproto_thread->misc_route);
 		break;
 	case IPROTO_AUTH:
 		if (xrow_decode_auth(&msg->header, &msg->auth))
 			goto error;
-		cmsg_init(&msg->base, misc_route);
+		cmsg_init(&msg->base, iproto_thread->misc_route);
+		break;
+	case IPROTO_ID:
+		if (xrow_decode_id(&msg->header, &msg->id))
+			goto error;
+		/* Reply with the subset of features we can provide. */
+		msg->id.features &= IPROTO_CURRENT_FEATURES;
+		if ((msg->id.features &
+		     (1ULL << IPROTO_FEATURE_COMPRESSION)) != 0 &&
+		    iproto_connection_enable_compression(msg->connection,
+							 reqend) != 0) {
+			diag_log();
+			msg->id.features &=
+				~(1ULL << IPROTO_FEATURE_COMPRESSION);
+		}
+		cmsg_init(&msg->base, iproto_thread->misc_route);
 		break;
 	default:
 		diag_set(ClientError, ER_UNKNOWN_REQUEST_TYPE,
 			 (uint32_t) type);
 		goto error;
 	}
+	/*
+	 * Shed the request right here when its class queue is
+	 * full. The client gets an error at once instead of
+	 * waiting behind a deep queue, while control traffic is
+	 * never shed, so pings keep working under overload.
+	 */
+	if (iproto_class_msg_max > 0 &&
+	    msg->msg_class != IPROTO_CLASS_CONTROL &&
+	    iproto_thread->class_depth[msg->msg_class] >
+	    iproto_class_msg_max) {
+		rmean_collect(iproto_thread->rmean, IPROTO_SHED, 1);
+		diag_set(ClientError, ER_REQUEST_QUEUE_FULL,
+			 iproto_class_strings[msg->msg_class]);
+		goto error;
+	}
 	return;
 error:
 	/** Log and send the error. */
 	diag_log();
 	diag_create(&msg->diag);
 	diag_move(&fiber()->diag, &msg->diag);
-	cmsg_init(&msg->base, error_route);
+	cmsg_init(&msg->base, iproto_thread->error_route);
+	/*
+	 * An error reply is cheap control traffic, whatever the
+	 * request was: deliver it via the priority pipe and do
+	 * not let it occupy a data class slot.
+	 */
+	iproto_msg_set_class(msg, IPROTO_CLASS_CONTROL);
 }
 
 static void
@@ -1438,7 +2343,8 @@ tx_discard_input(struct iproto_msg *msg)
 		{ net_discard_input, NULL },
 	};
 	cmsg_init(&msg->discard_input, discard_input_route);
-	cpipe_push(&net_pipe, &msg->discard_input);
+	cpipe_push(&msg->connection->iproto_thread->net_pipe,
+		   &msg->discard_input);
 }
 
 /**
@@ -1484,6 +2390,7 @@ static inline struct iproto_msg *
 tx_accept_msg(struct cmsg *m)
 {
 	struct iproto_msg *msg = (struct iproto_msg *) m;
+	TNT_PROBE2(request_dequeue, msg->header.sync, msg->header.type);
 	tx_accept_wpos(msg->connection, &msg->wpos);
 	tx_fiber_init(msg->connection->session, msg->header.sync);
 	return msg;
@@ -1530,6 +2437,12 @@ static void
 tx_process1(struct cmsg *m)
 {
 	struct iproto_msg *msg = tx_accept_msg(m);
+	/*
+	 * Single-statement DML is a latency-critical path and is
+	 * expected to live on the region and mempools only, see
+	 * lib/core/heap_audit.h.
+	 */
+	heap_audit_scope_enter(iproto_type_name(msg->header.type));
 	if (tx_check_schema(msg->header.schema_version))
 		goto error;
 
@@ -1547,11 +2460,75 @@ tx_process1(struct cmsg *m)
 	iproto_reply_select(out, &svp, msg->header.sync, ::schema_version,
 			    tuple != 0);
 	iproto_wpos_create(&msg->wpos, out);
+	heap_audit_scope_leave();
 	return;
 error:
+	heap_audit_scope_leave();
 	tx_reply_error(msg);
 }
 
+static void
+tx_begin_push(struct iproto_connection *con);
+
+/**
+ * Send a streamed SELECT response: all complete chunks of
+ * req->stream tuples go out as IPROTO_CHUNK packets, the tail as
+ * an ordinary select reply. After each chunk the net thread is
+ * notified via the kharon, exactly like on box.session.push(),
+ * and the fiber yields, so the socket starts draining while the
+ * dump is still in progress and other requests of this connection
+ * are not starved. Each chunk is a complete packet, so yielding
+ * between them can not leave the output buffer in an inconsistent
+ * state.
+ */
+static int
+tx_process_select_stream(struct iproto_msg *msg, struct port *base)
+{
+	assert(base->vtab == &port_c_vtab);
+	struct iproto_connection *con = msg->connection;
+	struct port_c *port = (struct port_c *) base;
+	struct port_c_entry *pe = port->first;
+	int left = port->size;
+	int chunk = msg->dml.stream;
+	/* Guard against overflow of the unsigned protocol field. */
+	if (chunk <= 0)
+		chunk = left;
+	struct obuf *out;
+	struct obuf_svp svp;
+	int count;
+	while (left > chunk) {
+		out = con->tx.p_obuf;
+		if (iproto_prepare_select(out, &svp) != 0)
+			return -1;
+		count = port_c_dump_msgpack_16_chunk(&pe, out, chunk);
+		if (count < 0) {
+			obuf_rollback_to_svp(out, &svp);
+			return -1;
+		}
+		iproto_reply_chunk(out, &svp, msg->header.sync,
+				   ::schema_version, count);
+		left -= count;
+		if (! con->tx.is_push_sent)
+			tx_begin_push(con);
+		else
+			con->tx.is_push_pending = true;
+		fiber_sleep(0);
+	}
+	/* Re-read the obuf - it may be rotated during a yield. */
+	out = con->tx.p_obuf;
+	if (iproto_prepare_select(out, &svp) != 0)
+		return -1;
+	count = port_c_dump_msgpack_16_chunk(&pe, out, left);
+	if (count < 0) {
+		obuf_rollback_to_svp(out, &svp);
+		return -1;
+	}
+	iproto_reply_select(out, &svp, msg->header.sync,
+			    ::schema_version, count);
+	iproto_wpos_create(&msg->wpos, out);
+	return 0;
+}
+
 static void
 tx_process_select(struct cmsg *m)
 {
@@ -1562,6 +2539,7 @@ tx_process_select(struct cmsg *m)
 	int count;
 	int rc;
 	struct request *req = &msg->dml;
+	heap_audit_scope_enter(iproto_type_name(msg->header.type));
 	if (tx_check_schema(msg->header.schema_version))
 		goto error;
 
@@ -1572,6 +2550,14 @@ tx_process_select(struct cmsg *m)
 	if (rc < 0)
 		goto error;
 
+	if (req->stream > 0) {
+		rc = tx_process_select_stream(msg, &port);
+		port_destroy(&port);
+		if (rc != 0)
+			goto error;
+		heap_audit_scope_leave();
+		return;
+	}
 	out = msg->connection->tx.p_obuf;
 	if (iproto_prepare_select(out, &svp) != 0) {
 		port_destroy(&port);
@@ -1590,8 +2576,10 @@ tx_process_select(struct cmsg *m)
 	iproto_reply_select(out, &svp, msg->header.sync,
 			    ::schema_version, count);
 	iproto_wpos_create(&msg->wpos, out);
+	heap_audit_scope_leave();
 	return;
 error:
+	heap_audit_scope_leave();
 	tx_reply_error(msg);
 }
 
@@ -1706,6 +2694,11 @@ tx_process_misc(struct cmsg *m)
 			iproto_reply_ok_xc(out, msg->header.sync,
 					   ::schema_version);
 			break;
+		case IPROTO_ID:
+			iproto_reply_id_xc(out, msg->id.features,
+					   msg->header.sync,
+					   ::schema_version);
+			break;
 		case IPROTO_VOTE_DEPRECATED:
 			iproto_reply_vclock_xc(out, &replicaset.vclock,
 					       msg->header.sync,
@@ -1728,6 +2721,61 @@ error:
 	tx_reply_error(msg);
 }
 
+/**
+ * Send a streamed DQL response: all complete chunks of
+ * msg->sql.stream rows go out as IPROTO_CHUNK packets with the
+ * same framing box.session.push() uses, the metadata and the tail
+ * rows as an ordinary EXECUTE reply. The net thread is notified
+ * after each chunk and the fiber yields, exactly as in
+ * tx_process_select_stream(), so the socket starts draining while
+ * the dump is still in progress.
+ */
+static int
+tx_process_sql_stream(struct iproto_msg *msg, struct port *base)
+{
+	struct iproto_connection *con = msg->connection;
+	struct port_c *port = (struct port_c *) base;
+	struct port_c_entry *pe = port->first;
+	int left = port->size;
+	int chunk = msg->sql.stream;
+	/* Guard against overflow of the unsigned protocol field. */
+	if (chunk <= 0)
+		chunk = left;
+	struct obuf *out;
+	struct obuf_svp svp;
+	int count;
+	while (left > chunk) {
+		out = con->tx.p_obuf;
+		if (iproto_prepare_select(out, &svp) != 0)
+			return -1;
+		count = port_c_dump_msgpack_16_chunk(&pe, out, chunk);
+		if (count < 0) {
+			obuf_rollback_to_svp(out, &svp);
+			return -1;
+		}
+		iproto_reply_chunk(out, &svp, msg->header.sync,
+				   ::schema_version, count);
+		left -= count;
+		if (! con->tx.is_push_sent)
+			tx_begin_push(con);
+		else
+			con->tx.is_push_pending = true;
+		fiber_sleep(0);
+	}
+	/* Re-read the obuf - it may be rotated during a yield. */
+	out = con->tx.p_obuf;
+	struct obuf_svp header_svp;
+	if (iproto_prepare_header(out, &header_svp, IPROTO_HEADER_LEN) != 0)
+		return -1;
+	if (port_sql_dump_msgpack_tail(base, out, &pe, left) != 0) {
+		obuf_rollback_to_svp(out, &header_svp);
+		return -1;
+	}
+	iproto_reply_sql(out, &header_svp, msg->header.sync, ::schema_version);
+	iproto_wpos_create(&msg->wpos, out);
+	return 0;
+}
+
 static void
 tx_process_sql(struct cmsg *m)
 {
@@ -1805,6 +2853,14 @@ tx_process_sql(struct cmsg *m)
 		iproto_wpos_create(&msg->wpos, out);
 		return;
 	}
+	if (msg->sql.stream > 0 &&
+	    ((struct port_sql *) &port)->serialization_format == DQL_EXECUTE) {
+		int rc = tx_process_sql_stream(msg, &port);
+		port_destroy(&port);
+		if (rc != 0)
+			goto error;
+		return;
+	}
 	struct obuf_svp header_svp;
 	/* Prepare memory for the iproto header. */
 	if (iproto_prepare_header(out, &header_svp, IPROTO_HEADER_LEN) != 0) {
@@ -1872,6 +2928,14 @@ net_send_msg(struct cmsg *m)
 {
 	struct iproto_msg *msg = (struct iproto_msg *) m;
 	struct iproto_connection *con = msg->connection;
+	struct iproto_thread *iproto_thread = con->iproto_thread;
+	double rtt = ev_monotonic_now(con->loop) - msg->enqueue_time;
+	hdr_histogram_record(iproto_thread->class_hist[msg->msg_class],
+			     (int64_t) (rtt * 1e6));
+	flightrec_record(FLIGHTREC_REPLY_FLUSH, msg->header.sync,
+			 obuf_size(msg->wpos.obuf));
+	TNT_PROBE2(request_reply, msg->header.sync,
+		   obuf_size(msg->wpos.obuf));
 
 	if (msg->len != 0) {
 		/* Discard request (see iproto_enqueue_batch()). */
@@ -1882,6 +2946,16 @@ net_send_msg(struct cmsg *m)
 		con->long_poll_count--;
 	}
 	con->wend = msg->wpos;
+	if (msg->header.type == IPROTO_ID && con->zstd_out != NULL &&
+	    !con->is_compress_output) {
+		/*
+		 * The ID reply which has granted compression must
+		 * reach the client as is, everything after it is
+		 * compressed.
+		 */
+		con->compress_wpos = msg->wpos;
+		con->is_compress_output = true;
+	}
 
 	if (evio_has_fd(&con->output)) {
 		if (! ev_is_active(&con->output))
@@ -1988,7 +3062,8 @@ net_send_greeting(struct cmsg *m)
 
 		if (nwr > 0) {
 			/* Count statistics. */
-			rmean_collect(rmean_net, IPROTO_SENT, nwr);
+			rmean_collect(con->iproto_thread->rmean,
+				      IPROTO_SENT, nwr);
 		} else if (nwr < 0 && ! sio_wouldblock(errno)) {
 			diag_log();
 		}
@@ -2009,24 +3084,17 @@ net_send_greeting(struct cmsg *m)
 	iproto_msg_delete(msg);
 }
 
-static const struct cmsg_hop connect_route[] = {
-	{ tx_process_connect, &net_pipe },
-	{ net_send_greeting, NULL },
-};
-
 /** }}} */
 
 /**
- * Create a connection and start input.
+ * Create a connection in the given thread and start input.
  */
 static int
-iproto_on_accept(struct evio_service * /* service */, int fd,
-		 struct sockaddr *addr, socklen_t addrlen)
+iproto_thread_accept(struct iproto_thread *iproto_thread, int fd)
 {
-	(void) addr;
-	(void) addrlen;
 	struct iproto_msg *msg;
-	struct iproto_connection *con = iproto_connection_new(fd);
+	struct iproto_connection *con =
+		iproto_connection_new(iproto_thread, fd);
 	if (con == NULL)
 		return -1;
 	/*
@@ -2036,61 +3104,254 @@ iproto_on_accept(struct evio_service * /* service */, int fd,
 	 */
 	msg = iproto_msg_new(con);
 	if (msg == NULL) {
-		mempool_free(&iproto_connection_pool, con);
+		mempool_free(&iproto_thread->iproto_connection_pool, con);
 		return -1;
 	}
-	cmsg_init(&msg->base, connect_route);
+	cmsg_init(&msg->base, iproto_thread->connect_route);
 	msg->p_ibuf = con->p_ibuf;
 	msg->wpos = con->wpos;
-	cpipe_push(&tx_pipe, &msg->base);
+	cpipe_push(&iproto_thread->tx_pipe, &msg->base);
 	return 0;
 }
 
-static struct evio_service binary; /* iproto binary listener */
+/**
+ * A message sent by the first thread to hand an accepted socket
+ * over to the thread that is to serve the connection. Allocated
+ * with malloc() since it travels between two threads.
+ */
+struct iproto_accept_msg {
+	struct cmsg base;
+	/** The accepted peer socket. */
+	int fd;
+	/** The thread that is to serve the connection. */
+	struct iproto_thread *iproto_thread;
+};
+
+/** Finish an accept handed over from the first thread. */
+static void
+net_complete_accept(struct cmsg *m)
+{
+	struct iproto_accept_msg *msg = (struct iproto_accept_msg *) m;
+	if (iproto_thread_accept(msg->iproto_thread, msg->fd) != 0) {
+		diag_log();
+		close(msg->fd);
+	}
+	free(msg);
+}
+
+static const struct cmsg_hop accept_route[] = {
+	{ net_complete_accept, NULL },
+};
+
+/**
+ * Distribute a new connection between the threads. When every
+ * thread has its own SO_REUSEPORT acceptor, the kernel has
+ * already balanced the connection and the accepting thread
+ * serves it itself. With a single acceptor the first thread
+ * assigns connections round-robin by accept order and hands
+ * them over to their threads via the accept pipes.
+ */
+static int
+iproto_on_accept(struct evio_service *service, int fd,
+		 struct sockaddr *addr, socklen_t addrlen)
+{
+	(void) addr;
+	(void) addrlen;
+	struct iproto_thread *iproto_thread =
+		(struct iproto_thread *) service->on_accept_param;
+	if (!service->reuse_port) {
+		assert(iproto_thread->id == 0);
+		iproto_thread = &iproto_threads[iproto_accept_counter++ %
+						iproto_threads_count];
+		if (iproto_thread->id != 0) {
+			struct iproto_accept_msg *msg =
+				(struct iproto_accept_msg *) malloc(sizeof(*msg));
+			if (msg == NULL) {
+				diag_set(OutOfMemory, sizeof(*msg),
+					 "malloc", "msg");
+				return -1;
+			}
+			cmsg_init(&msg->base, accept_route);
+			msg->fd = fd;
+			msg->iproto_thread = iproto_thread;
+			cpipe_push(&iproto_thread->accept_pipe, &msg->base);
+			return 0;
+		}
+	}
+	return iproto_thread_accept(iproto_thread, fd);
+}
+
+#if defined(ENABLE_IOURING)
+/**
+ * Create this thread's io_uring and plug its completions into
+ * the event loop. Failure is not fatal: the kernel may simply be
+ * too old, the thread then keeps using plain reads.
+ */
+static void
+iproto_thread_ring_start(struct iproto_thread *iproto_thread)
+{
+	iproto_thread->ring_active = false;
+	iproto_thread->ring.fd = -1;
+	iproto_thread->ring_eventfd = -1;
+	rlist_create(&iproto_thread->read_queue);
+	if (!iproto_use_iouring)
+		return;
+	if (iouring_create(&iproto_thread->ring,
+			   IPROTO_IOURING_ENTRIES) != 0) {
+		diag_log();
+		say_warn("net_iouring is set, but io_uring is not "
+			 "available, falling back to plain socket reads");
+		return;
+	}
+	iproto_thread->ring_eventfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (iproto_thread->ring_eventfd < 0 ||
+	    iouring_register_eventfd(&iproto_thread->ring,
+				     iproto_thread->ring_eventfd) != 0) {
+		diag_log();
+		say_warn("failed to plug io_uring into the event loop, "
+			 "falling back to plain socket reads");
+		if (iproto_thread->ring_eventfd >= 0) {
+			close(iproto_thread->ring_eventfd);
+			iproto_thread->ring_eventfd = -1;
+		}
+		iouring_destroy(&iproto_thread->ring);
+		return;
+	}
+	ev_io_init(&iproto_thread->ring_input, iproto_ring_on_event,
+		   iproto_thread->ring_eventfd, EV_READ);
+	iproto_thread->ring_input.data = iproto_thread;
+	ev_io_start(loop(), &iproto_thread->ring_input);
+	ev_prepare_init(&iproto_thread->ring_prepare, iproto_ring_prepare_cb);
+	iproto_thread->ring_prepare.data = iproto_thread;
+	ev_prepare_start(loop(), &iproto_thread->ring_prepare);
+	iproto_thread->ring_active = true;
+}
+
+/** Unplug and destroy this thread's io_uring, if any. */
+static void
+iproto_thread_ring_stop(struct iproto_thread *iproto_thread)
+{
+	if (iproto_thread->ring.fd < 0)
+		return;
+	ev_prepare_stop(loop(), &iproto_thread->ring_prepare);
+	ev_io_stop(loop(), &iproto_thread->ring_input);
+	close(iproto_thread->ring_eventfd);
+	iproto_thread->ring_eventfd = -1;
+	iouring_destroy(&iproto_thread->ring);
+	iproto_thread->ring_active = false;
+}
+#endif /* defined(ENABLE_IOURING) */
 
 /**
  * The network io thread main function:
  * begin serving the message bus.
  */
 static int
-net_cord_f(va_list /* ap */)
+net_cord_f(va_list ap)
 {
-	mempool_create(&iproto_msg_pool, &cord()->slabc,
+	struct iproto_thread *iproto_thread =
+		va_arg(ap, struct iproto_thread *);
+
+	mempool_create(&iproto_thread->iproto_msg_pool, &cord()->slabc,
 		       sizeof(struct iproto_msg));
-	mempool_create(&iproto_connection_pool, &cord()->slabc,
+	mempool_create(&iproto_thread->iproto_connection_pool, &cord()->slabc,
 		       sizeof(struct iproto_connection));
+	rlist_create(&iproto_thread->stopped_connections);
+#if defined(ENABLE_IOURING)
+	iproto_thread_ring_start(iproto_thread);
+#endif
 
-	evio_service_init(loop(), &binary, "binary",
-			  iproto_on_accept, NULL);
-
+	evio_service_init(loop(), &iproto_thread->binary, "binary",
+			  iproto_on_accept, iproto_thread);
 
 	/* Init statistics counter */
-	rmean_net = rmean_new(rmean_net_strings, IPROTO_LAST);
+	iproto_thread->rmean = rmean_new(rmean_net_strings, IPROTO_LAST);
 
-	if (rmean_net == NULL) {
+	if (iproto_thread->rmean == NULL) {
 		tnt_raise(OutOfMemory, sizeof(struct rmean),
 			  "rmean", "struct rmean");
 	}
 
+	char endpoint_name[FIBER_NAME_MAX];
+	snprintf(endpoint_name, sizeof(endpoint_name), "net%d",
+		 iproto_thread->id);
 	struct cbus_endpoint endpoint;
 	/* Create "net" endpoint. */
-	cbus_endpoint_create(&endpoint, "net", fiber_schedule_cb, fiber());
+	cbus_endpoint_create(&endpoint, endpoint_name,
+			     fiber_schedule_cb, fiber());
 	/* Create a pipe to "tx" thread. */
-	cpipe_create(&tx_pipe, "tx");
-	cpipe_set_max_input(&tx_pipe, iproto_msg_max / 2);
+	cpipe_create(&iproto_thread->tx_pipe, "tx");
+	cpipe_set_max_input(&iproto_thread->tx_pipe, iproto_msg_max / 2);
+	/* A separate pipe to "tx" for control requests. */
+	cpipe_create(&iproto_thread->tx_prio_pipe, "tx");
+	cpipe_set_max_input(&iproto_thread->tx_prio_pipe, iproto_msg_max / 2);
+
+	static const int64_t flush_hist_buckets[] = {
+		1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024, 2048, 4096,
+	};
+	iproto_thread->flush_hist = histogram_new(flush_hist_buckets,
+						  lengthof(flush_hist_buckets));
+	if (iproto_thread->flush_hist == NULL) {
+		tnt_raise(OutOfMemory, sizeof(struct histogram),
+			  "histogram", "flush_hist");
+	}
+	for (int i = 0; i < IPROTO_CLASS_MAX; i++) {
+		iproto_thread->class_depth[i] = 0;
+		/*
+		 * 1 us .. 100 s with two significant digits of
+		 * precision at any magnitude.
+		 */
+		iproto_thread->class_hist[i] =
+			hdr_histogram_new(1, 100 * 1000000LL, 2);
+		if (iproto_thread->class_hist[i] == NULL) {
+			tnt_raise(OutOfMemory, sizeof(struct hdr_histogram),
+				  "histogram", "class_hist");
+		}
+	}
+	trigger_create(&iproto_thread->on_flush, iproto_on_flush_cb,
+		       iproto_thread, NULL);
+	trigger_add(&iproto_thread->tx_pipe.on_flush, &iproto_thread->on_flush);
+	ev_timer_init(&iproto_thread->flush_timer, iproto_flush_timer_cb,
+		      0., 0.);
+	iproto_thread->flush_timer.data = iproto_thread;
+	/*
+	 * Connect the accept pipes to the sibling threads. Their
+	 * endpoints may not exist yet - cpipe_create() waits for
+	 * them to be registered.
+	 */
+	if (iproto_thread->id == 0) {
+		for (int i = 1; i < iproto_threads_count; i++) {
+			snprintf(endpoint_name, sizeof(endpoint_name),
+				 "net%d", i);
+			cpipe_create(&iproto_threads[i].accept_pipe,
+				     endpoint_name);
+		}
+	}
 	/* Process incomming messages. */
 	cbus_loop(&endpoint);
 
-	cpipe_destroy(&tx_pipe);
+	if (iproto_thread->id == 0) {
+		for (int i = 1; i < iproto_threads_count; i++)
+			cpipe_destroy(&iproto_threads[i].accept_pipe);
+	}
+	ev_timer_stop(loop(), &iproto_thread->flush_timer);
+#if defined(ENABLE_IOURING)
+	iproto_thread_ring_stop(iproto_thread);
+#endif
+	cpipe_destroy(&iproto_thread->tx_prio_pipe);
+	cpipe_destroy(&iproto_thread->tx_pipe);
+	histogram_delete(iproto_thread->flush_hist);
+	for (int i = 0; i < IPROTO_CLASS_MAX; i++)
+		hdr_histogram_delete(iproto_thread->class_hist[i]);
 	/*
 	 * Nothing to do in the fiber so far, the service
 	 * will take care of creating events for incoming
 	 * connections.
 	 */
-	if (evio_service_is_active(&binary))
-		evio_service_stop(&binary);
+	if (evio_service_is_active(&iproto_thread->binary))
+		evio_service_stop(&iproto_thread->binary);
 
-	rmean_delete(rmean_net);
+	rmean_delete(iproto_thread->rmean);
 	return 0;
 }
 
@@ -2119,7 +3380,7 @@ iproto_process_push(struct cmsg *m)
 	struct iproto_connection *con =
 		container_of(kharon, struct iproto_connection, kharon);
 	con->wend = kharon->wpos;
-	kharon->wpos = con->wpos;
+	kharon->wpos = *iproto_connection_safe_wpos(con);
 	if (evio_has_fd(&con->output) && !ev_is_active(&con->output))
 		ev_feed_event(con->loop, &con->output, EV_WRITE);
 }
@@ -2132,11 +3393,11 @@ static void
 tx_begin_push(struct iproto_connection *con)
 {
 	assert(! con->tx.is_push_sent);
-	cmsg_init(&con->kharon.base, push_route);
+	cmsg_init(&con->kharon.base, con->iproto_thread->push_route);
 	iproto_wpos_create(&con->kharon.wpos, con->tx.p_obuf);
 	con->tx.is_push_pending = false;
 	con->tx.is_push_sent = true;
-	cpipe_push(&net_pipe, (struct cmsg *) &con->kharon);
+	cpipe_push(&con->iproto_thread->net_pipe, (struct cmsg *) &con->kharon);
 }
 
 static void
@@ -2174,7 +3435,7 @@ iproto_session_push(struct session *session, struct port *port)
 		return -1;
 	}
 	iproto_reply_chunk(con->tx.p_obuf, &svp, iproto_session_sync(session),
-			   ::schema_version);
+			   ::schema_version, 1);
 	if (! con->tx.is_push_sent)
 		tx_begin_push(con);
 	else
@@ -2184,18 +3445,96 @@ iproto_session_push(struct session *session, struct port *port)
 
 /** }}} */
 
-/** Initialize the iproto subsystem and start network io thread */
+/** Fill in per-thread copies of the cmsg routes. */
+static void
+iproto_thread_init_routes(struct iproto_thread *iproto_thread)
+{
+	iproto_thread->destroy_route[0] =
+		{ tx_process_destroy, &iproto_thread->net_pipe };
+	iproto_thread->destroy_route[1] = { net_finish_destroy, NULL };
+	iproto_thread->disconnect_route[0] =
+		{ tx_process_disconnect, &iproto_thread->net_pipe };
+	iproto_thread->disconnect_route[1] = { net_finish_disconnect, NULL };
+	iproto_thread->push_route[0] =
+		{ iproto_process_push, &iproto_thread->tx_pipe };
+	iproto_thread->push_route[1] = { tx_end_push, NULL };
+	iproto_thread->misc_route[0] =
+		{ tx_process_misc, &iproto_thread->net_pipe };
+	iproto_thread->misc_route[1] = { net_send_msg, NULL };
+	iproto_thread->call_route[0] =
+		{ tx_process_call, &iproto_thread->net_pipe };
+	iproto_thread->call_route[1] = { net_send_msg, NULL };
+	iproto_thread->select_route[0] =
+		{ tx_process_select, &iproto_thread->net_pipe };
+	iproto_thread->select_route[1] = { net_send_msg, NULL };
+	iproto_thread->process1_route[0] =
+		{ tx_process1, &iproto_thread->net_pipe };
+	iproto_thread->process1_route[1] = { net_send_msg, NULL };
+	iproto_thread->sql_route[0] =
+		{ tx_process_sql, &iproto_thread->net_pipe };
+	iproto_thread->sql_route[1] = { net_send_msg, NULL };
+	iproto_thread->join_route[0] =
+		{ tx_process_replication, &iproto_thread->net_pipe };
+	iproto_thread->join_route[1] = { net_end_join, NULL };
+	iproto_thread->subscribe_route[0] =
+		{ tx_process_replication, &iproto_thread->net_pipe };
+	iproto_thread->subscribe_route[1] = { net_end_subscribe, NULL };
+	iproto_thread->error_route[0] =
+		{ tx_reply_iproto_error, &iproto_thread->net_pipe };
+	iproto_thread->error_route[1] = { net_send_error, NULL };
+	iproto_thread->connect_route[0] =
+		{ tx_process_connect, &iproto_thread->net_pipe };
+	iproto_thread->connect_route[1] = { net_send_greeting, NULL };
+
+	iproto_thread->dml_route[IPROTO_OK] = NULL;
+	iproto_thread->dml_route[IPROTO_SELECT] = iproto_thread->select_route;
+	iproto_thread->dml_route[IPROTO_INSERT] = iproto_thread->process1_route;
+	iproto_thread->dml_route[IPROTO_REPLACE] =
+		iproto_thread->process1_route;
+	iproto_thread->dml_route[IPROTO_UPDATE] = iproto_thread->process1_route;
+	iproto_thread->dml_route[IPROTO_DELETE] = iproto_thread->process1_route;
+	iproto_thread->dml_route[IPROTO_CALL_16] = iproto_thread->call_route;
+	iproto_thread->dml_route[IPROTO_AUTH] = iproto_thread->misc_route;
+	iproto_thread->dml_route[IPROTO_EVAL] = iproto_thread->call_route;
+	iproto_thread->dml_route[IPROTO_UPSERT] = iproto_thread->process1_route;
+	iproto_thread->dml_route[IPROTO_CALL] = iproto_thread->call_route;
+	iproto_thread->dml_route[IPROTO_EXECUTE] = iproto_thread->sql_route;
+	iproto_thread->dml_route[IPROTO_NOP] = NULL;
+	iproto_thread->dml_route[IPROTO_PREPARE] = iproto_thread->sql_route;
+}
+
+/** Initialize the iproto subsystem and start network io threads */
 void
-iproto_init(void)
+iproto_init(int threads_count)
 {
 	slab_cache_create(&net_slabc, &runtime);
 
-	if (cord_costart(&net_cord, "iproto", net_cord_f, NULL))
-		panic("failed to initialize iproto thread");
-
-	/* Create a pipe to "net" thread. */
-	cpipe_create(&net_pipe, "net");
-	cpipe_set_max_input(&net_pipe, iproto_msg_max / 2);
+	iproto_threads = (struct iproto_thread *)
+		calloc(threads_count, sizeof(*iproto_threads));
+	if (iproto_threads == NULL)
+		panic("failed to allocate iproto threads");
+	/*
+	 * The counter must be set before the first thread is
+	 * started: the first thread connects the accept pipes
+	 * to all the others, see net_cord_f().
+	 */
+	iproto_threads_count = threads_count;
+
+	for (int i = 0; i < threads_count; i++) {
+		struct iproto_thread *iproto_thread = &iproto_threads[i];
+		iproto_thread->id = i;
+		iproto_thread_init_routes(iproto_thread);
+		if (cord_costart(&iproto_thread->net_cord, "iproto",
+				 net_cord_f, iproto_thread))
+			panic("failed to initialize iproto thread");
+
+		/* Create a pipe to the "net" thread. */
+		char endpoint_name[FIBER_NAME_MAX];
+		snprintf(endpoint_name, sizeof(endpoint_name), "net%d", i);
+		cpipe_create(&iproto_thread->net_pipe, endpoint_name);
+		cpipe_set_max_input(&iproto_thread->net_pipe,
+				    iproto_msg_max / 2);
+	}
 	struct session_vtab iproto_session_vtab = {
 		/* .push = */ iproto_session_push,
 		/* .fd = */ iproto_session_fd,
@@ -2220,10 +3559,17 @@ struct iproto_cfg_msg: public cbus_call_msg
 {
 	/** Operation to execute in iproto thread. */
 	enum iproto_cfg_op op;
+	/** Thread the operation is executed in. */
+	struct iproto_thread *iproto_thread;
 	union {
 		struct {
-			/** New URI to bind to. */
+			/**
+			 * New URI to bind to. NULL if the thread
+			 * must only stop its acceptor.
+			 */
 			const char *uri;
+			/** Bind the acceptor with SO_REUSEPORT. */
+			bool reuse_port;
 			/** Result address. */
 			struct sockaddr_storage addr;
 			/** Address length. */
@@ -2246,27 +3592,34 @@ static int
 iproto_do_cfg_f(struct cbus_call_msg *m)
 {
 	struct iproto_cfg_msg *cfg_msg = (struct iproto_cfg_msg *) m;
-	int old;
+	struct iproto_thread *iproto_thread = cfg_msg->iproto_thread;
 	try {
 		switch (cfg_msg->op) {
 		case IPROTO_CFG_MSG_MAX:
-			cpipe_set_max_input(&tx_pipe,
+			cpipe_set_max_input(&iproto_thread->tx_pipe,
 					    cfg_msg->iproto_msg_max / 2);
-			old = iproto_msg_max;
-			iproto_msg_max = cfg_msg->iproto_msg_max;
-			if (old < iproto_msg_max)
-				iproto_resume();
+			cpipe_set_max_input(&iproto_thread->tx_prio_pipe,
+					    cfg_msg->iproto_msg_max / 2);
+			/*
+			 * The limit may have been raised - it is
+			 * harmless to try to resume when it was not,
+			 * iproto_resume() re-checks the limit.
+			 */
+			iproto_resume(iproto_thread);
 			break;
-		case IPROTO_CFG_LISTEN:
-			if (evio_service_is_active(&binary))
-				evio_service_stop(&binary);
+		case IPROTO_CFG_LISTEN: {
+			struct evio_service *binary = &iproto_thread->binary;
+			if (evio_service_is_active(binary))
+				evio_service_stop(binary);
+			binary->reuse_port = cfg_msg->reuse_port;
 			if (cfg_msg->uri != NULL &&
-			    (evio_service_bind(&binary, cfg_msg->uri) != 0 ||
-			     evio_service_listen(&binary) != 0))
+			    (evio_service_bind(binary, cfg_msg->uri) != 0 ||
+			     evio_service_listen(binary) != 0))
 				diag_raise();
-			cfg_msg->addrlen = binary.addr_len;
-			cfg_msg->addr = binary.addrstorage;
+			cfg_msg->addrlen = binary->addr_len;
+			cfg_msg->addr = binary->addrstorage;
 			break;
+		}
 		default:
 			unreachable();
 		}
@@ -2277,46 +3630,128 @@ iproto_do_cfg_f(struct cbus_call_msg *m)
 }
 
 static inline void
-iproto_do_cfg(struct iproto_cfg_msg *msg)
+iproto_do_cfg(struct iproto_thread *iproto_thread,
+	      struct iproto_cfg_msg *msg)
 {
-	if (cbus_call(&net_pipe, &tx_pipe, msg, iproto_do_cfg_f,
-		      NULL, TIMEOUT_INFINITY) != 0)
+	msg->iproto_thread = iproto_thread;
+	if (cbus_call(&iproto_thread->net_pipe, &iproto_thread->tx_pipe, msg,
+		      iproto_do_cfg_f, NULL, TIMEOUT_INFINITY) != 0)
 		diag_raise();
 }
 
+/** True if @a uri refers to a unix domain socket. */
+static bool
+iproto_uri_is_unix(const char *uri)
+{
+	struct uri u;
+	if (uri_parse(&u, uri) != 0 || u.host == NULL)
+		return false;
+	return u.host_len == strlen(URI_HOST_UNIX) &&
+	       strncmp(u.host, URI_HOST_UNIX, u.host_len) == 0;
+}
+
 void
 iproto_listen(const char *uri)
 {
-	struct iproto_cfg_msg cfg_msg;
-	iproto_cfg_msg_create(&cfg_msg, IPROTO_CFG_LISTEN);
-	cfg_msg.uri = uri;
-	iproto_do_cfg(&cfg_msg);
-	iproto_bound_address_storage = cfg_msg.addr;
-	iproto_bound_address_len = cfg_msg.addrlen;
+	/*
+	 * When possible, bind an acceptor in every thread with
+	 * SO_REUSEPORT and let the kernel balance incoming
+	 * connections between the accept queues. Unix domain
+	 * sockets do not support the option - they are served by
+	 * the first thread alone, which distributes connections
+	 * round-robin, see iproto_on_accept().
+	 */
+	bool reuse_port = iproto_threads_count > 1 && uri != NULL &&
+			  !iproto_uri_is_unix(uri) &&
+			  evio_reuse_port_supported();
+	for (int i = 0; i < iproto_threads_count; i++) {
+		struct iproto_cfg_msg cfg_msg;
+		iproto_cfg_msg_create(&cfg_msg, IPROTO_CFG_LISTEN);
+		cfg_msg.uri = (i == 0 || reuse_port) ? uri : NULL;
+		cfg_msg.reuse_port = reuse_port;
+		iproto_do_cfg(&iproto_threads[i], &cfg_msg);
+		if (i == 0) {
+			iproto_bound_address_storage = cfg_msg.addr;
+			iproto_bound_address_len = cfg_msg.addrlen;
+		}
+	}
 }
 
 size_t
 iproto_mem_used(void)
 {
-	return slab_cache_used(&net_cord.slabc) + slab_cache_used(&net_slabc);
+	size_t size = slab_cache_used(&net_slabc);
+	for (int i = 0; i < iproto_threads_count; i++)
+		size += slab_cache_used(&iproto_threads[i].net_cord.slabc);
+	return size;
 }
 
 size_t
 iproto_connection_count(void)
 {
-	return mempool_count(&iproto_connection_pool);
+	size_t count = 0;
+	for (int i = 0; i < iproto_threads_count; i++)
+		count += mempool_count(&iproto_threads[i].iproto_connection_pool);
+	return count;
 }
 
 size_t
 iproto_request_count(void)
 {
-	return mempool_count(&iproto_msg_pool);
+	size_t count = 0;
+	for (int i = 0; i < iproto_threads_count; i++)
+		count += mempool_count(&iproto_threads[i].iproto_msg_pool);
+	return count;
+}
+
+struct rmean *
+iproto_thread_rmean(int thread_id)
+{
+	assert(thread_id >= 0 && thread_id < iproto_threads_count);
+	return iproto_threads[thread_id].rmean;
+}
+
+struct histogram *
+iproto_thread_flush_hist(int thread_id)
+{
+	assert(thread_id >= 0 && thread_id < iproto_threads_count);
+	return iproto_threads[thread_id].flush_hist;
+}
+
+struct hdr_histogram *
+iproto_thread_class_hist(int thread_id, enum iproto_msg_class msg_class)
+{
+	assert(thread_id >= 0 && thread_id < iproto_threads_count);
+	assert(msg_class < IPROTO_CLASS_MAX);
+	return iproto_threads[thread_id].class_hist[msg_class];
+}
+
+int
+iproto_rmean_foreach(rmean_cb cb, void *cb_ctx)
+{
+	for (size_t i = 0; i < IPROTO_LAST; i++) {
+		int64_t mean = 0;
+		int64_t total = 0;
+		for (int j = 0; j < iproto_threads_count; j++) {
+			mean += rmean_mean(iproto_threads[j].rmean, i);
+			total += rmean_total(iproto_threads[j].rmean, i);
+		}
+		int rc = cb(rmean_net_strings[i], mean, total, cb_ctx);
+		if (rc != 0)
+			return rc;
+	}
+	return 0;
 }
 
 void
 iproto_reset_stat(void)
 {
-	rmean_cleanup(rmean_net);
+	for (int i = 0; i < iproto_threads_count; i++) {
+		rmean_cleanup(iproto_threads[i].rmean);
+		histogram_reset(iproto_threads[i].flush_hist);
+		for (int j = 0; j < IPROTO_CLASS_MAX; j++)
+			hdr_histogram_reset(iproto_threads[i].class_hist[j]);
+	}
 }
 
 void
@@ -2327,23 +3762,72 @@ iproto_set_msg_max(int new_iproto_msg_max)
 			  tt_sprintf("minimal value is %d",
 				     IPROTO_MSG_MAX_MIN));
 	}
-	struct iproto_cfg_msg cfg_msg;
-	iproto_cfg_msg_create(&cfg_msg, IPROTO_CFG_MSG_MAX);
-	cfg_msg.iproto_msg_max = new_iproto_msg_max;
-	iproto_do_cfg(&cfg_msg);
-	cpipe_set_max_input(&net_pipe, new_iproto_msg_max / 2);
+	iproto_msg_max = new_iproto_msg_max;
+	for (int i = 0; i < iproto_threads_count; i++) {
+		struct iproto_cfg_msg cfg_msg;
+		iproto_cfg_msg_create(&cfg_msg, IPROTO_CFG_MSG_MAX);
+		cfg_msg.iproto_msg_max = new_iproto_msg_max;
+		iproto_do_cfg(&iproto_threads[i], &cfg_msg);
+		cpipe_set_max_input(&iproto_threads[i].net_pipe,
+				    new_iproto_msg_max / 2);
+	}
+}
+
+void
+iproto_set_flush_interval(double interval)
+{
+	if (interval < 0) {
+		tnt_raise(ClientError, ER_CFG, "net_flush_interval",
+			  "the value must be >= 0");
+	}
+	iproto_flush_interval = interval;
+}
+
+void
+iproto_set_zerocopy(bool zerocopy)
+{
+	iproto_zerocopy = zerocopy;
+}
+
+void
+iproto_set_iouring(bool use)
+{
+#if !defined(ENABLE_IOURING)
+	if (use) {
+		say_warn("net_iouring is not supported on this platform, "
+			 "falling back to plain socket reads");
+		use = false;
+	}
+#endif
+	iproto_use_iouring = use;
+}
+
+void
+iproto_set_class_msg_max(int limit)
+{
+	if (limit < 0) {
+		tnt_raise(ClientError, ER_CFG, "net_class_msg_max",
+			  "the value must be >= 0");
+	}
+	iproto_class_msg_max = limit;
 }
 
 void
 iproto_free(void)
 {
-	tt_pthread_cancel(net_cord.id);
-	tt_pthread_join(net_cord.id, NULL);
+	for (int i = 0; i < iproto_threads_count; i++) {
+		tt_pthread_cancel(iproto_threads[i].net_cord.id);
+		tt_pthread_join(iproto_threads[i].net_cord.id, NULL);
+	}
 	/*
-	* Close socket descriptor to prevent hot standby instance
-	* failing to bind in case it tries to bind before socket
-	* is closed by OS.
+	* Close socket descriptors to prevent hot standby instance
+	* failing to bind in case it tries to bind before sockets
+	* are closed by OS.
 	*/
-	if (evio_service_is_active(&binary))
-		close(binary.ev.fd);
+	for (int i = 0; i < iproto_threads_count; i++) {
+		struct evio_service *binary = &iproto_threads[i].binary;
+		if (evio_service_is_active(binary))
+			close(binary->ev.fd);
+	}
+	free(iproto_threads);
 }
@@ -32,14 +32,21 @@
  */
 
 #include <stddef.h>
+#include <stdint.h>
 
 #if defined(__cplusplus)
 extern "C" {
 #endif /* defined(__cplusplus) */
 
+struct rmean;
+struct histogram;
+struct hdr_histogram;
+
 enum {
 	/** The minimal value for net_msg_max. */
 	IPROTO_MSG_MAX_MIN = 2,
+	/** The maximal value for iproto_threads. */
+	IPROTO_THREADS_MAX = 1000,
 	/**
 	 * The size of tx fiber pool for iproto requests is
 	 * limited by the number of concurrent iproto messages,
@@ -54,8 +61,34 @@ enum {
 	IPROTO_FIBER_POOL_SIZE_FACTOR = 5,
 };
 
+/**
+ * Priority classes the requests are sorted into at the
+ * iproto -> tx boundary. Control requests (pings, auth,
+ * handshakes) jump ahead of batched data traffic and are never
+ * shed, so a cheap watchdog ping is not stuck behind a huge
+ * select. The data classes can be individually limited in depth,
+ * see iproto_set_class_msg_max().
+ */
+enum iproto_msg_class {
+	/** Pings, votes, auth, replication handshakes, errors. */
+	IPROTO_CLASS_CONTROL,
+	/** Writes: insert, replace, update, delete, upsert. */
+	IPROTO_CLASS_DML,
+	/** Reads: select. */
+	IPROTO_CLASS_SELECT,
+	/** Call, eval and SQL - arbitrarily expensive requests. */
+	IPROTO_CLASS_CALL,
+	IPROTO_CLASS_MAX,
+};
+
+/** Class names as shown in box.stat.net.thread(). */
+extern const char *iproto_class_strings[];
+
 extern unsigned iproto_readahead;
 
+/** The number of network threads. */
+extern int iproto_threads_count;
+
 /**
  * Return size of memory used for storing network buffers.
  */
@@ -74,6 +107,39 @@ iproto_connection_count(void);
 size_t
 iproto_request_count(void);
 
+/**
+ * Return network statistics of the given thread.
+ */
+struct rmean *
+iproto_thread_rmean(int thread_id);
+
+/**
+ * Return the histogram of request batch sizes the given thread
+ * flushed to the tx thread. Updated in the network thread, so the
+ * reader may see slightly stale counters.
+ */
+struct histogram *
+iproto_thread_flush_hist(int thread_id);
+
+/**
+ * Return the histogram of request latencies of the given class
+ * in the given thread, in microseconds from reading a request up
+ * to staging its reply for writing. Recorded in the network
+ * thread with lock-free increments, so reading it from the tx
+ * thread is safe, if slightly stale.
+ */
+struct hdr_histogram *
+iproto_thread_class_hist(int thread_id, enum iproto_msg_class msg_class);
+
+/**
+ * Invoke @a cb for each network statistic, aggregated over all
+ * threads. Stops and returns the callback result as soon as it
+ * is not 0, like rmean_foreach().
+ */
+int
+iproto_rmean_foreach(int (*cb)(const char *name, int rps, int64_t total,
+			       void *cb_ctx), void *cb_ctx);
+
 /**
  * Reset network statistics.
  */
@@ -91,7 +157,7 @@ iproto_bound_address(void);
 } /* extern "C" */
 
 void
-iproto_init(void);
+iproto_init(int threads_count);
 
 void
 iproto_listen(const char *uri);
@@ -99,6 +165,29 @@ iproto_listen(const char *uri);
 void
 iproto_set_msg_max(int iproto_msg_max);
 
+void
+iproto_set_flush_interval(double interval);
+
+void
+iproto_set_class_msg_max(int limit);
+
+/**
+ * Toggle MSG_ZEROCOPY sends for large responses. Affects new
+ * connections only; has no effect on platforms without zerocopy
+ * support.
+ */
+void
+iproto_set_zerocopy(bool zerocopy);
+
+/**
+ * Toggle io_uring batched socket reads in the network threads.
+ * Must be called before iproto_init(): the setting is read once
+ * at thread start. On platforms or kernels without io_uring the
+ * threads fall back to plain reads with a warning.
+ */
+void
+iproto_set_iouring(bool use);
+
 void
 iproto_free(void);
 
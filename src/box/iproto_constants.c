@@ -89,6 +89,7 @@ const unsigned char iproto_key_type[IPROTO_KEY_MAX] =
 	/* 0x29 */	MP_MAP, /* IPROTO_BALLOT */
 	/* 0x2a */	MP_MAP, /* IPROTO_TUPLE_META */
 	/* 0x2b */	MP_MAP, /* IPROTO_OPTIONS */
+	/* 0x2c */	MP_UINT, /* IPROTO_STREAM */
 	/* }}} */
 };
 
@@ -174,7 +175,7 @@ const char *iproto_key_strs[IPROTO_KEY_MAX] = {
 	"ballot",           /* 0x29 */
 	"tuple meta",       /* 0x2a */
 	"options",          /* 0x2b */
-	NULL,               /* 0x2c */
+	"stream",           /* 0x2c */
 	NULL,               /* 0x2d */
 	NULL,               /* 0x2e */
 	NULL,               /* 0x2f */
@@ -98,6 +98,14 @@ enum iproto_key {
 	IPROTO_BALLOT = 0x29,
 	IPROTO_TUPLE_META = 0x2a,
 	IPROTO_OPTIONS = 0x2b,
+	/**
+	 * Number of tuples per chunk in a streamed SELECT or
+	 * EXECUTE (DQL) response. When > 0, the response is sent
+	 * as a sequence of IPROTO_CHUNK packets followed by an
+	 * ordinary reply with the tail, instead of one huge
+	 * packet.
+	 */
+	IPROTO_STREAM = 0x2c,
 
 	/* Leave a gap between request keys and response keys */
 	IPROTO_DATA = 0x30,
@@ -127,6 +135,20 @@ enum iproto_key {
 	IPROTO_REPLICA_ANON = 0x50,
 	IPROTO_ID_FILTER = 0x51,
 	IPROTO_ERROR = 0x52,
+	/**
+	 * List of space ids the replica subscribes to. Rows of
+	 * other non-system spaces are relayed as NOPs.
+	 */
+	IPROTO_SPACE_FILTER = 0x53,
+	/** Protocol version, in IPROTO_ID request and response. */
+	IPROTO_VERSION = 0x54,
+	/**
+	 * Bitmap of protocol features, @sa enum iproto_feature.
+	 * In an IPROTO_ID request - the features the client would
+	 * like to use, in the response - the subset the server has
+	 * granted.
+	 */
+	IPROTO_FEATURES = 0x55,
 	IPROTO_KEY_MAX
 };
 
@@ -152,13 +174,35 @@ enum iproto_ballot_key {
 	IPROTO_BALLOT_IS_ANON = 0x05,
 };
 
+/**
+ * Optional features which a client may negotiate with an
+ * IPROTO_ID request before using them.
+ */
+enum iproto_feature {
+	/**
+	 * Streaming zstd compression of the connection. Once
+	 * granted, the client wraps everything it sends after the
+	 * ID request into a zstd stream and the server does the
+	 * same with everything it sends after the ID response.
+	 */
+	IPROTO_FEATURE_COMPRESSION = 0,
+};
+
+enum {
+	/** Version of the protocol implemented by this server. */
+	IPROTO_CURRENT_VERSION = 1,
+	/** Bitmap of the features this server can provide. */
+	IPROTO_CURRENT_FEATURES = 1 << IPROTO_FEATURE_COMPRESSION,
+};
+
 #define bit(c) (1ULL<<IPROTO_##c)
 
 #define IPROTO_HEAD_BMAP (bit(REQUEST_TYPE) | bit(SYNC) | bit(REPLICA_ID) |\
 			  bit(LSN) | bit(SCHEMA_VERSION))
 #define IPROTO_DML_BODY_BMAP (bit(SPACE_ID) | bit(INDEX_ID) | bit(LIMIT) |\
 			      bit(OFFSET) | bit(ITERATOR) | bit(INDEX_BASE) |\
-			      bit(KEY) | bit(TUPLE) | bit(OPS) | bit(TUPLE_META))
+			      bit(KEY) | bit(TUPLE) | bit(OPS) | bit(TUPLE_META) |\
+			      bit(STREAM))
 
 static inline bool
 xrow_header_has_key(const char *pos, const char *end)
@@ -241,6 +285,12 @@ enum iproto_type {
 	IPROTO_FETCH_SNAPSHOT = 69,
 	/** REGISTER request to leave anonymous replication. */
 	IPROTO_REGISTER = 70,
+	/**
+	 * Protocol features request. The client reports its
+	 * protocol version and the features it would like to use,
+	 * the server responds with the subset it has granted.
+	 */
+	IPROTO_ID = 73,
 
 	/** Vinyl run info stored in .index file */
 	VY_INDEX_RUN_INFO = 100,
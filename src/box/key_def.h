@@ -184,6 +184,10 @@ struct key_def {
 	tuple_hash_t tuple_hash;
 	/** @see key_hash() */
 	key_hash_t key_hash;
+	/** @see tuple_hash_fast() */
+	tuple_hash_t tuple_hash_fast;
+	/** @see key_hash_fast() */
+	key_hash_t key_hash_fast;
 	/** @see tuple_hint() */
 	tuple_hint_t tuple_hint;
 	/** @see key_hint() */
@@ -1049,6 +1053,38 @@ key_hash(const char *key, struct key_def *key_def)
 	return key_def->key_hash(key, key_def);
 }
 
+/**
+ * Calculate a hash value for a tuple with the fastest hash
+ * function available on this CPU (hardware CRC32-C when SSE 4.2
+ * or the ARMv8 CRC32 instructions are present). The values are
+ * not compatible with tuple_hash() and not stable across
+ * restarts or architectures, so they must only be used for
+ * in-memory hash tables that are rebuilt on recovery, e.g. the
+ * memtx HASH index. Anything that ends up on disk, like vinyl
+ * bloom filters, must use tuple_hash().
+ * @param tuple - a tuple
+ * @param key_def - key_def for field description
+ * @return - hash value
+ */
+static inline uint32_t
+tuple_hash_fast(struct tuple *tuple, struct key_def *key_def)
+{
+	return key_def->tuple_hash_fast(tuple, key_def);
+}
+
+/**
+ * Calculate a hash value for a key, consistent with
+ * tuple_hash_fast(). See the stability caveats there.
+ * @param key - full key (msgpack fields w/o array marker)
+ * @param key_def - key_def for field description
+ * @return - hash value
+ */
+static inline uint32_t
+key_hash_fast(const char *key, struct key_def *key_def)
+{
+	return key_def->key_hash_fast(key, key_def);
+}
+
  /*
  * Get comparison hint for a tuple.
  * @param tuple - tuple to compute the hint for
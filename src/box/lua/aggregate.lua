@@ -0,0 +1,342 @@
+-- aggregate.lua (internal file)
+--
+-- Materialized aggregates: a target space holding one row per
+-- group-by key with count/sum/min/max over a source space,
+-- maintained incrementally from an on_replace trigger. The
+-- target updates happen inside the same transaction as the
+-- source DML, so the pair commits (and replicates) atomically
+-- with a single WAL write.
+--
+-- Definitions are runtime objects, like any Lua trigger: the
+-- target space and its contents persist, but register() must be
+-- called again after restart to re-attach the trigger. Rows
+-- applied by the replication applier do not fire the trigger -
+-- the master's target updates arrive through replication
+-- themselves.
+
+local ops = {
+    count = true,
+    sum = true,
+    min = true,
+    max = true,
+}
+
+-- name -> {source_id, target_id, key, aggs, trigger}
+local registry = {}
+
+local function illegal(msg)
+    box.error(box.error.ILLEGAL_PARAMS, msg)
+end
+
+local function key_of(def, tuple)
+    local key = {}
+    for i, fieldno in ipairs(def.key) do
+        key[i] = tuple[fieldno]
+    end
+    return key
+end
+
+-- Position of the i-th aggregate value in a target row:
+-- group key fields, then the group row count, then the values.
+local function value_pos(def, i)
+    return #def.key + 1 + i
+end
+
+local function agg_input(agg, tuple)
+    if agg.op == 'count' then
+        return 1
+    end
+    return tuple[agg.field]
+end
+
+-- Recompute a min/max from scratch by scanning the source group.
+-- Needed when the row holding the current extremum goes away; the
+-- source is already updated when on_replace triggers run, so a
+-- plain scan gives the new value.
+local function recompute(def, key, agg)
+    local index = box.space[def.source_id].index[def.source_index]
+    local best
+    for _, tuple in index:pairs(key, {iterator = 'EQ'}) do
+        local v = tuple[agg.field]
+        if v ~= nil then
+            if best == nil or (agg.op == 'min' and v < best) or
+               (agg.op == 'max' and v > best) then
+                best = v
+            end
+        end
+    end
+    return best
+end
+
+local function row_new(def, key, tuple)
+    local row = {}
+    for i, v in ipairs(key) do
+        row[i] = v
+    end
+    row[#def.key + 1] = 1
+    for i, agg in ipairs(def.aggs) do
+        local v = agg_input(agg, tuple)
+        if agg.op == 'sum' then
+            v = v or 0
+        end
+        row[value_pos(def, i)] = v == nil and box.NULL or v
+    end
+    return row
+end
+
+local function group_add(def, target, key, tuple)
+    local row = target:get(key)
+    if row == nil then
+        target:insert(row_new(def, key, tuple))
+        return
+    end
+    row = row:totable()
+    row[#def.key + 1] = row[#def.key + 1] + 1
+    for i, agg in ipairs(def.aggs) do
+        local pos = value_pos(def, i)
+        local v = agg_input(agg, tuple)
+        if agg.op == 'count' then
+            row[pos] = row[pos] + 1
+        elseif agg.op == 'sum' then
+            row[pos] = row[pos] + (v or 0)
+        elseif v ~= nil then
+            local cur = row[pos]
+            if cur == nil or (agg.op == 'min' and v < cur) or
+               (agg.op == 'max' and v > cur) then
+                row[pos] = v
+            end
+        end
+    end
+    target:replace(row)
+end
+
+local function group_remove(def, target, key, tuple)
+    local row = target:get(key)
+    if row == nil then
+        return
+    end
+    local count = row[#def.key + 1] - 1
+    if count == 0 then
+        target:delete(key)
+        return
+    end
+    row = row:totable()
+    row[#def.key + 1] = count
+    for i, agg in ipairs(def.aggs) do
+        local pos = value_pos(def, i)
+        local v = agg_input(agg, tuple)
+        if agg.op == 'count' then
+            row[pos] = row[pos] - 1
+        elseif agg.op == 'sum' then
+            row[pos] = row[pos] - (v or 0)
+        elseif v ~= nil and v == row[pos] then
+            local best = recompute(def, key, agg)
+            row[pos] = best == nil and box.NULL or best
+        end
+    end
+    target:replace(row)
+end
+
+local function group_update(def, target, key, old, new)
+    local row = target:get(key)
+    if row == nil then
+        return
+    end
+    row = row:totable()
+    for i, agg in ipairs(def.aggs) do
+        local pos = value_pos(def, i)
+        local ov = agg_input(agg, old)
+        local nv = agg_input(agg, new)
+        if agg.op == 'sum' then
+            row[pos] = row[pos] - (ov or 0) + (nv or 0)
+        elseif agg.op == 'min' or agg.op == 'max' then
+            local cur = row[pos]
+            if nv ~= nil and (cur == nil or
+               (agg.op == 'min' and nv < cur) or
+               (agg.op == 'max' and nv > cur)) then
+                row[pos] = nv
+            elseif ov ~= nil and ov == cur and nv ~= ov then
+                local best = recompute(def, key, agg)
+                row[pos] = best == nil and box.NULL or best
+            end
+        end
+    end
+    target:replace(row)
+end
+
+local function keys_equal(a, b)
+    for i = 1, #a do
+        if a[i] ~= b[i] then
+            return false
+        end
+    end
+    return true
+end
+
+local function on_replace(def, old, new)
+    -- The master's target updates replicate on their own.
+    if box.session.type() == 'applier' then
+        return
+    end
+    local target = box.space[def.target_id]
+    if target == nil then
+        return
+    end
+    if old ~= nil and new ~= nil then
+        local old_key = key_of(def, old)
+        local new_key = key_of(def, new)
+        if keys_equal(old_key, new_key) then
+            group_update(def, target, old_key, old, new)
+            return
+        end
+        group_remove(def, target, old_key, old)
+        group_add(def, target, new_key, new)
+        return
+    end
+    if old ~= nil then
+        group_remove(def, target, key_of(def, old), old)
+    end
+    if new ~= nil then
+        group_add(def, target, key_of(def, new), new)
+    end
+end
+
+-- Find a source TREE index whose first parts are exactly the
+-- group-by fields, for min/max recomputation.
+local function find_group_index(source, key)
+    for i = 0, #source.index do
+        local index = source.index[i]
+        if index ~= nil and index.type == 'TREE' and
+           #index.parts >= #key then
+            local match = true
+            for j, fieldno in ipairs(key) do
+                if index.parts[j].fieldno ~= fieldno then
+                    match = false
+                    break
+                end
+            end
+            if match then
+                return i
+            end
+        end
+    end
+    return nil
+end
+
+-- Build the initial target contents with a full source scan.
+-- Runs in one transaction; there are no yields between trigger
+-- installation and commit, so no concurrent write can be lost
+-- or double-counted.
+local function initial_build(def, source, target)
+    for _, tuple in source:pairs() do
+        group_add(def, target, key_of(def, tuple), tuple)
+    end
+end
+
+box.schema.aggregate = {}
+
+box.schema.aggregate.register = function(name, opts)
+    if type(name) ~= 'string' then
+        illegal("name: expected string")
+    end
+    opts = opts or {}
+    if registry[name] ~= nil then
+        if opts.if_not_exists then
+            return box.space[name]
+        end
+        illegal("aggregate '" .. name .. "' is already registered")
+    end
+    local source = box.space[opts.source]
+    if source == nil then
+        box.error(box.error.NO_SUCH_SPACE, tostring(opts.source))
+    end
+    if type(opts.key) ~= 'table' or #opts.key == 0 then
+        illegal("options.key: expected a non-empty array of field numbers")
+    end
+    for _, fieldno in ipairs(opts.key) do
+        if type(fieldno) ~= 'number' then
+            illegal("options.key: expected a non-empty array of field numbers")
+        end
+    end
+    if type(opts.aggregates) ~= 'table' or #opts.aggregates == 0 then
+        illegal("options.aggregates: expected a non-empty array of " ..
+                "{op[, field]} pairs")
+    end
+    local aggs = {}
+    local need_group_index = false
+    for i, spec in ipairs(opts.aggregates) do
+        local op = spec[1]
+        if not ops[op] then
+            illegal("options.aggregates: unknown operation " ..
+                    tostring(op))
+        end
+        if op ~= 'count' and type(spec[2]) ~= 'number' then
+            illegal("options.aggregates: " .. op ..
+                    " requires a field number")
+        end
+        if op == 'min' or op == 'max' then
+            need_group_index = true
+        end
+        aggs[i] = {op = op, field = spec[2]}
+    end
+    local source_index
+    if need_group_index then
+        source_index = find_group_index(source, opts.key)
+        if source_index == nil then
+            illegal("min/max aggregates require a source TREE index " ..
+                    "starting with the group-by fields")
+        end
+    end
+    local existed = box.space[name] ~= nil
+    local target = box.schema.space.create(name, {if_not_exists = existed})
+    if not existed then
+        local parts = {}
+        for i = 1, #opts.key do
+            parts[#parts + 1] = i
+            parts[#parts + 1] = 'scalar'
+        end
+        target:create_index('primary', {parts = parts})
+    end
+    local def = {
+        source_id = source.id,
+        target_id = target.id,
+        key = opts.key,
+        aggs = aggs,
+        source_index = source_index,
+    }
+    def.trigger = function(old, new)
+        return on_replace(def, old, new)
+    end
+    box.begin()
+    local ok, err = pcall(function()
+        -- A pre-existing target keeps its rows: the space holds
+        -- the state built before restart and the trigger resumes
+        -- from it.
+        if not existed then
+            initial_build(def, source, target)
+        end
+        source:on_replace(def.trigger)
+    end)
+    if not ok then
+        box.rollback()
+        error(err)
+    end
+    box.commit()
+    registry[name] = def
+    return target
+end
+
+box.schema.aggregate.unregister = function(name, opts)
+    local def = registry[name]
+    if def == nil then
+        if opts ~= nil and opts.if_exists then
+            return
+        end
+        illegal("aggregate '" .. tostring(name) .. "' is not registered")
+    end
+    local source = box.space[def.source_id]
+    if source ~= nil then
+        source:on_replace(nil, def.trigger)
+    end
+    registry[name] = nil
+end
@@ -0,0 +1,219 @@
+-- bench.lua -- built-in workload benchmark driver
+--
+-- Generates a configurable read/write load against a space of a
+-- local or remote instance and reports throughput and latency
+-- percentiles from a log-bucketed (HDR-style) histogram, so that
+-- box.cfg tunings can be compared with standardized numbers:
+--
+--     local bench = require('bench')
+--     bench.run({
+--         uri = 'localhost:3301',  -- nil to hit box directly
+--         space = 'bench',
+--         duration = 10,           -- seconds
+--         fibers = 32,             -- concurrent request fibers
+--         keys = 1000000,          -- key range
+--         value_size = 64,         -- payload bytes
+--         read_ratio = 0.95,      -- reads vs replaces
+--         distribution = 'zipfian',-- or 'uniform'
+--         zipf_theta = 0.99,
+--         load = true,             -- preload the key range
+--     })
+
+local clock = require('clock')
+local fiber = require('fiber')
+local digest = require('digest')
+
+--
+-- Latency histogram with two significant digits: microsecond
+-- values are bucketed as <two leading digits> x 10^<decade>,
+-- giving a constant <= 10% relative error like HDR histograms.
+-- Recording is a few integer divisions; memory is 100 slots per
+-- decade.
+--
+local DECADES = 8 -- 1us .. ~100s
+
+local function hist_new()
+    local h = {count = 0, max = 0, buckets = {}}
+    for i = 1, DECADES * 100 do
+        h.buckets[i] = 0
+    end
+    return h
+end
+
+local function hist_record(h, us)
+    if us > h.max then
+        h.max = us
+    end
+    local v = math.floor(us)
+    local decade = 0
+    while v >= 100 do
+        v = math.floor(v / 10)
+        decade = decade + 1
+    end
+    if decade >= DECADES then
+        decade = DECADES - 1
+        v = 99
+    end
+    local i = decade * 100 + v + 1
+    h.buckets[i] = h.buckets[i] + 1
+    h.count = h.count + 1
+end
+
+local function hist_percentile(h, p)
+    local target = h.count * p
+    local seen = 0
+    for i = 1, DECADES * 100 do
+        seen = seen + h.buckets[i]
+        if seen >= target then
+            local decade = math.floor((i - 1) / 100)
+            local slot = (i - 1) % 100
+            return slot * 10 ^ decade
+        end
+    end
+    return h.max
+end
+
+--
+-- Key distributions. The zipfian generator is the standard YCSB
+-- construction: most of the load lands on a stable set of hot
+-- keys scattered over the range.
+--
+local function uniform_new(keys)
+    return function()
+        return math.random(keys)
+    end
+end
+
+local function zipfian_new(keys, theta)
+    local zetan = 0
+    for i = 1, keys do
+        zetan = zetan + 1 / i ^ theta
+    end
+    local zeta2 = 1 + 1 / 2 ^ theta
+    local alpha = 1 / (1 - theta)
+    local eta = (1 - (2 / keys) ^ (1 - theta)) / (1 - zeta2 / zetan)
+    return function()
+        local u = math.random()
+        local uz = u * zetan
+        if uz < 1 then
+            return 1
+        end
+        if uz < zeta2 then
+            return 2
+        end
+        local rank = math.floor(keys * (eta * u - eta + 1) ^ alpha) + 1
+        -- Scatter the rank so hot keys are not neighbours.
+        return 1 + (rank * 2654435761) % keys
+    end
+end
+
+local function check_options(opts)
+    opts = opts or {}
+    local cfg = {
+        uri = opts.uri,
+        space = opts.space or 'bench',
+        duration = opts.duration or 10,
+        fibers = opts.fibers or 32,
+        connections = opts.connections or 4,
+        keys = opts.keys or 100000,
+        value_size = opts.value_size or 64,
+        read_ratio = opts.read_ratio or 0.95,
+        distribution = opts.distribution or 'uniform',
+        zipf_theta = opts.zipf_theta or 0.99,
+        load = opts.load,
+    }
+    if cfg.distribution ~= 'uniform' and cfg.distribution ~= 'zipfian' then
+        error("bench: distribution must be 'uniform' or 'zipfian'")
+    end
+    if cfg.read_ratio < 0 or cfg.read_ratio > 1 then
+        error("bench: read_ratio must be in [0, 1]")
+    end
+    return cfg
+end
+
+-- One target per connection; local mode has a single target.
+local function make_targets(cfg)
+    local targets = {}
+    if cfg.uri == nil then
+        local space = box.space[cfg.space]
+        if space == nil then
+            error('bench: no space ' .. cfg.space)
+        end
+        targets[1] = space
+    else
+        local net_box = require('net.box')
+        for i = 1, cfg.connections do
+            local conn = net_box.connect(cfg.uri)
+            if conn.space == nil or conn.space[cfg.space] == nil then
+                error('bench: no space ' .. cfg.space .. ' on ' .. cfg.uri)
+            end
+            targets[i] = conn.space[cfg.space]
+        end
+    end
+    return targets
+end
+
+local function preload(cfg, target)
+    local value = digest.urandom(cfg.value_size)
+    for key = 1, cfg.keys do
+        target:replace{key, value}
+    end
+end
+
+local function run(opts)
+    local cfg = check_options(opts)
+    local targets = make_targets(cfg)
+    if cfg.load then
+        preload(cfg, targets[1])
+    end
+    local hist = hist_new()
+    local value = digest.urandom(cfg.value_size)
+    local deadline = clock.monotonic() + cfg.duration
+    local reads, writes = 0, 0
+    local workers = {}
+    for i = 1, cfg.fibers do
+        workers[i] = fiber.new(function()
+            local next_key = cfg.distribution == 'zipfian' and
+                zipfian_new(cfg.keys, cfg.zipf_theta) or
+                uniform_new(cfg.keys)
+            local target = targets[1 + (i - 1) % #targets]
+            while clock.monotonic() < deadline do
+                local key = next_key()
+                local start = clock.monotonic64()
+                if math.random() < cfg.read_ratio then
+                    target:get(key)
+                    reads = reads + 1
+                else
+                    target:replace{key, value}
+                    writes = writes + 1
+                end
+                local us = tonumber(clock.monotonic64() - start) / 1000
+                hist_record(hist, us)
+            end
+        end)
+        workers[i]:set_joinable(true)
+    end
+    local start = clock.monotonic()
+    for _, w in ipairs(workers) do
+        w:join()
+    end
+    local elapsed = clock.monotonic() - start
+    return {
+        seconds = elapsed,
+        requests = hist.count,
+        reads = reads,
+        writes = writes,
+        rps = math.floor(hist.count / elapsed),
+        latency_us = {
+            p50 = hist_percentile(hist, 0.50),
+            p90 = hist_percentile(hist, 0.90),
+            p99 = hist_percentile(hist, 0.99),
+            p999 = hist_percentile(hist, 0.999),
+            max = hist.max,
+        },
+    }
+end
+
+package.loaded['bench'] = {
+    run = run,
+}
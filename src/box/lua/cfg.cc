@@ -131,6 +131,28 @@ lbox_cfg_set_snap_io_rate_limit(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_snap_io_backoff_latency(struct lua_State *L)
+{
+	try {
+		box_set_snap_io_backoff_latency();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
+static int
+lbox_cfg_set_checkpoint_threads(struct lua_State *L)
+{
+	try {
+		box_set_checkpoint_threads();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
 static int
 lbox_cfg_set_checkpoint_count(struct lua_State *L)
 {
@@ -164,6 +186,50 @@ lbox_cfg_set_checkpoint_wal_threshold(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_checkpoint_min_wal_size(struct lua_State *L)
+{
+	try {
+		box_set_checkpoint_min_wal_size();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
+static int
+lbox_cfg_set_gc_unlink_rate(struct lua_State *L)
+{
+	try {
+		box_set_gc_unlink_rate();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
+static int
+lbox_cfg_set_wal_sync_size(struct lua_State *L)
+{
+	try {
+		box_set_wal_sync_size();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
+static int
+lbox_cfg_set_wal_hiccup_threshold(struct lua_State *L)
+{
+	try {
+		box_set_wal_hiccup_threshold();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
 static int
 lbox_cfg_set_read_only(struct lua_State *L)
 {
@@ -197,6 +263,17 @@ lbox_cfg_set_memtx_max_tuple_size(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_memtx_compaction(struct lua_State *L)
+{
+	try {
+		box_set_memtx_compaction();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
 static int
 lbox_cfg_set_vinyl_memory(struct lua_State *L)
 {
@@ -252,6 +329,39 @@ lbox_cfg_set_net_msg_max(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_net_flush_interval(struct lua_State *L)
+{
+	try {
+		box_set_net_flush_interval();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
+static int
+lbox_cfg_set_net_class_msg_max(struct lua_State *L)
+{
+	try {
+		box_set_net_class_msg_max();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
+static int
+lbox_cfg_set_net_zerocopy(struct lua_State *L)
+{
+	try {
+		box_set_net_zerocopy();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
 static int
 lbox_set_prepared_stmt_cache_size(struct lua_State *L)
 {
@@ -296,6 +406,17 @@ lbox_cfg_set_replication_timeout(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_replication_ack_period(struct lua_State *L)
+{
+	try {
+		box_set_replication_ack_period();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
 static int
 lbox_cfg_set_replication_connect_timeout(struct lua_State *L)
 {
@@ -396,12 +517,19 @@ box_lua_cfg_init(struct lua_State *L)
 		{"cfg_set_io_collect_interval", lbox_cfg_set_io_collect_interval},
 		{"cfg_set_too_long_threshold", lbox_cfg_set_too_long_threshold},
 		{"cfg_set_snap_io_rate_limit", lbox_cfg_set_snap_io_rate_limit},
+		{"cfg_set_snap_io_backoff_latency", lbox_cfg_set_snap_io_backoff_latency},
+		{"cfg_set_checkpoint_threads", lbox_cfg_set_checkpoint_threads},
 		{"cfg_set_checkpoint_count", lbox_cfg_set_checkpoint_count},
 		{"cfg_set_checkpoint_interval", lbox_cfg_set_checkpoint_interval},
 		{"cfg_set_checkpoint_wal_threshold", lbox_cfg_set_checkpoint_wal_threshold},
+		{"cfg_set_checkpoint_min_wal_size", lbox_cfg_set_checkpoint_min_wal_size},
+		{"cfg_set_gc_unlink_rate", lbox_cfg_set_gc_unlink_rate},
+		{"cfg_set_wal_sync_size", lbox_cfg_set_wal_sync_size},
+		{"cfg_set_wal_hiccup_threshold", lbox_cfg_set_wal_hiccup_threshold},
 		{"cfg_set_read_only", lbox_cfg_set_read_only},
 		{"cfg_set_memtx_memory", lbox_cfg_set_memtx_memory},
 		{"cfg_set_memtx_max_tuple_size", lbox_cfg_set_memtx_max_tuple_size},
+		{"cfg_set_memtx_compaction", lbox_cfg_set_memtx_compaction},
 		{"cfg_set_vinyl_memory", lbox_cfg_set_vinyl_memory},
 		{"cfg_set_vinyl_max_tuple_size", lbox_cfg_set_vinyl_max_tuple_size},
 		{"cfg_set_vinyl_cache", lbox_cfg_set_vinyl_cache},
@@ -409,6 +537,7 @@ box_lua_cfg_init(struct lua_State *L)
 		{"cfg_set_election_mode", lbox_cfg_set_election_mode},
 		{"cfg_set_election_timeout", lbox_cfg_set_election_timeout},
 		{"cfg_set_replication_timeout", lbox_cfg_set_replication_timeout},
+		{"cfg_set_replication_ack_period", lbox_cfg_set_replication_ack_period},
 		{"cfg_set_replication_connect_quorum", lbox_cfg_set_replication_connect_quorum},
 		{"cfg_set_replication_connect_timeout", lbox_cfg_set_replication_connect_timeout},
 		{"cfg_set_replication_sync_lag", lbox_cfg_set_replication_sync_lag},
@@ -418,6 +547,9 @@ box_lua_cfg_init(struct lua_State *L)
 		{"cfg_set_replication_skip_conflict", lbox_cfg_set_replication_skip_conflict},
 		{"cfg_set_replication_anon", lbox_cfg_set_replication_anon},
 		{"cfg_set_net_msg_max", lbox_cfg_set_net_msg_max},
+		{"cfg_set_net_flush_interval", lbox_cfg_set_net_flush_interval},
+		{"cfg_set_net_class_msg_max", lbox_cfg_set_net_class_msg_max},
+		{"cfg_set_net_zerocopy", lbox_cfg_set_net_zerocopy},
 		{"cfg_set_sql_cache_size", lbox_set_prepared_stmt_cache_size},
 		{"cfg_set_crash", lbox_cfg_set_crash},
 		{NULL, NULL}
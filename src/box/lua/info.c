@@ -445,6 +445,10 @@ lbox_info_gc_call(struct lua_State *L)
 	lua_pushboolean(L, gc.checkpoint_is_in_progress);
 	lua_settable(L, -3);
 
+	lua_pushstring(L, "wal_cleanup_backlog");
+	lua_pushnumber(L, gc.wal_cleanup_backlog);
+	lua_settable(L, -3);
+
 	lua_pushstring(L, "checkpoints");
 	lua_newtable(L);
 
@@ -582,7 +586,7 @@ static int
 lbox_info_election(struct lua_State *L)
 {
 	struct raft *raft = box_raft();
-	lua_createtable(L, 0, 4);
+	lua_createtable(L, 0, 5);
 	lua_pushstring(L, raft_state_str(raft->state));
 	lua_setfield(L, -2, "state");
 	luaL_pushuint64(L, raft->volatile_term);
@@ -591,6 +595,20 @@ lbox_info_election(struct lua_State *L)
 	lua_setfield(L, -2, "vote");
 	lua_pushinteger(L, raft->leader);
 	lua_setfield(L, -2, "leader");
+	lua_pushnumber(L, box_raft_leader_lease_remaining());
+	lua_setfield(L, -2, "lease");
+	return 1;
+}
+
+static int
+lbox_info_startup(struct lua_State *L)
+{
+	lua_createtable(L, 0, box_startup_stage_MAX);
+	for (int i = 0; i < box_startup_stage_MAX; i++) {
+		lua_pushnumber(L, box_startup_duration(
+					(enum box_startup_stage)i));
+		lua_setfield(L, -2, box_startup_stage_strs[i]);
+	}
 	return 1;
 }
 
@@ -613,6 +631,7 @@ static const struct luaL_Reg lbox_info_dynamic_meta[] = {
 	{"sql", lbox_info_sql},
 	{"listen", lbox_info_listen},
 	{"election", lbox_info_election},
+	{"startup", lbox_info_startup},
 	{NULL, NULL}
 };
 
@@ -73,12 +73,14 @@ extern char session_lua[],
 	tuple_lua[],
 	key_def_lua[],
 	schema_lua[],
+	aggregate_lua[],
 	load_cfg_lua[],
 	xlog_lua[],
 #if ENABLE_FEEDBACK_DAEMON
 	feedback_daemon_lua[],
 #endif
 	net_box_lua[],
+	bench_lua[],
 	upgrade_lua[],
 	console_lua[],
 	merger_lua[];
@@ -87,6 +89,8 @@ static const char *lua_sources[] = {
 	"box/session", session_lua,
 	"box/tuple", tuple_lua,
 	"box/schema", schema_lua,
+	/* Attaches to box.schema, must follow it. */
+	"box/aggregate", aggregate_lua,
 #if ENABLE_FEEDBACK_DAEMON
 	/*
 	 * It is important to initialize the daemon before
@@ -97,6 +101,7 @@ static const char *lua_sources[] = {
 #endif
 	"box/upgrade", upgrade_lua,
 	"box/net_box", net_box_lua,
+	"box/bench", bench_lua,
 	"box/console", console_lua,
 	"box/load_cfg", load_cfg_lua,
 	"box/xlog", xlog_lua,
@@ -412,9 +417,18 @@ luamp_encode_extension_box(struct lua_State *L, int idx,
 		return MP_ARRAY;
 	}
 	struct error *err = luaL_iserror(L, idx);
-	struct serializer_opts *opts = &current_session()->meta.serializer_opts;
-	if (err != NULL && opts->error_marshaling_enabled)
-		error_to_mpstream(err, stream);
+	if (err != NULL) {
+		/*
+		 * This handler runs for every encoded extension
+		 * value, most of which are tuples. Resolve the
+		 * session serializer options only when they are
+		 * actually consulted, i.e. for errors.
+		 */
+		const struct serializer_opts *opts =
+			&current_session()->meta.serializer_opts;
+		if (opts->error_marshaling_enabled)
+			error_to_mpstream(err, stream);
+	}
 
 	return MP_EXT;
 }
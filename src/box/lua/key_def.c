@@ -29,6 +29,8 @@
  * SUCH DAMAGE.
  */
 
+#include <msgpuck.h>
+
 #include "box/coll_id_cache.h"
 #include "box/lua/key_def.h"
 #include "box/tuple.h"
@@ -239,6 +241,85 @@ luaT_key_def_check_tuple(struct lua_State *L, struct key_def *key_def, int idx)
 	return tuple;
 }
 
+/**
+ * Check whether a key may be extracted right from raw msgpack
+ * @a data with tuple_extract_key_raw(): every field required by
+ * a non-nullable part must be present and a missing field of a
+ * nullable part must be handled by the optional parts support of
+ * the extractor. JSON path parts are not applicable: the raw
+ * extractor can not report a missing path leaf. When the check
+ * fails the caller is expected to fall back to a temporary
+ * tuple, which reports a missing field with a proper diag.
+ */
+static bool
+luaT_key_def_can_extract_raw(struct key_def *key_def, const char *data)
+{
+	assert(mp_typeof(*data) == MP_ARRAY);
+	if (key_def->has_json_paths)
+		return false;
+	uint32_t field_count = mp_decode_array(&data);
+	if (field_count == 0)
+		return false;
+	for (uint32_t i = 0; i < key_def->part_count; ++i) {
+		const struct key_part *part = &key_def->parts[i];
+		if (part->fieldno < field_count)
+			continue;
+		if (!key_part_is_nullable(part) ||
+		    !key_def->has_optional_parts)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Extract the key from a tuple or a Lua table at @a idx to a
+ * buffer allocated on the fiber gc region.
+ *
+ * A table argument is extracted right from its msgpack
+ * serialization: no point in creating a temporary tuple which is
+ * thrown away as soon as the key is copied out of it. The
+ * extracted key is validated against the key definition instead
+ * of the source tuple fields, which gives the same checks on
+ * the same data.
+ *
+ * The caller is responsible for truncating the region.
+ * Returns not NULL key pointer on success, NULL otherwise and
+ * sets a diag.
+ */
+static char *
+luaT_key_def_extract(struct lua_State *L, struct key_def *key_def, int idx,
+		     uint32_t *key_size)
+{
+	struct tuple *tuple = luaT_istuple(L, idx);
+	if (tuple == NULL && lua_istable(L, idx)) {
+		size_t data_len;
+		const char *data = lbox_encode_tuple_on_gc(L, idx, &data_len);
+		if (luaT_key_def_can_extract_raw(key_def, data)) {
+			char *key = tuple_extract_key_raw(data,
+							  data + data_len,
+							  key_def,
+							  MULTIKEY_NONE,
+							  key_size);
+			if (key == NULL ||
+			    box_key_def_validate_full_key(key_def, key,
+							  NULL) != 0)
+				return NULL;
+			return key;
+		}
+	}
+	if (tuple == NULL) {
+		tuple = luaT_tuple_new(L, idx, box_tuple_format_default());
+		if (tuple == NULL)
+			return NULL;
+	}
+	if (tuple_validate_key_parts(key_def, tuple) != 0)
+		return NULL;
+	tuple_ref(tuple);
+	char *key = tuple_extract_key(tuple, key_def, MULTIKEY_NONE, key_size);
+	tuple_unref(tuple);
+	return key;
+}
+
 struct key_def *
 luaT_check_key_def(struct lua_State *L, int idx)
 {
@@ -277,17 +358,14 @@ lbox_key_def_extract_key(struct lua_State *L)
 	if (lua_gettop(L) != 2 || (key_def = luaT_check_key_def(L, 1)) == NULL)
 		return luaL_error(L, "Usage: key_def:extract_key(tuple)");
 
-	struct tuple *tuple;
-	if ((tuple = luaT_key_def_check_tuple(L, key_def, 2)) == NULL)
-		return luaT_error(L);
-
 	struct region *region = &fiber()->gc;
 	size_t region_svp = region_used(region);
 	uint32_t key_size;
-	char *key = tuple_extract_key(tuple, key_def, MULTIKEY_NONE, &key_size);
-	tuple_unref(tuple);
-	if (key == NULL)
+	char *key = luaT_key_def_extract(L, key_def, 2, &key_size);
+	if (key == NULL) {
+		region_truncate(region, region_svp);
 		return luaT_error(L);
+	}
 
 	struct tuple *ret =
 		tuple_new(tuple_format_runtime, key, key + key_size);
@@ -365,23 +443,48 @@ lbox_key_def_compare_with_key(struct lua_State *L)
 		return luaT_error(L);
 	}
 
-	struct tuple *tuple = luaT_key_def_check_tuple(L, key_def, 2);
-	if (tuple == NULL)
-		return luaT_error(L);
-
 	struct region *region = &fiber()->gc;
 	size_t region_svp = region_used(region);
+	struct tuple *tuple = luaT_istuple(L, 2);
+	uint32_t tuple_key_size;
+	char *tuple_key = NULL;
+	if (tuple != NULL) {
+		if (tuple_validate_key_parts(key_def, tuple) != 0)
+			return luaT_error(L);
+		tuple_ref(tuple);
+	} else {
+		/*
+		 * Fast path for a table argument: compare the
+		 * key extracted right from its msgpack
+		 * serialization instead of materializing a
+		 * temporary tuple.
+		 */
+		tuple_key = luaT_key_def_extract(L, key_def, 2,
+						 &tuple_key_size);
+		if (tuple_key == NULL) {
+			region_truncate(region, region_svp);
+			return luaT_error(L);
+		}
+	}
+
 	size_t key_len;
 	const char *key = lbox_encode_tuple_on_gc(L, 3, &key_len);
 	if (box_key_def_validate_key(key_def, key, NULL)) {
 		region_truncate(region, region_svp);
-		tuple_unref(tuple);
+		if (tuple != NULL)
+			tuple_unref(tuple);
 		return luaT_error(L);
 	}
 
-	int rc = box_tuple_compare_with_key(tuple, key, key_def);
+	int rc;
+	if (tuple != NULL) {
+		rc = box_tuple_compare_with_key(tuple, key, key_def);
+		tuple_unref(tuple);
+	} else {
+		rc = key_compare(tuple_key, HINT_NONE, key, HINT_NONE,
+				 key_def);
+	}
 	region_truncate(region, region_svp);
-	tuple_unref(tuple);
 	lua_pushinteger(L, rc);
 	return 1;
 }
@@ -42,6 +42,8 @@ local default_cfg = {
     strip_core          = true,
     memtx_min_tuple_size = 16,
     memtx_max_tuple_size = 1024 * 1024,
+    memtx_use_hugepages = false,
+    memtx_compaction    = false,
     slab_alloc_factor   = 1.05,
     work_dir            = nil,
     memtx_dir           = ".",
@@ -67,9 +69,13 @@ local default_cfg = {
     io_collect_interval = nil,
     readahead           = 16320,
     snap_io_rate_limit  = nil, -- no limit
+    snap_io_backoff_latency = nil, -- no backoff
     too_long_threshold  = 0.5,
     wal_mode            = "write",
     wal_max_size        = 256 * 1024 * 1024,
+    wal_sync_size       = 256 * 1024,
+    wal_hiccup_threshold = 0.05,
+    wal_direct          = false,
     wal_dir_rescan_delay= 2,
     force_recovery      = false,
     replication         = nil,
@@ -84,12 +90,16 @@ local default_cfg = {
     hot_standby         = false,
     memtx_use_mvcc_engine = false,
     checkpoint_interval = 3600,
+    checkpoint_min_wal_size = 0,
     checkpoint_wal_threshold = 1e18,
     checkpoint_count    = 2,
+    checkpoint_threads  = 1,
+    gc_unlink_rate      = 0,
     worker_pool_threads = 4,
     election_mode       = 'off',
     election_timeout    = 5,
     replication_timeout = 1,
+    replication_ack_period = 0,
     replication_sync_lag = 10,
     replication_sync_timeout = 300,
     replication_synchro_quorum = 1,
@@ -103,6 +113,12 @@ local default_cfg = {
     feedback_host         = "https://feedback.tarantool.io",
     feedback_interval     = 3600,
     net_msg_max           = 768,
+    net_flush_interval    = 0,
+    net_class_msg_max     = 0,
+    net_zerocopy          = false,
+    net_iouring           = false,
+    iproto_threads        = 1,
+    cpu_affinity          = nil,
     sql_cache_size        = 5 * 1024 * 1024,
 }
 
@@ -123,6 +139,8 @@ local template_cfg = {
     strip_core          = 'boolean',
     memtx_min_tuple_size  = 'number',
     memtx_max_tuple_size  = 'number',
+    memtx_use_hugepages = 'boolean',
+    memtx_compaction    = 'boolean',
     slab_alloc_factor   = 'number',
     work_dir            = 'string',
     memtx_dir            = 'string',
@@ -148,9 +166,13 @@ local template_cfg = {
     io_collect_interval = 'number',
     readahead           = 'number',
     snap_io_rate_limit  = 'number',
+    snap_io_backoff_latency = 'number',
     too_long_threshold  = 'number',
     wal_mode            = 'string',
     wal_max_size        = 'number',
+    wal_sync_size       = 'number',
+    wal_hiccup_threshold = 'number',
+    wal_direct          = 'boolean',
     wal_dir_rescan_delay= 'number',
     force_recovery      = 'boolean',
     replication         = 'string, number, table',
@@ -162,8 +184,11 @@ local template_cfg = {
     username            = 'string',
     coredump            = 'boolean',
     checkpoint_interval = 'number',
+    checkpoint_min_wal_size = 'number',
     checkpoint_wal_threshold = 'number',
     checkpoint_count    = 'number',
+    checkpoint_threads  = 'number',
+    gc_unlink_rate      = 'number',
     read_only           = 'boolean',
     hot_standby         = 'boolean',
     memtx_use_mvcc_engine = 'boolean',
@@ -171,6 +196,7 @@ local template_cfg = {
     election_mode       = 'string',
     election_timeout    = 'number',
     replication_timeout = 'number',
+    replication_ack_period = 'number',
     replication_sync_lag = 'number',
     replication_sync_timeout = 'number',
     replication_synchro_quorum = 'string, number',
@@ -179,11 +205,18 @@ local template_cfg = {
     replication_connect_quorum = 'number',
     replication_skip_conflict = 'boolean',
     replication_anon      = 'boolean',
+    replication_space_filter = 'table',
     feedback_enabled      = ifdef_feedback('boolean'),
     feedback_crashinfo    = ifdef_feedback('boolean'),
     feedback_host         = ifdef_feedback('string'),
     feedback_interval     = ifdef_feedback('number'),
     net_msg_max           = 'number',
+    net_flush_interval    = 'number',
+    net_class_msg_max     = 'number',
+    net_zerocopy          = 'boolean',
+    net_iouring           = 'boolean',
+    iproto_threads        = 'number',
+    cpu_affinity          = 'string',
     sql_cache_size        = 'number',
 }
 
@@ -267,16 +300,23 @@ local dynamic_cfg = {
     readahead               = private.cfg_set_readahead,
     too_long_threshold      = private.cfg_set_too_long_threshold,
     snap_io_rate_limit      = private.cfg_set_snap_io_rate_limit,
+    snap_io_backoff_latency = private.cfg_set_snap_io_backoff_latency,
     read_only               = private.cfg_set_read_only,
     memtx_memory            = private.cfg_set_memtx_memory,
     memtx_max_tuple_size    = private.cfg_set_memtx_max_tuple_size,
+    memtx_compaction        = private.cfg_set_memtx_compaction,
     vinyl_memory            = private.cfg_set_vinyl_memory,
     vinyl_max_tuple_size    = private.cfg_set_vinyl_max_tuple_size,
     vinyl_cache             = private.cfg_set_vinyl_cache,
     vinyl_timeout           = private.cfg_set_vinyl_timeout,
     checkpoint_count        = private.cfg_set_checkpoint_count,
+    checkpoint_threads      = private.cfg_set_checkpoint_threads,
     checkpoint_interval     = private.cfg_set_checkpoint_interval,
+    checkpoint_min_wal_size = private.cfg_set_checkpoint_min_wal_size,
     checkpoint_wal_threshold = private.cfg_set_checkpoint_wal_threshold,
+    gc_unlink_rate          = private.cfg_set_gc_unlink_rate,
+    wal_sync_size           = private.cfg_set_wal_sync_size,
+    wal_hiccup_threshold    = private.cfg_set_wal_hiccup_threshold,
     worker_pool_threads     = private.cfg_set_worker_pool_threads,
     feedback_enabled        = ifdef_feedback_set_params,
     feedback_crashinfo      = ifdef_feedback_set_params,
@@ -291,6 +331,7 @@ local dynamic_cfg = {
     election_mode           = private.cfg_set_election_mode,
     election_timeout        = private.cfg_set_election_timeout,
     replication_timeout     = private.cfg_set_replication_timeout,
+    replication_ack_period  = private.cfg_set_replication_ack_period,
     replication_connect_timeout = private.cfg_set_replication_connect_timeout,
     replication_connect_quorum = private.cfg_set_replication_connect_quorum,
     replication_sync_lag    = private.cfg_set_replication_sync_lag,
@@ -302,6 +343,9 @@ local dynamic_cfg = {
     instance_uuid           = check_instance_uuid,
     replicaset_uuid         = check_replicaset_uuid,
     net_msg_max             = private.cfg_set_net_msg_max,
+    net_flush_interval      = private.cfg_set_net_flush_interval,
+    net_class_msg_max       = private.cfg_set_net_class_msg_max,
+    net_zerocopy            = private.cfg_set_net_zerocopy,
     sql_cache_size          = private.cfg_set_sql_cache_size,
 }
 
@@ -363,6 +407,7 @@ local dynamic_cfg_skip_at_load = {
     vinyl_cache             = true,
     vinyl_timeout           = true,
     too_long_threshold      = true,
+    wal_hiccup_threshold    = true,
     election_mode           = true,
     election_timeout        = true,
     replication             = true,
@@ -381,6 +426,9 @@ local dynamic_cfg_skip_at_load = {
     instance_uuid           = true,
     replicaset_uuid         = true,
     net_msg_max             = true,
+    net_flush_interval      = true,
+    net_class_msg_max       = true,
+    net_zerocopy            = true,
     readahead               = true,
 }
 
@@ -41,6 +41,7 @@
 #include <lauxlib.h>         /* luaL_*() */
 
 #include "fiber.h"           /* fiber() */
+#include "fiber_cond.h"      /* fiber_cond_*() */
 #include "diag.h"            /* diag_set() */
 
 #include "box/tuple.h"       /* tuple_format_runtime,
@@ -54,6 +55,7 @@
 #include "box/lua/tuple.h"   /* luaT_tuple_new() */
 
 #include "small/ibuf.h"      /* struct ibuf */
+#include "small/rlist.h"     /* struct rlist */
 #include "msgpuck.h"         /* mp_*() */
 
 #include "box/merger.h"      /* merge_source_*, merger_*() */
@@ -66,8 +68,12 @@ static uint32_t CTID_STRUCT_MERGE_SOURCE_REF = 0;
  *
  * Such function is to be passed to lbox_merge_source_new() as
  * a parameter.
+ *
+ * @a prefetch is an amount of chunks to fetch ahead of the
+ * consumer in a background fiber, zero to fetch on demand.
  */
-typedef struct merge_source *(*luaL_merge_source_new_f)(struct lua_State *L);
+typedef struct merge_source *(*luaL_merge_source_new_f)(struct lua_State *L,
+							uint32_t prefetch);
 
 /* {{{ Helpers */
 
@@ -256,16 +262,41 @@ lbox_merge_source_new(struct lua_State *L, const char *func_name,
 		      luaL_merge_source_new_f luaL_merge_source_new)
 {
 	int top = lua_gettop(L);
-	if (top < 1 || top > 3 || !luaL_iscallable(L, 1))
+	if (top < 1 || top > 4 || !luaL_iscallable(L, 1))
 		return luaL_error(L, "Usage: %s(gen, param, state)", func_name);
 
+	/* Parse options. */
+	uint32_t prefetch = 0;
+	if (top == 4 && lua_isnil(L, 4)) {
+		lua_pop(L, 1);
+		top = 3;
+	}
+	if (top == 4) {
+		if (lua_istable(L, 4) == 0)
+			return luaL_error(L, "Usage: %s(gen, param, state[, "
+					  "{prefetch = <number>}])", func_name);
+		lua_pushstring(L, "prefetch");
+		lua_gettable(L, 4);
+		if (!lua_isnil(L, -1)) {
+			if (lua_isnumber(L, -1) == 0 ||
+			    lua_tonumber(L, -1) < 0)
+				return luaL_error(L, "Bad param \"prefetch\", "
+						  "expected a non-negative "
+						  "number");
+			prefetch = (uint32_t) lua_tonumber(L, -1);
+		}
+		lua_pop(L, 1);
+		/* Pop the options table. */
+		lua_pop(L, 1);
+	}
+
 	/*
 	 * luaL_merge_source_new() reads exactly three top values.
 	 */
 	while (lua_gettop(L) < 3)
 		lua_pushnil(L);
 
-	struct merge_source *source = luaL_merge_source_new(L);
+	struct merge_source *source = luaL_merge_source_new(L, prefetch);
 	if (source == NULL)
 		return luaT_error(L);
 	*(struct merge_source **)
@@ -400,13 +431,84 @@ lbox_merger_new(struct lua_State *L)
 
 /* {{{ Buffer merge source */
 
+/**
+ * A chunk of tuples fetched ahead by a background fiber.
+ */
+struct merge_buffer_chunk {
+	/** Link in merge_buffer_fetch_task::chunks. */
+	struct rlist link;
+	/**
+	 * A reference to the Lua buffer object. It is needed to
+	 * prevent LuaJIT from collecting the buffer while the
+	 * chunk is queued or consumed.
+	 */
+	int ref;
+	/** A buffer with the chunk of tuples. */
+	struct ibuf *buf;
+	/** Amount of tuples in the chunk. */
+	size_t remaining_tuple_count;
+};
+
+/**
+ * State shared between a buffer source and its background fetch
+ * fiber.
+ *
+ * The task is referenced both by the source and by the fiber and
+ * is freed together with the last reference. So the source may be
+ * destroyed from a Lua GC handler without waiting for the fiber
+ * to exit (a GC handler must not yield): the destructor just
+ * cancels the fiber and drops its reference.
+ */
+struct merge_buffer_fetch_task {
+	/** Reference counter. */
+	int refs;
+	/*
+	 * A reference to a Lua iterator to fetch a next chunk of
+	 * tuples.
+	 */
+	struct luaL_iterator *fetch_it;
+	/** The fetch fiber. NULL before start and after exit. */
+	struct fiber *fiber;
+	/**
+	 * Signaled when a chunk is produced or consumed and when
+	 * the fiber stops.
+	 */
+	struct fiber_cond cond;
+	/** Fetched, but not yet consumed chunks. */
+	struct rlist chunks;
+	/** Amount of chunks in the @a chunks list. */
+	uint32_t chunk_count;
+	/** Amount of chunks to fetch ahead of the consumer. */
+	uint32_t prefetch;
+	/** The fiber has been started at least once. */
+	bool is_started;
+	/** The chunk iterator has ended. */
+	bool eof;
+	/** The fiber has stopped on an error saved in @a diag. */
+	bool is_failed;
+	/** An error of the background fetch. */
+	struct diag diag;
+	/**
+	 * The source the task belongs to, solely for error
+	 * messages. Never dereferenced.
+	 */
+	const void *source_id;
+};
+
 struct merge_source_buffer {
 	struct merge_source base;
 	/*
 	 * A reference to a Lua iterator to fetch a next chunk of
-	 * tuples.
+	 * tuples. Owned by the source when prefetching is
+	 * disabled, otherwise it is NULL and the iterator is
+	 * owned by the fetch task.
 	 */
 	struct luaL_iterator *fetch_it;
+	/*
+	 * A background fetch state. NULL when prefetching is
+	 * disabled.
+	 */
+	struct merge_buffer_fetch_task *fetch_task;
 	/*
 	 * A reference to a buffer storing the current chunk of
 	 * tuples. It is needed to prevent LuaJIT from collecting
@@ -425,6 +527,28 @@ struct merge_source_buffer {
 	size_t remaining_tuple_count;
 };
 
+/**
+ * Decrement the task reference counter and free the task with
+ * everything it owns when the counter reaches zero.
+ */
+static void
+merge_buffer_fetch_task_unref(struct merge_buffer_fetch_task *task)
+{
+	assert(task->refs - 1 >= 0);
+	if (--task->refs > 0)
+		return;
+	struct merge_buffer_chunk *chunk, *tmp;
+	rlist_foreach_entry_safe(chunk, &task->chunks, link, tmp) {
+		if (chunk->ref > 0)
+			luaL_unref(tarantool_L, LUA_REGISTRYINDEX, chunk->ref);
+		free(chunk);
+	}
+	luaL_iterator_delete(task->fetch_it);
+	fiber_cond_destroy(&task->cond);
+	diag_destroy(&task->diag);
+	free(task);
+}
+
 /* Virtual methods declarations */
 
 static void
@@ -444,7 +568,7 @@ luaL_merge_source_buffer_next(struct merge_source *base,
  * In case of an error it returns NULL and sets a diag.
  */
 static struct merge_source *
-luaL_merge_source_buffer_new(struct lua_State *L)
+luaL_merge_source_buffer_new(struct lua_State *L, uint32_t prefetch)
 {
 	static struct merge_source_vtab merge_source_buffer_vtab = {
 		.destroy = luaL_merge_source_buffer_destroy,
@@ -461,11 +585,38 @@ luaL_merge_source_buffer_new(struct lua_State *L)
 
 	merge_source_create(&source->base, &merge_source_buffer_vtab);
 
-	source->fetch_it = luaL_iterator_new(L, 0);
+	source->fetch_it = NULL;
+	source->fetch_task = NULL;
 	source->ref = 0;
 	source->buf = NULL;
 	source->remaining_tuple_count = 0;
 
+	if (prefetch == 0) {
+		source->fetch_it = luaL_iterator_new(L, 0);
+		return &source->base;
+	}
+
+	struct merge_buffer_fetch_task *task = malloc(sizeof(*task));
+	if (task == NULL) {
+		diag_set(OutOfMemory, sizeof(*task), "malloc",
+			 "merge_buffer_fetch_task");
+		free(source);
+		return NULL;
+	}
+	task->refs = 1;
+	task->fetch_it = luaL_iterator_new(L, 0);
+	task->fiber = NULL;
+	fiber_cond_create(&task->cond);
+	rlist_create(&task->chunks);
+	task->chunk_count = 0;
+	task->prefetch = prefetch;
+	task->is_started = false;
+	task->eof = false;
+	task->is_failed = false;
+	diag_create(&task->diag);
+	task->source_id = &source->base;
+	source->fetch_task = task;
+
 	return &source->base;
 }
 
@@ -473,10 +624,12 @@ luaL_merge_source_buffer_new(struct lua_State *L)
  * Helper for `luaL_merge_source_buffer_fetch()`.
  */
 static int
-luaL_merge_source_buffer_fetch_impl(struct merge_source_buffer *source,
+luaL_merge_source_buffer_fetch_impl(struct luaL_iterator *fetch_it,
+				    struct merge_buffer_chunk *chunk,
+				    const void *source_id,
 				    struct lua_State *L)
 {
-	int nresult = luaL_iterator_next(L, source->fetch_it);
+	int nresult = luaL_iterator_next(L, fetch_it);
 
 	/* Handle a Lua error in a gen function. */
 	if (nresult == -1)
@@ -493,24 +646,21 @@ luaL_merge_source_buffer_fetch_impl(struct merge_source_buffer *source,
 		return -1;
 	}
 
-	/* Set a new buffer as the current chunk. */
-	if (source->ref > 0) {
-		luaL_unref(L, LUA_REGISTRYINDEX, source->ref);
-		source->ref = 0;
-	}
+	/* Save the received buffer into the chunk. */
 	lua_pushvalue(L, -nresult + 1); /* Popped by luaL_ref(). */
-	source->buf = luaT_toibuf(L, -1);
-	if (source->buf == NULL) {
+	chunk->buf = luaT_toibuf(L, -1);
+	if (chunk->buf == NULL) {
 		diag_set(IllegalParams, "Expected <state>, <buffer>");
 		return -1;
 	}
-	source->ref = luaL_ref(L, LUA_REGISTRYINDEX);
+	chunk->ref = luaL_ref(L, LUA_REGISTRYINDEX);
 	lua_pop(L, nresult);
 
 	/* Update remaining_tuple_count and skip the header. */
-	if (decode_header(source->buf, &source->remaining_tuple_count) != 0) {
-		diag_set(IllegalParams, "Invalid merge source %p",
-			 &source->base);
+	if (decode_header(chunk->buf, &chunk->remaining_tuple_count) != 0) {
+		luaL_unref(L, LUA_REGISTRYINDEX, chunk->ref);
+		chunk->ref = 0;
+		diag_set(IllegalParams, "Invalid merge source %p", source_id);
 		return -1;
 	}
 	return 1;
@@ -524,18 +674,129 @@ luaL_merge_source_buffer_fetch_impl(struct merge_source_buffer *source,
  * iterator ends and -1 at error and set a diag.
  */
 static int
-luaL_merge_source_buffer_fetch(struct merge_source_buffer *source)
+luaL_merge_source_buffer_fetch(struct luaL_iterator *fetch_it,
+			       struct merge_buffer_chunk *chunk,
+			       const void *source_id)
 {
 	int coro_ref = LUA_NOREF;
 	int top = -1;
 	struct lua_State *L = luaT_temp_luastate(&coro_ref, &top);
 	if (L == NULL)
 		return -1;
-	int rc = luaL_merge_source_buffer_fetch_impl(source, L);
+	int rc = luaL_merge_source_buffer_fetch_impl(fetch_it, chunk,
+						     source_id, L);
 	luaT_release_temp_luastate(L, coro_ref, top);
 	return rc;
 }
 
+/**
+ * Fiber function of the background fetch: keep up to
+ * task->prefetch chunks ahead of the consumer until the chunk
+ * iterator ends, an error occurs or the fiber is cancelled.
+ */
+static int
+luaL_merge_source_buffer_fetch_f(va_list ap)
+{
+	struct merge_buffer_fetch_task *task =
+		va_arg(ap, struct merge_buffer_fetch_task *);
+	while (!fiber_is_cancelled()) {
+		if (task->chunk_count >= task->prefetch) {
+			fiber_cond_wait(&task->cond);
+			continue;
+		}
+		struct merge_buffer_chunk *chunk = malloc(sizeof(*chunk));
+		if (chunk == NULL) {
+			diag_set(OutOfMemory, sizeof(*chunk), "malloc",
+				 "merge_buffer_chunk");
+			diag_move(diag_get(), &task->diag);
+			task->is_failed = true;
+			break;
+		}
+		chunk->ref = 0;
+		chunk->buf = NULL;
+		chunk->remaining_tuple_count = 0;
+		int rc = luaL_merge_source_buffer_fetch(task->fetch_it, chunk,
+							task->source_id);
+		if (rc < 0) {
+			free(chunk);
+			if (fiber_is_cancelled())
+				break;
+			diag_move(diag_get(), &task->diag);
+			task->is_failed = true;
+			break;
+		}
+		if (rc == 0) {
+			free(chunk);
+			task->eof = true;
+			break;
+		}
+		rlist_add_tail(&task->chunks, &chunk->link);
+		++task->chunk_count;
+		fiber_cond_broadcast(&task->cond);
+	}
+	fiber_cond_broadcast(&task->cond);
+	task->fiber = NULL;
+	merge_buffer_fetch_task_unref(task);
+	return 0;
+}
+
+/**
+ * Take a next prefetched chunk and make it the current one of
+ * the source. Start the fetch fiber on the first call and wait
+ * for it when the queue is empty.
+ *
+ * Return 1 when a new buffer is taken, 0 when the chunk iterator
+ * has ended and -1 at error (set a diag).
+ */
+static int
+luaL_merge_source_buffer_take_chunk(struct merge_source_buffer *source)
+{
+	struct merge_buffer_fetch_task *task = source->fetch_task;
+	if (!task->is_started) {
+		struct fiber *f = fiber_new("merger.fetch",
+					    luaL_merge_source_buffer_fetch_f);
+		if (f == NULL)
+			return -1;
+		task->is_started = true;
+		task->fiber = f;
+		++task->refs;
+		fiber_start(f, task);
+	}
+	while (true) {
+		if (!rlist_empty(&task->chunks)) {
+			struct merge_buffer_chunk *chunk =
+				rlist_shift_entry(&task->chunks,
+						  struct merge_buffer_chunk,
+						  link);
+			--task->chunk_count;
+			if (source->ref > 0)
+				luaL_unref(tarantool_L, LUA_REGISTRYINDEX,
+					   source->ref);
+			source->ref = chunk->ref;
+			source->buf = chunk->buf;
+			source->remaining_tuple_count =
+				chunk->remaining_tuple_count;
+			free(chunk);
+			fiber_cond_broadcast(&task->cond);
+			return 1;
+		}
+		if (task->is_failed) {
+			/*
+			 * Report the error once, then behave as
+			 * an ended iterator.
+			 */
+			task->is_failed = false;
+			task->eof = true;
+			diag_move(&task->diag, diag_get());
+			return -1;
+		}
+		if (task->eof)
+			return 0;
+		if (fiber_cond_wait(&task->cond) != 0)
+			return -1;
+	}
+}
+
 /* Virtual methods */
 
 /**
@@ -549,8 +810,19 @@ luaL_merge_source_buffer_destroy(struct merge_source *base)
 	struct merge_source_buffer *source = container_of(base,
 		struct merge_source_buffer, base);
 
-	assert(source->fetch_it != NULL);
-	luaL_iterator_delete(source->fetch_it);
+	assert(source->fetch_it != NULL || source->fetch_task != NULL);
+	if (source->fetch_task != NULL) {
+		/*
+		 * The fiber releases the task reference on exit,
+		 * so there is no need to wait for it here (and a
+		 * Lua GC handler must not yield).
+		 */
+		if (source->fetch_task->fiber != NULL)
+			fiber_cancel(source->fetch_task->fiber);
+		merge_buffer_fetch_task_unref(source->fetch_task);
+	} else {
+		luaL_iterator_delete(source->fetch_it);
+	}
 	if (source->ref > 0)
 		luaL_unref(tarantool_L, LUA_REGISTRYINDEX, source->ref);
 
@@ -576,7 +848,27 @@ luaL_merge_source_buffer_next(struct merge_source *base,
 	 * chunks iterator ends.
 	 */
 	while (source->remaining_tuple_count == 0) {
-		int rc = luaL_merge_source_buffer_fetch(source);
+		int rc;
+		if (source->fetch_task != NULL) {
+			rc = luaL_merge_source_buffer_take_chunk(source);
+		} else {
+			struct merge_buffer_chunk chunk;
+			chunk.ref = 0;
+			chunk.buf = NULL;
+			chunk.remaining_tuple_count = 0;
+			rc = luaL_merge_source_buffer_fetch(
+				source->fetch_it, &chunk, &source->base);
+			if (rc > 0) {
+				if (source->ref > 0)
+					luaL_unref(tarantool_L,
+						   LUA_REGISTRYINDEX,
+						   source->ref);
+				source->ref = chunk.ref;
+				source->buf = chunk.buf;
+				source->remaining_tuple_count =
+					chunk.remaining_tuple_count;
+			}
+		}
 		if (rc < 0)
 			return -1;
 		if (rc == 0) {
@@ -655,13 +947,19 @@ luaL_merge_source_table_next(struct merge_source *base,
  * In case of an error it returns NULL and set a diag.
  */
 static struct merge_source *
-luaL_merge_source_table_new(struct lua_State *L)
+luaL_merge_source_table_new(struct lua_State *L, uint32_t prefetch)
 {
 	static struct merge_source_vtab merge_source_table_vtab = {
 		.destroy = luaL_merge_source_table_destroy,
 		.next = luaL_merge_source_table_next,
 	};
 
+	if (prefetch != 0) {
+		diag_set(IllegalParams, "Option 'prefetch' is supported "
+			 "only by a buffer source");
+		return NULL;
+	}
+
 	struct merge_source_table *source = malloc(
 		sizeof(struct merge_source_table));
 	if (source == NULL) {
@@ -857,13 +1155,19 @@ luaL_merge_source_tuple_next(struct merge_source *base,
  * In case of an error it returns NULL and set a diag.
  */
 static struct merge_source *
-luaL_merge_source_tuple_new(struct lua_State *L)
+luaL_merge_source_tuple_new(struct lua_State *L, uint32_t prefetch)
 {
 	static struct merge_source_vtab merge_source_tuple_vtab = {
 		.destroy = luaL_merge_source_tuple_destroy,
 		.next = luaL_merge_source_tuple_next,
 	};
 
+	if (prefetch != 0) {
+		diag_set(IllegalParams, "Option 'prefetch' is supported "
+			 "only by a buffer source");
+		return NULL;
+	}
+
 	struct merge_source_tuple *source = malloc(
 		sizeof(struct merge_source_tuple));
 	if (source == NULL) {
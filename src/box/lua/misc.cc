@@ -31,11 +31,20 @@
 #include "box/lua/misc.h"
 
 #include "fiber.h" /* fiber->gc() */
+#include "flightrec.h"
 #include <small/region.h>
 #include "lua/utils.h"
 #include "lua/msgpack.h"
 
+#include <fcntl.h>
+#include <msgpuck.h>
+
+#include "coio_file.h"
+#include "csv/csv.h"
+
 #include "box/box.h"
+#include "box/index.h"
+#include "box/txn.h"
 #include "box/port.h"
 #include "box/tuple.h"
 #include "box/tuple_format.h"
@@ -96,15 +105,17 @@ port_msgpack_dump_lua(struct port *base, struct lua_State *L, bool is_flat)
 
 /* }}} */
 
-/** {{{ Lua/C implementation of index:select(): used only by Vinyl **/
+/** {{{ Lua/C implementation of index:select(): used by Vinyl and
+ * by paginated (after/fetch_pos) selects of any engine **/
 
 static int
 lbox_select(lua_State *L)
 {
-	if (lua_gettop(L) != 6 || !lua_isnumber(L, 1) || !lua_isnumber(L, 2) ||
+	int top = lua_gettop(L);
+	if (top < 6 || top > 8 || !lua_isnumber(L, 1) || !lua_isnumber(L, 2) ||
 		!lua_isnumber(L, 3) || !lua_isnumber(L, 4) || !lua_isnumber(L, 5)) {
 		return luaL_error(L, "Usage index:select(iterator, offset, "
-				  "limit, key)");
+				  "limit, key[, after, fetch_pos])");
 	}
 
 	uint32_t space_id = lua_tonumber(L, 1);
@@ -116,9 +127,25 @@ lbox_select(lua_State *L)
 	size_t key_len;
 	const char *key = lbox_encode_tuple_on_gc(L, 6, &key_len);
 
+	/* Optional stateless pagination arguments. */
+	const char *after_pos = NULL;
+	size_t after_pos_len = 0;
+	if (top >= 7 && !lua_isnil(L, 7)) {
+		if (lua_type(L, 7) != LUA_TSTRING) {
+			return luaL_error(L, "Iterator position must be a "
+					  "string");
+		}
+		after_pos = lua_tolstring(L, 7, &after_pos_len);
+	}
+	bool fetch_pos = top >= 8 && lua_toboolean(L, 8);
+	const char *pos = NULL;
+	uint32_t pos_size = 0;
+
 	struct port port;
-	if (box_select(space_id, index_id, iterator, offset, limit,
-		       key, key + key_len, &port) != 0) {
+	if (box_select_after(space_id, index_id, iterator, offset, limit,
+			     key, key + key_len, after_pos,
+			     (uint32_t)after_pos_len, fetch_pos,
+			     &pos, &pos_size, &port) != 0) {
 		return luaT_error(L);
 	}
 
@@ -133,7 +160,376 @@ lbox_select(lua_State *L)
 	 */
 	port_dump_lua(&port, L, false);
 	port_destroy(&port);
-	return 1; /* lua table with tuples */
+	if (!fetch_pos)
+		return 1; /* lua table with tuples */
+	if (pos != NULL)
+		lua_pushlstring(L, pos, pos_size);
+	else
+		lua_pushnil(L);
+	return 2; /* lua table with tuples, iterator position */
+}
+
+/* }}} */
+
+/** {{{ Native bulk CSV import/export **/
+
+enum {
+	/** IO chunk size for bulk CSV import and export. */
+	CSV_BULK_CHUNK_SIZE = 512 * 1024,
+};
+
+/**
+ * Encode one CSV field into msgpack on @a region. When
+ * @a try_numeric is set, a field which parses completely as an
+ * integer or a floating point number is encoded as one;
+ * everything else, including an empty field, becomes a string.
+ */
+static int
+csv_bulk_encode_field(struct region *region, const char *field, size_t len,
+		      bool try_numeric)
+{
+	char *data;
+	size_t size;
+	if (try_numeric && len > 0 && len < 32) {
+		char tmp[32];
+		memcpy(tmp, field, len);
+		tmp[len] = '\0';
+		char *endp;
+		errno = 0;
+		long long ival = strtoll(tmp, &endp, 10);
+		if (*endp == '\0' && errno == 0) {
+			size = ival < 0 ? mp_sizeof_int(ival) :
+					  mp_sizeof_uint(ival);
+			data = (char *)region_alloc(region, size);
+			if (data == NULL)
+				goto oom;
+			if (ival < 0)
+				mp_encode_int(data, ival);
+			else
+				mp_encode_uint(data, ival);
+			return 0;
+		}
+		errno = 0;
+		double dval = strtod(tmp, &endp);
+		if (*endp == '\0' && errno == 0) {
+			size = mp_sizeof_double(dval);
+			data = (char *)region_alloc(region, size);
+			if (data == NULL)
+				goto oom;
+			mp_encode_double(data, dval);
+			return 0;
+		}
+	}
+	size = mp_sizeof_str(len);
+	data = (char *)region_alloc(region, size);
+	if (data == NULL)
+		goto oom;
+	mp_encode_str(data, field, len);
+	return 0;
+oom:
+	diag_set(OutOfMemory, size, "region_alloc", "csv field");
+	return -1;
+}
+
+/**
+ * box.internal.csv_import(space_id, path, batch_size,
+ *                         try_numeric, use_replace)
+ *
+ * Stream @a path through the CSV parser and insert (or replace,
+ * when @a use_replace is set) every row into the space. The file
+ * is read with coio in large chunks, rows are encoded on the
+ * fiber region without intermediate Lua values, and @a batch_size
+ * consecutive rows share one transaction - and thereby one WAL
+ * write. Returns the number of imported rows, raises on the
+ * first IO, parse or DML error; rows of committed batches stay.
+ */
+static int
+lbox_csv_import(lua_State *L)
+{
+	if (lua_gettop(L) != 5 || !lua_isnumber(L, 1) ||
+	    lua_type(L, 2) != LUA_TSTRING || !lua_isnumber(L, 3)) {
+		return luaL_error(L, "Usage: box.internal.csv_import("
+				  "space_id, path, batch_size, try_numeric, "
+				  "use_replace)");
+	}
+	uint32_t space_id = lua_tonumber(L, 1);
+	const char *path = lua_tostring(L, 2);
+	uint32_t batch_size = lua_tonumber(L, 3);
+	if (batch_size == 0)
+		batch_size = 1;
+	bool try_numeric = lua_toboolean(L, 4);
+	bool use_replace = lua_toboolean(L, 5);
+
+	if (box_txn()) {
+		diag_set(IllegalParams,
+			 "CSV import can not be done in a transaction");
+		return luaT_error(L);
+	}
+
+	struct region *gc = &fiber()->gc;
+	size_t region_svp = region_used(gc);
+
+	int fd = coio_file_open(path, O_RDONLY, 0);
+	if (fd < 0) {
+		diag_set(SystemError, "failed to open '%s'", path);
+		return luaT_error(L);
+	}
+	char *buf = (char *)malloc(CSV_BULK_CHUNK_SIZE);
+	if (buf == NULL) {
+		coio_file_close(fd);
+		diag_set(OutOfMemory, CSV_BULK_CHUNK_SIZE, "malloc",
+			 "csv buffer");
+		return luaT_error(L);
+	}
+	struct csv csv;
+	csv_create(&csv);
+	struct csv_iterator it;
+	csv_iterator_create(&it, &csv);
+
+	uint64_t rows = 0;
+	uint32_t batched = 0;
+	uint32_t field_count = 0;
+	size_t row_svp = region_used(gc);
+	bool eof = false;
+	int st;
+	while ((st = csv_next(&it)) != CSV_IT_EOF) {
+		if (st == CSV_IT_NEEDMORE) {
+			/*
+			 * coio_read() yields, and without MVCC a
+			 * yield aborts an in-flight transaction.
+			 * Close the open batch before refilling the
+			 * buffer: a batch cut short at a chunk
+			 * boundary is merely smaller.
+			 */
+			if (box_txn()) {
+				if (box_txn_commit() != 0)
+					goto error;
+				batched = 0;
+			}
+			ssize_t n = eof ? 0 :
+				coio_read(fd, buf, CSV_BULK_CHUNK_SIZE);
+			if (n < 0) {
+				diag_set(SystemError, "failed to read '%s'",
+					 path);
+				goto error;
+			}
+			if (n == 0)
+				eof = true;
+			/* A zero-length chunk signals the end. */
+			csv_feed(&it, buf, n);
+			continue;
+		}
+		if (st == CSV_IT_ERROR)
+			break;
+		if (st == CSV_IT_OK) {
+			if (csv_bulk_encode_field(
+					gc, csv_iterator_get_field(&it),
+					csv_iterator_get_field_len(&it),
+					try_numeric) != 0)
+				goto error;
+			field_count++;
+			continue;
+		}
+		assert(st == CSV_IT_EOL);
+		size_t fields_len = region_used(gc) - row_svp;
+		char *fields = (char *)region_join(gc, fields_len);
+		if (fields == NULL) {
+			diag_set(OutOfMemory, fields_len, "region_join",
+				 "csv row");
+			goto error;
+		}
+		size_t head = mp_sizeof_array(field_count);
+		char *row = (char *)region_alloc(gc, head + fields_len);
+		if (row == NULL) {
+			diag_set(OutOfMemory, head + fields_len,
+				 "region_alloc", "csv row");
+			goto error;
+		}
+		memcpy(mp_encode_array(row, field_count), fields, fields_len);
+		if (!box_txn() && box_txn_begin() != 0)
+			goto error;
+		int rc;
+		if (use_replace) {
+			rc = box_replace(space_id, row, row + head +
+					 fields_len, NULL);
+		} else {
+			rc = box_insert(space_id, row, row + head +
+					fields_len, NULL);
+		}
+		if (rc != 0)
+			goto error;
+		rows++;
+		if (++batched >= batch_size) {
+			if (box_txn_commit() != 0)
+				goto error;
+			batched = 0;
+		}
+		region_truncate(gc, row_svp);
+		field_count = 0;
+	}
+	if (csv_get_error_status(&csv) != CSV_ER_OK) {
+		diag_set(IllegalParams, "CSV parse error in '%s'", path);
+		goto error;
+	}
+	if (box_txn() && box_txn_commit() != 0)
+		goto error;
+	free(buf);
+	csv_destroy(&csv);
+	coio_file_close(fd);
+	region_truncate(gc, region_svp);
+	luaL_pushuint64(L, rows);
+	return 1;
+error:
+	if (box_txn())
+		box_txn_rollback();
+	free(buf);
+	csv_destroy(&csv);
+	coio_file_close(fd);
+	region_truncate(gc, region_svp);
+	return luaT_error(L);
+}
+
+/**
+ * box.internal.csv_export(space_id, path)
+ *
+ * Dump all tuples of the primary index into @a path as CSV, in
+ * index order. Strings are escaped with the CSV rules, other
+ * field types are rendered the way mp_snprint() does (numbers as
+ * numbers, complex fields as JSON-like text) and escaped too.
+ * The output is buffered and written with coio in large chunks.
+ * Returns the number of exported rows. The export yields on
+ * writes, so concurrent DML may or may not be visible in the
+ * dump; wrap the call into a read-view providing machinery when
+ * a consistent snapshot is required.
+ */
+static int
+lbox_csv_export(lua_State *L)
+{
+	if (lua_gettop(L) != 2 || !lua_isnumber(L, 1) ||
+	    lua_type(L, 2) != LUA_TSTRING) {
+		return luaL_error(L, "Usage: box.internal.csv_export("
+				  "space_id, path)");
+	}
+	uint32_t space_id = lua_tonumber(L, 1);
+	const char *path = lua_tostring(L, 2);
+
+	struct region *gc = &fiber()->gc;
+	size_t region_svp = region_used(gc);
+
+	int fd = coio_file_open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		diag_set(SystemError, "failed to open '%s'", path);
+		return luaT_error(L);
+	}
+	char *out = (char *)malloc(CSV_BULK_CHUNK_SIZE);
+	if (out == NULL) {
+		coio_file_close(fd);
+		diag_set(OutOfMemory, CSV_BULK_CHUNK_SIZE, "malloc",
+			 "csv buffer");
+		return luaT_error(L);
+	}
+	struct csv csv;
+	csv_create(&csv);
+
+	char key[8];
+	char *key_end = mp_encode_array(key, 0);
+	box_iterator_t *iter = box_index_iterator(space_id, 0, ITER_ALL,
+						  key, key_end);
+	uint64_t rows = 0;
+	size_t used = 0;
+	int rc = -1;
+	if (iter == NULL)
+		goto error;
+
+	box_tuple_t *tuple;
+	while ((rc = box_iterator_next(iter, &tuple)) == 0 &&
+	       tuple != NULL) {
+		size_t row_svp = region_used(gc);
+		const char *data = tuple_data(tuple);
+		uint32_t field_count = mp_decode_array(&data);
+		for (uint32_t i = 0; i < field_count; i++) {
+			const char *field;
+			size_t len;
+			if (mp_typeof(*data) == MP_STR) {
+				uint32_t str_len;
+				const char *str = mp_decode_str(&data,
+								&str_len);
+				/*
+				 * csv_escape_field() wants a
+				 * NUL-terminated string.
+				 */
+				char *copy = (char *)region_alloc(
+							gc, str_len + 1);
+				if (copy == NULL)
+					goto row_oom;
+				memcpy(copy, str, str_len);
+				copy[str_len] = '\0';
+				field = copy;
+				len = str_len;
+			} else {
+				const char *end = data;
+				mp_next(&end);
+				int plen = mp_snprint(NULL, 0, data);
+				if (plen < 0)
+					goto row_oom;
+				char *copy = (char *)region_alloc(
+							gc, plen + 1);
+				if (copy == NULL)
+					goto row_oom;
+				mp_snprint(copy, plen + 1, data);
+				data = end;
+				field = copy;
+				len = plen;
+			}
+			char *esc = (char *)region_alloc(gc, 2 * len + 3);
+			if (esc == NULL)
+				goto row_oom;
+			int esc_len = csv_escape_field(&csv, field, len, esc,
+						       2 * len + 3);
+			if (used + esc_len + 1 > CSV_BULK_CHUNK_SIZE) {
+				if (coio_write(fd, out, used) < 0)
+					goto write_error;
+				used = 0;
+			}
+			if ((size_t)esc_len + 1 > CSV_BULK_CHUNK_SIZE) {
+				/* A field larger than the buffer. */
+				if (coio_write(fd, esc, esc_len) < 0)
+					goto write_error;
+			} else {
+				memcpy(out + used, esc, esc_len);
+				used += esc_len;
+			}
+			out[used++] = i + 1 < field_count ?
+				csv.delimiter : '\n';
+		}
+		region_truncate(gc, row_svp);
+		rows++;
+	}
+	if (rc != 0)
+		goto error;
+	if (used > 0 && coio_write(fd, out, used) < 0)
+		goto write_error;
+	box_iterator_free(iter);
+	free(out);
+	csv_destroy(&csv);
+	coio_file_close(fd);
+	region_truncate(gc, region_svp);
+	luaL_pushuint64(L, rows);
+	return 1;
+row_oom:
+	diag_set(OutOfMemory, CSV_BULK_CHUNK_SIZE, "region_alloc",
+		 "csv field");
+	goto error;
+write_error:
+	diag_set(SystemError, "failed to write '%s'", path);
+error:
+	if (iter != NULL)
+		box_iterator_free(iter);
+	free(out);
+	csv_destroy(&csv);
+	coio_file_close(fd);
+	region_truncate(gc, region_svp);
+	return luaT_error(L);
 }
 
 /* }}} */
@@ -247,12 +643,28 @@ lbox_tuple_format_new(struct lua_State *L)
 
 /* }}} */
 
+/**
+ * Dump the tx thread flight recorder ring to the log, see
+ * flightrec.h. Meant for post-incident inspection:
+ * box.internal.flightrec_dump().
+ */
+static int
+lbox_flightrec_dump(struct lua_State *L)
+{
+	(void)L;
+	flightrec_dump();
+	return 0;
+}
+
 void
 box_lua_misc_init(struct lua_State *L)
 {
 	static const struct luaL_Reg boxlib_internal[] = {
 		{"select", lbox_select},
 		{"new_tuple_format", lbox_tuple_format_new},
+		{"flightrec_dump", lbox_flightrec_dump},
+		{"csv_import", lbox_csv_import},
+		{"csv_export", lbox_csv_export},
 		{NULL, NULL}
 	};
 
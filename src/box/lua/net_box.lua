@@ -25,6 +25,7 @@ local check_primary_index = box.internal.check_primary_index
 
 local communicate     = internal.communicate
 local encode_auth     = internal.encode_auth
+local encode_ping     = internal.encode_ping
 local encode_select   = internal.encode_select
 local decode_greeting = internal.decode_greeting
 
@@ -681,6 +682,14 @@ local function create_transport(host, port, user, password, callback,
 
     -- IO (WORKER FIBER) --
     local function send_and_recv(limit_or_boundary, timeout)
+        -- Micro-batching: when there is still unsent data, give
+        -- the requesting fibers a short window to queue more
+        -- requests, so that the whole batch leaves the socket in
+        -- one syscall.
+        local flush_delay = callback('flush_delay')
+        if flush_delay and send_buf:size() > 0 then
+            fiber.sleep(flush_delay)
+        end
         return communicate(connection:fd(), send_buf, recv_buf,
                            limit_or_boundary, timeout)
     end
@@ -809,6 +818,32 @@ local function create_transport(host, port, user, password, callback,
             set_state('active')
             return iproto_sm(schema_version)
         end
+        -- The schema loaded by a previous connection is still
+        -- valid if the peer reports the same schema version: the
+        -- version is bumped on every DDL and is stamped into
+        -- every iproto response header. When the version is not
+        -- known yet (no auth stage on this connection), learn it
+        -- with a ping, which is way cheaper than re-fetching
+        -- whole _vspace/_vindex dumps on every reconnect.
+        if schema_version == nil and callback('has_schema_cache') then
+            local ping_id = new_request_id()
+            local ping_done = false
+            encode_ping(send_buf, ping_id)
+            repeat
+                local err, hdr, body_rpos, body_end = send_and_recv_iproto()
+                if err then return error_sm(err, hdr) end
+                dispatch_response_iproto(hdr, body_rpos, body_end)
+                if hdr[IPROTO_SYNC_KEY] == ping_id then
+                    ping_done = true
+                    schema_version = hdr[IPROTO_SCHEMA_VERSION_KEY]
+                end
+            until ping_done
+        end
+        if schema_version ~= nil and schema_version > 0 and
+           callback('schema_is_cached', schema_version) then
+            set_state('active')
+            return iproto_sm(schema_version)
+        end
         -- _vcollation view was added in 2.2.0-389-g3e3ef182f
         local peer_has_vcollation = version_at_least(greeting.version_id,
                                                      2, 2, 1)
@@ -880,7 +915,7 @@ local function create_transport(host, port, user, password, callback,
             -- schema_version has been changed - start to load a new version.
             -- Sic: self.schema_version will be updated only after reload.
             set_state('fetch_schema')
-            return iproto_schema_sm(schema_version)
+            return iproto_schema_sm(response_schema_version)
         end
         return iproto_sm(schema_version)
     end
@@ -1031,6 +1066,14 @@ local function new_sm(host, port, opts, connection, greeting)
             remote.peer_version_id = greeting.version_id
         elseif what == 'will_fetch_schema' then
             return not opts.console
+        elseif what == 'has_schema_cache' then
+            return remote.schema_version ~= nil and remote.space ~= nil and
+                   remote._schema_peer_uuid == remote.peer_uuid
+        elseif what == 'schema_is_cached' then
+            local version = ...
+            return remote.schema_version == version and
+                   remote.space ~= nil and
+                   remote._schema_peer_uuid == remote.peer_uuid
         elseif what == 'fetch_connect_timeout' then
             return opts.connect_timeout or DEFAULT_CONNECT_TIMEOUT
         elseif what == 'did_fetch_schema' then
@@ -1040,6 +1083,11 @@ local function new_sm(host, port, opts, connection, greeting)
                opts.reconnect_after > 0 then
                 return opts.reconnect_after
             end
+        elseif what == 'flush_delay' then
+            if type(opts.flush_delay) == 'number' and
+               opts.flush_delay > 0 then
+                return opts.flush_delay
+            end
         end
     end
     -- @deprecated since 1.10
@@ -1289,6 +1337,83 @@ function remote_methods:unprepare(query, parameters, sql_opts, netbox_opts)
                          sql_opts or {})
 end
 
+--
+-- Pipelined request batches.
+--
+-- All requests issued through a batch object are encoded into
+-- the shared send buffer one after another without handing
+-- control to the worker fiber in between, so the whole batch
+-- leaves the socket in a single write and the replies come back
+-- pipelined. Each batch method has the signature of the
+-- corresponding connection method and returns a future, as if
+-- {is_async = true} was passed; batch:wait_result() waits for
+-- all collected futures at once.
+--
+local batch_methods = {}
+local batch_mt = { __index = batch_methods, __metatable = false }
+
+local function batch_opts(opts)
+    local res = {}
+    if opts ~= nil then
+        for k, v in pairs(opts) do res[k] = v end
+    end
+    res.is_async = true
+    return res
+end
+
+local function batch_request(batch, method, ...)
+    local future = remote_methods[method](batch._conn, ...)
+    table.insert(batch._futures, future)
+    return future
+end
+
+function batch_methods:call(func_name, args, opts)
+    return batch_request(self, 'call', func_name, args, batch_opts(opts))
+end
+
+function batch_methods:eval(code, args, opts)
+    return batch_request(self, 'eval', code, args, batch_opts(opts))
+end
+
+function batch_methods:execute(query, parameters, sql_opts, netbox_opts)
+    return batch_request(self, 'execute', query, parameters, sql_opts,
+                         batch_opts(netbox_opts))
+end
+
+--
+-- Wait for all requests of the batch.
+--
+-- Return an array with an entry per request, in the order of
+-- issue: {res} on success, {nil, err} on failure.
+--
+function batch_methods:wait_result(timeout)
+    local deadline = fiber_clock() + (timeout or TIMEOUT_INFINITY)
+    local results = {}
+    for i, future in ipairs(self._futures) do
+        local res, err = future:wait_result(max(0, deadline - fiber_clock()))
+        if err ~= nil then
+            results[i] = {nil, err}
+        else
+            results[i] = {res}
+        end
+    end
+    return results
+end
+
+-- Discard all not yet finished requests of the batch.
+function batch_methods:discard()
+    for _, future in ipairs(self._futures) do
+        if not future:is_ready() then
+            future:discard()
+        end
+    end
+end
+
+function remote_methods:batch()
+    check_remote_arg(self, 'batch')
+    return setmetatable({_conn = self, _futures = {}}, batch_mt)
+end
+
 function remote_methods:wait_state(state, timeout)
     check_remote_arg(self, 'wait_state')
     if timeout == nil then
@@ -1419,6 +1544,10 @@ function remote_methods:_install_schema(schema_version, spaces, indices,
 
     self.schema_version = schema_version
     self.space = sl
+    -- Schema versions of different instances are not comparable,
+    -- so remember whose schema is cached: a reconnect reuses it
+    -- only when it ends up on the same peer.
+    self._schema_peer_uuid = self.peer_uuid
     self._on_schema_reload:run(self)
 end
 
@@ -412,6 +412,7 @@ box.schema.space.create = function(name, options)
         is_local = 'boolean',
         temporary = 'boolean',
         is_sync = 'boolean',
+        expire_field = 'number',
     }
     local options_defaults = {
         engine = 'memtx',
@@ -456,7 +457,8 @@ box.schema.space.create = function(name, options)
     local space_options = setmap({
         group_id = options.is_local and 1 or nil,
         temporary = options.temporary and true or nil,
-        is_sync = options.is_sync
+        is_sync = options.is_sync,
+        expire_field = options.expire_field,
     })
     _space:insert{id, uid, name, options.engine, options.field_count,
         space_options, format}
@@ -545,6 +547,7 @@ local alter_space_template = {
     format = 'table',
     temporary = 'boolean',
     is_sync = 'boolean',
+    expire_field = 'number',
     name = 'string',
 }
 
@@ -581,6 +584,11 @@ box.schema.space.alter = function(space_id, options)
         flags.is_sync = options.is_sync
     end
 
+    if options.expire_field ~= nil then
+        flags.expire_field = options.expire_field ~= 0 and
+            options.expire_field or nil
+    end
+
     local format
     if options.format ~= nil then
         format = update_format(options.format)
@@ -1043,6 +1051,7 @@ local index_options = {
     range_size = 'number',
     page_size = 'number',
     bloom_fpr = 'number',
+    zstd_level = 'number',
     func = 'number, string',
     hint = 'boolean',
 }
@@ -1190,6 +1199,7 @@ box.schema.index.create = function(space_id, name, options)
             run_count_per_level = options.run_count_per_level,
             run_size_ratio = options.run_size_ratio,
             bloom_fpr = options.bloom_fpr,
+            zstd_level = options.zstd_level,
             func = options.func,
             hint = options.hint,
     }
@@ -1894,6 +1904,8 @@ end
 local function check_select_opts(opts, key_is_nil)
     local offset = 0
     local limit = 4294967295
+    local after = nil
+    local fetch_pos = false
     local iterator = check_iterator_type(opts, key_is_nil)
     if opts ~= nil then
         if opts.offset ~= nil then
@@ -1902,12 +1914,24 @@ local function check_select_opts(opts, key_is_nil)
         if opts.limit ~= nil then
             limit = opts.limit
         end
+        if opts.after ~= nil then
+            after = opts.after
+        end
+        if opts.fetch_pos ~= nil then
+            fetch_pos = opts.fetch_pos
+        end
     end
-    return iterator, offset, limit
+    return iterator, offset, limit, after, fetch_pos
 end
 
 base_index_mt.select_ffi = function(index, key, opts)
     check_index_arg(index, 'select')
+    if opts ~= nil and (opts.after ~= nil or opts.fetch_pos) then
+        -- Pagination: the position token travels as an extra
+        -- argument and return value, which the FFI binding of
+        -- box_select() does not carry. Take the Lua/C path.
+        return base_index_mt.select_luac(index, key, opts)
+    end
     local key, key_end = tuple_encode(key)
     local iterator, offset, limit = check_select_opts(opts, key + 1 >= key_end)
 
@@ -1931,9 +1955,14 @@ end
 base_index_mt.select_luac = function(index, key, opts)
     check_index_arg(index, 'select')
     local key = keify(key)
-    local iterator, offset, limit = check_select_opts(opts, #key == 0)
+    local iterator, offset, limit, after, fetch_pos =
+        check_select_opts(opts, #key == 0)
+    if after ~= nil and type(after) ~= 'string' then
+        box.error(box.error.ILLEGAL_PARAMS,
+                  "options parameter 'after' should be of type string")
+    end
     return internal.select(index.space_id, index.id, iterator,
-        offset, limit, key)
+        offset, limit, key, after, fetch_pos)
 end
 
 base_index_mt.update = function(index, key, ops)
@@ -2053,6 +2082,36 @@ space_mt.delete = function(space, key)
     check_space_arg(space, 'delete')
     return check_primary_index(space):delete(key)
 end
+-- Bulk load a CSV file straight into the space, bypassing
+-- per-row Lua values. Options: batch_size (rows per transaction
+-- and WAL entry, default 1000), numeric (cast numeric-looking
+-- fields to numbers, default true), replace (use replace instead
+-- of insert, default false). Returns the number of loaded rows.
+space_mt.import_csv = function(space, path, opts)
+    check_space_arg(space, 'import_csv')
+    if type(path) ~= 'string' then
+        box.error(box.error.ILLEGAL_PARAMS,
+                  'Usage: space:import_csv(path[, opts])')
+    end
+    opts = opts or {}
+    check_param_table(opts, {
+        batch_size = 'number',
+        numeric = 'boolean',
+        replace = 'boolean',
+    })
+    return internal.csv_import(space.id, path, opts.batch_size or 1000,
+                               opts.numeric ~= false, opts.replace == true)
+end
+-- Dump the whole space (in primary index order) into a CSV file.
+-- Returns the number of dumped rows.
+space_mt.export_csv = function(space, path)
+    check_space_arg(space, 'export_csv')
+    if type(path) ~= 'string' then
+        box.error(box.error.ILLEGAL_PARAMS,
+                  'Usage: space:export_csv(path)')
+    end
+    return internal.csv_export(space.id, path)
+end
 -- Assumes that spaceno has a TREE (NUM) primary key
 -- inserts a tuple after getting the next value of the
 -- primary key and returns it back to the user
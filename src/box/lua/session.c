@@ -506,6 +506,19 @@ lbox_session_settings_init(struct lua_State *L)
 	lua_setfield(L, -2, "settings");
 }
 
+/**
+ * Mark the current session as an owner of a Lua storage table.
+ * Called when box.session.storage is materialized, so that
+ * session_destroy() knows there is something to clean up.
+ */
+static int
+lbox_session_storage_created(struct lua_State *L)
+{
+	(void) L;
+	current_session()->has_lua_storage = true;
+	return 0;
+}
+
 void
 session_storage_cleanup(int sid)
 {
@@ -548,6 +561,7 @@ box_lua_session_init(struct lua_State *L)
 		{"run_on_connect",    lbox_session_run_on_connect},
 		{"run_on_disconnect", lbox_session_run_on_disconnect},
 		{"run_on_auth", lbox_session_run_on_auth},
+		{"storage_created", lbox_session_storage_created},
 		{NULL, NULL}
 	};
 	luaL_register(L, "box.internal.session", session_internal_lib);
@@ -14,6 +14,9 @@ setmetatable(session, {
         local mt = getmetatable(tbl)
 
         if mt.aggregate_storage[ sid ] == nil then
+            -- Tell the session core that there now is something
+            -- to clean up on session destruction.
+            box.internal.session.storage_created()
             mt.aggregate_storage[ sid ] = {}
         end
         return mt.aggregate_storage[ sid ]
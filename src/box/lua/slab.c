@@ -98,10 +98,70 @@ small_stats_lua_cb(const struct mempool_stats *stats, void *cb_ctx)
 	luaL_pushuint64(L, stats->objcount);
 	lua_settable(L, -3);
 
+	/*
+	 * Share of the memory formatted for the class which does
+	 * not hold live items - the per-class fragmentation
+	 * score. A class with a high waste ratio and a large
+	 * mem_free is where a memory incident hides.
+	 */
+	double waste = 100 * ((double) (stats->totals.total -
+					stats->totals.used)
+			      / ((double) stats->totals.total + 0.0001));
+	char waste_buf[32];
+	snprintf(waste_buf, sizeof(waste_buf), "%0.2lf%%", waste);
+	lua_pushstring(L, "waste_ratio");
+	lua_pushstring(L, waste_buf);
+	lua_settable(L, -3);
+
 	lua_settable(L, -3);
 	return 0;
 }
 
+/**
+ * Append tuple allocation churn accumulated by memtx to a Lua
+ * table, one row per non-idle power-of-two size class. The
+ * counters are monotonic, rates are up to the scraper.
+ */
+static int
+lbox_slab_churn(struct lua_State *L)
+{
+	struct memtx_engine *memtx;
+	memtx = (struct memtx_engine *)engine_by_name("memtx");
+
+	lua_newtable(L);
+	for (int i = 0; i < MEMTX_CHURN_CLASSES; i++) {
+		struct memtx_churn_class *churn = &memtx->churn[i];
+		if (churn->allocs == 0 && churn->frees == 0)
+			continue;
+		lua_pushnumber(L, lua_objlen(L, -1) + 1);
+		lua_newtable(L);
+		luaL_setmaphint(L, -1);
+
+		lua_pushstring(L, "item_size_max");
+		luaL_pushuint64(L, UINT64_C(1) << i);
+		lua_settable(L, -3);
+
+		lua_pushstring(L, "allocs");
+		luaL_pushuint64(L, churn->allocs);
+		lua_settable(L, -3);
+
+		lua_pushstring(L, "frees");
+		luaL_pushuint64(L, churn->frees);
+		lua_settable(L, -3);
+
+		lua_pushstring(L, "alloc_bytes");
+		luaL_pushuint64(L, churn->alloc_bytes);
+		lua_settable(L, -3);
+
+		lua_pushstring(L, "free_bytes");
+		luaL_pushuint64(L, churn->free_bytes);
+		lua_settable(L, -3);
+
+		lua_settable(L, -3);
+	}
+	return 1;
+}
+
 static int
 lbox_slab_stats(struct lua_State *L)
 {
@@ -228,6 +288,18 @@ lbox_slab_info(struct lua_State *L)
 	lua_pushstring(L, ratio_buf);
 	lua_settable(L, -3);
 
+	/*
+	 * Progress of the background tuple arena compaction,
+	 * see box.cfg.memtx_compaction.
+	 */
+	lua_pushstring(L, "compaction_tuples_moved");
+	luaL_pushuint64(L, memtx->compaction_tuples_moved);
+	lua_settable(L, -3);
+
+	lua_pushstring(L, "compaction_bytes_moved");
+	luaL_pushuint64(L, memtx->compaction_bytes_moved);
+	lua_settable(L, -3);
+
 	return 1;
 }
 
@@ -279,6 +351,10 @@ box_lua_slab_init(struct lua_State *L)
 	lua_pushcfunction(L, lbox_slab_stats);
 	lua_settable(L, -3);
 
+	lua_pushstring(L, "churn");
+	lua_pushcfunction(L, lbox_slab_churn);
+	lua_settable(L, -3);
+
 	lua_pushstring(L, "check");
 	lua_pushcfunction(L, lbox_slab_check);
 	lua_settable(L, -3);
@@ -32,7 +32,10 @@
 #include "stat.h"
 
 #include <string.h>
+#include <dlfcn.h>
 #include <rmean.h>
+#include <histogram.h>
+#include <hdr_histogram.h>
 
 #include <lua.h>
 #include <lauxlib.h>
@@ -40,17 +43,21 @@
 
 #include "box/box.h"
 #include "box/iproto.h"
+#include "box/schema.h"
+#include "box/space.h"
 #include "box/engine.h"
 #include "box/vinyl.h"
 #include "box/sql.h"
+#include "box/wal.h"
 #include "info/info.h"
 #include "lua/info.h"
 #include "lua/utils.h"
+#include "cbus.h"
+#include "fiber.h"
+#include "profiler.h"
 
 extern struct rmean *rmean_box;
 extern struct rmean *rmean_error;
-/** network statistics (iproto & cbus) */
-extern struct rmean *rmean_net;
 extern struct rmean *rmean_tx_wal_bus;
 
 static void
@@ -148,7 +155,7 @@ static int
 lbox_stat_net_index(struct lua_State *L)
 {
 	const char *key = luaL_checkstring(L, -1);
-	if (rmean_foreach(rmean_net, seek_stat_item, L) == 0)
+	if (iproto_rmean_foreach(seek_stat_item, L) == 0)
 		return 0;
 
 	if (strcmp(key, "CONNECTIONS") == 0) {
@@ -183,7 +190,7 @@ static int
 lbox_stat_net_call(struct lua_State *L)
 {
 	lua_newtable(L);
-	rmean_foreach(rmean_net, set_stat_item, L);
+	iproto_rmean_foreach(set_stat_item, L);
 
 	lua_pushstring(L, "CONNECTIONS");
 	lua_rawget(L, -2);
@@ -202,6 +209,366 @@ lbox_stat_net_call(struct lua_State *L)
 	return 1;
 }
 
+/**
+ * Push a table with percentiles of a histogram to a Lua stack.
+ */
+static void
+fill_stat_histogram(struct lua_State *L, const char *name,
+		    struct histogram *hist)
+{
+	lua_pushstring(L, name);
+	lua_newtable(L);
+
+	lua_pushstring(L, "total");
+	lua_pushnumber(L, hist->total);
+	lua_settable(L, -3);
+
+	lua_pushstring(L, "p50");
+	lua_pushnumber(L, histogram_percentile(hist, 50));
+	lua_settable(L, -3);
+
+	lua_pushstring(L, "p90");
+	lua_pushnumber(L, histogram_percentile(hist, 90));
+	lua_settable(L, -3);
+
+	lua_pushstring(L, "p99");
+	lua_pushnumber(L, histogram_percentile(hist, 99));
+	lua_settable(L, -3);
+
+	lua_pushstring(L, "max");
+	lua_pushnumber(L, hist->max);
+	lua_settable(L, -3);
+
+	lua_settable(L, -3);
+}
+
+/**
+ * Push a table with percentiles of an HDR histogram to a Lua
+ * stack. The extra precision makes a p99.9 meaningful, so it is
+ * included.
+ */
+static void
+fill_stat_hdr_histogram(struct lua_State *L, const char *name,
+			struct hdr_histogram *hdr)
+{
+	lua_pushstring(L, name);
+	lua_newtable(L);
+
+	lua_pushstring(L, "total");
+	lua_pushnumber(L, hdr_histogram_total(hdr));
+	lua_settable(L, -3);
+
+	lua_pushstring(L, "p50");
+	lua_pushnumber(L, hdr_histogram_percentile(hdr, 50));
+	lua_settable(L, -3);
+
+	lua_pushstring(L, "p90");
+	lua_pushnumber(L, hdr_histogram_percentile(hdr, 90));
+	lua_settable(L, -3);
+
+	lua_pushstring(L, "p99");
+	lua_pushnumber(L, hdr_histogram_percentile(hdr, 99));
+	lua_settable(L, -3);
+
+	lua_pushstring(L, "p999");
+	lua_pushnumber(L, hdr_histogram_percentile(hdr, 99.9));
+	lua_settable(L, -3);
+
+	lua_settable(L, -3);
+}
+
+/**
+ * Push an array of per-thread network metric tables to a Lua
+ * stack, one table per network thread, in thread order. Each
+ * table has the same metrics as box.stat.net(), minus the
+ * 'current' fields, which are not accounted per thread, plus
+ * BATCH - the histogram of request batch sizes flushed to the
+ * tx thread ('total' flushes, 'p50', 'p90', 'p99' and 'max'
+ * batch sizes) and LATENCY - per priority class histograms of
+ * request round trip times in microseconds ('total' requests,
+ * 'p50', 'p90', 'p99' and 'p999' round trip times).
+ */
+static int
+lbox_stat_net_thread_call(struct lua_State *L)
+{
+	lua_newtable(L);
+	for (int i = 0; i < iproto_threads_count; i++) {
+		lua_newtable(L);
+		rmean_foreach(iproto_thread_rmean(i), set_stat_item, L);
+		fill_stat_histogram(L, "BATCH", iproto_thread_flush_hist(i));
+		lua_pushstring(L, "LATENCY");
+		lua_newtable(L);
+		for (int c = 0; c < IPROTO_CLASS_MAX; c++) {
+			fill_stat_hdr_histogram(L, iproto_class_strings[c],
+						iproto_thread_class_hist(i, c));
+		}
+		lua_settable(L, -3);
+		lua_rawseti(L, -2, i + 1);
+	}
+	return 1;
+}
+
+/**
+ * Push a table of WAL metrics to a Lua stack. Contains GROUP -
+ * the histogram of group commit sizes in bytes, one sample per
+ * group fdatasync() ('total' groups, 'p50', 'p90', 'p99' and
+ * 'max' group sizes), FSYNC - the HDR histogram of fdatasync()
+ * latencies in microseconds ('total' syncs, 'p50', 'p90', 'p99',
+ * 'p999'), both only populated in wal_mode = 'fsync', WRITE -
+ * the HDR histogram of WAL batch write latencies in the same
+ * format, and HICCUPS - the number of batch writes and
+ * fdatasync() calls slower than box.cfg.wal_hiccup_threshold
+ * since start.
+ */
+static int
+lbox_stat_wal(struct lua_State *L)
+{
+	lua_newtable(L);
+	fill_stat_histogram(L, "GROUP", wal_group_hist());
+	fill_stat_hdr_histogram(L, "FSYNC", wal_fsync_hdr_hist());
+	fill_stat_hdr_histogram(L, "WRITE", wal_write_hdr_hist());
+	lua_pushstring(L, "HICCUPS");
+	lua_pushnumber(L, wal_hiccup_count());
+	lua_settable(L, -3);
+	return 1;
+}
+
+/** cbus_endpoint_stat_foreach() callback, see lbox_stat_queues(). */
+static int
+queues_stat_cb(const char *name, int64_t depth, int64_t fetched,
+	       struct histogram *delay_hist, void *cb_ctx)
+{
+	struct lua_State *L = cb_ctx;
+	lua_pushstring(L, name);
+	lua_newtable(L);
+	lua_pushstring(L, "DEPTH");
+	lua_pushnumber(L, depth);
+	lua_settable(L, -3);
+	lua_pushstring(L, "TOTAL");
+	lua_pushnumber(L, fetched);
+	lua_settable(L, -3);
+	if (delay_hist != NULL)
+		fill_stat_histogram(L, "DELAY", delay_hist);
+	lua_settable(L, -3);
+	return 0;
+}
+
+/**
+ * Push a table of inter-thread queue statistics to a Lua stack,
+ * keyed by cbus endpoint name ('tx', 'wal', 'net1', ...). Each
+ * entry contains DEPTH - messages pushed but not yet taken by
+ * the consumer thread, TOTAL - messages consumed since start,
+ * and DELAY - a histogram of the push-to-fetch queue delay in
+ * microseconds. Shows which of the iproto/tx/wal/vinyl queues
+ * the request latency is spent in.
+ */
+static int
+lbox_stat_queues(struct lua_State *L)
+{
+	lua_newtable(L);
+	cbus_endpoint_stat_foreach(queues_stat_cb, L);
+	return 1;
+}
+
+/**
+ * Push a table of Lua GC pacing metrics to a Lua stack. Contains
+ * STEPS - the number of incremental GC steps run at fiber yield
+ * points, TIME - the total time spent in them and MAX - the
+ * longest single step, both in seconds.
+ */
+static int
+lbox_stat_gc(struct lua_State *L)
+{
+	uint64_t steps, step_time, step_time_max;
+	luaT_gc_pace_stat(&steps, &step_time, &step_time_max);
+	lua_newtable(L);
+
+	lua_pushstring(L, "STEPS");
+	lua_pushnumber(L, steps);
+	lua_settable(L, -3);
+
+	lua_pushstring(L, "TIME");
+	lua_pushnumber(L, step_time * 1e-9);
+	lua_settable(L, -3);
+
+	lua_pushstring(L, "MAX");
+	lua_pushnumber(L, step_time_max * 1e-9);
+	lua_settable(L, -3);
+
+	return 1;
+}
+
+/**
+ * Resolve the first Lua argument, a space id or name, into a
+ * space. Raises a Lua error if the space does not exist.
+ */
+static struct space *
+lbox_stat_space_resolve(struct lua_State *L)
+{
+	struct space *space;
+	if (lua_type(L, 1) == LUA_TNUMBER) {
+		space = space_by_id(lua_tonumber(L, 1));
+	} else {
+		const char *name = luaL_checkstring(L, 1);
+		space = space_by_name(name);
+	}
+	if (space == NULL)
+		luaL_error(L, "box.stat.space: space not found");
+	return space;
+}
+
+/**
+ * box.stat.space_enable(id | name): start collecting per-space
+ * operation statistics, see lbox_stat_space().
+ */
+static int
+lbox_stat_space_enable(struct lua_State *L)
+{
+	struct space *space = lbox_stat_space_resolve(L);
+	if (space_stats_enable(space) != 0)
+		return luaT_error(L);
+	return 0;
+}
+
+/**
+ * box.stat.space_disable(id | name): stop collecting per-space
+ * operation statistics and discard them.
+ */
+static int
+lbox_stat_space_disable(struct lua_State *L)
+{
+	struct space *space = lbox_stat_space_resolve(L);
+	space_stats_disable(space);
+	return 0;
+}
+
+/**
+ * box.stat.space(id | name): push a table of per-space metrics.
+ * Contains INSERT, REPLACE, UPDATE, UPSERT, DELETE - executed
+ * request counts ('total', 'rps'), BYTES - request payload bytes,
+ * ERROR - failed requests, and LATENCY - the histogram of request
+ * execution times in microseconds ('total' requests, 'p50',
+ * 'p90', 'p99' and 'max' times). Returns nil unless statistics
+ * have been enabled for the space with box.stat.space_enable().
+ */
+static int
+lbox_stat_space(struct lua_State *L)
+{
+	struct space *space = lbox_stat_space_resolve(L);
+	if (space->stats_rmean == NULL) {
+		lua_pushnil(L);
+		return 1;
+	}
+	lua_newtable(L);
+	rmean_foreach(space->stats_rmean, set_stat_item, L);
+	fill_stat_histogram(L, "LATENCY", space->stats_latency);
+	return 1;
+}
+
+/**
+ * A profiler_foreach() callback: account one sample into the
+ * aggregation table at the top of the Lua stack, keyed by
+ * "fiber_name/fid", with per-symbol sample counts inside. The
+ * instruction pointer is resolved lazily here, in the reader,
+ * via dladdr(); unresolvable addresses are reported in hex.
+ */
+static int
+profiler_stat_cb(uint64_t fid, void *ip, void *cb_ctx)
+{
+	struct lua_State *L = (struct lua_State *)cb_ctx;
+
+	char key[FIBER_NAME_MAX + 32];
+	struct fiber *f = fiber_find((uint32_t)fid);
+	snprintf(key, sizeof(key), "%s/%llu",
+		 f != NULL ? fiber_name(f) : "?",
+		 (unsigned long long)fid);
+
+	lua_pushstring(L, key);
+	lua_gettable(L, -2);
+	if (lua_isnil(L, -1)) {
+		lua_pop(L, 1);
+		lua_newtable(L);
+		lua_pushstring(L, key);
+		lua_pushvalue(L, -2);
+		lua_settable(L, -4);
+	}
+
+	char sym[128];
+	Dl_info info;
+	if (ip != NULL && dladdr(ip, &info) != 0 && info.dli_sname != NULL) {
+		snprintf(sym, sizeof(sym), "%s", info.dli_sname);
+	} else {
+		snprintf(sym, sizeof(sym), "0x%llx",
+			 (unsigned long long)(uintptr_t)ip);
+	}
+
+	lua_pushstring(L, sym);
+	lua_gettable(L, -2);
+	double count = lua_isnil(L, -1) ? 0 : lua_tonumber(L, -1);
+	lua_pop(L, 1);
+	lua_pushstring(L, sym);
+	lua_pushnumber(L, count + 1);
+	lua_settable(L, -3);
+
+	lua_pop(L, 1); /* per-fiber table */
+	return 0;
+}
+
+/**
+ * box.stat.profiler(): push a table with the state of the
+ * sampling CPU profiler of the calling (tx) thread. Contains
+ * 'enabled', 'sampled' - samples taken in this thread since
+ * start, and 'samples' - the rolling window of recent samples
+ * aggregated as { ["fiber_name/fid"] = { [symbol] = count } },
+ * i.e. collapsed flamegraph-style data.
+ */
+static int
+lbox_stat_profiler(struct lua_State *L)
+{
+	lua_newtable(L);
+
+	lua_pushstring(L, "enabled");
+	lua_pushboolean(L, profiler_is_enabled());
+	lua_settable(L, -3);
+
+	lua_pushstring(L, "sampled");
+	lua_pushnumber(L, profiler_sample_count());
+	lua_settable(L, -3);
+
+	lua_pushstring(L, "samples");
+	lua_newtable(L);
+	profiler_foreach(profiler_stat_cb, L);
+	lua_settable(L, -3);
+
+	return 1;
+}
+
+/**
+ * box.stat.profiler_enable([freq]): (re)arm the sampling
+ * profiler at the given frequency, default 49 Hz.
+ */
+static int
+lbox_stat_profiler_enable(struct lua_State *L)
+{
+	double freq = luaL_optnumber(L, 1, 49);
+	if (freq <= 0 || freq > 1000) {
+		return luaL_error(L, "box.stat.profiler_enable: frequency "
+				  "must be in (0, 1000]");
+	}
+	if (profiler_start(freq) != 0)
+		return luaT_error(L);
+	return 0;
+}
+
+/** box.stat.profiler_disable(): disarm the sampling profiler. */
+static int
+lbox_stat_profiler_disable(struct lua_State *L)
+{
+	(void)L;
+	profiler_stop();
+	return 0;
+}
+
 static int
 lbox_stat_sql(struct lua_State *L)
 {
@@ -231,6 +598,15 @@ box_lua_stat_init(struct lua_State *L)
 		{"vinyl", lbox_stat_vinyl},
 		{"reset", lbox_stat_reset},
 		{"sql", lbox_stat_sql},
+		{"wal", lbox_stat_wal},
+		{"queues", lbox_stat_queues},
+		{"gc", lbox_stat_gc},
+		{"space", lbox_stat_space},
+		{"space_enable", lbox_stat_space_enable},
+		{"space_disable", lbox_stat_space_disable},
+		{"profiler", lbox_stat_profiler},
+		{"profiler_enable", lbox_stat_profiler_enable},
+		{"profiler_disable", lbox_stat_profiler_disable},
 		{NULL, NULL}
 	};
 
@@ -242,6 +618,7 @@ box_lua_stat_init(struct lua_State *L)
 	lua_pop(L, 1); /* stat module */
 
 	static const struct luaL_Reg netstatlib [] = {
+		{"thread", lbox_stat_net_thread_call},
 		{NULL, NULL}
 	};
 
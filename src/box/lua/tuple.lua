@@ -108,16 +108,6 @@ local tuple_check = function(tuple, usage)
 end
 
 local tuple_iterator_t = ffi.typeof('box_tuple_iterator_t')
-local tuple_iterator_ref_t = ffi.typeof('box_tuple_iterator_t &')
-
-local function tuple_iterator(tuple)
-    local it = builtin.box_tuple_iterator(tuple)
-    if it == nil then
-        box.error()
-    end
-    return ffi.gc(ffi.cast(tuple_iterator_ref_t, it),
-        builtin.box_tuple_iterator_free)
-end
 
 local function tuple_iterator_next(it, tuple, pos)
     if pos == nil then
@@ -162,25 +152,63 @@ local function tuple_next(tuple, pos)
 end
 
 -- See http://www.lua.org/manual/5.2/manual.html#pdf-ipairs
+--
+-- Decode fields in place over the raw tuple data instead of
+-- going through a heap-allocated box_tuple_iterator: the only
+-- per-call allocations left are the generator closure and the
+-- luafun wrapper. A pointer to the yet undecoded part of the
+-- tuple is kept in an upvalue, so sequential iteration decodes
+-- each field exactly once; an out-of-order position falls back
+-- to a box_tuple_field() seek.
 local function tuple_ipairs(tuple, pos)
     tuple_check(tuple, "tuple:pairs(tuple[, pos])")
-    local it = tuple_iterator(tuple)
-    return fun.wrap(it, tuple, pos)
+    local field_count = builtin.box_tuple_field_count(tuple)
+    local curpos = -1
+    local curfield
+    local function gen(tuple, pos)
+        if pos == nil then
+            pos = 0
+        elseif type(pos) ~= "number" then
+            error("error: invalid key to 'next'")
+        end
+        if pos >= field_count then
+            if pos == field_count then
+                -- No more fields, stop iteration
+                return nil
+            end
+            -- Invalid pos
+            error("error: invalid key to 'next'")
+        end
+        local field
+        if pos == curpos then
+            -- Sequential iteration
+            field = curfield
+        else
+            -- Seek
+            field = builtin.box_tuple_field(tuple, pos)
+            if field == nil then
+                error("error: invalid key to 'next'")
+            end
+        end
+        local val
+        val, curfield = msgpackffi.decode_unchecked(field)
+        curpos = pos + 1
+        return curpos, val
+    end
+    return fun.wrap(gen, tuple, pos)
 end
 
+-- Decode the requested field range in one sequential pass over
+-- the raw tuple data: no box_tuple_iterator allocation and no
+-- repeated seeks.
 local function tuple_totable(tuple, i, j)
     tuple_check(tuple, "tuple:totable([from[, to]])");
-    local it = tuple_iterator(tuple)
-    builtin.box_tuple_rewind(it)
-    local field
     if i ~= nil then
         if i < 1 then
             error('tuple.totable: invalid second argument')
         end
-        field = builtin.box_tuple_seek(it, i - 1)
     else
         i = 1
-        field = builtin.box_tuple_next(it)
     end
     if j ~= nil then
         if j <= 0 then
@@ -189,12 +217,19 @@ local function tuple_totable(tuple, i, j)
     else
         j = 4294967295
     end
+    local field_count = builtin.box_tuple_field_count(tuple)
+    if j > field_count then
+        j = field_count
+    end
     local ret = {}
-    while field ~= nil and i <= j do
-        local val = msgpackffi.decode_unchecked(field)
-        table.insert(ret, val)
-        i = i + 1
-        field = builtin.box_tuple_next(it)
+    if i > j then
+        return setmetatable(ret, msgpackffi.array_mt)
+    end
+    local field = builtin.box_tuple_field(tuple, i - 1)
+    local val
+    for k = 1, j - i + 1 do
+        val, field = msgpackffi.decode_unchecked(field)
+        ret[k] = val
     end
     return setmetatable(ret, msgpackffi.array_mt)
 end
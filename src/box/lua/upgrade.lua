@@ -1,6 +1,7 @@
 local log = require('log')
 local bit = require('bit')
 local json = require('json')
+local fiber = require('fiber')
 
 -- Guest user id - the default user
 local GUEST = 0
@@ -48,6 +49,23 @@ function mkversion.__lt(lhs, rhs)
     return lhs.id < rhs.id
 end
 
+-- Upgrade handlers that sweep over a whole system space yield
+-- every that many processed records so that a big instance does
+-- not block the tx thread for the entire duration of the sweep.
+local UPGRADE_YIELD_ROWS = 100
+
+-- Make a closure to be called once per processed record by the
+-- per-row system space sweeps below.
+local function make_yielder()
+    local count = 0
+    return function()
+        count = count + 1
+        if count % UPGRADE_YIELD_ROWS == 0 then
+            fiber.sleep(0)
+        end
+    end
+end
+
 -- space:truncate() doesn't work with disabled triggers on __index
 local function truncate(space)
     local pk = space.index[0]
@@ -517,9 +535,11 @@ local function upgrade_priv_to_2_1_0()
     -- objects, since it has no effect. We also skip grants for
     -- sequences since they were added after the new privileges
     -- and compatibility mode was always off for them.
+    local yield = make_yielder()
     for _, user in _user:pairs() do
         if user[0] ~= ADMIN and user[0] ~= SUPER then
             for _, priv in _priv:pairs(user[0]) do
+                yield()
                 if priv[3] ~= 'sequence' and
                    bit.band(priv[5], box.priv.W) ~= 0 and
                    bit.band(priv[5], box.priv.R) ~= 0 then
@@ -755,7 +775,9 @@ local function upgrade_sequence_to_2_2_1()
     log.info("add sequence field to space _space_sequence")
     local _index = box.space[box.schema.INDEX_ID]
     local _space_sequence = box.space[box.schema.SPACE_SEQUENCE_ID]
+    local yield = make_yielder()
     for _, v in _space_sequence:pairs() do
+        yield()
         if #v > 3 then
             -- Must be a sequence created after upgrade.
             -- It doesn't need to get updated.
@@ -800,7 +822,9 @@ local function upgrade_ck_constraint_to_2_2_1()
     _index:insert{_ck_constraint.id, 0, 'primary', 'tree',
                   {unique = true}, {{0, 'unsigned'}, {1, 'string'}}}
 
+    local yield = make_yielder()
     for _, space in _space:pairs() do
+        yield()
         local flags = space.flags
         if flags.checks then
             for i, check in pairs(flags.checks) do
@@ -829,7 +853,9 @@ local function upgrade_func_to_2_2_1()
     local _func = box.space[box.schema.FUNC_ID]
     local _priv = box.space[box.schema.PRIV_ID]
     local datetime = os.date("%Y-%m-%d %H:%M:%S")
+    local yield = make_yielder()
     for _, v in box.space._func:pairs() do
+        yield()
         box.space._func:replace({v.id, v.owner, v.name, v.setuid, v[5] or 'LUA',
                                  '', 'function', {}, 'any', 'none', 'none',
                                  false, false, true, v[15] or {'LUA'},
@@ -931,7 +957,9 @@ local function upgrade_to_2_3_0()
 
     log.info("Extend _ck_constraint space format with is_enabled field")
     local _ck_constraint = box.space._ck_constraint
+    local yield = make_yielder()
     for _, tuple in _ck_constraint:pairs() do
+        yield()
         _ck_constraint:update({tuple[1], tuple[2]}, {{'=', 6, true}})
     end
     local format = {{name='space_id', type='unsigned'},
@@ -1042,10 +1070,7 @@ local function schema_needs_upgrade()
     return false
 end
 
-local function upgrade(options)
-    options = options or {}
-    setmetatable(options, {__index = {auto = false}})
-
+local function upgrade_run(options)
     local version = get_version()
     if version < mkversion(1, 7, 5) then
         log.warn('can upgrade from 1.7.5 only')
@@ -1072,6 +1097,32 @@ local function upgrade(options)
     end
 end
 
+-- Fiber running a background schema upgrade, if any. Used to
+-- protect against starting a second upgrade while the first one
+-- is still in progress.
+local upgrade_fiber
+
+local function upgrade(options)
+    options = options or {}
+    setmetatable(options, {__index = {auto = false, background = false}})
+    if not options.background then
+        return upgrade_run(options)
+    end
+    if upgrade_fiber ~= nil and upgrade_fiber:status() ~= 'dead' then
+        log.warn('schema upgrade is already running in the background')
+        return
+    end
+    upgrade_fiber = fiber.new(function()
+        local ok, err = pcall(upgrade_run, options)
+        if ok then
+            log.info('background schema upgrade complete')
+        else
+            log.error('background schema upgrade failed: %s', err)
+        end
+    end)
+    upgrade_fiber:name('schema_upgrade')
+end
+
 local function bootstrap()
     set_system_triggers(false)
 
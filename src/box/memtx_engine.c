@@ -36,6 +36,8 @@
 #include <small/mempool.h>
 
 #include "fiber.h"
+#include "fiber_cond.h"
+#include "cbus.h"
 #include "errinj.h"
 #include "coio_file.h"
 #include "tuple.h"
@@ -48,8 +50,13 @@
 #include "bootstrap.h"
 #include "replication.h"
 #include "schema.h"
+#include "box.h"
 #include "gc.h"
 #include "raft.h"
+#include "wal.h"
+#include "bit/bit.h"
+#include "probes.h"
+#include "pmatomic.h"
 
 /* sync snapshot every 16MB */
 #define SNAP_SYNC_INTERVAL	(1 << 24)
@@ -128,6 +135,134 @@ memtx_build_secondary_keys(struct space *space, void *param)
 	return 0;
 }
 
+enum {
+	/**
+	 * Number of fibers building secondary keys during
+	 * recovery. While one space's build sorts its keys in a
+	 * worker thread, the tx thread scans and builds other
+	 * spaces.
+	 */
+	MEMTX_BUILD_FIBER_COUNT = 4,
+};
+
+/** Context of a parallel secondary key build. */
+struct secondary_build_ctx {
+	/** The engine. */
+	struct memtx_engine *memtx;
+	/** Spaces to build, collected from the space cache. */
+	struct space **spaces;
+	/** Number of collected spaces. */
+	int space_count;
+	/** Allocated size of @a spaces. */
+	int space_capacity;
+	/** Next space to take by a worker fiber. */
+	int next;
+	/** First build error code. */
+	int rc;
+	/** First build error. */
+	struct diag diag;
+	/** Number of still running worker fibers. */
+	int worker_count;
+	/** Signalled when the last worker finishes. */
+	struct fiber_cond done_cond;
+};
+
+/** Collect a space for the parallel secondary key build. */
+static int
+memtx_collect_secondary_build(struct space *space, void *param)
+{
+	struct secondary_build_ctx *ctx = (struct secondary_build_ctx *)param;
+	struct memtx_space *memtx_space = (struct memtx_space *)space;
+	if (space->engine != (struct engine *)ctx->memtx ||
+	    space_index(space, 0) == NULL ||
+	    memtx_space->replace == memtx_space_replace_all_keys)
+		return 0;
+	if (ctx->space_count == ctx->space_capacity) {
+		int capacity = ctx->space_capacity == 0 ?
+			       256 : ctx->space_capacity * 2;
+		struct space **spaces = (struct space **)
+			realloc(ctx->spaces, capacity * sizeof(*spaces));
+		if (spaces == NULL) {
+			diag_set(OutOfMemory, capacity * sizeof(*spaces),
+				 "malloc", "secondary build context");
+			return -1;
+		}
+		ctx->spaces = spaces;
+		ctx->space_capacity = capacity;
+	}
+	ctx->spaces[ctx->space_count++] = space;
+	return 0;
+}
+
+/** Worker fiber of a parallel secondary key build. */
+static int
+memtx_build_secondary_worker_f(va_list ap)
+{
+	struct secondary_build_ctx *ctx =
+		va_arg(ap, struct secondary_build_ctx *);
+	while (ctx->rc == 0 && ctx->next < ctx->space_count) {
+		struct space *space = ctx->spaces[ctx->next++];
+		if (memtx_build_secondary_keys(space, ctx->memtx) != 0 &&
+		    ctx->rc == 0) {
+			ctx->rc = -1;
+			diag_move(diag_get(), &ctx->diag);
+		}
+	}
+	if (--ctx->worker_count == 0)
+		fiber_cond_signal(&ctx->done_cond);
+	return 0;
+}
+
+/**
+ * Build secondary keys of all spaces with a pool of fibers.
+ * The tuples are known to be immutable here, so the builds may
+ * offload their sort phase to worker threads; several fibers
+ * keep the tx thread busy while sorts are in progress.
+ */
+static int
+memtx_build_all_secondary_keys(struct memtx_engine *memtx)
+{
+	struct secondary_build_ctx ctx;
+	memset(&ctx, 0, sizeof(ctx));
+	ctx.memtx = memtx;
+	diag_create(&ctx.diag);
+	fiber_cond_create(&ctx.done_cond);
+	if (space_foreach(memtx_collect_secondary_build, &ctx) != 0) {
+		free(ctx.spaces);
+		return -1;
+	}
+	memtx->is_recovery_build = true;
+	int fiber_count = MIN(ctx.space_count, MEMTX_BUILD_FIBER_COUNT);
+	for (int i = 0; i < fiber_count; i++) {
+		struct fiber *worker = fiber_new("secondary.build",
+						 memtx_build_secondary_worker_f);
+		if (worker == NULL) {
+			/*
+			 * Already running workers will do the
+			 * job, albeit with less concurrency.
+			 */
+			if (ctx.worker_count > 0)
+				break;
+			memtx->is_recovery_build = false;
+			diag_destroy(&ctx.diag);
+			fiber_cond_destroy(&ctx.done_cond);
+			free(ctx.spaces);
+			return -1;
+		}
+		ctx.worker_count++;
+		fiber_start(worker, &ctx);
+	}
+	while (ctx.worker_count > 0)
+		fiber_cond_wait(&ctx.done_cond);
+	memtx->is_recovery_build = false;
+	if (ctx.rc != 0)
+		diag_move(&ctx.diag, diag_get());
+	diag_destroy(&ctx.diag);
+	fiber_cond_destroy(&ctx.done_cond);
+	free(ctx.spaces);
+	return ctx.rc;
+}
+
 static void
 memtx_engine_shutdown(struct engine *engine)
 {
@@ -152,6 +287,232 @@ static int
 memtx_engine_recover_snapshot_row(struct memtx_engine *memtx,
 				  struct xrow_header *row, int *is_space_system);
 
+enum {
+	/** Max number of rows in one snapshot read-ahead batch. */
+	SNAP_BATCH_ROWS_MAX = 1024,
+	/** Target total size of row bodies in one batch. */
+	SNAP_BATCH_SIZE_MAX = 1 << 20,
+	/** Read-ahead depth of the snapshot loader pipeline. */
+	SNAP_BATCH_COUNT = 2,
+};
+
+/**
+ * A batch of snapshot rows decoded by the reader thread. Row
+ * bodies are copied off the xlog cursor buffers into @a data so
+ * that the cursor may read the file further while the batch is
+ * being applied in tx.
+ */
+struct snap_batch {
+	/** Decoded row headers, bodies point into @a data. */
+	struct xrow_header rows[SNAP_BATCH_ROWS_MAX];
+	/** Number of rows in the batch. */
+	int row_count;
+	/** Row body storage. */
+	char *data;
+	/** Used size of @a data. */
+	size_t size;
+	/** Allocated size of @a data. */
+	size_t capacity;
+};
+
+/** State of a snapshot loader batch slot. */
+enum snap_batch_state {
+	/** The batch may be refilled by the reader. */
+	SNAP_BATCH_FREE,
+	/** The batch is decoded and may be applied in tx. */
+	SNAP_BATCH_READY,
+};
+
+/**
+ * Pipelined snapshot loader. A dedicated reader thread reads
+ * and decodes xlog rows into batches while the tx thread builds
+ * tuples and inserts them into the primary indexes. The
+ * pipeline uses a fixed ring of batch slots handed over in
+ * round-robin order, so rows are applied strictly in file
+ * order. Tuple allocation stays in tx - the small allocator
+ * backing the tuple arena is not thread-safe.
+ */
+struct snap_loader {
+	/** Reader thread. */
+	struct cord cord;
+	/** Pipe from tx to the reader thread. */
+	struct cpipe reader_pipe;
+	/** Pipe from the reader thread back to tx. */
+	struct cpipe tx_pipe;
+	/** Snapshot cursor. Opened and used in the reader thread. */
+	struct xlog_cursor cursor;
+	/** Batch slot ring. */
+	struct snap_batch batches[SNAP_BATCH_COUNT];
+	/** Batch slot states. */
+	enum snap_batch_state states[SNAP_BATCH_COUNT];
+	/** Per slot row count, 0 on EOF, -1 on read error. */
+	ssize_t rc[SNAP_BATCH_COUNT];
+	/** Reader error, moved to the consumer on failure. */
+	struct diag diag;
+	/**
+	 * Whether xlog_cursor_next() may skip broken rows. Set
+	 * by tx once recovery leaves the system spaces, read by
+	 * the producer fiber. Since the reader runs a couple of
+	 * batches ahead of tx, the flag may lag behind: the only
+	 * effect is that a broken row right at the system space
+	 * boundary is reported instead of skipped.
+	 */
+	bool force_recovery;
+	/** Set when tx is done consuming batches. */
+	bool is_done;
+	/** Producer <-> consumer handshake. */
+	struct fiber_cond cond;
+};
+
+/** Cbus message for calls executed in the reader thread. */
+struct snap_loader_msg {
+	struct cbus_call_msg base;
+	/** The loader. */
+	struct snap_loader *loader;
+	/** Batch to fill, for snap_loader_read_f(). */
+	struct snap_batch *batch;
+	/** Snapshot file name, for snap_loader_open_f(). */
+	const char *filename;
+	/** Whether broken rows may be skipped. */
+	bool force_recovery;
+	/** Number of rows read, 0 on EOF. */
+	ssize_t row_count;
+};
+
+/** Reader thread main loop. */
+static int
+snap_loader_cord_f(va_list ap)
+{
+	struct snap_loader *loader = va_arg(ap, struct snap_loader *);
+	struct cbus_endpoint endpoint;
+	cpipe_create(&loader->tx_pipe, "tx_prio");
+	cbus_endpoint_create(&endpoint, cord_name(cord()),
+			     fiber_schedule_cb, fiber());
+	cbus_loop(&endpoint);
+	cbus_endpoint_destroy(&endpoint, cbus_process);
+	cpipe_destroy(&loader->tx_pipe);
+	return 0;
+}
+
+/** Open the snapshot cursor. Executed in the reader thread. */
+static int
+snap_loader_open_f(struct cbus_call_msg *base)
+{
+	struct snap_loader_msg *msg = (struct snap_loader_msg *)base;
+	return xlog_cursor_open(&msg->loader->cursor, msg->filename);
+}
+
+/** Close the snapshot cursor. Executed in the reader thread. */
+static int
+snap_loader_close_f(struct cbus_call_msg *base)
+{
+	struct snap_loader_msg *msg = (struct snap_loader_msg *)base;
+	xlog_cursor_close(&msg->loader->cursor, false);
+	return 0;
+}
+
+/** Decode the next batch of rows. Executed in the reader thread. */
+static int
+snap_loader_read_f(struct cbus_call_msg *base)
+{
+	struct snap_loader_msg *msg = (struct snap_loader_msg *)base;
+	struct xlog_cursor *cursor = &msg->loader->cursor;
+	struct snap_batch *batch = msg->batch;
+	batch->row_count = 0;
+	batch->size = 0;
+	while (batch->row_count < SNAP_BATCH_ROWS_MAX &&
+	       batch->size < SNAP_BATCH_SIZE_MAX) {
+		struct xrow_header row;
+		int rc = xlog_cursor_next(cursor, &row, msg->force_recovery);
+		if (rc < 0)
+			return -1;
+		if (rc > 0)
+			break; /* EOF */
+		assert(row.bodycnt <= 1);
+		size_t body_len = row.bodycnt == 1 ? row.body[0].iov_len : 0;
+		if (batch->size + body_len > batch->capacity) {
+			size_t capacity = batch->capacity == 0 ?
+					  SNAP_BATCH_SIZE_MAX : batch->capacity;
+			while (capacity < batch->size + body_len)
+				capacity *= 2;
+			char *data = (char *)realloc(batch->data, capacity);
+			if (data == NULL) {
+				diag_set(OutOfMemory, capacity, "malloc",
+					 "snapshot row batch");
+				return -1;
+			}
+			batch->data = data;
+			batch->capacity = capacity;
+		}
+		struct xrow_header *dst = &batch->rows[batch->row_count++];
+		*dst = row;
+		if (body_len > 0) {
+			memcpy(batch->data + batch->size, row.body[0].iov_base,
+			       body_len);
+			/*
+			 * The buffer may still be reallocated by
+			 * a next row, so remember the offset and
+			 * translate it to a pointer at the end.
+			 */
+			dst->body[0].iov_base = (void *)batch->size;
+			batch->size += body_len;
+		}
+	}
+	for (int i = 0; i < batch->row_count; i++) {
+		struct xrow_header *row = &batch->rows[i];
+		if (row->bodycnt == 1) {
+			row->body[0].iov_base = batch->data +
+				(size_t)row->body[0].iov_base;
+		}
+	}
+	msg->row_count = batch->row_count;
+	return 0;
+}
+
+/** Execute a call in the reader thread. */
+static int
+snap_loader_call(struct snap_loader *loader, struct snap_loader_msg *msg,
+		 cbus_call_f func)
+{
+	msg->loader = loader;
+	bool cancellable = fiber_set_cancellable(false);
+	int rc = cbus_call(&loader->reader_pipe, &loader->tx_pipe,
+			   &msg->base, func, NULL, TIMEOUT_INFINITY);
+	fiber_set_cancellable(cancellable);
+	return rc;
+}
+
+/**
+ * Producer fiber: keeps the reader thread busy decoding rows
+ * into free batch slots ahead of the consumer.
+ */
+static int
+snap_loader_producer_f(va_list ap)
+{
+	struct snap_loader *loader = va_arg(ap, struct snap_loader *);
+	int slot = 0;
+	while (true) {
+		while (loader->states[slot] != SNAP_BATCH_FREE &&
+		       !loader->is_done)
+			fiber_cond_wait(&loader->cond);
+		if (loader->is_done)
+			break;
+		struct snap_loader_msg msg;
+		msg.batch = &loader->batches[slot];
+		msg.force_recovery = loader->force_recovery;
+		int rc = snap_loader_call(loader, &msg, snap_loader_read_f);
+		if (rc != 0)
+			diag_move(diag_get(), &loader->diag);
+		loader->rc[slot] = rc != 0 ? -1 : msg.row_count;
+		loader->states[slot] = SNAP_BATCH_READY;
+		fiber_cond_signal(&loader->cond);
+		if (rc != 0 || msg.row_count == 0)
+			break;
+		slot = (slot + 1) % SNAP_BATCH_COUNT;
+	}
+	return 0;
+}
+
 int
 memtx_engine_recover_snapshot(struct memtx_engine *memtx,
 			      const struct vclock *vclock)
@@ -163,54 +524,114 @@ memtx_engine_recover_snapshot(struct memtx_engine *memtx,
 						    signature, NONE);
 
 	say_info("recovering from `%s'", filename);
-	struct xlog_cursor cursor;
-	if (xlog_cursor_open(&cursor, filename) < 0)
+	struct snap_loader *loader =
+		(struct snap_loader *)calloc(1, sizeof(*loader));
+	if (loader == NULL) {
+		diag_set(OutOfMemory, sizeof(*loader), "malloc",
+			 "snap_loader");
+		return -1;
+	}
+	fiber_cond_create(&loader->cond);
+	diag_create(&loader->diag);
+	if (cord_costart(&loader->cord, "snap.reader", snap_loader_cord_f,
+			 loader) != 0) {
+		diag_destroy(&loader->diag);
+		fiber_cond_destroy(&loader->cond);
+		free(loader);
 		return -1;
+	}
+	cpipe_create(&loader->reader_pipe, "snap.reader");
 
-	int rc;
-	struct xrow_header row;
+	int rc = 0;
 	uint64_t row_count = 0;
 	int is_space_system = -1;
-	bool force_recovery = false;
-	/*
-	 * In case when we read system space, we can't ignore errors.
-	 */
-	while ((rc = xlog_cursor_next(&cursor, &row, force_recovery)) == 0) {
-		row.lsn = signature;
-		rc = memtx_engine_recover_snapshot_row(memtx, &row,
-						       &is_space_system);
-		force_recovery = is_space_system == 0 ?
-				 memtx->force_recovery : false;
-		if (rc < 0) {
-			if (!force_recovery)
-				break;
-			say_error("can't apply row: ");
-			diag_log();
+	struct snap_loader_msg msg;
+	msg.filename = filename;
+	if (snap_loader_call(loader, &msg, snap_loader_open_f) != 0) {
+		rc = -1;
+		goto out_stop_cord;
+	}
+
+	struct fiber *producer = fiber_new("snap.producer",
+					   snap_loader_producer_f);
+	if (producer == NULL) {
+		rc = -1;
+		goto out_close_cursor;
+	}
+	fiber_set_joinable(producer, true);
+	fiber_start(producer, loader);
+
+	int slot;
+	slot = 0;
+	while (true) {
+		while (loader->states[slot] != SNAP_BATCH_READY)
+			fiber_cond_wait(&loader->cond);
+		if (loader->rc[slot] < 0) {
+			diag_move(&loader->diag, diag_get());
+			rc = -1;
+			break;
 		}
-		++row_count;
-		if (row_count % 100000 == 0) {
-			say_info("%.1fM rows processed",
-				 row_count / 1000000.);
-			fiber_yield_timeout(0);
+		if (loader->rc[slot] == 0)
+			break; /* EOF */
+		struct snap_batch *batch = &loader->batches[slot];
+		for (int i = 0; i < batch->row_count; i++) {
+			struct xrow_header *row = &batch->rows[i];
+			row->lsn = signature;
+			rc = memtx_engine_recover_snapshot_row(
+				memtx, row, &is_space_system);
+			loader->force_recovery = is_space_system == 0 ?
+						 memtx->force_recovery : false;
+			if (rc < 0) {
+				if (!loader->force_recovery)
+					break;
+				say_error("can't apply row: ");
+				diag_log();
+				rc = 0;
+			}
+			++row_count;
+			if (row_count % 100000 == 0) {
+				say_info("%.1fM rows processed",
+					 row_count / 1000000.);
+				fiber_yield_timeout(0);
+			}
 		}
+		if (rc < 0)
+			break;
+		loader->states[slot] = SNAP_BATCH_FREE;
+		fiber_cond_signal(&loader->cond);
+		slot = (slot + 1) % SNAP_BATCH_COUNT;
 	}
-	xlog_cursor_close(&cursor, false);
-	if (rc < 0 || is_space_system < 0)
-		return -1;
+	loader->is_done = true;
+	fiber_cond_broadcast(&loader->cond);
+	fiber_join(producer);
+
+out_close_cursor:
+	snap_loader_call(loader, &msg, snap_loader_close_f);
 
+	if (rc == 0 && is_space_system < 0)
+		rc = -1;
 	/**
 	 * We should never try to read snapshots with no EOF
 	 * marker - such snapshots are very likely corrupted and
 	 * should not be trusted.
 	 */
-	if (!xlog_cursor_is_eof(&cursor)) {
+	if (rc == 0 && !xlog_cursor_is_eof(&loader->cursor)) {
 		if (!memtx->force_recovery)
 			panic("snapshot `%s' has no EOF marker", filename);
 		else
 			say_error("snapshot `%s' has no EOF marker", filename);
 	}
-
-	return 0;
+out_stop_cord:
+	cbus_stop_loop(&loader->reader_pipe);
+	cpipe_destroy(&loader->reader_pipe);
+	if (cord_join(&loader->cord) != 0)
+		panic("failed to join snapshot reader thread");
+	for (int i = 0; i < SNAP_BATCH_COUNT; i++)
+		free(loader->batches[i].data);
+	diag_destroy(&loader->diag);
+	fiber_cond_destroy(&loader->cond);
+	free(loader);
+	return rc;
 }
 
 static int
@@ -331,7 +752,7 @@ memtx_engine_begin_final_recovery(struct engine *engine)
 		 * unique keys.
 		 */
 		memtx->state = MEMTX_OK;
-		if (space_foreach(memtx_build_secondary_keys, memtx) != 0)
+		if (memtx_build_all_secondary_keys(memtx) != 0)
 			return -1;
 	}
 	return 0;
@@ -350,7 +771,7 @@ memtx_engine_end_recovery(struct engine *engine)
 	if (memtx->state != MEMTX_OK) {
 		assert(memtx->state == MEMTX_FINAL_RECOVERY);
 		memtx->state = MEMTX_OK;
-		if (space_foreach(memtx_build_secondary_keys, memtx) != 0)
+		if (memtx_build_all_secondary_keys(memtx) != 0)
 			return -1;
 	}
 	return 0;
@@ -530,6 +951,22 @@ struct checkpoint_entry {
 	struct rlist link;
 };
 
+/**
+ * A finished xlog tx block produced by a parallel snapshot
+ * writer thread, queued for the checkpoint thread to append to
+ * the snapshot file.
+ */
+struct checkpoint_block {
+	/** Link in checkpoint::blocks. */
+	struct stailq_entry link;
+	/** The encoded block, malloc()-ed. */
+	char *data;
+	/** Size of the block, in bytes. */
+	size_t size;
+	/** The number of rows in the block. */
+	int64_t row_count;
+};
+
 struct checkpoint {
 	/**
 	 * List of MemTX spaces to snapshot, with consistent
@@ -547,10 +984,48 @@ struct checkpoint {
 	 * checkpoint already exists.
 	 */
 	bool touch;
+	/** See memtx_engine::snap_io_backoff_latency. */
+	double backoff_latency;
+	/** See memtx_engine::checkpoint_threads. */
+	int worker_count;
+	/*
+	 * The rest of the struct is the parallel writer state,
+	 * used only when worker_count > 1.
+	 */
+	/** Protects the fields below. */
+	pthread_mutex_t mutex;
+	/** Signaled on any state change protected by the mutex. */
+	pthread_cond_t cond;
+	/** Finished tx blocks queued for the checkpoint thread. */
+	struct stailq blocks;
+	/** Total size of the queued blocks, for backpressure. */
+	size_t blocks_size;
+	/** The next entry to be claimed by a worker thread. */
+	struct checkpoint_entry *next_entry;
+	/** The number of worker threads that have finished. */
+	int workers_done;
+	/** Set on any failure to stop all parties. */
+	bool failed;
+	/** The error of the first failed worker thread. */
+	struct diag diag;
+	/**
+	 * Global row sequence. Snapshot rows are normally
+	 * numbered from 1 to the row count (see
+	 * checkpoint_write_row()); with parallel workers the
+	 * numbering stays unique but blocks of different workers
+	 * interleave in the file. That is fine: local recovery
+	 * overwrites snapshot row LSNs with the snapshot
+	 * signature and initial join streams the read view
+	 * directly, not the file.
+	 */
+	int64_t row_counter;
+	/** Timestamp stamped into the snapshot rows. */
+	double tm;
 };
 
 static struct checkpoint *
-checkpoint_new(const char *snap_dirname, uint64_t snap_io_rate_limit)
+checkpoint_new(const char *snap_dirname, uint64_t snap_io_rate_limit,
+	       double backoff_latency, int worker_count)
 {
 	struct checkpoint *ckpt = malloc(sizeof(*ckpt));
 	if (ckpt == NULL) {
@@ -568,6 +1043,18 @@ checkpoint_new(const char *snap_dirname, uint64_t snap_io_rate_limit)
 	vclock_create(&ckpt->vclock);
 	box_raft_checkpoint_local(&ckpt->raft);
 	ckpt->touch = false;
+	ckpt->backoff_latency = backoff_latency;
+	ckpt->worker_count = worker_count;
+	tt_pthread_mutex_init(&ckpt->mutex, NULL);
+	tt_pthread_cond_init(&ckpt->cond, NULL);
+	stailq_create(&ckpt->blocks);
+	ckpt->blocks_size = 0;
+	ckpt->next_entry = NULL;
+	ckpt->workers_done = 0;
+	ckpt->failed = false;
+	diag_create(&ckpt->diag);
+	ckpt->row_counter = 0;
+	ckpt->tm = 0;
 	return ckpt;
 }
 
@@ -579,6 +1066,16 @@ checkpoint_delete(struct checkpoint *ckpt)
 		entry->iterator->free(entry->iterator);
 		free(entry);
 	}
+	while (!stailq_empty(&ckpt->blocks)) {
+		struct checkpoint_block *block =
+			stailq_shift_entry(&ckpt->blocks,
+					   struct checkpoint_block, link);
+		free(block->data);
+		free(block);
+	}
+	diag_destroy(&ckpt->diag);
+	tt_pthread_cond_destroy(&ckpt->cond);
+	tt_pthread_mutex_destroy(&ckpt->mutex);
 	xdir_destroy(&ckpt->dir);
 	free(ckpt);
 }
@@ -592,6 +1089,17 @@ checkpoint_cancel(struct checkpoint *ckpt)
 	 * of use-after-free.
 	 */
 	if (ckpt->waiting_for_snap_thread) {
+		if (ckpt->worker_count > 1) {
+			/*
+			 * Ask the writer pool to stop: the
+			 * checkpoint thread defers cancellation
+			 * until the pool has been joined.
+			 */
+			tt_pthread_mutex_lock(&ckpt->mutex);
+			ckpt->failed = true;
+			tt_pthread_cond_broadcast(&ckpt->cond);
+			tt_pthread_mutex_unlock(&ckpt->mutex);
+		}
 		tt_pthread_cancel(ckpt->cord.id);
 		tt_pthread_join(ckpt->cord.id, NULL);
 	}
@@ -655,6 +1163,300 @@ finish:
 	return rc;
 }
 
+enum {
+	/** How often, in rows, to check for WAL fsync backoff. */
+	CHECKPOINT_BACKOFF_ROW_INTERVAL = 1024,
+};
+
+/**
+ * Snapshot writing competes with the WAL for disk bandwidth. If
+ * the latest WAL fdatasync() took longer than the configured
+ * threshold, pause until the device drains. The latency sample
+ * expires after a second (see wal_sync_recent_duration()), so an
+ * idle WAL can't stall the snapshot indefinitely.
+ */
+static void
+checkpoint_backoff(struct checkpoint *ckpt)
+{
+	if (ckpt->backoff_latency <= 0)
+		return;
+	while (wal_sync_recent_duration() > ckpt->backoff_latency)
+		ev_sleep(0.1);
+}
+
+enum {
+	/**
+	 * Target tx block size of a parallel snapshot writer,
+	 * matches XLOG_TX_AUTOCOMMIT_THRESHOLD.
+	 */
+	CHECKPOINT_TX_SIZE = 128 * 1024,
+	/**
+	 * Cap on the total size of finished blocks waiting for
+	 * the checkpoint thread: if the disk cannot keep up,
+	 * the workers stall instead of buffering the whole
+	 * snapshot in memory.
+	 */
+	CHECKPOINT_BLOCK_QUEUE_MAX = 16 * 1024 * 1024,
+};
+
+/** A parallel snapshot writer thread. */
+struct checkpoint_worker {
+	struct cord cord;
+	struct checkpoint *ckpt;
+};
+
+/**
+ * Record a failure: stop all workers and the checkpoint thread
+ * and keep the first error for the caller.
+ */
+static void
+checkpoint_set_failed(struct checkpoint *ckpt)
+{
+	tt_pthread_mutex_lock(&ckpt->mutex);
+	if (!ckpt->failed) {
+		ckpt->failed = true;
+		diag_move(diag_get(), &ckpt->diag);
+	}
+	tt_pthread_cond_broadcast(&ckpt->cond);
+	tt_pthread_mutex_unlock(&ckpt->mutex);
+}
+
+/** Claim the next space to dump. Returns NULL when done. */
+static struct checkpoint_entry *
+checkpoint_next_entry(struct checkpoint *ckpt)
+{
+	tt_pthread_mutex_lock(&ckpt->mutex);
+	struct checkpoint_entry *entry = NULL;
+	if (!ckpt->failed && ckpt->next_entry != NULL) {
+		entry = ckpt->next_entry;
+		if (rlist_last(&ckpt->entries) == &entry->link)
+			ckpt->next_entry = NULL;
+		else
+			ckpt->next_entry = rlist_next_entry(entry, link);
+	}
+	tt_pthread_mutex_unlock(&ckpt->mutex);
+	return entry;
+}
+
+/**
+ * Finalize the current tx block and queue it for the checkpoint
+ * thread, stalling if the queue has grown too big.
+ */
+static int
+checkpoint_block_push(struct checkpoint *ckpt,
+		      struct xlog_tx_encoder *encoder)
+{
+	char *data;
+	size_t size;
+	int64_t row_count;
+	if (xlog_tx_encoder_flush(encoder, &data, &size, &row_count) != 0)
+		return -1;
+	if (data == NULL)
+		return 0;
+	struct checkpoint_block *block = malloc(sizeof(*block));
+	if (block == NULL) {
+		diag_set(OutOfMemory, sizeof(*block), "malloc",
+			 "struct checkpoint_block");
+		free(data);
+		return -1;
+	}
+	block->data = data;
+	block->size = size;
+	block->row_count = row_count;
+	tt_pthread_mutex_lock(&ckpt->mutex);
+	while (!ckpt->failed &&
+	       ckpt->blocks_size >= CHECKPOINT_BLOCK_QUEUE_MAX)
+		tt_pthread_cond_wait(&ckpt->cond, &ckpt->mutex);
+	if (ckpt->failed) {
+		tt_pthread_mutex_unlock(&ckpt->mutex);
+		free(block->data);
+		free(block);
+		/* The first failer has recorded the error. */
+		diag_set(FiberIsCancelled);
+		return -1;
+	}
+	stailq_add_tail_entry(&ckpt->blocks, block, link);
+	ckpt->blocks_size += size;
+	tt_pthread_cond_broadcast(&ckpt->cond);
+	tt_pthread_mutex_unlock(&ckpt->mutex);
+	return 0;
+}
+
+/** Parallel flavor of checkpoint_write_tuple(). */
+static int
+checkpoint_worker_write_tuple(struct checkpoint *ckpt,
+			      struct xlog_tx_encoder *encoder,
+			      uint32_t space_id, uint32_t group_id,
+			      const char *data, uint32_t size)
+{
+	struct request_replace_body body;
+	request_replace_body_create(&body, space_id);
+
+	struct xrow_header row;
+	memset(&row, 0, sizeof(struct xrow_header));
+	row.type = IPROTO_INSERT;
+	row.group_id = group_id;
+
+	row.bodycnt = 2;
+	row.body[0].iov_base = &body;
+	row.body[0].iov_len = sizeof(body);
+	row.body[1].iov_base = (char *)data;
+	row.body[1].iov_len = size;
+
+	row.tm = ckpt->tm;
+	row.replica_id = 0;
+	row.lsn = pm_atomic_fetch_add(&ckpt->row_counter, 1) + 1;
+	row.sync = 0; /* don't write sync to wal */
+
+	ssize_t written = xlog_tx_encoder_add_row(encoder, &row);
+	fiber_gc();
+	if (written < 0)
+		return -1;
+	if (xlog_tx_encoder_size(encoder) >= CHECKPOINT_TX_SIZE)
+		return checkpoint_block_push(ckpt, encoder);
+	return 0;
+}
+
+/** Main function of a parallel snapshot writer thread. */
+static void *
+checkpoint_worker_f(void *arg)
+{
+	struct checkpoint_worker *worker = (struct checkpoint_worker *)arg;
+	struct checkpoint *ckpt = worker->ckpt;
+
+	struct xlog_tx_encoder encoder;
+	if (xlog_tx_encoder_create(&encoder, &ckpt->dir.opts) != 0) {
+		checkpoint_set_failed(ckpt);
+		goto done;
+	}
+	struct checkpoint_entry *entry;
+	while ((entry = checkpoint_next_entry(ckpt)) != NULL) {
+		int rc;
+		uint32_t size;
+		const char *data;
+		struct snapshot_iterator *it = entry->iterator;
+		while ((rc = it->next(it, &data, &size)) == 0 && data != NULL) {
+			if (checkpoint_worker_write_tuple(ckpt, &encoder,
+					entry->space_id, entry->group_id,
+					data, size) != 0) {
+				rc = -1;
+				break;
+			}
+		}
+		if (rc != 0) {
+			checkpoint_set_failed(ckpt);
+			break;
+		}
+	}
+	if (checkpoint_block_push(ckpt, &encoder) != 0)
+		checkpoint_set_failed(ckpt);
+	xlog_tx_encoder_destroy(&encoder);
+done:
+	tt_pthread_mutex_lock(&ckpt->mutex);
+	ckpt->workers_done++;
+	tt_pthread_cond_broadcast(&ckpt->cond);
+	tt_pthread_mutex_unlock(&ckpt->mutex);
+	return NULL;
+}
+
+/**
+ * Write the snapshot body with a pool of worker threads. The
+ * spaces are distributed between the workers, which encode and
+ * compress xlog tx blocks in parallel; this thread only appends
+ * the finished blocks to the file, so the disk, not a single
+ * CPU, becomes the bottleneck.
+ */
+static int
+checkpoint_write_parallel(struct checkpoint *ckpt, struct xlog *snap)
+{
+	int worker_count = ckpt->worker_count;
+	struct checkpoint_worker *workers =
+		calloc(worker_count, sizeof(*workers));
+	if (workers == NULL) {
+		diag_set(OutOfMemory, worker_count * sizeof(*workers),
+			 "malloc", "checkpoint workers");
+		return -1;
+	}
+	ckpt->next_entry = rlist_empty(&ckpt->entries) ? NULL :
+		rlist_first_entry(&ckpt->entries,
+				  struct checkpoint_entry, link);
+	int started = 0;
+	for (int i = 0; i < worker_count; i++) {
+		workers[i].ckpt = ckpt;
+		char name[FIBER_NAME_MAX];
+		snprintf(name, sizeof(name), "snap.writer.%d", i);
+		if (cord_start(&workers[i].cord, name,
+			       checkpoint_worker_f, &workers[i]) != 0)
+			break;
+		started++;
+	}
+	int rc = 0;
+	if (started == 0) {
+		free(workers);
+		return -1;
+	}
+	int64_t rows = 0;
+	while (true) {
+		tt_pthread_mutex_lock(&ckpt->mutex);
+		while (stailq_empty(&ckpt->blocks) &&
+		       ckpt->workers_done < started)
+			tt_pthread_cond_wait(&ckpt->cond, &ckpt->mutex);
+		struct checkpoint_block *block = NULL;
+		if (!stailq_empty(&ckpt->blocks)) {
+			block = stailq_shift_entry(&ckpt->blocks,
+					struct checkpoint_block, link);
+			ckpt->blocks_size -= block->size;
+			tt_pthread_cond_broadcast(&ckpt->cond);
+		}
+		tt_pthread_mutex_unlock(&ckpt->mutex);
+		if (block == NULL)
+			break;
+		/*
+		 * Keep draining the queue even after a failure
+		 * so that stalled workers can finish.
+		 */
+		if (rc == 0 && !ckpt->failed) {
+			if (xlog_write_block(snap, block->data, block->size,
+					     block->row_count) < 0) {
+				rc = -1;
+				tt_pthread_mutex_lock(&ckpt->mutex);
+				ckpt->failed = true;
+				tt_pthread_cond_broadcast(&ckpt->cond);
+				tt_pthread_mutex_unlock(&ckpt->mutex);
+			} else {
+				if (rows / 1000000 !=
+				    (rows + block->row_count) / 1000000)
+					say_crit("%.1fM rows written",
+						 (rows + block->row_count) /
+						 1000000.0);
+				rows += block->row_count;
+				checkpoint_backoff(ckpt);
+			}
+		}
+		free(block->data);
+		free(block);
+	}
+	for (int i = 0; i < started; i++) {
+		if (cord_join(&workers[i].cord) != 0)
+			diag_log();
+	}
+	free(workers);
+	if (started < worker_count)
+		rc = -1;
+	if (rc == 0 && ckpt->failed) {
+		/*
+		 * The diag is empty if the checkpoint was stopped
+		 * by checkpoint_cancel() rather than an error.
+		 */
+		if (diag_is_empty(&ckpt->diag))
+			diag_set(FiberIsCancelled);
+		else
+			diag_move(&ckpt->diag, diag_get());
+		rc = -1;
+	}
+	return rc;
+}
+
 static int
 checkpoint_f(va_list ap)
 {
@@ -676,19 +1478,42 @@ checkpoint_f(va_list ap)
 
 	say_info("saving snapshot `%s'", snap.filename);
 	ERROR_INJECT_SLEEP(ERRINJ_SNAP_WRITE_DELAY);
-	struct checkpoint_entry *entry;
-	rlist_foreach_entry(entry, &ckpt->entries, link) {
-		int rc;
-		uint32_t size;
-		const char *data;
-		struct snapshot_iterator *it = entry->iterator;
-		while ((rc = it->next(it, &data, &size)) == 0 && data != NULL) {
-			if (checkpoint_write_tuple(&snap, entry->space_id,
-					entry->group_id, data, size) != 0)
-				goto fail;
-		}
+	if (ckpt->worker_count > 1) {
+		/*
+		 * A pthread_cancel() from checkpoint_cancel()
+		 * must not strand the worker pool or leave the
+		 * mutex locked: defer it until the pool has been
+		 * joined. The cancel also sets ckpt->failed, so
+		 * the pool terminates promptly.
+		 */
+		int old_state;
+		tt_pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &old_state);
+		int rc = checkpoint_write_parallel(ckpt, &snap);
+		tt_pthread_setcancelstate(old_state, NULL);
 		if (rc != 0)
 			goto fail;
+	} else {
+		int64_t rows = 0;
+		struct checkpoint_entry *entry;
+		rlist_foreach_entry(entry, &ckpt->entries, link) {
+			int rc;
+			uint32_t size;
+			const char *data;
+			struct snapshot_iterator *it = entry->iterator;
+			while ((rc = it->next(it, &data, &size)) == 0 &&
+			       data != NULL) {
+				if (checkpoint_write_tuple(&snap,
+						entry->space_id,
+						entry->group_id,
+						data, size) != 0)
+					goto fail;
+				if (++rows %
+				    CHECKPOINT_BACKOFF_ROW_INTERVAL == 0)
+					checkpoint_backoff(ckpt);
+			}
+			if (rc != 0)
+				goto fail;
+		}
 	}
 	if (checkpoint_write_raft(&snap, &ckpt->raft) != 0)
 		goto fail;
@@ -711,7 +1536,9 @@ memtx_engine_begin_checkpoint(struct engine *engine, bool is_scheduled)
 
 	assert(memtx->checkpoint == NULL);
 	memtx->checkpoint = checkpoint_new(memtx->snap_dir.dirname,
-					   memtx->snap_io_rate_limit);
+					   memtx->snap_io_rate_limit,
+					   memtx->snap_io_backoff_latency,
+					   memtx->checkpoint_threads);
 	if (memtx->checkpoint == NULL)
 		return -1;
 
@@ -739,6 +1566,8 @@ memtx_engine_wait_checkpoint(struct engine *engine,
 		memtx->checkpoint->touch = true;
 	}
 	vclock_copy(&memtx->checkpoint->vclock, vclock);
+	ev_now_update(loop());
+	memtx->checkpoint->tm = ev_now(loop());
 
 	if (cord_costart(&memtx->checkpoint->cord, "snapshot",
 			 checkpoint_f, memtx->checkpoint)) {
@@ -1033,6 +1862,7 @@ memtx_engine_run_gc(struct memtx_engine *memtx, bool *stop)
 	struct memtx_gc_task *task = stailq_first_entry(&memtx->gc_queue,
 					struct memtx_gc_task, link);
 	bool task_done;
+	TNT_PROBE1(memtx_gc_step, (uintptr_t)task);
 	task->vtab->run(task, &task_done);
 	if (task_done) {
 		stailq_shift(&memtx->gc_queue);
@@ -1061,10 +1891,175 @@ memtx_engine_gc_f(va_list va)
 	return 0;
 }
 
+enum {
+	/**
+	 * Number of tuples the compaction fiber re-inserts
+	 * between sleeps, limiting the load it puts on tx.
+	 */
+	MEMTX_COMPACTION_BATCH = 100,
+};
+
+/** Delay between compaction batches, seconds. */
+static const double MEMTX_COMPACTION_BATCH_DELAY = 0.01;
+
+/** Delay between compaction passes over all spaces, seconds. */
+static const double MEMTX_COMPACTION_IDLE_DELAY = 1;
+
+/**
+ * Tuple slabs are worth compacting when live tuples occupy less
+ * than this share of the formatted slab space. Below the
+ * threshold a sparsely used slab is likely to be emptied by
+ * migrating its surviving tuples and returned to the arena.
+ */
+static const double MEMTX_COMPACTION_USED_RATIO = 0.75;
+
+static int
+memtx_compaction_stats_cb(const struct mempool_stats *stats, void *cb_ctx)
+{
+	(void) stats;
+	(void) cb_ctx;
+	return 0;
+}
+
+/** Return true if the tuple slabs are fragmented enough. */
+static bool
+memtx_compaction_is_needed(struct memtx_engine *memtx)
+{
+	struct small_stats totals;
+	small_stats(&memtx->alloc, &totals, memtx_compaction_stats_cb, NULL);
+	if (totals.total == 0)
+		return false;
+	return (double) totals.used / (double) totals.total <
+	       MEMTX_COMPACTION_USED_RATIO;
+}
+
+/** Set of space ids to be visited by a compaction pass. */
+struct memtx_compaction_ctx {
+	/** Collected space ids. */
+	uint32_t *ids;
+	/** Number of collected ids. */
+	int count;
+	/** Allocated size of @a ids. */
+	int capacity;
+};
+
+/** Collect a space id for a compaction pass. */
+static int
+memtx_compaction_collect_space(struct space *space, void *param)
+{
+	struct memtx_compaction_ctx *ctx =
+		(struct memtx_compaction_ctx *)param;
+	if (space->engine->vtab != &memtx_engine_vtab ||
+	    space_is_system(space) || space_index(space, 0) == NULL)
+		return 0;
+	if (ctx->count == ctx->capacity) {
+		int capacity = ctx->capacity == 0 ? 256 : ctx->capacity * 2;
+		uint32_t *ids = (uint32_t *)realloc(ctx->ids,
+						    capacity * sizeof(*ids));
+		if (ids == NULL) {
+			diag_set(OutOfMemory, capacity * sizeof(*ids),
+				 "malloc", "compaction context");
+			return -1;
+		}
+		ctx->ids = ids;
+		ctx->capacity = capacity;
+	}
+	ctx->ids[ctx->count++] = space_id(space);
+	return 0;
+}
+
+/**
+ * Migrate the tuples of a space to freshly allocated copies by
+ * replacing each tuple with an identical one through the regular
+ * replace machinery. New tuples land in the currently filled
+ * slabs, so the sparsely used slabs they leave get empty and
+ * reusable. Replaces go through the transaction machinery, so
+ * concurrent transactions, including MVCC ones, see them as
+ * ordinary no-op updates.
+ */
+static int
+memtx_compact_space(struct memtx_engine *memtx, uint32_t space_id)
+{
+	struct space *space = space_by_id(space_id);
+	if (space == NULL || space->engine->vtab != &memtx_engine_vtab)
+		return 0;
+	struct index *pk = space_index(space, 0);
+	if (pk == NULL)
+		return 0;
+	struct iterator *it = index_create_iterator(pk, ITER_ALL, NULL, 0);
+	if (it == NULL)
+		return -1;
+	int rc = 0;
+	int batch = 0;
+	struct tuple *tuple;
+	while ((rc = iterator_next(it, &tuple)) == 0 && tuple != NULL) {
+		uint32_t bsize;
+		const char *data = tuple_data_range(tuple, &bsize);
+		/*
+		 * The iterator references the old tuple, so the
+		 * data stays valid while the copy is made.
+		 */
+		if (box_replace(space_id, data, data + bsize, NULL) != 0) {
+			rc = -1;
+			break;
+		}
+		memtx->compaction_tuples_moved++;
+		memtx->compaction_bytes_moved += bsize;
+		if (++batch >= MEMTX_COMPACTION_BATCH) {
+			batch = 0;
+			fiber_sleep(MEMTX_COMPACTION_BATCH_DELAY);
+			if (!memtx->compaction || fiber_is_cancelled())
+				break;
+		}
+	}
+	iterator_delete(it);
+	return rc;
+}
+
+static int
+memtx_engine_compaction_f(va_list va)
+{
+	struct memtx_engine *memtx = va_arg(va, struct memtx_engine *);
+	while (!fiber_is_cancelled()) {
+		if (!memtx->compaction) {
+			fiber_yield_timeout(TIMEOUT_INFINITY);
+			continue;
+		}
+		if (!memtx_compaction_is_needed(memtx)) {
+			fiber_sleep(MEMTX_COMPACTION_IDLE_DELAY);
+			continue;
+		}
+		struct memtx_compaction_ctx ctx;
+		memset(&ctx, 0, sizeof(ctx));
+		if (space_foreach(memtx_compaction_collect_space, &ctx) != 0) {
+			diag_log();
+			free(ctx.ids);
+			fiber_sleep(MEMTX_COMPACTION_IDLE_DELAY);
+			continue;
+		}
+		for (int i = 0; i < ctx.count; i++) {
+			if (!memtx->compaction || fiber_is_cancelled())
+				break;
+			if (memtx_compact_space(memtx, ctx.ids[i]) != 0) {
+				/*
+				 * E.g. the instance became
+				 * read-only. Retry on the next
+				 * pass.
+				 */
+				diag_log();
+				break;
+			}
+		}
+		free(ctx.ids);
+		fiber_sleep(MEMTX_COMPACTION_IDLE_DELAY);
+	}
+	return 0;
+}
+
 struct memtx_engine *
 memtx_engine_new(const char *snap_dirname, bool force_recovery,
 		 uint64_t tuple_arena_max_size, uint32_t objsize_min,
-		 bool dontdump, float alloc_factor)
+		 bool dontdump, bool use_hugepages, float alloc_factor)
 {
 	struct memtx_engine *memtx = calloc(1, sizeof(*memtx));
 	if (memtx == NULL) {
@@ -1112,6 +2107,11 @@ memtx_engine_new(const char *snap_dirname, bool force_recovery,
 	if (memtx->gc_fiber == NULL)
 		goto fail;
 
+	memtx->compaction_fiber = fiber_new("memtx.compaction",
+					    memtx_engine_compaction_f);
+	if (memtx->compaction_fiber == NULL)
+		goto fail;
+
 	/* Apply lowest allowed objsize bound. */
 	if (objsize_min < OBJSIZE_MIN)
 		objsize_min = OBJSIZE_MIN;
@@ -1129,7 +2129,7 @@ memtx_engine_new(const char *snap_dirname, bool force_recovery,
 	/* Initialize tuple allocator. */
 	quota_init(&memtx->quota, tuple_arena_max_size);
 	tuple_arena_create(&memtx->arena, &memtx->quota, tuple_arena_max_size,
-			   SLAB_SIZE, dontdump, "memtx");
+			   SLAB_SIZE, dontdump, use_hugepages, "memtx");
 	slab_cache_create(&memtx->slab_cache, &memtx->arena);
 	float actual_alloc_factor;
 	small_alloc_create(&memtx->alloc, &memtx->slab_cache,
@@ -1145,10 +2145,13 @@ memtx_engine_new(const char *snap_dirname, bool force_recovery,
 		       MEMTX_ITERATOR_SIZE);
 	memtx->num_reserved_extents = 0;
 	memtx->reserved_extents = NULL;
+	memtx->reserve_extents_batch = RESERVE_EXTENTS_BEFORE_REPLACE;
+	memtx->reserve_calls_since_refill = 0;
 
 	memtx->state = MEMTX_INITIALIZED;
 	memtx->max_tuple_size = MAX_TUPLE_SIZE;
 	memtx->force_recovery = force_recovery;
+	memtx->checkpoint_threads = 1;
 
 	memtx->replica_join_cord = NULL;
 
@@ -1156,6 +2159,7 @@ memtx_engine_new(const char *snap_dirname, bool force_recovery,
 	memtx->base.name = "memtx";
 
 	fiber_start(memtx->gc_fiber, memtx);
+	fiber_start(memtx->compaction_fiber, memtx);
 	return memtx;
 fail:
 	xdir_destroy(&memtx->snap_dir);
@@ -1171,12 +2175,35 @@ memtx_engine_schedule_gc(struct memtx_engine *memtx,
 	fiber_wakeup(memtx->gc_fiber);
 }
 
+void
+memtx_engine_set_compaction(struct memtx_engine *memtx, bool enable)
+{
+	if (memtx->compaction == enable)
+		return;
+	memtx->compaction = enable;
+	if (enable)
+		fiber_wakeup(memtx->compaction_fiber);
+}
+
 void
 memtx_engine_set_snap_io_rate_limit(struct memtx_engine *memtx, double limit)
 {
 	memtx->snap_io_rate_limit = limit * 1024 * 1024;
 }
 
+void
+memtx_engine_set_snap_io_backoff_latency(struct memtx_engine *memtx,
+					 double latency)
+{
+	memtx->snap_io_backoff_latency = latency;
+}
+
+void
+memtx_engine_set_checkpoint_threads(struct memtx_engine *memtx, int threads)
+{
+	memtx->checkpoint_threads = threads;
+}
+
 int
 memtx_engine_set_memory(struct memtx_engine *memtx, size_t size)
 {
@@ -1211,6 +2238,32 @@ memtx_leave_delayed_free_mode(struct memtx_engine *memtx)
 		small_alloc_setopt(&memtx->alloc, SMALL_DELAYED_FREE_MODE, false);
 }
 
+/** Churn accounting class for an allocation of @a size bytes. */
+static inline struct memtx_churn_class *
+memtx_churn_class(struct memtx_engine *memtx, size_t size)
+{
+	int class = size > 1 ? 64 - bit_clz_u64(size - 1) : 0;
+	if (class >= MEMTX_CHURN_CLASSES)
+		class = MEMTX_CHURN_CLASSES - 1;
+	return &memtx->churn[class];
+}
+
+static inline void
+memtx_churn_account_alloc(struct memtx_engine *memtx, size_t size)
+{
+	struct memtx_churn_class *class = memtx_churn_class(memtx, size);
+	class->allocs++;
+	class->alloc_bytes += size;
+}
+
+static inline void
+memtx_churn_account_free(struct memtx_engine *memtx, size_t size)
+{
+	struct memtx_churn_class *class = memtx_churn_class(memtx, size);
+	class->frees++;
+	class->free_bytes += size;
+}
+
 struct tuple *
 memtx_tuple_new(struct tuple_format *format, const char *data, const char *end)
 {
@@ -1260,6 +2313,7 @@ memtx_tuple_new(struct tuple_format *format, const char *data, const char *end)
 		diag_set(OutOfMemory, total, "slab allocator", "memtx_tuple");
 		goto end;
 	}
+	memtx_churn_account_alloc(memtx, total);
 	tuple = &memtx_tuple->base;
 	tuple->refs = 0;
 	memtx_tuple->version = memtx->snapshot_version;
@@ -1293,6 +2347,7 @@ memtx_tuple_delete(struct tuple_format *format, struct tuple *tuple)
 		smfree(&memtx->alloc, memtx_tuple, total);
 	else
 		smfree_delayed(&memtx->alloc, memtx_tuple, total);
+	memtx_churn_account_free(memtx, total);
 	tuple_format_unref(format);
 }
 
@@ -1305,6 +2360,7 @@ metmx_tuple_chunk_delete(struct tuple_format *format, const char *data)
 			     struct tuple_chunk, data);
 	uint32_t sz = tuple_chunk_sz(tuple_chunk->data_sz);
 	smfree(&memtx->alloc, tuple_chunk, sz);
+	memtx_churn_account_free(memtx, sz);
 }
 
 const char *
@@ -1319,6 +2375,7 @@ memtx_tuple_chunk_new(struct tuple_format *format, struct tuple *tuple,
 		diag_set(OutOfMemory, sz, "smalloc", "tuple");
 		return NULL;
 	}
+	memtx_churn_account_alloc(memtx, sz);
 	tuple_chunk->data_sz = data_sz;
 	memcpy(tuple_chunk->data, data, data_sz);
 	return tuple_chunk->data;
@@ -1387,8 +2444,29 @@ memtx_index_extent_reserve(struct memtx_engine *memtx, int num)
 			 "mempool", "new slab");
 		return -1;
 	});
+	if (memtx->num_reserved_extents >= num) {
+		memtx->reserve_calls_since_refill++;
+		return 0;
+	}
+	/*
+	 * Adapt the refill batch to the recent demand: if the
+	 * slack lasted only a few statements, double the batch,
+	 * and if it lasted long, shrink it back.
+	 */
+	if (memtx->reserve_calls_since_refill < RESERVE_EXTENTS_CALLS_GROW &&
+	    memtx->reserve_extents_batch < RESERVE_EXTENTS_BATCH_MAX) {
+		memtx->reserve_extents_batch *= 2;
+	} else if (memtx->reserve_calls_since_refill >
+		   RESERVE_EXTENTS_CALLS_DECAY &&
+		   memtx->reserve_extents_batch >
+		   RESERVE_EXTENTS_BEFORE_REPLACE) {
+		memtx->reserve_extents_batch /= 2;
+	}
+	memtx->reserve_calls_since_refill = 0;
+	int target = num > memtx->reserve_extents_batch ?
+		     num : memtx->reserve_extents_batch;
 	struct mempool *pool = &memtx->index_extent_pool;
-	while (memtx->num_reserved_extents < num) {
+	while (memtx->num_reserved_extents < target) {
 		void *ext;
 		while ((ext = mempool_alloc(pool)) == NULL) {
 			bool stop;
@@ -1397,6 +2475,13 @@ memtx_index_extent_reserve(struct memtx_engine *memtx, int num)
 				break;
 		}
 		if (ext == NULL) {
+			/*
+			 * Reserving beyond the guaranteed minimum
+			 * is best effort - fail only if even the
+			 * minimum can not be met.
+			 */
+			if (memtx->num_reserved_extents >= num)
+				return 0;
 			diag_set(OutOfMemory, MEMTX_EXTENT_SIZE,
 				 "mempool", "new slab");
 			return -1;
@@ -87,6 +87,31 @@ enum memtx_recovery_state {
 /** Memtx extents pool, available to statistics. */
 extern struct mempool memtx_index_extent_pool;
 
+enum {
+	/**
+	 * Number of power-of-two size classes used to account
+	 * tuple allocation churn. Class n covers allocations of
+	 * (2^(n-1), 2^n] bytes, the last class absorbs the tail.
+	 */
+	MEMTX_CHURN_CLASSES = 32,
+};
+
+/**
+ * Cumulative tuple allocation churn of one size class. The
+ * counters are monotonic, so a monitoring scraper can derive
+ * alloc/free rates from two consecutive samples.
+ */
+struct memtx_churn_class {
+	/** Number of allocations landed in the class. */
+	uint64_t allocs;
+	/** Number of frees landed in the class. */
+	uint64_t frees;
+	/** Total bytes requested by the allocations. */
+	uint64_t alloc_bytes;
+	/** Total bytes returned by the frees. */
+	uint64_t free_bytes;
+};
+
 enum memtx_reserve_extents_num {
 	/**
 	 * This number is calculated based on the
@@ -96,7 +121,25 @@ enum memtx_reserve_extents_num {
 	 * number of new block allocations.
 	 */
 	RESERVE_EXTENTS_BEFORE_DELETE = 8,
-	RESERVE_EXTENTS_BEFORE_REPLACE = 16
+	RESERVE_EXTENTS_BEFORE_REPLACE = 16,
+	/**
+	 * Upper bound of the adaptive refill batch for the
+	 * reserved extent list, see memtx_index_extent_reserve().
+	 * 128 extents is 2 MB of index memory at most kept as
+	 * slack during the heaviest write bursts.
+	 */
+	RESERVE_EXTENTS_BATCH_MAX = 128,
+	/**
+	 * If the reserve runs dry again after fewer than this
+	 * many statements, the refill batch is doubled.
+	 */
+	RESERVE_EXTENTS_CALLS_GROW = 32,
+	/**
+	 * If the reserve lasted for more than this many
+	 * statements, the refill batch is halved back so that
+	 * a quiet workload does not hoard extents.
+	 */
+	RESERVE_EXTENTS_CALLS_DECAY = 1024
 };
 
 /**
@@ -105,7 +148,7 @@ enum memtx_reserve_extents_num {
  * allocated for each iterator (except rtree index iterator that
  * is significantly bigger so has own pool).
  */
-#define MEMTX_ITERATOR_SIZE (152)
+#define MEMTX_ITERATOR_SIZE (168)
 
 struct memtx_engine {
 	struct engine base;
@@ -117,8 +160,30 @@ struct memtx_engine {
 	struct xdir snap_dir;
 	/** Limit disk usage of checkpointing (bytes per second). */
 	uint64_t snap_io_rate_limit;
+	/**
+	 * WAL fdatasync() latency, in seconds, above which
+	 * snapshot writing backs off to let the WAL device
+	 * drain. 0 disables the backoff.
+	 */
+	double snap_io_backoff_latency;
+	/**
+	 * Number of snapshot writer threads,
+	 * box.cfg.checkpoint_threads. When > 1, the spaces are
+	 * distributed between worker threads which encode and
+	 * compress xlog tx blocks in parallel, while the
+	 * checkpoint thread only appends the finished blocks to
+	 * the snapshot file.
+	 */
+	int checkpoint_threads;
 	/** Skip invalid snapshot records if this flag is set. */
 	bool force_recovery;
+	/**
+	 * Set while secondary keys are being bulk-built during
+	 * recovery. The data is immutable then, which allows
+	 * index implementations to offload parts of the build
+	 * to worker threads.
+	 */
+	bool is_recovery_build;
 	/**
 	 * Cord being currently used to join replica. It is only
 	 * needed to be able to cancel it on shutdown.
@@ -150,6 +215,23 @@ struct memtx_engine {
 	 */
 	int num_reserved_extents;
 	void *reserved_extents;
+	/**
+	 * Refill batch for the reserved extent list. Adapts to
+	 * the recent allocation rate: doubled when refills come
+	 * close together, halved when the slack lasts long, so
+	 * a bulk load pays the slow mempool path (and possibly
+	 * a GC round) once per batch of statements rather than
+	 * once per statement.
+	 */
+	int reserve_extents_batch;
+	/** Statements served from the slack since last refill. */
+	int reserve_calls_since_refill;
+	/**
+	 * Tuple allocation churn by power-of-two size class,
+	 * exposed via box.slab.churn(). Updated on the tx
+	 * thread only, so plain counters suffice.
+	 */
+	struct memtx_churn_class churn[MEMTX_CHURN_CLASSES];
 	/** Maximal allowed tuple size, box.cfg.memtx_max_tuple_size. */
 	size_t max_tuple_size;
 	/** Incremented with each next snapshot. */
@@ -178,6 +260,19 @@ struct memtx_engine {
 	 * memtx_gc_task::link.
 	 */
 	struct stailq gc_queue;
+	/**
+	 * Background tuple arena compaction fiber. When enabled,
+	 * it re-inserts tuples of user spaces through the regular
+	 * replace machinery, migrating them out of sparsely used
+	 * slabs so that those can be reused for new allocations.
+	 */
+	struct fiber *compaction_fiber;
+	/** True if background compaction is enabled. */
+	bool compaction;
+	/** Number of tuples migrated by the compaction fiber. */
+	uint64_t compaction_tuples_moved;
+	/** Number of tuple bytes migrated by the compaction fiber. */
+	uint64_t compaction_bytes_moved;
 };
 
 struct memtx_gc_task;
@@ -213,7 +308,7 @@ struct memtx_engine *
 memtx_engine_new(const char *snap_dirname, bool force_recovery,
 		 uint64_t tuple_arena_max_size,
 		 uint32_t objsize_min, bool dontdump,
-		 float alloc_factor);
+		 bool use_hugepages, float alloc_factor);
 
 int
 memtx_engine_recover_snapshot(struct memtx_engine *memtx,
@@ -222,12 +317,23 @@ memtx_engine_recover_snapshot(struct memtx_engine *memtx,
 void
 memtx_engine_set_snap_io_rate_limit(struct memtx_engine *memtx, double limit);
 
+void
+memtx_engine_set_snap_io_backoff_latency(struct memtx_engine *memtx,
+					 double latency);
+
+void
+memtx_engine_set_checkpoint_threads(struct memtx_engine *memtx, int threads);
+
 int
 memtx_engine_set_memory(struct memtx_engine *memtx, size_t size);
 
 void
 memtx_engine_set_max_tuple_size(struct memtx_engine *memtx, size_t max_size);
 
+/** Enable or disable background tuple arena compaction. */
+void
+memtx_engine_set_compaction(struct memtx_engine *memtx, bool enable);
+
 /**
  * Enter tuple delayed free mode: tuple allocated before the call
  * won't be freed until memtx_leave_delayed_free_mode() is called.
@@ -277,7 +383,10 @@ memtx_index_extent_free(void *ctx, void *extent);
 
 /**
  * Reserve num extents in pool.
- * Ensure that next num extent_alloc will succeed w/o an error
+ * Ensure that next num extent_alloc will succeed w/o an error.
+ * On top of the guaranteed minimum, tops the reserve up to an
+ * adaptive batch size (best effort) to amortize the refill cost
+ * over many statements under a write burst.
  */
 int
 memtx_index_extent_reserve(struct memtx_engine *memtx, int num);
@@ -299,13 +408,13 @@ static inline struct memtx_engine *
 memtx_engine_new_xc(const char *snap_dirname, bool force_recovery,
 		    uint64_t tuple_arena_max_size,
 		    uint32_t objsize_min, bool dontdump,
-		    float alloc_factor)
+		    bool use_hugepages, float alloc_factor)
 {
 	struct memtx_engine *memtx;
 	memtx = memtx_engine_new(snap_dirname, force_recovery,
 				 tuple_arena_max_size,
 				 objsize_min, dontdump,
-				 alloc_factor);
+				 use_hugepages, alloc_factor);
 	if (memtx == NULL)
 		diag_raise();
 	return memtx;
@@ -317,7 +317,7 @@ memtx_hash_index_get(struct index *base, const char *key,
 
 	struct space *space = space_by_id(base->def->space_id);
 	*result = NULL;
-	uint32_t h = key_hash(key, base->def->key_def);
+	uint32_t h = key_hash_fast(key, base->def->key_def);
 	uint32_t k = light_index_find_key(&index->hash_table, h, key);
 	if (k != light_index_end) {
 		struct tuple *tuple = light_index_get(&index->hash_table, k);
@@ -339,7 +339,7 @@ memtx_hash_index_replace(struct index *base, struct tuple *old_tuple,
 	struct light_index_core *hash_table = &index->hash_table;
 
 	if (new_tuple) {
-		uint32_t h = tuple_hash(new_tuple, base->def->key_def);
+		uint32_t h = tuple_hash_fast(new_tuple, base->def->key_def);
 		struct tuple *dup_tuple = NULL;
 		uint32_t pos = light_index_replace(hash_table, h, new_tuple,
 						   &dup_tuple);
@@ -382,7 +382,7 @@ memtx_hash_index_replace(struct index *base, struct tuple *old_tuple,
 	}
 
 	if (old_tuple) {
-		uint32_t h = tuple_hash(old_tuple, base->def->key_def);
+		uint32_t h = tuple_hash_fast(old_tuple, base->def->key_def);
 		int res = light_index_delete_value(hash_table, h, old_tuple);
 		assert(res == 0); (void) res;
 	}
@@ -414,7 +414,7 @@ memtx_hash_index_create_iterator(struct index *base, enum iterator_type type,
 	case ITER_GT:
 		if (part_count != 0) {
 			light_index_iterator_key(&index->hash_table, &it->iterator,
-					key_hash(key, base->def->key_def), key);
+					key_hash_fast(key, base->def->key_def), key);
 			it->base.next = hash_iterator_gt;
 		} else {
 			light_index_iterator_begin(&index->hash_table, &it->iterator);
@@ -428,7 +428,7 @@ memtx_hash_index_create_iterator(struct index *base, enum iterator_type type,
 	case ITER_EQ:
 		assert(part_count > 0);
 		light_index_iterator_key(&index->hash_table, &it->iterator,
-				key_hash(key, base->def->key_def), key);
+				key_hash_fast(key, base->def->key_def), key);
 		it->base.next = hash_iterator_eq;
 		break;
 	default:
@@ -527,6 +527,23 @@ memtx_hash_index_create_snapshot_iterator(struct index *base)
 	return (struct snapshot_iterator *) it;
 }
 
+static int
+memtx_hash_index_reserve(struct index *base, uint32_t size_hint)
+{
+	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
+	/*
+	 * Grow the hash table to the expected size up front, so
+	 * that the build does not interleave insertions with
+	 * incremental chain splitting.
+	 */
+	if (light_index_reserve(&index->hash_table, size_hint) != 0) {
+		diag_set(OutOfMemory, (ssize_t)size_hint,
+			 "hash_table", "reserve");
+		return -1;
+	}
+	return 0;
+}
+
 static const struct index_vtab memtx_hash_index_vtab = {
 	/* .destroy = */ memtx_hash_index_destroy,
 	/* .commit_create = */ generic_index_commit_create,
@@ -552,7 +569,7 @@ static const struct index_vtab memtx_hash_index_vtab = {
 	/* .compact = */ generic_index_compact,
 	/* .reset_stat = */ generic_index_reset_stat,
 	/* .begin_build = */ generic_index_begin_build,
-	/* .reserve = */ generic_index_reserve,
+	/* .reserve = */ memtx_hash_index_reserve,
 	/* .build_next = */ generic_index_build_next,
 	/* .end_build = */ generic_index_end_build,
 };
@@ -50,6 +50,18 @@ struct memtx_rtree_index {
 	struct index base;
 	unsigned dimension;
 	struct rtree tree;
+	/**
+	 * Rectangles of the tuples collected for a bulk index
+	 * build, 2 * dimension coordinates per tuple, laid out
+	 * as in rtree_rect.
+	 */
+	coord_t *build_coords;
+	/** Tuples collected for a bulk index build. */
+	struct tuple **build_tuples;
+	/** Number of elements in the build arrays. */
+	uint32_t build_array_size;
+	/** Allocated size (in elements) of the build arrays. */
+	uint32_t build_array_alloc_size;
 };
 
 /* {{{ Utilities. *************************************************/
@@ -173,6 +185,8 @@ memtx_rtree_index_destroy(struct index *base)
 {
 	struct memtx_rtree_index *index = (struct memtx_rtree_index *)base;
 	rtree_destroy(&index->tree);
+	free(index->build_coords);
+	free(index->build_tuples);
 	free(index);
 }
 
@@ -277,13 +291,39 @@ memtx_rtree_index_reserve(struct index *base, uint32_t size_hint)
          * on rtree, because there is no error handling in the
          * rtree lib.
          */
-	(void)size_hint;
 	ERROR_INJECT(ERRINJ_INDEX_RESERVE, {
 		diag_set(OutOfMemory, MEMTX_EXTENT_SIZE, "mempool", "new slab");
 		return -1;
 	});
 	struct memtx_engine *memtx = (struct memtx_engine *)base->engine;
-	return memtx_index_extent_reserve(memtx, RESERVE_EXTENTS_BEFORE_REPLACE);
+	if (memtx_index_extent_reserve(memtx,
+				       RESERVE_EXTENTS_BEFORE_REPLACE) != 0)
+		return -1;
+	/*
+	 * During a bulk build the hint is the expected tuple
+	 * count, so the build arrays can be sized upfront.
+	 */
+	struct memtx_rtree_index *index = (struct memtx_rtree_index *)base;
+	if (size_hint <= index->build_array_alloc_size)
+		return 0;
+	coord_t *coords = realloc(index->build_coords, size_hint * 2 *
+				  index->dimension * sizeof(coord_t));
+	if (coords == NULL) {
+		diag_set(OutOfMemory, size_hint * 2 * index->dimension *
+			 sizeof(coord_t), "memtx_rtree_index", "reserve");
+		return -1;
+	}
+	index->build_coords = coords;
+	struct tuple **tuples = realloc(index->build_tuples,
+					size_hint * sizeof(tuples[0]));
+	if (tuples == NULL) {
+		diag_set(OutOfMemory, size_hint * sizeof(tuples[0]),
+			 "memtx_rtree_index", "reserve");
+		return -1;
+	}
+	index->build_tuples = tuples;
+	index->build_array_alloc_size = size_hint;
+	return 0;
 }
 
 static struct iterator *
@@ -359,6 +399,87 @@ memtx_rtree_index_create_iterator(struct index *base,  enum iterator_type type,
 	return (struct iterator *)it;
 }
 
+static void
+memtx_rtree_index_begin_build(struct index *base)
+{
+	struct memtx_rtree_index *index = (struct memtx_rtree_index *)base;
+	assert(rtree_number_of_records(&index->tree) == 0);
+	(void)index;
+}
+
+/** Initialize the next element of the index build arrays. */
+static int
+memtx_rtree_index_build_next(struct index *base, struct tuple *tuple)
+{
+	struct memtx_rtree_index *index = (struct memtx_rtree_index *)base;
+	struct rtree_rect rect;
+	if (extract_rectangle(&rect, tuple, base->def) != 0)
+		return -1;
+	assert(index->build_array_size <= index->build_array_alloc_size);
+	if (index->build_array_size == index->build_array_alloc_size) {
+		uint32_t alloc = index->build_array_alloc_size == 0 ?
+			MEMTX_EXTENT_SIZE / sizeof(index->build_tuples[0]) :
+			index->build_array_alloc_size +
+			DIV_ROUND_UP(index->build_array_alloc_size, 2);
+		coord_t *coords = realloc(index->build_coords, alloc * 2 *
+					  index->dimension * sizeof(coord_t));
+		if (coords == NULL) {
+			diag_set(OutOfMemory, alloc * 2 * index->dimension *
+				 sizeof(coord_t), "memtx_rtree_index",
+				 "build_next");
+			return -1;
+		}
+		index->build_coords = coords;
+		struct tuple **tuples = realloc(index->build_tuples,
+						alloc * sizeof(tuples[0]));
+		if (tuples == NULL) {
+			diag_set(OutOfMemory, alloc * sizeof(tuples[0]),
+				 "memtx_rtree_index", "build_next");
+			return -1;
+		}
+		index->build_tuples = tuples;
+		index->build_array_alloc_size = alloc;
+	}
+	uint32_t n = index->build_array_size++;
+	index->build_tuples[n] = tuple;
+	memcpy(&index->build_coords[n * 2 * index->dimension], rect.coords,
+	       2 * index->dimension * sizeof(coord_t));
+	return 0;
+}
+
+static void
+memtx_rtree_index_end_build(struct index *base)
+{
+	struct memtx_rtree_index *index = (struct memtx_rtree_index *)base;
+	struct memtx_engine *memtx = (struct memtx_engine *)base->engine;
+	if (rtree_bulk_load(&index->tree, index->build_coords,
+			    (record_t *)index->build_tuples,
+			    index->build_array_size) != 0) {
+		/*
+		 * Bulk load ran out of memory and left the tree
+		 * empty. Fall back to one-by-one insertion, which
+		 * allocates pages incrementally and so may still
+		 * proceed where the bulk load temporary arrays
+		 * did not fit.
+		 */
+		for (uint32_t i = 0; i < index->build_array_size; i++) {
+			(void)memtx_index_extent_reserve(memtx,
+					RESERVE_EXTENTS_BEFORE_REPLACE);
+			struct rtree_rect *rect = (struct rtree_rect *)
+				&index->build_coords[i * 2 *
+						     index->dimension];
+			rtree_insert(&index->tree, rect,
+				     index->build_tuples[i]);
+		}
+	}
+	free(index->build_coords);
+	index->build_coords = NULL;
+	free(index->build_tuples);
+	index->build_tuples = NULL;
+	index->build_array_size = 0;
+	index->build_array_alloc_size = 0;
+}
+
 static const struct index_vtab memtx_rtree_index_vtab = {
 	/* .destroy = */ memtx_rtree_index_destroy,
 	/* .commit_create = */ generic_index_commit_create,
@@ -383,10 +504,10 @@ static const struct index_vtab memtx_rtree_index_vtab = {
 	/* .stat = */ generic_index_stat,
 	/* .compact = */ generic_index_compact,
 	/* .reset_stat = */ generic_index_reset_stat,
-	/* .begin_build = */ generic_index_begin_build,
+	/* .begin_build = */ memtx_rtree_index_begin_build,
 	/* .reserve = */ memtx_rtree_index_reserve,
-	/* .build_next = */ generic_index_build_next,
-	/* .end_build = */ generic_index_end_build,
+	/* .build_next = */ memtx_rtree_index_build_next,
+	/* .end_build = */ memtx_rtree_index_end_build,
 };
 
 struct index *
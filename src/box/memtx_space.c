@@ -43,10 +43,14 @@
 #include "memtx_engine.h"
 #include "column_mask.h"
 #include "sequence.h"
+#include "clock.h"
 
 /*
- * Yield every 1K tuples while building a new index or checking
- * a space format. In debug mode yield more often for testing
+ * While building a new index or checking a space format, check
+ * the clock every few tuples and yield once the time budget is
+ * spent, so that the tx thread never gets monopolized for longer
+ * than the budget no matter how expensive a single tuple is. In
+ * debug mode yield every few tuples unconditionally for testing
  * purposes.
  *
  * Yields do not happen during recovery. At this point of time
@@ -54,10 +58,32 @@
  * to be proccessed while data is not fully recovered.
  */
 #ifdef NDEBUG
-enum { MEMTX_DDL_YIELD_LOOPS = 1000 };
+enum { MEMTX_DDL_YIELD_LOOPS = 64 };
 #else
 enum { MEMTX_DDL_YIELD_LOOPS = 10 };
 #endif
+/** Time budget between DDL yields, in ns. */
+enum { MEMTX_DDL_YIELD_BUDGET_NS = 1000000 };
+
+/**
+ * Check if it's time to yield: the budget since the last yield
+ * has been spent. In debug builds yield whenever asked to keep
+ * the DDL vs concurrent DML paths well exercised by tests.
+ */
+static inline bool
+memtx_ddl_need_yield(uint64_t *last_yield)
+{
+#ifdef NDEBUG
+	uint64_t now = clock_monotonic64();
+	if (now - *last_yield < MEMTX_DDL_YIELD_BUDGET_NS)
+		return false;
+	*last_yield = now;
+	return true;
+#else
+	(void)last_yield;
+	return true;
+#endif
+}
 
 static void
 memtx_space_destroy(struct space *space)
@@ -378,6 +404,110 @@ memtx_space_execute_delete(struct space *space, struct txn *txn,
 	return 0;
 }
 
+/** Undo record of an in-place update, see memtx_space_try_update_inplace(). */
+struct memtx_inplace_undo {
+	/** Rollback trigger restoring the old payload. */
+	struct trigger on_rollback;
+	/** The mutated tuple. */
+	struct tuple *tuple;
+	/** Size of the saved payload. */
+	uint32_t size;
+	/** Copy of the tuple payload before the update. */
+	char data[0];
+};
+
+static int
+memtx_space_update_inplace_rollback(struct trigger *trigger, void *event)
+{
+	(void)event;
+	struct memtx_inplace_undo *undo =
+		(struct memtx_inplace_undo *)trigger->data;
+	memcpy((char *)tuple_data(undo->tuple), undo->data, undo->size);
+	return 0;
+}
+
+/**
+ * Try to apply an update in place, without materializing a new
+ * tuple and updating the indexes. This is possible when the new
+ * payload keeps the size of every top-level field, so the cached
+ * field map stays valid, and the update provably does not touch
+ * any indexed field, so all index keys, hashes and the tuple
+ * pointers stored in the indexes stay valid too. The payload is
+ * then overwritten directly and a copy of the old payload is
+ * saved on the txn region to be restored on rollback.
+ *
+ * The path is disabled when MVCC is on (tuple versions must be
+ * distinct stories), while a snapshot is being written (its read
+ * view relies on tuple immutability), when anything besides the
+ * space references the tuple (Lua handles and iterators expect
+ * tuples to never change) and when the space has on_replace
+ * triggers (they expect distinct old and new tuples).
+ *
+ * @retval true if the update was applied in place.
+ */
+static bool
+memtx_space_try_update_inplace(struct space *space, struct txn *txn,
+			       struct tuple *old_tuple, const char *old_data,
+			       uint32_t bsize, const char *new_data,
+			       uint32_t new_size, uint64_t column_mask)
+{
+	struct memtx_space *memtx_space = (struct memtx_space *)space;
+	struct memtx_engine *memtx = (struct memtx_engine *)space->engine;
+	if (memtx_tx_manager_use_mvcc_engine)
+		return false;
+	if (memtx_space->replace != memtx_space_replace_all_keys)
+		return false;
+	if (memtx->delayed_free_mode > 0)
+		return false;
+	if (new_size != bsize)
+		return false;
+	if (old_tuple->is_bigref || old_tuple->refs != 1)
+		return false;
+	if (space->run_triggers && !rlist_empty(&space->on_replace))
+		return false;
+	for (uint32_t i = 0; i < space->index_count; i++) {
+		struct key_def *key_def = space->index[i]->def->key_def;
+		if (key_def->for_func_index ||
+		    !key_update_can_be_skipped(key_def->column_mask,
+					       column_mask))
+			return false;
+	}
+	/*
+	 * The total size may be preserved while the fields are
+	 * reshuffled - one shrank, another grew. The field map
+	 * offsets stay valid only if every field kept its size.
+	 */
+	const char *old_field = old_data;
+	const char *new_field = new_data;
+	uint32_t field_count = mp_decode_array(&old_field);
+	if (mp_decode_array(&new_field) != field_count)
+		return false;
+	for (uint32_t i = 0; i < field_count; i++) {
+		const char *old_end = old_field;
+		const char *new_end = new_field;
+		mp_next(&old_end);
+		mp_next(&new_end);
+		if (old_end - old_field != new_end - new_field)
+			return false;
+		old_field = old_end;
+		new_field = new_end;
+	}
+	size_t size = sizeof(struct memtx_inplace_undo) + bsize;
+	struct memtx_inplace_undo *undo =
+		region_aligned_alloc(&txn->region, size,
+				     alignof(struct memtx_inplace_undo));
+	if (undo == NULL)
+		return false;
+	undo->tuple = old_tuple;
+	undo->size = bsize;
+	memcpy(undo->data, old_data, bsize);
+	trigger_create(&undo->on_rollback,
+		       memtx_space_update_inplace_rollback, undo, NULL);
+	txn_stmt_on_rollback(txn_current_stmt(txn), &undo->on_rollback);
+	memcpy((char *)old_data, new_data, bsize);
+	return true;
+}
+
 static int
 memtx_space_execute_update(struct space *space, struct txn *txn,
 			   struct request *request, struct tuple **result)
@@ -403,15 +533,25 @@ memtx_space_execute_update(struct space *space, struct txn *txn,
 
 	/* Update the tuple; legacy, request ops are in request->tuple */
 	uint32_t new_size = 0, bsize;
+	uint64_t column_mask = COLUMN_MASK_FULL;
 	struct tuple_format *format = space->format;
 	const char *old_data = tuple_data_range(old_tuple, &bsize);
 	const char *new_data =
 		xrow_update_execute(request->tuple, request->tuple_end,
 				    old_data, old_data + bsize, format,
-				    &new_size, request->index_base, NULL);
+				    &new_size, request->index_base,
+				    &column_mask);
 	if (new_data == NULL)
 		return -1;
 
+	if (memtx_space_try_update_inplace(space, txn, old_tuple, old_data,
+					   bsize, new_data, new_size,
+					   column_mask)) {
+		stmt->engine_savepoint = stmt;
+		*result = old_tuple;
+		return 0;
+	}
+
 	stmt->new_tuple = memtx_tuple_new(format, new_data,
 					  new_data + new_size);
 	if (stmt->new_tuple == NULL)
@@ -922,6 +1062,8 @@ memtx_space_check_format(struct space *space, struct tuple_format *format)
 	int rc;
 	struct tuple *tuple;
 	size_t count = 0;
+	uint64_t last_yield = clock_monotonic64();
+	(void)last_yield;
 	while ((rc = iterator_next(it, &tuple)) == 0 && tuple != NULL) {
 		/*
 		 * Check that the tuple is OK according to the
@@ -935,7 +1077,8 @@ memtx_space_check_format(struct space *space, struct tuple_format *format)
 		tuple_ref(state.cursor);
 
 		if (++count % MEMTX_DDL_YIELD_LOOPS == 0 &&
-		    memtx->state == MEMTX_OK)
+		    memtx->state == MEMTX_OK &&
+		    memtx_ddl_need_yield(&last_yield))
 			fiber_sleep(0);
 
 		ERROR_INJECT_YIELD(ERRINJ_CHECK_FORMAT_DELAY);
@@ -1089,6 +1232,8 @@ memtx_space_build_index(struct space *src_space, struct index *new_index,
 	int rc;
 	struct tuple *tuple;
 	size_t count = 0;
+	uint64_t last_yield = clock_monotonic64();
+	(void)last_yield;
 	while ((rc = iterator_next(it, &tuple)) == 0 && tuple != NULL) {
 		/*
 		 * Check that the tuple is OK according to the
@@ -1121,7 +1266,8 @@ memtx_space_build_index(struct space *src_space, struct index *new_index,
 		state.cursor = tuple;
 		tuple_ref(state.cursor);
 		if (++count % MEMTX_DDL_YIELD_LOOPS == 0 &&
-		    memtx->state == MEMTX_OK)
+		    memtx->state == MEMTX_OK &&
+		    memtx_ddl_need_yield(&last_yield))
 			fiber_sleep(0);
 		/*
 		 * Sleep after at least one tuple is inserted to test
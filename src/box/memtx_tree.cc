@@ -36,9 +36,12 @@
 #include "memory.h"
 #include "fiber.h"
 #include "key_list.h"
+#include "assoc.h"
 #include "tuple.h"
 #include "txn.h"
 #include "memtx_tx.h"
+#include "coio_task.h"
+#include "mp_check_flat.h"
 #include <third_party/qsort_arg.h>
 #include <small/mempool.h>
 
@@ -132,12 +135,28 @@ memtx_tree_data_is_equal(const struct memtx_tree_data_common *a,
 #define BPS_TREE_NAMESPACE NS_USE_HINT
 #define bps_tree_elem_t struct memtx_tree_data<true>
 #define bps_tree_key_t struct memtx_tree_key_data<true> *
+/*
+ * Order block search probes by the inline hints so that most
+ * descent comparisons never dereference the tuple. Multikey and
+ * functional indexes use the hint as an offset rather than as a
+ * key prefix, so for them the hints do not follow the tree order
+ * and the block search falls back to the plain comparators.
+ */
+#define BPS_TREE_ELEM_HINT(elem) ((&elem)->hint)
+#define BPS_TREE_KEY_HINT(key) ((key)->hint)
+#define BPS_TREE_HINT_NONE HINT_NONE
+#define BPS_TREE_HINTS_ORDERED(arg) \
+	(!(arg)->is_multikey && !(arg)->for_func_index)
 
 #include "salad/bps_tree.h"
 
 #undef BPS_TREE_NAMESPACE
 #undef bps_tree_elem_t
 #undef bps_tree_key_t
+#undef BPS_TREE_ELEM_HINT
+#undef BPS_TREE_KEY_HINT
+#undef BPS_TREE_HINT_NONE
+#undef BPS_TREE_HINTS_ORDERED
 
 #undef BPS_TREE_NAME
 #undef BPS_TREE_BLOCK_SIZE
@@ -191,6 +210,16 @@ invalidate_tree_iterator(NS_USE_HINT::memtx_tree_iterator *itr)
 	*itr = NS_USE_HINT::memtx_tree_invalid_iterator();
 }
 
+enum {
+	/**
+	 * Number of slots in the point lookup cache of a primary
+	 * tree index, see memtx_tree_index::get_cache. Must be a
+	 * power of two. 8192 pointer slots cost 64 KB per index
+	 * and cover hot key sets in the tens of thousands.
+	 */
+	MEMTX_TREE_GET_CACHE_SIZE = 8192,
+};
+
 template <bool USE_HINT>
 struct memtx_tree_index {
 	struct index base;
@@ -199,6 +228,25 @@ struct memtx_tree_index {
 	size_t build_array_size, build_array_alloc_size;
 	struct memtx_gc_task gc_task;
 	memtx_tree_iterator_t<USE_HINT> gc_iterator;
+	/**
+	 * Direct-mapped cache of recent point lookups, indexed
+	 * by key_hash_fast() of the full key. A hit turns a tree
+	 * descent (several dependent cache misses) into a single
+	 * probe plus a key comparison against the cached tuple.
+	 * Only allocated for the primary index; NULL otherwise.
+	 * Entries are dropped on every physical insertion or
+	 * deletion of a tuple with the same hash slot, see
+	 * memtx_tree_get_cache_invalidate().
+	 */
+	struct tuple **get_cache;
+	/**
+	 * Functional index only, NULL otherwise: maps a tuple
+	 * pointer to the memoized list of key chunks currently
+	 * inserted into the tree on the tuple's behalf, so that
+	 * deleting the tuple does not call the index function
+	 * again. See struct func_key_memo.
+	 */
+	struct mh_i64ptr_t *func_keys;
 };
 
 /* {{{ Utilities. *************************************************/
@@ -210,6 +258,23 @@ memtx_tree_cmp_def(TREE *tree)
 	return tree->arg;
 }
 
+/**
+ * Drop the point lookup cache slot that may refer to the given
+ * tuple. Must be called for every tuple physically inserted into
+ * or deleted from a primary tree index, otherwise the cache
+ * could serve a dangling pointer.
+ */
+template <bool USE_HINT>
+static inline void
+memtx_tree_get_cache_invalidate(struct memtx_tree_index<USE_HINT> *index,
+				struct tuple *tuple)
+{
+	if (index->get_cache == NULL || tuple == NULL)
+		return;
+	uint32_t h = tuple_hash_fast(tuple, index->base.def->key_def);
+	index->get_cache[h & (MEMTX_TREE_GET_CACHE_SIZE - 1)] = NULL;
+}
+
 template <bool USE_HINT>
 static int
 memtx_tree_qcompare(const void* a, const void *b, void *c)
@@ -229,6 +294,13 @@ struct tree_iterator {
 	struct iterator base;
 	memtx_tree_iterator_t<USE_HINT> tree_iterator;
 	enum iterator_type type;
+	/**
+	 * True if tree_iterator already points to the first
+	 * element to return: the position was pre-resolved by
+	 * tree_iterator_position_restore(), so the first next()
+	 * call must not seek by key_data.
+	 */
+	bool positioned;
 	struct memtx_tree_key_data<USE_HINT> key_data;
 	struct memtx_tree_data<USE_HINT> current;
 	/** Memory pool the iterator was allocated from. */
@@ -273,6 +345,31 @@ tree_iterator_dummie(struct iterator *iterator, struct tuple **ret)
 	return 0;
 }
 
+/**
+ * Prefetch the tuple the iterator is going to return on the
+ * following step. A tree scan pays one dependent random memory
+ * access per returned tuple - the hop from the B+ tree element
+ * to the tuple itself. Issuing the load for the next tuple while
+ * the current one is still being processed overlaps that cache
+ * miss with useful work, so long range scans stop being bound by
+ * per-row memory latency. The iterator is copied by value and
+ * the tree is left untouched.
+ */
+template <bool USE_HINT>
+static inline void
+tree_iterator_prefetch(memtx_tree_t<USE_HINT> *tree,
+		       memtx_tree_iterator_t<USE_HINT> itr, bool reverse)
+{
+	if (reverse)
+		memtx_tree_iterator_prev(tree, &itr);
+	else
+		memtx_tree_iterator_next(tree, &itr);
+	struct memtx_tree_data<USE_HINT> *next =
+		memtx_tree_iterator_get_elem(tree, &itr);
+	if (next != NULL)
+		prefetch(next->tuple, 0);
+}
+
 template <bool USE_HINT>
 static int
 tree_iterator_next_base(struct iterator *iterator, struct tuple **ret)
@@ -300,6 +397,7 @@ tree_iterator_next_base(struct iterator *iterator, struct tuple **ret)
 		*ret = res->tuple;
 		tuple_ref(*ret);
 		it->current = *res;
+		tree_iterator_prefetch(&index->tree, it->tree_iterator, false);
 	}
 	return 0;
 }
@@ -330,6 +428,7 @@ tree_iterator_prev_base(struct iterator *iterator, struct tuple **ret)
 		*ret = res->tuple;
 		tuple_ref(*ret);
 		it->current = *res;
+		tree_iterator_prefetch(&index->tree, it->tree_iterator, true);
 	}
 	return 0;
 }
@@ -367,6 +466,7 @@ tree_iterator_next_equal_base(struct iterator *iterator, struct tuple **ret)
 		*ret = res->tuple;
 		tuple_ref(*ret);
 		it->current = *res;
+		tree_iterator_prefetch(&index->tree, it->tree_iterator, false);
 	}
 	return 0;
 }
@@ -403,6 +503,7 @@ tree_iterator_prev_equal_base(struct iterator *iterator, struct tuple **ret)
 		*ret = res->tuple;
 		tuple_ref(*ret);
 		it->current = *res;
+		tree_iterator_prefetch(&index->tree, it->tree_iterator, true);
 	}
 	return 0;
 }
@@ -492,7 +593,13 @@ tree_iterator_start(struct iterator *iterator, struct tuple **ret)
 	enum iterator_type type = it->type;
 	bool exact = false;
 	assert(it->current.tuple == NULL);
-	if (it->key_data.key == 0) {
+	if (it->positioned) {
+		/*
+		 * The tree iterator was already placed on the
+		 * first element to return by
+		 * tree_iterator_position_restore().
+		 */
+	} else if (it->key_data.key == 0) {
 		if (iterator_type_is_reverse(it->type))
 			it->tree_iterator = memtx_tree_iterator_last(tree);
 		else
@@ -532,6 +639,16 @@ tree_iterator_start(struct iterator *iterator, struct tuple **ret)
 		memtx_tree_iterator_get_elem(tree, &it->tree_iterator);
 	if (!res)
 		return 0;
+	/*
+	 * A restored position skips the equality shortcut of the
+	 * seek above, so re-check that the scan is still inside
+	 * the key range of an equality iterator.
+	 */
+	if (it->positioned && (type == ITER_EQ || type == ITER_REQ) &&
+	    tuple_compare_with_key(res->tuple, res->hint, it->key_data.key,
+				   it->key_data.part_count, it->key_data.hint,
+				   index->base.def->key_def) != 0)
+		return 0;
 	*ret = res->tuple;
 	tuple_ref(*ret);
 	it->current = *res;
@@ -555,6 +672,94 @@ tree_iterator_start(struct iterator *iterator, struct tuple **ret)
 	return 0;
 }
 
+/*
+ * A saved iterator position is the full cmp_def key of the last
+ * returned tuple, packed as an MP_ARRAY. The token is opaque for
+ * the user and remains meaningful across requests and restarts.
+ * Restoring always re-seeks by the key: the token may come from
+ * an arbitrary client, so no raw tree coordinates may be trusted
+ * from it, and the key alone identifies the position exactly -
+ * cmp_def includes the primary key parts, so it is unique even
+ * in a non-unique index.
+ */
+
+template <bool USE_HINT>
+static int
+tree_iterator_position(struct iterator *iterator, const char **pos,
+		       uint32_t *pos_size)
+{
+	struct memtx_tree_index<USE_HINT> *index =
+		(struct memtx_tree_index<USE_HINT> *)iterator->index;
+	struct tree_iterator<USE_HINT> *it = get_tree_iterator<USE_HINT>(iterator);
+	if (it->current.tuple == NULL) {
+		/* Nothing has been returned yet or EOF. */
+		*pos = NULL;
+		*pos_size = 0;
+		return 0;
+	}
+	struct key_def *cmp_def = memtx_tree_cmp_def(&index->tree);
+	uint32_t key_size;
+	char *key = tuple_extract_key(it->current.tuple, cmp_def,
+				      MULTIKEY_NONE, &key_size);
+	if (key == NULL)
+		return -1;
+	*pos = key;
+	*pos_size = key_size;
+	return 0;
+}
+
+template <bool USE_HINT>
+static int
+tree_iterator_position_restore(struct iterator *iterator, const char *pos,
+			       uint32_t pos_size)
+{
+	struct memtx_tree_index<USE_HINT> *index =
+		(struct memtx_tree_index<USE_HINT> *)iterator->index;
+	struct tree_iterator<USE_HINT> *it = get_tree_iterator<USE_HINT>(iterator);
+	memtx_tree_t<USE_HINT> *tree = &index->tree;
+	struct key_def *cmp_def = memtx_tree_cmp_def(tree);
+	assert(it->current.tuple == NULL);
+	/* The token may come from a client: validate the key. */
+	const char *key = pos;
+	const char *key_check = key;
+	if (mp_check_flat(&key_check, pos + pos_size) != 0 ||
+	    key_check != pos + pos_size || mp_typeof(*key) != MP_ARRAY) {
+		diag_set(ClientError, ER_ILLEGAL_PARAMS,
+			 "Invalid iterator position");
+		return -1;
+	}
+	uint32_t part_count = mp_decode_array(&key);
+	if (part_count != cmp_def->part_count) {
+		diag_set(ClientError, ER_ILLEGAL_PARAMS,
+			 "Invalid iterator position");
+		return -1;
+	}
+	const char *key_end;
+	if (key_validate_parts(cmp_def, key, part_count, true, &key_end) != 0)
+		return -1;
+	/*
+	 * Find the first element past the saved key. The key is
+	 * complete (cmp_def includes the primary key parts), so
+	 * the bound is exact even in a non-unique index, and a
+	 * deleted element is skipped naturally.
+	 */
+	struct memtx_tree_key_data<USE_HINT> after;
+	after.key = key;
+	after.part_count = part_count;
+	if (USE_HINT)
+		after.set_hint(key_hint(key, part_count, cmp_def));
+	if (iterator_type_is_reverse(it->type)) {
+		it->tree_iterator =
+			memtx_tree_lower_bound(tree, &after, NULL);
+		memtx_tree_iterator_prev(tree, &it->tree_iterator);
+	} else {
+		it->tree_iterator =
+			memtx_tree_upper_bound(tree, &after, NULL);
+	}
+	it->positioned = true;
+	return 0;
+}
+
 /* }}} */
 
 /* {{{ MemtxTree  **********************************************************/
@@ -565,6 +770,13 @@ memtx_tree_index_free(struct memtx_tree_index<USE_HINT> *index)
 {
 	memtx_tree_destroy(&index->tree);
 	free(index->build_array);
+	free(index->get_cache);
+	if (index->func_keys != NULL) {
+		mh_int_t k;
+		mh_foreach(index->func_keys, k)
+			free(mh_i64ptr_node(index->func_keys, k)->val);
+		mh_i64ptr_delete(index->func_keys);
+	}
 	free(index);
 }
 
@@ -661,6 +873,15 @@ memtx_tree_index_update_def(struct index *base)
 	 */
 	index->tree.arg = def->opts.is_unique && !def->key_def->is_nullable ?
 						def->key_def : def->cmp_def;
+	/*
+	 * The new definition may hash keys differently, which
+	 * would break invalidation-by-hash of the point lookup
+	 * cache, so start it from scratch.
+	 */
+	if (index->get_cache != NULL) {
+		memset(index->get_cache, 0, MEMTX_TREE_GET_CACHE_SIZE *
+		       sizeof(*index->get_cache));
+	}
 }
 
 static bool
@@ -720,6 +941,28 @@ memtx_tree_index_get(struct index *base, const char *key,
 	struct memtx_tree_index<USE_HINT> *index =
 		(struct memtx_tree_index<USE_HINT> *)base;
 	struct key_def *cmp_def = memtx_tree_cmp_def(&index->tree);
+	struct tuple **slot = NULL;
+	if (index->get_cache != NULL) {
+		/*
+		 * The primary index is unique and the key is full
+		 * (see the assertion above), so a key comparison
+		 * is enough to validate a cached tuple.
+		 */
+		uint32_t h = key_hash_fast(key, base->def->key_def);
+		slot = &index->get_cache[h &
+					 (MEMTX_TREE_GET_CACHE_SIZE - 1)];
+		struct tuple *cached = *slot;
+		if (cached != NULL &&
+		    tuple_compare_with_key(cached, HINT_NONE, key, part_count,
+					   HINT_NONE, cmp_def) == 0) {
+			struct txn *txn = in_txn();
+			struct space *space = space_by_id(base->def->space_id);
+			bool is_rw = txn != NULL;
+			*result = memtx_tx_tuple_clarify(txn, space, cached,
+							 0, 0, is_rw);
+			return 0;
+		}
+	}
 	struct memtx_tree_key_data<USE_HINT> key_data;
 	key_data.key = key;
 	key_data.part_count = part_count;
@@ -731,6 +974,8 @@ memtx_tree_index_get(struct index *base, const char *key,
 		*result = NULL;
 		return 0;
 	}
+	if (slot != NULL)
+		*slot = res->tuple;
 	struct txn *txn = in_txn();
 	struct space *space = space_by_id(base->def->space_id);
 	bool is_rw = txn != NULL;
@@ -779,6 +1024,7 @@ memtx_tree_index_replace(struct index *base, struct tuple *old_tuple,
 					 space_name(sp));
 			return -1;
 		}
+		memtx_tree_get_cache_invalidate(index, new_tuple);
 		if (dup_data.tuple != NULL) {
 			*result = dup_data.tuple;
 			return 0;
@@ -790,6 +1036,7 @@ memtx_tree_index_replace(struct index *base, struct tuple *old_tuple,
 		if (USE_HINT)
 			old_data.set_hint(tuple_hint(old_tuple, cmp_def));
 		memtx_tree_delete(&index->tree, old_data);
+		memtx_tree_get_cache_invalidate(index, old_tuple);
 	}
 	*result = old_tuple;
 	return 0;
@@ -990,6 +1237,63 @@ func_index_key_dummy_alloc(struct tuple *tuple, const char *key,
 	return key;
 }
 
+/**
+ * Memoized functional index keys of one tuple: the key chunks
+ * that are currently inserted into the tree on the tuple's
+ * behalf. Saved on a successful replace so that deleting the
+ * tuple later does not have to call the index function again.
+ */
+struct func_key_memo {
+	/** Number of keys in the array. */
+	uint32_t count;
+	/** Key chunks, the same pointers as the tree entry hints. */
+	const char *keys[];
+};
+
+/**
+ * Look up and unlink the key memo of a tuple. The caller owns
+ * the returned memo and must free() it.
+ */
+static struct func_key_memo *
+func_key_memo_take(struct memtx_tree_index<true> *index, struct tuple *tuple)
+{
+	struct mh_i64ptr_t *h = index->func_keys;
+	if (h == NULL)
+		return NULL;
+	mh_int_t k = mh_i64ptr_find(h, (uint64_t)(uintptr_t)tuple, NULL);
+	if (k == mh_end(h))
+		return NULL;
+	struct func_key_memo *memo =
+		(struct func_key_memo *)mh_i64ptr_node(h, k)->val;
+	mh_i64ptr_del(h, k, NULL);
+	return memo;
+}
+
+/**
+ * Remove one key chunk from the memo of a tuple. Called when a
+ * tree entry of the tuple is replaced and its chunk is about to
+ * be freed, so that the memo never lists a dangling chunk.
+ */
+static void
+func_key_memo_forget(struct memtx_tree_index<true> *index, struct tuple *tuple,
+		     const char *key)
+{
+	struct mh_i64ptr_t *h = index->func_keys;
+	if (h == NULL)
+		return;
+	mh_int_t k = mh_i64ptr_find(h, (uint64_t)(uintptr_t)tuple, NULL);
+	if (k == mh_end(h))
+		return;
+	struct func_key_memo *memo =
+		(struct func_key_memo *)mh_i64ptr_node(h, k)->val;
+	for (uint32_t i = 0; i < memo->count; i++) {
+		if (memo->keys[i] == key) {
+			memo->keys[i] = memo->keys[--memo->count];
+			break;
+		}
+	}
+}
+
 /**
  * An undo entry for multikey functional index replace operation.
  * Used to roll back a failed insert/replace and restore the
@@ -1017,6 +1321,38 @@ func_key_undo_new(struct region *region)
 	return undo;
 }
 
+/**
+ * Memoize the key chunks inserted on behalf of a tuple, given
+ * the undo list of a successful replace. Best effort: on OOM the
+ * memo is simply not saved and the delete path falls back to
+ * recomputing the keys.
+ */
+static void
+func_key_memo_save(struct memtx_tree_index<true> *index, struct tuple *tuple,
+		   struct rlist *keys)
+{
+	struct mh_i64ptr_t *h = index->func_keys;
+	if (h == NULL)
+		return;
+	uint32_t count = 0;
+	struct func_key_undo *undo;
+	rlist_foreach_entry(undo, keys, link)
+		count++;
+	struct func_key_memo *memo = (struct func_key_memo *)
+		malloc(sizeof(*memo) + count * sizeof(*memo->keys));
+	if (memo == NULL)
+		return;
+	memo->count = 0;
+	rlist_foreach_entry(undo, keys, link)
+		memo->keys[memo->count++] = (const char *)undo->key.hint;
+	struct mh_i64ptr_node_t node;
+	node.key = (uint64_t)(uintptr_t)tuple;
+	node.val = memo;
+	mh_int_t k = mh_i64ptr_put(h, &node, NULL, NULL);
+	if (k == mh_end(h))
+		free(memo);
+}
+
 /**
  * Rollback a sequence of memtx_tree_index_replace_multikey_one
  * insertions for functional index. Routine uses given list to
@@ -1143,16 +1479,41 @@ memtx_tree_func_index_replace(struct index *base, struct tuple *old_tuple,
 		 * replaced entries.
 		 */
 		rlist_foreach_entry(undo, &old_keys, link) {
+			func_key_memo_forget(index, undo->key.tuple,
+					     (const char *)undo->key.hint);
 			tuple_chunk_delete(undo->key.tuple,
 					   (const char *)undo->key.hint);
 		}
+		func_key_memo_save(index, new_tuple, &new_keys);
 	}
 	if (old_tuple != NULL) {
+		struct memtx_tree_data<true> data, deleted_data;
+		data.tuple = old_tuple;
+		struct func_key_memo *memo = func_key_memo_take(index,
+								old_tuple);
+		if (memo != NULL) {
+			/*
+			 * The live keys of the tuple are known -
+			 * no need to call the index function.
+			 */
+			for (uint32_t i = 0; i < memo->count; i++) {
+				data.hint = (hint_t)memo->keys[i];
+				deleted_data.tuple = NULL;
+				memtx_tree_delete_value(&index->tree, data,
+							&deleted_data);
+				if (deleted_data.tuple != NULL) {
+					tuple_chunk_delete(deleted_data.tuple,
+						(const char *)
+						deleted_data.hint);
+				}
+			}
+			free(memo);
+			rc = 0;
+			goto end;
+		}
 		if (key_list_iterator_create(&it, old_tuple, index_def, false,
 					     func_index_key_dummy_alloc) != 0)
 			goto end;
-		struct memtx_tree_data<true> data, deleted_data;
-		data.tuple = old_tuple;
 		const char *key;
 		while (key_list_iterator_next(&it, &key) == 0 && key != NULL) {
 			data.hint = (hint_t) key;
@@ -1213,7 +1574,19 @@ memtx_tree_index_create_iterator(struct index *base, enum iterator_type type,
 	it->pool = &memtx->iterator_pool;
 	it->base.next = tree_iterator_start<USE_HINT>;
 	it->base.free = tree_iterator_free<USE_HINT>;
+	/*
+	 * Multikey and functional indexes use the hint as an
+	 * entry index rather than as a comparison hint, so a
+	 * tuple alone does not identify its tree element and
+	 * positions are not supported for them.
+	 */
+	if (!cmp_def->is_multikey && !cmp_def->for_func_index) {
+		it->base.position = tree_iterator_position<USE_HINT>;
+		it->base.position_restore =
+			tree_iterator_position_restore<USE_HINT>;
+	}
 	it->type = type;
+	it->positioned = false;
 	it->key_data.key = key;
 	it->key_data.part_count = part_count;
 	if (USE_HINT)
@@ -1396,16 +1769,67 @@ memtx_tree_index_build_array_deduplicate(struct memtx_tree_index<USE_HINT> *inde
 	index->build_array_size = w_idx + 1;
 }
 
+enum {
+	/**
+	 * Minimal build array size for which the sort of a
+	 * recovery build is offloaded to a worker thread.
+	 */
+	MEMTX_TREE_OFFLOAD_SORT_MIN = 1 << 16,
+	/**
+	 * Target block fill factor of a bulk-built tree, in
+	 * percent.
+	 */
+	MEMTX_TREE_BUILD_FILL_PERCENT = 90,
+};
+
+/** qsort_arg() wrapper executed in a coio worker thread. */
+static ssize_t
+memtx_tree_index_sort_f(va_list ap)
+{
+	void *array = va_arg(ap, void *);
+	size_t size = va_arg(ap, size_t);
+	size_t elem_size = va_arg(ap, size_t);
+	int (*cmp)(const void *, const void *, void *) =
+		va_arg(ap, int (*)(const void *, const void *, void *));
+	void *cmp_arg = va_arg(ap, void *);
+	qsort_arg(array, size, elem_size, cmp, cmp_arg);
+	return 0;
+}
+
 template <bool USE_HINT>
 static void
 memtx_tree_index_end_build(struct index *base)
 {
 	struct memtx_tree_index<USE_HINT> *index =
 		(struct memtx_tree_index<USE_HINT> *)base;
+	struct memtx_engine *memtx = (struct memtx_engine *)base->engine;
 	struct key_def *cmp_def = memtx_tree_cmp_def(&index->tree);
-	qsort_arg(index->build_array, index->build_array_size,
-		  sizeof(index->build_array[0]),
-		  memtx_tree_qcompare<USE_HINT>, cmp_def);
+	/*
+	 * During recovery the tuples are immutable and several
+	 * index builds run at once, so the sort - the most
+	 * CPU-expensive part of the build - may be pushed to a
+	 * worker thread, letting the tx thread scan and build
+	 * other indexes meanwhile. Outside of recovery the
+	 * build array may be updated by concurrent DML, so the
+	 * sort has to stay in tx.
+	 */
+	if (memtx->is_recovery_build &&
+	    index->build_array_size >= MEMTX_TREE_OFFLOAD_SORT_MIN) {
+		bool cancellable = fiber_set_cancellable(false);
+		ssize_t rc = coio_call(memtx_tree_index_sort_f,
+				       index->build_array,
+				       index->build_array_size,
+				       sizeof(index->build_array[0]),
+				       memtx_tree_qcompare<USE_HINT>, cmp_def);
+		fiber_set_cancellable(cancellable);
+		/* The sort callback itself cannot fail. */
+		assert(rc == 0);
+		(void)rc;
+	} else {
+		qsort_arg(index->build_array, index->build_array_size,
+			  sizeof(index->build_array[0]),
+			  memtx_tree_qcompare<USE_HINT>, cmp_def);
+	}
 	if (cmp_def->is_multikey) {
 		/*
 		 * Multikey index may have equal(in terms of
@@ -1419,8 +1843,14 @@ memtx_tree_index_end_build(struct index *base)
 		memtx_tree_index_build_array_deduplicate<USE_HINT>(index,
 							 tuple_chunk_delete);
 	}
-	memtx_tree_build(&index->tree, index->build_array,
-			 index->build_array_size);
+	/*
+	 * Leave some free room in the tree blocks: a fully
+	 * packed tree would split a block on nearly every
+	 * insert arriving right after the build.
+	 */
+	memtx_tree_build_filled(&index->tree, index->build_array,
+				index->build_array_size,
+				MEMTX_TREE_BUILD_FILL_PERCENT);
 
 	free(index->build_array);
 	index->build_array = NULL;
@@ -1691,8 +2121,33 @@ memtx_tree_index_new_tpl(struct memtx_engine *memtx, struct index_def *def,
 			 "malloc", "struct memtx_tree_index");
 		return NULL;
 	}
+	if (def->iid == 0) {
+		index->get_cache = (struct tuple **)
+			calloc(MEMTX_TREE_GET_CACHE_SIZE,
+			       sizeof(*index->get_cache));
+		if (index->get_cache == NULL) {
+			diag_set(OutOfMemory, MEMTX_TREE_GET_CACHE_SIZE *
+				 sizeof(*index->get_cache), "malloc",
+				 "memtx_tree_index get_cache");
+			free(index);
+			return NULL;
+		}
+	}
+	if (def->key_def->for_func_index) {
+		index->func_keys = mh_i64ptr_new();
+		if (index->func_keys == NULL) {
+			diag_set(OutOfMemory, sizeof(*index->func_keys),
+				 "malloc", "memtx_tree_index func_keys");
+			free(index->get_cache);
+			free(index);
+			return NULL;
+		}
+	}
 	if (index_create(&index->base, (struct engine *)memtx,
 			 vtab, def) != 0) {
+		if (index->func_keys != NULL)
+			mh_i64ptr_delete(index->func_keys);
+		free(index->get_cache);
 		free(index);
 		return NULL;
 	}
@@ -35,6 +35,8 @@
 #include <stdint.h>
 
 #include "txn.h"
+#include "fiber.h"
+#include "fiber_cond.h"
 #include "schema_def.h"
 #include "small/mempool.h"
 
@@ -56,6 +58,12 @@ memtx_tx_story_key_hash(const struct tuple *a)
 #define mh_hash_key(a, arg) (memtx_tx_story_key_hash(a))
 #define mh_cmp(a, b, arg) ((*(a))->tuple != (*(b))->tuple)
 #define mh_cmp_key(a, b, arg) ((a) != (*(b))->tuple)
+/*
+ * The story hash is probed on every replace with MVCC on, so use
+ * the flat metadata byte array: a probe then compares a 7-bit hash
+ * tag instead of chasing the story pointer to fetch its tuple.
+ */
+#define mh_bytemap 1
 #define MH_SOURCE
 #include "salad/mhash.h"
 
@@ -75,6 +83,12 @@ struct tx_manager
 	struct rlist all_stories;
 	/** Iterator that sequentially traverses all memtx_story objects. */
 	struct rlist *traverse_all_stories;
+	/** Total number of existing memtx_story objects. */
+	size_t story_count;
+	/** Background story garbage collection fiber. */
+	struct fiber *gc_fiber;
+	/** Signalled when the first story appears. */
+	struct fiber_cond gc_cond;
 };
 
 enum {
@@ -84,14 +98,54 @@ enum {
 	 * a new story.
 	 */
 		TX_MANAGER_GC_STEPS_SIZE = 2,
+	/**
+	 * Number of story garbage collection steps done by the
+	 * background fiber per wakeup.
+	 */
+		TX_MANAGER_BG_GC_STEPS_SIZE = 128,
 };
 
+/**
+ * Period of the background story garbage collection, in seconds.
+ * The foreground collection is driven by story creation, so when
+ * the write load stops, the leftover stories would otherwise
+ * stay pinned in memory indefinitely.
+ */
+static const double TX_MANAGER_BG_GC_INTERVAL = 0.1;
+
 /** That's a definition, see declaration for description. */
 bool memtx_tx_manager_use_mvcc_engine = false;
 
 /** The one and only instance of tx_manager. */
 static struct tx_manager txm;
 
+/** See definition for details */
+static void
+memtx_tx_story_gc_step();
+
+/**
+ * Background story garbage collection fiber function. The
+ * foreground collection runs a couple of crawler steps per new
+ * story, so it makes progress only under write load; this fiber
+ * keeps reclaiming story memory after the load stops.
+ */
+static int
+memtx_tx_story_gc_f(va_list ap)
+{
+	(void)ap;
+	while (!fiber_is_cancelled()) {
+		if (txm.story_count == 0) {
+			fiber_cond_wait(&txm.gc_cond);
+			continue;
+		}
+		for (size_t i = 0; i < TX_MANAGER_BG_GC_STEPS_SIZE &&
+		     txm.story_count > 0; i++)
+			memtx_tx_story_gc_step();
+		fiber_sleep(TX_MANAGER_BG_GC_INTERVAL);
+	}
+	return 0;
+}
+
 void
 memtx_tx_manager_init()
 {
@@ -105,11 +159,21 @@ memtx_tx_manager_init()
 	txm.history = mh_history_new();
 	rlist_create(&txm.all_stories);
 	txm.traverse_all_stories = &txm.all_stories;
+	txm.story_count = 0;
+	fiber_cond_create(&txm.gc_cond);
+	txm.gc_fiber = fiber_new("memtx.tx.gc", memtx_tx_story_gc_f);
+	if (txm.gc_fiber == NULL)
+		panic("failed to create memtx tx gc fiber");
+	fiber_set_joinable(txm.gc_fiber, true);
+	fiber_start(txm.gc_fiber);
 }
 
 void
 memtx_tx_manager_free()
 {
+	fiber_cancel(txm.gc_fiber);
+	fiber_join(txm.gc_fiber);
+	fiber_cond_destroy(&txm.gc_cond);
 	for (size_t i = 0; i < BOX_INDEX_MAX; i++)
 		mempool_destroy(&txm.memtx_tx_story_pool[i]);
 }
@@ -180,10 +244,6 @@ memtx_tx_handle_conflict(struct txn *breaker, struct txn *victim)
 	}
 }
 
-/** See definition for details */
-static void
-memtx_tx_story_gc_step();
-
 /**
  * Create a new story and link it with the @a tuple.
  * @return story on success, NULL on error (diag is set).
@@ -231,6 +291,8 @@ memtx_tx_story_new(struct space *space, struct tuple *tuple)
 	rlist_add_tail(&txm.all_stories, &story->in_all_stories);
 	rlist_add(&space->memtx_stories, &story->in_space_stories);
 	memset(story->link, 0, sizeof(story->link[0]) * index_count);
+	if (txm.story_count++ == 0)
+		fiber_cond_signal(&txm.gc_cond);
 	return story;
 }
 
@@ -1099,6 +1161,8 @@ memtx_tx_story_delete(struct memtx_story *story)
 		txm.traverse_all_stories = rlist_next(txm.traverse_all_stories);
 	rlist_del(&story->in_all_stories);
 	rlist_del(&story->in_space_stories);
+	assert(txm.story_count > 0);
+	txm.story_count--;
 
 	mh_int_t pos = mh_history_find(txm.history, story->tuple, 0);
 	assert(pos != mh_end(txm.history));
@@ -1214,6 +1278,11 @@ struct memtx_tx_snapshot_cleaner_entry
 #define mh_hash_key(a, arg) (memtx_tx_snapshot_cleaner_hash(a))
 #define mh_cmp(a, b, arg) (((a)->from) != ((b)->from))
 #define mh_cmp_key(a, b, arg) ((a) != ((b)->from))
+/*
+ * Probed once per tuple written to a snapshot, see the story hash
+ * above for why the byte map pays off.
+ */
+#define mh_bytemap 1
 #define MH_SOURCE
 #include "salad/mhash.h"
 
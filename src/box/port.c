@@ -30,7 +30,6 @@
  */
 #include "port.h"
 #include "tuple.h"
-#include "tuple_convert.h"
 #include <small/obuf.h>
 #include <small/slab_cache.h>
 #include <small/mempool.h>
@@ -56,6 +55,8 @@ port_c_destroy_entry(struct port_c_entry *pe)
 	 */
 	if (pe->mp_size == 0)
 		tuple_unref(pe->tuple);
+	else if (pe->mp_on_buf)
+		; /* Freed in one go with the port's buffer. */
 	else if (pe->mp_size <= PORT_ENTRY_SIZE)
 		mempool_free(&port_entry_pool, pe->mp);
 	else
@@ -67,20 +68,24 @@ port_c_destroy(struct port *base)
 {
 	struct port_c *port = (struct port_c *)base;
 	struct port_c_entry *pe = port->first;
-	if (pe == NULL)
-		return;
-	port_c_destroy_entry(pe);
-	/*
-	 * Port->first is skipped, it is pointing at
-	 * port_c.first_entry, and is freed together with the
-	 * port.
-	 */
-	pe = pe->next;
-	while (pe != NULL) {
-		struct port_c_entry *cur = pe;
+	if (pe != NULL) {
+		port_c_destroy_entry(pe);
+		/*
+		 * Port->first is skipped, it is pointing at
+		 * port_c.first_entry, and is freed together with
+		 * the port.
+		 */
 		pe = pe->next;
-		port_c_destroy_entry(cur);
-		mempool_free(&port_entry_pool, cur);
+		while (pe != NULL) {
+			struct port_c_entry *cur = pe;
+			pe = pe->next;
+			port_c_destroy_entry(cur);
+			mempool_free(&port_entry_pool, cur);
+		}
+	}
+	if (port->buf != NULL) {
+		obuf_destroy(port->buf);
+		free(port->buf);
 	}
 }
 
@@ -115,6 +120,7 @@ port_c_add_tuple(struct port *base, struct tuple *tuple)
 		return -1;
 	/* 0 mp_size means the entry stores a tuple. */
 	pe->mp_size = 0;
+	pe->mp_on_buf = false;
 	pe->tuple = tuple;
 	tuple_ref(tuple);
 	return 0;
@@ -151,6 +157,7 @@ port_c_add_mp(struct port *base, const char *mp, const char *mp_end)
 		memcpy(dst, mp, size);
 		pe->mp = dst;
 		pe->mp_size = size;
+		pe->mp_on_buf = false;
 		return 0;
 	}
 	if (size <= PORT_ENTRY_SIZE)
@@ -160,27 +167,120 @@ port_c_add_mp(struct port *base, const char *mp, const char *mp_end)
 	return -1;
 }
 
-static int
-port_c_dump_msgpack_16(struct port *base, struct obuf *out)
+enum {
+	/**
+	 * First chunk size of the port's own obuf. The following
+	 * chunks grow exponentially, as usual for an obuf.
+	 */
+	PORT_C_BUF_CHUNK_SIZE = 4096,
+};
+
+char *
+port_c_reserve_mp(struct port *base, size_t size)
 {
 	struct port_c *port = (struct port_c *)base;
-	struct port_c_entry *pe;
-	for (pe = port->first; pe != NULL; pe = pe->next) {
-		uint32_t size = pe->mp_size;
-		if (size == 0) {
-			if (tuple_to_obuf(pe->tuple, out) != 0)
-				return -1;
-		} else if (obuf_dup(out, pe->mp, size) != size) {
-			diag_set(OutOfMemory, size, "obuf_dup", "data");
+	if (port->buf == NULL) {
+		struct obuf *buf = malloc(sizeof(*buf));
+		if (buf == NULL) {
+			diag_set(OutOfMemory, sizeof(*buf), "malloc", "buf");
+			return NULL;
+		}
+		obuf_create(buf, &cord()->slabc, PORT_C_BUF_CHUNK_SIZE);
+		port->buf = buf;
+	}
+	char *data = obuf_reserve(port->buf, size);
+	if (data == NULL) {
+		diag_set(OutOfMemory, size, "obuf_reserve", "data");
+		return NULL;
+	}
+	return data;
+}
+
+int
+port_c_commit_mp(struct port *base, size_t size)
+{
+	struct port_c *port = (struct port_c *)base;
+	assert(port->buf != NULL);
+	assert(size > 0);
+	struct port_c_entry *pe = port_c_new_entry(port);
+	if (pe == NULL)
+		return -1;
+	char *data = obuf_alloc(port->buf, size);
+	assert(data != NULL);
+	pe->mp = data;
+	pe->mp_size = size;
+	pe->mp_on_buf = true;
+	return 0;
+}
+
+enum {
+	/**
+	 * Upper size bound of a single contiguous reservation
+	 * made by the batched dump. Large enough to cover
+	 * hundreds of typical tuples with one obuf capacity
+	 * check, small enough not to distort obuf chunk sizing
+	 * on huge selects.
+	 */
+	PORT_C_DUMP_BATCH_SIZE = 64 * 1024,
+};
+
+int
+port_c_dump_msgpack_16_chunk(struct port_c_entry **pe, struct obuf *out,
+			     int count)
+{
+	int dumped = 0;
+	while (*pe != NULL && dumped < count) {
+		/*
+		 * Sum the sizes of the next entries first, then
+		 * reserve one contiguous area for all of them:
+		 * obuf_dup() pays a capacity check per value and
+		 * may split it across obuf chunks, while with a
+		 * reservation ahead every entry is one plain
+		 * memcpy().
+		 */
+		size_t total = 0;
+		int batch = 0;
+		struct port_c_entry *e = *pe;
+		while (e != NULL && dumped + batch < count &&
+		       total < PORT_C_DUMP_BATCH_SIZE) {
+			uint32_t size = e->mp_size;
+			if (size == 0)
+				tuple_data_range(e->tuple, &size);
+			total += size;
+			batch++;
+			e = e->next;
+		}
+		char *data = obuf_reserve(out, total);
+		if (data == NULL) {
+			diag_set(OutOfMemory, total, "obuf_reserve", "data");
 			return -1;
 		}
 		ERROR_INJECT(ERRINJ_PORT_DUMP, {
-			diag_set(OutOfMemory,
-				 size == 0 ? tuple_size(pe->tuple) : size,
-				 "obuf_dup", "data");
+			diag_set(OutOfMemory, total, "obuf_reserve", "data");
 			return -1;
 		});
+		for (e = *pe; batch > 0; batch--, e = e->next, dumped++) {
+			uint32_t size = e->mp_size;
+			const char *src = size == 0 ?
+				tuple_data_range(e->tuple, &size) : e->mp;
+			memcpy(data, src, size);
+			data += size;
+		}
+		*pe = e;
+		char *svp = obuf_alloc(out, total);
+		assert(svp != NULL && svp + total == data);
+		(void)svp;
 	}
+	return dumped;
+}
+
+static int
+port_c_dump_msgpack_16(struct port *base, struct obuf *out)
+{
+	struct port_c *port = (struct port_c *)base;
+	struct port_c_entry *pe = port->first;
+	if (port_c_dump_msgpack_16_chunk(&pe, out, port->size) < 0)
+		return -1;
 	return port->size;
 }
 
@@ -224,6 +324,7 @@ port_c_create(struct port *base)
 	port->first = NULL;
 	port->last = NULL;
 	port->size = 0;
+	port->buf = NULL;
 }
 
 void
@@ -114,11 +114,18 @@ struct port_c_entry {
 		/**
 		 * Valid if mp_size is > 0. MessagePack is
 		 * allocated either on heap or on the port entry
-		 * mempool, if it fits into a pool object.
+		 * mempool, if it fits into a pool object, or on
+		 * the port's own obuf when encoded in place via
+		 * the reserve/commit API.
 		 */
 		char *mp;
 	};
 	uint32_t mp_size;
+	/**
+	 * True if mp resides on the port's own obuf and is
+	 * freed together with it, not entry by entry.
+	 */
+	bool mp_on_buf;
 };
 
 /**
@@ -131,6 +138,11 @@ struct port_c {
 	struct port_c_entry *last;
 	struct port_c_entry first_entry;
 	int size;
+	/**
+	 * Output buffer for values encoded in place via the
+	 * reserve/commit API. NULL until the first reservation.
+	 */
+	struct obuf *buf;
 };
 
 static_assert(sizeof(struct port_c) <= sizeof(struct port),
@@ -148,6 +160,38 @@ port_c_add_tuple(struct port *port, struct tuple *tuple);
 int
 port_c_add_mp(struct port *port, const char *mp, const char *mp_end);
 
+/**
+ * Reserve @a size bytes of contiguous memory on the port's own
+ * buffer, so MessagePack can be encoded right in place instead
+ * of being encoded elsewhere and copied with port_c_add_mp().
+ * The reservation stays valid until the next reserve or commit.
+ * @retval not NULL Pointer to the reserved memory.
+ * @retval NULL Memory error.
+ */
+char *
+port_c_reserve_mp(struct port *port, size_t size);
+
+/**
+ * Append the first @a size bytes of the memory obtained with
+ * port_c_reserve_mp() to the port as a single MessagePack value,
+ * without copying it anywhere.
+ */
+int
+port_c_commit_mp(struct port *port, size_t size);
+
+/**
+ * Dump up to @a count entries of a C port to @a out in the same
+ * format as dump_msgpack_16 (a plain sequence of tuples without an
+ * array header), starting from the entry @a *pe. On success @a *pe
+ * is advanced to the entry to continue from, or to NULL when the
+ * port is exhausted.
+ * @retval >= 0 Number of entries dumped.
+ * @retval -1 Error.
+ */
+int
+port_c_dump_msgpack_16_chunk(struct port_c_entry **pe, struct obuf *out,
+			     int count);
+
 void
 port_init(void);
 
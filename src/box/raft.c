@@ -280,6 +280,78 @@ box_raft_broadcast(struct raft *raft, const struct raft_msg *msg)
 		relay_push_raft(replica->relay, &req);
 }
 
+/**
+ * Pre-vote check: see if this node is connected to at least a quorum of peers
+ * via the replication channels. When it is not, the votes couldn't be
+ * collected anyway, so there is no point in bumping the term. A relay in
+ * FOLLOW state is used as a reachability sign - it means the peer is
+ * connected and consumes this node's data.
+ */
+static bool
+box_raft_is_quorum_reachable(struct raft *raft)
+{
+	assert(raft == box_raft());
+	/* Self is always reachable. */
+	int count = 1;
+	replicaset_foreach(replica) {
+		if (replica->id == instance_id ||
+		    replica->id == REPLICA_ID_NIL || replica->anon)
+			continue;
+		if (relay_get_state(replica->relay) == RELAY_FOLLOW)
+			count++;
+	}
+	return count >= raft->election_quorum;
+}
+
+double
+box_raft_leader_lease_remaining(void)
+{
+	struct raft *raft = box_raft();
+	if (raft->state != RAFT_STATE_LEADER)
+		return 0;
+	/*
+	 * A follower does not grant its vote to anybody else while it
+	 * considers the current leader alive, i.e. during the death timeout
+	 * since the last row from the leader. Hence after receiving an ack
+	 * the leader knows the sender won't help to elect a rival for a
+	 * while. Half of the death timeout is used so as to absorb the
+	 * delays between the follower hearing the leader, sending the ack,
+	 * and the leader receiving it.
+	 */
+	double lease = raft->death_timeout / 2;
+	if (raft->election_quorum == 1)
+		return lease;
+	/*
+	 * The lease lasts as long as a quorum of the freshest acks stays
+	 * inside the lease window. Collect the ack times sorted newest
+	 * first, and look at the one closing the quorum.
+	 */
+	double acks[VCLOCK_MAX];
+	int count = 0;
+	replicaset_foreach(replica) {
+		if (replica->id == instance_id ||
+		    replica->id == REPLICA_ID_NIL || replica->anon)
+			continue;
+		if (relay_get_state(replica->relay) != RELAY_FOLLOW)
+			continue;
+		double t = relay_last_ack_time(replica->relay);
+		if (t == 0)
+			continue;
+		int i = count++;
+		while (i > 0 && acks[i - 1] < t) {
+			acks[i] = acks[i - 1];
+			i--;
+		}
+		acks[i] = t;
+	}
+	/* Self is always a part of the quorum. */
+	int needed = raft->election_quorum - 1;
+	if (count < needed)
+		return 0;
+	double remaining = acks[needed - 1] + lease - ev_monotonic_now(loop());
+	return remaining > 0 ? remaining : 0;
+}
+
 /** Wakeup Raft state writer fiber waiting for WAL write end. */
 static void
 box_raft_write_cb(struct journal_entry *entry)
@@ -341,6 +413,7 @@ box_raft_init(void)
 		.broadcast = box_raft_broadcast,
 		.write = box_raft_write,
 		.schedule_async = box_raft_schedule_async,
+		.is_quorum_reachable = box_raft_is_quorum_reachable,
 	};
 	raft_create(&box_raft_global, &box_raft_vtab);
 	trigger_create(&box_raft_on_update, box_raft_on_update_f, NULL, NULL);
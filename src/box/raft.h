@@ -80,6 +80,16 @@ box_raft_checkpoint_remote(struct raft_request *req);
 int
 box_raft_process(struct raft_request *req, uint32_t source);
 
+/**
+ * Time in seconds during which this instance is still guaranteed to stay the
+ * leader, based on the freshness of the collected quorum of replica acks.
+ * While it is > 0, no rival can be elected, so the leader can serve
+ * linearizable reads locally, without a quorum round trip. 0 when the
+ * instance is not a leader or the acks are too old.
+ */
+double
+box_raft_leader_lease_remaining(void);
+
 void
 box_raft_init(void);
 
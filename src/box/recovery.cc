@@ -30,7 +30,14 @@
  */
 #include "recovery.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef HAVE_SYS_INOTIFY_H
+#include <sys/inotify.h>
+#endif
+
 #include "small/rlist.h"
+#include "third_party/tarantool_eio.h"
 #include "scoped_guard.h"
 #include "trigger.h"
 #include "fiber.h"
@@ -159,6 +166,53 @@ recovery_close_log(struct recovery *r)
 	trigger_run_xc(&r->on_close_log, NULL);
 }
 
+/**
+ * Runs in an eio thread: pull the next xlog file into the page
+ * cache while rows of the current one are being applied, so that
+ * replay doesn't stall on disk reads at every file switch.
+ */
+static void
+recovery_prefetch_cb(eio_req *req)
+{
+	const char *path = (const char *)req->data;
+	req->result = 0;
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return;
+#ifdef HAVE_POSIX_FADVISE
+	posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+#endif
+	close(fd);
+}
+
+static int
+recovery_prefetch_done_cb(eio_req *req)
+{
+	free(req->data);
+	return 0;
+}
+
+/**
+ * Schedule a prefetch of the xlog file following @vclock in the
+ * directory index, if there is one.
+ */
+static void
+recovery_prefetch_next_log(struct recovery *r, const struct vclock *vclock)
+{
+	struct vclock *cur = vclockset_search(&r->wal_dir.index,
+					      (struct vclock *)vclock);
+	if (cur == NULL)
+		return;
+	struct vclock *next = vclockset_next(&r->wal_dir.index, cur);
+	if (next == NULL)
+		return;
+	char *path = strdup(xdir_format_filename(&r->wal_dir,
+						 vclock_sum(next), NONE));
+	if (path == NULL)
+		return; /* Not critical, just no prefetch. */
+	eio_custom(recovery_prefetch_cb, 0, recovery_prefetch_done_cb, path);
+}
+
 static void
 recovery_open_log(struct recovery *r, const struct vclock *vclock)
 {
@@ -170,6 +224,24 @@ recovery_open_log(struct recovery *r, const struct vclock *vclock)
 
 	xdir_open_cursor_xc(&r->wal_dir, vclock_sum(vclock), &r->cursor);
 
+#ifdef HAVE_POSIX_FADVISE
+	/* The cursor reads the file strictly sequentially. */
+	posix_fadvise(r->cursor.fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+	recovery_prefetch_next_log(r, vclock);
+	/*
+	 * Skip tx blocks fully covered by the recovery position
+	 * using the sidecar LSN index, if the file has one. Must
+	 * be done before decode ahead kicks off the first block.
+	 */
+	xlog_cursor_seek_vclock(&r->cursor, &r->vclock);
+	if (r->shared_block_cache) {
+		r->cursor.shared_cache = true;
+	} else {
+		/* Decode the next tx block while rows are being applied. */
+		xlog_cursor_decode_ahead(&r->cursor);
+	}
+
 	if (state == XLOG_CURSOR_NEW &&
 	    vclock_compare(vclock, &r->vclock) > 0) {
 		/*
@@ -374,6 +446,13 @@ recovery_finalize(struct recovery *r)
  * Any change to the WAL dir itself or a change in the XLOG
  * file triggers a wakeup. The WAL dir path is set in the
  * constructor. XLOG file path is set with set_log_path().
+ *
+ * On Linux the WAL dir is watched with inotify, which delivers
+ * an append or a file creation the moment it happens, without
+ * the stat() round-trip libev's ev_stat does per event and
+ * without its multi-second poll fallback. If inotify is not
+ * available, or the watch cannot be installed (e.g. the WAL
+ * dir is on NFS), a pair of ev_stat watchers is used instead.
  */
 class WalSubscription {
 public:
@@ -381,6 +460,10 @@ public:
 	unsigned events;
 	struct ev_stat dir_stat;
 	struct ev_stat file_stat;
+#ifdef HAVE_SYS_INOTIFY_H
+	int inotify_fd;
+	struct ev_io inotify_io;
+#endif
 	char dir_path[PATH_MAX];
 	char file_path[PATH_MAX];
 
@@ -401,10 +484,48 @@ public:
 			fiber_wakeup(f);
 	}
 
+#ifdef HAVE_SYS_INOTIFY_H
+	static void inotify_cb(struct ev_loop *, struct ev_io *io, int)
+	{
+		((WalSubscription *)io->data)->inotify_read();
+	}
+
+	void inotify_read()
+	{
+		char buf[4096]
+			__attribute__((aligned(__alignof__(
+						struct inotify_event))));
+		const char *file_name = strrchr(file_path, '/');
+		file_name = file_name != NULL ? file_name + 1 : file_path;
+		ssize_t len;
+		while ((len = read(inotify_fd, buf, sizeof(buf))) > 0) {
+			for (const char *p = buf; p < buf + len;) {
+				const struct inotify_event *e =
+					(const struct inotify_event *)p;
+				p += sizeof(*e) + e->len;
+				if ((e->mask & (IN_CREATE | IN_MOVED_TO |
+						IN_DELETE)) != 0) {
+					wakeup(WAL_EVENT_ROTATE);
+					continue;
+				}
+				/*
+				 * An append to a file other than the
+				 * one currently being followed will be
+				 * picked up by the next rotate scan.
+				 */
+				if (e->len > 0 && file_path[0] != '\0' &&
+				    strcmp(e->name, file_name) == 0)
+					wakeup(WAL_EVENT_WRITE);
+			}
+		}
+	}
+#endif
+
 	WalSubscription(const char *wal_dir)
 	{
 		f = fiber();
 		events = 0;
+		file_path[0] = '\0';
 		if ((size_t)snprintf(dir_path, sizeof(dir_path), "%s", wal_dir) >=
 				sizeof(dir_path)) {
 
@@ -416,18 +537,60 @@ public:
 		dir_stat.data = this;
 		file_stat.data = this;
 
+#ifdef HAVE_SYS_INOTIFY_H
+		inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (inotify_fd >= 0 &&
+		    inotify_add_watch(inotify_fd, dir_path,
+				      IN_CREATE | IN_MOVED_TO | IN_DELETE |
+				      IN_MODIFY | IN_CLOSE_WRITE) < 0) {
+			say_syserror("inotify_add_watch, path: %s", dir_path);
+			close(inotify_fd);
+			inotify_fd = -1;
+		}
+		if (inotify_fd >= 0) {
+			ev_io_init(&inotify_io, inotify_cb, inotify_fd,
+				   EV_READ);
+			inotify_io.data = this;
+			ev_io_start(loop(), &inotify_io);
+			return;
+		}
+#endif
 		ev_stat_set(&dir_stat, dir_path, 0.0);
 		ev_stat_start(loop(), &dir_stat);
 	}
 
 	~WalSubscription()
 	{
+#ifdef HAVE_SYS_INOTIFY_H
+		if (inotify_fd >= 0) {
+			ev_io_stop(loop(), &inotify_io);
+			close(inotify_fd);
+			return;
+		}
+#endif
 		ev_stat_stop(loop(), &file_stat);
 		ev_stat_stop(loop(), &dir_stat);
 	}
 
 	void set_log_path(const char *path)
 	{
+#ifdef HAVE_SYS_INOTIFY_H
+		if (inotify_fd >= 0) {
+			/*
+			 * The dir watch already covers appends to any
+			 * file in the WAL dir - just remember which
+			 * file write events should be attributed to.
+			 */
+			if (path == NULL) {
+				file_path[0] = '\0';
+			} else if ((size_t)snprintf(file_path,
+					sizeof(file_path), "%s", path) >=
+					sizeof(file_path)) {
+				panic("path too long: %s", path);
+			}
+			return;
+		}
+#endif
 		/*
 		 * Avoid toggling ev_stat if the path didn't change.
 		 * Note: .file_path valid iff file_stat is active.
@@ -56,6 +56,14 @@ struct recovery {
 	struct fiber *watcher;
 	/** List of triggers invoked when the current WAL is closed. */
 	struct rlist on_close_log;
+	/**
+	 * Read xlog files through the process-wide cache of
+	 * decoded tx blocks instead of private decode ahead.
+	 * Set by relays: replicas at similar vclocks read the
+	 * same blocks, so each one is decoded once for all of
+	 * them.
+	 */
+	bool shared_block_cache;
 };
 
 struct recovery *
@@ -37,6 +37,7 @@
 #include "errinj.h"
 #include "fiber.h"
 #include "say.h"
+#include <small/obuf.h>
 
 #include "coio.h"
 #include "coio_task.h"
@@ -45,6 +46,7 @@
 #include "iproto_constants.h"
 #include "recovery.h"
 #include "replication.h"
+#include "schema_def.h"
 #include "trigger.h"
 #include "vclock/vclock.h"
 #include "version.h"
@@ -84,6 +86,22 @@ struct relay_gc_msg {
 	struct vclock vclock;
 };
 
+/**
+ * Cbus message to deliver a Raft state update to a relay thread.
+ * The updates don't stack: the relay owns two preallocated
+ * rotating messages, and while one is en route, all the newer
+ * updates land into the other one. Hence a single relay wakeup
+ * delivers the latest state no matter how many updates were made
+ * meanwhile, and the broadcast makes zero heap allocations.
+ */
+struct relay_raft_msg {
+	struct cmsg base;
+	struct cmsg_hop route[2];
+	struct raft_request req;
+	struct vclock vclock;
+	struct relay *relay;
+};
+
 /** State of a replication relay. */
 struct relay {
 	/** The thread in which we relay data to the replica. */
@@ -117,12 +135,45 @@ struct relay {
 	 * is passed by the replica on subscribe.
 	 */
 	uint32_t id_filter;
+	/**
+	 * List of ids of the spaces the replica subscribed to,
+	 * NULL if the replica receives everything. Rows of other
+	 * non-system spaces are relayed as NOPs, which keeps the
+	 * replica vclock, acks and WAL garbage collection exact
+	 * while dropping the payload. Passed by the replica on
+	 * subscribe.
+	 */
+	uint32_t *space_filter;
+	uint32_t space_filter_count;
 	/**
 	 * Local vclock at the moment of subscribe, used to check
 	 * dataset on the other side and send missing data rows if any.
 	 */
 	struct vclock local_vclock_at_subscribe;
 
+	/**
+	 * Buffer accumulating encoded initial join rows so that
+	 * the read view is sent in large batched writes instead
+	 * of one writev() per tuple. Plain malloc-ed, because it
+	 * is filled from an engine join cord and freed in tx.
+	 */
+	char *join_buf;
+	size_t join_buf_size;
+	size_t join_buf_capacity;
+	/**
+	 * Output buffer accumulating rows encoded during a WAL
+	 * catch-up burst, so that they are sent in large batched
+	 * writes instead of one writev() per row. Created and
+	 * used only inside the relay cord.
+	 */
+	struct obuf send_buf;
+	/**
+	 * True while rows are recovered from WAL files - then
+	 * relay_send() appends to send_buf instead of writing to
+	 * the socket directly.
+	 */
+	bool is_send_buffered;
+
 	/** Relay endpoint */
 	struct cbus_endpoint endpoint;
 	/** A pipe from 'relay' thread to 'tx' */
@@ -146,12 +197,29 @@ struct relay {
 		alignas(CACHELINE_SIZE)
 		/** Known relay vclock. */
 		struct vclock vclock;
+		/** Time of the last ack received from the replica. */
+		double last_ack_time;
 		/**
 		 * True if the relay needs Raft updates. It can live fine
 		 * without sending Raft updates, if it is a relay to an
 		 * anonymous replica, for example.
 		 */
 		bool is_raft_enabled;
+		/** Pair of rotating Raft state messages. */
+		struct relay_raft_msg raft_msgs[2];
+		/**
+		 * Index of the Raft message accumulating the
+		 * latest state. It is the one sent on a next
+		 * push.
+		 */
+		int raft_ready_msg;
+		/** True if one of the messages is en route now. */
+		bool is_raft_push_sent;
+		/**
+		 * True if the ready message contains an update
+		 * not sent to the relay thread yet.
+		 */
+		bool is_raft_push_pending;
 	} tx;
 };
 
@@ -179,12 +247,22 @@ relay_last_row_time(const struct relay *relay)
 	return relay->last_row_time;
 }
 
+double
+relay_last_ack_time(const struct relay *relay)
+{
+	return relay->tx.last_ack_time;
+}
+
 static void
 relay_send(struct relay *relay, struct xrow_header *packet);
 static void
 relay_send_initial_join_row(struct xstream *stream, struct xrow_header *row);
 static void
 relay_send_row(struct xstream *stream, struct xrow_header *row);
+static void
+relay_push_raft_msg(struct relay *relay);
+static void
+relay_flush(struct relay *relay);
 
 struct relay *
 relay_new(struct replica *replica)
@@ -278,6 +356,8 @@ relay_delete(struct relay *relay)
 {
 	if (relay->state == RELAY_FOLLOW)
 		relay_stop(relay);
+	free(relay->space_filter);
+	free(relay->join_buf);
 	fiber_cond_destroy(&relay->reader_cond);
 	diag_destroy(&relay->diag);
 	TRASH(relay);
@@ -299,6 +379,25 @@ relay_set_cord_name(int fd)
 	cord_set_name(name);
 }
 
+enum {
+	/** Flush the batched initial join rows at this size. */
+	RELAY_JOIN_FLUSH_THRESHOLD = 256 * 1024,
+	/** Flush the rows batched during a WAL catch-up at this size. */
+	RELAY_SEND_FLUSH_THRESHOLD = 256 * 1024,
+};
+
+/** Send out the rows buffered by relay_send_initial_join_row(). */
+static void
+relay_flush_initial_join(struct relay *relay)
+{
+	if (relay->join_buf_size == 0)
+		return;
+	relay->last_row_time = ev_monotonic_now(loop());
+	coio_write(&relay->io, relay->join_buf, relay->join_buf_size);
+	relay->join_buf_size = 0;
+	fiber_gc();
+}
+
 void
 relay_initial_join(int fd, uint64_t sync, struct vclock *vclock)
 {
@@ -342,6 +441,7 @@ relay_initial_join(int fd, uint64_t sync, struct vclock *vclock)
 
 	/* Send read view to the replica. */
 	engine_join_xc(&ctx, &relay->stream);
+	relay_flush_initial_join(relay);
 }
 
 int
@@ -353,10 +453,20 @@ relay_final_join_f(va_list ap)
 	coio_enable();
 	relay_set_cord_name(relay->io.fd);
 
+	obuf_create(&relay->send_buf, &cord()->slabc,
+		    RELAY_SEND_FLUSH_THRESHOLD);
+	auto obuf_guard = make_scoped_guard([=] {
+		relay->is_send_buffered = false;
+		obuf_destroy(&relay->send_buf);
+	});
+
 	/* Send all WALs until stop_vclock */
 	assert(relay->stream.write != NULL);
+	relay->is_send_buffered = true;
 	recover_remaining_wals(relay->r, &relay->stream,
 			       &relay->stop_vclock, true);
+	relay_flush(relay);
+	relay->is_send_buffered = false;
 	assert(vclock_compare(&relay->r->vclock, &relay->stop_vclock) == 0);
 	return 0;
 }
@@ -376,6 +486,7 @@ relay_final_join(int fd, uint64_t sync, struct vclock *start_vclock,
 	});
 
 	relay->r = recovery_new(wal_dir(), false, start_vclock);
+	relay->r->shared_block_cache = true;
 	vclock_copy(&relay->stop_vclock, stop_vclock);
 
 	int rc = cord_costart(&relay->cord, "final_join",
@@ -412,6 +523,7 @@ tx_status_update(struct cmsg *msg)
 {
 	struct relay_status_msg *status = (struct relay_status_msg *)msg;
 	vclock_copy(&status->relay->tx.vclock, &status->vclock);
+	status->relay->tx.last_ack_time = ev_monotonic_now(loop());
 	struct replication_ack ack;
 	ack.source = status->relay->replica->id;
 	ack.vclock = &status->vclock;
@@ -528,14 +640,43 @@ relay_process_wal_event(struct wal_watcher *watcher, unsigned events)
 		return;
 	}
 	try {
+		/*
+		 * Buffer the rows of the burst and send them in
+		 * large writes. If an error interrupts the burst,
+		 * the buffered tail is simply dropped - nothing
+		 * of it has reached the socket, and the relay is
+		 * exiting anyway.
+		 */
+		relay->is_send_buffered = true;
+		auto guard = make_scoped_guard([=] {
+			relay->is_send_buffered = false;
+			obuf_reset(&relay->send_buf);
+		});
 		recover_remaining_wals(relay->r, &relay->stream, NULL,
 				       (events & WAL_EVENT_ROTATE) != 0);
+		relay_flush(relay);
 	} catch (Exception *e) {
 		relay_set_error(relay, e);
 		fiber_cancel(fiber());
 	}
 }
 
+/**
+ * Return true if @in buffers at least one complete xrow, i.e.
+ * one more row can be read without touching the socket.
+ */
+static bool
+relay_has_buffered_row(struct ibuf *in)
+{
+	if (ibuf_used(in) < 1 || mp_typeof(*in->rpos) != MP_UINT)
+		return false;
+	if (mp_check_uint(in->rpos, in->wpos) > 0)
+		return false;
+	const char *pos = in->rpos;
+	uint32_t len = mp_decode_uint(&pos);
+	return ibuf_used(in) - (pos - in->rpos) >= len;
+}
+
 /*
  * Relay reader fiber function.
  * Read xrow encoded vclocks sent by the replica.
@@ -555,6 +696,15 @@ relay_reader_f(va_list ap)
 			struct xrow_header xrow;
 			coio_read_xrow_timeout_xc(&io, &ibuf, &xrow,
 					replication_disconnect_timeout());
+			/*
+			 * Drain the acks accumulated while the relay
+			 * was busy sending rows. The vclocks in them
+			 * are cumulative, so it's enough to decode
+			 * the last one and wake the relay once per
+			 * batch instead of once per ack.
+			 */
+			while (relay_has_buffered_row(&ibuf))
+				coio_read_xrow_timeout_xc(&io, &ibuf, &xrow, 0);
 			/* vclock is followed while decoding, zeroing it. */
 			vclock_create(&relay->recv_vclock);
 			xrow_decode_vclock_xc(&xrow, &relay->recv_vclock);
@@ -607,7 +757,11 @@ tx_set_is_raft_enabled(struct cmsg *base)
 {
 	struct relay_is_raft_enabled_msg *msg =
 		(struct relay_is_raft_enabled_msg *)base;
-	msg->relay->tx.is_raft_enabled = msg->value;
+	struct relay *relay = msg->relay;
+	relay->tx.is_raft_enabled = msg->value;
+	/* Send an update, if it was not possible before. */
+	if (msg->value && relay->tx.is_raft_push_pending)
+		relay_push_raft_msg(relay);
 }
 
 /** Relay thread part of the Raft flag setting, second hop. */
@@ -666,6 +820,9 @@ relay_subscribe_f(va_list ap)
 	coio_enable();
 	relay_set_cord_name(relay->io.fd);
 
+	obuf_create(&relay->send_buf, &cord()->slabc,
+		    RELAY_SEND_FLUSH_THRESHOLD);
+
 	/* Create cpipe to tx for propagating vclock. */
 	cbus_endpoint_create(&relay->endpoint, tt_sprintf("relay_%p", relay),
 			     fiber_schedule_cb, fiber());
@@ -777,6 +934,9 @@ relay_subscribe_f(va_list ap)
 
 	relay_exit(relay);
 
+	relay->is_send_buffered = false;
+	obuf_destroy(&relay->send_buf);
+
 	/*
 	 * Log the error that caused the relay to break the loop.
 	 * Don't clear the error for status reporting.
@@ -793,7 +953,8 @@ relay_subscribe_f(va_list ap)
 void
 relay_subscribe(struct replica *replica, int fd, uint64_t sync,
 		struct vclock *replica_clock, uint32_t replica_version_id,
-		uint32_t replica_id_filter)
+		uint32_t replica_id_filter, const uint32_t *space_filter,
+		uint32_t space_filter_count)
 {
 	assert(replica->anon || replica->id != REPLICA_ID_NIL);
 	struct relay *relay = replica->relay;
@@ -818,10 +979,22 @@ relay_subscribe(struct replica *replica, int fd, uint64_t sync,
 
 	vclock_copy(&relay->local_vclock_at_subscribe, &replicaset.vclock);
 	relay->r = recovery_new(wal_dir(), false, replica_clock);
+	relay->r->shared_block_cache = true;
 	vclock_copy(&relay->tx.vclock, replica_clock);
 	relay->version_id = replica_version_id;
 
 	relay->id_filter = replica_id_filter;
+	free(relay->space_filter);
+	relay->space_filter = NULL;
+	relay->space_filter_count = 0;
+	if (space_filter_count != 0) {
+		size_t size = space_filter_count * sizeof(*space_filter);
+		relay->space_filter = (uint32_t *)malloc(size);
+		if (relay->space_filter == NULL)
+			tnt_raise(OutOfMemory, size, "malloc", "space filter");
+		memcpy(relay->space_filter, space_filter, size);
+		relay->space_filter_count = space_filter_count;
+	}
 
 	int rc = cord_costart(&relay->cord, "subscribe",
 			      relay_subscribe_f, relay);
@@ -831,6 +1004,17 @@ relay_subscribe(struct replica *replica, int fd, uint64_t sync,
 		diag_raise();
 }
 
+/** Send out the rows accumulated in relay->send_buf. */
+static void
+relay_flush(struct relay *relay)
+{
+	if (obuf_size(&relay->send_buf) == 0)
+		return;
+	coio_writev(&relay->io, relay->send_buf.iov,
+		    obuf_iovcnt(&relay->send_buf), obuf_size(&relay->send_buf));
+	obuf_reset(&relay->send_buf);
+}
+
 static void
 relay_send(struct relay *relay, struct xrow_header *packet)
 {
@@ -838,7 +1022,17 @@ relay_send(struct relay *relay, struct xrow_header *packet)
 
 	packet->sync = relay->sync;
 	relay->last_row_time = ev_monotonic_now(loop());
-	coio_write_xrow(&relay->io, packet);
+	if (relay->is_send_buffered) {
+		struct iovec iov[XROW_IOVMAX];
+		int iovcnt = xrow_to_iovec_xc(packet, iov);
+		for (int i = 0; i < iovcnt; i++)
+			obuf_dup_xc(&relay->send_buf, iov[i].iov_base,
+				    iov[i].iov_len);
+		if (obuf_size(&relay->send_buf) >= RELAY_SEND_FLUSH_THRESHOLD)
+			relay_flush(relay);
+	} else {
+		coio_write_xrow(&relay->io, packet);
+	}
 	fiber_gc();
 
 	struct errinj *inj = errinj(ERRINJ_RELAY_TIMEOUT, ERRINJ_DOUBLE);
@@ -850,12 +1044,42 @@ static void
 relay_send_initial_join_row(struct xstream *stream, struct xrow_header *row)
 {
 	struct relay *relay = container_of(stream, struct relay, stream);
+	ERROR_INJECT_YIELD(ERRINJ_RELAY_SEND_DELAY);
 	/*
 	 * Ignore replica local requests as we don't need to promote
 	 * vclock while sending a snapshot.
 	 */
-	if (row->group_id != GROUP_LOCAL)
-		relay_send(relay, row);
+	if (row->group_id == GROUP_LOCAL)
+		return;
+	row->sync = relay->sync;
+	struct iovec iov[XROW_IOVMAX];
+	int iovcnt = xrow_to_iovec_xc(row, iov);
+	for (int i = 0; i < iovcnt; i++) {
+		size_t size = relay->join_buf_size + iov[i].iov_len;
+		if (size > relay->join_buf_capacity) {
+			size_t capacity = relay->join_buf_capacity;
+			if (capacity == 0)
+				capacity = RELAY_JOIN_FLUSH_THRESHOLD;
+			while (capacity < size)
+				capacity *= 2;
+			char *buf = (char *)realloc(relay->join_buf, capacity);
+			if (buf == NULL) {
+				tnt_raise(OutOfMemory, capacity, "malloc",
+					  "join buffer");
+			}
+			relay->join_buf = buf;
+			relay->join_buf_capacity = capacity;
+		}
+		memcpy(relay->join_buf + relay->join_buf_size,
+		       iov[i].iov_base, iov[i].iov_len);
+		relay->join_buf_size = size;
+	}
+	if (relay->join_buf_size >= RELAY_JOIN_FLUSH_THRESHOLD)
+		relay_flush_initial_join(relay);
+
+	struct errinj *inj = errinj(ERRINJ_RELAY_TIMEOUT, ERRINJ_DOUBLE);
+	if (inj != NULL && inj->dparam > 0)
+		fiber_sleep(inj->dparam);
 }
 
 /**
@@ -889,20 +1113,20 @@ relay_restart_recovery(struct relay *relay)
 	vclock_copy(&restart_vclock, &relay->recv_vclock);
 	vclock_reset(&restart_vclock, 0, vclock_get(&relay->r->vclock, 0));
 	struct recovery *r = recovery_new(wal_dir(), false, &restart_vclock);
+	r->shared_block_cache = true;
 	rlist_swap(&relay->r->on_close_log, &r->on_close_log);
 	recovery_delete(relay->r);
 	relay->r = r;
+	relay->is_send_buffered = true;
+	auto guard = make_scoped_guard([=] {
+		relay->is_send_buffered = false;
+		obuf_reset(&relay->send_buf);
+	});
 	recover_remaining_wals(relay->r, &relay->stream, NULL, true);
+	relay_flush(relay);
 }
 
-struct relay_raft_msg {
-	struct cmsg base;
-	struct cmsg_hop route;
-	struct raft_request req;
-	struct vclock vclock;
-	struct relay *relay;
-};
-
+/** Relay thread part of the Raft broadcast. */
 static void
 relay_raft_msg_push(struct cmsg *base)
 {
@@ -922,48 +1146,104 @@ relay_raft_msg_push(struct cmsg *base)
 		relay_set_error(msg->relay, e);
 		fiber_cancel(fiber());
 	}
-	free(msg);
 }
 
-void
-relay_push_raft(struct relay *relay, const struct raft_request *req)
+/**
+ * The message came back to the tx thread. Rotate the buffers, and
+ * send the second message, if something new appeared while the
+ * first one was en route.
+ */
+static void
+tx_raft_msg_return(struct cmsg *base)
 {
-	/*
-	 * Raft updates don't stack. They are thrown away if can't be pushed
-	 * now. This is fine, as long as relay's live much longer that the
-	 * timeouts in Raft are set.
-	 */
+	struct relay_raft_msg *msg = (struct relay_raft_msg *)base;
+	struct relay *relay = msg->relay;
+	relay->tx.is_raft_push_sent = false;
 	if (!relay->tx.is_raft_enabled)
+		relay->tx.is_raft_push_pending = false;
+	if (relay->tx.is_raft_push_pending)
+		relay_push_raft_msg(relay);
+}
+
+/** Send the Raft message accumulating the latest state. */
+static void
+relay_push_raft_msg(struct relay *relay)
+{
+	if (!relay->tx.is_raft_enabled || relay->tx.is_raft_push_sent)
 		return;
+	struct relay_raft_msg *msg =
+		&relay->tx.raft_msgs[relay->tx.raft_ready_msg];
+	cpipe_push(&relay->relay_pipe, &msg->base);
+	relay->tx.raft_ready_msg = (relay->tx.raft_ready_msg + 1) % 2;
+	relay->tx.is_raft_push_sent = true;
+	relay->tx.is_raft_push_pending = false;
+}
+
+void
+relay_push_raft(struct relay *relay, const struct raft_request *req)
+{
 	/*
-	 * XXX: the message should be preallocated. It should
-	 * work like Kharon in IProto. Relay should have 2 raft
-	 * messages rotating. When one is sent, the other can be
-	 * updated and a flag is set. When the first message is
-	 * sent, the control returns to TX thread, sees the set
-	 * flag, rotates the buffers, and sends it again. And so
-	 * on. This is how it can work in future, with 0 heap
-	 * allocations. Current solution with alloc-per-update is
-	 * good enough as a start. Another option - wait until all
-	 * is moved to WAL thread, where this will all happen
-	 * in one thread and will be much simpler.
+	 * Raft updates don't stack. The newer update is saved into the ready
+	 * message overwriting whatever was there, and is delivered whenever
+	 * the relay thread is free.
 	 */
 	struct relay_raft_msg *msg =
-		(struct relay_raft_msg *)malloc(sizeof(*msg));
-	if (msg == NULL) {
-		panic("Couldn't allocate raft message");
-		return;
-	}
+		&relay->tx.raft_msgs[relay->tx.raft_ready_msg];
 	msg->req = *req;
 	if (req->vclock != NULL) {
 		msg->req.vclock = &msg->vclock;
 		vclock_copy(&msg->vclock, req->vclock);
 	}
-	msg->route.f = relay_raft_msg_push;
-	msg->route.pipe = NULL;
-	cmsg_init(&msg->base, &msg->route);
+	msg->route[0].f = relay_raft_msg_push;
+	msg->route[0].pipe = &relay->tx_pipe;
+	msg->route[1].f = tx_raft_msg_return;
+	msg->route[1].pipe = NULL;
+	cmsg_init(&msg->base, msg->route);
 	msg->relay = relay;
-	cpipe_push(&relay->relay_pipe, &msg->base);
+	relay->tx.is_raft_push_pending = true;
+	relay_push_raft_msg(relay);
+}
+
+/** Extract the space id from a DML row body, 0 if there is none. */
+static uint32_t
+relay_row_space_id(const struct xrow_header *row)
+{
+	if (row->bodycnt == 0)
+		return 0;
+	const char *d = (const char *)row->body[0].iov_base;
+	if (mp_typeof(*d) != MP_MAP)
+		return 0;
+	uint32_t map_size = mp_decode_map(&d);
+	for (uint32_t i = 0; i < map_size; i++) {
+		if (mp_typeof(*d) != MP_UINT) {
+			mp_next(&d); /* key */
+			mp_next(&d); /* value */
+			continue;
+		}
+		uint64_t key = mp_decode_uint(&d);
+		if (key == IPROTO_SPACE_ID && mp_typeof(*d) == MP_UINT)
+			return mp_decode_uint(&d);
+		mp_next(&d); /* value */
+	}
+	return 0;
+}
+
+/**
+ * Return true if the row must be sent as is under the replica's
+ * space filter. System spaces are always relayed - the replica
+ * needs the schema to stay consistent.
+ */
+static bool
+relay_space_is_relayed(struct relay *relay, const struct xrow_header *row)
+{
+	uint32_t space_id = relay_row_space_id(row);
+	if (space_id <= BOX_SYSTEM_ID_MAX)
+		return true;
+	for (uint32_t i = 0; i < relay->space_filter_count; i++) {
+		if (relay->space_filter[i] == space_id)
+			return true;
+	}
+	return false;
 }
 
 /** Send a single row to the client. */
@@ -992,6 +1272,19 @@ relay_send_row(struct xstream *stream, struct xrow_header *packet)
 	/* Check if the rows from the instance are filtered. */
 	if ((1 << packet->replica_id & relay->id_filter) != 0)
 		return;
+	/*
+	 * Replace rows of spaces the replica did not subscribe to
+	 * with NOPs. A NOP keeps the replica_id/lsn of the
+	 * original row, so the replica vclock, its acks and hence
+	 * WAL garbage collection stay exact - only the payload is
+	 * dropped.
+	 */
+	if (relay->space_filter_count != 0 &&
+	    iproto_type_is_dml(packet->type) && packet->type != IPROTO_NOP &&
+	    !relay_space_is_relayed(relay, packet)) {
+		packet->type = IPROTO_NOP;
+		packet->bodycnt = 0;
+	}
 	/*
 	 * We're feeding a WAL, thus responding to FINAL JOIN or SUBSCRIBE
 	 * request. If this is FINAL JOIN (i.e. relay->replica is NULL),
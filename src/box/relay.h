@@ -93,6 +93,13 @@ relay_vclock(const struct relay *relay);
 double
 relay_last_row_time(const struct relay *relay);
 
+/**
+ * Returns the time when the last ack was received from the
+ * replica, 0 if there were no acks yet.
+ */
+double
+relay_last_ack_time(const struct relay *relay);
+
 /**
  * Send a Raft update request to the relay channel. It is not
  * guaranteed that it will be delivered. The connection may break.
@@ -105,7 +112,15 @@ relay_push_raft(struct relay *relay, const struct raft_request *req);
 #endif /* defined(__cplusplus) */
 
 /**
- * Send initial JOIN rows to the replica
+ * Send initial JOIN rows to the replica.
+ *
+ * The rows are fed from a read view frozen in the engines
+ * (engine_prepare_join), not from a checkpoint file: joining
+ * neither requires a recent checkpoint nor triggers a new one,
+ * and the data goes straight from memory to the socket. The
+ * WAL rows the replica needs to catch up from the read view
+ * vclock are pinned by the gc consumer registered by the
+ * caller, see box_process_join().
  *
  * @param fd        client connection
  * @param sync      sync from incoming JOIN request
@@ -132,6 +147,7 @@ relay_final_join(int fd, uint64_t sync, struct vclock *start_vclock,
 void
 relay_subscribe(struct replica *replica, int fd, uint64_t sync,
 		struct vclock *replica_vclock, uint32_t replica_version_id,
-		uint32_t replica_id_filter);
+		uint32_t replica_id_filter, const uint32_t *space_filter,
+		uint32_t space_filter_count);
 
 #endif /* TARANTOOL_REPLICATION_RELAY_H_INCLUDED */
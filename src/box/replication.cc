@@ -48,6 +48,9 @@ struct tt_uuid INSTANCE_UUID;
 struct tt_uuid REPLICASET_UUID;
 
 double replication_timeout = 1.0; /* seconds */
+double replication_ack_period = 0.0; /* seconds */
+uint32_t *replication_space_filter = NULL;
+uint32_t replication_space_filter_count = 0;
 double replication_connect_timeout = 30.0; /* seconds */
 int replication_connect_quorum = REPLICATION_CONNECT_QUORUM_ALL;
 double replication_sync_lag = 10.0; /* seconds */
@@ -104,6 +104,22 @@ static const int REPLICATION_CONNECT_QUORUM_ALL = INT_MAX;
  */
 extern double replication_timeout;
 
+/**
+ * Minimal interval between vclock acks sent by an applier to its
+ * master. 0 means ack every applied transaction batch. Set by
+ * box.cfg.replication_ack_period.
+ */
+extern double replication_ack_period;
+
+/**
+ * List of ids of the spaces the instance wants replicated to it,
+ * NULL to receive everything. Sent to masters at subscribe; a
+ * master relays rows of other non-system spaces as NOPs. Set by
+ * box.cfg.replication_space_filter.
+ */
+extern uint32_t *replication_space_filter;
+extern uint32_t replication_space_filter_count;
+
 /**
  * Maximal time box.cfg() may wait for connections to all configured
  * replicas to be established. If box.cfg() fails to connect to all
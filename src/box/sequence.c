@@ -151,6 +151,7 @@ sequence_delete(struct sequence *seq)
 void
 sequence_reset(struct sequence *seq)
 {
+	seq->cache_count = 0;
 	uint32_t key = seq->def->id;
 	uint32_t hash = sequence_hash(key);
 	uint32_t pos = light_sequence_find_key(&sequence_data_index, hash, key);
@@ -161,6 +162,11 @@ sequence_reset(struct sequence *seq)
 int
 sequence_set(struct sequence *seq, int64_t value)
 {
+	/*
+	 * The value may be set backward, so the preallocated
+	 * range could overlap with future values - discard it.
+	 */
+	seq->cache_count = 0;
 	uint32_t key = seq->def->id;
 	uint32_t hash = sequence_hash(key);
 	struct sequence_data new_data, old_data;
@@ -260,6 +266,46 @@ overflow:
 	goto done;
 }
 
+int
+sequence_next_batch(struct sequence *seq, int64_t count, int64_t *result,
+		    int64_t *last, int64_t *issued)
+{
+	assert(count >= 1);
+	if (sequence_next(seq, result) != 0)
+		return -1;
+	struct sequence_def *def = seq->def;
+	/*
+	 * Cut the batch at the min/max boundary so that the
+	 * issued values form an arithmetic progression. Use
+	 * unsigned arithmetic: the full [min, max] span does
+	 * not necessarily fit in int64_t.
+	 */
+	uint64_t span, step;
+	if (def->step > 0) {
+		span = (uint64_t)def->max - (uint64_t)*result;
+		step = (uint64_t)def->step;
+	} else {
+		span = (uint64_t)*result - (uint64_t)def->min;
+		step = -(uint64_t)def->step;
+	}
+	uint64_t extra = span / step;
+	if (extra > (uint64_t)(count - 1))
+		extra = count - 1;
+	*last = *result;
+	*issued = 1;
+	if (extra > 0) {
+		if (def->step > 0)
+			*last = (int64_t)((uint64_t)*result + extra * step);
+		else
+			*last = (int64_t)((uint64_t)*result - extra * step);
+		assert(*last >= def->min && *last <= def->max);
+		if (sequence_set(seq, *last) != 0)
+			return -1;
+		*issued += (int64_t)extra;
+	}
+	return 0;
+}
+
 int
 access_check_sequence(struct sequence *seq)
 {
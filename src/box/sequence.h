@@ -64,7 +64,10 @@ struct sequence_def {
 	int64_t max;
 	/** Initial sequence value. */
 	int64_t start;
-	/** Number of values to preallocate. Not implemented yet. */
+	/**
+	 * Number of values to preallocate per sequence_next_batch()
+	 * call. Values <= 1 disable preallocation.
+	 */
 	int64_t cache;
 	/**
 	 * If this flag is set, the sequence will wrap
@@ -80,6 +83,18 @@ struct sequence_def {
 struct sequence {
 	/** Sequence definition. */
 	struct sequence_def *def;
+	/**
+	 * The next value to serve from the range preallocated
+	 * by sequence_next_batch(). Meaningless unless
+	 * cache_count > 0.
+	 */
+	int64_t cache_value;
+	/**
+	 * Number of values left in the preallocated range.
+	 * The range is discarded whenever the sequence value
+	 * is set explicitly, see sequence_set().
+	 */
+	int64_t cache_count;
 	/** Set if the sequence is automatically generated. */
 	bool is_generated;
 	/** Cached runtime access information. */
@@ -150,6 +165,24 @@ sequence_update(struct sequence *seq, int64_t value);
 int
 sequence_next(struct sequence *seq, int64_t *result);
 
+/**
+ * Advance a sequence by up to @count values at once.
+ *
+ * Equivalent to calling sequence_next() @count times, except
+ * that the batch is cut short at the min/max boundary so that
+ * the issued values always form a plain arithmetic progression:
+ * a cycle wrap or an overflow error is only ever taken by the
+ * call that issues the first value.
+ *
+ * On success, return 0 and assign the first issued value to
+ * @result, the last one to @last and the number of issued
+ * values to @issued (1 <= *issued <= @count). Otherwise return
+ * -1 and set diag, see sequence_next() for the error reasons.
+ */
+int
+sequence_next_batch(struct sequence *seq, int64_t count, int64_t *result,
+		    int64_t *last, int64_t *issued);
+
 /**
  * Check whether or not the current user can be granted
  * access to the sequence.
@@ -142,6 +142,7 @@ session_create(enum session_type type)
 	session->sql_flags = default_flags;
 	session->sql_default_engine = SQL_STORAGE_ENGINE_MEMTX;
 	session->sql_stmts = NULL;
+	session->has_lua_storage = false;
 
 	/* For on_connect triggers. */
 	credentials_create(&session->credentials, guest_user);
@@ -256,7 +257,8 @@ session_run_on_auth_triggers(const struct on_auth_trigger_ctx *result)
 void
 session_destroy(struct session *session)
 {
-	session_storage_cleanup(session->id);
+	if (session->has_lua_storage)
+		session_storage_cleanup(session->id);
 	struct mh_i64ptr_node_t node = { session->id, NULL };
 	mh_i64ptr_remove(session_registry, &node, NULL);
 	credentials_destroy(&session->credentials);
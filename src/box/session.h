@@ -114,6 +114,12 @@ struct session {
 	const struct session_vtab *vtab;
 	/** Session metadata. */
 	struct session_meta meta;
+	/**
+	 * True if a box.session.storage table was materialized
+	 * for this session. Lets session_destroy() skip the Lua
+	 * cleanup for sessions which never touched the storage.
+	 */
+	bool has_lua_storage;
 	/**
 	 * ID of statements prepared in current session.
 	 * This map is allocated on demand.
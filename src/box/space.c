@@ -48,6 +48,9 @@
 #include "ck_constraint.h"
 #include "assoc.h"
 #include "constraint_id.h"
+#include "rmean.h"
+#include "histogram.h"
+#include "clock.h"
 
 int
 access_check_space(struct space *space, user_access_t access)
@@ -255,6 +258,7 @@ void
 space_delete(struct space *space)
 {
 	memtx_tx_on_space_delete(space);
+	space_stats_disable(space);
 	assert(space->ck_constraint_trigger == NULL);
 	for (uint32_t j = 0; j <= space->index_id_max; j++) {
 		struct index *index = space->index_map[j];
@@ -300,6 +304,35 @@ space_index_key_def(struct space *space, uint32_t id)
 	return NULL;
 }
 
+bool
+space_tuple_is_expired(struct space *space, struct tuple *tuple, double now)
+{
+	assert(space_has_expire(space));
+	const char *field = tuple_field(tuple,
+					space->def->opts.expire_field - 1);
+	if (field == NULL)
+		return false;
+	double expire_at;
+	switch (mp_typeof(*field)) {
+	case MP_UINT:
+		expire_at = (double)mp_decode_uint(&field);
+		break;
+	case MP_INT:
+		expire_at = (double)mp_decode_int(&field);
+		break;
+	case MP_FLOAT:
+		expire_at = mp_decode_float(&field);
+		break;
+	case MP_DOUBLE:
+		expire_at = mp_decode_double(&field);
+		break;
+	default:
+		/* Not a timestamp - never expires. */
+		return false;
+	}
+	return expire_at != 0 && expire_at <= now;
+}
+
 void
 generic_space_swap_index(struct space *old_space, struct space *new_space,
 			 uint32_t old_index_id, uint32_t new_index_id)
@@ -534,9 +567,9 @@ out:
 	return rc;
 }
 
-int
-space_execute_dml(struct space *space, struct txn *txn,
-		  struct request *request, struct tuple **result)
+static int
+space_execute_dml_impl(struct space *space, struct txn *txn,
+		       struct request *request, struct tuple **result)
 {
 	if (unlikely(space->sequence != NULL) &&
 	    (request->type == IPROTO_INSERT ||
@@ -600,6 +633,125 @@ space_execute_dml(struct space *space, struct txn *txn,
 	return 0;
 }
 
+/**
+ * Statistics collected per space when enabled, see
+ * space_stats_enable(). The names are what box.stat.space()
+ * reports.
+ */
+enum space_stat_name {
+	SPACE_STAT_INSERT,
+	SPACE_STAT_REPLACE,
+	SPACE_STAT_UPDATE,
+	SPACE_STAT_UPSERT,
+	SPACE_STAT_DELETE,
+	SPACE_STAT_BYTES,
+	SPACE_STAT_ERROR,
+	SPACE_STAT_MAX,
+};
+
+static const char *space_stat_strs[SPACE_STAT_MAX] = {
+	"INSERT",
+	"REPLACE",
+	"UPDATE",
+	"UPSERT",
+	"DELETE",
+	"BYTES",
+	"ERROR",
+};
+
+int
+space_stats_enable(struct space *space)
+{
+	if (space->stats_rmean != NULL)
+		return 0;
+	struct rmean *rmean = rmean_new(space_stat_strs, SPACE_STAT_MAX);
+	if (rmean == NULL) {
+		diag_set(OutOfMemory, sizeof(struct rmean), "rmean_new",
+			 "stats_rmean");
+		return -1;
+	}
+	/* Latency buckets, in microseconds: 1 us .. 10 s. */
+	static const int64_t latency_buckets[] = {
+		1, 10, 100, 1000, 10000, 100000, 1000000, 10000000,
+	};
+	struct histogram *latency = histogram_new(latency_buckets,
+						  lengthof(latency_buckets));
+	if (latency == NULL) {
+		rmean_delete(rmean);
+		diag_set(OutOfMemory, sizeof(struct histogram),
+			 "histogram_new", "stats_latency");
+		return -1;
+	}
+	space->stats_rmean = rmean;
+	space->stats_latency = latency;
+	return 0;
+}
+
+void
+space_stats_disable(struct space *space)
+{
+	if (space->stats_rmean == NULL)
+		return;
+	rmean_delete(space->stats_rmean);
+	space->stats_rmean = NULL;
+	histogram_delete(space->stats_latency);
+	space->stats_latency = NULL;
+}
+
+/** Account an executed DML request into the space statistics. */
+static void
+space_stats_account(struct space *space, const struct request *request,
+		    int rc, uint64_t duration)
+{
+	struct rmean *rmean = space->stats_rmean;
+	size_t stat = SPACE_STAT_MAX;
+	switch (request->type) {
+	case IPROTO_INSERT:
+		stat = SPACE_STAT_INSERT;
+		break;
+	case IPROTO_REPLACE:
+		stat = SPACE_STAT_REPLACE;
+		break;
+	case IPROTO_UPDATE:
+		stat = SPACE_STAT_UPDATE;
+		break;
+	case IPROTO_UPSERT:
+		stat = SPACE_STAT_UPSERT;
+		break;
+	case IPROTO_DELETE:
+		stat = SPACE_STAT_DELETE;
+		break;
+	default:
+		break;
+	}
+	if (stat != SPACE_STAT_MAX)
+		rmean_collect(rmean, stat, 1);
+	int64_t bytes = 0;
+	if (request->tuple != NULL)
+		bytes += request->tuple_end - request->tuple;
+	if (request->key != NULL)
+		bytes += request->key_end - request->key;
+	if (request->ops != NULL)
+		bytes += request->ops_end - request->ops;
+	if (bytes != 0)
+		rmean_collect(rmean, SPACE_STAT_BYTES, bytes);
+	if (rc != 0)
+		rmean_collect(rmean, SPACE_STAT_ERROR, 1);
+	histogram_collect(space->stats_latency, duration / 1000);
+}
+
+int
+space_execute_dml(struct space *space, struct txn *txn,
+		  struct request *request, struct tuple **result)
+{
+	if (likely(space->stats_rmean == NULL))
+		return space_execute_dml_impl(space, txn, request, result);
+	uint64_t start = clock_monotonic64();
+	int rc = space_execute_dml_impl(space, txn, request, result);
+	space_stats_account(space, request, rc, clock_monotonic64() - start);
+	return rc;
+}
+
 int
 space_add_ck_constraint(struct space *space, struct ck_constraint *ck)
 {
@@ -53,6 +53,8 @@ struct tuple;
 struct tuple_format;
 struct ck_constraint;
 struct constraint_id;
+struct rmean;
+struct histogram;
 
 struct space_vtab {
 	/** Free a space instance. */
@@ -243,6 +245,18 @@ struct space {
 	 * List of all tx stories in the space.
 	 */
 	struct rlist memtx_stories;
+	/**
+	 * Per-space operation statistics: request counts by type,
+	 * bytes and errors. NULL unless enabled with
+	 * space_stats_enable(), so spaces that nobody profiles
+	 * cost nothing on the DML path.
+	 */
+	struct rmean *stats_rmean;
+	/**
+	 * Request latency histogram, in microseconds. NULL unless
+	 * statistics are enabled.
+	 */
+	struct histogram *stats_latency;
 };
 
 /** Initialize a base space instance. */
@@ -276,6 +290,32 @@ space_group_id(struct space *space)
 	return space->def->opts.group_id;
 }
 
+/** Return true if the space has an expiration (TTL) field. */
+static inline bool
+space_has_expire(struct space *space)
+{
+	return space->def->opts.expire_field != 0;
+}
+
+/**
+ * Check if a tuple of a space with an expiration field has
+ * expired at the given point in time.
+ *
+ * The expiration field is decoded as a Unix timestamp in seconds
+ * (unsigned, integer, float or double). A missing field, a
+ * non-numeric value or 0 means the tuple never expires.
+ *
+ * @param space Space the tuple belongs to. Must have an
+ *              expiration field, see space_has_expire().
+ * @param tuple Tuple to check.
+ * @param now   Current time, fiber_time().
+ *
+ * @retval true  The tuple has expired.
+ * @retval false The tuple is still alive.
+ */
+bool
+space_tuple_is_expired(struct space *space, struct tuple *tuple, double now);
+
 void
 space_run_triggers(struct space *space, bool yesno);
 
@@ -394,6 +434,24 @@ int
 space_execute_dml(struct space *space, struct txn *txn,
 		  struct request *request, struct tuple **result);
 
+/**
+ * Start collecting operation statistics for the space: request
+ * counts by type, bytes, errors and a request latency histogram,
+ * see box.stat.space(). A no-op if already enabled.
+ *
+ * @retval  0 Success.
+ * @retval -1 Memory error.
+ */
+int
+space_stats_enable(struct space *space);
+
+/**
+ * Stop collecting operation statistics for the space and discard
+ * whatever has been collected. A no-op if not enabled.
+ */
+void
+space_stats_disable(struct space *space);
+
 static inline int
 space_ephemeral_replace(struct space *space, const char *tuple,
 			const char *tuple_end)
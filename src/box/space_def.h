@@ -73,6 +73,13 @@ struct space_opts {
 	 * until replicated to a quorum of replicas.
 	 */
 	bool is_sync;
+	/**
+	 * 1-based number of the tuple field holding the expiration
+	 * timestamp (Unix time, seconds). 0 means the space has no
+	 * TTL. Expired tuples are hidden from box-level reads and
+	 * reclaimed by the background purge fiber.
+	 */
+	uint32_t expire_field;
 	/** SQL statement that produced this space. */
 	char *sql;
 };
@@ -889,6 +889,7 @@ static int
 cursor_seek(BtCursor *pCur, int *pRes)
 {
 	/* Close existing iterator, if any */
+	sql_cursor_prefetch_reset(pCur);
 	if (pCur->iter) {
 		box_iterator_free(pCur->iter);
 		pCur->iter = NULL;
@@ -922,11 +923,61 @@ cursor_seek(BtCursor *pCur, int *pRes)
 	return cursor_advance(pCur, pRes);
 }
 
+/*
+ * Refill the cursor row buffer: pull the next batch of tuples
+ * from the engine iterator in one tight loop and reference each
+ * of them. Advancing the iterator back to back is considerably
+ * cheaper than paying the full VDBE -> cursor -> engine round
+ * trip per row.
+ *
+ * @param pCur Cursor with an empty prefetch buffer.
+ *
+ * @retval 0 on success, -1 otherwise.
+ */
+static int
+cursor_prefetch(BtCursor *pCur)
+{
+	assert(pCur->prefetch_pos == pCur->prefetch_count);
+	/*
+	 * Ramp the batch up from SQL_CURSOR_PREFETCH_MIN: short
+	 * scans (LIMIT-bound pagination) should not pull rows
+	 * past the cut just to throw them away.
+	 */
+	int batch = pCur->prefetch_batch == 0 ? SQL_CURSOR_PREFETCH_MIN :
+		    MIN(2 * pCur->prefetch_batch, SQL_CURSOR_PREFETCH_COUNT);
+	pCur->prefetch_batch = batch;
+	bool has_expire = space_has_expire(pCur->space);
+	double now = has_expire ? fiber_time() : 0;
+	int count = 0;
+	while (count < batch) {
+		struct tuple *tuple;
+		if (iterator_next(pCur->iter, &tuple) != 0) {
+			while (count > 0)
+				box_tuple_unref(pCur->prefetch[--count]);
+			return -1;
+		}
+		if (tuple == NULL)
+			break;
+		if (has_expire &&
+		    space_tuple_is_expired(pCur->space, tuple, now))
+			continue;
+		box_tuple_ref(tuple);
+		pCur->prefetch[count++] = tuple;
+	}
+	pCur->prefetch_count = count;
+	pCur->prefetch_pos = 0;
+	return 0;
+}
+
 /*
  * Move cursor to the next entry in space.
  * New tuple is refed and saved in cursor.
  * Tuple from previous call is unrefed.
  *
+ * Cursors with BTCF_Prefetch consume rows from the prefetch
+ * buffer and refill it in batches; the rest talk to the engine
+ * iterator row by row.
+ *
  * @param pCur Cursor which contains space and tuple.
  * @param[out] pRes Flag which is 0 if reached end of space, 1 otherwise.
  *
@@ -938,12 +989,26 @@ cursor_advance(BtCursor *pCur, int *pRes)
 	assert(pCur->iter != NULL);
 
 	struct tuple *tuple;
-	if (iterator_next(pCur->iter, &tuple) != 0)
-		return -1;
+	if ((pCur->curFlags & BTCF_Prefetch) != 0) {
+		if (pCur->prefetch_pos == pCur->prefetch_count &&
+		    cursor_prefetch(pCur) != 0)
+			return -1;
+		/* Prefetched tuples are referenced already. */
+		tuple = pCur->prefetch_pos < pCur->prefetch_count ?
+			pCur->prefetch[pCur->prefetch_pos++] : NULL;
+	} else {
+		do {
+			if (iterator_next(pCur->iter, &tuple) != 0)
+				return -1;
+		} while (tuple != NULL && space_has_expire(pCur->space) &&
+			 space_tuple_is_expired(pCur->space, tuple,
+						fiber_time()));
+		if (tuple)
+			box_tuple_ref(tuple);
+	}
 	if (pCur->last_tuple)
 		box_tuple_unref(pCur->last_tuple);
 	if (tuple) {
-		box_tuple_ref(tuple);
 		*pRes = 0;
 	} else {
 		pCur->eState = CURSOR_INVALID;
@@ -1599,7 +1599,24 @@ index_field_tuple_est(const struct index_def *idx_def, uint32_t field)
 			return 0;
 		return default_tuple_est[field + 1 >= 6 ? 6 : field];
 	}
-	return tnt_idx->def->opts.stat->tuple_log_est[field];
+	log_est_t est = tnt_idx->def->opts.stat->tuple_log_est[field];
+	/*
+	 * Statistics age: the space may have grown or shrunk
+	 * considerably since the last ANALYZE. Scale the stored
+	 * estimate by the change of the live tuple count, which
+	 * preserves the rows-per-key ratios measured by ANALYZE
+	 * while keeping the absolute numbers honest. Exact zero
+	 * estimates are left alone: log(1) == 0 marks a unique
+	 * (sub)key, and it stays unique at any size.
+	 */
+	log_est_t delta = sql_space_tuple_log_count(space) -
+			  tnt_idx->def->opts.stat->tuple_log_est[0];
+	if (est > 0 && delta != 0) {
+		est += delta;
+		if (est < 0)
+			est = 0;
+	}
+	return est;
 }
 
 /**
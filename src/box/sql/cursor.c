@@ -33,9 +33,20 @@
 #include "tarantoolInt.h"
 #include "box/tuple.h"
 
+void
+sql_cursor_prefetch_reset(struct BtCursor *cursor)
+{
+	while (cursor->prefetch_pos < cursor->prefetch_count)
+		tuple_unref(cursor->prefetch[cursor->prefetch_pos++]);
+	cursor->prefetch_count = 0;
+	cursor->prefetch_pos = 0;
+	cursor->prefetch_batch = 0;
+}
+
 void
 sql_cursor_cleanup(struct BtCursor *cursor)
 {
+	sql_cursor_prefetch_reset(cursor);
 	if (cursor->iter)
 		iterator_delete(cursor->iter);
 	if (cursor->last_tuple)
@@ -34,6 +34,26 @@
 
 typedef struct BtCursor BtCursor;
 
+enum {
+	/**
+	 * Size of the first batch pulled from the engine iterator
+	 * by a cursor running with BTCF_Prefetch. Each refill
+	 * doubles the batch up to SQL_CURSOR_PREFETCH_COUNT, so a
+	 * scan cut short by LIMIT - the most common shape of a
+	 * paginated query - fetches few rows past the cut, while
+	 * a long scan quickly reaches the full batch size.
+	 */
+	SQL_CURSOR_PREFETCH_MIN = 4,
+	/**
+	 * Maximal number of tuples pulled from the engine iterator
+	 * in one go when the cursor runs with BTCF_Prefetch.
+	 * Advancing the iterator in a tight loop amortizes the
+	 * per-row trip from the VDBE through the cursor into the
+	 * engine.
+	 */
+	SQL_CURSOR_PREFETCH_COUNT = 16,
+};
+
 /*
  * A cursor contains a particular entry either from Tarantrool or
  * Sorter. Tarantool cursor is able to point to ordinary table or
@@ -44,12 +64,24 @@ struct BtCursor {
 	u8 curFlags;		/* zero or more BTCF_* flags defined below */
 	u8 eState;		/* One of the CURSOR_XXX constants (see below) */
 	u8 hints;		/* As configured by CursorSetHints() */
+	/** Number of tuples stored in prefetch[]. */
+	u8 prefetch_count;
+	/** Index of the next tuple in prefetch[] to consume. */
+	u8 prefetch_pos;
+	/** Size of the last prefetch batch, doubled per refill. */
+	u8 prefetch_batch;
 	struct space *space;
 	struct index *index;
 	struct iterator *iter;
 	enum iterator_type iter_type;
 	struct tuple *last_tuple;
 	char *key;		/* Saved key that was cursor last known position */
+	/**
+	 * Row buffer of a batched scan: tuples fetched from the
+	 * iterator ahead of time, each referenced until consumed
+	 * or dropped by sql_cursor_prefetch_reset().
+	 */
+	struct tuple *prefetch[SQL_CURSOR_PREFETCH_COUNT];
 };
 
 void sqlCursorZero(BtCursor *);
@@ -76,6 +108,14 @@ sqlCursorPayload(BtCursor *, u32 offset, u32 amt, void *);
 void
 sql_cursor_cleanup(struct BtCursor *cursor);
 
+/**
+ * Unref tuples fetched ahead of time but not yet consumed and
+ * empty the prefetch buffer. Must be called whenever the cursor
+ * iterator is repositioned or freed.
+ */
+void
+sql_cursor_prefetch_reset(struct BtCursor *cursor);
+
 #ifndef NDEBUG
 int sqlCursorIsValid(BtCursor *);
 #endif
@@ -86,6 +126,7 @@ int sqlCursorIsValidNN(BtCursor *);
  */
 #define BTCF_TaCursor     0x80	/* Tarantool cursor, pTaCursor valid */
 #define BTCF_TEphemCursor 0x40	/* Tarantool cursor to ephemeral table  */
+#define BTCF_Prefetch     0x20	/* Scan may buffer rows ahead of time */
 
 /*
  * Potential values for BtCursor.eState.
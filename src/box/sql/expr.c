@@ -425,12 +425,21 @@ expr_cmp_mutual_type(struct Expr *pExpr)
  * Return the P5 value that should be used for a binary comparison
  * opcode (OP_Eq, OP_Ge etc.) used to compare pExpr1 and pExpr2.
  */
-static u8
+static u16
 binaryCompareP5(Expr * pExpr1, Expr * pExpr2, int jumpIfNull)
 {
 	enum field_type lhs = sql_expr_type(pExpr2);
 	enum field_type rhs = sql_expr_type(pExpr1);
-	u8 type_mask = sql_type_result(rhs, lhs) | (u8) jumpIfNull;
+	u16 type_mask = sql_type_result(rhs, lhs) | (u8) jumpIfNull;
+	/*
+	 * When both operands are statically known to be integers
+	 * (e.g. a comparison of two INTEGER columns), let the VDBE
+	 * take a monomorphic fast path which skips the dynamic
+	 * type tests of the generic comparison.
+	 */
+	if ((lhs == FIELD_TYPE_INTEGER || lhs == FIELD_TYPE_UNSIGNED) &&
+	    (rhs == FIELD_TYPE_INTEGER || rhs == FIELD_TYPE_UNSIGNED))
+		type_mask |= SQL_CMP_INT;
 	return type_mask;
 }
 
@@ -515,7 +524,7 @@ codeCompare(Parse * pParse,	/* The parsing (and code generating) context */
 	int p5 = binaryCompareP5(pLeft, pRight, jumpIfNull);
 	int addr = sqlVdbeAddOp4(pParse->pVdbe, opcode, in2, dest, in1,
 				     (void *)coll, P4_COLLSEQ);
-	sqlVdbeChangeP5(pParse->pVdbe, (u8) p5);
+	sqlVdbeChangeP5(pParse->pVdbe, p5);
 	return addr;
 }
 
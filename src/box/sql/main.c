@@ -59,7 +59,17 @@ char *sql_temp_directory = 0;
 char *sql_data_directory = 0;
 
 enum {
-	LOOKASIDE_SLOT_NUMBER = 125,
+	/*
+	 * There is a single global connection, so the lookaside
+	 * pool is sized for the parser of a complex statement
+	 * rather than for many concurrent handles: a SELECT with
+	 * a few joins and dozens of expressions keeps hundreds
+	 * of Expr, ExprList and token allocations alive at once,
+	 * and every allocation that does not find a free slot
+	 * falls back to malloc(). 1024 slots of 512 bytes are
+	 * 512 KB total.
+	 */
+	LOOKASIDE_SLOT_NUMBER = 1024,
 	LOOKASIDE_SLOT_SIZE = 512,
 };
 
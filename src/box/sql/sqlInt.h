@@ -1321,6 +1321,7 @@ enum trim_side_mask {
 #define SQL_STOREP2      0x20	/* Store result in reg[P2] rather than jump */
 #define SQL_KEEPNULL     0x40	/* Used by vector == or <> */
 #define SQL_NULLEQ       0x80	/* NULL=NULL */
+#define SQL_CMP_INT      0x100	/* Both operands are statically INTEGER */
 #define SQL_NOTNULL      0x90	/* Assert that operands are never NULL */
 
 /**
@@ -2257,6 +2257,36 @@ case OP_Ge: {             /* same as TK_GE, jump, in1, in3 */
 	flags3 = pIn3->flags;
 	enum field_type ft_p1 = pIn1->field_type;
 	enum field_type ft_p3 = pIn3->field_type;
+	/*
+	 * Fast path for comparisons which codegen marked as
+	 * statically integer (both operands are INTEGER or
+	 * UNSIGNED expressions): once the runtime values indeed
+	 * carry an integer representation, none of the NULL,
+	 * boolean/varbinary or string-affinity handling below can
+	 * apply, so compare immediately. NULLs in nullable columns
+	 * lack MEM_Int/MEM_UInt and fall through to the generic
+	 * code.
+	 */
+	if ((pOp->p5 & SQL_CMP_INT) != 0) {
+		if ((flags1 & flags3 & MEM_Int) != 0) {
+			if (pIn3->u.i > pIn1->u.i)
+				res = +1;
+			else if (pIn3->u.i < pIn1->u.i)
+				res = -1;
+			else
+				res = 0;
+			goto compare_op;
+		}
+		if ((flags1 & flags3 & MEM_UInt) != 0) {
+			if (pIn3->u.u > pIn1->u.u)
+				res = +1;
+			else if (pIn3->u.u < pIn1->u.u)
+				res = -1;
+			else
+				res = 0;
+			goto compare_op;
+		}
+	}
 	if ((flags1 | flags3)&MEM_Null) {
 		/* One or both operands are NULL */
 		if (pOp->p5 & SQL_NULLEQ) {
@@ -3229,6 +3259,19 @@ case OP_IteratorOpen:
 	struct BtCursor *bt_cur = cur->uc.pCursor;
 	bt_cur->curFlags |= space->def->id == 0 ? BTCF_TEphemCursor :
 				BTCF_TaCursor;
+	/*
+	 * Statements that cannot write (changeCntOn is set by
+	 * every DML and DDL code generator) may scan spaces in
+	 * batches: nothing in this VM invalidates a row between
+	 * the moment it is prefetched and the moment it is read.
+	 * Ephemeral spaces are excluded since a query may fill
+	 * them while iterating (e.g. a recursive CTE), system
+	 * spaces - since service routines update them without
+	 * going through the DML path.
+	 */
+	if (!p->changeCntOn && space->def->id != 0 &&
+	    !space_is_system(space))
+		bt_cur->curFlags |= BTCF_Prefetch;
 	bt_cur->space = space;
 	bt_cur->index = index;
 	bt_cur->eState = CURSOR_INVALID;
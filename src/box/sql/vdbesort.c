@@ -153,6 +153,9 @@
  */
 #include "sqlInt.h"
 #include "vdbeInt.h"
+#include "box/txn.h"
+#include "coio_task.h"
+#include "fiber.h"
 
 /*
  * Hard-coded maximum amount of data to accumulate in memory before flushing
@@ -1117,31 +1120,22 @@ vdbeSorterGetCompare(VdbeSorter * p)
 }
 
 /*
- * Sort the linked list of records headed at pTask->pList. Return
- * 0 if successful, or an sql error code (i.e. -1) if
- * an error occurs.
+ * The allocation-free core of vdbeSorterSort(): merge sort the
+ * linked list of records headed at pList->pList using aSlot[] as
+ * scratch space for partially merged lists. Split out so that it
+ * may run in a coio worker thread - everything it needs, i.e.
+ * aSlot[] and pTask->pUnpacked, is allocated by the caller in the
+ * tx thread beforehand, and the records themselves are standalone
+ * serialized keys with no ties to spaces or tuples.
  */
-static int
-vdbeSorterSort(SortSubtask * pTask, SorterList * pList)
+static void
+vdbeSorterSortList(SortSubtask * pTask, SorterList * pList,
+		   SorterRecord ** aSlot)
 {
 	int i;
-	SorterRecord **aSlot;
 	SorterRecord *p;
-	int rc;
-
-	rc = vdbeSortAllocUnpacked(pTask);
-	if (rc != 0)
-		return rc;
 
 	p = pList->pList;
-	pTask->xCompare = vdbeSorterGetCompare(pTask->pSorter);
-
-	aSlot =
-	    (SorterRecord **) sqlMallocZero(64 * sizeof(SorterRecord *));
-	if (!aSlot) {
-		return -1;
-	}
-
 	while (p) {
 		SorterRecord *pNext;
 		if (pList->aMemory) {
@@ -1174,6 +1168,69 @@ vdbeSorterSort(SortSubtask * pTask, SorterList * pList)
 		p = p ? vdbeSorterMerge(pTask, p, aSlot[i]) : aSlot[i];
 	}
 	pList->pList = p;
+}
+
+/** vdbeSorterSortList() wrapper executed in a coio worker thread. */
+static ssize_t
+vdbeSorterSortListCb(va_list ap)
+{
+	SortSubtask *pTask = va_arg(ap, SortSubtask *);
+	SorterList *pList = va_arg(ap, SorterList *);
+	SorterRecord **aSlot = va_arg(ap, SorterRecord **);
+	vdbeSorterSortList(pTask, pList, aSlot);
+	return 0;
+}
+
+enum {
+	/**
+	 * Minimal size of an in-memory run, in bytes, for which
+	 * its sort is offloaded to a coio worker thread. Smaller
+	 * runs are sorted faster than a round trip to a worker
+	 * takes.
+	 */
+	SQL_SORTER_OFFLOAD_MIN = 256 * 1024,
+};
+
+/*
+ * Sort the linked list of records headed at pTask->pList. Return
+ * 0 if successful, or an sql error code (i.e. -1) if
+ * an error occurs.
+ *
+ * A large run of an autocommit statement is sorted in a coio
+ * worker thread while the tx fiber yields, keeping the event loop
+ * responsive during big ORDER BY/GROUP BY spills. Inside a
+ * transaction the sort stays in tx: a yield would get the
+ * transaction aborted.
+ */
+static int
+vdbeSorterSort(SortSubtask * pTask, SorterList * pList)
+{
+	SorterRecord **aSlot;
+	int rc;
+
+	rc = vdbeSortAllocUnpacked(pTask);
+	if (rc != 0)
+		return rc;
+
+	pTask->xCompare = vdbeSorterGetCompare(pTask->pSorter);
+
+	aSlot =
+	    (SorterRecord **) sqlMallocZero(64 * sizeof(SorterRecord *));
+	if (!aSlot) {
+		return -1;
+	}
+
+	if (pList->szPMA >= SQL_SORTER_OFFLOAD_MIN && !box_txn()) {
+		bool cancellable = fiber_set_cancellable(false);
+		ssize_t cb_rc = coio_call(vdbeSorterSortListCb, pTask, pList,
+					  aSlot);
+		fiber_set_cancellable(cancellable);
+		/* The sort callback itself cannot fail. */
+		assert(cb_rc == 0);
+		(void)cb_rc;
+	} else {
+		vdbeSorterSortList(pTask, pList, aSlot);
+	}
 
 	sql_free(aSlot);
 	return 0;
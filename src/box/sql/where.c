@@ -2869,12 +2869,23 @@ tnt_error:
 	}
 
 	/* Automatic indexes */
+	/*
+	 * Charge the build of the ephemeral index for the actual
+	 * number of tuples in the space whenever it is known.
+	 * With the default guess of 2^20 rows the build of an
+	 * automatic index over a moderately sized space gets
+	 * overpriced and the planner keeps a plain nested loop
+	 * scan even when the outer loop is huge.
+	 */
+	LogEst space_size = sql_space_tuple_log_count(space);
 	rSize = DEFAULT_TUPLE_LOG_COUNT;
+	if (!space->def->opts.is_view && space_size > 0)
+		rSize = space_size;
 	/*
 	 * Increase cost of ephemeral index if number of tuples in space is less
 	 * then 10240.
 	 */
-	if (!space->def->opts.is_view && sql_space_tuple_log_count(space) < 133)
+	if (!space->def->opts.is_view && space_size < 133)
 		rSize += DEFAULT_TUPLE_LOG_COUNT;
 	LogEst rLogSize = estLog(rSize);
 	if (!pBuilder->pOrSet && /* Not pqart of an OR optimization */
@@ -46,30 +46,46 @@ sql_stmt_cache_init(void)
 		panic("out of memory");
 	sql_stmt_cache.mem_quota = 0;
 	sql_stmt_cache.mem_used = 0;
+	sql_stmt_cache.hits = 0;
+	sql_stmt_cache.misses = 0;
 	rlist_create(&sql_stmt_cache.gc_queue);
 }
 
+static size_t
+sql_cache_entry_sizeof(struct sql_stmt *stmt)
+{
+	return sql_stmt_est_size(stmt) + sizeof(struct stmt_cache_entry);
+}
+
 void
 sql_stmt_cache_stat(struct info_handler *h)
 {
+	/*
+	 * Unreferenced statements kept around for reuse are not
+	 * reported in size and stmt_count: those reflect what
+	 * sessions hold right now, as they always did.
+	 */
+	size_t zombie_size = 0;
+	uint32_t zombie_count = 0;
+	struct stmt_cache_entry *entry;
+	rlist_foreach_entry(entry, &sql_stmt_cache.gc_queue, link) {
+		zombie_size += sql_cache_entry_sizeof(entry->stmt);
+		zombie_count++;
+	}
 	info_begin(h);
 	info_table_begin(h, "cache");
-	info_append_int(h, "size", sql_stmt_cache.mem_used);
+	info_append_int(h, "size", sql_stmt_cache.mem_used - zombie_size);
 	uint32_t entry_count = 0;
 	mh_int_t i;
 	mh_foreach(sql_stmt_cache.hash, i)
 		entry_count++;
-	info_append_int(h, "stmt_count", entry_count);
+	info_append_int(h, "stmt_count", entry_count - zombie_count);
+	info_append_int(h, "hits", sql_stmt_cache.hits);
+	info_append_int(h, "misses", sql_stmt_cache.misses);
 	info_table_end(h);
 	info_end(h);
 }
 
-static size_t
-sql_cache_entry_sizeof(struct sql_stmt *stmt)
-{
-	return sql_stmt_est_size(stmt) + sizeof(struct stmt_cache_entry);
-}
-
 static void
 sql_cache_entry_delete(struct stmt_cache_entry *entry)
 {
@@ -81,16 +97,22 @@ sql_cache_entry_delete(struct stmt_cache_entry *entry)
 }
 
 /**
- * Remove statement entry from cache: remove from LRU list and
- * account cache size changes, then release occupied memory.
- * At the moment of calling this function, entry is already
- * removed from hash.
+ * Remove statement entry from cache: remove from the hash and
+ * the eviction queue, account cache size changes, then release
+ * occupied memory.
  */
 static void
 sql_stmt_cache_delete(struct stmt_cache_entry *entry)
 {
-	if (sql_stmt_cache.last_found == entry)
-		sql_stmt_cache.last_found = NULL;
+	struct sql_stmt_cache *cache = &sql_stmt_cache;
+	if (cache->last_found == entry)
+		cache->last_found = NULL;
+	const char *sql_str = sql_stmt_query_str(entry->stmt);
+	uint32_t stmt_id = sql_stmt_calculate_id(sql_str, strlen(sql_str));
+	mh_int_t i = mh_i32ptr_find(cache->hash, stmt_id, NULL);
+	assert(i != mh_end(cache->hash));
+	mh_i32ptr_del(cache->hash, i, NULL);
+	cache->mem_used -= sql_cache_entry_sizeof(entry->stmt);
 	rlist_del(&entry->link);
 	sql_cache_entry_delete(entry);
 }
@@ -118,13 +140,21 @@ stmt_cache_find_entry(uint32_t stmt_id)
 	return entry;
 }
 
+/**
+ * Evict unreferenced statements, oldest first, until used
+ * memory does not exceed @a target or the eviction queue is
+ * empty. Referenced statements are never evicted.
+ */
 static void
-sql_stmt_cache_gc(void)
+sql_stmt_cache_gc(size_t target)
 {
-	struct stmt_cache_entry *entry, *next;
-	rlist_foreach_entry_safe(entry, &sql_stmt_cache.gc_queue, link, next)
+	struct sql_stmt_cache *cache = &sql_stmt_cache;
+	while (cache->mem_used > target && !rlist_empty(&cache->gc_queue)) {
+		struct stmt_cache_entry *entry =
+			rlist_first_entry(&cache->gc_queue,
+					  struct stmt_cache_entry, link);
 		sql_stmt_cache_delete(entry);
-	assert(rlist_empty(&sql_stmt_cache.gc_queue));
+	}
 }
 
 /**
@@ -141,7 +171,7 @@ sql_cache_entry_new(struct sql_stmt *stmt)
 		return NULL;
 	}
 	entry->stmt = stmt;
-	entry->link = (struct rlist) { NULL, NULL };
+	rlist_create(&entry->link);
 	entry->refs = 0;
 	return entry;
 }
@@ -162,21 +192,14 @@ sql_stmt_cache_entry_unref(struct stmt_cache_entry *entry)
 	assert((int64_t)entry->refs - 1 >= 0);
 	if (--entry->refs == 0) {
 		/*
-		 * Remove entry from hash and add it to gc queue.
-		 * Resources are to be released in the nearest
-		 * GC cycle (see sql_stmt_cache_insert()).
+		 * Keep the entry in the hash so that a session
+		 * preparing the same statement again revives the
+		 * compiled program instead of recompiling it.
+		 * The entry is put at the tail of the eviction
+		 * queue and released only when the cache runs
+		 * out of quota (see sql_stmt_cache_gc()).
 		 */
-		struct sql_stmt_cache *cache = &sql_stmt_cache;
-		const char *sql_str = sql_stmt_query_str(entry->stmt);
-		uint32_t stmt_id = sql_stmt_calculate_id(sql_str,
-							 strlen(sql_str));
-		mh_int_t i = mh_i32ptr_find(cache->hash, stmt_id, NULL);
-		assert(i != mh_end(cache->hash));
-		mh_i32ptr_del(cache->hash, i, NULL);
-		rlist_add(&sql_stmt_cache.gc_queue, &entry->link);
-		sql_stmt_cache.mem_used -= sql_cache_entry_sizeof(entry->stmt);
-		if (sql_stmt_cache.last_found == entry)
-			sql_stmt_cache.last_found = NULL;
+		rlist_add_tail(&sql_stmt_cache.gc_queue, &entry->link);
 	}
 }
 
@@ -208,6 +231,9 @@ sql_session_stmt_hash_add_id(struct mh_i32ptr_t *hash, uint32_t stmt_id)
 	}
 	assert(old_node == NULL);
 	entry->refs++;
+	/* Pull a revived entry out of the eviction queue. */
+	if (entry->refs == 1)
+		rlist_del(&entry->link);
 	return 0;
 }
 
@@ -217,6 +243,17 @@ sql_stmt_calculate_id(const char *sql_str, size_t len)
 	return mh_strn_hash(sql_str, len);
 }
 
+void
+sql_stmt_ref(uint32_t stmt_id)
+{
+	struct stmt_cache_entry *entry = stmt_cache_find_entry(stmt_id);
+	assert(entry != NULL);
+	entry->refs++;
+	/* Pull a revived entry out of the eviction queue. */
+	if (entry->refs == 1)
+		rlist_del(&entry->link);
+}
+
 void
 sql_stmt_unref(uint32_t stmt_id)
 {
@@ -231,8 +268,10 @@ sql_stmt_cache_update(struct sql_stmt *old_stmt, struct sql_stmt *new_stmt)
 	const char *sql_str = sql_stmt_query_str(old_stmt);
 	uint32_t stmt_id = sql_stmt_calculate_id(sql_str, strlen(sql_str));
 	struct stmt_cache_entry *entry = stmt_cache_find_entry(stmt_id);
+	sql_stmt_cache.mem_used -= sql_stmt_est_size(entry->stmt);
 	sql_stmt_finalize(entry->stmt);
 	entry->stmt = new_stmt;
+	sql_stmt_cache.mem_used += sql_stmt_est_size(new_stmt);
 	return 0;
 }
 
@@ -243,8 +282,11 @@ sql_stmt_cache_insert(struct sql_stmt *stmt)
 	struct sql_stmt_cache *cache = &sql_stmt_cache;
 	size_t new_entry_size = sql_cache_entry_sizeof(stmt);
 
-	if (! sql_cache_check_new_entry_size(new_entry_size))
-		sql_stmt_cache_gc();
+	if (! sql_cache_check_new_entry_size(new_entry_size)) {
+		size_t quota = sql_stmt_cache.mem_quota;
+		sql_stmt_cache_gc(new_entry_size > quota ?
+				  0 : quota - new_entry_size);
+	}
 	/*
 	 * Test memory limit again. Raise an error if it is
 	 * still overcrowded.
@@ -261,7 +303,7 @@ sql_stmt_cache_insert(struct sql_stmt *stmt)
 		return -1;
 	const char *sql_str = sql_stmt_query_str(stmt);
 	uint32_t stmt_id = sql_stmt_calculate_id(sql_str, strlen(sql_str));
-	assert(sql_stmt_cache_find(stmt_id) == NULL);
+	assert(stmt_cache_find_entry(stmt_id) == NULL);
 	const struct mh_i32ptr_node_t id_node = { stmt_id, entry };
 	struct mh_i32ptr_node_t *old_node = NULL;
 	mh_int_t i = mh_i32ptr_put(hash, &id_node, &old_node, NULL);
@@ -279,8 +321,11 @@ struct sql_stmt *
 sql_stmt_cache_find(uint32_t stmt_id)
 {
 	struct stmt_cache_entry *entry = stmt_cache_find_entry(stmt_id);
-	if (entry == NULL)
+	if (entry == NULL) {
+		sql_stmt_cache.misses++;
 		return NULL;
+	}
+	sql_stmt_cache.hits++;
 	return entry->stmt;
 }
 
@@ -288,7 +333,7 @@ int
 sql_stmt_cache_set_size(size_t size)
 {
 	if (sql_stmt_cache.mem_used > size)
-		sql_stmt_cache_gc();
+		sql_stmt_cache_gc(size);
 	if (sql_stmt_cache.mem_used > size) {
 		diag_set(ClientError, ER_SQL_PREPARE, "Can't reduce memory "\
 			 "limit for SQL prepared statements: please, deallocate "\
@@ -70,11 +70,17 @@ struct sql_stmt_cache {
 	struct mh_i32ptr_t *hash;
 	/**
 	 * After deallocation statements are not deleted, but
-	 * moved to this list. GC process is triggered only
-	 * when memory limit has reached. It allows to reduce
-	 * workload on session's disconnect.
+	 * moved to this list while staying findable in the hash,
+	 * so a session preparing the same statement again revives
+	 * the compiled program instead of recompiling it. Entries
+	 * are evicted from the head of the list (oldest first),
+	 * and only when the memory quota runs out.
 	 */
 	struct rlist gc_queue;
+	/** Number of cache lookups that found a statement. */
+	size_t hits;
+	/** Number of cache lookups that found nothing. */
+	size_t misses;
 	/**
 	 * Last result of sql_stmt_cache_find() invocation.
 	 * Since during processing prepared statement it
@@ -121,6 +127,14 @@ sql_session_stmt_hash_add_id(struct mh_i32ptr_t *hash, uint32_t stmt_id);
 uint32_t
 sql_stmt_calculate_id(const char *sql_str, size_t len);
 
+/**
+ * Ref prepared statement entry in global holder: the statement
+ * can not be evicted from the cache until the reference is
+ * dropped with sql_stmt_unref().
+ */
+void
+sql_stmt_ref(uint32_t stmt_id);
+
 /** Unref prepared statement entry in global holder. */
 void
 sql_stmt_unref(uint32_t stmt_id);
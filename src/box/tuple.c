@@ -38,6 +38,8 @@
 #include "xrow_update.h"
 #include "coll_id_cache.h"
 
+#include <sys/mman.h>
+
 static struct mempool tuple_iterator_pool;
 static struct small_alloc runtime_alloc;
 
@@ -333,7 +335,7 @@ tuple_init(field_name_hash_f hash)
 void
 tuple_arena_create(struct slab_arena *arena, struct quota *quota,
 		   uint64_t arena_max_size, uint32_t slab_size,
-		   bool dontdump, const char *arena_name)
+		   bool dontdump, bool hugepages, const char *arena_name)
 {
 	/*
 	 * Ensure that quota is a multiple of slab_size, to
@@ -362,6 +364,24 @@ tuple_arena_create(struct slab_arena *arena, struct quota *quota,
 		}
 	}
 
+	/*
+	 * The whole arena is mapped upfront, so a single madvise()
+	 * hint covers every slab that will ever be carved from it.
+	 * MADV_HUGEPAGE is a hint: when huge pages are unavailable
+	 * the kernel silently keeps regular pages, so there is
+	 * nothing to fall back to here.
+	 */
+	if (hugepages && prealloc > 0) {
+#ifdef MADV_HUGEPAGE
+		if (madvise(arena->arena, prealloc, MADV_HUGEPAGE) != 0)
+			say_syserror("failed to enable huge pages for %s "
+				     "tuple arena", arena_name);
+#else
+		say_warn("huge pages are not supported on this platform, "
+			 "option ignored for %s tuple arena", arena_name);
+#endif
+	}
+
 	say_debug("tuple arena %s: addr %p size %zu flags %#x dontdump %d",
 		  arena_name, arena->arena, prealloc, flags, dontdump);
 }
@@ -453,11 +473,111 @@ tuple_field_go_to_key(const char **field, const char *key, int len)
 	return -1;
 }
 
+enum {
+	/** Number of slots in the per-thread compiled path cache. */
+	TUPLE_PATH_CACHE_SIZE = 64,
+	/** Longest path a cache slot can hold. */
+	TUPLE_PATH_CACHE_PATH_MAX = 128,
+	/** Maximum number of tokens in a compiled path. */
+	TUPLE_PATH_CACHE_TOKEN_MAX = 16,
+};
+
+/**
+ * A compiled JSON path: the token array of a valid path,
+ * pre-lexed so that repeated accesses do not pay the lexer
+ * again. Keyed by the path content - paths come from different
+ * sources (key part definitions, Lua calls), but equal text
+ * always compiles to the same tokens. Token strings point into
+ * the stored copy of the path.
+ */
+struct tuple_path_cache_entry {
+	/** Hash of the path, to skip most false slot hits. */
+	uint32_t hash;
+	/** Length of the cached path, 0 if the slot is empty. */
+	uint16_t path_len;
+	/** Number of tokens, JSON_TOKEN_END excluded. */
+	uint16_t token_count;
+	/** The path itself. */
+	char path[TUPLE_PATH_CACHE_PATH_MAX];
+	/** Its tokens. */
+	struct json_token tokens[TUPLE_PATH_CACHE_TOKEN_MAX];
+};
+
+/** Direct-mapped per-thread cache of compiled JSON paths. */
+static __thread struct tuple_path_cache_entry
+	tuple_path_cache[TUPLE_PATH_CACHE_SIZE];
+
+/**
+ * Find or build the compiled form of a path. Returns NULL if
+ * the path is invalid or too long or too deep for a cache slot -
+ * the caller then falls back to the plain lexer loop.
+ */
+static struct tuple_path_cache_entry *
+tuple_path_compile(const char *path, uint32_t path_len)
+{
+	/* field_name_hash may be unset, e.g. in unit tests. */
+	if (path_len == 0 || path_len > TUPLE_PATH_CACHE_PATH_MAX ||
+	    field_name_hash == NULL)
+		return NULL;
+	uint32_t h = field_name_hash(path, path_len);
+	struct tuple_path_cache_entry *e =
+		&tuple_path_cache[h & (TUPLE_PATH_CACHE_SIZE - 1)];
+	if (e->hash == h && e->path_len == path_len &&
+	    memcmp(e->path, path, path_len) == 0)
+		return e;
+	memcpy(e->path, path, path_len);
+	struct json_lexer lexer;
+	json_lexer_create(&lexer, e->path, path_len, TUPLE_INDEX_BASE);
+	uint16_t count = 0;
+	while (true) {
+		if (count >= TUPLE_PATH_CACHE_TOKEN_MAX ||
+		    json_lexer_next_token(&lexer, &e->tokens[count]) != 0) {
+			e->path_len = 0;
+			return NULL;
+		}
+		if (e->tokens[count].type == JSON_TOKEN_END)
+			break;
+		count++;
+	}
+	e->hash = h;
+	e->path_len = path_len;
+	e->token_count = count;
+	return e;
+}
+
 int
 tuple_go_to_path(const char **data, const char *path, uint32_t path_len,
 		 int multikey_idx)
 {
 	int rc;
+	struct tuple_path_cache_entry *e = tuple_path_compile(path, path_len);
+	if (e != NULL) {
+		for (uint16_t i = 0; i < e->token_count; i++) {
+			const struct json_token *ctoken = &e->tokens[i];
+			switch (ctoken->type) {
+			case JSON_TOKEN_ANY:
+				if (multikey_idx == MULTIKEY_NONE)
+					return -1;
+				rc = tuple_field_go_to_index(data,
+							     multikey_idx);
+				break;
+			case JSON_TOKEN_NUM:
+				rc = tuple_field_go_to_index(data,
+							     ctoken->num);
+				break;
+			default:
+				assert(ctoken->type == JSON_TOKEN_STR);
+				rc = tuple_field_go_to_key(data, ctoken->str,
+							   ctoken->len);
+				break;
+			}
+			if (rc != 0) {
+				*data = NULL;
+				return 0;
+			}
+		}
+		return 0;
+	}
 	struct json_lexer lexer;
 	struct json_token token;
 	json_lexer_create(&lexer, path, path_len, TUPLE_INDEX_BASE);
@@ -33,6 +33,7 @@
 #include "trivia/util.h"
 #include "say.h"
 #include "diag.h"
+#include "mp_check_flat.h"
 #include "error.h"
 #include "uuid/tt_uuid.h" /* tuple_field_uuid */
 #include "tt_static.h"
@@ -65,12 +66,17 @@ tuple_free(void);
  * @param arena[out] Arena to initialize.
  * @param quota Arena's quota.
  * @param arena_max_size Maximal size of @arena.
+ * @param dontdump Exclude @arena from core dumps.
+ * @param hugepages Ask the kernel to back @arena with huge
+ *                  pages. This is a hint: if huge pages can not
+ *                  be used, the arena transparently falls back
+ *                  to regular pages.
  * @param arena_name Name of @arena for logs.
  */
 void
 tuple_arena_create(struct slab_arena *arena, struct quota *quota,
 		   uint64_t arena_max_size, uint32_t slab_size,
-		   bool dontdump, const char *arena_name);
+		   bool dontdump, bool hugepages, const char *arena_name);
 
 void
 tuple_arena_destroy(struct slab_arena *arena);
@@ -667,13 +673,37 @@ offset_slot_access:
 		tuple += offset;
 	} else {
 		uint32_t field_count;
+		const char *data;
 parse:
 		ERROR_INJECT(ERRINJ_TUPLE_FIELD, return NULL);
+		data = tuple;
 		field_count = mp_decode_array(&tuple);
 		if (unlikely(fieldno >= field_count))
 			return NULL;
-		for (uint32_t k = 0; k < fieldno; k++)
-			mp_next(&tuple);
+		/*
+		 * Use the decode plan to reach the field through
+		 * the field map anchor closest to it, see
+		 * tuple_field_raw().
+		 */
+		if (format->decode_plan_count > 0) {
+			uint32_t i = MIN(fieldno,
+					 format->decode_plan_count - 1);
+			const struct tuple_decode_step *step =
+				&format->decode_plan[i];
+			uint32_t offset = 0;
+			if (step->offset_slot != TUPLE_OFFSET_SLOT_NIL)
+				offset = field_map_get_offset(
+					field_map, step->offset_slot,
+					MULTIKEY_NONE);
+			if (offset != 0) {
+				tuple = data + offset;
+				mp_next_flat(&tuple,
+					     step->skip + (fieldno - i));
+				goto descend;
+			}
+		}
+		mp_next_flat(&tuple, fieldno);
+descend:
 		if (path != NULL &&
 		    unlikely(tuple_go_to_path(&tuple, path, path_len,
 					      multikey_idx) != 0))
@@ -716,13 +746,37 @@ tuple_field_raw(struct tuple_format *format, const char *tuple,
 			return NULL;
 		tuple += offset;
 	} else {
+		const char *data;
 parse:
 		ERROR_INJECT(ERRINJ_TUPLE_FIELD, return NULL);
+		data = tuple;
 		uint32_t field_count = mp_decode_array(&tuple);
 		if (unlikely(field_no >= field_count))
 			return NULL;
-		for ( ; field_no > 0; field_no--)
-			mp_next(&tuple);
+		/*
+		 * Use the decode plan: jump to the nearest
+		 * preceding field present in the field map and
+		 * skip only the remainder. Fields past the plan
+		 * reuse its last anchor.
+		 */
+		if (format->decode_plan_count > 0) {
+			uint32_t i = MIN(field_no,
+					 format->decode_plan_count - 1);
+			const struct tuple_decode_step *step =
+				&format->decode_plan[i];
+			if (step->offset_slot != TUPLE_OFFSET_SLOT_NIL) {
+				uint32_t offset = field_map_get_offset(
+					field_map, step->offset_slot,
+					MULTIKEY_NONE);
+				if (offset != 0) {
+					tuple = data + offset;
+					mp_next_flat(&tuple, step->skip +
+						     (field_no - i));
+					return tuple;
+				}
+			}
+		}
+		mp_next_flat(&tuple, field_no);
 	}
 	return tuple;
 }
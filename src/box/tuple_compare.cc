@@ -1951,6 +1951,89 @@ key_def_set_hint_func(struct key_def *def)
 
 /* }}} tuple_hint */
 
+/**
+ * Compare two integer fields of the same statically known index
+ * part type.
+ */
+template<bool is_unsigned>
+static inline int
+field_compare_integer(const char *field_a, const char *field_b)
+{
+	if (is_unsigned)
+		return mp_compare_uint(field_a, field_b);
+	return mp_compare_integer_with_type(field_a, mp_typeof(*field_a),
+					    field_b, mp_typeof(*field_b));
+}
+
+/**
+ * Comparator for key_defs consisting entirely of integer parts.
+ * Such keys are by far the most common, so when no pre-compiled
+ * signature matches (more than three parts, or parts outside of
+ * the first fields), it is still worth shaving the per-part
+ * type dispatch and collation checks of tuple_compare_field()
+ * off the inner loop.
+ */
+template<bool is_unsigned>
+static int
+tuple_compare_all_integer(struct tuple *tuple_a, hint_t tuple_a_hint,
+			  struct tuple *tuple_b, hint_t tuple_b_hint,
+			  struct key_def *key_def)
+{
+	int rc = hint_cmp(tuple_a_hint, tuple_b_hint);
+	if (rc != 0)
+		return rc;
+	struct tuple_format *format_a = tuple_format(tuple_a);
+	struct tuple_format *format_b = tuple_format(tuple_b);
+	const char *tuple_a_raw = tuple_data(tuple_a);
+	const char *tuple_b_raw = tuple_data(tuple_b);
+	const uint32_t *field_map_a = tuple_field_map(tuple_a);
+	const uint32_t *field_map_b = tuple_field_map(tuple_b);
+	struct key_part *part = key_def->parts;
+	struct key_part *end = part + key_def->part_count;
+	for (; part < end; part++) {
+		const char *field_a = tuple_field_raw(format_a, tuple_a_raw,
+						      field_map_a,
+						      part->fieldno);
+		const char *field_b = tuple_field_raw(format_b, tuple_b_raw,
+						      field_map_b,
+						      part->fieldno);
+		assert(field_a != NULL && field_b != NULL);
+		rc = field_compare_integer<is_unsigned>(field_a, field_b);
+		if (rc != 0)
+			return rc;
+	}
+	return 0;
+}
+
+/** @sa tuple_compare_all_integer(). */
+template<bool is_unsigned>
+static int
+tuple_compare_with_key_all_integer(struct tuple *tuple, hint_t tuple_hint,
+				   const char *key, uint32_t part_count,
+				   hint_t key_hint, struct key_def *key_def)
+{
+	assert(key != NULL || part_count == 0);
+	assert(part_count <= key_def->part_count);
+	int rc = hint_cmp(tuple_hint, key_hint);
+	if (rc != 0)
+		return rc;
+	struct tuple_format *format = tuple_format(tuple);
+	const char *tuple_raw = tuple_data(tuple);
+	const uint32_t *field_map = tuple_field_map(tuple);
+	struct key_part *part = key_def->parts;
+	struct key_part *end = part + part_count;
+	for (; part < end; part++) {
+		const char *field = tuple_field_raw(format, tuple_raw,
+						    field_map, part->fieldno);
+		assert(field != NULL);
+		rc = field_compare_integer<is_unsigned>(field, key);
+		if (rc != 0)
+			return rc;
+		mp_next(&key);
+	}
+	return 0;
+}
+
 static void
 key_def_set_compare_func_fast(struct key_def *def)
 {
@@ -1990,6 +2073,36 @@ key_def_set_compare_func_fast(struct key_def *def)
 			break;
 		}
 	}
+	/*
+	 * No pre-compiled signature matched - check for an
+	 * all-integer key before falling back on the generic
+	 * comparators. Sequential keys keep the sequential
+	 * version: it walks the fields without field map
+	 * lookups.
+	 */
+	if (!is_sequential && (cmp == NULL || cmp_wk == NULL)) {
+		bool all_unsigned = true;
+		bool all_integer = true;
+		for (uint32_t i = 0; i < def->part_count; i++) {
+			if (def->parts[i].type != FIELD_TYPE_UNSIGNED)
+				all_unsigned = false;
+			if (def->parts[i].type != FIELD_TYPE_UNSIGNED &&
+			    def->parts[i].type != FIELD_TYPE_INTEGER)
+				all_integer = false;
+		}
+		if (cmp == NULL) {
+			if (all_unsigned)
+				cmp = tuple_compare_all_integer<true>;
+			else if (all_integer)
+				cmp = tuple_compare_all_integer<false>;
+		}
+		if (cmp_wk == NULL) {
+			if (all_unsigned)
+				cmp_wk = tuple_compare_with_key_all_integer<true>;
+			else if (all_integer)
+				cmp_wk = tuple_compare_with_key_all_integer<false>;
+		}
+	}
 	if (cmp == NULL) {
 		cmp = is_sequential ?
 			tuple_compare_sequential<false, false> :
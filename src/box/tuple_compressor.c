@@ -0,0 +1,253 @@
+/*
+ * Copyright 2010-2021, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "tuple_compressor.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zstd.h>
+
+#include "diag.h"
+#include "small/region.h"
+#include "trivia/util.h"
+
+enum {
+	/**
+	 * Size of the dictionary sample buffer. Once this many
+	 * payload bytes have been sampled, the buffer is digested
+	 * into the shared dictionary.
+	 */
+	TUPLE_COMPRESSOR_DICT_SIZE = 64 * 1024,
+	/**
+	 * Size of the image header: one flags byte followed by
+	 * the uncompressed payload size.
+	 */
+	TUPLE_COMPRESSOR_HDR_SIZE = 1 + sizeof(uint32_t),
+};
+
+/** The image was compressed with the shared dictionary. */
+enum { TUPLE_COMPRESSOR_FLAG_DICT = 0x01 };
+
+struct tuple_compressor {
+	/** zstd compression level. */
+	int level;
+	/** Reusable compression context. */
+	ZSTD_CCtx *cctx;
+	/** Reusable decompression context. */
+	ZSTD_DCtx *dctx;
+	/** Digested dictionary, NULL until trained. */
+	ZSTD_CDict *cdict;
+	/** @see cdict */
+	ZSTD_DDict *ddict;
+	/**
+	 * Sample buffer the dictionary is trained from. Freed
+	 * once the dictionary is built.
+	 */
+	char *samples;
+	/** Number of bytes collected in @a samples. */
+	uint32_t sample_size;
+};
+
+struct tuple_compressor *
+tuple_compressor_new(int level)
+{
+	struct tuple_compressor *compressor = calloc(1, sizeof(*compressor));
+	if (compressor == NULL) {
+		diag_set(OutOfMemory, sizeof(*compressor), "malloc",
+			 "compressor");
+		return NULL;
+	}
+	compressor->level = level;
+	compressor->cctx = ZSTD_createCCtx();
+	compressor->dctx = ZSTD_createDCtx();
+	compressor->samples = malloc(TUPLE_COMPRESSOR_DICT_SIZE);
+	if (compressor->cctx == NULL || compressor->dctx == NULL ||
+	    compressor->samples == NULL) {
+		diag_set(OutOfMemory, TUPLE_COMPRESSOR_DICT_SIZE, "malloc",
+			 "compressor context");
+		tuple_compressor_delete(compressor);
+		return NULL;
+	}
+	return compressor;
+}
+
+void
+tuple_compressor_delete(struct tuple_compressor *compressor)
+{
+	ZSTD_freeCCtx(compressor->cctx);
+	ZSTD_freeDCtx(compressor->dctx);
+	ZSTD_freeCDict(compressor->cdict);
+	ZSTD_freeDDict(compressor->ddict);
+	free(compressor->samples);
+	free(compressor);
+}
+
+bool
+tuple_compressor_is_trained(const struct tuple_compressor *compressor)
+{
+	return compressor->cdict != NULL;
+}
+
+/**
+ * Digest the sample buffer into the shared dictionary. The
+ * bundled zstd has no ZDICT trainer, so the raw samples are used
+ * as a content dictionary. On failure the compressor silently
+ * stays dictionary-less - compression keeps working, just not as
+ * well on small payloads.
+ */
+static void
+tuple_compressor_train(struct tuple_compressor *compressor)
+{
+	assert(compressor->cdict == NULL);
+	compressor->cdict = ZSTD_createCDict(compressor->samples,
+					     compressor->sample_size,
+					     compressor->level);
+	if (compressor->cdict == NULL)
+		return;
+	compressor->ddict = ZSTD_createDDict(compressor->samples,
+					     compressor->sample_size);
+	if (compressor->ddict == NULL) {
+		ZSTD_freeCDict(compressor->cdict);
+		compressor->cdict = NULL;
+		return;
+	}
+	free(compressor->samples);
+	compressor->samples = NULL;
+}
+
+void
+tuple_compressor_sample(struct tuple_compressor *compressor,
+			const char *data, uint32_t size)
+{
+	if (compressor->cdict != NULL)
+		return;
+	uint32_t left = TUPLE_COMPRESSOR_DICT_SIZE - compressor->sample_size;
+	if (size > left)
+		size = left;
+	memcpy(compressor->samples + compressor->sample_size, data, size);
+	compressor->sample_size += size;
+	if (compressor->sample_size == TUPLE_COMPRESSOR_DICT_SIZE)
+		tuple_compressor_train(compressor);
+}
+
+char *
+tuple_compressor_compress(struct tuple_compressor *compressor,
+			  const char *data, uint32_t size,
+			  struct region *region, uint32_t *out_size)
+{
+	*out_size = 0;
+	if (size <= TUPLE_COMPRESSOR_HDR_SIZE)
+		return NULL;
+	/*
+	 * Any result that does not fit below the original size is
+	 * not worth storing, so cap the destination buffer at one
+	 * byte less and let zstd fail on overflow.
+	 */
+	uint32_t dst_cap = size - 1 - TUPLE_COMPRESSOR_HDR_SIZE;
+	size_t svp = region_used(region);
+	char *dst = region_alloc(region, TUPLE_COMPRESSOR_HDR_SIZE + dst_cap);
+	if (dst == NULL) {
+		diag_set(OutOfMemory, TUPLE_COMPRESSOR_HDR_SIZE + dst_cap,
+			 "region_alloc", "compressed tuple");
+		return NULL;
+	}
+	size_t rc;
+	uint8_t flags = 0;
+	if (compressor->cdict != NULL) {
+		flags |= TUPLE_COMPRESSOR_FLAG_DICT;
+		rc = ZSTD_compress_usingCDict(compressor->cctx,
+					      dst + TUPLE_COMPRESSOR_HDR_SIZE,
+					      dst_cap, data, size,
+					      compressor->cdict);
+	} else {
+		rc = ZSTD_compressCCtx(compressor->cctx,
+				       dst + TUPLE_COMPRESSOR_HDR_SIZE,
+				       dst_cap, data, size,
+				       compressor->level);
+	}
+	if (ZSTD_isError(rc)) {
+		/* Incompressible payload, not an error. */
+		region_truncate(region, svp);
+		return NULL;
+	}
+	dst[0] = flags;
+	uint32_t raw_size = size;
+	memcpy(dst + 1, &raw_size, sizeof(raw_size));
+	*out_size = TUPLE_COMPRESSOR_HDR_SIZE + rc;
+	return dst;
+}
+
+char *
+tuple_compressor_decompress(struct tuple_compressor *compressor,
+			    const char *data, uint32_t size,
+			    struct region *region, uint32_t *out_size)
+{
+	*out_size = 0;
+	if (size < TUPLE_COMPRESSOR_HDR_SIZE) {
+		diag_set(IllegalParams, "truncated compressed tuple");
+		return NULL;
+	}
+	uint8_t flags = (uint8_t)data[0];
+	uint32_t raw_size;
+	memcpy(&raw_size, data + 1, sizeof(raw_size));
+	size_t svp = region_used(region);
+	char *dst = region_alloc(region, raw_size);
+	if (dst == NULL) {
+		diag_set(OutOfMemory, raw_size, "region_alloc",
+			 "decompressed tuple");
+		return NULL;
+	}
+	size_t rc;
+	const char *src = data + TUPLE_COMPRESSOR_HDR_SIZE;
+	size_t src_size = size - TUPLE_COMPRESSOR_HDR_SIZE;
+	if ((flags & TUPLE_COMPRESSOR_FLAG_DICT) != 0) {
+		if (compressor->ddict == NULL) {
+			region_truncate(region, svp);
+			diag_set(IllegalParams, "compressed tuple refers "
+				 "to an unknown dictionary");
+			return NULL;
+		}
+		rc = ZSTD_decompress_usingDDict(compressor->dctx, dst,
+						raw_size, src, src_size,
+						compressor->ddict);
+	} else {
+		rc = ZSTD_decompressDCtx(compressor->dctx, dst, raw_size,
+					 src, src_size);
+	}
+	if (ZSTD_isError(rc) || rc != raw_size) {
+		region_truncate(region, svp);
+		diag_set(IllegalParams, "invalid compressed tuple data");
+		return NULL;
+	}
+	*out_size = raw_size;
+	return dst;
+}
@@ -0,0 +1,123 @@
+#ifndef TARANTOOL_BOX_TUPLE_COMPRESSOR_H_INCLUDED
+#define TARANTOOL_BOX_TUPLE_COMPRESSOR_H_INCLUDED
+/*
+ * Copyright 2010-2021, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct region;
+
+/**
+ * Per-space tuple payload compressor.
+ *
+ * Tuple payloads of one space tend to be highly repetitive -
+ * the same map keys, the same enum-like strings, the same field
+ * structure in every tuple - but each payload is too small for a
+ * generic compressor to exploit that on its own. The compressor
+ * therefore trains a shared dictionary from the first payloads
+ * it sees: until enough samples are collected, payloads are
+ * compressed without a dictionary; once the sample buffer is
+ * full, it is digested into a zstd dictionary that all
+ * subsequent payloads are compressed against. The bundled zstd
+ * build does not include the ZDICT trainer, so the sample buffer
+ * is used as a raw content dictionary, which for repetitive
+ * payloads captures most of the win.
+ *
+ * Every compressed image records whether the dictionary was used,
+ * so payloads compressed before training decompress fine after
+ * it. The dictionary is built once and never retrained: images
+ * referring to it stay decompressible for the compressor
+ * lifetime.
+ *
+ * The compressor is a single-thread object, intended to live in
+ * a tuple_format and be used from the owner cord only.
+ */
+struct tuple_compressor;
+
+/**
+ * Create a compressor with the given zstd compression level.
+ * Returns NULL and sets diag on memory allocation failure.
+ */
+struct tuple_compressor *
+tuple_compressor_new(int level);
+
+/** Destroy a compressor and free all its resources. */
+void
+tuple_compressor_delete(struct tuple_compressor *compressor);
+
+/**
+ * Feed a payload into the dictionary sample buffer. A no-op
+ * once the dictionary has been built. Samples are copied, the
+ * caller's buffer is not referenced afterwards.
+ */
+void
+tuple_compressor_sample(struct tuple_compressor *compressor,
+			const char *data, uint32_t size);
+
+/**
+ * Compress a payload onto the given region.
+ * @retval not NULL - compressed image, *out_size bytes.
+ * @retval NULL, *out_size == 0 - the payload is incompressible
+ *         (the image would not be smaller than the original);
+ *         the caller should store the original bytes.
+ * @retval NULL, *out_size != 0 impossible; allocation failure
+ *         returns NULL with *out_size == 0 and diag set, check
+ *         diag_is_empty() to tell it from incompressible data.
+ */
+char *
+tuple_compressor_compress(struct tuple_compressor *compressor,
+			  const char *data, uint32_t size,
+			  struct region *region, uint32_t *out_size);
+
+/**
+ * Decompress an image produced by tuple_compressor_compress()
+ * onto the given region. Returns NULL and sets diag on
+ * allocation failure or if the image is corrupt.
+ */
+char *
+tuple_compressor_decompress(struct tuple_compressor *compressor,
+			    const char *data, uint32_t size,
+			    struct region *region, uint32_t *out_size);
+
+/** True if the dictionary has been built. */
+bool
+tuple_compressor_is_trained(const struct tuple_compressor *compressor);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_BOX_TUPLE_COMPRESSOR_H_INCLUDED */
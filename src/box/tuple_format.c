@@ -417,6 +417,43 @@ tuple_format_use_key_part(struct tuple_format *format, uint32_t field_count,
 	return 0;
 }
 
+/**
+ * Compile the decode plan of the format: for every top-level
+ * field remember the nearest preceding field (itself included)
+ * whose data offset is stored in the field map, and the number
+ * of fields left to skip from it. Multikey fields are not usable
+ * as anchors - their offset slot points at the extra offset
+ * array, not at the field data.
+ */
+static int
+tuple_format_create_decode_plan(struct tuple_format *format)
+{
+	uint32_t field_count = tuple_format_field_count(format);
+	assert(field_count > 0);
+	struct tuple_decode_step *plan = malloc(field_count * sizeof(*plan));
+	if (plan == NULL) {
+		diag_set(OutOfMemory, field_count * sizeof(*plan), "malloc",
+			 "tuple decode plan");
+		return -1;
+	}
+	int32_t anchor_slot = TUPLE_OFFSET_SLOT_NIL;
+	uint32_t skip = 0;
+	for (uint32_t i = 0; i < field_count; i++) {
+		struct tuple_field *field = tuple_format_field(format, i);
+		if (field->offset_slot != TUPLE_OFFSET_SLOT_NIL &&
+		    !field->is_multikey_part &&
+		    !json_token_is_multikey(&field->token)) {
+			anchor_slot = field->offset_slot;
+			skip = 0;
+		}
+		plan[i].offset_slot = anchor_slot;
+		plan[i].skip = skip++;
+	}
+	format->decode_plan = plan;
+	format->decode_plan_count = field_count;
+	return 0;
+}
+
 /**
  * Extract all available type info from keys and field
  * definitions.
@@ -537,6 +574,8 @@ tuple_format_create(struct tuple_format *format, struct key_def * const *keys,
 		    !tuple_field_is_nullable(field))
 			bit_set(required_fields, field->id);
 	}
+	if (tuple_format_create_decode_plan(format) != 0)
+		return -1;
 	format->hash = tuple_format_hash(format);
 	return 0;
 }
@@ -669,6 +708,8 @@ tuple_format_alloc(struct key_def * const *keys, uint16_t key_count,
 	}
 	format->total_field_count = field_count;
 	format->required_fields = NULL;
+	format->decode_plan = NULL;
+	format->decode_plan_count = 0;
 	format->fields_depth = 1;
 	format->refs = 0;
 	format->id = FORMAT_ID_NIL;
@@ -687,6 +728,7 @@ error:
 static inline void
 tuple_format_destroy(struct tuple_format *format)
 {
+	free(format->decode_plan);
 	free(format->required_fields);
 	tuple_format_destroy_fields(format);
 	tuple_dictionary_unref(format->dict);
@@ -157,6 +157,21 @@ tuple_field_is_nullable(struct tuple_field *tuple_field)
 	return tuple_field->nullable_action == ON_CONFLICT_ACTION_NONE;
 }
 
+/**
+ * One step of a format's decode plan: how to reach a top-level
+ * field with the fewest msgpack decodes. @sa tuple_format::decode_plan.
+ */
+struct tuple_decode_step {
+	/**
+	 * The offset slot of the nearest preceding field (the
+	 * planned field itself included) present in the field
+	 * map, or TUPLE_OFFSET_SLOT_NIL if there is none.
+	 */
+	int32_t offset_slot;
+	/** How many fields to skip from that anchor. */
+	uint32_t skip;
+};
+
 /**
  * @brief Tuple format
  * Tuple format describes how tuple is stored and information about its fields
@@ -233,6 +248,18 @@ struct tuple_format {
 	 * A maximum depth of format::fields subtree.
 	 */
 	uint32_t fields_depth;
+	/**
+	 * The decode plan, compiled once per format: for every
+	 * top-level field, the nearest preceding field with an
+	 * offset slot in the field map and the number of fields
+	 * left to skip from it. Unindexed field access jumps to
+	 * the anchor through the field map and decodes only the
+	 * remainder instead of re-parsing the tuple from the
+	 * start. NULL when the format has no fields.
+	 */
+	struct tuple_decode_step *decode_plan;
+	/** Length of decode_plan. */
+	uint32_t decode_plan_count;
 	/**
 	 * Fields comprising the format, organized in a tree.
 	 * First level nodes correspond to tuple fields.
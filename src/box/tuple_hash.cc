@@ -33,6 +33,7 @@
 #include "tuple.h"
 #include "third_party/PMurHash.h"
 #include "coll/coll.h"
+#include "crc32.h"
 #include <math.h>
 
 /* Tuple and key hasher */
@@ -183,15 +184,122 @@ struct TupleHash<FIELD_TYPE_UNSIGNED> {
 	}
 };
 
+/**
+ * CRC32-C counterpart of field_hash(). crc32_calc is dispatched
+ * by crc32_init() to the SSE 4.2 or ARMv8 CRC32 instructions
+ * when available, which makes it several times cheaper per byte
+ * than PMurHash. The values are incompatible with the PMurHash
+ * ones and not stable across architectures, so they must never
+ * reach persistent state, see tuple_hash_fast().
+ */
+template <int TYPE>
+static inline void
+field_crc_hash(uint32_t *pcrc, const char **field)
+{
+	/* See the encoding notes in field_hash(). */
+	const char *f = *field;
+	mp_next(field);
+	uint32_t size = *field - f;
+	assert(size < INT32_MAX);
+	*pcrc = crc32_calc(*pcrc, f, size);
+}
+
+template <>
+inline void
+field_crc_hash<FIELD_TYPE_STRING>(uint32_t *pcrc, const char **pfield)
+{
+	/*
+	 * As in field_hash<FIELD_TYPE_STRING>(), the MsgPack
+	 * format identifier is excluded so that a key sent by a
+	 * client with a wider string header hashes the same as
+	 * the stored field (gh-522). The length is mixed in
+	 * explicitly instead, otherwise adjacent string parts
+	 * would concatenate ambiguously ("ab", "c" vs "a", "bc").
+	 */
+	uint32_t size;
+	const char *f = mp_decode_str(pfield, &size);
+	assert(size < INT32_MAX);
+	*pcrc = crc32_calc(*pcrc, (const char *)&size, sizeof(size));
+	*pcrc = crc32_calc(*pcrc, f, size);
+}
+
+template <int TYPE, int ...MORE_TYPES> struct KeyFieldCrcHash {};
+
+template <int TYPE, int TYPE2, int ...MORE_TYPES>
+struct KeyFieldCrcHash<TYPE, TYPE2, MORE_TYPES...> {
+	static void hash(uint32_t *pcrc, const char **pfield)
+	{
+		field_crc_hash<TYPE>(pcrc, pfield);
+		KeyFieldCrcHash<TYPE2, MORE_TYPES...>::hash(pcrc, pfield);
+	}
+};
+
+template <int TYPE>
+struct KeyFieldCrcHash<TYPE> {
+	static void hash(uint32_t *pcrc, const char **pfield)
+	{
+		field_crc_hash<TYPE>(pcrc, pfield);
+	}
+};
+
+template <int TYPE, int ...MORE_TYPES>
+struct KeyCrcHash {
+	static uint32_t hash(const char *key, struct key_def *)
+	{
+		uint32_t crc = HASH_SEED;
+		KeyFieldCrcHash<TYPE, MORE_TYPES...>::hash(&crc, &key);
+		return crc;
+	}
+};
+
+template <>
+struct KeyCrcHash<FIELD_TYPE_UNSIGNED> {
+	static uint32_t hash(const char *key, struct key_def *key_def)
+	{
+		return KeyHash<FIELD_TYPE_UNSIGNED>::hash(key, key_def);
+	}
+};
+
+template <int TYPE, int ...MORE_TYPES>
+struct TupleCrcHash
+{
+	static uint32_t hash(struct tuple *tuple, struct key_def *key_def)
+	{
+		assert(!key_def->is_multikey);
+		uint32_t crc = HASH_SEED;
+		const char *field = tuple_field_by_part(tuple,
+						key_def->parts,
+						MULTIKEY_NONE);
+		/*
+		 * Key parts are sequential here (checked by
+		 * key_def_set_hash_func()), so the whole key is
+		 * hashed in a single pass over adjacent fields.
+		 */
+		KeyFieldCrcHash<TYPE, MORE_TYPES...>::hash(&crc, &field);
+		return crc;
+	}
+};
+
+template <>
+struct TupleCrcHash<FIELD_TYPE_UNSIGNED> {
+	static uint32_t hash(struct tuple *tuple, struct key_def *key_def)
+	{
+		return TupleHash<FIELD_TYPE_UNSIGNED>::hash(tuple, key_def);
+	}
+};
+
 }; /* namespace { */
 
 #define HASHER(...) \
 	{ KeyHash<__VA_ARGS__>::hash, TupleHash<__VA_ARGS__>::hash, \
+		KeyCrcHash<__VA_ARGS__>::hash, TupleCrcHash<__VA_ARGS__>::hash, \
 		{ __VA_ARGS__, UINT32_MAX } },
 
 struct hasher_signature {
 	key_hash_t kf;
 	tuple_hash_t tf;
+	key_hash_t kcf;
+	tuple_hash_t tcf;
 	uint32_t p[64];
 };
 
@@ -255,6 +363,8 @@ key_def_set_hash_func(struct key_def *key_def) {
 		if (i == key_def->part_count && hash_arr[k].p[i] == UINT32_MAX){
 			key_def->tuple_hash = hash_arr[k].tf;
 			key_def->key_hash = hash_arr[k].kf;
+			key_def->tuple_hash_fast = hash_arr[k].tcf;
+			key_def->key_hash_fast = hash_arr[k].kcf;
 			return;
 		}
 	}
@@ -272,6 +382,13 @@ slowpath:
 			key_def->tuple_hash = tuple_hash_slowpath<false, false>;
 	}
 	key_def->key_hash = key_hash_slowpath;
+	/*
+	 * The slow path handles collations, json paths and
+	 * optional parts that the CRC32-C templates do not cover,
+	 * so the fast hooks fall back to it.
+	 */
+	key_def->tuple_hash_fast = key_def->tuple_hash;
+	key_def->key_hash_fast = key_def->key_hash;
 }
 
 uint32_t
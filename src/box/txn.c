@@ -38,14 +38,28 @@
 #include "xrow.h"
 #include "errinj.h"
 #include "iproto_constants.h"
+#include "flightrec.h"
+#include "probes.h"
 
 double too_long_threshold;
 
 /** Last prepare-sequence-number that was assigned to prepared TX. */
 int64_t txn_last_psn = 0;
 
+enum {
+	/**
+	 * Max number of recycled txn objects kept in the cache.
+	 * Each cached txn pins a region slab, so a burst of
+	 * concurrent transactions must not turn into a permanent
+	 * per-thread hoard.
+	 */
+	TXN_CACHE_MAX = 128,
+};
+
 /* Txn cache. */
 static struct stailq txn_cache = {NULL, &txn_cache.first};
+/** Number of txn objects in txn_cache. */
+static int txn_cache_size = 0;
 
 static int
 txn_on_stop(struct trigger *trigger, void *event);
@@ -183,8 +197,11 @@ txn_rollback_to_svp(struct txn *txn, struct stailq_entry *svp)
 inline static struct txn *
 txn_new(void)
 {
-	if (!stailq_empty(&txn_cache))
-		return stailq_shift_entry(&txn_cache, struct txn, in_txn_cache);
+	if (!stailq_empty(&txn_cache)) {
+		txn_cache_size--;
+		return stailq_shift_entry(&txn_cache, struct txn,
+					  in_txn_cache);
+	}
 
 	/* Create a region. */
 	struct region region;
@@ -199,6 +216,14 @@ txn_new(void)
 	}
 	assert(region_used(&region) == sizeof(*txn));
 	txn->region = region;
+	/*
+	 * The region was moved into the txn by a shallow copy, so
+	 * the boundary slabs of its list still link back to the
+	 * stack-frame list head, which is about to die. Re-home
+	 * them at the new location.
+	 */
+	txn->region.slabs.slabs.next->prev = &txn->region.slabs.slabs;
+	txn->region.slabs.slabs.prev->next = &txn->region.slabs.slabs;
 	rlist_create(&txn->read_set);
 	rlist_create(&txn->conflict_list);
 	rlist_create(&txn->conflicted_by_list);
@@ -240,9 +265,32 @@ txn_free(struct txn *txn)
 	stailq_foreach_entry(stmt, &txn->stmts, next)
 		txn_stmt_destroy(stmt);
 
-	/* Truncate region up to struct txn size. */
+	if (txn_cache_size >= TXN_CACHE_MAX) {
+		/*
+		 * The cache is full - destroy the txn for real.
+		 * The txn itself is the first allocation on its
+		 * region, so the region can not be destroyed in
+		 * place: its list head would be freed from under
+		 * region_destroy() together with the first slab.
+		 * Move the region onto the stack first, re-homing
+		 * the boundary slab links at the copied head the
+		 * same way txn_new() does.
+		 */
+		struct region region = txn->region;
+		region.slabs.slabs.next->prev = &region.slabs.slabs;
+		region.slabs.slabs.prev->next = &region.slabs.slabs;
+		region_destroy(&region);
+		return;
+	}
+	/*
+	 * Truncate region up to struct txn size. The first slab
+	 * stays with the region, so statements of the next
+	 * transaction recycling this txn are carved out of it
+	 * without going to the slab cache.
+	 */
 	region_truncate(&txn->region, sizeof(struct txn));
 	stailq_add(&txn_cache, &txn->in_txn_cache);
+	txn_cache_size++;
 }
 
 struct txn *
@@ -283,6 +331,8 @@ txn_begin(void)
 	 * if they are not supported.
 	 */
 	txn_set_flag(txn, TXN_CAN_YIELD);
+	flightrec_record(FLIGHTREC_TX_BEGIN, txn->id, 0);
+	TNT_PROBE1(txn_begin, txn->id);
 	return txn;
 }
 
@@ -529,6 +579,8 @@ txn_complete_fail(struct txn *txn)
 	assert(!txn_has_flag(txn, TXN_IS_DONE));
 	assert(txn->signature < 0);
 	txn->status = TXN_ABORTED;
+	flightrec_record(FLIGHTREC_TX_ROLLBACK, txn->id, 0);
+	TNT_PROBE1(txn_rollback, txn->id);
 	struct txn_stmt *stmt;
 	stailq_reverse(&txn->stmts);
 	stailq_foreach_entry(stmt, &txn->stmts, next)
@@ -547,6 +599,8 @@ txn_complete_success(struct txn *txn)
 	assert(!txn_has_flag(txn, TXN_WAIT_SYNC));
 	assert(txn->signature >= 0);
 	txn->status = TXN_COMMITTED;
+	flightrec_record(FLIGHTREC_TX_COMMIT, txn->id, txn->n_new_rows);
+	TNT_PROBE2(txn_commit, txn->id, txn->n_new_rows);
 	if (txn->engine != NULL)
 		engine_commit(txn->engine, txn);
 	if (txn_has_flag(txn, TXN_HAS_TRIGGERS))
@@ -261,6 +261,27 @@ vy_info_append_regulator(struct vy_env *env, struct info_handler *h)
 	info_append_int(h, "dump_watermark", r->dump_watermark);
 	info_append_int(h, "rate_limit", vy_quota_get_rate_limit(r->quota,
 							VY_QUOTA_CONSUMER_TX));
+	/*
+	 * Derived gauges that save the operator the arithmetic:
+	 * how soon the memory quota will run out at the current
+	 * write rate, how much data compaction has yet to chew
+	 * through and how long it would take at the current disk
+	 * bandwidth, and the cumulative write amplification.
+	 * ETAs are reported as -1 when the rate is zero.
+	 */
+	info_append_double(h, "quota_exhaustion_eta", r->write_rate > 0 ?
+			   (double)(r->quota->limit - r->quota->used) /
+			   r->write_rate : -1);
+	size_t compaction_debt = env->lsm_env.compaction_queue_size;
+	info_append_int(h, "compaction_debt", compaction_debt);
+	info_append_double(h, "compaction_debt_eta", r->dump_bandwidth > 0 ?
+			   (double)compaction_debt / r->dump_bandwidth : -1);
+	struct vy_scheduler_stat *sched_stat = &env->scheduler.stat;
+	info_append_double(h, "write_amplification",
+			   sched_stat->dump_output > 0 ?
+			   (double)(sched_stat->dump_output +
+				    sched_stat->compaction_output) /
+			   sched_stat->dump_output : 0);
 	info_table_end(h); /* regulator */
 }
 
@@ -294,6 +315,7 @@ vy_info_append_memory(struct vy_env *env, struct info_handler *h)
 	info_table_begin(h, "memory");
 	info_append_int(h, "tx", vy_tx_manager_mem_used(env->xm));
 	info_append_int(h, "level0", lsregion_used(&env->mem_env.allocator));
+	info_append_int(h, "level0_pinned", env->mem_env.pinned_bytes);
 	info_append_int(h, "tuple_cache", env->cache_env.mem_used);
 	info_append_int(h, "page_index", env->lsm_env.page_index_size);
 	info_append_int(h, "bloom_filter", env->lsm_env.bloom_size);
@@ -423,6 +445,17 @@ vinyl_index_stat(struct index *index, struct info_handler *h)
 	vy_info_append_disk_stmt_counter(h, "output", &stat->disk.compaction.output);
 	vy_info_append_disk_stmt_counter(h, "queue", &stat->disk.compaction.queue);
 	info_table_end(h); /* compaction */
+	/*
+	 * How many bytes compaction writes to disk per byte
+	 * dumped into this LSM tree. Growing over time means
+	 * the index is paying more and more in disk writes for
+	 * the same ingest.
+	 */
+	info_append_double(h, "write_amplification",
+			   stat->disk.dump.output.bytes > 0 ?
+			   (double)(stat->disk.dump.output.bytes +
+				    stat->disk.compaction.output.bytes) /
+			   stat->disk.dump.output.bytes : 0);
 	info_append_int(h, "index_size", lsm->page_index_size);
 	info_append_int(h, "bloom_size", lsm->bloom_size);
 	info_table_end(h); /* disk */
@@ -431,6 +464,7 @@ vinyl_index_stat(struct index *index, struct info_handler *h)
 	vy_info_append_stmt_counter(h, NULL, &cache_stat->count);
 	info_append_int(h, "lookup", cache_stat->lookup);
 	vy_info_append_stmt_counter(h, "get", &cache_stat->get);
+	vy_info_append_stmt_counter(h, "get_hot", &cache_stat->get_hot);
 	vy_info_append_stmt_counter(h, "put", &cache_stat->put);
 	vy_info_append_stmt_counter(h, "invalidate", &cache_stat->invalidate);
 	vy_info_append_stmt_counter(h, "evict", &cache_stat->evict);
@@ -454,6 +488,12 @@ vinyl_index_stat(struct index *index, struct info_handler *h)
 	info_append_str(h, "run_histogram", buf);
 	info_append_int(h, "dumps_per_compaction",
 			vy_lsm_dumps_per_compaction(lsm));
+	/*
+	 * Worst-case number of runs a point lookup has to visit,
+	 * i.e. the number of runs in the most fragmented range.
+	 */
+	info_append_int(h, "read_amplification",
+			histogram_percentile(lsm->run_hist, 100));
 
 	info_end(h);
 }
@@ -493,6 +533,7 @@ vinyl_index_reset_stat(struct index *index)
 	/* Cache */
 	cache_stat->lookup = 0;
 	vy_stmt_counter_reset(&cache_stat->get);
+	vy_stmt_counter_reset(&cache_stat->get_hot);
 	vy_stmt_counter_reset(&cache_stat->put);
 	vy_stmt_counter_reset(&cache_stat->invalidate);
 	vy_stmt_counter_reset(&cache_stat->evict);
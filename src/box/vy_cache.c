@@ -50,13 +50,19 @@ enum {
 	/* Max number of deletes that are made by cleanup action per one
 	 * cache operation */
 	VY_CACHE_CLEANUP_MAX_STEPS = 10,
+	/* Max share of the memory quota the hot LRU list may
+	 * occupy, in percent. Past the limit eviction switches
+	 * from the cold list to the hot one. */
+	VY_CACHE_HOT_SHARE = 66,
 };
 
 void
 vy_cache_env_create(struct vy_cache_env *e, struct slab_cache *slab_cache)
 {
-	rlist_create(&e->cache_lru);
+	rlist_create(&e->cold_lru);
+	rlist_create(&e->hot_lru);
 	e->mem_used = 0;
+	e->hot_mem_used = 0;
 	e->mem_quota = 0;
 	mempool_create(&e->cache_node_mempool, slab_cache,
 		       sizeof(struct vy_cache_node));
@@ -95,7 +101,8 @@ vy_cache_node_new(struct vy_cache_env *env, struct vy_cache *cache,
 	node->flags = 0;
 	node->left_boundary_level = cache->cmp_def->part_count;
 	node->right_boundary_level = cache->cmp_def->part_count;
-	rlist_add(&env->cache_lru, &node->in_lru);
+	node->is_hot = false;
+	rlist_add(&env->cold_lru, &node->in_lru);
 	env->mem_used += vy_cache_node_size(node);
 	vy_stmt_counter_acct_tuple(&cache->stat.count, entry.stmt);
 	return node;
@@ -104,16 +111,41 @@ vy_cache_node_new(struct vy_cache_env *env, struct vy_cache *cache,
 static void
 vy_cache_node_delete(struct vy_cache_env *env, struct vy_cache_node *node)
 {
+	size_t node_size = vy_cache_node_size(node);
 	vy_stmt_counter_unacct_tuple(&node->cache->stat.count,
 				     node->entry.stmt);
-	assert(env->mem_used >= vy_cache_node_size(node));
-	env->mem_used -= vy_cache_node_size(node);
+	assert(env->mem_used >= node_size);
+	env->mem_used -= node_size;
+	if (node->is_hot) {
+		assert(env->hot_mem_used >= node_size);
+		env->hot_mem_used -= node_size;
+	}
 	tuple_unref(node->entry.stmt);
 	rlist_del(&node->in_lru);
 	TRASH(node);
 	mempool_free(&env->cache_node_mempool, node);
 }
 
+/**
+ * Account a read of a node: move it to the head of the hot LRU
+ * list, promoting it from the cold list on the first read. Only
+ * read nodes may push others out of the hot list, which keeps
+ * the cache scan-resistant: entries added by a one-shot scan die
+ * on the cold list without being read again.
+ */
+static void
+vy_cache_node_touch(struct vy_cache_env *env, struct vy_cache_node *node)
+{
+	if (!node->is_hot) {
+		node->is_hot = true;
+		env->hot_mem_used += vy_cache_node_size(node);
+	} else {
+		vy_stmt_counter_acct_tuple(&node->cache->stat.get_hot,
+					   node->entry.stmt);
+	}
+	rlist_move(&env->hot_lru, &node->in_lru);
+}
+
 static void *
 vy_cache_tree_page_alloc(void *ctx)
 {
@@ -166,7 +198,15 @@ vy_cache_destroy(struct vy_cache *cache)
 static void
 vy_cache_gc_step(struct vy_cache_env *env)
 {
-	struct rlist *lru = &env->cache_lru;
+	/*
+	 * Evict from the cold list first and touch the hot one
+	 * only when it outgrows its share of the quota or there
+	 * is nothing else left.
+	 */
+	struct rlist *lru = &env->cold_lru;
+	if (rlist_empty(lru) ||
+	    env->hot_mem_used > env->mem_quota / 100 * VY_CACHE_HOT_SHARE)
+		lru = &env->hot_lru;
 	struct vy_cache_node *node =
 		rlist_last_entry(lru, struct vy_cache_node, in_lru);
 	struct vy_cache *cache = node->cache;
@@ -423,6 +463,7 @@ vy_cache_get(struct vy_cache *cache, struct vy_entry key)
 		vy_cache_tree_find(&cache->cache_tree, key);
 	if (node == NULL)
 		return vy_entry_none();
+	vy_cache_node_touch(cache->env, *node);
 	return (*node)->entry;
 }
 
@@ -515,6 +556,21 @@ vy_cache_iterator_curr(struct vy_cache_iterator *itr)
 	return node ? (*node)->entry : vy_entry_none();
 }
 
+/**
+ * Account a read of the node at the current iterator position
+ * and promote it on the LRU lists.
+ */
+static void
+vy_cache_iterator_acct_get(struct vy_cache_iterator *itr)
+{
+	vy_stmt_counter_acct_tuple(&itr->cache->stat.get, itr->curr.stmt);
+	struct vy_cache_tree *tree = &itr->cache->cache_tree;
+	struct vy_cache_node **node =
+		vy_cache_tree_iterator_get_elem(tree, &itr->curr_pos);
+	if (node != NULL && vy_entry_is_equal((*node)->entry, itr->curr))
+		vy_cache_node_touch(itr->cache->env, *node);
+}
+
 /**
  * Determine whether the merge iterator must be stopped or not.
  * That is made by examining flags of a cache record.
@@ -714,8 +770,7 @@ vy_cache_iterator_next(struct vy_cache_iterator *itr,
 
 	vy_cache_iterator_skip_to_read_view(itr, stop);
 	if (itr->curr.stmt != NULL) {
-		vy_stmt_counter_acct_tuple(&itr->cache->stat.get,
-					   itr->curr.stmt);
+		vy_cache_iterator_acct_get(itr);
 		return vy_history_append_stmt(history, itr->curr);
 	}
 	return 0;
@@ -745,8 +800,7 @@ vy_cache_iterator_skip(struct vy_cache_iterator *itr, struct vy_entry last,
 	vy_cache_iterator_skip_to_read_view(itr, stop);
 
 	if (itr->curr.stmt != NULL) {
-		vy_stmt_counter_acct_tuple(&itr->cache->stat.get,
-					   itr->curr.stmt);
+		vy_cache_iterator_acct_get(itr);
 		return vy_history_append_stmt(history, itr->curr);
 	}
 	return 0;
@@ -824,8 +878,7 @@ vy_cache_iterator_restore(struct vy_cache_iterator *itr, struct vy_entry last,
 
 	vy_history_cleanup(history);
 	if (itr->curr.stmt != NULL) {
-		vy_stmt_counter_acct_tuple(&itr->cache->stat.get,
-					   itr->curr.stmt);
+		vy_cache_iterator_acct_get(itr);
 		if (vy_history_append_stmt(history, itr->curr) != 0)
 			return -1;
 	}
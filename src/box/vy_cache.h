@@ -65,6 +65,8 @@ struct vy_cache_node {
 	uint8_t left_boundary_level;
 	/* Number of parts in key when the value was the last in EQ search */
 	uint8_t right_boundary_level;
+	/** Set if the node is on the hot LRU list. */
+	bool is_hot;
 };
 
 /**
@@ -115,12 +117,25 @@ vy_cache_tree_key_cmp(struct vy_cache_node *a, struct vy_entry b,
  * Environment of the cache
  */
 struct vy_cache_env {
-	/** Common LRU list of read cache. The first element is the newest */
-	struct rlist cache_lru;
+	/**
+	 * Common LRU list of nodes that have not been read since
+	 * they were added to the cache. A one-shot scan passes
+	 * through this list without ever touching the hot one,
+	 * so it can not evict the hot working set. The first
+	 * element is the newest.
+	 */
+	struct rlist cold_lru;
+	/**
+	 * Common LRU list of nodes that have been read at least
+	 * once after insertion. The first element is the newest.
+	 */
+	struct rlist hot_lru;
 	/** Common mempool for vy_cache_node struct */
 	struct mempool cache_node_mempool;
 	/** Size of memory occupied by cached tuples */
 	size_t mem_used;
+	/** Size of memory occupied by nodes on hot_lru */
+	size_t hot_mem_used;
 	/** Max memory size that can be used for cache */
 	size_t mem_quota;
 };
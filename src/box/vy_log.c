@@ -198,6 +198,22 @@ struct vy_log {
 	 * only relevant if @tx_failed is set.
 	 */
 	struct diag tx_diag;
+	/**
+	 * Set while a new log file is being written in the
+	 * background by log rotation. While the flag is set,
+	 * records flushed to the old log file are duplicated
+	 * to rotation_delta so that rotation can append them
+	 * to the new file, whose snapshot part was taken
+	 * before they were committed.
+	 */
+	bool rotating;
+	/**
+	 * Records flushed while the new log file was being
+	 * written, linked by vy_log_record::in_tx.
+	 */
+	struct stailq rotation_delta;
+	/** Region used for rotation_delta allocations. */
+	struct region rotation_region;
 };
 static struct vy_log vy_log;
 
@@ -214,6 +230,9 @@ vy_recovery_process_record(struct vy_recovery *recovery,
 static int
 vy_log_create(const struct vclock *vclock, struct vy_recovery *recovery);
 
+static ssize_t
+vy_log_append_delta_f(va_list ap);
+
 int
 vy_log_rotate(const struct vclock *vclock);
 
@@ -764,6 +783,8 @@ vy_log_init(const char *dir)
 	mempool_create(&vy_log.tx_pool, cord_slab_cache(),
 		       sizeof(struct vy_log_tx));
 	stailq_create(&vy_log.pending_tx);
+	stailq_create(&vy_log.rotation_delta);
+	region_create(&vy_log.rotation_region, cord_slab_cache());
 	diag_create(&vy_log.tx_diag);
 	wal_init_vy_log();
 	fiber_cond_create(&vy_log.flusher_cond);
@@ -845,6 +866,27 @@ vy_log_tx_flush(struct vy_log_tx *tx)
 	}
 	assert(i == tx_size);
 
+	/*
+	 * If the log is being rotated, the records must also be
+	 * appended to the new log file once its snapshot part
+	 * has been written, so duplicate them on the side. This
+	 * is done before the disk write so that an allocation
+	 * failure can't leave a transaction half-remembered.
+	 */
+	struct stailq delta;
+	stailq_create(&delta);
+	size_t delta_used = region_used(&vy_log.rotation_region);
+	if (vy_log.rotating) {
+		stailq_foreach_entry(record, &tx->records, in_tx) {
+			struct vy_log_record *delta_record =
+				vy_log_record_dup(&vy_log.rotation_region,
+						  record);
+			if (delta_record == NULL)
+				goto err;
+			stailq_add_tail_entry(&delta, delta_record, in_tx);
+		}
+	}
+
 	/*
 	 * Do actual disk writes on behalf of the WAL
 	 * so as not to block the tx thread.
@@ -852,9 +894,11 @@ vy_log_tx_flush(struct vy_log_tx *tx)
 	if (wal_write_vy_log(entry) != 0)
 		goto err;
 
+	stailq_concat(&vy_log.rotation_delta, &delta);
 	region_truncate(&fiber()->gc, used);
 	return 0;
 err:
+	region_truncate(&vy_log.rotation_region, delta_used);
 	region_truncate(&fiber()->gc, used);
 	return -1;
 }
@@ -930,6 +974,7 @@ vy_log_free(void)
 		vy_log_tx_delete(tx);
 	stailq_create(&vy_log.pending_tx);
 	mempool_destroy(&vy_log.tx_pool);
+	region_destroy(&vy_log.rotation_region);
 	xdir_destroy(&vy_log.dir);
 	diag_destroy(&vy_log.tx_diag);
 }
@@ -1158,13 +1203,15 @@ vy_log_rotate(const struct vclock *vclock)
 		    (long long)prev_signature, (long long)signature);
 
 	/*
-	 * Lock out all concurrent log writers while we are rotating it.
-	 * This effectively stalls the vinyl scheduler for a while, but
-	 * this is acceptable, because (1) the log file is small and
-	 * hence can be rotated fairly quickly so the stall isn't going
-	 * to take too long and (2) dumps/compactions, which are scheduled
-	 * by the scheduler, are rare events so there shouldn't be too
-	 * many of them piling up due to log rotation.
+	 * Lock out concurrent log writers while we are taking
+	 * a consistent snapshot of the log state. The expensive
+	 * part - writing the snapshot to the new file - is done
+	 * with the latch released: records committed meanwhile
+	 * are flushed to the old log file as usual and collected
+	 * in rotation_delta, to be appended to the new file
+	 * before it replaces the old one. This way the scheduler
+	 * is only stalled for the duration of the delta flush,
+	 * not for the time it takes to rewrite the whole state.
 	 */
 	latch_lock(&vy_log.latch);
 
@@ -1173,12 +1220,38 @@ vy_log_rotate(const struct vclock *vclock)
 	if (recovery == NULL)
 		goto fail;
 
+	assert(!vy_log.rotating);
+	assert(stailq_empty(&vy_log.rotation_delta));
+	vy_log.rotating = true;
+	latch_unlock(&vy_log.latch);
+
 	/* Do actual work from coio so as not to stall tx thread. */
 	int rc = coio_call(vy_log_rotate_f, recovery, vclock);
 	vy_recovery_delete(recovery);
+	bool file_written = (rc == 0);
+
+	latch_lock(&vy_log.latch);
+	/*
+	 * Complete the delta: flush everything still pending,
+	 * then stop recording and append the collected records
+	 * to the new log file.
+	 */
+	if (rc == 0)
+		rc = vy_log_flush();
+	vy_log.rotating = false;
+	if (rc == 0 && !stailq_empty(&vy_log.rotation_delta))
+		rc = coio_call(vy_log_append_delta_f, vclock);
+	stailq_create(&vy_log.rotation_delta);
+	region_free(&vy_log.rotation_region);
 	if (rc < 0) {
 		diag_log();
 		say_error("failed to write `%s'", vy_log_filename(signature));
+		/*
+		 * Delete the new log file - it is incomplete and
+		 * all its records are in the old file anyway.
+		 */
+		if (file_written)
+			unlink(vy_log_filename(signature));
 		goto fail;
 	}
 
@@ -2631,3 +2704,57 @@ err_write_xlog:
 err_create_xlog:
 	return -1;
 }
+
+/**
+ * Append records committed while a vylog snapshot was being
+ * written to the new log file. Part of log rotation.
+ */
+static ssize_t
+vy_log_append_delta_f(va_list ap)
+{
+	const struct vclock *vclock = va_arg(ap, const struct vclock *);
+	const char *path = xdir_format_filename(&vy_log.dir,
+						vclock_sum(vclock), NONE);
+	struct xlog xlog;
+	if (access(path, F_OK) == 0) {
+		if (xlog_open(&xlog, path, &vy_log.dir.opts) < 0)
+			return -1;
+	} else {
+		/*
+		 * The state snapshot was empty so the new log
+		 * file wasn't created. Create it with a snapshot
+		 * marker, just like vy_log_open() does.
+		 */
+		if (xdir_create_xlog(&vy_log.dir, &xlog, vclock) < 0)
+			return -1;
+		struct xrow_header row;
+		struct vy_log_record snap_record;
+		vy_log_record_init(&snap_record);
+		snap_record.type = VY_LOG_SNAPSHOT;
+		if (vy_log_record_encode(&snap_record, &row) < 0 ||
+		    xlog_write_row(&xlog, &row) < 0)
+			goto err_close;
+		if (xlog_rename(&xlog) < 0)
+			goto err_close;
+	}
+
+	struct vy_log_record *record;
+	xlog_tx_begin(&xlog);
+	stailq_foreach_entry(record, &vy_log.rotation_delta, in_tx) {
+		if (vy_log_append_record(&xlog, record) != 0) {
+			xlog_tx_rollback(&xlog);
+			goto err_close;
+		}
+	}
+	if (xlog_tx_commit(&xlog) < 0 ||
+	    xlog_flush(&xlog) < 0 ||
+	    xlog_sync(&xlog) < 0)
+		goto err_close;
+
+	xlog_close(&xlog, false);
+	return 0;
+
+err_close:
+	xlog_close(&xlog, false);
+	return -1;
+}
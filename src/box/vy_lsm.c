@@ -879,6 +879,17 @@ vy_lsm_rotate_mem(struct vy_lsm *lsm)
 	return 0;
 }
 
+bool
+vy_lsm_try_reuse_mem(struct vy_lsm *lsm)
+{
+	assert(lsm->mem != NULL);
+	if (lsm->mem->version != 0 || lsm->mem->pin_count != 0 ||
+	    lsm->mem->space_cache_version != space_cache_version)
+		return false;
+	lsm->mem->generation = *lsm->env->p_generation;
+	return true;
+}
+
 void
 vy_lsm_delete_mem(struct vy_lsm *lsm, struct vy_mem *mem)
 {
@@ -528,6 +528,19 @@ vy_lsm_acct_compaction(struct vy_lsm *lsm, double time,
 int
 vy_lsm_rotate_mem(struct vy_lsm *lsm);
 
+/**
+ * Try to switch the active in-memory index of an LSM tree to the
+ * current generation in place instead of rotating it. Only
+ * possible if the tree was never written to. The caller must
+ * update the scheduler state accordingly, because this raises
+ * the LSM tree generation without sealing anything.
+ *
+ * @retval true  The tree was switched, no rotation is needed.
+ * @retval false The tree must be rotated with vy_lsm_rotate_mem().
+ */
+bool
+vy_lsm_try_reuse_mem(struct vy_lsm *lsm);
+
 /**
  * Remove an in-memory tree from the sealed list of an LSM tree,
  * unaccount and delete it.
@@ -54,9 +54,10 @@ vy_mem_env_create(struct vy_mem_env *env, size_t memory)
 	/* Vinyl memory is limited by vy_quota. */
 	quota_init(&env->quota, QUOTA_MAX);
 	tuple_arena_create(&env->arena, &env->quota, memory,
-			   SLAB_SIZE, false, "vinyl");
+			   SLAB_SIZE, false, false, "vinyl");
 	lsregion_create(&env->allocator, &env->arena);
 	env->tree_extent_size = 0;
+	env->pinned_bytes = 0;
 }
 
 void
@@ -125,6 +126,7 @@ vy_mem_new(struct vy_mem_env *env, struct key_def *cmp_def,
 void
 vy_mem_delete(struct vy_mem *index)
 {
+	assert(index->pin_count == 0);
 	index->env->tree_extent_size -= index->tree_extent_size;
 	tuple_format_unref(index->format);
 	fiber_cond_destroy(&index->pin_cond);
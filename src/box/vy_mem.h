@@ -59,6 +59,15 @@ struct vy_mem_env {
 	struct quota quota;
 	/** Size of memory used for storing tree extents. */
 	size_t tree_extent_size;
+	/**
+	 * Bytes of in-memory trees that are currently pinned and
+	 * hence cannot be dumped and reclaimed. A single stuck
+	 * writer keeps a whole generation in memory, because the
+	 * lsregion backing the trees frees memory only up to the
+	 * oldest still referenced allocation id - this gauge
+	 * shows how much is held hostage that way.
+	 */
+	size_t pinned_bytes;
 };
 
 /**
@@ -208,6 +217,12 @@ struct vy_mem {
 	 * to WAL or rollback.
 	 */
 	int pin_count;
+	/**
+	 * Bytes accounted in env->pinned_bytes while this tree
+	 * is pinned - the tree size at the moment it got its
+	 * first pin.
+	 */
+	size_t pinned_bytes;
 	/**
 	 * Condition variable signaled by vy_mem_unpin()
 	 * if pin_count reaches 0.
@@ -223,7 +238,10 @@ struct vy_mem {
 static inline void
 vy_mem_pin(struct vy_mem *mem)
 {
-	mem->pin_count++;
+	if (mem->pin_count++ == 0) {
+		mem->pinned_bytes = mem->count.bytes;
+		mem->env->pinned_bytes += mem->pinned_bytes;
+	}
 }
 
 /**
@@ -236,8 +254,12 @@ vy_mem_unpin(struct vy_mem *mem)
 {
 	assert(mem->pin_count > 0);
 	mem->pin_count--;
-	if (mem->pin_count == 0)
+	if (mem->pin_count == 0) {
+		assert(mem->env->pinned_bytes >= mem->pinned_bytes);
+		mem->env->pinned_bytes -= mem->pinned_bytes;
+		mem->pinned_bytes = 0;
 		fiber_cond_broadcast(&mem->pin_cond);
+	}
 }
 
 /**
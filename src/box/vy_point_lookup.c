@@ -182,6 +182,16 @@ vy_point_lookup_scan_slices(struct vy_lsm *lsm, const struct vy_read_view **rv,
 		slices[i++] = slice;
 	}
 	assert(i == slice_count);
+	/*
+	 * The slices are scanned one by one below, each read
+	 * blocking the fiber. Hint the kernel to fetch the
+	 * candidate pages of the deeper slices in advance, so
+	 * that their I/O overlaps with the first read instead of
+	 * forming a chain of sequential disk round trips.
+	 */
+	for (i = 1; i < slice_count; i++)
+		vy_run_prefetch_page(slices[i]->run, key, lsm->cmp_def,
+				     lsm->key_def);
 	int rc = 0;
 	for (i = 0; i < slice_count; i++) {
 		if (rc == 0 && !vy_history_is_terminal(history))
@@ -119,6 +119,13 @@ struct vy_range {
 	bool needs_compaction;
 	/** Number of times the range was compacted. */
 	int n_compactions;
+	/**
+	 * Number of lookups served by this range since it was
+	 * created or last compacted. Fed by the read iterator
+	 * and used to compact ranges that actually serve reads
+	 * before equally fragmented cold ranges.
+	 */
+	uint64_t read_count;
 	/**
 	 * Number of dumps it takes to trigger major compaction in
 	 * this range, see vy_run::dump_count for more details.
@@ -143,9 +150,24 @@ struct vy_range {
 static inline bool
 vy_range_heap_less(struct vy_range *r1, struct vy_range *r2)
 {
-	return r1->compaction_priority > r2->compaction_priority;
+	if (r1->compaction_priority != r2->compaction_priority)
+		return r1->compaction_priority > r2->compaction_priority;
+	/*
+	 * Among equally fragmented ranges prefer the one that
+	 * serves more reads - compacting it reduces read
+	 * amplification where it actually hurts. The counters
+	 * are taken into account whenever range priorities are
+	 * updated, i.e. on each dump and compaction.
+	 */
+	return r1->read_count > r2->read_count;
 }
 #define HEAP_LESS(h, l, r) vy_range_heap_less(l, r)
+/*
+ * An LSM tree may have tens of thousands of ranges; a 4-ary
+ * layout halves the heap depth and so the cache misses taken
+ * by priority updates on each dump and compaction.
+ */
+#define HEAP_ARITY 4
 #define heap_value_t struct vy_range
 #define heap_value_attr heap_node
 #include "salad/heap.h"
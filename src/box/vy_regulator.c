@@ -50,6 +50,20 @@
  */
 static const double VY_REGULATOR_TIMER_PERIOD = 1;
 
+/**
+ * If at the current write rate the memory quota is forecast to
+ * be exhausted sooner than this many seconds while dumps can't
+ * keep up, warn the operator, see
+ * vy_regulator_check_stall_forecast().
+ */
+static const double VY_STALL_FORECAST_HORIZON = 300;
+
+/**
+ * Min interval between two write stall forecast warnings,
+ * in seconds.
+ */
+static const double VY_STALL_WARN_INTERVAL = 60;
+
 /**
  * Time window over which the write rate is averaged,
  * in seconds.
@@ -189,6 +203,40 @@ vy_regulator_update_dump_watermark(struct vy_regulator *regulator)
 					quota->limit / 2);
 }
 
+/**
+ * Warn the operator if at the current write rate the memory
+ * quota is going to be exhausted within the forecast horizon
+ * while dump bandwidth is insufficient to keep up. In contrast
+ * to throttling, which reacts to a stall that has already
+ * happened, this gives a chance to slow down the load or add
+ * disks before transactions start blocking.
+ */
+static void
+vy_regulator_check_stall_forecast(struct vy_regulator *regulator)
+{
+	struct vy_quota *quota = regulator->quota;
+
+	if (regulator->write_rate <= regulator->dump_bandwidth)
+		return; /* dumps keep up, no stall ahead */
+
+	double eta = (double)(quota->limit - quota->used) /
+		     regulator->write_rate;
+	if (eta >= VY_STALL_FORECAST_HORIZON)
+		return;
+
+	double now = ev_monotonic_now(loop());
+	if (now - regulator->stall_warn_last < VY_STALL_WARN_INTERVAL)
+		return;
+	regulator->stall_warn_last = now;
+
+	say_warn("vinyl write stall forecast: at the current write rate "
+		 "of %.1f MB/s the memory quota will be exhausted in %.0f "
+		 "seconds, while dump bandwidth is only %.1f MB/s; "
+		 "consider reducing the load or speeding up the disks",
+		 (double)regulator->write_rate / 1024 / 1024, eta,
+		 (double)regulator->dump_bandwidth / 1024 / 1024);
+}
+
 static void
 vy_regulator_timer_cb(ev_loop *loop, ev_timer *timer, int events)
 {
@@ -200,6 +248,7 @@ vy_regulator_timer_cb(ev_loop *loop, ev_timer *timer, int events)
 	vy_regulator_update_write_rate(regulator);
 	vy_regulator_update_dump_watermark(regulator);
 	vy_regulator_check_dump_watermark(regulator);
+	vy_regulator_check_stall_forecast(regulator);
 }
 
 void
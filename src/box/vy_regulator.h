@@ -124,6 +124,12 @@ struct vy_regulator {
 	 * Used for calculating the rate limit.
 	 */
 	struct vy_scheduler_stat sched_stat_recent;
+	/**
+	 * Time when a write stall forecast warning was last
+	 * logged. Used to avoid flooding the log while the
+	 * condition persists.
+	 */
+	double stall_warn_last;
 };
 
 void
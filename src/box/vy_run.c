@@ -35,6 +35,8 @@
 #include "fiber.h"
 #include "fiber_cond.h"
 #include "fio.h"
+#include <sys/uio.h>
+#include <fcntl.h>
 #include "cbus.h"
 #include "memory.h"
 #include "coio_file.h"
@@ -71,6 +73,8 @@ const char *vy_file_suffix[] = {
 	"run" inprogress_suffix, 	/* VY_FILE_RUN_INPROGRESS */
 };
 
+double vy_run_hiccup_threshold = 0;
+
 /* sync run and index files very 16 MB */
 #define VY_RUN_SYNC_INTERVAL (1 << 24)
 
@@ -411,6 +415,33 @@ vy_page_index_find_page(struct vy_run *run, struct vy_entry key,
 	return page;
 }
 
+void
+vy_run_prefetch_page(struct vy_run *run, struct vy_entry key,
+		     struct key_def *cmp_def, struct key_def *key_def)
+{
+#ifdef HAVE_POSIX_FADVISE
+	if (run->info.page_count == 0)
+		return;
+	if (run->info.bloom != NULL &&
+	    !vy_bloom_maybe_has(run->info.bloom, key, key_def))
+		return;
+	bool equal_key;
+	uint32_t page_no = vy_page_index_find_page(run, key, cmp_def,
+						   ITER_EQ, &equal_key);
+	if (page_no >= run->info.page_count)
+		return;
+	struct vy_page_info *page_info = vy_run_page_info(run, page_no);
+	/* This is a hint, errors can be safely ignored. */
+	posix_fadvise(run->fd, page_info->offset, page_info->size,
+		      POSIX_FADV_WILLNEED);
+#else
+	(void)run;
+	(void)key;
+	(void)cmp_def;
+	(void)key_def;
+#endif
+}
+
 struct vy_slice *
 vy_slice_new(int64_t id, struct vy_run *run, struct vy_entry begin,
 	     struct vy_entry end, struct key_def *cmp_def)
@@ -881,6 +912,39 @@ vy_run_filename(struct vy_run *run)
 	return buf;
 }
 
+/**
+ * Decode page rows and the page row index from raw xlog tx
+ * data read from a run file.
+ *
+ * @retval 0 on success
+ * @retval -1 on error, check diag
+ */
+static int
+vy_page_decode(struct vy_page *page, const struct vy_page_info *page_info,
+	       const char *data, size_t size, ZSTD_DStream *zdctx)
+{
+	const char *data_pos = data;
+	const char *data_end = data + size;
+	char *rows = page->data;
+	char *rows_end = rows + page_info->unpacked_size;
+	if (xlog_tx_decode(data, data_end, rows, rows_end, zdctx) != 0)
+		return -1;
+
+	struct xrow_header xrow;
+	data_pos = page->data + page_info->row_index_offset;
+	data_end = page->data + page_info->unpacked_size;
+	if (xrow_header_decode(&xrow, &data_pos, data_end, true) == -1)
+		return -1;
+	if (xrow.type != VY_RUN_ROW_INDEX) {
+		diag_set(ClientError, ER_INVALID_RUN_FILE,
+			 tt_sprintf("Wrong row index type "
+				    "(expected %d, got %u)",
+				    VY_RUN_ROW_INDEX, (unsigned)xrow.type));
+		return -1;
+	}
+	return vy_row_index_decode(page->row_index, page->row_count, &xrow);
+}
+
 /**
  * Read a page requests from vinyl xlog data file.
  *
@@ -920,26 +984,7 @@ vy_page_read(struct vy_page *page, const struct vy_page_info *page_info,
 	ERROR_INJECT_SLEEP(ERRINJ_VY_READ_PAGE_DELAY);
 
 	/* decode xlog tx */
-	const char *data_pos = data;
-	const char *data_end = data + readen;
-	char *rows = page->data;
-	char *rows_end = rows + page_info->unpacked_size;
-	if (xlog_tx_decode(data, data_end, rows, rows_end, zdctx) != 0)
-		goto error;
-
-	struct xrow_header xrow;
-	data_pos = page->data + page_info->row_index_offset;
-	data_end = page->data + page_info->unpacked_size;
-	if (xrow_header_decode(&xrow, &data_pos, data_end, true) == -1)
-		goto error;
-	if (xrow.type != VY_RUN_ROW_INDEX) {
-		diag_set(ClientError, ER_INVALID_RUN_FILE,
-			 tt_sprintf("Wrong row index type "
-				    "(expected %d, got %u)",
-				    VY_RUN_ROW_INDEX, (unsigned)xrow.type));
-		goto error;
-	}
-	if (vy_row_index_decode(page->row_index, page->row_count, &xrow) != 0)
+	if (vy_page_decode(page, page_info, data, readen, zdctx) != 0)
 		goto error;
 	region_truncate(&fiber()->gc, region_svp);
 	ERROR_INJECT(ERRINJ_VY_READ_PAGE, {
@@ -974,6 +1019,75 @@ vy_env_get_zdctx(struct vy_run_env *env)
 	return zdctx;
 }
 
+#if defined(__linux__) && defined(RWF_NOWAIT)
+/**
+ * Try to read and decode a page without blocking. Succeeds only
+ * if the data is already in the OS page cache, so it may be
+ * called from the tx thread: a cache hit costs less here than a
+ * round-trip to a reader thread, while a miss falls back to one.
+ * Sets @a done to true if the page has been read.
+ *
+ * @retval 0 on success or if the read could not be done
+ *           without blocking
+ * @retval -1 on error, check diag
+ */
+static int
+vy_page_read_nowait(struct vy_page *page, const struct vy_page_info *page_info,
+		    struct vy_run *run, ZSTD_DStream *zdctx, bool *done)
+{
+	*done = false;
+	/*
+	 * Error injection tests expect page reads to go through
+	 * the reader threads - do not short-circuit them.
+	 */
+	struct errinj *inj = errinj(ERRINJ_VY_READ_PAGE, ERRINJ_BOOL);
+	if (inj != NULL && inj->bparam)
+		return 0;
+	inj = errinj(ERRINJ_VY_READ_PAGE_DELAY, ERRINJ_BOOL);
+	if (inj != NULL && inj->bparam)
+		return 0;
+	inj = errinj(ERRINJ_VY_READ_PAGE_TIMEOUT, ERRINJ_DOUBLE);
+	if (inj != NULL && inj->dparam > 0)
+		return 0;
+	inj = errinj(ERRINJ_VYRUN_DATA_READ, ERRINJ_BOOL);
+	if (inj != NULL && inj->bparam)
+		return 0;
+
+	size_t region_svp = region_used(&fiber()->gc);
+	char *data = (char *)region_alloc(&fiber()->gc, page_info->size);
+	if (data == NULL) {
+		diag_set(OutOfMemory, page_info->size, "region gc", "page");
+		return -1;
+	}
+	struct iovec iov = { data, page_info->size };
+	ssize_t readen = preadv2(run->fd, &iov, 1, page_info->offset,
+				 RWF_NOWAIT);
+	if (readen != (ssize_t)page_info->size) {
+		/*
+		 * EAGAIN means the data is not cached. ENOSYS and
+		 * EOPNOTSUPP mean the kernel or the file system
+		 * does not support non-blocking reads. A short
+		 * read means only a part of the page is cached.
+		 * In all these cases fall back to a reader
+		 * thread; real I/O errors will be reported there.
+		 */
+		region_truncate(&fiber()->gc, region_svp);
+		return 0;
+	}
+	int rc = vy_page_decode(page, page_info, data, readen, zdctx);
+	region_truncate(&fiber()->gc, region_svp);
+	if (rc != 0) {
+		diag_log();
+		say_error("error reading %s@%llu:%u", vy_run_filename(run),
+			  (unsigned long long)page_info->offset,
+			  (unsigned)page_info->size);
+		return -1;
+	}
+	*done = true;
+	return 0;
+}
+#endif /* defined(__linux__) && defined(RWF_NOWAIT) */
+
 /**
  * vinyl read task callback
  */
@@ -995,6 +1109,44 @@ vy_page_read_cb(struct cbus_call_msg *base)
 	return 0;
 }
 
+#ifdef HAVE_POSIX_FADVISE
+enum {
+	/**
+	 * Number of next run pages the kernel is asked to
+	 * prefetch when an iterator walks pages sequentially.
+	 */
+	VY_RUN_READAHEAD_PAGES = 4,
+};
+
+/**
+ * Ask the kernel to start reading the run pages following
+ * @a page_no in the scan direction. The hint is asynchronous,
+ * so by the time the iterator exhausts the current page the
+ * next ones are likely to be in the OS page cache, where
+ * vy_page_read_nowait() picks them up without blocking.
+ */
+static void
+vy_run_iterator_readahead(struct vy_run_iterator *itr, uint32_t page_no,
+			  int dir)
+{
+	struct vy_run *run = itr->slice->run;
+	uint64_t begin = UINT64_MAX;
+	uint64_t end = 0;
+	for (int i = 1; i <= VY_RUN_READAHEAD_PAGES; i++) {
+		int64_t next = (int64_t)page_no + i * dir;
+		if (next < 0 || next >= (int64_t)run->info.page_count)
+			break;
+		struct vy_page_info *page_info = vy_run_page_info(run, next);
+		begin = MIN(begin, page_info->offset);
+		end = MAX(end, page_info->offset + page_info->size);
+	}
+	if (begin >= end)
+		return;
+	/* This is a hint, errors can be safely ignored. */
+	posix_fadvise(run->fd, begin, end - begin, POSIX_FADV_WILLNEED);
+}
+#endif /* HAVE_POSIX_FADVISE */
+
 /**
  * Read a page from disk given its number.
  * The function caches two most recently read pages.
@@ -1030,12 +1182,49 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 		return 0;
 	}
 
+#ifdef HAVE_POSIX_FADVISE
+	/*
+	 * If the iterator walks pages sequentially, prefetch the
+	 * following pages while the caller is busy merging this
+	 * one.
+	 */
+	int dir = iterator_direction(iterator_type);
+	if (itr->curr_page != NULL &&
+	    (int64_t)itr->curr_page->page_no + dir == (int64_t)page_no)
+		vy_run_iterator_readahead(itr, page_no, dir);
+#endif
+
 	/* Allocate buffers */
 	struct vy_page_info *page_info = vy_run_page_info(slice->run, page_no);
 	page = vy_page_new(page_info);
 	if (page == NULL)
 		return -1;
 
+#if defined(__linux__) && defined(RWF_NOWAIT)
+	/*
+	 * A page cached by the OS is cheaper to read and decode
+	 * right away than to ship to a reader thread and back.
+	 */
+	ZSTD_DStream *zdctx = vy_env_get_zdctx(env);
+	if (zdctx != NULL) {
+		bool done;
+		if (vy_page_read_nowait(page, page_info, slice->run,
+					zdctx, &done) != 0) {
+			vy_page_delete(page);
+			return -1;
+		}
+		if (done) {
+			if (key.stmt != NULL)
+				*pos_in_page = vy_page_find_key(page, key,
+							itr->cmp_def,
+							itr->format,
+							iterator_type,
+							equal_found);
+			goto update_cache;
+		}
+	}
+#endif
+
 	/* Read page data from the disk */
 	struct vy_page_read_task *task = mempool_alloc(&env->read_task_pool);
 	if (task == NULL) {
@@ -1065,6 +1254,9 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 		return -1;
 	}
 
+#if defined(__linux__) && defined(RWF_NOWAIT)
+update_cache:
+#endif
 	/* Update cache */
 	if (itr->prev_page != NULL)
 		vy_page_delete(itr->prev_page);
@@ -2112,7 +2304,8 @@ int
 vy_run_writer_create(struct vy_run_writer *writer, struct vy_run *run,
 		     const char *dirpath, uint32_t space_id, uint32_t iid,
 		     struct key_def *cmp_def, struct key_def *key_def,
-		     uint64_t page_size, double bloom_fpr, bool no_compression)
+		     uint64_t page_size, double bloom_fpr, bool no_compression,
+		     int64_t zstd_level)
 {
 	memset(writer, 0, sizeof(*writer));
 	writer->run = run;
@@ -2124,6 +2317,7 @@ vy_run_writer_create(struct vy_run_writer *writer, struct vy_run *run,
 	writer->page_size = page_size;
 	writer->bloom_fpr = bloom_fpr;
 	writer->no_compression = no_compression;
+	writer->zstd_level = zstd_level;
 	if (bloom_fpr < 1) {
 		writer->bloom = tuple_bloom_builder_new(key_def->part_count);
 		if (writer->bloom == NULL)
@@ -2160,6 +2354,7 @@ vy_run_writer_create_xlog(struct vy_run_writer *writer)
 	opts.rate_limit = writer->run->env->snap_io_rate_limit;
 	opts.sync_interval = VY_RUN_SYNC_INTERVAL;
 	opts.no_compression = writer->no_compression;
+	opts.zstd_level = writer->zstd_level;
 	if (xlog_create(&writer->data_xlog, path, 0, &meta, &opts) != 0)
 		return -1;
 	return 0;
@@ -2266,9 +2461,17 @@ vy_run_writer_end_page(struct vy_run_writer *writer)
 	page->row_index_offset = page->unpacked_size;
 	page->unpacked_size += written;
 
+	double flush_start = ev_monotonic_time();
 	written = xlog_tx_commit(&writer->data_xlog);
 	if (written == 0)
 		written = xlog_flush(&writer->data_xlog);
+	double flush_duration = ev_monotonic_time() - flush_start;
+	if (vy_run_hiccup_threshold > 0 &&
+	    flush_duration > vy_run_hiccup_threshold) {
+		say_warn("disk hiccup: flushing a page of %s took %.3f sec "
+			 "(threshold %.3f sec)", writer->data_xlog.filename,
+			 flush_duration, vy_run_hiccup_threshold);
+	}
 	if (written < 0)
 		return -1;
 	page->size = written;
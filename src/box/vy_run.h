@@ -412,6 +412,15 @@ enum vy_file_type {
 
 extern const char *vy_file_suffix[];
 
+/**
+ * Disk hiccup threshold for run writes, in seconds: a single
+ * page flush slower than this is reported by the worker thread
+ * writing the run. Shares box.cfg.wal_hiccup_threshold, <= 0
+ * disables detection. Written by tx, read by worker threads
+ * without synchronization: stale reads are harmless.
+ */
+extern double vy_run_hiccup_threshold;
+
 static inline int
 vy_lsm_snprint_path(char *buf, int size, const char *dir,
 		    uint32_t space_id, uint32_t iid)
@@ -510,6 +519,17 @@ vy_slice_cut(struct vy_slice *slice, int64_t id, struct vy_entry begin,
 	     struct vy_entry end, struct key_def *cmp_def,
 	     struct vy_slice **result);
 
+/**
+ * Hint the kernel to prefetch the page of @a run that may
+ * contain @a key. Used by point lookups to overlap the I/O of
+ * all runs the key may reside in before they are scanned one by
+ * one. Does nothing if the run can not contain the key according
+ * to its bloom filter.
+ */
+void
+vy_run_prefetch_page(struct vy_run *run, struct vy_entry key,
+		     struct key_def *cmp_def, struct key_def *key_def);
+
 /**
  * Open an iterator over on-disk run.
  *
@@ -614,6 +634,8 @@ struct vy_run_writer {
 	uint32_t page_info_capacity;
 	/** Don't use compression while writing xlog files. */
 	bool no_compression;
+	/** Zstd compression level used for xlog files. */
+	int64_t zstd_level;
 	/** Xlog to write data. */
 	struct xlog data_xlog;
 	/** Bloom filter false positive rate. */
@@ -634,7 +656,8 @@ int
 vy_run_writer_create(struct vy_run_writer *writer, struct vy_run *run,
 		     const char *dirpath, uint32_t space_id, uint32_t iid,
 		     struct key_def *cmp_def, struct key_def *key_def,
-		     uint64_t page_size, double bloom_fpr, bool no_compression);
+		     uint64_t page_size, double bloom_fpr, bool no_compression,
+		     int64_t zstd_level);
 
 /**
  * Write a specified statement into a run.
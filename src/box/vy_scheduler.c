@@ -47,6 +47,7 @@
 #include "cbus.h"
 #include "salad/stailq.h"
 #include "say.h"
+#include "probes.h"
 #include "txn.h"
 #include "space.h"
 #include "schema.h"
@@ -204,6 +205,7 @@ struct vy_task {
 	 */
 	double bloom_fpr;
 	int64_t page_size;
+	int64_t zstd_level;
 	/**
 	 * Deferred DELETE handler passed to the write iterator.
 	 * It sends deferred DELETE statements generated during
@@ -308,6 +310,8 @@ vy_dump_heap_less(struct vy_lsm *i1, struct vy_lsm *i2)
 
 #define HEAP_NAME vy_dump_heap
 #define HEAP_LESS(h, l, r) vy_dump_heap_less(l, r)
+/* One LSM tree per index: the heap can get large, keep it shallow. */
+#define HEAP_ARITY 4
 #define heap_value_t struct vy_lsm
 #define heap_value_attr in_dump
 
@@ -325,6 +329,7 @@ vy_compaction_heap_less(struct vy_lsm *i1, struct vy_lsm *i2)
 
 #define HEAP_NAME vy_compaction_heap
 #define HEAP_LESS(h, l, r) vy_compaction_heap_less(l, r)
+#define HEAP_ARITY 4
 #define heap_value_t struct vy_lsm
 #define heap_value_attr in_compaction
 
@@ -1067,7 +1072,7 @@ vy_task_write_run(struct vy_task *task, bool no_compression)
 				 lsm->space_id, lsm->index_id,
 				 task->cmp_def, task->key_def,
 				 task->page_size, task->bloom_fpr,
-				 no_compression) != 0)
+				 no_compression, task->zstd_level) != 0)
 		goto fail;
 
 	if (wi->iface->start(wi) != 0)
@@ -1261,6 +1266,7 @@ delete_mems:
 	scheduler->dump_task_count--;
 
 	say_info("%s: dump completed", vy_lsm_name(lsm));
+	TNT_PROBE1(vinyl_dump_complete, lsm->id);
 
 	vy_scheduler_complete_dump(scheduler);
 	return 0;
@@ -1330,9 +1336,15 @@ vy_task_dump_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 		goto err;
 	}
 
-	/* Rotate the active tree if it needs to be dumped. */
+	/*
+	 * Rotate the active tree if it needs to be dumped. If it
+	 * was never written to, switch it to the new generation
+	 * in place: sealing it would only make us go through a
+	 * dump task cycle to delete it. The heap position of the
+	 * LSM tree is updated below in either case.
+	 */
 	if (lsm->mem->generation == scheduler->dump_generation &&
-	    vy_lsm_rotate_mem(lsm) != 0)
+	    !vy_lsm_try_reuse_mem(lsm) && vy_lsm_rotate_mem(lsm) != 0)
 		goto err;
 
 	/*
@@ -1397,6 +1409,7 @@ vy_task_dump_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 	task->wi = wi;
 	task->bloom_fpr = lsm->opts.bloom_fpr;
 	task->page_size = lsm->opts.page_size;
+	task->zstd_level = lsm->opts.zstd_level;
 
 	lsm->is_dumping = true;
 	vy_scheduler_update_lsm(scheduler, lsm);
@@ -1416,6 +1429,7 @@ vy_task_dump_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 	scheduler->dump_task_count++;
 
 	say_info("%s: dump started", vy_lsm_name(lsm));
+	TNT_PROBE1(vinyl_dump_start, lsm->id);
 	*p_task = task;
 	return 0;
 
@@ -1561,6 +1575,7 @@ vy_task_compaction_complete(struct vy_task *task)
 			break;
 	}
 	range->n_compactions++;
+	range->read_count = 0;
 	vy_range_update_compaction_priority(range, &lsm->opts);
 	vy_range_update_dumps_per_compaction(range);
 	vy_lsm_acct_range(lsm, range);
@@ -1590,6 +1605,7 @@ vy_task_compaction_complete(struct vy_task *task)
 
 	say_info("%s: completed compacting range %s",
 		 vy_lsm_name(lsm), vy_range_str(range));
+	TNT_PROBE2(vinyl_compaction_complete, lsm->id, (uintptr_t)range);
 	return 0;
 }
 
@@ -1692,6 +1708,7 @@ vy_task_compaction_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 	task->wi = wi;
 	task->bloom_fpr = lsm->opts.bloom_fpr;
 	task->page_size = lsm->opts.page_size;
+	task->zstd_level = lsm->opts.zstd_level;
 
 	/*
 	 * Remove the range we are going to compact from the heap
@@ -1703,6 +1720,7 @@ vy_task_compaction_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 	say_info("%s: started compacting range %s, runs %d/%d",
 		 vy_lsm_name(lsm), vy_range_str(range),
                  range->compaction_priority, range->slice_count);
+	TNT_PROBE2(vinyl_compaction_start, lsm->id, (uintptr_t)range);
 	*p_task = task;
 	return 0;
 
@@ -189,6 +189,12 @@ struct vy_cache_stat {
 	int64_t lookup;
 	/** Number of reads from the cache. */
 	struct vy_stmt_counter get;
+	/**
+	 * Number of reads served by nodes that were already on
+	 * the hot LRU list, i.e. had been read before. The rest
+	 * of the reads, get - get_hot, hit the cold list.
+	 */
+	struct vy_stmt_counter get_hot;
 	/** Number of writes to the cache. */
 	struct vy_stmt_counter put;
 	/**
@@ -47,17 +47,6 @@ struct vy_write_src {
 	struct heap_node heap_node;
 	/* Current tuple in the source (with minimal key and maximal LSN) */
 	struct vy_entry entry;
-	/**
-	 * If this flag is set, this is a so called "virtual"
-	 * source. A virtual source does not stand for any mem or
-	 * run, but represents a delimiter between the current key
-	 * and the next one. There is a special rule used by the
-	 * write iterator heap when comparing with a virtual
-	 * source. Such source is greater than any source with
-	 * the same key and less than any source with a greater
-	 * key, regardless of LSN.
-	 */
-	bool is_end_of_key;
 	/** An iterator over the source */
 	union {
 		struct vy_slice_stream slice_stream;
@@ -219,8 +208,7 @@ struct vy_write_iterator {
 };
 
 /**
- * Comparator of the heap. Put newer LSNs first, unless
- * it's a virtual source (is_end_of_key).
+ * Comparator of the heap. Put newer LSNs first.
  */
 static bool
 heap_less(heap_t *heap, struct vy_write_src *src1, struct vy_write_src *src2)
@@ -232,13 +220,9 @@ heap_less(heap_t *heap, struct vy_write_src *src1, struct vy_write_src *src2)
 	if (cmp != 0)
 		return cmp < 0;
 
-	/**
-	 * Keys are equal, order by LSN, descending.
-	 * Virtual sources use 0 for LSN, so they are ordered
-	 * last automatically.
-	 */
-	int64_t lsn1 = src1->is_end_of_key  ? 0 : vy_stmt_lsn(src1->entry.stmt);
-	int64_t lsn2 = src2->is_end_of_key  ? 0 : vy_stmt_lsn(src2->entry.stmt);
+	/** Keys are equal, order by LSN, descending. */
+	int64_t lsn1 = vy_stmt_lsn(src1->entry.stmt);
+	int64_t lsn2 = vy_stmt_lsn(src2->entry.stmt);
 	if (lsn1 != lsn2)
 		return lsn1 > lsn2;
 
@@ -270,7 +254,6 @@ vy_write_iterator_new_src(struct vy_write_iterator *stream)
 	}
 	heap_node_create(&res->heap_node);
 	res->entry = vy_entry_none();
-	res->is_end_of_key = false;
 	rlist_add(&stream->src_list, &res->in_src_list);
 	return res;
 }
@@ -282,7 +265,6 @@ vy_write_iterator_delete_src(struct vy_write_iterator *stream,
 			     struct vy_write_src *src)
 {
 	(void)stream;
-	assert(!src->is_end_of_key);
 	if (src->stream.iface->close != NULL)
 		src->stream.iface->close(&src->stream);
 	rlist_del(&src->in_src_list);
@@ -682,24 +664,15 @@ vy_write_iterator_build_history(struct vy_write_iterator *stream,
 	/* Search must have been started already. */
 	assert(src->entry.stmt != NULL);
 	/*
-	 * A virtual source instance which represents the end on
-	 * the current key in the source heap. It is greater
-	 * than any statement on the current key and less than
-	 * any statement on the next key.
-	 * The moment we get this source from the heap we know
-	 * that there are no statements that there are no more
-	 * statements for the current key.
+	 * Remember the current key. The history is built until
+	 * the heap top moves on to a greater key, which is
+	 * detected with a single comparison per merge step. The
+	 * statement is referenced because the source it came from
+	 * may be advanced past it while the history is built.
 	 */
-	struct vy_write_src end_of_key_src;
-	end_of_key_src.is_end_of_key = true;
-	end_of_key_src.entry = src->entry;
-	int rc = vy_source_heap_insert(&stream->src_heap, &end_of_key_src);
-	if (rc) {
-		diag_set(OutOfMemory, sizeof(void *),
-			 "malloc", "vinyl write stream heap");
-		return rc;
-	}
-	vy_stmt_ref_if_possible(src->entry.stmt);
+	struct vy_entry key = src->entry;
+	vy_stmt_ref_if_possible(key.stmt);
+	int rc = 0;
 	/*
 	 * For each pair (merge_until_lsn, current_rv_lsn] build
 	 * a history in the corresponding read view.
@@ -796,10 +769,11 @@ next_lsn:
 		if (rc != 0)
 			break;
 		src = vy_source_heap_top(&stream->src_heap);
-		assert(src != NULL);
+		if (src == NULL)
+			break; /* all sources are exhausted */
 		assert(src->entry.stmt != NULL);
-		if (src->is_end_of_key)
-			break;
+		if (vy_entry_compare(src->entry, key, stream->cmp_def) != 0)
+			break; /* the next key has started */
 	}
 
 	/*
@@ -813,8 +787,7 @@ next_lsn:
 		stream->deferred_delete = vy_entry_none();
 	}
 
-	vy_source_heap_delete(&stream->src_heap, &end_of_key_src);
-	vy_stmt_unref_if_possible(end_of_key_src.entry.stmt);
+	vy_stmt_unref_if_possible(key.stmt);
 	return rc;
 }
 
@@ -42,6 +42,10 @@
 #include "cbus.h"
 #include "coio_task.h"
 #include "replication.h"
+#include "histogram.h"
+#include "hdr_histogram.h"
+#include "flightrec.h"
+#include "probes.h"
 
 enum {
 	/**
@@ -71,6 +75,14 @@ wal_write_none_async(struct journal *, struct journal_entry *);
 static int
 wal_write_none(struct journal *, struct journal_entry *);
 
+enum {
+	/**
+	 * Default group commit target, in bytes, see
+	 * wal_writer::sync_size.
+	 */
+	WAL_SYNC_SIZE_DEFAULT = 256 * 1024,
+};
+
 /*
  * WAL writer - maintain a Write Ahead Log for every change
  * in the data state.
@@ -166,6 +178,40 @@ struct wal_writer
 	 * Used for replication relays.
 	 */
 	struct rlist watchers;
+	/**
+	 * Group commit target, in bytes. In WAL_FSYNC mode all
+	 * entries of a batch share one fdatasync(), and a batch
+	 * bigger than this is synced in several groups so that a
+	 * burst does not turn into one giant fsync. Set from
+	 * box.cfg.wal_sync_size.
+	 */
+	int64_t sync_size;
+	/** Group sizes in bytes, collected at each group fsync. */
+	struct histogram *group_hist;
+	/**
+	 * Duration of the most recent fdatasync(), in seconds,
+	 * and the monotonic time when it completed. Read by other
+	 * threads without synchronization for heuristics, e.g.
+	 * snapshot write backoff.
+	 */
+	double sync_last_duration;
+	double sync_last_time;
+	/** Batch write latencies in microseconds. */
+	struct hdr_histogram *write_hist;
+	/**
+	 * fdatasync() latencies in microseconds. Only populated
+	 * in WAL_FSYNC mode, like group_hist.
+	 */
+	struct hdr_histogram *fsync_hist;
+	/**
+	 * Disk hiccup threshold, in seconds: a single batch write
+	 * or fdatasync() slower than this is counted and reported
+	 * with attribution. Set from
+	 * box.cfg.wal_hiccup_threshold, <= 0 disables detection.
+	 */
+	double hiccup_threshold;
+	/** Number of hiccups detected since start. */
+	int64_t hiccup_count;
 };
 
 struct wal_msg {
@@ -272,8 +318,12 @@ static void
 tx_schedule_queue(struct stailq *queue)
 {
 	struct journal_entry *req, *tmp;
-	stailq_foreach_entry_safe(req, tmp, queue, fifo)
+	stailq_foreach_entry_safe(req, tmp, queue, fifo) {
+		flightrec_record(FLIGHTREC_WAL_COMPLETE, (uintptr_t)req,
+				 req->res);
+		TNT_PROBE2(wal_write_done, (uintptr_t)req, req->res);
 		journal_async_complete(req);
+	}
 }
 
 /**
@@ -408,7 +458,7 @@ tx_notify_checkpoint(struct cmsg *msg)
 static void
 wal_writer_create(struct wal_writer *writer, enum wal_mode wal_mode,
 		  const char *wal_dirname, int64_t wal_max_size,
-		  const struct tt_uuid *instance_uuid,
+		  bool wal_direct, const struct tt_uuid *instance_uuid,
 		  wal_on_garbage_collection_f on_garbage_collection,
 		  wal_on_checkpoint_threshold_f on_checkpoint_threshold)
 {
@@ -423,14 +473,37 @@ wal_writer_create(struct wal_writer *writer, enum wal_mode wal_mode,
 
 	struct xlog_opts opts = xlog_opts_default;
 	opts.sync_is_async = true;
+	opts.direct = wal_direct;
+	opts.lsn_index = true;
 	xdir_create(&writer->wal_dir, wal_dirname, XLOG, instance_uuid, &opts);
 	xlog_clear(&writer->current_wal);
-	if (wal_mode == WAL_FSYNC)
-		writer->wal_dir.open_wflags |= O_SYNC;
+	/*
+	 * In WAL_FSYNC mode durability is provided by explicit
+	 * group fdatasync() calls in wal_write_to_disk() rather
+	 * than by O_SYNC: one sync covers a whole group of
+	 * entries instead of every write syncing on its own.
+	 */
 
 	stailq_create(&writer->rollback);
 	writer->is_in_rollback = false;
 
+	writer->sync_size = WAL_SYNC_SIZE_DEFAULT;
+	static const int64_t group_hist_buckets[] = {
+		1024, 4096, 16384, 65536, 262144, 1048576, 4194304, 16777216,
+	};
+	writer->group_hist = histogram_new(group_hist_buckets,
+					   lengthof(group_hist_buckets));
+	/* Latencies in microseconds: 1 us .. 100 s. */
+	writer->write_hist = hdr_histogram_new(1, 100 * 1000000LL, 2);
+	writer->fsync_hist = hdr_histogram_new(1, 100 * 1000000LL, 2);
+	if (writer->group_hist == NULL ||
+	    writer->write_hist == NULL || writer->fsync_hist == NULL)
+		panic("failed to allocate WAL statistics");
+	writer->hiccup_threshold = 0;
+	writer->hiccup_count = 0;
+	writer->sync_last_duration = 0;
+	writer->sync_last_time = 0;
+
 	writer->checkpoint_wal_size = 0;
 	writer->checkpoint_threshold = INT64_MAX;
 	writer->checkpoint_triggered = false;
@@ -450,6 +523,9 @@ wal_writer_create(struct wal_writer *writer, enum wal_mode wal_mode,
 static void
 wal_writer_destroy(struct wal_writer *writer)
 {
+	histogram_delete(writer->group_hist);
+	hdr_histogram_delete(writer->write_hist);
+	hdr_histogram_delete(writer->fsync_hist);
 	xdir_destroy(&writer->wal_dir);
 }
 
@@ -528,14 +604,15 @@ wal_open(struct wal_writer *writer)
 
 int
 wal_init(enum wal_mode wal_mode, const char *wal_dirname,
-	 int64_t wal_max_size, const struct tt_uuid *instance_uuid,
+	 int64_t wal_max_size, bool wal_direct,
+	 const struct tt_uuid *instance_uuid,
 	 wal_on_garbage_collection_f on_garbage_collection,
 	 wal_on_checkpoint_threshold_f on_checkpoint_threshold)
 {
 	/* Initialize the state. */
 	struct wal_writer *writer = &wal_writer_singleton;
 	wal_writer_create(writer, wal_mode, wal_dirname, wal_max_size,
-			  instance_uuid, on_garbage_collection,
+			  wal_direct, instance_uuid, on_garbage_collection,
 			  on_checkpoint_threshold);
 
 	/* Start WAL thread. */
@@ -765,6 +842,110 @@ wal_set_checkpoint_threshold(int64_t threshold)
 	fiber_set_cancellable(cancellable);
 }
 
+struct wal_set_sync_size_msg {
+	struct cbus_call_msg base;
+	int64_t sync_size;
+};
+
+static int
+wal_set_sync_size_f(struct cbus_call_msg *data)
+{
+	struct wal_writer *writer = &wal_writer_singleton;
+	struct wal_set_sync_size_msg *msg;
+	msg = (struct wal_set_sync_size_msg *)data;
+	writer->sync_size = msg->sync_size;
+	return 0;
+}
+
+void
+wal_set_sync_size(int64_t sync_size)
+{
+	struct wal_writer *writer = &wal_writer_singleton;
+	if (writer->wal_mode == WAL_NONE)
+		return;
+	struct wal_set_sync_size_msg msg;
+	msg.sync_size = sync_size;
+	bool cancellable = fiber_set_cancellable(false);
+	cbus_call(&writer->wal_pipe, &writer->tx_prio_pipe,
+		  &msg.base, wal_set_sync_size_f, NULL,
+		  TIMEOUT_INFINITY);
+	fiber_set_cancellable(cancellable);
+}
+
+struct wal_set_hiccup_threshold_msg {
+	struct cbus_call_msg base;
+	double hiccup_threshold;
+};
+
+static int
+wal_set_hiccup_threshold_f(struct cbus_call_msg *data)
+{
+	struct wal_writer *writer = &wal_writer_singleton;
+	struct wal_set_hiccup_threshold_msg *msg;
+	msg = (struct wal_set_hiccup_threshold_msg *)data;
+	writer->hiccup_threshold = msg->hiccup_threshold;
+	return 0;
+}
+
+void
+wal_set_hiccup_threshold(double threshold)
+{
+	struct wal_writer *writer = &wal_writer_singleton;
+	if (writer->wal_mode == WAL_NONE)
+		return;
+	struct wal_set_hiccup_threshold_msg msg;
+	msg.hiccup_threshold = threshold;
+	bool cancellable = fiber_set_cancellable(false);
+	cbus_call(&writer->wal_pipe, &writer->tx_prio_pipe,
+		  &msg.base, wal_set_hiccup_threshold_f, NULL,
+		  TIMEOUT_INFINITY);
+	fiber_set_cancellable(cancellable);
+}
+
+struct histogram *
+wal_group_hist(void)
+{
+	return wal_writer_singleton.group_hist;
+}
+
+struct hdr_histogram *
+wal_write_hdr_hist(void)
+{
+	return wal_writer_singleton.write_hist;
+}
+
+struct hdr_histogram *
+wal_fsync_hdr_hist(void)
+{
+	return wal_writer_singleton.fsync_hist;
+}
+
+int64_t
+wal_hiccup_count(void)
+{
+	return wal_writer_singleton.hiccup_count;
+}
+
+int64_t
+wal_checkpoint_wal_size(void)
+{
+	return wal_writer_singleton.checkpoint_wal_size;
+}
+
+double
+wal_sync_recent_duration(void)
+{
+	struct wal_writer *writer = &wal_writer_singleton;
+	double duration = writer->sync_last_duration;
+	/*
+	 * A sample expires after a second: an idle WAL must not
+	 * keep reporting an old slow fdatasync() forever.
+	 */
+	if (ev_monotonic_time() - writer->sync_last_time > 1.)
+		return 0;
+	return duration;
+}
+
 struct wal_gc_msg
 {
 	struct cbus_call_msg base;
@@ -813,6 +994,60 @@ wal_collect_garbage(const struct vclock *vclock)
 	fiber_set_cancellable(cancellable);
 }
 
+struct wal_gc_step_msg
+{
+	struct cbus_call_msg base;
+	const struct vclock *vclock;
+	int max_files;
+	int backlog;
+};
+
+static int
+wal_collect_garbage_step_f(struct cbus_call_msg *data)
+{
+	struct wal_writer *writer = &wal_writer_singleton;
+	struct wal_gc_step_msg *msg = (struct wal_gc_step_msg *)data;
+	const struct vclock *vclock = msg->vclock;
+
+	/* Clamp the boundary the same way wal_collect_garbage_f does. */
+	if (!xlog_is_open(&writer->current_wal) &&
+	    vclock_sum(vclock) >= vclock_sum(&writer->vclock)) {
+		/* The last sealed WAL can be deleted too. */
+	} else {
+		vclock = vclockset_psearch(&writer->wal_dir.index, vclock);
+	}
+	if (vclock == NULL) {
+		msg->backlog = 0;
+		return 0;
+	}
+	int64_t signature = vclock_sum(vclock);
+	for (int i = 0; i < msg->max_files; i++) {
+		if (!xdir_has_garbage(&writer->wal_dir, signature))
+			break;
+		xdir_collect_garbage(&writer->wal_dir, signature,
+				     XDIR_GC_ASYNC | XDIR_GC_REMOVE_ONE);
+	}
+	msg->backlog = xdir_gc_backlog(&writer->wal_dir, signature);
+	return 0;
+}
+
+int
+wal_collect_garbage_step(const struct vclock *vclock, int max_files)
+{
+	struct wal_writer *writer = &wal_writer_singleton;
+	if (writer->wal_mode == WAL_NONE)
+		return 0;
+	struct wal_gc_step_msg msg;
+	msg.vclock = vclock;
+	msg.max_files = max_files;
+	msg.backlog = 0;
+	bool cancellable = fiber_set_cancellable(false);
+	cbus_call(&writer->wal_pipe, &writer->tx_prio_pipe, &msg.base,
+		  wal_collect_garbage_step_f, NULL, TIMEOUT_INFINITY);
+	fiber_set_cancellable(cancellable);
+	return msg.backlog;
+}
+
 static void
 wal_notify_watchers(struct wal_writer *writer, unsigned events);
 
@@ -861,6 +1096,13 @@ wal_opt_rotate(struct wal_writer *writer)
 	 */
 	xdir_add_vclock(&writer->wal_dir, &writer->vclock);
 
+	/*
+	 * Prepare the next WAL file in advance so that the next
+	 * rotation only has to rename it into place instead of
+	 * creating and growing a file from scratch.
+	 */
+	xdir_prepare_spare(&writer->wal_dir, writer->wal_max_size);
+
 	wal_notify_watchers(writer, WAL_EVENT_ROTATE);
 	return 0;
 }
@@ -1016,6 +1258,44 @@ wal_assign_lsn(struct vclock *vclock_diff, struct vclock *base,
 		(*row)->tsn = tsn;
 }
 
+/**
+ * Make everything written so far durable with one fdatasync()
+ * and account the group in the box.stat.wal() histograms.
+ * @a group_size is the number of bytes the group has
+ * accumulated since the previous sync.
+ *
+ * @retval  0 Success.
+ * @retval -1 Sync failed, the diagnostics is set.
+ */
+static int
+wal_sync_group(struct wal_writer *writer, int64_t group_size)
+{
+	struct xlog *l = &writer->current_wal;
+	double start = ev_monotonic_time();
+	if (fdatasync(l->fd) != 0) {
+		diag_set(SystemError, "failed to sync WAL %s", l->filename);
+		return -1;
+	}
+	double end = ev_monotonic_time();
+	TNT_PROBE2(wal_fsync, group_size,
+		   (uint64_t)((end - start) * 1e9));
+	histogram_collect(writer->group_hist, group_size);
+	hdr_histogram_record(writer->fsync_hist,
+			     (int64_t) ((end - start) * 1e6));
+	if (writer->hiccup_threshold > 0 &&
+	    end - start > writer->hiccup_threshold) {
+		writer->hiccup_count++;
+		say_warn("disk hiccup: fsync of %s took %.3f sec "
+			 "(threshold %.3f sec), group size %lld bytes, "
+			 "lsn sum %lld", l->filename, end - start,
+			 writer->hiccup_threshold, (long long) group_size,
+			 (long long) vclock_sum(&writer->vclock));
+	}
+	writer->sync_last_duration = end - start;
+	writer->sync_last_time = end;
+	return 0;
+}
+
 static void
 wal_write_to_disk(struct cmsg *msg)
 {
@@ -1039,6 +1319,16 @@ wal_write_to_disk(struct cmsg *msg)
 		ERROR_INJECT_SLEEP(ERRINJ_WAL_DELAY);
 	});
 
+	if (stailq_empty(&wal_msg->commit) && stailq_empty(&wal_msg->rollback)) {
+		/*
+		 * The entries were coalesced into a preceding
+		 * batch, see wal_coalesce_queue(). The message
+		 * only travels back to tx to be freed.
+		 */
+		vclock_copy(&wal_msg->vclock, &writer->vclock);
+		return;
+	}
+
 	if (writer->is_in_rollback) {
 		/* We're rolling back a failed write. */
 		stailq_concat(&wal_msg->rollback, &wal_msg->commit);
@@ -1083,12 +1373,26 @@ wal_write_to_disk(struct cmsg *msg)
 
 	struct xlog *l = &writer->current_wal;
 
+	double write_start = ev_monotonic_time();
+	int64_t write_lsn_before = vclock_sum(&writer->vclock);
+
 	/*
 	 * Iterate over requests (transactions)
 	 */
 	int rc;
 	struct journal_entry *entry;
 	struct stailq_entry *last_committed = NULL;
+	/*
+	 * Group commit: in WAL_FSYNC mode entries are accumulated
+	 * up to sync_size bytes and made durable with a single
+	 * fdatasync() per group - one sync per batch in the common
+	 * case, several for a batch bigger than the target. An
+	 * entry only counts as committed, and the writer vclock is
+	 * only advanced, once the sync covering it has succeeded,
+	 * so a failed sync rolls back exactly the unsynced tail.
+	 */
+	bool group_commit = writer->wal_mode == WAL_FSYNC;
+	int64_t group_size = 0;
 	stailq_foreach_entry(entry, &wal_msg->commit, fifo) {
 		wal_assign_lsn(&vclock_diff, &writer->vclock,
 			       entry->rows, entry->rows + entry->n_rows);
@@ -1099,8 +1403,19 @@ wal_write_to_disk(struct cmsg *msg)
 			goto done;
 		if (rc > 0) {
 			writer->checkpoint_wal_size += rc;
-			last_committed = &entry->fifo;
-			vclock_merge(&writer->vclock, &vclock_diff);
+			if (!group_commit) {
+				last_committed = &entry->fifo;
+				vclock_merge(&writer->vclock, &vclock_diff);
+				continue;
+			}
+			group_size += rc;
+			if (group_size >= writer->sync_size) {
+				if (wal_sync_group(writer, group_size) != 0)
+					goto done;
+				last_committed = &entry->fifo;
+				vclock_merge(&writer->vclock, &vclock_diff);
+				group_size = 0;
+			}
 		}
 		/* rc == 0: the write is buffered in xlog_tx */
 	}
@@ -1109,6 +1424,10 @@ wal_write_to_disk(struct cmsg *msg)
 		goto done;
 
 	writer->checkpoint_wal_size += rc;
+	group_size += rc;
+	if (group_commit && last_committed != stailq_last(&wal_msg->commit) &&
+	    wal_sync_group(writer, group_size) != 0)
+		goto done;
 	last_committed = stailq_last(&wal_msg->commit);
 	vclock_merge(&writer->vclock, &vclock_diff);
 
@@ -1134,7 +1453,26 @@ wal_write_to_disk(struct cmsg *msg)
 		}
 	}
 
-done:
+done:;
+	/*
+	 * Account the batch write and report a disk hiccup with
+	 * the batch, i.e. the queue backlog drained into this
+	 * write, and the row range it covered.
+	 */
+	double write_duration = ev_monotonic_time() - write_start;
+	hdr_histogram_record(writer->write_hist,
+			     (int64_t) (write_duration * 1e6));
+	if (writer->hiccup_threshold > 0 &&
+	    write_duration > writer->hiccup_threshold) {
+		writer->hiccup_count++;
+		say_warn("disk hiccup: writing a WAL batch of %zu bytes "
+			 "to %s took %.3f sec (threshold %.3f sec), "
+			 "lsn sum %lld..%lld", wal_msg->approx_len,
+			 l->filename, write_duration,
+			 writer->hiccup_threshold,
+			 (long long) write_lsn_before,
+			 (long long) vclock_sum(&writer->vclock));
+	}
 	error = diag_last_error(diag_get());
 	if (error) {
 		/* Until we can pass the error to tx, log it and clear. */
@@ -1170,6 +1508,38 @@ done:
 	ERROR_INJECT_SLEEP(ERRINJ_RELAY_FASTER_THAN_TX);
 }
 
+/**
+ * Coalesce adjacent WAL write batches fetched in one queue
+ * drain: move the entries of each follower into the first batch
+ * of its run, so that a single write pass - and in WAL_FSYNC
+ * mode a single group fdatasync() - covers them all and tx gets
+ * the whole completion range at once. The emptied followers
+ * still travel their route so that tx can free them. Only
+ * adjacent batches are merged: reordering writes around other
+ * messages, e.g. a checkpoint request, would change which rows
+ * the checkpoint vclock covers.
+ */
+static void
+wal_coalesce_queue(struct stailq *queue)
+{
+	struct wal_msg *first = NULL;
+	struct cmsg *msg;
+	stailq_foreach_entry(msg, queue, fifo) {
+		struct wal_msg *batch = wal_msg(msg);
+		if (batch == NULL) {
+			first = NULL;
+			continue;
+		}
+		if (first == NULL) {
+			first = batch;
+			continue;
+		}
+		stailq_concat(&first->commit, &batch->commit);
+		first->approx_len += batch->approx_len;
+		batch->approx_len = 0;
+	}
+}
+
 /** WAL writer main loop.  */
 static int
 wal_writer_f(va_list ap)
@@ -1189,7 +1559,23 @@ wal_writer_f(va_list ap)
 	 */
 	cpipe_create(&writer->tx_prio_pipe, "tx_prio");
 
-	cbus_loop(&endpoint);
+	/*
+	 * The endpoint loop is open-coded instead of cbus_loop()
+	 * so that all write batches of a drain can be coalesced
+	 * before they are delivered, see wal_coalesce_queue().
+	 */
+	while (true) {
+		struct stailq queue;
+		stailq_create(&queue);
+		cbus_endpoint_fetch(&endpoint, &queue);
+		wal_coalesce_queue(&queue);
+		struct cmsg *msg, *msg_next;
+		stailq_foreach_entry_safe(msg, msg_next, &queue, fifo)
+			cmsg_deliver(msg);
+		if (fiber_is_cancelled())
+			break;
+		fiber_yield();
+	}
 
 	/*
 	 * Create a new empty WAL on shutdown so that we don't
@@ -1227,6 +1613,9 @@ wal_write_async(struct journal *journal, struct journal_entry *entry)
 {
 	struct wal_writer *writer = (struct wal_writer *) journal;
 
+	flightrec_record(FLIGHTREC_WAL_SUBMIT, (uintptr_t)entry,
+			 entry->approx_len);
+	TNT_PROBE2(wal_write, (uintptr_t)entry, entry->approx_len);
 	ERROR_INJECT(ERRINJ_WAL_IO, {
 		goto fail;
 	});
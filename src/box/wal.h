@@ -40,6 +40,8 @@
 struct fiber;
 struct wal_writer;
 struct tt_uuid;
+struct histogram;
+struct hdr_histogram;
 
 enum wal_mode { WAL_NONE = 0, WAL_WRITE, WAL_FSYNC, WAL_MODE_MAX };
 
@@ -82,7 +84,8 @@ typedef void (*wal_on_checkpoint_threshold_f)(void);
  */
 int
 wal_init(enum wal_mode wal_mode, const char *wal_dirname,
-	 int64_t wal_max_size, const struct tt_uuid *instance_uuid,
+	 int64_t wal_max_size, bool wal_direct,
+	 const struct tt_uuid *instance_uuid,
 	 wal_on_garbage_collection_f on_garbage_collection,
 	 wal_on_checkpoint_threshold_f on_checkpoint_threshold);
 
@@ -237,6 +240,69 @@ wal_commit_checkpoint(struct wal_checkpoint *checkpoint);
 void
 wal_set_checkpoint_threshold(int64_t threshold);
 
+/**
+ * Set the group commit target, in bytes: how much WAL data may
+ * accumulate before an fdatasync() is issued in WAL_FSYNC mode,
+ * see box.cfg.wal_sync_size.
+ */
+void
+wal_set_sync_size(int64_t sync_size);
+
+/**
+ * Set the disk hiccup threshold, in seconds: a single WAL batch
+ * write or fdatasync() slower than this is counted and reported
+ * with attribution, see box.cfg.wal_hiccup_threshold. A value
+ * <= 0 disables detection.
+ */
+void
+wal_set_hiccup_threshold(double threshold);
+
+/**
+ * Amount of WAL data written since the last checkpoint, in bytes.
+ * Updated in the WAL thread, read without synchronization, for
+ * heuristics and statistics only.
+ */
+int64_t
+wal_checkpoint_wal_size(void);
+
+/**
+ * Histogram of group commit sizes, in bytes, one sample per
+ * group fdatasync(). Collected in the WAL thread, read without
+ * synchronization for statistics only.
+ */
+struct histogram *
+wal_group_hist(void);
+
+/**
+ * HDR histogram of WAL batch write latencies, in microseconds.
+ * Collected in the WAL thread, read without synchronization for
+ * statistics only.
+ */
+struct hdr_histogram *
+wal_write_hdr_hist(void);
+
+/**
+ * HDR histogram of fdatasync() latencies, in microseconds. Only
+ * populated in WAL_FSYNC mode.
+ */
+struct hdr_histogram *
+wal_fsync_hdr_hist(void);
+
+/**
+ * Number of disk hiccups - batch writes or fdatasync() calls
+ * slower than the configured threshold - detected since start.
+ */
+int64_t
+wal_hiccup_count(void);
+
+/**
+ * Duration of the most recent WAL fdatasync(), in seconds, or 0
+ * if none completed within the last second. Updated in the WAL
+ * thread, read without synchronization, for heuristics only.
+ */
+double
+wal_sync_recent_duration(void);
+
 /**
  * Remove WAL files that are not needed by consumers reading
  * rows at @vclock or newer.
@@ -244,6 +310,14 @@ wal_set_checkpoint_threshold(int64_t threshold);
 void
 wal_collect_garbage(const struct vclock *vclock);
 
+/**
+ * Same as wal_collect_garbage(), but remove at most @max_files
+ * files. Returns the number of obsolete files still left, so
+ * the caller can pace the deletion, see gc.c.
+ */
+int
+wal_collect_garbage_step(const struct vclock *vclock, int max_files);
+
 void
 wal_init_vy_log(void);
 
@@ -96,6 +96,7 @@ const struct xlog_opts xlog_opts_default = {
 	.free_cache = false,
 	.sync_is_async = false,
 	.no_compression = false,
+	.zstd_level = 3,
 };
 
 /* {{{ struct xlog_meta */
@@ -676,6 +677,106 @@ xdir_complete_gc(eio_req *req)
 	return 0;
 }
 
+/** Name of the spare file, see xdir_prepare_spare(). */
+#define spare_filename "spare" inprogress_suffix
+
+/** Format the path to the spare file of a directory. */
+static void
+xdir_format_spare_path(struct xdir *dir, char *path, size_t size)
+{
+	snprintf(path, size, "%s/%s", dir->dirname, spare_filename);
+}
+
+/** Context of an eio task preparing a spare file. */
+struct xdir_spare_task {
+	/** The directory the spare file is prepared for. */
+	struct xdir *dir;
+	/** Path to the spare file. */
+	char path[PATH_MAX];
+	/**
+	 * How many bytes to preallocate. On completion - how
+	 * many bytes were actually preallocated (0 if fallocate
+	 * is not supported).
+	 */
+	size_t size;
+	/** File create mode. */
+	mode_t mode;
+};
+
+/**
+ * Runs in an eio thread: create (or truncate, if the file was
+ * recycled from an old WAL) the spare file and preallocate disk
+ * space for it.
+ */
+static void
+xdir_prepare_spare_cb(eio_req *req)
+{
+	struct xdir_spare_task *task = (struct xdir_spare_task *)req->data;
+	req->result = 0;
+	int fd = open(task->path, O_RDWR | O_CREAT | O_TRUNC, task->mode);
+	if (fd < 0)
+		goto error;
+#ifdef HAVE_FALLOCATE
+	/*
+	 * Keep the file size zero - all readers stop at EOF, so
+	 * whatever is left in the preallocated blocks can never
+	 * be mistaken for valid xlog data.
+	 */
+	if (fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, task->size) != 0) {
+		if (errno != ENOSYS && errno != EOPNOTSUPP) {
+			close(fd);
+			unlink(task->path);
+			goto error;
+		}
+		task->size = 0;
+	}
+#else
+	task->size = 0;
+#endif /* HAVE_FALLOCATE */
+	close(fd);
+	return;
+error:
+	req->errorno = errno;
+	req->result = -1;
+}
+
+/** Called on the caller's thread when a spare file is ready. */
+static int
+xdir_complete_spare(eio_req *req)
+{
+	struct xdir_spare_task *task = (struct xdir_spare_task *)req->data;
+	struct xdir *dir = task->dir;
+	assert(dir->spare_in_progress);
+	dir->spare_in_progress = false;
+	if (req->result == 0) {
+		dir->spare_ready = true;
+		dir->spare_allocated = task->size;
+	} else {
+		errno = req->errorno;
+		say_syserror("error while preparing %s", task->path);
+	}
+	free(task);
+	return 0;
+}
+
+void
+xdir_prepare_spare(struct xdir *dir, size_t size)
+{
+	dir->spare_size = size;
+	if (dir->spare_ready || dir->spare_in_progress)
+		return;
+	struct xdir_spare_task *task =
+		(struct xdir_spare_task *)malloc(sizeof(*task));
+	if (task == NULL)
+		return; /* Not critical, retried on the next rotation. */
+	task->dir = dir;
+	task->size = size;
+	task->mode = dir->mode;
+	xdir_format_spare_path(dir, task->path, sizeof(task->path));
+	dir->spare_in_progress = true;
+	eio_custom(xdir_prepare_spare_cb, 0, xdir_complete_spare, task);
+}
+
 void
 xdir_collect_garbage(struct xdir *dir, int64_t signature, unsigned flags)
 {
@@ -684,10 +785,37 @@ xdir_collect_garbage(struct xdir *dir, int64_t signature, unsigned flags)
 	       vclock_sum(vclock) < signature) {
 		const char *filename =
 			xdir_format_filename(dir, vclock_sum(vclock), NONE);
-		if (flags & XDIR_GC_ASYNC)
+		if (dir->opts.lsn_index) {
+			/* Collect the sidecar LSN index, if any. */
+			char idx_path[PATH_MAX];
+			snprintf(idx_path, sizeof(idx_path), "%s.idx",
+				 filename);
+			if (flags & XDIR_GC_ASYNC)
+				eio_unlink(idx_path, 0, xdir_complete_gc, NULL);
+			else
+				xdir_say_gc(unlink(idx_path), errno, idx_path);
+		}
+		bool recycle = dir->spare_size > 0 && !dir->spare_ready &&
+			       !dir->spare_in_progress;
+		if (recycle) {
+			char spare_path[PATH_MAX];
+			xdir_format_spare_path(dir, spare_path,
+					       sizeof(spare_path));
+			recycle = rename(filename, spare_path) == 0;
+		}
+		if (recycle) {
+			/*
+			 * Donate the old file to the spare slot
+			 * instead of unlinking it: truncation and
+			 * preallocation happen in an eio thread.
+			 */
+			say_info("recycled %s", filename);
+			xdir_prepare_spare(dir, dir->spare_size);
+		} else if (flags & XDIR_GC_ASYNC) {
 			eio_unlink(filename, 0, xdir_complete_gc, NULL);
-		else
+		} else {
 			xdir_say_gc(unlink(filename), errno, filename);
+		}
 		vclockset_remove(&dir->index, vclock);
 		free(vclock);
 
@@ -696,6 +824,18 @@ xdir_collect_garbage(struct xdir *dir, int64_t signature, unsigned flags)
 	}
 }
 
+int
+xdir_gc_backlog(struct xdir *dir, int64_t signature)
+{
+	int backlog = 0;
+	struct vclock *vclock = vclockset_first(&dir->index);
+	while (vclock != NULL && vclock_sum(vclock) < signature) {
+		backlog++;
+		vclock = vclockset_next(&dir->index, vclock);
+	}
+	return backlog;
+}
+
 void
 xdir_collect_inprogress(struct xdir *xdir)
 {
@@ -772,6 +912,8 @@ xlog_init(struct xlog *xlog, const struct xlog_opts *opts)
 	xlog->is_autocommit = true;
 	obuf_create(&xlog->obuf, &cord()->slabc, XLOG_TX_AUTOCOMMIT_THRESHOLD);
 	obuf_create(&xlog->zbuf, &cord()->slabc, XLOG_TX_AUTOCOMMIT_THRESHOLD);
+	obuf_create(&xlog->idx_buf, &cord()->slabc, XLOG_TX_AUTOCOMMIT_THRESHOLD);
+	vclock_create(&xlog->idx_vclock);
 	if (!opts->no_compression) {
 		xlog->zctx = ZSTD_createCCtx();
 		if (xlog->zctx == NULL) {
@@ -797,14 +939,97 @@ xlog_destroy(struct xlog *xlog)
 	assert(xlog->zbuf.slabc == &cord()->slabc);
 	obuf_destroy(&xlog->obuf);
 	obuf_destroy(&xlog->zbuf);
+	obuf_destroy(&xlog->idx_buf);
 	ZSTD_freeCCtx(xlog->zctx);
+	free(xlog->direct_buf);
 	TRASH(xlog);
 	xlog->fd = -1;
 }
 
-int
-xlog_create(struct xlog *xlog, const char *name, int flags,
-	    const struct xlog_meta *meta, const struct xlog_opts *opts)
+#ifdef O_DIRECT
+/**
+ * Write a vector at the current logical end of an O_DIRECT file.
+ *
+ * The vector is copied into an aligned bounce buffer, prepended
+ * with the contents of the last partial sector of the file and
+ * zero padded up to the next sector boundary, so that the
+ * physical write offset, size and memory are all sector aligned
+ * as O_DIRECT requires. The padding is rewritten with real data
+ * by the next write; at the end of the file readers, which stop
+ * at EOF or at the eof marker, treat it like a torn tail.
+ *
+ * Like fio_writevn(), doesn't update log->offset.
+ *
+ * @retval -1 error
+ * @retval >= 0 the number of logical bytes written
+ */
+static ssize_t
+xlog_direct_writev(struct xlog *log, struct iovec *iov, int iovcnt)
+{
+	off_t phys_offset = log->offset & ~((off_t)XLOG_SECTOR_SIZE - 1);
+	size_t tail_len = log->offset - phys_offset;
+	size_t len = tail_len;
+	for (int i = 0; i < iovcnt; i++)
+		len += iov[i].iov_len;
+	size_t phys_len = (len + XLOG_SECTOR_SIZE - 1) &
+			  ~((size_t)XLOG_SECTOR_SIZE - 1);
+	if (phys_len > log->direct_buf_size) {
+		size_t size = MAX(log->direct_buf_size, XLOG_SECTOR_SIZE);
+		while (size < phys_len)
+			size *= 2;
+		void *buf;
+		if (posix_memalign(&buf, XLOG_SECTOR_SIZE, size) != 0) {
+			diag_set(OutOfMemory, size, "posix_memalign",
+				 "xlog direct buffer");
+			return -1;
+		}
+		free(log->direct_buf);
+		log->direct_buf = (char *)buf;
+		log->direct_buf_size = size;
+	}
+	char *pos = log->direct_buf;
+	memcpy(pos, log->direct_tail, tail_len);
+	pos += tail_len;
+	for (int i = 0; i < iovcnt; i++) {
+		memcpy(pos, iov[i].iov_base, iov[i].iov_len);
+		pos += iov[i].iov_len;
+	}
+	memset(pos, 0, phys_len - len);
+
+	size_t written = 0;
+	while (written < phys_len) {
+		ssize_t n = pwrite(log->fd, log->direct_buf + written,
+				   phys_len - written, phys_offset + written);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			diag_set(SystemError, "failed to write to '%s' file",
+				 log->filename);
+			return -1;
+		}
+		/* Direct writes complete in sector multiples. */
+		assert(n % XLOG_SECTOR_SIZE == 0);
+		written += n;
+	}
+
+	/* Remember the new partial sector contents. */
+	size_t new_tail_len = len & (XLOG_SECTOR_SIZE - 1);
+	memcpy(log->direct_tail, log->direct_buf + (len - new_tail_len),
+	       new_tail_len);
+	return len - tail_len;
+}
+#endif /* O_DIRECT */
+
+/**
+ * Implementation of xlog_create(). If @reuse is set, the
+ * .inprogress file is expected to exist already (a recycled
+ * spare file renamed into place, see xdir_prepare_spare())
+ * and is opened instead of created.
+ */
+static int
+xlog_create_impl(struct xlog *xlog, const char *name, int flags,
+		 const struct xlog_meta *meta, const struct xlog_opts *opts,
+		 bool reuse)
 {
 	char meta_buf[XLOG_META_LEN_MAX];
 	int meta_len;
@@ -823,6 +1048,7 @@ xlog_create(struct xlog *xlog, const char *name, int flags,
 		goto err;
 
 	xlog->meta = *meta;
+	vclock_copy(&xlog->idx_vclock, &xlog->meta.vclock);
 	xlog->is_inprogress = true;
 	snprintf(xlog->filename, sizeof(xlog->filename), "%s%s", name, inprogress_suffix);
 
@@ -833,7 +1059,20 @@ xlog_create(struct xlog *xlog, const char *name, int flags,
 		goto err;
 	}
 
-	flags |= O_RDWR | O_CREAT | O_EXCL;
+	if (reuse)
+		flags |= O_RDWR;
+	else
+		flags |= O_RDWR | O_CREAT | O_EXCL;
+
+#ifdef O_DIRECT
+	xlog->direct = opts->direct;
+	if (xlog->direct)
+		flags |= O_DIRECT;
+#else
+	if (opts->direct)
+		say_warn("%s: O_DIRECT is not supported on this platform, "
+			 "proceeding without it", name);
+#endif /* O_DIRECT */
 
 	/*
 	 * Open the <lsn>.<suffix>.inprogress file.
@@ -846,6 +1085,15 @@ xlog_create(struct xlog *xlog, const char *name, int flags,
 	 * replication.
 	 */
 	xlog->fd = open(xlog->filename, flags, 0644);
+#ifdef O_DIRECT
+	if (xlog->fd < 0 && xlog->direct && errno == EINVAL) {
+		/* The filesystem does not support O_DIRECT. */
+		say_warn("%s: O_DIRECT is not supported by the filesystem, "
+			 "proceeding without it", xlog->filename);
+		xlog->direct = false;
+		xlog->fd = open(xlog->filename, flags & ~O_DIRECT, 0644);
+	}
+#endif /* O_DIRECT */
 	if (xlog->fd < 0) {
 		say_syserror("open, [%s]", xlog->filename);
 		diag_set(SystemError, "failed to create file '%s'",
@@ -861,6 +1109,15 @@ xlog_create(struct xlog *xlog, const char *name, int flags,
 	assert(meta_len < (int)sizeof(meta_buf));
 
 	/* Write metadata */
+#ifdef O_DIRECT
+	if (xlog->direct) {
+		struct iovec iov;
+		iov.iov_base = meta_buf;
+		iov.iov_len = meta_len;
+		if (xlog_direct_writev(xlog, &iov, 1) < 0)
+			goto err_write;
+	} else
+#endif /* O_DIRECT */
 	if (fio_writen(xlog->fd, meta_buf, meta_len) < 0) {
 		diag_set(SystemError, "%s: failed to write xlog meta",
 			 xlog->filename);
@@ -878,6 +1135,13 @@ err:
 	return -1;
 }
 
+int
+xlog_create(struct xlog *xlog, const char *name, int flags,
+	    const struct xlog_meta *meta, const struct xlog_opts *opts)
+{
+	return xlog_create_impl(xlog, name, flags, meta, opts, false);
+}
+
 int
 xlog_open(struct xlog *xlog, const char *name, const struct xlog_opts *opts)
 {
@@ -995,10 +1259,37 @@ xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
 			 vclock, prev_vclock);
 
 	const char *filename = xdir_format_filename(dir, signature, NONE);
-	if (xlog_create(xlog, filename, dir->open_wflags, &meta,
-			&dir->opts) != 0)
+
+	/*
+	 * If a preallocated spare file is ready, rename it into
+	 * place and reuse it instead of creating the file from
+	 * scratch: the first writes then don't pay for filesystem
+	 * block allocation and inode creation, see
+	 * xdir_prepare_spare().
+	 */
+	bool reuse = dir->spare_ready;
+	if (reuse) {
+		char spare_path[PATH_MAX];
+		char in_progress[PATH_MAX];
+		xdir_format_spare_path(dir, spare_path, sizeof(spare_path));
+		snprintf(in_progress, sizeof(in_progress), "%s%s",
+			 filename, inprogress_suffix);
+		if (rename(spare_path, in_progress) != 0) {
+			say_syserror("can't rename %s to %s", spare_path,
+				     in_progress);
+			reuse = false;
+		}
+		dir->spare_ready = false;
+	}
+
+	if (xlog_create_impl(xlog, filename, dir->open_wflags, &meta,
+			     &dir->opts, reuse) != 0)
 		return -1;
 
+	/* Account the disk space preallocated in the spare file. */
+	if (reuse && dir->spare_allocated > (size_t)xlog->offset)
+		xlog->allocated = dir->spare_allocated - xlog->offset;
+
 	/* Rename xlog file */
 	if (dir->suffix != INPROGRESS && xlog_rename(xlog)) {
 		int save_errno = errno;
@@ -1095,7 +1386,17 @@ xlog_tx_write_plain(struct xlog *log)
 		return -1;
 	});
 
-	ssize_t written = fio_writevn(log->fd, log->obuf.iov, log->obuf.pos + 1);
+	ssize_t written;
+#ifdef O_DIRECT
+	if (log->direct) {
+		written = xlog_direct_writev(log, log->obuf.iov,
+					     log->obuf.pos + 1);
+		if (written < 0)
+			return -1;
+		return obuf_size(&log->obuf);
+	}
+#endif /* O_DIRECT */
+	written = fio_writevn(log->fd, log->obuf.iov, log->obuf.pos + 1);
 	if (written < 0) {
 		diag_set(SystemError, "failed to write to '%s' file",
 			 log->filename);
@@ -1117,8 +1418,7 @@ xlog_tx_write_zstd(struct xlog *log)
 
 	uint32_t crc32c = 0;
 	struct iovec *iov;
-	/* 3 is compression level. */
-	ZSTD_compressBegin(log->zctx, 3);
+	ZSTD_compressBegin(log->zctx, log->opts.zstd_level);
 	size_t offset = XLOG_FIXHEADER_SIZE;
 	for (iov = log->obuf.iov; iov->iov_len; ++iov) {
 		/* Estimate max output buffer size. */
@@ -1185,6 +1485,16 @@ xlog_tx_write_zstd(struct xlog *log)
 	});
 
 	ssize_t written;
+#ifdef O_DIRECT
+	if (log->direct) {
+		written = xlog_direct_writev(log, log->zbuf.iov,
+					     log->zbuf.pos + 1);
+		if (written < 0)
+			goto error;
+		obuf_reset(&log->zbuf);
+		return written;
+	}
+#endif /* O_DIRECT */
 	written = fio_writevn(log->fd, log->zbuf.iov,
 			      log->zbuf.pos + 1);
 	if (written < 0) {
@@ -1204,6 +1514,33 @@ error:
 #define SYNC_ROUND_DOWN(size)	((size) & ~(4096 - 1))
 #define SYNC_ROUND_UP(size)	(SYNC_ROUND_DOWN(size + SYNC_MASK))
 
+/**
+ * Append an entry to the in-memory LSN index: all rows written
+ * before the current file offset are covered by idx_vclock. The
+ * entries are dumped to the sidecar index file when the xlog is
+ * closed, see xlog_write_index().
+ */
+static void
+xlog_tx_index(struct xlog *log)
+{
+	char entry[VCLOCK_STR_LEN_MAX + 32];
+	int len = snprintf(entry, sizeof(entry), "%lld %s\n",
+			   (long long)log->offset,
+			   vclock_to_string(&log->idx_vclock));
+	assert(len < (int)sizeof(entry));
+	char *ptr = obuf_alloc(&log->idx_buf, len);
+	if (ptr == NULL) {
+		/* The index is advisory, just drop it. */
+		obuf_reset(&log->idx_buf);
+		log->opts.lsn_index = false;
+		return;
+	}
+	memcpy(ptr, entry, len);
+}
+
+static ssize_t
+xlog_tx_written(struct xlog *log, ssize_t written, int64_t row_count);
+
 /**
  * Writes xlog batch to file
  */
@@ -1226,6 +1563,22 @@ xlog_tx_write(struct xlog *log)
 	});
 
 	obuf_reset(&log->obuf);
+	int64_t row_count = log->tx_rows;
+	log->tx_rows = 0;
+	return xlog_tx_written(log, written, row_count);
+}
+
+/**
+ * Account a tx block write: handle a failed write, advance the
+ * file position and row count, and sync/throttle per the
+ * configured intervals.
+ *
+ * @retval -1 error
+ * @retval >= 0 the number of bytes written
+ */
+static ssize_t
+xlog_tx_written(struct xlog *log, ssize_t written, int64_t row_count)
+{
 	/*
 	 * Simplify recovery after a temporary write failure:
 	 * truncate the file to the best known good write
@@ -1243,8 +1596,9 @@ xlog_tx_write(struct xlog *log)
 	else
 		log->allocated = 0;
 	log->offset += written;
-	log->rows += log->tx_rows;
-	log->tx_rows = 0;
+	log->rows += row_count;
+	if (log->opts.lsn_index)
+		xlog_tx_index(log);
 	if ((log->opts.sync_interval && log->offset >=
 	    (off_t)(log->synced_size + log->opts.sync_interval)) ||
 	    (log->opts.rate_limit && log->offset >=
@@ -1308,6 +1662,19 @@ xlog_write_row(struct xlog *log, const struct xrow_header *packet)
 		}
 	}
 
+	if (log->opts.lsn_index && packet->replica_id != 0 &&
+	    packet->lsn > vclock_get(&log->idx_vclock, packet->replica_id)) {
+		/*
+		 * Keep an upper bound of the vclock of the rows
+		 * written so far for the LSN index. A row that
+		 * fails to be written may leave the bound too
+		 * high, which is safe: a seek never lands past
+		 * a row the reader still needs.
+		 */
+		vclock_follow(&log->idx_vclock, packet->replica_id,
+			      packet->lsn);
+	}
+
 	struct obuf_svp svp = obuf_create_svp(&log->obuf);
 	size_t page_offset = obuf_size(&log->obuf);
 	/** encode row into iovec */
@@ -1348,6 +1715,208 @@ xlog_write_row(struct xlog *log, const struct xrow_header *packet)
 	return row_size;
 }
 
+int
+xlog_tx_encoder_create(struct xlog_tx_encoder *encoder,
+		       const struct xlog_opts *opts)
+{
+	obuf_create(&encoder->obuf, &cord()->slabc,
+		    XLOG_TX_AUTOCOMMIT_THRESHOLD);
+	encoder->zctx = NULL;
+	if (!opts->no_compression) {
+		encoder->zctx = ZSTD_createCCtx();
+		if (encoder->zctx == NULL) {
+			diag_set(OutOfMemory, sizeof(ZSTD_CCtx), "malloc",
+				 "zstd context");
+			obuf_destroy(&encoder->obuf);
+			return -1;
+		}
+	}
+	encoder->opts = *opts;
+	encoder->tx_rows = 0;
+	return 0;
+}
+
+void
+xlog_tx_encoder_destroy(struct xlog_tx_encoder *encoder)
+{
+	obuf_destroy(&encoder->obuf);
+	ZSTD_freeCCtx(encoder->zctx);
+}
+
+size_t
+xlog_tx_encoder_size(const struct xlog_tx_encoder *encoder)
+{
+	return obuf_size((struct obuf *)&encoder->obuf);
+}
+
+ssize_t
+xlog_tx_encoder_add_row(struct xlog_tx_encoder *encoder,
+			const struct xrow_header *packet)
+{
+	struct obuf *obuf = &encoder->obuf;
+	/*
+	 * Reserve space for a fixheader when adding the first
+	 * row, just like xlog_write_row(). It is populated at
+	 * flush.
+	 */
+	if (obuf_size(obuf) == 0) {
+		if (!obuf_alloc(obuf, XLOG_FIXHEADER_SIZE)) {
+			diag_set(OutOfMemory, XLOG_FIXHEADER_SIZE,
+				 "runtime arena", "xlog tx output buffer");
+			return -1;
+		}
+	}
+	struct obuf_svp svp = obuf_create_svp(obuf);
+	size_t page_offset = obuf_size(obuf);
+	/** encode row into iovec */
+	struct iovec iov[XROW_IOVMAX];
+	/** don't write sync to the disk */
+	int iovcnt = xrow_header_encode(packet, 0, iov, 0);
+	if (iovcnt < 0)
+		return -1;
+	for (int i = 0; i < iovcnt; ++i) {
+		if (obuf_dup(obuf, iov[i].iov_base, iov[i].iov_len) <
+		    iov[i].iov_len) {
+			diag_set(OutOfMemory, iov[i].iov_len,
+				 "runtime arena", "xlog tx output buffer");
+			obuf_rollback_to_svp(obuf, &svp);
+			return -1;
+		}
+	}
+	assert(iovcnt <= XROW_IOVMAX);
+	encoder->tx_rows++;
+	return obuf_size(obuf) - page_offset;
+}
+
+int
+xlog_tx_encoder_flush(struct xlog_tx_encoder *encoder, char **data,
+		      size_t *size, int64_t *row_count)
+{
+	struct obuf *obuf = &encoder->obuf;
+	if (obuf_size(obuf) <= XLOG_FIXHEADER_SIZE) {
+		*data = NULL;
+		*size = 0;
+		*row_count = 0;
+		return 0;
+	}
+	char *buf;
+	size_t buf_size;
+	char *pos;
+	uint32_t crc32c = 0;
+	struct iovec *iov;
+	if (encoder->zctx != NULL &&
+	    obuf_size(obuf) >= XLOG_TX_COMPRESS_THRESHOLD) {
+		/* Upper bound of the compressed block size. */
+		buf_size = XLOG_FIXHEADER_SIZE;
+		size_t offset = XLOG_FIXHEADER_SIZE;
+		for (iov = obuf->iov; iov->iov_len; ++iov) {
+			buf_size += ZSTD_compressBound(iov->iov_len - offset);
+			offset = 0;
+		}
+		buf = (char *)malloc(buf_size);
+		if (buf == NULL) {
+			diag_set(OutOfMemory, buf_size, "malloc",
+				 "xlog tx block");
+			return -1;
+		}
+		pos = buf + XLOG_FIXHEADER_SIZE;
+		ZSTD_compressBegin(encoder->zctx, encoder->opts.zstd_level);
+		offset = XLOG_FIXHEADER_SIZE;
+		for (iov = obuf->iov; iov->iov_len; ++iov) {
+			size_t (*fcompress)(ZSTD_CCtx *, void *, size_t,
+					    const void *, size_t);
+			/*
+			 * If it's the last iov or the next one is
+			 * empty, end the stream.
+			 */
+			if (iov == obuf->iov + obuf->pos ||
+			    !(iov + 1)->iov_len)
+				fcompress = ZSTD_compressEnd;
+			else
+				fcompress = ZSTD_compressContinue;
+			size_t zsize = fcompress(encoder->zctx, pos,
+						 buf + buf_size - pos,
+						 (char *)iov->iov_base + offset,
+						 iov->iov_len - offset);
+			if (ZSTD_isError(zsize)) {
+				diag_set(ClientError, ER_COMPRESSION,
+					 ZSTD_getErrorName(zsize));
+				free(buf);
+				return -1;
+			}
+			crc32c = crc32_calc(crc32c, pos, zsize);
+			pos += zsize;
+			offset = 0;
+		}
+		*(log_magic_t *)buf = zrow_marker;
+	} else {
+		buf_size = obuf_size(obuf);
+		buf = (char *)malloc(buf_size);
+		if (buf == NULL) {
+			diag_set(OutOfMemory, buf_size, "malloc",
+				 "xlog tx block");
+			return -1;
+		}
+		pos = buf;
+		for (iov = obuf->iov; iov->iov_len; ++iov) {
+			memcpy(pos, iov->iov_base, iov->iov_len);
+			pos += iov->iov_len;
+		}
+		crc32c = crc32_calc(0, buf + XLOG_FIXHEADER_SIZE,
+				    buf_size - XLOG_FIXHEADER_SIZE);
+		*(log_magic_t *)buf = row_marker;
+	}
+	char *d = buf + sizeof(log_magic_t);
+	d = mp_encode_uint(d, (size_t)(pos - buf) - XLOG_FIXHEADER_SIZE);
+	/* Encode crc32 for previous row */
+	d = mp_encode_uint(d, 0);
+	/* Encode crc32 for current row */
+	d = mp_encode_uint(d, crc32c);
+	/* Encode padding */
+	ssize_t padding = XLOG_FIXHEADER_SIZE - (d - buf);
+	if (padding > 0) {
+		d = mp_encode_strl(d, padding - 1);
+		if (padding > 1) {
+			memset(d, 0, padding - 1);
+			d += padding - 1;
+		}
+	}
+	*data = buf;
+	*size = pos - buf;
+	*row_count = encoder->tx_rows;
+	encoder->tx_rows = 0;
+	obuf_reset(obuf);
+	return 0;
+}
+
+ssize_t
+xlog_write_block(struct xlog *log, const char *data, size_t size,
+		 int64_t row_count)
+{
+	assert(obuf_size(&log->obuf) == 0);
+	assert(!log->opts.lsn_index);
+	struct iovec iov;
+	iov.iov_base = (void *)data;
+	iov.iov_len = size;
+	ssize_t written;
+#ifdef O_DIRECT
+	if (log->direct) {
+		written = xlog_direct_writev(log, &iov, 1);
+		if (written >= 0)
+			written = size;
+		return xlog_tx_written(log, written, row_count);
+	}
+#endif /* O_DIRECT */
+	written = fio_writevn(log->fd, &iov, 1);
+	if (written < 0) {
+		diag_set(SystemError, "failed to write to '%s' file",
+			 log->filename);
+	} else {
+		written = size;
+	}
+	return xlog_tx_written(log, written, row_count);
+}
+
 /**
  * Begin a multi-statement xlog transaction. All xrow objects
  * of a single transaction share the same header and checksum
@@ -1450,6 +2019,26 @@ xlog_write_eof(struct xlog *l)
 		return -1;
 	}
 
+#ifdef O_DIRECT
+	if (l->direct) {
+		struct iovec iov;
+		iov.iov_base = (void *)&eof_marker;
+		iov.iov_len = sizeof(eof_marker);
+		if (xlog_direct_writev(l, &iov, 1) < 0)
+			return -1;
+		/*
+		 * Cut the sector padding off so that the eof
+		 * marker is the last thing in the file and
+		 * recovery doesn't complain about data after it.
+		 */
+		if (ftruncate(l->fd, l->offset + sizeof(eof_marker)) < 0) {
+			diag_set(SystemError, "ftruncate() failed");
+			return -1;
+		}
+		return 0;
+	}
+#endif /* O_DIRECT */
+
 	if (fio_writen(l->fd, &eof_marker, sizeof(eof_marker)) < 0) {
 		diag_set(SystemError, "write() failed");
 		return -1;
@@ -1457,6 +2046,33 @@ xlog_write_eof(struct xlog *l)
 	return 0;
 }
 
+/**
+ * Dump the LSN index collected while writing to the sidecar
+ * index file (<xlog name>.idx). Best effort: the index is
+ * advisory and readers fall back to a sequential scan when it
+ * is missing, see xlog_cursor_seek_vclock(). A torn index is
+ * not a problem either: entries are ordered, so any prefix of
+ * the file is a valid index.
+ */
+static void
+xlog_write_index(struct xlog *l)
+{
+	if (l->is_inprogress || obuf_size(&l->idx_buf) == 0)
+		return;
+	char path[PATH_MAX];
+	snprintf(path, sizeof(path), "%s.idx", l->filename);
+	int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		say_syserror("failed to create %s", path);
+		return;
+	}
+	if (fio_writevn(fd, l->idx_buf.iov, l->idx_buf.pos + 1) < 0) {
+		say_syserror("failed to write %s", path);
+		unlink(path);
+	}
+	close(fd);
+}
+
 int
 xlog_close(struct xlog *l, bool reuse_fd)
 {
@@ -1473,6 +2089,9 @@ xlog_close(struct xlog *l, bool reuse_fd)
 	 */
 	xlog_sync(l);
 
+	if (l->opts.lsn_index)
+		xlog_write_index(l);
+
 	if (!reuse_fd) {
 		rc = close(l->fd);
 		if (rc < 0)
@@ -1854,8 +2473,345 @@ xlog_cursor_find_tx_magic(struct xlog_cursor *i)
 	return 0;
 }
 
-int
-xlog_cursor_next_tx(struct xlog_cursor *i)
+void
+xlog_cursor_seek_vclock(struct xlog_cursor *cursor,
+			const struct vclock *vclock)
+{
+	assert(cursor->state == XLOG_CURSOR_ACTIVE);
+	if (cursor->fd < 0)
+		return;
+	char path[PATH_MAX];
+	snprintf(path, sizeof(path), "%s.idx", cursor->name);
+	FILE *f = fopen(path, "r");
+	if (f == NULL)
+		return;
+	/*
+	 * Entries are ordered by both offset and vclock, so the
+	 * target position is the last entry covered by the given
+	 * vclock; the first entry that is not stops the scan.
+	 */
+	off_t offset = -1;
+	char line[VCLOCK_STR_LEN_MAX + 32];
+	while (fgets(line, sizeof(line), f) != NULL) {
+		char *pos = strchr(line, '\n');
+		if (pos == NULL)
+			break;
+		*pos = '\0';
+		long long entry_offset = strtoll(line, &pos, 10);
+		if (pos == line || *pos != ' ')
+			break;
+		struct vclock entry_vclock;
+		if (vclock_from_string(&entry_vclock, pos + 1) != 0)
+			break;
+		int cmp = vclock_compare(&entry_vclock, vclock);
+		if (cmp != -1 && cmp != 0)
+			break;
+		offset = entry_offset;
+	}
+	fclose(f);
+	if (offset <= xlog_cursor_pos(cursor))
+		return;
+	/*
+	 * The index is advisory - it may belong to an older
+	 * incarnation of the file. Only seek if the offset it
+	 * points at starts a tx block.
+	 */
+	log_magic_t magic;
+	if (fio_pread(cursor->fd, &magic, sizeof(magic), offset) !=
+	    sizeof(magic))
+		return;
+	if (magic != row_marker && magic != zrow_marker)
+		return;
+	ibuf_reset(&cursor->rbuf);
+	cursor->read_offset = offset;
+}
+
+/**
+ * Asynchronous tx block decoder, see xlog_cursor_decode_ahead().
+ */
+struct xlog_decoder {
+	/** True while an eio task is in flight. */
+	bool busy;
+	/** Set by the completion callback when a task finishes. */
+	bool done;
+	/**
+	 * Task result: 0 on success, -1 on a checksum or
+	 * decompression failure. No diagnostics are set in the
+	 * eio thread; a failed block is retried inline.
+	 */
+	int result;
+	/** Fixheader of the block being decoded. */
+	struct xlog_fixheader fixheader;
+	/** Size of the block in the read buffer, with header. */
+	size_t block_size;
+	/** Task input: a copy of the compressed tx block. */
+	char *in;
+	size_t in_size;
+	size_t in_capacity;
+	/** Task output: decoded rows. */
+	char *out;
+	size_t out_size;
+	size_t out_capacity;
+	/** Decompression stream, used by the eio thread only. */
+	ZSTD_DStream *zdctx;
+	/** Fiber waiting for the task to complete. */
+	struct fiber *waiter;
+};
+
+/**
+ * Runs in an eio thread: verify the block checksum and decompress
+ * the rows. Must not use diag or any other fiber machinery.
+ */
+static void
+xlog_decoder_exec_cb(eio_req *req)
+{
+	struct xlog_decoder *d = (struct xlog_decoder *)req->data;
+	req->result = 0;
+	d->result = -1;
+	d->out_size = 0;
+	if (crc32_calc(0, d->in, d->in_size) != d->fixheader.crc32c)
+		return;
+	if (d->fixheader.magic == row_marker) {
+		if (d->out_capacity < d->in_size) {
+			char *out = (char *)realloc(d->out, d->in_size);
+			if (out == NULL)
+				return;
+			d->out = out;
+			d->out_capacity = d->in_size;
+		}
+		memcpy(d->out, d->in, d->in_size);
+		d->out_size = d->in_size;
+		d->result = 0;
+		return;
+	}
+	assert(d->fixheader.magic == zrow_marker);
+	ZSTD_initDStream(d->zdctx);
+	ZSTD_inBuffer input = {d->in, d->in_size, 0};
+	while (input.pos < input.size) {
+		if (d->out_size == d->out_capacity) {
+			size_t capacity = MAX(d->out_capacity * 2,
+				(size_t)XLOG_TX_AUTOCOMMIT_THRESHOLD);
+			char *out = (char *)realloc(d->out, capacity);
+			if (out == NULL)
+				return;
+			d->out = out;
+			d->out_capacity = capacity;
+		}
+		ZSTD_outBuffer output = {d->out, d->out_capacity, d->out_size};
+		size_t rc = ZSTD_decompressStream(d->zdctx, &output, &input);
+		if (ZSTD_isError(rc))
+			return;
+		d->out_size = output.pos;
+	}
+	d->result = 0;
+}
+
+/** Runs in the cursor's thread when a decode task completes. */
+static int
+xlog_decoder_done_cb(eio_req *req)
+{
+	struct xlog_decoder *d = (struct xlog_decoder *)req->data;
+	d->busy = false;
+	d->done = true;
+	if (d->waiter != NULL)
+		fiber_wakeup(d->waiter);
+	return 0;
+}
+
+/**
+ * Start decoding the tx block at the current read position in an
+ * eio thread. File reads stay in the caller's thread: with kernel
+ * readahead they are cheap compared to crc32 and decompression.
+ * If the block can not be decoded ahead (eof marker, torn or
+ * corrupt header), does nothing - the inline path takes care of
+ * it with proper diagnostics.
+ */
+static void
+xlog_decoder_kick(struct xlog_cursor *cursor)
+{
+	struct xlog_decoder *d = cursor->decoder;
+	assert(!d->busy);
+	d->done = false;
+	if (xlog_cursor_ensure(cursor, XLOG_FIXHEADER_SIZE) != 0)
+		return;
+	const char *rpos = cursor->rbuf.rpos;
+	struct xlog_fixheader fixheader;
+	if (xlog_fixheader_decode(&fixheader, &rpos,
+				  (const char *)cursor->rbuf.wpos) != 0)
+		return;
+	size_t header_size = rpos - cursor->rbuf.rpos;
+	/* The read buffer may be reallocated by this call. */
+	if (xlog_cursor_ensure(cursor, header_size + fixheader.len) != 0)
+		return;
+	if (d->in_capacity < fixheader.len) {
+		char *in = (char *)realloc(d->in, fixheader.len);
+		if (in == NULL)
+			return;
+		d->in = in;
+		d->in_capacity = fixheader.len;
+	}
+	memcpy(d->in, cursor->rbuf.rpos + header_size, fixheader.len);
+	d->in_size = fixheader.len;
+	d->fixheader = fixheader;
+	d->block_size = header_size + fixheader.len;
+	d->busy = true;
+	eio_custom(xlog_decoder_exec_cb, 0, xlog_decoder_done_cb, d);
+}
+
+/** Wait until the in-flight decode task, if any, completes. */
+static void
+xlog_decoder_wait(struct xlog_decoder *d)
+{
+	while (d->busy) {
+		d->waiter = fiber();
+		fiber_yield();
+		d->waiter = NULL;
+	}
+}
+
+void
+xlog_cursor_decode_ahead(struct xlog_cursor *cursor)
+{
+	assert(xlog_cursor_is_open(cursor));
+	if (cursor->decoder != NULL)
+		return;
+	struct xlog_decoder *d =
+		(struct xlog_decoder *)calloc(1, sizeof(*d));
+	if (d == NULL)
+		return; /* An optimization, not a must. */
+	d->zdctx = ZSTD_createDStream();
+	if (d->zdctx == NULL) {
+		free(d);
+		return;
+	}
+	cursor->decoder = d;
+	/* The cursor is right before the first tx block. */
+	xlog_decoder_kick(cursor);
+}
+
+/** Free the decoder, waiting for an in-flight task to finish. */
+static void
+xlog_decoder_delete(struct xlog_decoder *d)
+{
+	xlog_decoder_wait(d);
+	ZSTD_freeDStream(d->zdctx);
+	free(d->in);
+	free(d->out);
+	free(d);
+}
+
+enum { XLOG_BLOCK_CACHE_SIZE = 16 };
+
+/** An entry of the shared tx block cache. */
+struct xlog_block {
+	/** Vclock signature of the source xlog file. */
+	int64_t signature;
+	/** File offset of the block, including the fixheader. */
+	off_t offset;
+	/** Size of the encoded block in the file, with header. */
+	size_t block_size;
+	/** Decoded rows, NULL if the slot is free. */
+	char *rows;
+	size_t size;
+	size_t capacity;
+	/** Access clock reading, for eviction. */
+	uint64_t used;
+};
+
+/**
+ * Cache of recently decoded tx blocks, shared between all threads
+ * which read xlog files with xlog_cursor.shared_cache set. With
+ * several relay threads serving replicas at similar vclocks each
+ * block of the common WAL tail is read, checksummed and
+ * decompressed once instead of once per replica. An entry is
+ * keyed by the file vclock signature and the block offset: file
+ * signatures never repeat within an instance lifetime and a block
+ * is immutable once fully written, so entries can not go stale.
+ */
+static struct xlog_block xlog_block_cache[XLOG_BLOCK_CACHE_SIZE];
+static uint64_t xlog_block_cache_clock;
+static pthread_mutex_t xlog_block_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Look the given block up in the shared cache. On a hit append
+ * the decoded rows to @rows and return the encoded block size so
+ * that the caller can skip it in the file, on a miss return -1.
+ */
+static ssize_t
+xlog_block_cache_find(int64_t signature, off_t offset, struct ibuf *rows)
+{
+	tt_pthread_mutex_lock(&xlog_block_cache_mutex);
+	struct xlog_block *b = NULL;
+	for (int i = 0; i < XLOG_BLOCK_CACHE_SIZE; i++) {
+		if (xlog_block_cache[i].rows != NULL &&
+		    xlog_block_cache[i].signature == signature &&
+		    xlog_block_cache[i].offset == offset) {
+			b = &xlog_block_cache[i];
+			break;
+		}
+	}
+	ssize_t block_size = -1;
+	if (b != NULL) {
+		/*
+		 * Copy under the mutex - the slot may be evicted
+		 * by another thread right after it is released.
+		 */
+		void *dst = ibuf_alloc(rows, b->size);
+		if (dst != NULL) {
+			memcpy(dst, b->rows, b->size);
+			b->used = ++xlog_block_cache_clock;
+			block_size = b->block_size;
+		}
+	}
+	tt_pthread_mutex_unlock(&xlog_block_cache_mutex);
+	return block_size;
+}
+
+/**
+ * Add a decoded block to the shared cache, evicting the least
+ * recently used entry. Failure to cache is not an error.
+ */
+static void
+xlog_block_cache_put(int64_t signature, off_t offset, size_t block_size,
+		     const char *rows, size_t size)
+{
+	tt_pthread_mutex_lock(&xlog_block_cache_mutex);
+	struct xlog_block *b = &xlog_block_cache[0];
+	for (int i = 0; i < XLOG_BLOCK_CACHE_SIZE; i++) {
+		if (xlog_block_cache[i].rows != NULL &&
+		    xlog_block_cache[i].signature == signature &&
+		    xlog_block_cache[i].offset == offset) {
+			/* Inserted by a concurrent reader. */
+			xlog_block_cache[i].used = ++xlog_block_cache_clock;
+			goto out;
+		}
+		if (xlog_block_cache[i].rows == NULL) {
+			b = &xlog_block_cache[i];
+			break;
+		}
+		if (xlog_block_cache[i].used < b->used)
+			b = &xlog_block_cache[i];
+	}
+	if (b->capacity < size) {
+		char *new_rows = (char *)realloc(b->rows, size);
+		if (new_rows == NULL)
+			goto out;
+		b->rows = new_rows;
+		b->capacity = size;
+	}
+	memcpy(b->rows, rows, size);
+	b->signature = signature;
+	b->offset = offset;
+	b->block_size = block_size;
+	b->size = size;
+	b->used = ++xlog_block_cache_clock;
+out:
+	tt_pthread_mutex_unlock(&xlog_block_cache_mutex);
+}
+
+/** Implementation of xlog_cursor_next_tx(): inline decoding. */
+static int
+xlog_cursor_next_tx_impl(struct xlog_cursor *i)
 {
 	int rc;
 	assert(xlog_cursor_is_open(i));
@@ -1906,6 +2862,98 @@ eof_found:
 	return 1;
 }
 
+/**
+ * Implementation of xlog_cursor_next_tx() with the shared block
+ * cache enabled: on a hit the encoded block is skipped without
+ * being read, checksummed or decompressed. Anything irregular -
+ * an eof marker, a torn or corrupt header - is left to the
+ * inline path, which owns the diagnostics and state handling.
+ */
+static int
+xlog_cursor_next_tx_cached(struct xlog_cursor *i)
+{
+	if (xlog_cursor_ensure(i, XLOG_FIXHEADER_SIZE) != 0)
+		return xlog_cursor_next_tx_impl(i);
+	if (load_u32(i->rbuf.rpos) == eof_marker)
+		return xlog_cursor_next_tx_impl(i);
+	const char *rpos = i->rbuf.rpos;
+	struct xlog_fixheader fixheader;
+	if (xlog_fixheader_decode(&fixheader, &rpos,
+				  (const char *)i->rbuf.wpos) != 0)
+		return xlog_cursor_next_tx_impl(i);
+	off_t offset = xlog_cursor_pos(i);
+	int64_t signature = vclock_sum(&i->meta.vclock);
+	ibuf_create(&i->tx_cursor.rows, &cord()->slabc,
+		    XLOG_TX_AUTOCOMMIT_THRESHOLD);
+	ssize_t block_size = xlog_block_cache_find(signature, offset,
+						   &i->tx_cursor.rows);
+	if (block_size < 0) {
+		ibuf_destroy(&i->tx_cursor.rows);
+		int rc = xlog_cursor_next_tx_impl(i);
+		if (rc != 0)
+			return rc;
+		xlog_block_cache_put(signature, offset,
+				     xlog_cursor_pos(i) - offset,
+				     i->tx_cursor.rows.rpos,
+				     ibuf_used(&i->tx_cursor.rows));
+		return 0;
+	}
+	/*
+	 * Skip the encoded block. The read buffer rarely holds
+	 * all of it, in which case drop the buffer and continue
+	 * reading right from the block end.
+	 */
+	if (ibuf_used(&i->rbuf) >= (size_t)block_size) {
+		i->rbuf.rpos += block_size;
+	} else {
+		ibuf_reset(&i->rbuf);
+		i->read_offset = offset + block_size;
+	}
+	i->tx_cursor.size = ibuf_used(&i->tx_cursor.rows);
+	i->state = XLOG_CURSOR_TX;
+	return 0;
+}
+
+int
+xlog_cursor_next_tx(struct xlog_cursor *i)
+{
+	assert(xlog_cursor_is_open(i));
+	if (i->shared_cache)
+		return xlog_cursor_next_tx_cached(i);
+	struct xlog_decoder *d = i->decoder;
+	if (d == NULL)
+		return xlog_cursor_next_tx_impl(i);
+	xlog_decoder_wait(d);
+	if (d->done && d->result == 0) {
+		d->done = false;
+		ibuf_create(&i->tx_cursor.rows, &cord()->slabc,
+			    XLOG_TX_AUTOCOMMIT_THRESHOLD);
+		void *dst = ibuf_alloc(&i->tx_cursor.rows, d->out_size);
+		if (dst == NULL) {
+			ibuf_destroy(&i->tx_cursor.rows);
+			diag_set(OutOfMemory, d->out_size, "runtime",
+				 "xlog rows buffer");
+			return -1;
+		}
+		memcpy(dst, d->out, d->out_size);
+		i->tx_cursor.size = d->out_size;
+		i->rbuf.rpos += d->block_size;
+		i->state = XLOG_CURSOR_TX;
+		xlog_decoder_kick(i);
+		return 0;
+	}
+	/*
+	 * Nothing was decoded ahead: eof marker, torn tail or a
+	 * corrupt block. Decode inline to get exact diagnostics
+	 * and state handling.
+	 */
+	d->done = false;
+	int rc = xlog_cursor_next_tx_impl(i);
+	if (rc == 0)
+		xlog_decoder_kick(i);
+	return rc;
+}
+
 int
 xlog_cursor_next_row(struct xlog_cursor *cursor, struct xrow_header *xrow)
 {
@@ -2054,6 +3102,10 @@ void
 xlog_cursor_close(struct xlog_cursor *i, bool reuse_fd)
 {
 	assert(xlog_cursor_is_open(i));
+	if (i->decoder != NULL) {
+		xlog_decoder_delete(i->decoder);
+		i->decoder = NULL;
+	}
 	if (i->fd >= 0 && !reuse_fd)
 		close(i->fd);
 	assert(i->rbuf.slabc == &cord()->slabc);
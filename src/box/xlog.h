@@ -82,6 +82,38 @@ struct xlog_opts {
 	 * to be read frequently, e.g. L1 run files in Vinyl.
 	 */
 	bool no_compression;
+	/**
+	 * Zstd compression level. Higher levels compress better
+	 * at the cost of write CPU. Ignored if no_compression is
+	 * set.
+	 */
+	int zstd_level;
+	/**
+	 * If this flag is set, open the file with O_DIRECT and
+	 * do sector-aligned writes via a bounce buffer, so that
+	 * the I/O bypasses the page cache entirely.
+	 *
+	 * This option is useful for WAL files: it keeps WAL
+	 * writeback from competing with data file reads for disk
+	 * queue slots and makes fdatasync() latency predictable.
+	 * Ignored with a warning on platforms and filesystems
+	 * that don't support O_DIRECT.
+	 */
+	bool direct;
+	/**
+	 * If this flag is set, collect a vclock -> file offset
+	 * entry at each tx block boundary and dump the entries to
+	 * a sidecar index file (<xlog name>.idx) when the log is
+	 * closed.
+	 *
+	 * This option is useful for WAL files: a reader resuming
+	 * from a vclock in the middle of a big xlog, e.g. a
+	 * replica resubscribing after a short outage, can seek
+	 * close to its position instead of reading and
+	 * decompressing the whole file, see
+	 * xlog_cursor_seek_vclock().
+	 */
+	bool lsn_index;
 };
 
 extern const struct xlog_opts xlog_opts_default;
@@ -165,6 +197,21 @@ struct xdir {
 	char dirname[PATH_MAX];
 	/** Snapshots or xlogs */
 	enum xdir_type type;
+	/**
+	 * Spare file ring state, see xdir_prepare_spare().
+	 * Only used for WAL directories.
+	 */
+	/**
+	 * Target preallocation size of a spare file.
+	 * 0 if the spare file ring is disabled.
+	 */
+	size_t spare_size;
+	/** Bytes actually preallocated in the ready spare file. */
+	size_t spare_allocated;
+	/** True if the spare file exists and is ready for use. */
+	bool spare_ready;
+	/** True while an eio task is preparing the spare file. */
+	bool spare_in_progress;
 };
 
 /**
@@ -240,12 +287,38 @@ enum {
 void
 xdir_collect_garbage(struct xdir *dir, int64_t signature, unsigned flags);
 
+/**
+ * Return the number of files whose signature is less than
+ * specified, i.e. how many files xdir_collect_garbage() with
+ * the same signature would remove.
+ */
+int
+xdir_gc_backlog(struct xdir *dir, int64_t signature);
+
 /**
  * Remove inprogress files in the specified directory.
  */
 void
 xdir_collect_inprogress(struct xdir *xdir);
 
+/**
+ * Prepare a spare file for the directory: create and preallocate
+ * (with fallocate) @size bytes of disk space for it in an eio
+ * thread so that the next xdir_create_xlog() can simply rename it
+ * into place and start writing without paying for filesystem
+ * block allocation and inode creation. Once a spare file exists,
+ * xdir_collect_garbage() recycles old files into the spare slot
+ * by rename instead of unlinking them.
+ *
+ * The function returns immediately; a failure to prepare the
+ * spare file is logged and xdir_create_xlog() falls back to
+ * creating files from scratch. The spare file has the .inprogress
+ * suffix, so directory scans ignore it, and it is truncated and
+ * reused when the spare is prepared anew after a restart.
+ */
+void
+xdir_prepare_spare(struct xdir *dir, size_t size);
+
 /**
  * Return LSN and vclock (unless @vclock is NULL) of the oldest
  * file in a directory or -1 if the directory is empty.
@@ -328,6 +401,14 @@ xlog_meta_create(struct xlog_meta *meta, const char *filetype,
 
 /* }}} */
 
+enum {
+	/**
+	 * Alignment of O_DIRECT writes, see xlog_opts::direct.
+	 * 4096 covers both native 4K and 512e drives.
+	 */
+	XLOG_SECTOR_SIZE = 4096,
+};
+
 /**
  * A single log file - a snapshot, a vylog or a write ahead log.
  */
@@ -377,6 +458,24 @@ struct xlog {
 	 * xlog_fallocate().
 	 */
 	size_t allocated;
+	/**
+	 * True if the file was opened with O_DIRECT and writes
+	 * go through the aligned bounce buffer, see
+	 * xlog_opts::direct. Cleared if the filesystem turned
+	 * out not to support O_DIRECT.
+	 */
+	bool direct;
+	/** Aligned bounce buffer for O_DIRECT writes. */
+	char *direct_buf;
+	/** Size of direct_buf, in bytes. */
+	size_t direct_buf_size;
+	/**
+	 * Contents of the last partial sector of the file. The
+	 * next O_DIRECT write rewrites this sector in full, so
+	 * zero padding added at the previous write is replaced
+	 * with real data.
+	 */
+	char direct_tail[XLOG_SECTOR_SIZE];
 	/**
 	 * Output buffer, works as row accumulator for
 	 * compression.
@@ -388,6 +487,17 @@ struct xlog {
 	 * Compressed output buffer
 	 */
 	struct obuf zbuf;
+	/**
+	 * LSN index entries accumulated while writing, dumped to
+	 * the sidecar index file on close. Empty unless
+	 * xlog_opts::lsn_index is set.
+	 */
+	struct obuf idx_buf;
+	/**
+	 * Running vclock of the rows written so far, maintained
+	 * only when the LSN index is enabled.
+	 */
+	struct vclock idx_vclock;
 	/**
 	 * Synced file size
 	 */
@@ -502,6 +612,83 @@ xlog_fallocate(struct xlog *log, size_t size);
 ssize_t
 xlog_write_row(struct xlog *log, const struct xrow_header *packet);
 
+/**
+ * A detached encoder of a single xlog tx block. Unlike
+ * xlog_write_row(), it is not bound to a file: rows are
+ * accumulated and compressed into a self-contained on-disk
+ * block which can later be appended to an xlog with
+ * xlog_write_block(). Since tx blocks are independent, several
+ * encoders may run in parallel threads, each producing blocks
+ * for the same file; this is what the parallel memtx snapshot
+ * writer is built on.
+ */
+struct xlog_tx_encoder {
+	/** Row accumulator, fixheader space included. */
+	struct obuf obuf;
+	/** The context of zstd compression. */
+	ZSTD_CCtx *zctx;
+	/** Write options of the target xlog (compression). */
+	struct xlog_opts opts;
+	/** The number of rows in the current tx. */
+	int64_t tx_rows;
+};
+
+/**
+ * Create an encoder. Must be called in a cord: the row
+ * accumulator lives in the cord's slab cache and row encoding
+ * uses the fiber region.
+ *
+ * @retval 0 success
+ * @retval -1 error, check diag
+ */
+int
+xlog_tx_encoder_create(struct xlog_tx_encoder *encoder,
+		       const struct xlog_opts *opts);
+
+void
+xlog_tx_encoder_destroy(struct xlog_tx_encoder *encoder);
+
+/** Size of the rows accumulated so far, in bytes. */
+size_t
+xlog_tx_encoder_size(const struct xlog_tx_encoder *encoder);
+
+/**
+ * Append a row to the current tx.
+ *
+ * @retval count of written bytes
+ * @retval -1 for error
+ */
+ssize_t
+xlog_tx_encoder_add_row(struct xlog_tx_encoder *encoder,
+			const struct xrow_header *packet);
+
+/**
+ * Finalize the current tx into a malloc()-ed on-disk block and
+ * reset the encoder for the next tx. If no rows have been
+ * accumulated, *data is set to NULL and *size to 0. The caller
+ * is responsible for free()-ing *data.
+ *
+ * @retval 0 success
+ * @retval -1 error, check diag
+ */
+int
+xlog_tx_encoder_flush(struct xlog_tx_encoder *encoder, char **data,
+		      size_t *size, int64_t *row_count);
+
+/**
+ * Append a pre-encoded tx block produced by
+ * xlog_tx_encoder_flush() to the log file. The row buffer must
+ * be empty, i.e. the caller must not mix xlog_write_row() into
+ * an unfinished block sequence. Does not maintain the LSN
+ * index, so the target must have xlog_opts::lsn_index unset.
+ *
+ * @retval count of written bytes
+ * @retval -1 for error
+ */
+ssize_t
+xlog_write_block(struct xlog *log, const char *data, size_t size,
+		 int64_t row_count);
+
 /**
  * Prevent xlog row buffer offloading, should be use
  * at transaction start to write transaction in one xlog tx
@@ -667,6 +854,18 @@ struct xlog_cursor {
 	struct xlog_tx_cursor tx_cursor;
 	/** ZSTD context for decompression */
 	ZSTD_DStream *zdctx;
+	/**
+	 * Asynchronous tx block decoder or NULL if decode ahead
+	 * is not enabled, see xlog_cursor_decode_ahead().
+	 */
+	struct xlog_decoder *decoder;
+	/**
+	 * Consult the process-wide cache of decoded tx blocks,
+	 * shared between all threads reading xlog files. Enabled
+	 * by relays so that replicas at similar vclocks read and
+	 * decode each block of the common WAL tail once.
+	 */
+	bool shared_cache;
 };
 
 /**
@@ -733,6 +932,37 @@ xlog_cursor_openmem(struct xlog_cursor *cursor, const char *data, size_t size,
 void
 xlog_cursor_close(struct xlog_cursor *cursor, bool reuse_fd);
 
+/**
+ * Enable decode ahead for the cursor: while rows of the current
+ * tx block are being applied, the next block is crc32-checked and
+ * decompressed in an eio thread, so decode overlaps apply. The
+ * calling thread must have eio enabled (see coio_enable()) and
+ * all cursor methods must keep being called from it.
+ *
+ * This is an optimization for sequential readers like recovery;
+ * if the decoder can not be set up, the cursor silently keeps
+ * decoding inline. Corrupt or torn blocks are retried inline to
+ * produce proper diagnostics.
+ */
+void
+xlog_cursor_decode_ahead(struct xlog_cursor *cursor);
+
+/**
+ * Try to reposition the cursor to the last tx block boundary
+ * preceding the given vclock, using the sidecar LSN index
+ * written for files with xlog_opts::lsn_index. Rows skipped by
+ * the seek are guaranteed to be covered by @a vclock. Best
+ * effort: if the index is missing, unparsable or does not point
+ * at a tx block, the cursor is left where it is and reading
+ * continues sequentially.
+ *
+ * Must be called right after the cursor is opened, before any
+ * rows are read and before xlog_cursor_decode_ahead().
+ */
+void
+xlog_cursor_seek_vclock(struct xlog_cursor *cursor,
+			const struct vclock *vclock);
+
 /**
  * Open next tx from xlog
  * @param cursor cursor
@@ -38,6 +38,7 @@
 #include "fiber.h"
 #include "version.h"
 #include "tt_static.h"
+#include "mp_check_flat.h"
 #include "error.h"
 #include "mp_error.h"
 #include "scramble.h"
@@ -134,8 +135,36 @@ xrow_header_decode(struct xrow_header *header, const char **pos,
 		   const char *end, bool end_is_exact)
 {
 	memset(header, 0, sizeof(struct xrow_header));
-	const char *tmp = *pos;
 	const char * const start = *pos;
+	/*
+	 * Fast path for the header shape every client request
+	 * carries: a two-entry fixmap {IPROTO_REQUEST_TYPE: t,
+	 * IPROTO_SYNC: s}, both keys single-byte fixints. Decoding
+	 * it straight away skips the generic mp_check() pass and
+	 * the per-key dispatch below, which dominate the fixed
+	 * cost of tiny requests like ping and get.
+	 */
+	const char *fast = *pos;
+	if (end - fast >= 4 && (uint8_t) fast[0] == 0x82 && fast[1] == 0x00 &&
+	    mp_typeof(fast[2]) == MP_UINT) {
+		const char *q = fast + 2;
+		if (mp_check_uint(q, end) <= 0) {
+			uint64_t type = mp_decode_uint(&q);
+			if (end - q >= 2 && q[0] == 0x01 &&
+			    mp_typeof(q[1]) == MP_UINT) {
+				const char *r = q + 1;
+				if (mp_check_uint(r, end) <= 0) {
+					header->type = type;
+					header->sync = mp_decode_uint(&r);
+					/* No tsn, see below. */
+					header->is_commit = true;
+					*pos = r;
+					goto body;
+				}
+			}
+		}
+	}
+	const char *tmp = *pos;
 	if (mp_check(&tmp, end) != 0) {
 error:
 		xrow_on_decode_err(start, end, ER_INVALID_MSGPACK, "packet header");
@@ -200,11 +229,11 @@ error:
 	}
 	/* Restore transaction id from lsn and transaction serial number. */
 	header->tsn = header->lsn - header->tsn;
-
+body:
 	/* Nop requests aren't supposed to have a body. */
 	if (*pos < end && header->type != IPROTO_NOP) {
 		const char *body = *pos;
-		if (mp_check(pos, end)) {
+		if (mp_check_flat(pos, end)) {
 			xrow_on_decode_err(start, end, ER_INVALID_MSGPACK, "packet body");
 			return -1;
 		}
@@ -441,6 +470,41 @@ iproto_reply_vclock(struct obuf *out, const struct vclock *vclock,
 	return 0;
 }
 
+int
+iproto_reply_id(struct obuf *out, uint64_t features, uint64_t sync,
+		uint32_t schema_version)
+{
+	size_t max_size = IPROTO_HEADER_LEN + mp_sizeof_map(2) +
+		mp_sizeof_uint(IPROTO_VERSION) +
+		mp_sizeof_uint(IPROTO_CURRENT_VERSION) +
+		mp_sizeof_uint(IPROTO_FEATURES) +
+		mp_sizeof_uint(UINT64_MAX);
+
+	char *buf = obuf_reserve(out, max_size);
+	if (buf == NULL) {
+		diag_set(OutOfMemory, max_size,
+			 "obuf_alloc", "buf");
+		return -1;
+	}
+
+	char *data = buf + IPROTO_HEADER_LEN;
+	data = mp_encode_map(data, 2);
+	data = mp_encode_uint(data, IPROTO_VERSION);
+	data = mp_encode_uint(data, IPROTO_CURRENT_VERSION);
+	data = mp_encode_uint(data, IPROTO_FEATURES);
+	data = mp_encode_uint(data, features);
+	size_t size = data - buf;
+	assert(size <= max_size);
+
+	iproto_header_encode(buf, IPROTO_OK, sync, schema_version,
+			     size - IPROTO_HEADER_LEN);
+
+	char *ptr = obuf_alloc(out, size);
+	(void) ptr;
+	assert(ptr == buf);
+	return 0;
+}
+
 int
 iproto_reply_vote(struct obuf *out, const struct ballot *ballot,
 		  uint64_t sync, uint32_t schema_version)
@@ -498,10 +562,23 @@ mpstream_error_handler(void *error_ctx)
 static void
 mpstream_iproto_encode_error(struct mpstream *stream, const struct error *error)
 {
-	mpstream_encode_map(stream, 2);
-	mpstream_encode_uint(stream, IPROTO_ERROR_24);
-	mpstream_encode_str(stream, error->errmsg);
-	mpstream_encode_uint(stream, IPROTO_ERROR);
+	/*
+	 * The total size of the fixed part of the body is known
+	 * in advance, so it is encoded into one reservation with
+	 * unchecked writes instead of a reserve call per value.
+	 */
+	uint32_t errmsg_len = strlen(error->errmsg);
+	size_t size = mp_sizeof_map(2) + mp_sizeof_uint(IPROTO_ERROR_24) +
+		      mp_sizeof_str(errmsg_len) + mp_sizeof_uint(IPROTO_ERROR);
+	char *data = mpstream_reserve(stream, size);
+	if (data == NULL)
+		return;
+	char *pos = mp_encode_map(data, 2);
+	pos = mp_encode_uint(pos, IPROTO_ERROR_24);
+	pos = mp_encode_str(pos, error->errmsg, errmsg_len);
+	pos = mp_encode_uint(pos, IPROTO_ERROR);
+	assert(pos == data + size);
+	mpstream_advance(stream, pos - data);
 	error_to_mpstream_noext(error, stream);
 }
 
@@ -621,10 +698,11 @@ error:
 	request->sql_text = NULL;
 	request->bind = NULL;
 	request->stmt_id = NULL;
+	request->stream = 0;
 	for (uint32_t i = 0; i < map_size; ++i) {
 		uint8_t key = *data;
 		if (key != IPROTO_SQL_BIND && key != IPROTO_SQL_TEXT &&
-		    key != IPROTO_STMT_ID) {
+		    key != IPROTO_STMT_ID && key != IPROTO_STREAM) {
 			mp_check(&data, end);   /* skip the key */
 			mp_check(&data, end);   /* skip the value */
 			continue;
@@ -636,7 +714,11 @@ error:
 			request->bind = value;
 		else if (key == IPROTO_SQL_TEXT)
 			request->sql_text = value;
-		else
+		else if (key == IPROTO_STREAM) {
+			if (mp_typeof(*value) != MP_UINT)
+				goto error;
+			request->stream = mp_decode_uint(&value);
+		} else
 			request->stmt_id = value;
 	}
 	if (request->sql_text != NULL && request->stmt_id != NULL) {
@@ -669,16 +751,66 @@ iproto_reply_sql(struct obuf *buf, struct obuf_svp *svp, uint64_t sync,
 
 void
 iproto_reply_chunk(struct obuf *buf, struct obuf_svp *svp, uint64_t sync,
-		   uint32_t schema_version)
+		   uint32_t schema_version, uint32_t count)
 {
 	char *pos = (char *) obuf_svp_to_ptr(buf, svp);
 	iproto_header_encode(pos, IPROTO_CHUNK, sync, schema_version,
 			     obuf_size(buf) - svp->used - IPROTO_HEADER_LEN);
 	struct iproto_body_bin body = iproto_body_bin;
-	body.v_data_len = mp_bswap_u32(1);
+	body.v_data_len = mp_bswap_u32(count);
 	memcpy(pos + IPROTO_HEADER_LEN, &body, sizeof(body));
 }
 
+/** How a DML body key value lands in struct request. */
+enum request_field_kind {
+	/** The key has no struct request field, skip it. */
+	REQUEST_FIELD_NONE = 0,
+	/** A scalar decoded into a uint32_t field. */
+	REQUEST_FIELD_U32,
+	/**
+	 * A msgpack subtree stored as a [start, end) pointer pair
+	 * in two adjacent struct request fields.
+	 */
+	REQUEST_FIELD_MP,
+};
+
+/** An entry of the DML body decode plan, see request_field_map. */
+struct request_field_plan {
+	/** enum request_field_kind. */
+	uint8_t kind;
+	/** Field offset in struct request. */
+	uint8_t offset;
+};
+
+static_assert(sizeof(struct request) <= UINT8_MAX,
+	      "request_field_plan::offset is a uint8_t");
+
+#define REQUEST_FIELD(kind, field) \
+	{ kind, offsetof(struct request, field) }
+
+/**
+ * Precomputed decode plan for DML body keys, indexed by key:
+ * which struct request field the value lands in and how it is
+ * decoded. One predictable table load per key instead of a
+ * switch spread over all body keys. The value type has already
+ * been checked against iproto_key_type when the plan is applied.
+ */
+static const struct request_field_plan request_field_map[IPROTO_KEY_MAX] = {
+	[IPROTO_SPACE_ID]   = REQUEST_FIELD(REQUEST_FIELD_U32, space_id),
+	[IPROTO_INDEX_ID]   = REQUEST_FIELD(REQUEST_FIELD_U32, index_id),
+	[IPROTO_OFFSET]     = REQUEST_FIELD(REQUEST_FIELD_U32, offset),
+	[IPROTO_INDEX_BASE] = REQUEST_FIELD(REQUEST_FIELD_U32, index_base),
+	[IPROTO_LIMIT]      = REQUEST_FIELD(REQUEST_FIELD_U32, limit),
+	[IPROTO_ITERATOR]   = REQUEST_FIELD(REQUEST_FIELD_U32, iterator),
+	[IPROTO_STREAM]     = REQUEST_FIELD(REQUEST_FIELD_U32, stream),
+	[IPROTO_TUPLE]      = REQUEST_FIELD(REQUEST_FIELD_MP, tuple),
+	[IPROTO_KEY]        = REQUEST_FIELD(REQUEST_FIELD_MP, key),
+	[IPROTO_OPS]        = REQUEST_FIELD(REQUEST_FIELD_MP, ops),
+	[IPROTO_TUPLE_META] = REQUEST_FIELD(REQUEST_FIELD_MP, tuple_meta),
+};
+
+#undef REQUEST_FIELD
+
 int
 xrow_decode_dml(struct xrow_header *row, struct request *request,
 		uint64_t key_map)
@@ -715,45 +847,20 @@ error:
 		}
 		uint64_t key = mp_decode_uint(&data);
 		const char *value = data;
-		if (mp_check(&data, end) ||
+		if (mp_check_flat(&data, end) ||
 		    key >= IPROTO_KEY_MAX ||
 		    iproto_key_type[key] != mp_typeof(*value))
 			goto error;
 		key_map &= ~iproto_key_bit(key);
-		switch (key) {
-		case IPROTO_SPACE_ID:
-			request->space_id = mp_decode_uint(&value);
-			break;
-		case IPROTO_INDEX_ID:
-			request->index_id = mp_decode_uint(&value);
-			break;
-		case IPROTO_OFFSET:
-			request->offset = mp_decode_uint(&value);
-			break;
-		case IPROTO_INDEX_BASE:
-			request->index_base = mp_decode_uint(&value);
-			break;
-		case IPROTO_LIMIT:
-			request->limit = mp_decode_uint(&value);
-			break;
-		case IPROTO_ITERATOR:
-			request->iterator = mp_decode_uint(&value);
-			break;
-		case IPROTO_TUPLE:
-			request->tuple = value;
-			request->tuple_end = data;
-			break;
-		case IPROTO_KEY:
-			request->key = value;
-			request->key_end = data;
-			break;
-		case IPROTO_OPS:
-			request->ops = value;
-			request->ops_end = data;
+		const struct request_field_plan *plan = &request_field_map[key];
+		char *field = (char *) request + plan->offset;
+		switch (plan->kind) {
+		case REQUEST_FIELD_U32:
+			*(uint32_t *) field = mp_decode_uint(&value);
 			break;
-		case IPROTO_TUPLE_META:
-			request->tuple_meta = value;
-			request->tuple_meta_end = data;
+		case REQUEST_FIELD_MP:
+			((const char **) field)[0] = value;
+			((const char **) field)[1] = data;
 			break;
 		default:
 			break;
@@ -1239,6 +1346,62 @@ error:
 	return 0;
 }
 
+int
+xrow_decode_id(const struct xrow_header *row, struct id_request *request)
+{
+	if (row->bodycnt == 0) {
+		diag_set(ClientError, ER_INVALID_MSGPACK,
+			 "missing request body");
+		return -1;
+	}
+
+	assert(row->bodycnt == 1);
+	const char *data = (const char *) row->body[0].iov_base;
+	const char *end = data + row->body[0].iov_len;
+	assert((end - data) > 0);
+
+	if (mp_typeof(*data) != MP_MAP || mp_check_map(data, end) > 0) {
+error:
+		xrow_on_decode_err(row->body[0].iov_base, end, ER_INVALID_MSGPACK,
+				   "packet body");
+		return -1;
+	}
+
+	memset(request, 0, sizeof(*request));
+
+	uint32_t map_size = mp_decode_map(&data);
+	for (uint32_t i = 0; i < map_size; ++i) {
+		if ((end - data) < 1 || mp_typeof(*data) != MP_UINT)
+			goto error;
+
+		uint64_t key = mp_decode_uint(&data);
+		const char *value = data;
+		if (mp_check(&data, end) != 0)
+			goto error;
+
+		switch (key) {
+		case IPROTO_VERSION:
+			if (mp_typeof(*value) != MP_UINT)
+				goto error;
+			request->version = mp_decode_uint(&value);
+			break;
+		case IPROTO_FEATURES:
+			if (mp_typeof(*value) != MP_UINT)
+				goto error;
+			request->features = mp_decode_uint(&value);
+			break;
+		default:
+			continue; /* unknown key */
+		}
+	}
+	if (data != end) {
+		xrow_on_decode_err(row->body[0].iov_base, end, ER_INVALID_MSGPACK,
+				   "packet end");
+		return -1;
+	}
+	return 0;
+}
+
 int
 xrow_encode_auth(struct xrow_header *packet, const char *salt, size_t salt_len,
 		 const char *login, size_t login_len,
@@ -1455,11 +1618,13 @@ xrow_encode_subscribe(struct xrow_header *row,
 		      const struct tt_uuid *replicaset_uuid,
 		      const struct tt_uuid *instance_uuid,
 		      const struct vclock *vclock, bool anon,
-		      uint32_t id_filter)
+		      uint32_t id_filter, const uint32_t *space_filter,
+		      uint32_t space_filter_count)
 {
 	memset(row, 0, sizeof(*row));
 	size_t size = XROW_BODY_LEN_MAX +
-		      mp_sizeof_vclock_ignore0(vclock);
+		      mp_sizeof_vclock_ignore0(vclock) +
+		      space_filter_count * mp_sizeof_uint(UINT32_MAX);
 	char *buf = (char *) region_alloc(&fiber()->gc, size);
 	if (buf == NULL) {
 		diag_set(OutOfMemory, size, "region_alloc", "buf");
@@ -1467,7 +1632,8 @@ xrow_encode_subscribe(struct xrow_header *row,
 	}
 	char *data = buf;
 	int filter_size = bit_count_u32(id_filter);
-	data = mp_encode_map(data, filter_size != 0 ? 6 : 5);
+	data = mp_encode_map(data, 5 + (filter_size != 0 ? 1 : 0) +
+			     (space_filter_count != 0 ? 1 : 0));
 	data = mp_encode_uint(data, IPROTO_CLUSTER_UUID);
 	data = xrow_encode_uuid(data, replicaset_uuid);
 	data = mp_encode_uint(data, IPROTO_INSTANCE_UUID);
@@ -1489,6 +1655,12 @@ xrow_encode_subscribe(struct xrow_header *row,
 			data = mp_encode_uint(data, id);
 		}
 	}
+	if (space_filter_count != 0) {
+		data = mp_encode_uint(data, IPROTO_SPACE_FILTER);
+		data = mp_encode_array(data, space_filter_count);
+		for (uint32_t i = 0; i < space_filter_count; i++)
+			data = mp_encode_uint(data, space_filter[i]);
+	}
 	assert(data <= buf + size);
 	row->body[0].iov_base = buf;
 	row->body[0].iov_len = (data - buf);
@@ -1501,7 +1673,8 @@ int
 xrow_decode_subscribe(struct xrow_header *row, struct tt_uuid *replicaset_uuid,
 		      struct tt_uuid *instance_uuid, struct vclock *vclock,
 		      uint32_t *version_id, bool *anon,
-		      uint32_t *id_filter)
+		      uint32_t *id_filter, uint32_t **space_filter,
+		      uint32_t *space_filter_count)
 {
 	if (row->bodycnt == 0) {
 		diag_set(ClientError, ER_INVALID_MSGPACK, "request body");
@@ -1521,6 +1694,10 @@ xrow_decode_subscribe(struct xrow_header *row, struct tt_uuid *replicaset_uuid,
 		*anon = false;
 	if (id_filter)
 		*id_filter = 0;
+	if (space_filter) {
+		*space_filter = NULL;
+		*space_filter_count = 0;
+	}
 	d = data;
 	uint32_t map_size = mp_decode_map(&d);
 	for (uint32_t i = 0; i < map_size; i++) {
@@ -1596,6 +1773,42 @@ id_filter_decode_err:		xrow_on_decode_err(data, end, ER_INVALID_MSGPACK,
 				*id_filter |= 1 << val;
 			}
 			break;
+		case IPROTO_SPACE_FILTER:
+			if (space_filter == NULL)
+				goto skip;
+			if (mp_typeof(*d) != MP_ARRAY) {
+space_filter_decode_err:	xrow_on_decode_err(data, end, ER_INVALID_MSGPACK,
+						   "invalid SPACE_FILTER");
+				return -1;
+			}
+			uint32_t count = mp_decode_array(&d);
+			uint32_t *filter = NULL;
+			if (count != 0) {
+				filter = (uint32_t *)malloc(count *
+							    sizeof(*filter));
+				if (filter == NULL) {
+					diag_set(OutOfMemory,
+						 count * sizeof(*filter),
+						 "malloc", "space filter");
+					return -1;
+				}
+			}
+			for (uint32_t j = 0; j < count; ++j) {
+				if (mp_typeof(*d) != MP_UINT) {
+					free(filter);
+					goto space_filter_decode_err;
+				}
+				uint64_t val = mp_decode_uint(&d);
+				if (val > UINT32_MAX) {
+					free(filter);
+					goto space_filter_decode_err;
+				}
+				filter[j] = val;
+			}
+			free(*space_filter);
+			*space_filter = filter;
+			*space_filter_count = count;
+			break;
 		default: skip:
 			mp_next(&d); /* value */
 		}
@@ -160,6 +160,11 @@ struct request {
 	uint32_t offset;
 	uint32_t limit;
 	uint32_t iterator;
+	/**
+	 * Number of tuples per IPROTO_CHUNK packet in a streamed
+	 * SELECT response, 0 for an ordinary single-packet reply.
+	 */
+	uint32_t stream;
 	/** Search key. */
 	const char *key;
 	const char *key_end;
@@ -329,6 +334,27 @@ struct auth_request {
 int
 xrow_decode_auth(const struct xrow_header *row, struct auth_request *request);
 
+/**
+ * ID request: the client reports its protocol version and the
+ * optional features it would like to use.
+ */
+struct id_request {
+	/** Protocol version. */
+	uint32_t version;
+	/** Bitmap of the requested features, @sa enum iproto_feature. */
+	uint64_t features;
+};
+
+/**
+ * Decode ID request from MessagePack.
+ * @param row request header.
+ * @param[out] request Request to decode.
+ * @retval  0 on success
+ * @retval -1 on error
+ */
+int
+xrow_decode_id(const struct xrow_header *row, struct id_request *request);
+
 /**
  * Encode AUTH command.
  * @param[out] Row.
@@ -405,6 +431,9 @@ xrow_encode_register(struct xrow_header *row,
  * @param anon Whether it is an anonymous subscribe request or not.
  * @param id_filter A List of replica ids to skip rows from
  *		    when feeding a replica.
+ * @param space_filter A list of space ids the replica wants
+ *		       relayed, NULL to receive everything.
+ * @param space_filter_count Length of @space_filter.
  *
  * @retval  0 Success.
  * @retval -1 Memory error.
@@ -414,7 +443,8 @@ xrow_encode_subscribe(struct xrow_header *row,
 		      const struct tt_uuid *replicaset_uuid,
 		      const struct tt_uuid *instance_uuid,
 		      const struct vclock *vclock, bool anon,
-		      uint32_t id_filter);
+		      uint32_t id_filter, const uint32_t *space_filter,
+		      uint32_t space_filter_count);
 
 /**
  * Decode SUBSCRIBE command.
@@ -426,6 +456,11 @@ xrow_encode_subscribe(struct xrow_header *row,
  * @param[out] anon Whether it is an anonymous subscribe.
  * @param[out] id_filter A list of ids to skip rows from when
  *			 feeding a replica.
+ * @param[out] space_filter A malloc-ed list of space ids the
+ *			    replica wants relayed, NULL if the
+ *			    replica receives everything. The
+ *			    caller owns the memory.
+ * @param[out] space_filter_count Length of @space_filter.
  *
  * @retval  0 Success.
  * @retval -1 Memory or format error.
@@ -434,7 +469,8 @@ int
 xrow_decode_subscribe(struct xrow_header *row, struct tt_uuid *replicaset_uuid,
 		      struct tt_uuid *instance_uuid, struct vclock *vclock,
 		      uint32_t *version_id, bool *anon,
-		      uint32_t *id_filter);
+		      uint32_t *id_filter, uint32_t **space_filter,
+		      uint32_t *space_filter_count);
 
 /**
  * Encode JOIN command.
@@ -625,6 +661,20 @@ int
 iproto_reply_vclock(struct obuf *out, const struct vclock *vclock,
 		    uint64_t sync, uint32_t schema_version);
 
+/**
+ * Encode a reply to an IPROTO_ID request.
+ * @param out Buffer to write to.
+ * @param features Bitmap of the features the server has granted.
+ * @param sync Request sync.
+ * @param schema_version Actual schema version.
+ *
+ * @retval  0 Success.
+ * @retval -1 Memory error.
+ */
+int
+iproto_reply_id(struct obuf *out, uint64_t features, uint64_t sync,
+		uint32_t schema_version);
+
 /**
  * Encode a reply to an IPROTO_VOTE request.
  * @param out Buffer to write to.
@@ -655,6 +705,11 @@ struct sql_request {
 	const char *bind;
 	/** ID of prepared statement. In this case @sql_text == NULL. */
 	const char *stmt_id;
+	/**
+	 * Number of rows per IPROTO_CHUNK packet in a streamed
+	 * DQL response, 0 for an ordinary single-packet reply.
+	 */
+	uint32_t stream;
 };
 
 /**
@@ -686,10 +741,11 @@ iproto_reply_sql(struct obuf *buf, struct obuf_svp *svp, uint64_t sync,
  * @param svp Position to write from.
  * @param sync Request sync.
  * @param schema_version Actual schema version.
+ * @param count Number of tuples in the chunk.
  */
 void
 iproto_reply_chunk(struct obuf *buf, struct obuf_svp *svp, uint64_t sync,
-		   uint32_t schema_version);
+		   uint32_t schema_version, uint32_t count);
 
 /** Write error directly to a socket. */
 void
@@ -908,10 +964,12 @@ xrow_encode_subscribe_xc(struct xrow_header *row,
 			 const struct tt_uuid *replicaset_uuid,
 			 const struct tt_uuid *instance_uuid,
 			 const struct vclock *vclock, bool anon,
-			 uint32_t id_filter)
+			 uint32_t id_filter, const uint32_t *space_filter,
+			 uint32_t space_filter_count)
 {
 	if (xrow_encode_subscribe(row, replicaset_uuid, instance_uuid,
-				  vclock, anon, id_filter) != 0)
+				  vclock, anon, id_filter, space_filter,
+				  space_filter_count) != 0)
 		diag_raise();
 }
 
@@ -921,11 +979,13 @@ xrow_decode_subscribe_xc(struct xrow_header *row,
 			 struct tt_uuid *replicaset_uuid,
 			 struct tt_uuid *instance_uuid, struct vclock *vclock,
 			 uint32_t *replica_version_id, bool *anon,
-			 uint32_t *id_filter)
+			 uint32_t *id_filter, uint32_t **space_filter,
+			 uint32_t *space_filter_count)
 {
 	if (xrow_decode_subscribe(row, replicaset_uuid, instance_uuid,
 				  vclock, replica_version_id, anon,
-				  id_filter) != 0)
+				  id_filter, space_filter,
+				  space_filter_count) != 0)
 		diag_raise();
 }
 
@@ -1017,6 +1077,15 @@ iproto_reply_vote_xc(struct obuf *out, const struct ballot *ballot,
 		diag_raise();
 }
 
+/** @copydoc iproto_reply_id. */
+static inline void
+iproto_reply_id_xc(struct obuf *out, uint64_t features, uint64_t sync,
+		   uint32_t schema_version)
+{
+	if (iproto_reply_id(out, features, sync, schema_version) != 0)
+		diag_raise();
+}
+
 #endif
 
 #endif /* TARANTOOL_XROW_H_INCLUDED */
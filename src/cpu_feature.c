@@ -114,6 +114,207 @@ sse42_enabled_cpu()
 	return (cx & (1 << 20)) != 0;
 }
 
+bool
+sha_ni_enabled_cpu()
+{
+	unsigned int ax, bx, cx, dx;
+
+	if (__get_cpuid_count(7, 0, &ax, &bx, &cx, &dx) == 0)
+		return false;
+
+	return (bx & (1 << 29)) != 0;
+}
+
+/*
+ * The SHA extension has no compact .byte encoding like the CRC32
+ * instructions above (the message schedule lives in xmm
+ * registers), so it is written with intrinsics and a per-function
+ * target attribute instead of compiling the whole file with -msha.
+ */
+#include <immintrin.h>
+
+__attribute__((target("sha,sse4.1")))
+void
+sha1_transform_hw(uint32_t state[5], const unsigned char buffer[64])
+{
+	__m128i abcd, abcd_save, e0, e0_save, e1;
+	__m128i msg0, msg1, msg2, msg3;
+	const __m128i shuf_mask = _mm_set_epi64x(0x0001020304050607ULL,
+						 0x08090a0b0c0d0e0fULL);
+
+	/* Load and byte-swap the state and the message block. */
+	abcd = _mm_loadu_si128((const __m128i *)state);
+	abcd = _mm_shuffle_epi32(abcd, 0x1b);
+	e0 = _mm_set_epi32(state[4], 0, 0, 0);
+	abcd_save = abcd;
+	e0_save = e0;
+
+	msg0 = _mm_loadu_si128((const __m128i *)(buffer + 0));
+	msg1 = _mm_loadu_si128((const __m128i *)(buffer + 16));
+	msg2 = _mm_loadu_si128((const __m128i *)(buffer + 32));
+	msg3 = _mm_loadu_si128((const __m128i *)(buffer + 48));
+	msg0 = _mm_shuffle_epi8(msg0, shuf_mask);
+	msg1 = _mm_shuffle_epi8(msg1, shuf_mask);
+	msg2 = _mm_shuffle_epi8(msg2, shuf_mask);
+	msg3 = _mm_shuffle_epi8(msg3, shuf_mask);
+
+	/* Rounds 0-3 */
+	e0 = _mm_add_epi32(e0, msg0);
+	e1 = abcd;
+	abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+
+	/* Rounds 4-7 */
+	e1 = _mm_sha1nexte_epu32(e1, msg1);
+	e0 = abcd;
+	abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+	msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+
+	/* Rounds 8-11 */
+	e0 = _mm_sha1nexte_epu32(e0, msg2);
+	e1 = abcd;
+	abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+	msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+	msg0 = _mm_xor_si128(msg0, msg2);
+
+	/* Rounds 12-15 */
+	e1 = _mm_sha1nexte_epu32(e1, msg3);
+	e0 = abcd;
+	msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+	abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+	msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+	msg1 = _mm_xor_si128(msg1, msg3);
+
+	/* Rounds 16-19 */
+	e0 = _mm_sha1nexte_epu32(e0, msg0);
+	e1 = abcd;
+	msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+	abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+	msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+	msg2 = _mm_xor_si128(msg2, msg0);
+
+	/* Rounds 20-23 */
+	e1 = _mm_sha1nexte_epu32(e1, msg1);
+	e0 = abcd;
+	msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+	abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+	msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+	msg3 = _mm_xor_si128(msg3, msg1);
+
+	/* Rounds 24-27 */
+	e0 = _mm_sha1nexte_epu32(e0, msg2);
+	e1 = abcd;
+	msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+	abcd = _mm_sha1rnds4_epu32(abcd, e0, 1);
+	msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+	msg0 = _mm_xor_si128(msg0, msg2);
+
+	/* Rounds 28-31 */
+	e1 = _mm_sha1nexte_epu32(e1, msg3);
+	e0 = abcd;
+	msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+	abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+	msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+	msg1 = _mm_xor_si128(msg1, msg3);
+
+	/* Rounds 32-35 */
+	e0 = _mm_sha1nexte_epu32(e0, msg0);
+	e1 = abcd;
+	msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+	abcd = _mm_sha1rnds4_epu32(abcd, e0, 1);
+	msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+	msg2 = _mm_xor_si128(msg2, msg0);
+
+	/* Rounds 36-39 */
+	e1 = _mm_sha1nexte_epu32(e1, msg1);
+	e0 = abcd;
+	msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+	abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+	msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+	msg3 = _mm_xor_si128(msg3, msg1);
+
+	/* Rounds 40-43 */
+	e0 = _mm_sha1nexte_epu32(e0, msg2);
+	e1 = abcd;
+	msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+	abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+	msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+	msg0 = _mm_xor_si128(msg0, msg2);
+
+	/* Rounds 44-47 */
+	e1 = _mm_sha1nexte_epu32(e1, msg3);
+	e0 = abcd;
+	msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+	abcd = _mm_sha1rnds4_epu32(abcd, e1, 2);
+	msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+	msg1 = _mm_xor_si128(msg1, msg3);
+
+	/* Rounds 48-51 */
+	e0 = _mm_sha1nexte_epu32(e0, msg0);
+	e1 = abcd;
+	msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+	abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+	msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+	msg2 = _mm_xor_si128(msg2, msg0);
+
+	/* Rounds 52-55 */
+	e1 = _mm_sha1nexte_epu32(e1, msg1);
+	e0 = abcd;
+	msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+	abcd = _mm_sha1rnds4_epu32(abcd, e1, 2);
+	msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+	msg3 = _mm_xor_si128(msg3, msg1);
+
+	/* Rounds 56-59 */
+	e0 = _mm_sha1nexte_epu32(e0, msg2);
+	e1 = abcd;
+	msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+	abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+	msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+	msg0 = _mm_xor_si128(msg0, msg2);
+
+	/* Rounds 60-63 */
+	e1 = _mm_sha1nexte_epu32(e1, msg3);
+	e0 = abcd;
+	msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+	abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+	msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+	msg1 = _mm_xor_si128(msg1, msg3);
+
+	/* Rounds 64-67 */
+	e0 = _mm_sha1nexte_epu32(e0, msg0);
+	e1 = abcd;
+	msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+	abcd = _mm_sha1rnds4_epu32(abcd, e0, 3);
+	msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+	msg2 = _mm_xor_si128(msg2, msg0);
+
+	/* Rounds 68-71 */
+	e1 = _mm_sha1nexte_epu32(e1, msg1);
+	e0 = abcd;
+	msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+	abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+	msg3 = _mm_xor_si128(msg3, msg1);
+
+	/* Rounds 72-75 */
+	e0 = _mm_sha1nexte_epu32(e0, msg2);
+	e1 = abcd;
+	msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+	abcd = _mm_sha1rnds4_epu32(abcd, e0, 3);
+
+	/* Rounds 76-79 */
+	e1 = _mm_sha1nexte_epu32(e1, msg3);
+	e0 = abcd;
+	abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+
+	/* Add the saved state back in. */
+	e0 = _mm_sha1nexte_epu32(e0, e0_save);
+	abcd = _mm_add_epi32(abcd, abcd_save);
+
+	abcd = _mm_shuffle_epi32(abcd, 0x1b);
+	_mm_storeu_si128((__m128i *)state, abcd);
+	state[4] = _mm_extract_epi32(e0, 3);
+}
+
 #else /* !(defined (__x86_64__) || defined (__i386__)) */
 
 bool
@@ -122,4 +323,97 @@ sse42_enabled_cpu()
 	return false;
 }
 
+bool
+sha_ni_enabled_cpu()
+{
+	return false;
+}
+
+#endif
+
+#if defined(__aarch64__)
+
+#if defined(__linux__)
+#include <sys/auxv.h>
+#endif
+
+/*
+ * The CRC32 instructions are an optional ARMv8 extension, so
+ * they are emitted as inline assembly with an explicit
+ * .arch_extension directive rather than via <arm_acle.h>
+ * intrinsics: this way the file does not have to be compiled
+ * with -march=armv8-a+crc, mirroring the .byte encoding used
+ * for SSE 4.2 above.
+ */
+static inline uint32_t
+crc32c_hw_u8(uint32_t crc, uint8_t data)
+{
+	__asm__ __volatile__(
+		".arch_extension crc\n"
+		"crc32cb %w0, %w0, %w1"
+		: "+r"(crc)
+		: "r"(data)
+	);
+	return crc;
+}
+
+static inline uint32_t
+crc32c_hw_u64(uint32_t crc, uint64_t data)
+{
+	__asm__ __volatile__(
+		".arch_extension crc\n"
+		"crc32cx %w0, %w0, %x1"
+		: "+r"(crc)
+		: "r"(data)
+	);
+	return crc;
+}
+
+uint32_t
+crc32c_hw(uint32_t crc, const char *buf, unsigned int len)
+{
+	/*
+	 * Process the unaligned prefix byte-by-byte, then the
+	 * bulk of the buffer a doubleword at a time: aligned
+	 * loads are both faster and free of undefined behaviour.
+	 */
+	while (len > 0 && (unsigned long)buf % alignof(uint64_t) != 0) {
+		crc = crc32c_hw_u8(crc, *(const uint8_t *)buf);
+		buf++;
+		len--;
+	}
+	while (len >= sizeof(uint64_t)) {
+		crc = crc32c_hw_u64(crc, *(const uint64_t *)buf);
+		buf += sizeof(uint64_t);
+		len -= sizeof(uint64_t);
+	}
+	while (len > 0) {
+		crc = crc32c_hw_u8(crc, *(const uint8_t *)buf);
+		buf++;
+		len--;
+	}
+	return crc;
+}
+
+bool
+crc32_armv8_enabled_cpu()
+{
+#if defined(__linux__) && defined(HWCAP_CRC32)
+	return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+#elif defined(__APPLE__)
+	/* All Apple ARMv8 cores implement the CRC32 extension. */
+	return true;
+#else
+	return false;
+#endif
+}
+
+#else /* !defined(__aarch64__) */
+
+bool
+crc32_armv8_enabled_cpu()
+{
+	return false;
+}
+
 #endif
@@ -34,6 +34,10 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
 /* Check whether CPU supports SSE 4.2 (needed to compute CRC32 in hardware).
  *
  * @param	feature		indetifier (see above) of the target feature
@@ -42,7 +46,31 @@
  */
 bool sse42_enabled_cpu();
 
+/* Check whether CPU supports the optional ARMv8 CRC32 instructions
+ * (needed to compute CRC32 in hardware on aarch64).
+ *
+ * @return	true if the instructions are available.
+ */
+bool crc32_armv8_enabled_cpu();
+
+/* Check whether CPU supports the x86 SHA extension (needed to
+ * compute SHA1 in hardware).
+ *
+ * @return	true if the instructions are available.
+ */
+bool sha_ni_enabled_cpu();
+
 #if defined (__x86_64__) || defined (__i386__)
+/* Hash a single 512-bit SHA1 block using the SHA instruction set.
+ * A drop-in replacement for SHA1Transform() from
+ * third_party/sha1.h, installed into sha1_transform at startup.
+ *
+ * @pre 	true == sha_ni_enabled_cpu()
+ */
+void sha1_transform_hw(uint32_t state[5], const unsigned char buffer[64]);
+#endif
+
+#if defined (__x86_64__) || defined (__i386__) || defined (__aarch64__)
 /* Hardware-calculate CRC32 for the given data buffer.
  *
  * @param	crc 		initial CRC
@@ -55,5 +83,9 @@ bool sse42_enabled_cpu();
 uint32_t crc32c_hw(uint32_t crc, const char *buf, unsigned int len);
 #endif
 
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif
+
 #endif /* TARANTOOL_CPU_FEATURES_H */
 
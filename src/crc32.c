@@ -44,6 +44,8 @@ crc32_init(void)
 {
 #if defined(HAVE_CPUID) && (defined (__x86_64__) || defined (__i386__))
 	crc32_calc = sse42_enabled_cpu() ? &crc32c_hw : &crc32c;
+#elif defined(__aarch64__)
+	crc32_calc = crc32_armv8_enabled_cpu() ? &crc32c_hw : &crc32c;
 #else
 	crc32_calc = &crc32c;
 #endif
@@ -220,7 +220,8 @@ curl_multi_sock_cb(CURL *easy, curl_socket_t fd, int what, void *envp,
 
 
 int
-curl_env_create(struct curl_env *env, long max_conns, long max_total_conns)
+curl_env_create(struct curl_env *env, long max_conns, long max_total_conns,
+		long max_host_conns)
 {
 	memset(env, 0, sizeof(*env));
 	mempool_create(&env->sock_pool, &cord()->slabc,
@@ -245,8 +246,19 @@ curl_env_create(struct curl_env *env, long max_conns, long max_total_conns)
 	curl_multi_setopt(env->multi, CURLMOPT_MAXCONNECTS, max_conns);
 #if LIBCURL_VERSION_NUM >= 0x071e00
 	curl_multi_setopt(env->multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, max_total_conns);
+	curl_multi_setopt(env->multi, CURLMOPT_MAX_HOST_CONNECTIONS,
+			  max_host_conns);
 #else
 	(void) max_total_conns;
+	(void) max_host_conns;
+#endif
+#if LIBCURL_VERSION_NUM >= 0x072b00
+	/*
+	 * Let concurrent requests to the same host share one
+	 * HTTP/2 connection instead of each opening its own.
+	 */
+	curl_multi_setopt(env->multi, CURLMOPT_PIPELINING,
+			  CURLPIPE_MULTIPLEX);
 #endif
 
 	return 0;
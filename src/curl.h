@@ -83,11 +83,16 @@ struct curl_request {
  * @brief Create a new CURL environment
  * @param env pointer to a structure to initialize
  * @param max_conn The maximum number of entries in connection cache
+ * @param max_total_conns The maximum number of simultaneously
+ *        open connections, 0 for no limit
+ * @param max_host_conns The maximum number of simultaneously
+ *        open connections to a single host, 0 for no limit
  * @retval 0 on success
  * @retval -1 on error, check diag
  */
 int
-curl_env_create(struct curl_env *env, long max_conns, long max_total_conns);
+curl_env_create(struct curl_env *env, long max_conns, long max_total_conns,
+		long max_host_conns);
 
 /**
  * Destroy HTTP client environment
@@ -54,9 +54,12 @@ EXPORT(box_region_truncate)
 EXPORT(box_region_used)
 EXPORT(box_replace)
 EXPORT(box_return_mp)
+EXPORT(box_return_mp_commit)
+EXPORT(box_return_mp_reserve)
 EXPORT(box_return_tuple)
 EXPORT(box_schema_version)
 EXPORT(box_select)
+EXPORT(box_select_after)
 EXPORT(box_sequence_current)
 EXPORT(box_sequence_next)
 EXPORT(box_sequence_reset)
@@ -108,7 +111,9 @@ EXPORT(clock_thread64)
 EXPORT(clock_thread)
 EXPORT(coio_call)
 EXPORT(coio_close)
+EXPORT(coio_freeaddrinfo)
 EXPORT(coio_getaddrinfo)
+EXPORT(coio_getaddrinfo_cached)
 EXPORT(coio_wait)
 EXPORT(console_get_output_format)
 EXPORT(console_set_output_format)
@@ -455,6 +460,10 @@ EXPORT(PMurHash32_Process)
 EXPORT(PMurHash32_Result)
 EXPORT(port_destroy)
 EXPORT(random_bytes)
+EXPORT(routing_table_create)
+EXPORT(routing_table_destroy)
+EXPORT(routing_table_rebalance)
+EXPORT(routing_table_route)
 EXPORT(_say)
 EXPORT(say_logger_init)
 EXPORT(say_logger_initialized)
@@ -511,6 +520,8 @@ EXPORT(tnt_iconv_open)
 EXPORT(tt_uuid_bswap)
 EXPORT(tt_uuid_compare)
 EXPORT(tt_uuid_create)
+EXPORT(tt_uuid_create_batch)
+EXPORT(tt_uuid_create_v7)
 EXPORT(tt_uuid_from_string)
 EXPORT(tt_uuid_is_equal)
 EXPORT(tt_uuid_is_nil)
@@ -0,0 +1,199 @@
+/*
+ * Copyright 2010-2021, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "hdr_histogram.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <pmatomic.h>
+
+#include "bit/bit.h"
+#include "trivia/util.h"
+
+/**
+ * The exponential bucket a value falls into: bucket 0 spans
+ * [0, sub_bucket_count) units, every following bucket doubles
+ * the range and the sub-bucket width.
+ */
+static inline int
+hdr_bucket_index(const struct hdr_histogram *hdr, int64_t value)
+{
+	int pow2ceiling = 64 - bit_clz_u64(value | hdr->sub_bucket_mask);
+	return pow2ceiling - hdr->unit_magnitude -
+	       (hdr->sub_bucket_half_count_magnitude + 1);
+}
+
+static inline int
+hdr_sub_bucket_index(const struct hdr_histogram *hdr, int64_t value,
+		     int bucket_index)
+{
+	return (int)(value >> (bucket_index + hdr->unit_magnitude));
+}
+
+/**
+ * The flat counts index: the lower half of every bucket past the
+ * first aliases the upper half of the previous one, so each
+ * bucket contributes only sub_bucket_half_count fresh slots.
+ */
+static inline int
+hdr_counts_index(const struct hdr_histogram *hdr, int64_t value)
+{
+	int bucket_index = hdr_bucket_index(hdr, value);
+	int sub_bucket_index = hdr_sub_bucket_index(hdr, value, bucket_index);
+	return ((bucket_index + 1) << hdr->sub_bucket_half_count_magnitude) +
+	       (sub_bucket_index - hdr->sub_bucket_half_count);
+}
+
+/** The highest value mapping to the given counts index. */
+static int64_t
+hdr_highest_value_at_index(const struct hdr_histogram *hdr, int index)
+{
+	int bucket_index = (index >> hdr->sub_bucket_half_count_magnitude) - 1;
+	int sub_bucket_index = (index & (hdr->sub_bucket_half_count - 1)) +
+			       hdr->sub_bucket_half_count;
+	if (bucket_index < 0) {
+		sub_bucket_index -= hdr->sub_bucket_half_count;
+		bucket_index = 0;
+	}
+	int shift = bucket_index + hdr->unit_magnitude;
+	return (((int64_t) sub_bucket_index + 1) << shift) - 1;
+}
+
+struct hdr_histogram *
+hdr_histogram_new(int64_t lowest_trackable, int64_t highest_trackable,
+		  int significant_digits)
+{
+	assert(lowest_trackable >= 1);
+	assert(highest_trackable > lowest_trackable * 2);
+	assert(significant_digits >= 1 && significant_digits <= 5);
+
+	/*
+	 * Enough linear sub-buckets to tell apart values which
+	 * differ in the requested decimal digit at any magnitude:
+	 * the largest value with single-unit resolution is
+	 * 2 * 10^digits, rounded up to a power of two.
+	 */
+	int64_t largest_single_unit = 2;
+	for (int i = 0; i < significant_digits; i++)
+		largest_single_unit *= 10;
+	int sub_bucket_half_count_magnitude = 0;
+	while ((1 << (sub_bucket_half_count_magnitude + 1)) <
+	       largest_single_unit)
+		sub_bucket_half_count_magnitude++;
+
+	int unit_magnitude = 63 - bit_clz_u64(lowest_trackable);
+	int32_t sub_bucket_count = 1 << (sub_bucket_half_count_magnitude + 1);
+
+	int32_t bucket_count = 1;
+	int64_t smallest_untrackable =
+		(int64_t) sub_bucket_count << unit_magnitude;
+	while (smallest_untrackable <= highest_trackable) {
+		if (smallest_untrackable > INT64_MAX / 2) {
+			bucket_count++;
+			break;
+		}
+		smallest_untrackable <<= 1;
+		bucket_count++;
+	}
+	int32_t counts_len = (bucket_count + 1) <<
+			     sub_bucket_half_count_magnitude;
+
+	struct hdr_histogram *hdr =
+		malloc(sizeof(*hdr) + counts_len * sizeof(*hdr->counts));
+	if (hdr == NULL)
+		return NULL;
+	hdr->lowest_trackable = lowest_trackable;
+	hdr->highest_trackable = highest_trackable;
+	hdr->unit_magnitude = unit_magnitude;
+	hdr->sub_bucket_half_count_magnitude = sub_bucket_half_count_magnitude;
+	hdr->sub_bucket_count = sub_bucket_count;
+	hdr->sub_bucket_half_count = sub_bucket_count / 2;
+	hdr->sub_bucket_mask = (int64_t)(sub_bucket_count - 1) <<
+			       unit_magnitude;
+	hdr->bucket_count = bucket_count;
+	hdr->counts_len = counts_len;
+	hdr->total = 0;
+	memset(hdr->counts, 0, counts_len * sizeof(*hdr->counts));
+	return hdr;
+}
+
+void
+hdr_histogram_delete(struct hdr_histogram *hdr)
+{
+	free(hdr);
+}
+
+void
+hdr_histogram_record(struct hdr_histogram *hdr, int64_t value)
+{
+	if (value < hdr->lowest_trackable)
+		value = hdr->lowest_trackable;
+	else if (value > hdr->highest_trackable)
+		value = hdr->highest_trackable;
+	int index = hdr_counts_index(hdr, value);
+	assert(index >= 0 && index < hdr->counts_len);
+	pm_atomic_fetch_add_explicit(&hdr->counts[index], 1,
+				     pm_memory_order_relaxed);
+	pm_atomic_fetch_add_explicit(&hdr->total, 1,
+				     pm_memory_order_relaxed);
+}
+
+int64_t
+hdr_histogram_total(struct hdr_histogram *hdr)
+{
+	return pm_atomic_load_explicit(&hdr->total, pm_memory_order_relaxed);
+}
+
+int64_t
+hdr_histogram_percentile(struct hdr_histogram *hdr, double pct)
+{
+	int64_t total = hdr_histogram_total(hdr);
+	if (total == 0)
+		return 0;
+	double target = pct / 100 * total;
+	int64_t count = 0;
+	for (int i = 0; i < hdr->counts_len; i++) {
+		count += pm_atomic_load_explicit(&hdr->counts[i],
+						 pm_memory_order_relaxed);
+		if (count >= target && count > 0)
+			return hdr_highest_value_at_index(hdr, i);
+	}
+	return hdr->highest_trackable;
+}
+
+void
+hdr_histogram_reset(struct hdr_histogram *hdr)
+{
+	pm_atomic_store(&hdr->total, 0);
+	for (int i = 0; i < hdr->counts_len; i++)
+		pm_atomic_store(&hdr->counts[i], 0);
+}
@@ -0,0 +1,123 @@
+#ifndef TARANTOOL_HDR_HISTOGRAM_H_INCLUDED
+#define TARANTOOL_HDR_HISTOGRAM_H_INCLUDED
+/*
+ * Copyright 2010-2021, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/**
+ * A log-linear (HDR) histogram: the value range is covered by
+ * exponentially growing buckets, each split into enough linear
+ * sub-buckets to resolve the configured number of significant
+ * decimal digits at any magnitude. Unlike struct histogram there
+ * is no bucket list to pick: the precision holds equally at the
+ * median and at the 99.99th percentile, and recording is a shift,
+ * a clz and one relaxed atomic increment, so any thread may
+ * record into a histogram another thread reads.
+ *
+ * Percentile queries are not atomic with respect to concurrent
+ * recording - a reader may see a count that is a few records
+ * stale, which is fine for statistics.
+ */
+struct hdr_histogram {
+	/** Values below are recorded as lowest_trackable. */
+	int64_t lowest_trackable;
+	/** Values above are clamped to highest_trackable. */
+	int64_t highest_trackable;
+	/** log2 of lowest_trackable, the unit shift. */
+	int unit_magnitude;
+	/** log2 of the linear sub-bucket count per bucket. */
+	int sub_bucket_half_count_magnitude;
+	/** Linear sub-buckets per bucket, a power of two. */
+	int32_t sub_bucket_count;
+	int32_t sub_bucket_half_count;
+	/** Mask of the sub-bucket bits at the unit shift. */
+	int64_t sub_bucket_mask;
+	/** Exponential buckets covering up to highest_trackable. */
+	int32_t bucket_count;
+	/** Length of counts. */
+	int32_t counts_len;
+	/** Total number of recorded values. */
+	int64_t total;
+	int64_t counts[0];
+};
+
+/**
+ * Create a histogram tracking [lowest_trackable,
+ * highest_trackable] with the given number of significant decimal
+ * digits, from 1 to 5. lowest_trackable sets the unit below which
+ * values are not distinguished (e.g. 1 for microsecond latency
+ * tracking in microseconds). Returns NULL on OOM.
+ */
+struct hdr_histogram *
+hdr_histogram_new(int64_t lowest_trackable, int64_t highest_trackable,
+		  int significant_digits);
+
+void
+hdr_histogram_delete(struct hdr_histogram *hdr);
+
+/**
+ * Record a value. Lock free: safe from any thread concurrently
+ * with other recorders and readers. Out-of-range values are
+ * clamped into the tracked range.
+ */
+void
+hdr_histogram_record(struct hdr_histogram *hdr, int64_t value);
+
+/**
+ * The value below which @a pct percent of the recorded values
+ * fall, as an upper bound of the matching sub-bucket. @a pct may
+ * be fractional, e.g. 99.99. Returns 0 on an empty histogram.
+ */
+int64_t
+hdr_histogram_percentile(struct hdr_histogram *hdr, double pct);
+
+/** Total number of recorded values. */
+int64_t
+hdr_histogram_total(struct hdr_histogram *hdr);
+
+/**
+ * Forget everything recorded so far. Not atomic with respect to
+ * concurrent recording: values recorded during the reset may be
+ * partially lost.
+ */
+void
+hdr_histogram_reset(struct hdr_histogram *hdr);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif
+
+#endif /* TARANTOOL_HDR_HISTOGRAM_H_INCLUDED */
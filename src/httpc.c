@@ -85,13 +85,15 @@ curl_easy_header_cb(char *buffer, size_t size, size_t nitems, void *ctx)
 }
 
 int
-httpc_env_create(struct httpc_env *env, int max_conns, int max_total_conns)
+httpc_env_create(struct httpc_env *env, int max_conns, int max_total_conns,
+		 int max_host_conns)
 {
 	memset(env, 0, sizeof(*env));
 	mempool_create(&env->req_pool, &cord()->slabc,
 			sizeof(struct httpc_request));
 
-	return curl_env_create(&env->curl_env, max_conns, max_total_conns);
+	return curl_env_create(&env->curl_env, max_conns, max_total_conns,
+			       max_host_conns);
 }
 
 void
@@ -155,8 +157,21 @@ httpc_request_new(struct httpc_env *env, const char *method,
 	curl_easy_setopt(req->curl_request.easy, CURLOPT_HEADERFUNCTION,
 			 curl_easy_header_cb);
 	curl_easy_setopt(req->curl_request.easy, CURLOPT_NOPROGRESS, 1L);
+#if LIBCURL_VERSION_NUM >= 0x072f00
+	/*
+	 * Negotiate HTTP/2 via ALPN on TLS connections and fall
+	 * back to HTTP/1.1 everywhere else. Together with
+	 * CURLOPT_PIPEWAIT this lets concurrent requests
+	 * multiplex over one connection instead of each paying a
+	 * TCP and TLS handshake.
+	 */
+	curl_easy_setopt(req->curl_request.easy, CURLOPT_HTTP_VERSION,
+			 CURL_HTTP_VERSION_2TLS);
+	curl_easy_setopt(req->curl_request.easy, CURLOPT_PIPEWAIT, 1L);
+#else
 	curl_easy_setopt(req->curl_request.easy, CURLOPT_HTTP_VERSION,
 			 CURL_HTTP_VERSION_1_1);
+#endif
 
 	ibuf_create(&req->body, &cord()->slabc, 1);
 
@@ -407,6 +422,8 @@ httpc_execute(struct httpc_request *req, double timeout)
 	long longval = 0;
 	switch (req->curl_request.code) {
 	case CURLE_OK:
+		curl_easy_getinfo(req->curl_request.easy, CURLINFO_NUM_CONNECTS, &longval);
+		env->stat.total_connections += longval;
 		curl_easy_getinfo(req->curl_request.easy, CURLINFO_RESPONSE_CODE, &longval);
 		req->status = (int) longval;
 
@@ -54,6 +54,12 @@ struct httpc_stat {
 	uint64_t http_other_responses;
 	uint64_t failed_requests;
 	uint64_t active_requests;
+	/**
+	 * Number of connections libcurl had to open to serve the
+	 * requests. The closer it is to total_requests, the worse
+	 * the keepalive connection cache performs.
+	 */
+	uint64_t total_connections;
 };
 
 /**
@@ -72,11 +78,16 @@ struct httpc_env {
  * @brief Creates  new HTTP client environment
  * @param env pointer to a structure to initialize
  * @param max_conn The maximum number of entries in connection cache
+ * @param max_total_conns The maximum number of simultaneously
+ *        open connections, 0 for no limit
+ * @param max_host_conns The maximum number of simultaneously
+ *        open connections to a single host, 0 for no limit
  * @retval 0 on success
  * @retval -1 on error, check diag
  */
 int
-httpc_env_create(struct httpc_env *ctx, int max_conns, int max_total_conns);
+httpc_env_create(struct httpc_env *ctx, int max_conns, int max_total_conns,
+		 int max_host_conns);
 
 /**
  * Destroy HTTP client environment
@@ -32,66 +32,57 @@
 
 #include <stdint.h>
 
-#include "histogram.h"
+#include "hdr_histogram.h"
 #include "trivia/util.h"
 
 enum {
-	USEC_PER_MSEC		= 1000,
 	USEC_PER_SEC		= 1000000,
+	/**
+	 * The tracked range, 1 usec to 100 sec: anything slower
+	 * is hopeless anyway and is clamped.
+	 */
+	LATENCY_MAX_USEC	= 100 * USEC_PER_SEC,
+	/**
+	 * Two significant decimal digits, i.e. a 1% worst case
+	 * quantization error at any magnitude - against the old
+	 * fixed bucket list which was off by up to 90% between
+	 * the decades.
+	 */
+	LATENCY_PRECISION	= 2,
 };
 
 int
 latency_create(struct latency *latency)
 {
-	enum { US = 1, MS = USEC_PER_MSEC, S = USEC_PER_SEC };
-	static int64_t buckets[] = {
-		  1 * US,   2 * US,   3 * US,   4 * US,   5 * US,   6 * US,
-		  7 * US,   8 * US,   9 * US,
-		 10 * US,  20 * US,  30 * US,  40 * US,  50 * US,  60 * US,
-		 70 * US,  80 * US,  90 * US,
-		100 * US, 200 * US, 300 * US, 400 * US, 500 * US, 600 * US,
-		700 * US, 800 * US, 900 * US,
-		  1 * MS,   2 * MS,   3 * MS,   4 * MS,   5 * MS,   6 * MS,
-		  7 * MS,   8 * MS,   9 * MS,
-		 10 * MS,  20 * MS,  30 * MS,  40 * MS,  50 * MS,  60 * MS,
-		 70 * MS,  80 * MS,  90 * MS,
-		100 * MS, 200 * MS, 300 * MS, 400 * MS, 500 * MS, 600 * MS,
-		700 * MS, 800 * MS, 900 * MS,
-		  1 * S,    2 * S,    3 * S,    4 * S,    5 * S,    6 * S,
-		  7 * S,    8 * S,    9 * S,   10 * S,
-	};
-
-	latency->histogram = histogram_new(buckets, lengthof(buckets));
+	latency->histogram = hdr_histogram_new(1, LATENCY_MAX_USEC,
+					       LATENCY_PRECISION);
 	if (latency->histogram == NULL)
 		return -1;
-
-	histogram_collect(latency->histogram, 0);
 	return 0;
 }
 
 void
 latency_destroy(struct latency *latency)
 {
-	histogram_delete(latency->histogram);
+	hdr_histogram_delete(latency->histogram);
 }
 
 void
 latency_reset(struct latency *latency)
 {
-	histogram_reset(latency->histogram);
-	histogram_collect(latency->histogram, 0);
+	hdr_histogram_reset(latency->histogram);
 }
 
 void
 latency_collect(struct latency *latency, double value)
 {
 	int64_t value_usec = value * USEC_PER_SEC;
-	histogram_collect(latency->histogram, value_usec);
+	hdr_histogram_record(latency->histogram, value_usec);
 }
 
 double
 latency_get(struct latency *latency, int pct)
 {
-	int64_t value_usec = histogram_percentile(latency->histogram, pct);
+	int64_t value_usec = hdr_histogram_percentile(latency->histogram, pct);
 	return (double)value_usec / USEC_PER_SEC;
 }
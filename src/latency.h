@@ -31,17 +31,17 @@
  * SUCH DAMAGE.
  */
 
-struct histogram;
+struct hdr_histogram;
 
 /**
  * Latency counter.
  */
 struct latency {
 	/**
-	 * Histogram of all latency observations,
+	 * HDR histogram of all latency observations,
 	 * in microseconds.
 	 */
-	struct histogram *histogram;
+	struct hdr_histogram *histogram;
 };
 
 /**
@@ -311,12 +311,29 @@ tt_bitset_iterator_conj_prepare_page(struct tt_bitset_iterator_conj *conj,
 	assert(conj->size > 0);
 	assert(conj->page_first_pos != SIZE_MAX);
 
-	tt_bitset_page_set_ones(dst);
+	bool inited = false;
 	for (size_t b = 0; b < conj->size; b++) {
 		if (!conj->pre_nots[b]) {
 			/* conj->pages[b] is rewinded to conj->page_first_pos */
 			assert(conj->pages[b]->first_pos == conj->page_first_pos);
+			if (!inited) {
+				/*
+				 * AND with an all-ones page is a plain
+				 * copy - skip the extra pass over dst.
+				 */
+				tt_bitset_page_copy_data(dst, conj->pages[b]);
+				inited = true;
+				continue;
+			}
 			tt_bitset_page_and(dst, conj->pages[b]);
+			/*
+			 * AND and NAND can only clear bits, so once
+			 * the page becomes all-zero the result is
+			 * known and the remaining bitsets can be
+			 * skipped.
+			 */
+			if (tt_bitset_page_is_zero(dst))
+				return;
 		} else {
 			/*
 			 * If page is NULL or its position is not equal
@@ -330,9 +347,18 @@ tt_bitset_iterator_conj_prepare_page(struct tt_bitset_iterator_conj *conj,
 			    conj->pages[b]->first_pos != conj->page_first_pos)
 				continue;
 
+			if (!inited) {
+				tt_bitset_page_set_ones(dst);
+				inited = true;
+			}
 			tt_bitset_page_nand(dst, conj->pages[b]);
+			if (tt_bitset_page_is_zero(dst))
+				return;
 		}
 	}
+	/* A conjunction of NOTs only, none of which had the page. */
+	if (!inited)
+		tt_bitset_page_set_ones(dst);
 }
 
 static void
@@ -360,6 +386,9 @@ tt_bitset_iterator_prepare_page(struct tt_bitset_iterator *it)
 		/* Get result from conj */
 		tt_bitset_iterator_conj_prepare_page(&it->conjs[c],
 						     it->page_tmp);
+		/* An all-zero page can not contribute to the OR */
+		if (tt_bitset_page_is_zero(it->page_tmp))
+			continue;
 		/* OR page from conjunction with it->page */
 		tt_bitset_page_or(it->page, it->page_tmp);
 	}
@@ -49,6 +49,12 @@
 #include <limits.h>
 #include <assert.h>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #if defined(__cplusplus)
 extern "C" {
 #endif /* defined(__cplusplus) */
@@ -58,10 +64,16 @@ enum {
 	BITSET_PAGE_DATA_SIZE = 160
 };
 
-#if defined(ENABLE_AVX)
+/*
+ * Page logic ops work on the widest integer type the target
+ * provides. gcc and clang support the bitwise operators directly
+ * on the vector types, so the op loops below stay generic; only
+ * tt_bitset_page_is_zero() needs intrinsics.
+ */
+#if defined(__AVX2__)
 typedef __m256i tt_bitset_word_t;
 #define BITSET_PAGE_DATA_ALIGNMENT 32
-#elif defined(ENABLE_SSE2)
+#elif defined(__SSE2__)
 typedef __m128i tt_bitset_word_t;
 #define BITSET_PAGE_DATA_ALIGNMENT 16
 #elif defined(__x86_64__)
@@ -174,6 +186,37 @@ tt_bitset_page_nand(struct tt_bitset_page *dst, struct tt_bitset_page *src)
 	}
 }
 
+/** Copy page data of @a src to @a dst. */
+inline void
+tt_bitset_page_copy_data(struct tt_bitset_page *dst,
+			 struct tt_bitset_page *src)
+{
+	memcpy(tt_bitset_page_data(dst), tt_bitset_page_data(src),
+	       BITSET_PAGE_DATA_SIZE);
+}
+
+/** Return true if no bit is set on the page. */
+inline bool
+tt_bitset_page_is_zero(struct tt_bitset_page *page)
+{
+	tt_bitset_word_t *d = (tt_bitset_word_t *) tt_bitset_page_data(page);
+
+	assert(BITSET_PAGE_DATA_SIZE % sizeof(tt_bitset_word_t) == 0);
+	int cnt = BITSET_PAGE_DATA_SIZE / sizeof(tt_bitset_word_t);
+	/* OR all words together and test the result once. */
+	tt_bitset_word_t acc = d[0];
+	for (int i = 1; i < cnt; i++)
+		acc |= d[i];
+#if defined(__AVX2__)
+	return _mm256_testz_si256(acc, acc);
+#elif defined(__SSE2__)
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(acc, _mm_setzero_si128())) ==
+	       0xffff;
+#else
+	return acc == 0;
+#endif
+}
+
 inline void
 tt_bitset_page_or(struct tt_bitset_page *dst, struct tt_bitset_page *src)
 {
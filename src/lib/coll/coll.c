@@ -74,6 +74,92 @@ static struct mh_coll_t *coll_cache = NULL;
 static_assert(COLL_LOCALE_LEN_MAX <= TT_STATIC_BUF_LEN,
 	      "static buf is used to 0-terminate locale name");
 
+enum {
+	/** Number of slots in the per-thread sort key cache. */
+	COLL_SORT_KEY_CACHE_SIZE = 256,
+	/** Longest string a cache slot can hold. */
+	COLL_SORT_KEY_CACHE_STR_MAX = 64,
+	/** Longest sort key a cache slot can hold. */
+	COLL_SORT_KEY_CACHE_KEY_MAX = 192,
+};
+
+/**
+ * A cached ICU sort key. A slot is keyed by the collation id and
+ * the string content rather than by the string address: tuples
+ * come and go and their memory is reused, while equal content
+ * always yields the same sort key.
+ */
+struct coll_sort_key_cache_entry {
+	/** Id of the collation the key was made with, 0 if empty. */
+	uint32_t coll_id;
+	/** Hash of the string, to skip most false slot hits. */
+	uint32_t hash;
+	/** Length of the cached string. */
+	uint16_t str_len;
+	/** Length of the cached sort key. */
+	uint16_t key_len;
+	/** The string itself. */
+	char str[COLL_SORT_KEY_CACHE_STR_MAX];
+	/** Its sort key. Byte order of sort keys is collation order. */
+	char key[COLL_SORT_KEY_CACHE_KEY_MAX];
+};
+
+/**
+ * Direct-mapped per-thread cache of ICU sort keys. Building a
+ * sort key costs about the same as one ucol_strcoll() call, but
+ * once both operands are cached a comparison is a plain memcmp().
+ * Index descents compare the same few strings over and over, so
+ * the hit rate on the comparison-heavy paths is high.
+ */
+static __thread struct coll_sort_key_cache_entry
+	coll_sort_key_cache[COLL_SORT_KEY_CACHE_SIZE];
+
+/**
+ * Find or build the sort key of a string. Returns NULL if the
+ * string or its sort key does not fit into a cache slot - the
+ * caller then falls back to ucol_strcoll(). The returned pointer
+ * is into the cache and is only valid until the next lookup.
+ */
+static const char *
+coll_icu_sort_key(const struct coll *coll, const char *s, size_t s_len,
+		  uint16_t *key_len)
+{
+	if (s_len > COLL_SORT_KEY_CACHE_STR_MAX)
+		return NULL;
+	uint32_t h = PMurHash32(coll->id, s, s_len);
+	struct coll_sort_key_cache_entry *e =
+		&coll_sort_key_cache[h & (COLL_SORT_KEY_CACHE_SIZE - 1)];
+	if (e->coll_id == coll->id && e->hash == h && e->str_len == s_len &&
+	    memcmp(e->str, s, s_len) == 0) {
+		*key_len = e->key_len;
+		return e->key;
+	}
+	UCharIterator itr;
+	uiter_setUTF8(&itr, s, s_len);
+	uint32_t state[2] = {0, 0};
+	UErrorCode status = U_ZERO_ERROR;
+	int32_t got = ucol_nextSortKeyPart(coll->collator, &itr, state,
+					   (uint8_t *)e->key,
+					   COLL_SORT_KEY_CACHE_KEY_MAX,
+					   &status);
+	if (U_FAILURE(status) || got == COLL_SORT_KEY_CACHE_KEY_MAX) {
+		/*
+		 * The sort key does not fit (a full buffer means
+		 * more parts may follow). The slot is trashed
+		 * already, mark it empty.
+		 */
+		e->coll_id = 0;
+		return NULL;
+	}
+	e->coll_id = coll->id;
+	e->hash = h;
+	e->str_len = s_len;
+	e->key_len = got;
+	memcpy(e->str, s, s_len);
+	*key_len = got;
+	return e->key;
+}
+
 /** Compare two string using ICU collation. */
 static int
 coll_icu_cmp(const char *s, size_t slen, const char *t, size_t tlen,
@@ -81,6 +167,29 @@ coll_icu_cmp(const char *s, size_t slen, const char *t, size_t tlen,
 {
 	assert(coll->collator != NULL);
 
+	/*
+	 * Sort keys first: comparing them byte-wise gives exactly
+	 * the ucol_strcoll() order, and for cached operands it is
+	 * an order of magnitude cheaper. Note that the two lookups
+	 * may collide on a slot, so the first key is copied out
+	 * before the second lookup.
+	 */
+	uint16_t s_key_len, t_key_len;
+	const char *key = coll_icu_sort_key(coll, s, slen, &s_key_len);
+	if (key != NULL) {
+		char s_key[COLL_SORT_KEY_CACHE_KEY_MAX];
+		memcpy(s_key, key, s_key_len);
+		const char *t_key = coll_icu_sort_key(coll, t, tlen,
+						      &t_key_len);
+		if (t_key != NULL) {
+			uint16_t min_len = MIN(s_key_len, t_key_len);
+			int res = memcmp(s_key, t_key, min_len);
+			if (res == 0)
+				res = (int)s_key_len - (int)t_key_len;
+			return res;
+		}
+	}
+
 	UErrorCode status = U_ZERO_ERROR;
 
 #ifdef HAVE_ICU_STRCOLLUTF8
@@ -373,6 +482,12 @@ coll_new(const struct coll_def *def)
 		return NULL;
 	}
 	memcpy((char *) coll->fingerprint, fingerprint, fingerprint_len + 1);
+	/*
+	 * Ids start from 1 so that a zeroed sort key cache slot
+	 * never matches a real collation.
+	 */
+	static uint32_t id_generator = 0;
+	coll->id = ++id_generator;
 	coll->refs = 1;
 	coll->type = def->type;
 	switch (coll->type) {
@@ -79,6 +79,14 @@ struct coll {
 	 * copied. Sort keys may be compared using strcmp().
 	 */
 	coll_hint_f hint;
+	/**
+	 * Identifier unique among all collations ever created
+	 * in the process. Unlike the object address it is never
+	 * reused, so it is used to key the per-thread sort key
+	 * cache: an entry left behind by a deleted collation can
+	 * never match a newer one.
+	 */
+	uint32_t id;
 	/** Reference counter. */
 	int refs;
 	/**
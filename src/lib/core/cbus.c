@@ -31,7 +31,9 @@
 #include "cbus.h"
 
 #include <limits.h>
+#include <pmatomic.h>
 #include "fiber.h"
+#include "histogram.h"
 #include "trigger.h"
 
 /**
@@ -87,6 +89,26 @@ static void
 cpipe_flush_cb(ev_loop * /* loop */, struct ev_async *watcher,
 	       int /* events */);
 
+/**
+ * Push a chain of messages on top of the endpoint staging stack.
+ * The chain must be linked via cmsg->fifo from @a head to @a tail
+ * in LIFO (reverse of delivery) order - the fetch reverses the
+ * stack back. Safe to call from any thread.
+ * @return true if the stack was empty, i.e. the consumer needs a
+ *         wakeup.
+ */
+static bool
+cbus_endpoint_push_reversed(struct cbus_endpoint *endpoint, struct cmsg *head,
+			    struct cmsg *tail)
+{
+	struct cmsg *old = pm_atomic_load(&endpoint->inbox);
+	do {
+		tail->fifo.next = old != NULL ? &old->fifo : NULL;
+	} while (!pm_atomic_compare_exchange_weak(&endpoint->inbox, &old,
+						  head));
+	return old == NULL;
+}
+
 void
 cpipe_create(struct cpipe *pipe, const char *consumer)
 {
@@ -154,23 +176,37 @@ cpipe_destroy(struct cpipe *pipe)
 	 * Avoid the general purpose cpipe_push_input() since
 	 * we want to control the way the poison message is
 	 * delivered.
+	 *
+	 * The shutdown message goes last, i.e. on top of the LIFO
+	 * staging stack.
 	 */
-	tt_pthread_mutex_lock(&endpoint->mutex);
-	/* Flush input */
-	stailq_concat(&endpoint->output, &pipe->input);
+	struct cmsg *head = &poison->msg;
+	struct cmsg *tail = &poison->msg;
+	poison->msg.push_time = clock_monotonic64();
+	poison->msg.fifo.next = NULL;
+	if (!stailq_empty(&pipe->input)) {
+		tail = stailq_first_entry(&pipe->input, struct cmsg, fifo);
+		stailq_reverse(&pipe->input);
+		struct cmsg *last = stailq_first_entry(&pipe->input,
+						       struct cmsg, fifo);
+		poison->msg.fifo.next = &last->fifo;
+	}
+	pm_atomic_fetch_add(&endpoint->depth, pipe->n_input + 1);
 	pipe->n_input = 0;
-	/* Add the pipe shutdown message as the last one. */
-	stailq_add_tail_entry(&endpoint->output, poison, msg.fifo);
-	/* Count statistics */
-	rmean_collect(cbus.stats, CBUS_STAT_EVENTS, 1);
 	/*
-	 * Keep the lock for the duration of ev_async_send():
-	 * this will avoid a race condition between
-	 * ev_async_send() and execution of the poison
-	 * message, after which the endpoint may disappear.
+	 * Keep the global mutex for the duration of
+	 * ev_async_send(): endpoint destruction passes through the
+	 * same mutex after the consumer has seen the poison, which
+	 * avoids a race condition between ev_async_send() and
+	 * execution of the poison message, after which the
+	 * endpoint may disappear.
 	 */
+	tt_pthread_mutex_lock(&cbus.mutex);
+	cbus_endpoint_push_reversed(endpoint, head, tail);
+	/* Count statistics */
+	rmean_collect(cbus.stats, CBUS_STAT_EVENTS, 1);
 	ev_async_send(endpoint->consumer, &endpoint->async);
-	tt_pthread_mutex_unlock(&endpoint->mutex);
+	tt_pthread_mutex_unlock(&cbus.mutex);
 
 	tt_pthread_setcancelstate(old_cancel_state, NULL);
 
@@ -226,8 +262,14 @@ cbus_endpoint_create(struct cbus_endpoint *endpoint, const char *name,
 	endpoint->consumer = loop();
 	endpoint->n_pipes = 0;
 	fiber_cond_create(&endpoint->cond);
-	tt_pthread_mutex_init(&endpoint->mutex, NULL);
-	stailq_create(&endpoint->output);
+	endpoint->inbox = NULL;
+	endpoint->depth = 0;
+	endpoint->fetched = 0;
+	static int64_t delay_buckets[] = {
+		1, 10, 100, 1000, 10000, 100000, 1000000,
+	};
+	endpoint->delay_hist = histogram_new(delay_buckets,
+					     lengthof(delay_buckets));
 	ev_async_init(&endpoint->async,
 		      (void (*)(ev_loop *, struct ev_async *, int)) fetch_cb);
 	endpoint->async.data = fetch_data;
@@ -261,20 +303,23 @@ cbus_endpoint_destroy(struct cbus_endpoint *endpoint,
 	while (true) {
 		if (process_cb)
 			process_cb(endpoint);
-		if (endpoint->n_pipes == 0 && stailq_empty(&endpoint->output))
+		if (endpoint->n_pipes == 0 &&
+		    pm_atomic_load(&endpoint->inbox) == NULL)
 			break;
 		 fiber_cond_wait(&endpoint->cond);
 	}
 
 	/*
-	 * Pipe flush func can still lock mutex, so just lock and unlock
-	 * it.
+	 * A cpipe_destroy() can still be between its poison push and the
+	 * consumer wakeup. It holds the global mutex around that window,
+	 * so just lock and unlock it to let the wakeup finish.
 	 */
-	tt_pthread_mutex_lock(&endpoint->mutex);
-	tt_pthread_mutex_unlock(&endpoint->mutex);
-	tt_pthread_mutex_destroy(&endpoint->mutex);
+	tt_pthread_mutex_lock(&cbus.mutex);
+	tt_pthread_mutex_unlock(&cbus.mutex);
 	ev_async_stop(endpoint->consumer, &endpoint->async);
 	fiber_cond_destroy(&endpoint->cond);
+	if (endpoint->delay_hist != NULL)
+		histogram_delete(endpoint->delay_hist);
 	TRASH(endpoint);
 	return 0;
 }
@@ -290,8 +335,6 @@ cpipe_flush_cb(ev_loop *loop, struct ev_async *watcher, int events)
 		return;
 
 	trigger_run(&pipe->on_flush, pipe);
-	/* Trigger task processing when the queue becomes non-empty. */
-	bool output_was_empty;
 
 	/*
 	 * We need to set a thread cancellation guard, because
@@ -304,14 +347,26 @@ cpipe_flush_cb(ev_loop *loop, struct ev_async *watcher, int events)
 	int old_cancel_state;
 	tt_pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &old_cancel_state);
 
-	tt_pthread_mutex_lock(&endpoint->mutex);
-	output_was_empty = stailq_empty(&endpoint->output);
-	/** Flush input */
-	stailq_concat(&endpoint->output, &pipe->input);
-	tt_pthread_mutex_unlock(&endpoint->mutex);
-
+	/*
+	 * Reverse the batch locally, so that a single
+	 * compare-and-swap puts it whole on top of the LIFO
+	 * staging stack. The endpoint is guaranteed to be alive
+	 * here, because it can't be destroyed until this pipe is.
+	 */
+	struct cmsg *tail = stailq_first_entry(&pipe->input, struct cmsg,
+					       fifo);
+	stailq_reverse(&pipe->input);
+	struct cmsg *head = stailq_first_entry(&pipe->input, struct cmsg,
+					       fifo);
+	stailq_create(&pipe->input);
+	/*
+	 * Account the batch in the queue depth before the push -
+	 * the consumer may fetch and subtract right away.
+	 */
+	pm_atomic_fetch_add(&endpoint->depth, pipe->n_input);
 	pipe->n_input = 0;
-	if (output_was_empty) {
+	/* Trigger task processing when the queue becomes non-empty. */
+	if (cbus_endpoint_push_reversed(endpoint, head, tail)) {
 		/* Count statistics */
 		rmean_collect(cbus.stats, CBUS_STAT_EVENTS, 1);
 
@@ -321,6 +376,33 @@ cpipe_flush_cb(ev_loop *loop, struct ev_async *watcher, int events)
 	tt_pthread_setcancelstate(old_cancel_state, NULL);
 }
 
+void
+cbus_endpoint_fetch(struct cbus_endpoint *endpoint, struct stailq *output)
+{
+	struct cmsg *msg = pm_atomic_exchange(&endpoint->inbox, NULL);
+	if (msg == NULL)
+		return;
+	uint64_t now = clock_monotonic64();
+	int64_t count = 0;
+	/* The stack is in LIFO order - reverse it back into FIFO. */
+	struct stailq batch;
+	stailq_create(&batch);
+	while (msg != NULL) {
+		struct stailq_entry *next = msg->fifo.next;
+		if (endpoint->delay_hist != NULL) {
+			histogram_collect(endpoint->delay_hist,
+					  (now - msg->push_time) / 1000);
+		}
+		count++;
+		stailq_add(&batch, &msg->fifo);
+		msg = next != NULL ?
+		      container_of(next, struct cmsg, fifo) : NULL;
+	}
+	stailq_concat(output, &batch);
+	pm_atomic_fetch_sub(&endpoint->depth, count);
+	endpoint->fetched += count;
+}
+
 void
 cbus_init(void)
 {
@@ -693,3 +775,19 @@ cbus_stop_loop(struct cpipe *pipe)
 	ev_invoke(pipe->producer, &pipe->flush_input, EV_CUSTOM);
 }
 
+
+int
+cbus_endpoint_stat_foreach(cbus_endpoint_stat_cb cb, void *cb_ctx)
+{
+	int rc = 0;
+	struct cbus_endpoint *endpoint;
+	tt_pthread_mutex_lock(&cbus.mutex);
+	rlist_foreach_entry(endpoint, &cbus.endpoints, in_cbus) {
+		rc = cb(endpoint->name, pm_atomic_load(&endpoint->depth),
+			endpoint->fetched, endpoint->delay_hist, cb_ctx);
+		if (rc != 0)
+			break;
+	}
+	tt_pthread_mutex_unlock(&cbus.mutex);
+	return rc;
+}
@@ -30,6 +30,7 @@
  * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
  * SUCH DAMAGE.
  */
+#include "clock.h"
 #include "fiber.h"
 #include "fiber_cond.h"
 #include "rmean.h"
@@ -43,6 +44,7 @@ extern "C" {
 /** cbus, cmsg - inter-cord bus and messaging */
 
 struct cmsg;
+struct histogram;
 struct cpipe;
 typedef void (*cmsg_f)(struct cmsg *);
 
@@ -88,6 +90,12 @@ struct cmsg {
 	const struct cmsg_hop *route;
 	/** The current hop the message is at. */
 	const struct cmsg_hop *hop;
+	/**
+	 * Monotonic time of the last push, in ns. Set anew on
+	 * every hop; the consumer turns it into the queue delay
+	 * of the endpoint, see cbus_endpoint::delay_hist.
+	 */
+	uint64_t push_time;
 };
 
 static inline struct cmsg *cmsg(void *ptr) { return (struct cmsg *) ptr; }
@@ -118,7 +126,7 @@ struct cpipe {
 	/**
 	 * When pushing messages, keep the staged input size under
 	 * this limit (speeds up message delivery and reduces
-	 * latency, while still keeping the bus mutex cold enough).
+	 * latency, while still keeping the handoff rate low enough).
 	 */
 	int max_input;
 	/**
@@ -166,7 +174,7 @@ cpipe_destroy(struct cpipe *pipe);
  * Otherwise, the messages flushed once per event loop iteration.
  *
  * @todo: collect bus stats per second and adjust max_input once
- * a second to keep the mutex cold regardless of the message load,
+ * a second to keep the handoff rate low regardless of the message load,
  * while still keeping the latency low if there are few
  * long-to-process messages.
  */
@@ -223,6 +231,7 @@ cpipe_push_input(struct cpipe *pipe, struct cmsg *msg)
 {
 	assert(loop() == pipe->producer);
 
+	msg->push_time = clock_monotonic64();
 	stailq_add_tail_entry(&pipe->input, msg, fifo);
 	pipe->n_input++;
 	if (pipe->n_input >= pipe->max_input)
@@ -255,10 +264,16 @@ struct cbus_endpoint {
 	char name[FIBER_NAME_MAX];
 	/** Member of cbus->endpoints */
 	struct rlist in_cbus;
-	/** The lock around the pipe. */
-	pthread_mutex_t mutex;
-	/** A queue with incoming messages. */
-	struct stailq output;
+	/**
+	 * Lock-free staging stack with incoming messages. The
+	 * producers push whole batches with a single
+	 * compare-and-swap, the consumer grabs the entire stack
+	 * at once. The messages are linked via cmsg->fifo in LIFO
+	 * order, the fetch restores FIFO. A push knows exactly
+	 * whether the stack was empty, so the consumer loop is
+	 * woken up only on empty -> non-empty transitions.
+	 */
+	struct cmsg *inbox;
 	/** Consumer cord loop */
 	ev_loop *consumer;
 	/** Async to notify the consumer */
@@ -267,18 +282,29 @@ struct cbus_endpoint {
 	uint32_t n_pipes;
 	/** Condition for endpoint destroy */
 	struct fiber_cond cond;
+	/**
+	 * Number of messages pushed to the inbox but not yet
+	 * fetched by the consumer. Updated with atomics: the
+	 * producers add, the consumer subtracts.
+	 */
+	int64_t depth;
+	/** Total number of messages fetched by the consumer. */
+	int64_t fetched;
+	/**
+	 * Histogram of the push-to-fetch delay, in usec. Filled
+	 * by the consumer thread only; may be read from another
+	 * thread for statistics - small inaccuracy is fine
+	 * there. NULL if allocation failed, then the delay is
+	 * simply not accounted.
+	 */
+	struct histogram *delay_hist;
 };
 
 /**
- * Fetch incomming messages to output
+ * Fetch incomming messages to output, in their push order.
  */
-static inline void
-cbus_endpoint_fetch(struct cbus_endpoint *endpoint, struct stailq *output)
-{
-	tt_pthread_mutex_lock(&endpoint->mutex);
-	stailq_concat(output, &endpoint->output);
-	tt_pthread_mutex_unlock(&endpoint->mutex);
-}
+void
+cbus_endpoint_fetch(struct cbus_endpoint *endpoint, struct stailq *output);
 
 /** Initialize the global singleton bus. */
 void
@@ -327,6 +353,22 @@ int
 cbus_endpoint_destroy(struct cbus_endpoint *endpoint,
 		      void (*process_cb)(struct cbus_endpoint *));
 
+/**
+ * Callback for cbus_endpoint_stat_foreach(). @a delay_hist may
+ * be NULL if its allocation failed at endpoint creation.
+ */
+typedef int (*cbus_endpoint_stat_cb)(const char *name, int64_t depth,
+				     int64_t fetched,
+				     struct histogram *delay_hist,
+				     void *cb_ctx);
+
+/**
+ * Invoke @a cb for every connected endpoint, stop if it returns
+ * non-zero and return that value. Safe to call from any thread.
+ */
+int
+cbus_endpoint_stat_foreach(cbus_endpoint_stat_cb cb, void *cb_ctx);
+
 /**
  * A helper method to invoke a function on the other side of the
  * bus.
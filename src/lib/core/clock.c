@@ -108,3 +108,121 @@ clock_thread64(void)
 	return (uint64_t) clock() * 1000000000 / CLOCKS_PER_SEC;
 #endif
 }
+
+/* {{{ Coarse monotonic clock */
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CLOCK_HAVE_CYCLES 1
+/** Read the CPU cycle counter. */
+static inline uint64_t
+clock_cycles(void)
+{
+	uint32_t lo, hi;
+	__asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+	return (uint64_t) hi << 32 | lo;
+}
+#elif defined(__aarch64__)
+#define CLOCK_HAVE_CYCLES 1
+static inline uint64_t
+clock_cycles(void)
+{
+	uint64_t value;
+	__asm__ __volatile__("mrs %0, cntvct_el0" : "=r" (value));
+	return value;
+}
+#endif
+
+#if defined(CLOCK_HAVE_CYCLES)
+
+/**
+ * The cycle counter is not guaranteed to be synchronized between
+ * cores, so the calibration is per thread. A thread migrating to
+ * another core in the middle of a rebase period may see a skewed
+ * reading; the clamp against the last returned value and the next
+ * rebase bound the damage to one period.
+ */
+struct clock_coarse {
+	/** clock_monotonic() at the last rebase. */
+	double base;
+	/** Cycle counter at the last rebase. */
+	uint64_t base_cycles;
+	/** The very first sample, the calibration baseline. */
+	double first;
+	uint64_t first_cycles;
+	/** Calibrated cycle length, 0 until known. */
+	double sec_per_cycle;
+	/** Cycle budget between rebases, ~10 msec worth. */
+	uint64_t rebase_cycles;
+	/** The last returned value, to stay monotonic. */
+	double last;
+};
+
+static __thread struct clock_coarse coarse;
+
+enum {
+	/** How often to fall back to the real clock, in usec. */
+	CLOCK_COARSE_REBASE_PERIOD = 10000,
+	/** Do not trust a calibration interval shorter than this. */
+	CLOCK_COARSE_MIN_CALIBRATION = 100,
+};
+
+/**
+ * The cold path: take a real clock sample, refine the cycle
+ * length estimate and restart the extrapolation from the fresh
+ * sample. The rate is derived against the very first sample, so
+ * its precision improves as the process lives on.
+ */
+static NOINLINE double
+clock_coarse_rebase(uint64_t cycles)
+{
+	struct clock_coarse *c = &coarse;
+	double now = clock_monotonic();
+	if (c->first_cycles == 0) {
+		c->first = now;
+		c->first_cycles = cycles;
+	} else if (now - c->first >= CLOCK_COARSE_MIN_CALIBRATION * 1e-6 &&
+		   cycles > c->first_cycles) {
+		c->sec_per_cycle = (now - c->first) /
+				   (cycles - c->first_cycles);
+		c->rebase_cycles = CLOCK_COARSE_REBASE_PERIOD * 1e-6 /
+				   c->sec_per_cycle;
+	}
+	c->base = now;
+	c->base_cycles = cycles;
+	return now;
+}
+
+double
+clock_monotonic_coarse(void)
+{
+	struct clock_coarse *c = &coarse;
+	uint64_t cycles = clock_cycles();
+	double t;
+	if (c->sec_per_cycle != 0 &&
+	    cycles - c->base_cycles < c->rebase_cycles) {
+		t = c->base + (cycles - c->base_cycles) * c->sec_per_cycle;
+	} else {
+		t = clock_coarse_rebase(cycles);
+	}
+	/*
+	 * A rebase may land a hair behind the extrapolation if the
+	 * estimated rate ran slightly fast. Never step back.
+	 */
+	if (t < c->last)
+		t = c->last;
+	else
+		c->last = t;
+	return t;
+}
+
+#else /* !defined(CLOCK_HAVE_CYCLES) */
+
+double
+clock_monotonic_coarse(void)
+{
+	return clock_monotonic();
+}
+
+#endif /* defined(CLOCK_HAVE_CYCLES) */
+
+/* }}} */
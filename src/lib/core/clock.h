@@ -52,6 +52,19 @@ uint64_t clock_thread64(void);
 
 /** \endcond public */
 
+/**
+ * A cheap approximation of clock_monotonic(): the value is
+ * extrapolated from the CPU cycle counter and re-anchored to the
+ * real clock roughly every 10 msec, so a read costs a few
+ * nanoseconds instead of a vDSO call. The result is monotonic
+ * within a thread but may lag or lead the real clock by up to a
+ * rebase period - use it for statistics and scheduling
+ * timestamps, not for anything user visible. Falls back to
+ * clock_monotonic() on platforms without a usable cycle counter.
+ */
+double
+clock_monotonic_coarse(void);
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
@@ -31,12 +31,17 @@
 #include "coio_file.h"
 #include "coio_task.h"
 #include "fiber.h"
+#include "iouring.h"
 #include "say.h"
 #include "fio.h"
 #include "errinj.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <dirent.h>
+#include <unistd.h>
+#ifdef ENABLE_IOURING
+#include <sys/eventfd.h>
+#endif
 
 /**
  * A context of libeio request for any
@@ -111,6 +116,148 @@ struct coio_file_task {
 	memset(&name, 0, sizeof(name));		\
 	name.fiber = fiber();			\
 
+#ifdef ENABLE_IOURING
+
+enum { COIO_URING_ENTRIES = 64 };
+
+/** One in-flight ring operation, on the waiting fiber's stack. */
+struct coio_uring_op {
+	struct iovec iov;
+	ssize_t result;
+	struct fiber *fiber;
+	bool done;
+};
+
+/**
+ * A lazily created per-thread ring for positional file reads and
+ * writes - the xlog and vy_run hot paths. It saves the libeio
+ * thread pool hop and its global queue lock; the rest of the
+ * file operations keep going through libeio. If the kernel has
+ * no io_uring, the ring is disabled for good on the first
+ * attempt and the callers fall back transparently.
+ */
+static __thread struct {
+	struct iouring ring;
+	/** Eventfd the kernel signals completions through. */
+	int efd;
+	/** Plugs @a efd into the thread's libev loop. */
+	struct ev_io efd_watcher;
+	/** -1 - not tried yet, 0 - unavailable, 1 - running. */
+	int state;
+} coio_uring = { .state = -1 };
+
+/** Reap ring completions and wake up the owning fibers. */
+static void
+coio_uring_complete_cb(ev_loop *loop, struct ev_io *watcher, int revents)
+{
+	(void) loop;
+	(void) watcher;
+	(void) revents;
+	uint64_t dummy;
+	ssize_t rc = read(coio_uring.efd, &dummy, sizeof(dummy));
+	(void) rc;
+	struct io_uring_cqe *cqe;
+	while ((cqe = iouring_peek_cqe(&coio_uring.ring)) != NULL) {
+		struct coio_uring_op *op =
+			(struct coio_uring_op *)(uintptr_t)cqe->user_data;
+		op->result = cqe->res;
+		op->done = true;
+		iouring_cqe_seen(&coio_uring.ring);
+		fiber_wakeup(op->fiber);
+	}
+}
+
+/** Shut the thread's ring down and never try it again. */
+static void
+coio_uring_disable(void)
+{
+	ev_io_stop(loop(), &coio_uring.efd_watcher);
+	close(coio_uring.efd);
+	iouring_destroy(&coio_uring.ring);
+	coio_uring.state = 0;
+}
+
+/** Create the thread's ring on the first file operation. */
+static bool
+coio_uring_is_available(void)
+{
+	if (coio_uring.state >= 0)
+		return coio_uring.state == 1;
+	coio_uring.state = 0;
+	if (iouring_create(&coio_uring.ring, COIO_URING_ENTRIES) != 0) {
+		say_info("io_uring is unavailable, "
+			 "file I/O falls back to libeio");
+		return false;
+	}
+	coio_uring.efd = eventfd(0, EFD_NONBLOCK);
+	if (coio_uring.efd < 0 ||
+	    iouring_register_eventfd(&coio_uring.ring, coio_uring.efd) != 0) {
+		if (coio_uring.efd >= 0)
+			close(coio_uring.efd);
+		iouring_destroy(&coio_uring.ring);
+		return false;
+	}
+	ev_io_init(&coio_uring.efd_watcher, coio_uring_complete_cb,
+		   coio_uring.efd, EV_READ);
+	ev_io_start(loop(), &coio_uring.efd_watcher);
+	coio_uring.state = 1;
+	return true;
+}
+
+/**
+ * Try to run a positional read or write through the ring.
+ * Returns false if the ring is unavailable or full and the
+ * caller must fall back to libeio. Otherwise waits for the
+ * completion and returns true with the result in @a res, errno
+ * set on failure.
+ */
+static bool
+coio_uring_rw(int fd, void *buf, size_t count, off_t offset, bool is_write,
+	      ssize_t *res)
+{
+	if (!coio_uring_is_available())
+		return false;
+	struct coio_uring_op op;
+	op.iov.iov_base = buf;
+	op.iov.iov_len = count;
+	op.result = 0;
+	op.fiber = fiber();
+	op.done = false;
+	uint64_t user_data = (uint64_t)(uintptr_t)&op;
+	int rc;
+	if (is_write) {
+		rc = iouring_prep_pwritev(&coio_uring.ring, fd, &op.iov, 1,
+					  offset, user_data);
+	} else {
+		rc = iouring_prep_preadv(&coio_uring.ring, fd, &op.iov, 1,
+					 offset, user_data);
+	}
+	if (rc != 0)
+		return false;
+	if (iouring_submit(&coio_uring.ring) < 0) {
+		/*
+		 * The entry is published, so it may not be left
+		 * behind to complete into a dead stack frame.
+		 * Tearing the ring down drops it for sure; such
+		 * an error is one-off per thread anyway.
+		 */
+		diag_log();
+		coio_uring_disable();
+		return false;
+	}
+	while (!op.done)
+		fiber_yield();
+	if (op.result < 0) {
+		errno = -op.result;
+		*res = -1;
+	} else {
+		*res = op.result;
+	}
+	return true;
+}
+
+#endif /* ENABLE_IOURING */
+
 /** A callback invoked by eio when a task is complete. */
 static int
 coio_complete(eio_req *req)
@@ -175,6 +322,18 @@ coio_pwrite(int fd, const void *buf, size_t count, off_t offset)
 			chunk = 1;
 		});
 
+#ifdef ENABLE_IOURING
+		if (coio_uring_rw(fd, (char *)buf + pos, chunk, offset + pos,
+				  true, &res)) {
+			if (res < 0) {
+				pos = -1;
+				break;
+			}
+			left -= res;
+			pos += res;
+			continue;
+		}
+#endif
 		req = eio_write(fd, (char *)buf + pos, chunk,
 				offset + pos, EIO_PRI_DEFAULT,
 				coio_complete, &eio);
@@ -193,6 +352,11 @@ coio_pwrite(int fd, const void *buf, size_t count, off_t offset)
 ssize_t
 coio_pread(int fd, void *buf, size_t count, off_t offset)
 {
+#ifdef ENABLE_IOURING
+	ssize_t res;
+	if (coio_uring_rw(fd, buf, count, offset, false, &res))
+		return res;
+#endif
 	INIT_COEIO_FILE(eio);
 	eio_req *req = eio_read(fd, buf, count,
 				offset, 0, coio_complete, &eio);
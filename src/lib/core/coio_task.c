@@ -38,6 +38,7 @@
 #include <netdb.h>
 #include <sys/socket.h>
 
+#include "assoc.h"
 #include "fiber.h"
 #include "third_party/tarantool_ev.h"
 
@@ -359,6 +360,192 @@ getaddrinfo_free_cb(struct coio_task *ptr)
 	return 0;
 }
 
+enum {
+	/** Seconds a cached resolver result is served without a refresh. */
+	COIO_DNS_CACHE_TTL = 30,
+	/**
+	 * Seconds after which a cached result is too old to serve
+	 * even as a fallback when a refresh fails.
+	 */
+	COIO_DNS_CACHE_STALE_TTL = 300,
+	/** Upper bound on cached (host, port, hints) combinations. */
+	COIO_DNS_CACHE_MAX_SIZE = 256,
+	/** Max length of a cache key; longer requests are not cached. */
+	COIO_DNS_CACHE_KEY_MAX = NI_MAXHOST + NI_MAXSERV + 64,
+};
+
+/**
+ * A cached getaddrinfo() result. The address list is a deep copy
+ * owned by the entry and is never handed out directly - lookups
+ * get their own copy, so an entry can be evicted at any moment.
+ */
+struct dns_cache_entry {
+	/** ev_monotonic_now() time the result was resolved. */
+	double created_at;
+	/** Deep copy of the result, allocated with coio_addrinfo_dup(). */
+	struct addrinfo *ai;
+	/** Length of the key. */
+	size_t key_len;
+	/** Cache key: host, port and hints, see dns_cache_key(). */
+	char key[0];
+};
+
+/**
+ * (host, port, hints) -> dns_cache_entry. The cache is per-thread:
+ * resolution requests of different cords never contend on it.
+ */
+static __thread struct mh_strnptr_t *dns_cache = NULL;
+
+/**
+ * Deep-copy an addrinfo list. Each node is a single allocation
+ * holding the struct, the address and the canonical name, so the
+ * copy is freed with coio_freeaddrinfo() on any platform,
+ * regardless of how the libc allocates its own lists.
+ */
+static struct addrinfo *
+coio_addrinfo_dup(const struct addrinfo *src)
+{
+	struct addrinfo *head = NULL;
+	struct addrinfo **tail = &head;
+	for (; src != NULL; src = src->ai_next) {
+		size_t canonname_size = src->ai_canonname != NULL ?
+					strlen(src->ai_canonname) + 1 : 0;
+		size_t size = sizeof(struct addrinfo) + src->ai_addrlen +
+			      canonname_size;
+		struct addrinfo *copy = (struct addrinfo *) malloc(size);
+		if (copy == NULL) {
+			diag_set(OutOfMemory, size, "malloc", "addrinfo");
+			coio_freeaddrinfo(head);
+			return NULL;
+		}
+		*copy = *src;
+		char *data = (char *) copy + sizeof(struct addrinfo);
+		if (src->ai_addrlen != 0) {
+			copy->ai_addr = (struct sockaddr *) data;
+			memcpy(copy->ai_addr, src->ai_addr, src->ai_addrlen);
+			data += src->ai_addrlen;
+		} else {
+			copy->ai_addr = NULL;
+		}
+		if (canonname_size != 0) {
+			copy->ai_canonname = data;
+			memcpy(copy->ai_canonname, src->ai_canonname,
+			       canonname_size);
+		} else {
+			copy->ai_canonname = NULL;
+		}
+		copy->ai_next = NULL;
+		*tail = copy;
+		tail = &copy->ai_next;
+	}
+	return head;
+}
+
+/**
+ * Build a cache key from the request. The hints members getaddrinfo()
+ * reads all take part: the same host resolved with different
+ * families or flags must not share an entry.
+ * @retval >= 0 key length.
+ * @retval -1   the key does not fit, the request is not cacheable.
+ */
+static int
+dns_cache_key(char *buf, size_t size, const char *host, const char *port,
+	      const struct addrinfo *hints)
+{
+	int total = snprintf(buf, size, "%s\n%s\n%d:%d:%d:%d",
+			     host != NULL ? host : "",
+			     port != NULL ? port : "",
+			     hints != NULL ? hints->ai_family : AF_UNSPEC,
+			     hints != NULL ? hints->ai_socktype : 0,
+			     hints != NULL ? hints->ai_protocol : 0,
+			     hints != NULL ? hints->ai_flags : 0);
+	if (total < 0 || (size_t) total >= size)
+		return -1;
+	return total;
+}
+
+static void
+dns_cache_entry_delete(struct dns_cache_entry *entry)
+{
+	coio_freeaddrinfo(entry->ai);
+	free(entry);
+}
+
+static struct dns_cache_entry *
+dns_cache_find(const char *key, size_t key_len)
+{
+	if (dns_cache == NULL)
+		return NULL;
+	mh_int_t i = mh_strnptr_find_inp(dns_cache, key, key_len);
+	if (i == mh_end(dns_cache))
+		return NULL;
+	return (struct dns_cache_entry *) mh_strnptr_node(dns_cache, i)->val;
+}
+
+/** Drop entries too old to be served even as a fallback. */
+static void
+dns_cache_purge_stale(double now)
+{
+	mh_int_t i = mh_first(dns_cache);
+	while (i != mh_end(dns_cache)) {
+		mh_int_t curr = i;
+		i = mh_next(dns_cache, i);
+		struct dns_cache_entry *entry = (struct dns_cache_entry *)
+			mh_strnptr_node(dns_cache, curr)->val;
+		if (now - entry->created_at > COIO_DNS_CACHE_STALE_TTL) {
+			mh_strnptr_del(dns_cache, curr, NULL);
+			dns_cache_entry_delete(entry);
+		}
+	}
+}
+
+/**
+ * Store a resolved list in the cache, taking ownership of @a ai.
+ * Best-effort: on any failure the list is simply freed - the
+ * caller already has its own copy of the result.
+ */
+static void
+dns_cache_put(const char *key, size_t key_len, struct addrinfo *ai,
+	      double now)
+{
+	if (dns_cache == NULL) {
+		dns_cache = mh_strnptr_new();
+		if (dns_cache == NULL) {
+			coio_freeaddrinfo(ai);
+			return;
+		}
+	}
+	mh_int_t i = mh_strnptr_find_inp(dns_cache, key, key_len);
+	if (i != mh_end(dns_cache)) {
+		struct dns_cache_entry *old = (struct dns_cache_entry *)
+			mh_strnptr_node(dns_cache, i)->val;
+		mh_strnptr_del(dns_cache, i, NULL);
+		dns_cache_entry_delete(old);
+	}
+	if (mh_size(dns_cache) >= COIO_DNS_CACHE_MAX_SIZE) {
+		dns_cache_purge_stale(now);
+		if (mh_size(dns_cache) >= COIO_DNS_CACHE_MAX_SIZE) {
+			coio_freeaddrinfo(ai);
+			return;
+		}
+	}
+	struct dns_cache_entry *entry =
+		(struct dns_cache_entry *) malloc(sizeof(*entry) + key_len);
+	if (entry == NULL) {
+		coio_freeaddrinfo(ai);
+		return;
+	}
+	entry->created_at = now;
+	entry->ai = ai;
+	entry->key_len = key_len;
+	memcpy(entry->key, key, key_len);
+	uint32_t hash = mh_strn_hash(entry->key, key_len);
+	struct mh_strnptr_node_t node = { entry->key, key_len, hash, entry };
+	if (mh_strnptr_put(dns_cache, &node, NULL, NULL) ==
+	    mh_end(dns_cache))
+		dns_cache_entry_delete(entry);
+}
+
 int
 coio_getaddrinfo(const char *host, const char *port,
 		 const struct addrinfo *hints, struct addrinfo **res,
@@ -429,3 +616,70 @@ coio_getaddrinfo(const char *host, const char *port,
 	getaddrinfo_free_cb(&task->base);
 	return 0;
 }
+
+int
+coio_getaddrinfo_cached(const char *host, const char *port,
+			const struct addrinfo *hints, struct addrinfo **res,
+			double timeout)
+{
+	char key[COIO_DNS_CACHE_KEY_MAX];
+	int key_len = dns_cache_key(key, sizeof(key), host, port, hints);
+	double now = ev_monotonic_now(loop());
+	struct dns_cache_entry *entry =
+		key_len < 0 ? NULL : dns_cache_find(key, key_len);
+	if (entry != NULL && now - entry->created_at <= COIO_DNS_CACHE_TTL) {
+		*res = coio_addrinfo_dup(entry->ai);
+		return *res != NULL ? 0 : -1;
+	}
+	struct addrinfo *ai = NULL;
+	if (coio_getaddrinfo(host, port, hints, &ai, timeout) != 0) {
+		/*
+		 * The entry is past its refresh deadline, but a
+		 * known-good address beats a resolver error: serve
+		 * it while it is not hopelessly stale. A transient
+		 * DNS outage then does not break reconnects to a
+		 * peer which is actually up.
+		 */
+		if (entry != NULL &&
+		    now - entry->created_at <= COIO_DNS_CACHE_STALE_TTL) {
+			struct addrinfo *copy = coio_addrinfo_dup(entry->ai);
+			if (copy != NULL) {
+				diag_clear(diag_get());
+				*res = copy;
+				return 0;
+			}
+		}
+		return -1;
+	}
+	if (ai == NULL) {
+		*res = NULL;
+		return 0;
+	}
+	/*
+	 * Normalize the libc-allocated list into our own layout so
+	 * that the caller frees cache hits and misses the same way.
+	 */
+	struct addrinfo *copy = coio_addrinfo_dup(ai);
+	freeaddrinfo(ai);
+	if (copy == NULL)
+		return -1;
+	*res = copy;
+	if (key_len >= 0) {
+		struct addrinfo *cached = coio_addrinfo_dup(copy);
+		if (cached != NULL)
+			dns_cache_put(key, key_len, cached, now);
+		else
+			diag_clear(diag_get());
+	}
+	return 0;
+}
+
+void
+coio_freeaddrinfo(struct addrinfo *ai)
+{
+	while (ai != NULL) {
+		struct addrinfo *next = ai->ai_next;
+		free(ai);
+		ai = next;
+	}
+}
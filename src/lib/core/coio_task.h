@@ -177,6 +177,30 @@ int
 coio_getaddrinfo(const char *host, const char *port,
 		 const struct addrinfo *hints, struct addrinfo **res,
 		 double timeout);
+
+/**
+ * Caching version of coio_getaddrinfo(). A successful result is
+ * remembered per thread for a fixed TTL, so repeated resolution of
+ * the same (host, port, hints) - reconnect loops first of all -
+ * does not post a task to the thread pool and does not yield.
+ * After the TTL the entry is refreshed via coio_getaddrinfo(); if
+ * the refresh fails, a moderately stale entry is served instead of
+ * an error.
+ *
+ * The result must be freed with coio_freeaddrinfo(), not
+ * freeaddrinfo(3). Other parameters and return values are the
+ * same as in coio_getaddrinfo().
+ */
+int
+coio_getaddrinfo_cached(const char *host, const char *port,
+			const struct addrinfo *hints, struct addrinfo **res,
+			double timeout);
+
+/**
+ * Free a result of coio_getaddrinfo_cached().
+ */
+void
+coio_freeaddrinfo(struct addrinfo *res);
 /** \endcond public */
 
 #if defined(__cplusplus)
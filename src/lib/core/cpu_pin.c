@@ -0,0 +1,205 @@
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "cpu_pin.h"
+
+#include <ctype.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "diag.h"
+#include "say.h"
+
+#if defined(__linux__)
+#define CPU_PIN_ENABLED 1
+#include <sched.h>
+#endif
+
+#if defined(CPU_PIN_ENABLED)
+
+enum {
+	/** Longest thread name an entry can match. */
+	CPU_PIN_NAME_MAX = 32,
+};
+
+struct cpu_pin_entry {
+	/** Thread name prefix the entry applies to. */
+	char name[CPU_PIN_NAME_MAX];
+	/** CPUs the matched threads are allowed to run on. */
+	cpu_set_t cpus;
+};
+
+static struct cpu_pin_entry *pin_entries;
+static int pin_entry_count;
+/**
+ * The process affinity before the spec was installed - restored
+ * for threads the spec does not mention so that they do not
+ * inherit another thread's pinning.
+ */
+static cpu_set_t pin_default_cpus;
+
+/**
+ * Parse a "0,2-5,7" CPU list into @a cpus.
+ * @retval 0 on success, -1 on a malformed list.
+ */
+static int
+cpu_pin_parse_cpus(const char *list, const char *end, cpu_set_t *cpus)
+{
+	CPU_ZERO(cpus);
+	const char *pos = list;
+	while (pos < end) {
+		if (!isdigit((unsigned char)*pos))
+			return -1;
+		long first = strtol(pos, (char **)&pos, 10);
+		long last = first;
+		if (pos < end && *pos == '-') {
+			pos++;
+			if (pos >= end || !isdigit((unsigned char)*pos))
+				return -1;
+			last = strtol(pos, (char **)&pos, 10);
+		}
+		if (first < 0 || last < first || last >= CPU_SETSIZE)
+			return -1;
+		for (long cpu = first; cpu <= last; cpu++)
+			CPU_SET(cpu, cpus);
+		if (pos < end) {
+			if (*pos != ',')
+				return -1;
+			pos++;
+		}
+	}
+	return CPU_COUNT(cpus) > 0 ? 0 : -1;
+}
+
+int
+cpu_pin_set_spec(const char *spec)
+{
+	int count = 1;
+	for (const char *pos = spec; *pos != '\0'; pos++) {
+		if (*pos == ';')
+			count++;
+	}
+	struct cpu_pin_entry *entries = calloc(count, sizeof(*entries));
+	if (entries == NULL) {
+		diag_set(OutOfMemory, count * sizeof(*entries), "calloc",
+			 "cpu_pin_entries");
+		return -1;
+	}
+	if (*spec == '\0') {
+		diag_set(IllegalParams, "cpu_affinity must not be empty");
+		free(entries);
+		return -1;
+	}
+	int n = 0;
+	const char *pos = spec;
+	while (*pos != '\0') {
+		const char *end = strchr(pos, ';');
+		if (end == NULL)
+			end = pos + strlen(pos);
+		const char *colon = memchr(pos, ':', end - pos);
+		size_t name_len = colon != NULL ? (size_t)(colon - pos) : 0;
+		if (name_len == 0 || name_len >= CPU_PIN_NAME_MAX ||
+		    cpu_pin_parse_cpus(colon + 1, end,
+				       &entries[n].cpus) != 0) {
+			diag_set(IllegalParams,
+				 "invalid cpu_affinity entry '%.*s', expected "
+				 "'name:cpu[-cpu][,cpu]...'",
+				 (int)(end - pos), pos);
+			free(entries);
+			return -1;
+		}
+		memcpy(entries[n].name, pos, name_len);
+		entries[n].name[name_len] = '\0';
+		n++;
+		pos = *end != '\0' ? end + 1 : end;
+	}
+	if (pin_entries == NULL &&
+	    pthread_getaffinity_np(pthread_self(), sizeof(pin_default_cpus),
+				   &pin_default_cpus) != 0) {
+		/* Fall back to "no restriction". */
+		CPU_ZERO(&pin_default_cpus);
+		for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+			CPU_SET(cpu, &pin_default_cpus);
+	}
+	free(pin_entries);
+	pin_entries = entries;
+	pin_entry_count = n;
+	return 0;
+}
+
+void
+cpu_pin_thread(const char *name)
+{
+	if (pin_entries == NULL)
+		return;
+	const cpu_set_t *cpus = &pin_default_cpus;
+	for (int i = 0; i < pin_entry_count; i++) {
+		if (strncmp(pin_entries[i].name, name,
+			    strlen(pin_entries[i].name)) == 0) {
+			cpus = &pin_entries[i].cpus;
+			break;
+		}
+	}
+	if (pthread_setaffinity_np(pthread_self(), sizeof(*cpus), cpus) != 0)
+		say_syserror("failed to set cpu affinity of thread '%s'",
+			     name);
+}
+
+void
+cpu_pin_free(void)
+{
+	free(pin_entries);
+	pin_entries = NULL;
+	pin_entry_count = 0;
+}
+
+#else /* !defined(CPU_PIN_ENABLED) */
+
+int
+cpu_pin_set_spec(const char *spec)
+{
+	(void)spec;
+	say_warn("cpu_affinity is not supported on this platform");
+	return 0;
+}
+
+void
+cpu_pin_thread(const char *name)
+{
+	(void)name;
+}
+
+void
+cpu_pin_free(void)
+{
+}
+
+#endif /* defined(CPU_PIN_ENABLED) */
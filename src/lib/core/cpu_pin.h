@@ -0,0 +1,90 @@
+#ifndef TARANTOOL_LIB_CORE_CPU_PIN_H_INCLUDED
+#define TARANTOOL_LIB_CORE_CPU_PIN_H_INCLUDED
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * Thread to CPU pinning.
+ *
+ * A pinning spec maps thread names to CPU sets:
+ *
+ *     tx:0-3;wal:4;iproto:5,6
+ *
+ * Entries are separated with ';', a CPU set is a comma-separated
+ * list of CPU numbers and ranges. An entry name matches a thread
+ * whose cord name it is a prefix of, so "vinyl" covers all vinyl
+ * worker threads. The tx thread is named "main".
+ *
+ * Pinning keeps a thread on one NUMA node, and with the kernel's
+ * first-touch policy the memory the thread allocates stays on
+ * that node too. Threads a spec does not mention run on the
+ * affinity mask the process had before the spec was installed,
+ * so they do not inherit another thread's pinning.
+ *
+ * Only Linux supports pinning; elsewhere installing a spec logs
+ * a warning and does nothing.
+ */
+
+/**
+ * Parse and install a pinning spec. Replaces a previously
+ * installed spec. Takes effect for threads started afterwards;
+ * the calling thread may apply it to itself with
+ * cpu_pin_thread().
+ * @retval  0 on success.
+ * @retval -1 on parse error or OOM, diag is set.
+ */
+int
+cpu_pin_set_spec(const char *spec);
+
+/**
+ * Apply the installed spec to the calling thread named @a name.
+ * A no-op if no spec is installed. A failure to set the
+ * affinity is logged, not returned: a thread that cannot be
+ * pinned still must run.
+ */
+void
+cpu_pin_thread(const char *name);
+
+/**
+ * Free the installed spec.
+ */
+void
+cpu_pin_free(void);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_LIB_CORE_CPU_PIN_H_INCLUDED */
@@ -4,11 +4,14 @@
  * Copyright 2010-2020, Tarantool AUTHORS, please see AUTHORS file.
  */
 
+#include <fcntl.h>
+#include <stdarg.h>
 #include <string.h>
 #include <signal.h>
 #include <stdint.h>
 #include <limits.h>
 #include <time.h>
+#include <unistd.h>
 #include <sys/types.h>
 #include <sys/utsname.h>
 
@@ -19,6 +22,9 @@
 #include "box/replication.h"
 #include "backtrace.h"
 #include "crash.h"
+#include "fiber.h"
+#include "flightrec.h"
+#include "memory.h"
 #include "say.h"
 
 #define pr_fmt(fmt)		"crash: " fmt
@@ -500,6 +506,103 @@ crash_report_stderr(struct crash_info *cinfo)
 #endif
 }
 
+/**
+ * printf() into the microdump file. Unlike fdprintf() it
+ * understands the full format syntax. The buffer is static
+ * since we're deep in the crash handler and the remaining
+ * stack space is unknown.
+ */
+static void
+microdump_printf(int fd, const char *format, ...)
+{
+	static char buf[1024];
+	va_list ap;
+
+	va_start(ap, format);
+	int len = vsnprintf(buf, sizeof(buf), format, ap);
+	va_end(ap);
+	if (len < 0)
+		return;
+	if (len > (int)sizeof(buf) - 1)
+		len = sizeof(buf) - 1;
+	ssize_t rc = write(fd, buf, len);
+	(void)rc;
+}
+
+#ifdef ENABLE_BACKTRACE
+/** backtrace_foreach() callback writing a frame line. */
+static int
+microdump_backtrace_cb(int frameno, void *frameret, const char *func,
+		       size_t offset, void *cb_ctx)
+{
+	int fd = *(int *)cb_ctx;
+	microdump_printf(fd, "#%-2d %p in %s+%lx\n", frameno, frameret,
+			 func != NULL ? func : "??", (long)offset);
+	return 0;
+}
+#endif /* ENABLE_BACKTRACE */
+
+/**
+ * Write a compact plain-text microdump into the working
+ * directory: the crashed thread backtrace, the stacks of all
+ * fibers of this cord, the flight recorder tail (which among
+ * other events keeps metadata of the last journal rows), the
+ * runtime arena usage and the current vclock. The file is a
+ * few KB and takes milliseconds to write, so the instance can
+ * be restarted immediately and diagnosed from the microdump
+ * while a core file, if enabled at all, may be skipped or
+ * written in background by the kernel.
+ */
+static void
+crash_report_microdump(struct crash_info *cinfo)
+{
+	char path[64];
+	snprintf(path, sizeof(path), "microdump.%llu.txt",
+		 (unsigned long long)getpid());
+	int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		pr_crit("unable to open %s for a microdump", path);
+		return;
+	}
+
+	microdump_printf(fd, "version: %s %s\n", PACKAGE_VERSION, BUILD_INFO);
+	microdump_printf(fd, "pid: %llu\n", (unsigned long long)getpid());
+
+	/* 64 bytes should be enough for longest localtime. */
+	char ts_buf[64];
+	ns_to_localtime(cinfo->timestamp_rt, ts_buf, sizeof(ts_buf));
+	microdump_printf(fd, "time: %s\n", ts_buf);
+
+	microdump_printf(fd, "signal: %d, si_code: %d, si_addr: %p\n",
+			 cinfo->signo, cinfo->sicode, cinfo->siaddr);
+	microdump_printf(fd, "vclock: %s\n",
+			 vclock_to_string(&replicaset.vclock));
+	microdump_printf(fd, "runtime arena: used %zu, prealloc %zu\n",
+			 runtime.used, runtime.prealloc);
+
+#ifdef ENABLE_BACKTRACE
+	microdump_printf(fd, "\nbacktrace of the crashed thread:\n%s",
+			 cinfo->backtrace_buf);
+	if (cord() != NULL) {
+		struct fiber *f;
+		rlist_foreach_entry(f, &cord()->alive, link) {
+			if (f == fiber())
+				continue;
+			microdump_printf(fd, "\nfiber %u (%s):\n",
+					 (unsigned)f->fid, fiber_name(f));
+			backtrace_foreach(microdump_backtrace_cb,
+					  &f->ctx, &fd);
+		}
+	}
+#endif /* ENABLE_BACKTRACE */
+
+	microdump_printf(fd, "\nflight recorder tail:\n");
+	flightrec_dump_fd(fd);
+
+	close(fd);
+	pr_crit("microdump written to %s", path);
+}
+
 /**
  * Handle fatal (crashing) signal.
  *
@@ -527,6 +630,7 @@ crash_signal_cb(int signo, siginfo_t *siginfo, void *context)
 		in_cb = 1;
 		cinfo = crash_collect(signo, siginfo, context);
 		crash_report_stderr(cinfo);
+		crash_report_microdump(cinfo);
 		if (send_crashinfo &&
 		    crash_report_feedback_daemon(cinfo) != 0) {
 			pr_crit("unable to send a crash report");
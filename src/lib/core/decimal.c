@@ -312,9 +312,132 @@ decimal_minus(decimal_t *res, const decimal_t *dec)
 	return res;
 }
 
+enum {
+	/**
+	 * Maximum number of coefficient digits handled by the
+	 * native integer fast path. 18-digit coefficients and
+	 * exponent differences leave the aligned operands and
+	 * their sum well within a signed 128 bit integer.
+	 */
+	DECIMAL_FAST_DIGITS = 18,
+};
+
+/** Powers of 10 fitting an int64. */
+static const int64_t decimal_pow10[DECIMAL_FAST_DIGITS + 1] = {
+	1LL,
+	10LL,
+	100LL,
+	1000LL,
+	10000LL,
+	100000LL,
+	1000000LL,
+	10000000LL,
+	100000000LL,
+	1000000000LL,
+	10000000000LL,
+	100000000000LL,
+	1000000000000LL,
+	10000000000000LL,
+	100000000000000LL,
+	1000000000000000LL,
+	10000000000000000LL,
+	100000000000000000LL,
+	1000000000000000000LL,
+};
+
+/**
+ * Extract the coefficient of a decimal with up to
+ * DECIMAL_FAST_DIGITS digits as a signed 64 bit integer.
+ */
+static inline int64_t
+decimal_get_coeff(const decimal_t *dec)
+{
+	assert(dec->digits <= DECIMAL_FAST_DIGITS);
+	int nunits = (dec->digits + DECDPUN - 1) / DECDPUN;
+	int64_t c = 0;
+	for (int i = nunits - 1; i >= 0; i--)
+		c = c * decimal_pow10[DECDPUN] + dec->lsu[i];
+	return (dec->bits & DECNEG) != 0 ? -c : c;
+}
+
+/**
+ * Initialize a decimal from a non-zero coefficient with up to
+ * DECIMAL_FAST_DIGITS digits and an exponent.
+ */
+static inline void
+decimal_set_coeff(decimal_t *dec, int64_t c, int32_t exponent, int digits)
+{
+	dec->bits = c < 0 ? DECNEG : 0;
+	dec->exponent = exponent;
+	dec->digits = digits;
+	uint64_t u = c < 0 ? (uint64_t)-c : (uint64_t)c;
+	uint64_t unit_pow = (uint64_t)decimal_pow10[DECDPUN];
+	int i = 0;
+	do {
+		dec->lsu[i++] = (decNumberUnit)(u % unit_pow);
+		u /= unit_pow;
+	} while (u != 0);
+	assert(i == (digits + DECDPUN - 1) / DECDPUN);
+}
+
+/**
+ * Add or subtract two decimals with native integer arithmetic.
+ * Handles the common case of short decimals with close scales -
+ * a billing-style 2-scale add lands here - without decNumber's
+ * digit-by-digit loops. Returns NULL if the operands or the
+ * exact result do not fit the fast path, in which case the
+ * caller falls back to decNumber. Result sign and exponent of
+ * a zero result follow special rules, so it is left to the
+ * fallback too.
+ */
+static decimal_t *
+decimal_add_int(decimal_t *res, const decimal_t *lhs, const decimal_t *rhs,
+		bool negate_rhs)
+{
+	if (((lhs->bits | rhs->bits) & DECSPECIAL) != 0)
+		return NULL;
+	if (lhs->digits > DECIMAL_FAST_DIGITS ||
+	    rhs->digits > DECIMAL_FAST_DIGITS)
+		return NULL;
+	int32_t shift = lhs->exponent - rhs->exponent;
+	if (shift > DECIMAL_FAST_DIGITS || shift < -DECIMAL_FAST_DIGITS)
+		return NULL;
+	__int128 a = decimal_get_coeff(lhs);
+	__int128 b = decimal_get_coeff(rhs);
+	if (negate_rhs)
+		b = -b;
+	int32_t exponent;
+	if (shift >= 0) {
+		a *= decimal_pow10[shift];
+		exponent = rhs->exponent;
+	} else {
+		b *= decimal_pow10[-shift];
+		exponent = lhs->exponent;
+	}
+	__int128 sum = a + b;
+	if (sum == 0)
+		return NULL;
+	if (sum >= decimal_pow10[DECIMAL_FAST_DIGITS] ||
+	    sum <= -decimal_pow10[DECIMAL_FAST_DIGITS])
+		return NULL;
+	int64_t c = (int64_t)sum;
+	uint64_t u = c < 0 ? (uint64_t)-c : (uint64_t)c;
+	int digits = 1;
+	while (digits < DECIMAL_FAST_DIGITS &&
+	       u >= (uint64_t)decimal_pow10[digits])
+		digits++;
+	/* Exponent overflow is an error, let decNumber report it. */
+	if (exponent + digits - 1 > decimal_context.emax)
+		return NULL;
+	decimal_set_coeff(res, c, exponent, digits);
+	return res;
+}
+
 decimal_t *
 decimal_add(decimal_t *res, const decimal_t *lhs, const decimal_t *rhs)
 {
+	if (decimal_add_int(res, lhs, rhs, false) != NULL)
+		return res;
 	decNumberAdd(res, lhs, rhs, &decimal_context);
 	return decimal_check_status(res, &decimal_context);
 }
@@ -322,6 +445,8 @@ decimal_add(decimal_t *res, const decimal_t *lhs, const decimal_t *rhs)
 decimal_t *
 decimal_sub(decimal_t *res, const decimal_t *lhs, const decimal_t *rhs)
 {
+	if (decimal_add_int(res, lhs, rhs, true) != NULL)
+		return res;
 	decNumberSubtract(res, lhs, rhs, &decimal_context);
 
 	return decimal_check_status(res, &decimal_context);
@@ -101,14 +101,15 @@ evio_setsockopt_keepalive(int fd)
 	return 0;
 }
 
-/** Set common client socket options. */
-int
-evio_setsockopt_client(int fd, int family, int type)
+/**
+ * Set common client socket options except the non-blocking mode,
+ * for sockets which are non-blocking already (accepted with
+ * sio_accept_nonblock()).
+ */
+static int
+evio_setsockopt_client_common(int fd, int family, int type)
 {
 	int on = 1;
-	/* In case this throws, the socket is not leaked. */
-	if (sio_setfl(fd, O_NONBLOCK, on))
-		return -1;
 	if (type == SOCK_STREAM && family != AF_UNIX) {
 		/*
 		 * SO_KEEPALIVE to ensure connections don't hang
@@ -128,6 +129,17 @@ evio_setsockopt_client(int fd, int family, int type)
 	return 0;
 }
 
+/** Set common client socket options. */
+int
+evio_setsockopt_client(int fd, int family, int type)
+{
+	int on = 1;
+	/* In case this throws, the socket is not leaked. */
+	if (sio_setfl(fd, O_NONBLOCK, on))
+		return -1;
+	return evio_setsockopt_client_common(fd, family, type);
+}
+
 int
 evio_setsockopt_server(int fd, int family, int type)
 {
@@ -155,12 +167,55 @@ evio_setsockopt_server(int fd, int family, int type)
 	return 0;
 }
 
+bool
+evio_reuse_port_supported(void)
+{
+#ifdef SO_REUSEPORT
+	return true;
+#else
+	return false;
+#endif
+}
+
+/**
+ * Allow several sockets to bind to the same address, each with
+ * its own accept queue. The kernel balances new connections
+ * between all such sockets.
+ */
+static int
+evio_setsockopt_reuseport(int fd)
+{
+#ifdef SO_REUSEPORT
+	int on = 1;
+	if (sio_setsockopt(fd, SOL_SOCKET, SO_REUSEPORT,
+		       &on, sizeof(on)))
+		return -1;
+	return 0;
+#else
+	diag_set(SocketError, sio_socketname(fd),
+		 "SO_REUSEPORT is not supported");
+	return -1;
+#endif
+}
+
 static inline const char *
 evio_service_name(struct evio_service *service)
 {
 	return service->name;
 }
 
+enum {
+	/**
+	 * How many connections a single acceptor callback may
+	 * take from the backlog. During a reconnect storm the
+	 * budget keeps the rest of the event loop responsive:
+	 * connections over the budget stay in the kernel backlog
+	 * and are picked up on the next loop iteration, since the
+	 * acceptor watcher is level-triggered.
+	 */
+	EVIO_ACCEPT_BATCH_MAX = 1024,
+};
+
 /**
  * A callback invoked by libev when acceptor socket is ready.
  * Accept the socket, initialize it and pass to the on_accept
@@ -173,28 +228,39 @@ evio_service_accept_cb(ev_loop *loop, ev_io *watcher, int events)
 	(void) events;
 	struct evio_service *service = (struct evio_service *) watcher->data;
 	int fd;
-	while (1) {
+	for (int i = 0; ; i++) {
+		if (i >= EVIO_ACCEPT_BATCH_MAX) {
+			/*
+			 * The budget is exhausted, the backlog is
+			 * not: let the rest of the loop run, the
+			 * watcher fires again right away.
+			 */
+			service->stats.batch_overflows++;
+			return;
+		}
 		/*
-		 * Accept all pending connections from backlog during event
-		 * loop iteration. Significally speed up acceptor with enabled
+		 * Accept pending connections from the backlog in a
+		 * batch during one event loop iteration.
+		 * Significally speed up acceptor with enabled
 		 * io_collect_interval.
 		 */
 		struct sockaddr_storage addr;
 		socklen_t addrlen = sizeof(addr);
-		fd = sio_accept(service->ev.fd, (struct sockaddr *)&addr,
-				&addrlen);
+		fd = sio_accept_nonblock(service->ev.fd,
+					 (struct sockaddr *)&addr, &addrlen);
 
 		if (fd < 0) {
 			if (! sio_wouldblock(errno))
 				break;
 			return;
 		}
-		if (evio_setsockopt_client(fd, service->addr.sa_family,
-					   SOCK_STREAM) != 0)
+		if (evio_setsockopt_client_common(fd, service->addr.sa_family,
+						  SOCK_STREAM) != 0)
 			break;
 		if (service->on_accept(service, fd, (struct sockaddr *)&addr,
 				       addrlen) != 0)
 			break;
+		service->stats.accepted++;
 	}
 	if (fd >= 0)
 		close(fd);
@@ -257,6 +323,9 @@ evio_service_bind_addr(struct evio_service *service)
 				   SOCK_STREAM) != 0)
 		goto error;
 
+	if (service->reuse_port && evio_setsockopt_reuseport(fd) != 0)
+		goto error;
+
 	if (sio_bind(fd, &service->addr, service->addr_len)) {
 		if (errno != EADDRINUSE)
 			goto error;
@@ -35,6 +35,7 @@
  * Requires a running libev loop.
  */
 #include <stdbool.h>
+#include <stdint.h>
 #include "tarantool_ev.h"
 #include "sio.h"
 #include "uri/uri.h"
@@ -87,6 +88,16 @@ struct evio_service
 	};
 	socklen_t addr_len;
 
+	/**
+	 * Bind the acceptor socket with SO_REUSEPORT so that
+	 * several services may share the same address, each with
+	 * its own accept queue the kernel balances incoming
+	 * connections between. Must be set before
+	 * evio_service_bind(). Unix domain sockets do not support
+	 * this option.
+	 */
+	bool reuse_port;
+
 	/**
 	 * A callback invoked on every accepted client socket.
 	 * If a callback returned != 0, the accepted socket is
@@ -95,6 +106,19 @@ struct evio_service
 	evio_accept_f on_accept;
 	void *on_accept_param;
 
+	/** Acceptor statistics. */
+	struct {
+		/** Connections accepted since start. */
+		uint64_t accepted;
+		/**
+		 * Times an acceptor callback stopped because the
+		 * per-iteration accept budget was exhausted while
+		 * the kernel backlog still had pending
+		 * connections.
+		 */
+		uint64_t batch_overflows;
+	} stats;
+
 	/** libev io object for the acceptor socket. */
 	struct ev_io ev;
 	ev_loop *loop;
@@ -162,6 +186,13 @@ evio_setsockopt_client(int fd, int family, int type);
 int
 evio_setsockopt_server(int fd, int family, int type);
 
+/**
+ * True if the platform supports SO_REUSEPORT, i.e. a service
+ * may be bound with the reuse_port flag set.
+ */
+bool
+evio_reuse_port_supported(void);
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
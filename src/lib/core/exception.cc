@@ -93,10 +93,78 @@ static const struct method_info exception_methods[] = {
 const struct type_info type_Exception = make_type("Exception", NULL,
 	exception_methods);
 
+enum {
+	/**
+	 * All error objects not larger than this (minus the
+	 * header) share one allocation size and are recycled
+	 * through a per-thread cache. Covers every error type
+	 * in the tree with room to spare for the ones carrying
+	 * payload arrays.
+	 */
+	EXCEPTION_CACHE_BLOCK_SIZE = 1024,
+	/** Max number of blocks cached per thread. */
+	EXCEPTION_CACHE_MAX = 64,
+};
+
+/**
+ * Header preceding every heap-allocated error object,
+ * remembering the allocation size for operator delete.
+ * Padded to keep the object aligned for any error member.
+ */
+struct alignas(sizeof(void *) * 2) exception_header {
+	size_t total;
+};
+
+/**
+ * Per-thread cache of discarded error blocks. A raise-catch-
+ * discard cycle, the common fate of a validation error, reuses
+ * a block from here instead of going to the heap. The list
+ * links through the block memory itself.
+ */
+static __thread void *exception_cache = NULL;
+static __thread int exception_cache_size = 0;
+
+static void *
+exception_alloc(size_t size)
+{
+	size_t total = sizeof(struct exception_header) + size;
+	struct exception_header *header;
+	if (total <= EXCEPTION_CACHE_BLOCK_SIZE) {
+		total = EXCEPTION_CACHE_BLOCK_SIZE;
+		if (exception_cache != NULL) {
+			header = (struct exception_header *)exception_cache;
+			exception_cache = *(void **)exception_cache;
+			exception_cache_size--;
+			header->total = total;
+			return header + 1;
+		}
+	}
+	header = (struct exception_header *)malloc(total);
+	if (header == NULL)
+		return NULL;
+	header->total = total;
+	return header + 1;
+}
+
+static void
+exception_free(void *ptr)
+{
+	struct exception_header *header =
+		(struct exception_header *)ptr - 1;
+	if (header->total == EXCEPTION_CACHE_BLOCK_SIZE &&
+	    exception_cache_size < EXCEPTION_CACHE_MAX) {
+		*(void **)header = exception_cache;
+		exception_cache = header;
+		exception_cache_size++;
+		return;
+	}
+	free(header);
+}
+
 void *
 Exception::operator new(size_t size)
 {
-	void *buf = malloc(size);
+	void *buf = exception_alloc(size);
 	if (buf != NULL)
 		return buf;
 	diag_set_error(diag_get(), &out_of_memory);
@@ -106,7 +174,7 @@ Exception::operator new(size_t size)
 void
 Exception::operator delete(void *ptr)
 {
-	free(ptr);
+	exception_free(ptr);
 }
 
 Exception::~Exception()
@@ -301,7 +369,7 @@ RaftError::RaftError(const char *file, unsigned line, const char *format, ...)
 }
 
 #define BuildAlloc(type)				\
-	void *p = malloc(sizeof(type));			\
+	void *p = exception_alloc(sizeof(type));	\
 	if (p == NULL)					\
 		return &out_of_memory;
 
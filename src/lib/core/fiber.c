@@ -39,7 +39,12 @@
 #include <pmatomic.h>
 
 #include "assoc.h"
+#include "bit/bit.h"
+#include "clock.h"
+#include "cpu_pin.h"
 #include "memory.h"
+#include "probes.h"
+#include "profiler.h"
 #include "trigger.h"
 #include "errinj.h"
 
@@ -268,6 +273,12 @@ enum {
 	FIBER_STACK_SIZE_DEFAULT = 524288,
 	/* Stack size watermark in bytes. */
 	FIBER_STACK_SIZE_WATERMARK = 65536,
+	/*
+	 * Default watermark on the dead fiber cache size. A
+	 * fiber pool raises it up to the pool capacity, see
+	 * fiber_cache_set_max_size().
+	 */
+	FIBER_DEAD_CACHE_SIZE_DEFAULT = 128,
 };
 
 /** Default fiber attributes */
@@ -400,6 +411,7 @@ fiber_call_impl(struct fiber *callee)
 	cord->fiber = callee;
 
 	callee->flags &= ~FIBER_IS_READY;
+	TNT_PROBE2(fiber_switch, caller->fid, callee->fid);
 	ASAN_START_SWITCH_FIBER(asan_state, 1,
 				callee->stack,
 				callee->stack_size);
@@ -443,6 +455,17 @@ fiber_checkstack(void)
 	return false;
 }
 
+/** True if no fiber is scheduled in any class. */
+static inline bool
+fiber_ready_is_empty(struct cord *cord)
+{
+	for (int prio = 0; prio < FIBER_PRIO_MAX; prio++) {
+		if (!rlist_empty(&cord->ready[prio]))
+			return false;
+	}
+	return true;
+}
+
 /**
  * Interrupt a synchronous wait of a fiber inside the event loop.
  * We do so by keeping an "async" event in every fiber, solely
@@ -480,7 +503,7 @@ fiber_wakeup(struct fiber *f)
 	if (f->flags & (FIBER_IS_READY | FIBER_IS_DEAD))
 		return;
 	struct cord *cord = cord();
-	if (rlist_empty(&cord->ready)) {
+	if (fiber_ready_is_empty(cord)) {
 		/*
 		 * ev_feed_event(EV_CUSTOM) gets scheduled in the
 		 * same event loop iteration, and we rely on this
@@ -497,12 +520,22 @@ fiber_wakeup(struct fiber *f)
 	 * added to the tail of the list, to preserve correct
 	 * transaction commit order after a successful WAL write.
 	 * (see tx_schedule_commit()/tx_schedule_rollback() in
-	 * box/wal.cc)
+	 * box/wal.cc). Fibers woken by the WAL share the same
+	 * scheduling class, so the per-class FIFO keeps the
+	 * order.
 	 */
-	rlist_move_tail_entry(&cord->ready, f, state);
+	rlist_move_tail_entry(&cord->ready[f->priority], f, state);
+	f->wakeup_time = clock_monotonic_coarse();
 	f->flags |= FIBER_IS_READY;
 }
 
+void
+fiber_set_priority(struct fiber *fiber, enum fiber_priority priority)
+{
+	assert(priority < FIBER_PRIO_MAX);
+	fiber->priority = priority;
+}
+
 /** Cancel the subject fiber.
 *
  * Note: cancelation is asynchronous. Use fiber_join() to wait for the
@@ -661,6 +694,7 @@ fiber_yield(void)
 	assert(! (callee->flags & FIBER_IS_DEAD));
 	cord->fiber = callee;
 	callee->flags &= ~FIBER_IS_READY;
+	TNT_PROBE2(fiber_switch, caller->fid, callee->fid);
 	ASAN_START_SWITCH_FIBER(asan_state,
 				(caller->flags & FIBER_IS_DEAD) == 0,
 				callee->stack,
@@ -742,8 +776,22 @@ fiber_schedule_cb(ev_loop *loop, ev_watcher *watcher, int revents)
 	fiber_wakeup(fiber);
 }
 
+/**
+ * Account the wakeup-to-run delay of @a f in a log-scale
+ * histogram: bucket i counts delays in [2^i, 2^(i+1)) us.
+ */
+static inline void
+fiber_sched_delay_collect(int64_t *hist, struct fiber *f, double now)
+{
+	uint64_t us = (uint64_t)((now - f->wakeup_time) * 1e6);
+	int bucket = 63 - bit_clz_u64(us | 1);
+	if (bucket >= FIBER_SCHED_DELAY_BUCKETS)
+		bucket = FIBER_SCHED_DELAY_BUCKETS - 1;
+	hist[bucket]++;
+}
+
 static inline void
-fiber_schedule_list(struct rlist *list)
+fiber_schedule_list(struct rlist *list, int64_t *delay_hist)
 {
 	struct fiber *first;
 	struct fiber *last;
@@ -755,13 +803,16 @@ fiber_schedule_list(struct rlist *list)
 	if (rlist_empty(list))
 		return;
 
+	double now = clock_monotonic_coarse();
 	first = last = rlist_shift_entry(list, struct fiber, state);
 	assert(last->flags & FIBER_IS_READY);
+	fiber_sched_delay_collect(delay_hist, first, now);
 
 	while (! rlist_empty(list)) {
 		last->caller = rlist_shift_entry(list, struct fiber, state);
 		last = last->caller;
 		assert(last->flags & FIBER_IS_READY);
+		fiber_sched_delay_collect(delay_hist, last, now);
 	}
 	last->caller = fiber();
 	assert(fiber() == &cord()->sched);
@@ -776,7 +827,9 @@ fiber_schedule_wakeup(ev_loop *loop, ev_async *watcher, int revents)
 	(void) watcher;
 	(void) revents;
 	struct cord *cord = cord();
-	fiber_schedule_list(&cord->ready);
+	for (int prio = FIBER_PRIO_MAX - 1; prio >= 0; prio--)
+		fiber_schedule_list(&cord->ready[prio],
+				    cord->sched_delay[prio]);
 }
 
 static void
@@ -820,15 +873,43 @@ fiber_self(void)
 	return fiber();
 }
 
+enum {
+	/** Region memory always kept across fiber_gc(). */
+	FIBER_GC_RETAIN_MIN = 128 * 1024,
+	/** Hard cap on region memory kept across fiber_gc(). */
+	FIBER_GC_RETAIN_MAX = 4 * 1024 * 1024,
+};
+
 void
 fiber_gc(void)
 {
-	if (region_used(&fiber()->gc) < 128 * 1024) {
-		region_reset(&fiber()->gc);
+	struct fiber *f = fiber();
+	size_t used = region_used(&f->gc);
+	/*
+	 * Retention cap derived from the decaying high watermark
+	 * of recent gc cycles: a fiber which sees the same demand
+	 * request after request keeps its slabs instead of cycling
+	 * them through the thread slab cache, while memory left
+	 * after a one-off spike or after the load has gone away
+	 * is released as the watermark decays.
+	 */
+	size_t watermark = f->gc_watermark;
+	size_t cap = 2 * watermark;
+	if (cap < FIBER_GC_RETAIN_MIN)
+		cap = FIBER_GC_RETAIN_MIN;
+	else if (cap > FIBER_GC_RETAIN_MAX)
+		cap = FIBER_GC_RETAIN_MAX;
+	watermark -= watermark / 16;
+	if (used > watermark)
+		watermark = used;
+	f->gc_watermark = watermark;
+	if (region_total(&f->gc) <= cap) {
+		f->gc_retain_count++;
+		region_reset(&f->gc);
 		return;
 	}
-
-	region_free(&fiber()->gc);
+	f->gc_release_count++;
+	region_free(&f->gc);
 }
 
 /** Common part of fiber_new() and fiber_recycle(). */
@@ -838,6 +919,10 @@ fiber_reset(struct fiber *fiber)
 	rlist_create(&fiber->on_yield);
 	rlist_create(&fiber->on_stop);
 	fiber->flags = FIBER_DEFAULT_FLAGS;
+	fiber->priority = FIBER_PRIO_NORMAL;
+	fiber->gc_watermark = 0;
+	fiber->gc_retain_count = 0;
+	fiber->gc_release_count = 0;
 #if ENABLE_FIBER_TOP
 	clock_stat_reset(&fiber->clock_stat);
 #endif /* ENABLE_FIBER_TOP */
@@ -862,12 +947,35 @@ fiber_recycle(struct fiber *fiber)
 	fiber->fid = 0;
 	region_free(&fiber->gc);
 	if (!has_custom_stack) {
+		/*
+		 * Evict the coldest cached fiber when the cache is
+		 * over its watermark. The victim is taken from the
+		 * tail since fiber_new_ex() reuses from the head,
+		 * so it can not be the fiber being recycled.
+		 */
+		while (cord()->dead_size >= cord()->dead_max) {
+			struct fiber *victim =
+				rlist_last_entry(&cord()->dead, struct fiber,
+						 link);
+			fiber_destroy(cord(), victim);
+			mempool_free(&cord()->fiber_mempool, victim);
+			--cord()->dead_size;
+			++cord()->stack_reclaimed;
+		}
 		rlist_move_entry(&cord()->dead, fiber, link);
+		++cord()->dead_size;
 	} else {
 		fiber_destroy(cord(), fiber);
 	}
 }
 
+void
+fiber_cache_set_max_size(int max_size)
+{
+	if (cord()->dead_max < max_size)
+		cord()->dead_max = max_size;
+}
+
 static void
 fiber_loop(MAYBE_UNUSED void *data)
 {
@@ -1020,11 +1128,18 @@ fiber_stack_recycle(struct fiber *fiber)
 	}
 
 	/*
-	 * Ignore errors on MADV_DONTNEED because this is
-	 * just a hint for OS and not critical for
-	 * functionality.
+	 * Ignore madvise() errors because this is just a hint
+	 * for OS and not critical for functionality. Prefer lazy
+	 * MADV_FREE when available: the pages are dropped only
+	 * under memory pressure, so a stack reused from the dead
+	 * fiber cache usually keeps its hot pages and does not
+	 * refault them.
 	 */
+#ifdef HAVE_MADV_FREE
+	fiber_madvise(start, end - start, MADV_FREE);
+#else
 	fiber_madvise(start, end - start, MADV_DONTNEED);
+#endif
 	stack_put_watermark(fiber->stack_watermark);
 }
 
@@ -1190,6 +1305,8 @@ fiber_new_ex(const char *name, const struct fiber_attr *fiber_attr,
 		fiber = rlist_first_entry(&cord->dead,
 					  struct fiber, link);
 		rlist_move_entry(&cord->alive, fiber, link);
+		--cord->dead_size;
+		++cord->stack_reused;
 	} else {
 		fiber = (struct fiber *)
 			mempool_alloc(&cord->fiber_mempool);
@@ -1205,6 +1322,7 @@ fiber_new_ex(const char *name, const struct fiber_attr *fiber_attr,
 			mempool_free(&cord->fiber_mempool, fiber);
 			return NULL;
 		}
+		++cord->stack_created;
 		coro_create(&fiber->ctx, fiber_loop, NULL,
 			    fiber->stack, fiber->stack_size);
 
@@ -1410,8 +1528,15 @@ cord_create(struct cord *cord, const char *name)
 	mempool_create(&cord->fiber_mempool, &cord->slabc,
 		       sizeof(struct fiber));
 	rlist_create(&cord->alive);
-	rlist_create(&cord->ready);
+	for (int prio = 0; prio < FIBER_PRIO_MAX; prio++)
+		rlist_create(&cord->ready[prio]);
+	memset(cord->sched_delay, 0, sizeof(cord->sched_delay));
 	rlist_create(&cord->dead);
+	cord->dead_size = 0;
+	cord->dead_max = FIBER_DEAD_CACHE_SIZE_DEFAULT;
+	cord->stack_created = 0;
+	cord->stack_reused = 0;
+	cord->stack_reclaimed = 0;
 	cord->fiber_registry = mh_i32ptr_new();
 
 	/* sched fiber is not present in alive/ready/dead list. */
@@ -1439,6 +1564,7 @@ cord_create(struct cord *cord, const char *name)
 		fiber_top_init();
 	}
 #endif /* ENABLE_FIBER_TOP */
+	profiler_thread_init();
 	cord_set_name(name);
 
 #if ENABLE_ASAN
@@ -1470,6 +1596,9 @@ cord_destroy(struct cord *cord)
 	diag_destroy(&cord->sched.diag);
 	if (cord->sched.name != cord->sched.inline_name)
 		free(cord->sched.name);
+	/* Non-main cords free their ring in cord_thread_func(). */
+	if (cord() == cord)
+		profiler_thread_free();
 	slab_cache_destroy(&cord->slabc);
 }
 
@@ -1492,6 +1621,7 @@ void *cord_thread_func(void *p)
 {
 	struct cord_thread_arg *ct_arg = (struct cord_thread_arg *) p;
 	cord_create(ct_arg->cord, (ct_arg->name));
+	cpu_pin_thread(ct_arg->name);
 	/** Can't possibly be the main thread */
 	assert(cord()->id != main_thread_id);
 	tt_pthread_mutex_lock(&ct_arg->start_mutex);
@@ -1518,6 +1648,11 @@ void *cord_thread_func(void *p)
 	                                            CORD_ON_EXIT_WONT_RUN);
 	if (!changed)
 		handler->callback(handler->argument);
+	/*
+	 * The ring is thread-local, so it must be freed here, in
+	 * the dying thread: cord_destroy() may run in the joiner.
+	 */
+	profiler_thread_free();
 	return res;
 }
 
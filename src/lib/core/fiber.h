@@ -165,6 +165,20 @@ enum {
 	FIBER_DEFAULT_FLAGS = FIBER_IS_CANCELLABLE
 };
 
+/**
+ * Fiber scheduling class. Within a class the ready list is
+ * FIFO, a higher class is always scheduled before a lower one.
+ */
+enum fiber_priority {
+	FIBER_PRIO_LOW = 0,
+	FIBER_PRIO_NORMAL = 1,
+	FIBER_PRIO_HIGH = 2,
+	FIBER_PRIO_MAX = 3,
+};
+
+/** Number of log-scale fiber scheduling delay buckets. */
+enum { FIBER_SCHED_DELAY_BUCKETS = 32 };
+
 /** \cond public */
 
 /**
@@ -522,6 +536,16 @@ struct fiber {
 	unsigned int stack_id;
 	/* A garbage-collected memory pool. */
 	struct region gc;
+	/**
+	 * Decaying high watermark of region usage at fiber_gc()
+	 * time. Drives the adaptive slab retention policy, see
+	 * fiber_gc().
+	 */
+	size_t gc_watermark;
+	/** Number of fiber_gc() calls which kept the slabs. */
+	uint64_t gc_retain_count;
+	/** Number of fiber_gc() calls which released the slabs. */
+	uint64_t gc_release_count;
 	/**
 	 * The fiber which should be scheduled when
 	 * this fiber yields.
@@ -533,6 +557,10 @@ struct fiber {
 	uint32_t fid;
 	/** Fiber flags */
 	uint32_t flags;
+	/** Scheduling class, see enum fiber_priority. */
+	uint8_t priority;
+	/** Monotonic time of the last fiber_wakeup(). */
+	double wakeup_time;
 #if ENABLE_FIBER_TOP
 	struct clock_stat clock_stat;
 #endif /* ENABLE_FIBER_TOP */
@@ -652,10 +680,33 @@ struct cord {
 	struct mh_i32ptr_t *fiber_registry;
 	/** All fibers */
 	struct rlist alive;
-	/** Fibers, ready for execution */
-	struct rlist ready;
+	/** Fibers, ready for execution, one FIFO list per class */
+	struct rlist ready[FIBER_PRIO_MAX];
+	/**
+	 * Log-scale wakeup-to-run delay histograms, one per
+	 * scheduling class: bucket i counts delays in
+	 * [2^i, 2^(i+1)) microseconds.
+	 */
+	int64_t sched_delay[FIBER_PRIO_MAX][FIBER_SCHED_DELAY_BUCKETS];
 	/** A cache of dead fibers for reuse */
 	struct rlist dead;
+	/** Number of fibers in the dead fiber cache. */
+	int dead_size;
+	/**
+	 * Watermark on the dead fiber cache size. A fiber
+	 * recycled over the watermark evicts the coldest cached
+	 * fiber instead of growing the cache, so stack memory of
+	 * a fiber churn burst is given back to the OS. A fiber
+	 * pool raises the watermark up to the pool capacity, see
+	 * fiber_cache_set_max_size().
+	 */
+	int dead_max;
+	/** Fiber stacks carved anew from the slab cache. */
+	int64_t stack_created;
+	/** Fibers served from the dead fiber cache. */
+	int64_t stack_reused;
+	/** Cached fibers destroyed over the watermark. */
+	int64_t stack_reclaimed;
 	/** A watcher to have a single async event for all ready fibers.
 	 * This technique is necessary to be able to suspend
 	 * a single fiber on a few watchers (for example,
@@ -791,6 +842,21 @@ fiber_name(struct fiber *f)
 bool
 fiber_checkstack(void);
 
+/**
+ * Set the scheduling class of @a fiber. Takes effect on the
+ * next wakeup: an already scheduled fiber is not requeued.
+ */
+void
+fiber_set_priority(struct fiber *fiber, enum fiber_priority priority);
+
+/**
+ * Raise the watermark on the cord's dead fiber cache up to
+ * @a max_size fibers. The watermark is never lowered: another
+ * user of the cache may have raised it before.
+ */
+void
+fiber_cache_set_max_size(int max_size);
+
 /**
  * @brief yield & check for timeout
  * @return true if timeout exceeded
@@ -97,15 +97,24 @@ fiber_pool_idle_cb(ev_loop *loop, struct ev_timer *watcher, int events)
 {
 	(void) events;
 	struct fiber_pool *pool = (struct fiber_pool *) watcher->data;
-	if (! rlist_empty(&pool->idle)) {
+	/*
+	 * Schedule fibers from the tail of the list - the ones
+	 * most likely to have not been scheduled lately. A fiber
+	 * idle longer than the timeout exits, and its stack is
+	 * retired to the cord's dead fiber cache for the next
+	 * pool growth. The list is most-recently-parked first,
+	 * so once a fiber survives the check and parks itself
+	 * back, the remaining fibers are all warmer and the
+	 * shrink is over: this way one timer tick retires a
+	 * whole burst worth of idle fibers instead of one.
+	 */
+	while (! rlist_empty(&pool->idle)) {
 		struct fiber *f;
-		/*
-		 * Schedule the fiber at the tail of the list,
-		 * it's the one most likely to have not been
-		 * scheduled lately.
-		 */
+		int size = pool->size;
 		f = rlist_shift_tail_entry(&pool->idle, struct fiber, state);
 		fiber_call(f);
+		if (pool->size >= size)
+			break;
 	}
 	ev_timer_again(loop, watcher);
 }
@@ -150,6 +159,7 @@ void
 fiber_pool_set_max_size(struct fiber_pool *pool, int new_max_size)
 {
 	pool->max_size = new_max_size;
+	fiber_cache_set_max_size(new_max_size);
 }
 
 void
@@ -165,6 +175,12 @@ fiber_pool_create(struct fiber_pool *pool, const char *name, int max_pool_size,
 	ev_timer_again(loop(), &pool->idle_timer);
 	pool->size = 0;
 	pool->max_size = max_pool_size;
+	/*
+	 * Let the dead fiber cache absorb a pool shrinking on
+	 * idle timeout, so that the stacks are reused when the
+	 * load comes back.
+	 */
+	fiber_cache_set_max_size(max_pool_size);
 	stailq_create(&pool->output);
 	fiber_cond_create(&pool->worker_cond);
 	/* Join fiber pool to cbus */
@@ -0,0 +1,152 @@
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "flightrec.h"
+
+#include <stdlib.h>
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include "clock.h"
+#include "say.h"
+
+enum {
+	/** Ring capacity, must be a power of two. */
+	FLIGHTREC_EVENTS = 8192,
+};
+
+struct flightrec_event {
+	/** Monotonic timestamp, ns. Zero marks an unused slot. */
+	uint64_t ns;
+	/** Event correlation id (sync, txn id, entry id). */
+	uint64_t id;
+	/** Event payload (length, row count, result). */
+	uint64_t arg;
+	/** enum flightrec_type. */
+	uint32_t type;
+};
+
+static const char *flightrec_type_strs[flightrec_type_MAX] = {
+	"iproto_recv",
+	"tx_begin",
+	"tx_commit",
+	"tx_rollback",
+	"wal_submit",
+	"wal_complete",
+	"reply_flush",
+};
+
+/**
+ * The ring is strictly thread-local: one writer, created on
+ * first use so threads which never record pay nothing.
+ */
+static __thread struct flightrec_event *flightrec_ring = NULL;
+static __thread uint64_t flightrec_pos = 0;
+
+void
+flightrec_record(enum flightrec_type type, uint64_t id, uint64_t arg)
+{
+	struct flightrec_event *ring = flightrec_ring;
+	if (ring == NULL) {
+		ring = calloc(FLIGHTREC_EVENTS, sizeof(*ring));
+		if (ring == NULL)
+			return;
+		flightrec_ring = ring;
+	}
+	struct flightrec_event *e =
+		&ring[flightrec_pos++ & (FLIGHTREC_EVENTS - 1)];
+	e->ns = clock_monotonic64();
+	e->id = id;
+	e->arg = arg;
+	e->type = type;
+}
+
+void
+flightrec_dump(void)
+{
+	struct flightrec_event *ring = flightrec_ring;
+	if (ring == NULL) {
+		say_info("flightrec: no events recorded on this thread");
+		return;
+	}
+	uint64_t now = clock_monotonic64();
+	uint64_t pos = flightrec_pos;
+	say_info("flightrec: dump of the last %llu events",
+		 (unsigned long long)(pos < FLIGHTREC_EVENTS ?
+				      pos : FLIGHTREC_EVENTS));
+	for (uint64_t i = 0; i < FLIGHTREC_EVENTS; i++) {
+		struct flightrec_event *e =
+			&ring[(pos + i) & (FLIGHTREC_EVENTS - 1)];
+		if (e->ns == 0)
+			continue;
+		say_info("flightrec: -%.6fs %s id=%llu arg=%llu",
+			 (now - e->ns) / 1e9,
+			 flightrec_type_strs[e->type],
+			 (unsigned long long)e->id,
+			 (unsigned long long)e->arg);
+	}
+}
+
+void
+flightrec_dump_fd(int fd)
+{
+	/*
+	 * fdprintf() understands too few conversions, so format
+	 * each line into a stack buffer and write() it. No
+	 * allocations - the caller may be a crash handler.
+	 */
+	char line[128];
+	int len;
+	struct flightrec_event *ring = flightrec_ring;
+	if (ring == NULL) {
+		len = snprintf(line, sizeof(line),
+			       "no events recorded on this thread\n");
+		if (write(fd, line, len) != len)
+			return;
+		return;
+	}
+	uint64_t now = clock_monotonic64();
+	uint64_t pos = flightrec_pos;
+	for (uint64_t i = 0; i < FLIGHTREC_EVENTS; i++) {
+		struct flightrec_event *e =
+			&ring[(pos + i) & (FLIGHTREC_EVENTS - 1)];
+		if (e->ns == 0)
+			continue;
+		len = snprintf(line, sizeof(line),
+			       "-%.6fs %s id=%llu arg=%llu\n",
+			       (now - e->ns) / 1e9,
+			       flightrec_type_strs[e->type],
+			       (unsigned long long)e->id,
+			       (unsigned long long)e->arg);
+		if (write(fd, line, len) != len)
+			break;
+	}
+}
@@ -0,0 +1,100 @@
+#ifndef TARANTOOL_LIB_CORE_FLIGHTREC_H_INCLUDED
+#define TARANTOOL_LIB_CORE_FLIGHTREC_H_INCLUDED
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * Flight recorder: an always-on per-thread ring of timestamped
+ * events along the request path. Recording is a timestamp read
+ * and three stores into a thread-local ring - no locks, no
+ * branches on hot data, old events are silently overwritten.
+ * When a latency incident has already passed, the ring still
+ * holds the last few thousand events of this thread and can be
+ * dumped to the log on demand.
+ */
+
+enum flightrec_type {
+	/** Request read from a socket. id = sync, arg = length. */
+	FLIGHTREC_IPROTO_RECV,
+	/** Transaction began. id = txn id. */
+	FLIGHTREC_TX_BEGIN,
+	/** Transaction committed. id = txn id, arg = row count. */
+	FLIGHTREC_TX_COMMIT,
+	/** Transaction rolled back. id = txn id. */
+	FLIGHTREC_TX_ROLLBACK,
+	/**
+	 * Journal entry handed to WAL. id identifies the entry,
+	 * arg = approximate length.
+	 */
+	FLIGHTREC_WAL_SUBMIT,
+	/**
+	 * Journal entry completed by WAL. id matches the submit
+	 * event, arg = result.
+	 */
+	FLIGHTREC_WAL_COMPLETE,
+	/** Reply flushed to a socket. id = sync, arg = length. */
+	FLIGHTREC_REPLY_FLUSH,
+	flightrec_type_MAX,
+};
+
+/**
+ * Record an event in the ring of the calling thread. Safe to
+ * call from any thread at any time; never fails (an allocation
+ * failure of the lazily created ring drops events silently).
+ */
+void
+flightrec_record(enum flightrec_type type, uint64_t id, uint64_t arg);
+
+/**
+ * Dump the ring of the calling thread to the log, oldest event
+ * first, with timestamps relative to the dump moment.
+ */
+void
+flightrec_dump(void);
+
+/**
+ * Same as flightrec_dump(), but write to a file descriptor
+ * instead of the log. Does not allocate, so it is usable from
+ * the crash handler for writing a microdump.
+ */
+void
+flightrec_dump_fd(int fd);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_LIB_CORE_FLIGHTREC_H_INCLUDED */
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2010-2021, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "heap_audit.h"
+
+#if defined(ENABLE_HEAP_AUDIT)
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "say.h"
+
+/**
+ * Name of the outermost open scope, for diagnostics.
+ */
+static __thread const char *heap_audit_scope_name;
+/**
+ * Nesting depth of open scopes. The counters are armed while it
+ * is above zero.
+ */
+static __thread int64_t heap_audit_scope_depth;
+/**
+ * Allocations and bytes seen since the outermost scope opened.
+ */
+static __thread int64_t heap_audit_allocs;
+static __thread int64_t heap_audit_bytes;
+
+void
+heap_audit_scope_enter(const char *name)
+{
+	if (heap_audit_scope_depth++ == 0) {
+		heap_audit_scope_name = name;
+		heap_audit_allocs = 0;
+		heap_audit_bytes = 0;
+	}
+}
+
+void
+heap_audit_scope_leave(void)
+{
+	assert(heap_audit_scope_depth > 0);
+	if (--heap_audit_scope_depth > 0)
+		return;
+	/*
+	 * The scope is closed before reporting, so the log
+	 * subsystem's own allocations are not counted.
+	 */
+	if (heap_audit_allocs > 0) {
+		say_warn_ratelimited("heap audit: %s: %lld heap "
+				     "allocation(s), %lld byte(s), inside "
+				     "an allocation-budgeted scope",
+				     heap_audit_scope_name,
+				     (long long) heap_audit_allocs,
+				     (long long) heap_audit_bytes);
+	}
+}
+
+/** Account a heap allocation of @a size bytes. */
+static inline void
+heap_audit_account(size_t size)
+{
+	if (heap_audit_scope_depth > 0) {
+		heap_audit_allocs++;
+		heap_audit_bytes += size;
+	}
+}
+
+/*
+ * The build is linked with --wrap=malloc,calloc,realloc: every
+ * call made from tarantool's own objects lands here and is
+ * forwarded to the real allocator. Allocations made inside libc
+ * or other shared libraries are not intercepted, which is fine:
+ * the audit is after our own code.
+ */
+
+extern void *
+__real_malloc(size_t size);
+
+extern void *
+__real_calloc(size_t nmemb, size_t size);
+
+extern void *
+__real_realloc(void *ptr, size_t size);
+
+void *
+__wrap_malloc(size_t size);
+
+void *
+__wrap_calloc(size_t nmemb, size_t size);
+
+void *
+__wrap_realloc(void *ptr, size_t size);
+
+void *
+__wrap_malloc(size_t size)
+{
+	heap_audit_account(size);
+	return __real_malloc(size);
+}
+
+void *
+__wrap_calloc(size_t nmemb, size_t size)
+{
+	heap_audit_account(nmemb * size);
+	return __real_calloc(nmemb, size);
+}
+
+void *
+__wrap_realloc(void *ptr, size_t size)
+{
+	heap_audit_account(size);
+	return __real_realloc(ptr, size);
+}
+
+#endif /* defined(ENABLE_HEAP_AUDIT) */
@@ -0,0 +1,88 @@
+#ifndef TARANTOOL_LIB_CORE_HEAP_AUDIT_H_INCLUDED
+#define TARANTOOL_LIB_CORE_HEAP_AUDIT_H_INCLUDED
+/*
+ * Copyright 2010-2021, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "trivia/config.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * Heap allocation audit: a CI/debug mode catching hidden mallocs
+ * on latency-critical paths.
+ *
+ * Hot request paths are expected to take all their memory from a
+ * region or a mempool; a stray malloc added in some decode corner
+ * is invisible in review but shows up in tail latency. When the
+ * build is configured with -DENABLE_HEAP_AUDIT=ON, malloc(),
+ * calloc() and realloc() calls made by tarantool's own code are
+ * counted per thread (via the linker's --wrap) and any allocation
+ * made inside an allocation-budgeted scope is reported to the
+ * log, rate-limited, with the scope name.
+ *
+ * In regular builds the scope markers compile to nothing.
+ *
+ * Scopes may nest; only the outermost enter/leave pair arms and
+ * reports the counters. The audit deliberately only reports and
+ * never aborts: a scope may legitimately allocate on rare
+ * subpaths (errors, first-touch caches), and the CI decides what
+ * is a regression by watching the log.
+ */
+#if defined(ENABLE_HEAP_AUDIT)
+
+/**
+ * Open an allocation-budgeted scope. @a name is reported with
+ * the diagnostics and must stay alive until the scope is left
+ * (a string literal, a request type name, etc).
+ */
+void
+heap_audit_scope_enter(const char *name);
+
+/**
+ * Close the scope opened by heap_audit_scope_enter(). Reports to
+ * the log when the outermost scope saw heap allocations.
+ */
+void
+heap_audit_scope_leave(void);
+
+#else /* !defined(ENABLE_HEAP_AUDIT) */
+
+#define heap_audit_scope_enter(name) do { (void) (name); } while (0)
+#define heap_audit_scope_leave() do {} while (0)
+
+#endif /* defined(ENABLE_HEAP_AUDIT) */
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_LIB_CORE_HEAP_AUDIT_H_INCLUDED */
@@ -0,0 +1,226 @@
+/*
+ * Copyright 2010-2021, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "iouring.h"
+
+#if defined(ENABLE_IOURING)
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "diag.h"
+#include "exception.h"
+
+static int
+iouring_enter(int fd, unsigned to_submit, unsigned min_complete,
+	      unsigned flags)
+{
+	return syscall(__NR_io_uring_enter, fd, to_submit, min_complete,
+		       flags, NULL, 0);
+}
+
+int
+iouring_create(struct iouring *ring, unsigned entries)
+{
+	struct io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	memset(ring, 0, sizeof(*ring));
+	int fd = syscall(__NR_io_uring_setup, entries, &params);
+	if (fd < 0) {
+		diag_set(SystemError, "io_uring_setup(%u)", entries);
+		return -1;
+	}
+	ring->fd = fd;
+	ring->sq_ring_size = params.sq_off.array +
+			     params.sq_entries * sizeof(unsigned);
+	ring->cq_ring_size = params.cq_off.cqes +
+			     params.cq_entries * sizeof(struct io_uring_cqe);
+	ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+	ring->sq_ring = mmap(NULL, ring->sq_ring_size,
+			     PROT_READ | PROT_WRITE,
+			     MAP_SHARED | MAP_POPULATE, fd,
+			     IORING_OFF_SQ_RING);
+	if (ring->sq_ring == MAP_FAILED)
+		goto fail;
+	ring->cq_ring = mmap(NULL, ring->cq_ring_size,
+			     PROT_READ | PROT_WRITE,
+			     MAP_SHARED | MAP_POPULATE, fd,
+			     IORING_OFF_CQ_RING);
+	if (ring->cq_ring == MAP_FAILED)
+		goto fail;
+	ring->sqes = (struct io_uring_sqe *)
+		mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+		     MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+	if (ring->sqes == MAP_FAILED)
+		goto fail;
+	char *sq = (char *) ring->sq_ring;
+	ring->sq_head = (unsigned *) (sq + params.sq_off.head);
+	ring->sq_tail = (unsigned *) (sq + params.sq_off.tail);
+	ring->sq_mask = (unsigned *) (sq + params.sq_off.ring_mask);
+	ring->sq_array = (unsigned *) (sq + params.sq_off.array);
+	ring->sq_entries = params.sq_entries;
+	ring->sq_prepared = *ring->sq_tail;
+	char *cq = (char *) ring->cq_ring;
+	ring->cq_head = (unsigned *) (cq + params.cq_off.head);
+	ring->cq_tail = (unsigned *) (cq + params.cq_off.tail);
+	ring->cq_mask = (unsigned *) (cq + params.cq_off.ring_mask);
+	ring->cqes = (struct io_uring_cqe *) (cq + params.cq_off.cqes);
+	return 0;
+fail:
+	diag_set(SystemError, "failed to map io_uring queues");
+	iouring_destroy(ring);
+	return -1;
+}
+
+void
+iouring_destroy(struct iouring *ring)
+{
+	if (ring->sqes != NULL && ring->sqes != MAP_FAILED)
+		munmap(ring->sqes, ring->sqes_size);
+	if (ring->cq_ring != NULL && ring->cq_ring != MAP_FAILED)
+		munmap(ring->cq_ring, ring->cq_ring_size);
+	if (ring->sq_ring != NULL && ring->sq_ring != MAP_FAILED)
+		munmap(ring->sq_ring, ring->sq_ring_size);
+	if (ring->fd >= 0)
+		close(ring->fd);
+	memset(ring, 0, sizeof(*ring));
+	ring->fd = -1;
+}
+
+int
+iouring_register_eventfd(struct iouring *ring, int eventfd)
+{
+	if (syscall(__NR_io_uring_register, ring->fd,
+		    IORING_REGISTER_EVENTFD, &eventfd, 1) != 0) {
+		diag_set(SystemError, "io_uring_register(EVENTFD)");
+		return -1;
+	}
+	return 0;
+}
+
+/** Grab the next free submission entry, NULL if the ring is full. */
+static struct io_uring_sqe *
+iouring_prep(struct iouring *ring, uint8_t opcode, int fd,
+	     const struct iovec *iov, int iovcnt, uint64_t user_data)
+{
+	unsigned head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+	if (ring->sq_prepared - head >= ring->sq_entries)
+		return NULL;
+	unsigned idx = ring->sq_prepared & *ring->sq_mask;
+	struct io_uring_sqe *sqe = &ring->sqes[idx];
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = opcode;
+	sqe->fd = fd;
+	sqe->addr = (uint64_t) (uintptr_t) iov;
+	sqe->len = iovcnt;
+	sqe->user_data = user_data;
+	ring->sq_array[idx] = idx;
+	ring->sq_prepared++;
+	return sqe;
+}
+
+int
+iouring_prep_readv(struct iouring *ring, int fd, const struct iovec *iov,
+		   int iovcnt, uint64_t user_data)
+{
+	return iouring_prep(ring, IORING_OP_READV, fd, iov, iovcnt,
+			    user_data) != NULL ? 0 : -1;
+}
+
+int
+iouring_prep_writev(struct iouring *ring, int fd, const struct iovec *iov,
+		    int iovcnt, uint64_t user_data)
+{
+	return iouring_prep(ring, IORING_OP_WRITEV, fd, iov, iovcnt,
+			    user_data) != NULL ? 0 : -1;
+}
+
+int
+iouring_prep_preadv(struct iouring *ring, int fd, const struct iovec *iov,
+		    int iovcnt, off_t offset, uint64_t user_data)
+{
+	struct io_uring_sqe *sqe = iouring_prep(ring, IORING_OP_READV, fd,
+						iov, iovcnt, user_data);
+	if (sqe == NULL)
+		return -1;
+	sqe->off = offset;
+	return 0;
+}
+
+int
+iouring_prep_pwritev(struct iouring *ring, int fd, const struct iovec *iov,
+		     int iovcnt, off_t offset, uint64_t user_data)
+{
+	struct io_uring_sqe *sqe = iouring_prep(ring, IORING_OP_WRITEV, fd,
+						iov, iovcnt, user_data);
+	if (sqe == NULL)
+		return -1;
+	sqe->off = offset;
+	return 0;
+}
+
+int
+iouring_submit(struct iouring *ring)
+{
+	unsigned to_submit = ring->sq_prepared - *ring->sq_tail;
+	if (to_submit == 0)
+		return 0;
+	__atomic_store_n(ring->sq_tail, ring->sq_prepared, __ATOMIC_RELEASE);
+	int rc;
+	do {
+		rc = iouring_enter(ring->fd, to_submit, 0, 0);
+	} while (rc < 0 && errno == EINTR);
+	if (rc < 0) {
+		diag_set(SystemError, "io_uring_enter(%u)", to_submit);
+		return -1;
+	}
+	return rc;
+}
+
+struct io_uring_cqe *
+iouring_peek_cqe(struct iouring *ring)
+{
+	unsigned head = *ring->cq_head;
+	unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+	if (head == tail)
+		return NULL;
+	return &ring->cqes[head & *ring->cq_mask];
+}
+
+void
+iouring_cqe_seen(struct iouring *ring)
+{
+	__atomic_store_n(ring->cq_head, *ring->cq_head + 1,
+			 __ATOMIC_RELEASE);
+}
+
+#endif /* defined(ENABLE_IOURING) */
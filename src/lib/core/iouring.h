@@ -0,0 +1,179 @@
+#ifndef TARANTOOL_LIB_CORE_IOURING_H_INCLUDED
+#define TARANTOOL_LIB_CORE_IOURING_H_INCLUDED
+/*
+ * Copyright 2010-2021, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "trivia/config.h"
+
+#if defined(__linux__) && defined(HAVE_LINUX_IO_URING_H)
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && \
+    defined(__NR_io_uring_register)
+/**
+ * Defined when io_uring can be used. The consumers are expected
+ * to provide a plain read()/write() fallback, both for other
+ * platforms and for kernels which predate io_uring: creating a
+ * ring may fail with ENOSYS at runtime even when this macro is
+ * defined.
+ */
+#define ENABLE_IOURING 1
+#endif
+#endif
+
+#if defined(ENABLE_IOURING)
+
+#include <linux/io_uring.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * A thin wrapper around the raw io_uring syscall interface,
+ * without a liburing dependency. Only what the network threads
+ * need is wrapped: readv/writev submissions batched into a
+ * single io_uring_enter() and completion reaping, with an
+ * optional eventfd to plug completions into a libev loop.
+ *
+ * Not thread safe, one ring per thread.
+ */
+struct iouring {
+	/** Ring file descriptor. */
+	int fd;
+	/** Submission queue ring mapping and its size. */
+	void *sq_ring;
+	size_t sq_ring_size;
+	/** Submission queue entry array mapping and its size. */
+	struct io_uring_sqe *sqes;
+	size_t sqes_size;
+	/** Completion queue ring mapping and its size. */
+	void *cq_ring;
+	size_t cq_ring_size;
+	/** Pointers into sq_ring, owned by the kernel ABI. */
+	unsigned *sq_head;
+	unsigned *sq_tail;
+	unsigned *sq_mask;
+	unsigned *sq_array;
+	unsigned sq_entries;
+	/** Pointers into cq_ring, owned by the kernel ABI. */
+	unsigned *cq_head;
+	unsigned *cq_tail;
+	unsigned *cq_mask;
+	struct io_uring_cqe *cqes;
+	/**
+	 * The local submission tail: entries in
+	 * [*sq_tail, sq_prepared) are filled in but not yet
+	 * published to the kernel.
+	 */
+	unsigned sq_prepared;
+};
+
+/**
+ * Create a ring with the given number of submission entries
+ * (rounded up to a power of two by the kernel). Returns 0 on
+ * success, -1 on error with the diagnostics set - including
+ * ENOSYS on kernels without io_uring.
+ */
+int
+iouring_create(struct iouring *ring, unsigned entries);
+
+/** Unmap and close the ring. */
+void
+iouring_destroy(struct iouring *ring);
+
+/**
+ * Tie an eventfd to the ring: the kernel signals it whenever a
+ * completion is posted, which lets a libev loop poll the eventfd
+ * instead of the ring. Returns 0 on success, -1 on error with
+ * the diagnostics set.
+ */
+int
+iouring_register_eventfd(struct iouring *ring, int eventfd);
+
+/**
+ * Stage a readv into the submission queue. Nothing reaches the
+ * kernel until iouring_submit(). The iovec array and the buffers
+ * must stay valid until the completion is reaped. @a user_data
+ * comes back in the completion verbatim. Returns 0 on success,
+ * -1 if the submission queue is full (no diagnostics).
+ */
+int
+iouring_prep_readv(struct iouring *ring, int fd, const struct iovec *iov,
+		   int iovcnt, uint64_t user_data);
+
+/** Stage a writev, @sa iouring_prep_readv(). */
+int
+iouring_prep_writev(struct iouring *ring, int fd, const struct iovec *iov,
+		    int iovcnt, uint64_t user_data);
+
+/**
+ * Stage a positional readv of a regular file,
+ * @sa iouring_prep_readv(). @a offset is the file offset, the
+ * file position is not used or changed.
+ */
+int
+iouring_prep_preadv(struct iouring *ring, int fd, const struct iovec *iov,
+		    int iovcnt, off_t offset, uint64_t user_data);
+
+/** Stage a positional writev, @sa iouring_prep_preadv(). */
+int
+iouring_prep_pwritev(struct iouring *ring, int fd, const struct iovec *iov,
+		     int iovcnt, off_t offset, uint64_t user_data);
+
+/**
+ * Publish all staged submissions to the kernel with a single
+ * io_uring_enter(). Returns the number of consumed entries, or
+ * -1 on error with the diagnostics set.
+ */
+int
+iouring_submit(struct iouring *ring);
+
+/**
+ * Return the oldest unreaped completion or NULL if there is
+ * none. The entry stays valid until iouring_cqe_seen().
+ */
+struct io_uring_cqe *
+iouring_peek_cqe(struct iouring *ring);
+
+/** Hand the oldest completion back to the kernel. */
+void
+iouring_cqe_seen(struct iouring *ring);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* defined(ENABLE_IOURING) */
+
+#endif /* TARANTOOL_LIB_CORE_IOURING_H_INCLUDED */
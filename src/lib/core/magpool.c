@@ -0,0 +1,220 @@
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "magpool.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+/** Allocate an empty magazine header. */
+static struct magpool_magazine *
+magpool_magazine_new(void)
+{
+	struct magpool_magazine *mag = malloc(sizeof(*mag));
+	if (mag == NULL)
+		return NULL;
+	mag->next = NULL;
+	mag->nobj = 0;
+	return mag;
+}
+
+/** Free a magazine header along with the objects it caches. */
+static void
+magpool_magazine_delete(struct magpool_magazine *mag)
+{
+	for (uint32_t i = 0; i < mag->nobj; i++)
+		free(mag->objs[i]);
+	free(mag);
+}
+
+void
+magpool_create(struct magpool *pool, size_t objsize)
+{
+	assert(objsize > 0);
+	pthread_mutex_init(&pool->mutex, NULL);
+	pool->objsize = objsize;
+	pool->depot = NULL;
+	pool->empty = NULL;
+	pool->depot_hits = 0;
+	pool->depot_misses = 0;
+}
+
+void
+magpool_destroy(struct magpool *pool)
+{
+	struct magpool_magazine *mag, *next;
+	for (mag = pool->depot; mag != NULL; mag = next) {
+		next = mag->next;
+		magpool_magazine_delete(mag);
+	}
+	for (mag = pool->empty; mag != NULL; mag = next) {
+		next = mag->next;
+		assert(mag->nobj == 0);
+		free(mag);
+	}
+	pool->depot = NULL;
+	pool->empty = NULL;
+	pthread_mutex_destroy(&pool->mutex);
+}
+
+int
+magpool_cache_create(struct magpool_cache *cache, struct magpool *pool)
+{
+	cache->pool = pool;
+	cache->loaded = magpool_magazine_new();
+	cache->prev = magpool_magazine_new();
+	if (cache->loaded == NULL || cache->prev == NULL) {
+		free(cache->loaded);
+		free(cache->prev);
+		cache->loaded = NULL;
+		cache->prev = NULL;
+		return -1;
+	}
+	return 0;
+}
+
+/** Hand a magazine over to the depot. */
+static void
+magpool_depot_put(struct magpool *pool, struct magpool_magazine *mag)
+{
+	if (mag->nobj == 0) {
+		mag->next = pool->empty;
+		pool->empty = mag;
+	} else {
+		mag->next = pool->depot;
+		pool->depot = mag;
+	}
+}
+
+void
+magpool_cache_destroy(struct magpool_cache *cache)
+{
+	struct magpool *pool = cache->pool;
+	pthread_mutex_lock(&pool->mutex);
+	magpool_depot_put(pool, cache->loaded);
+	magpool_depot_put(pool, cache->prev);
+	pthread_mutex_unlock(&pool->mutex);
+	cache->loaded = NULL;
+	cache->prev = NULL;
+}
+
+void *
+magpool_alloc(struct magpool_cache *cache)
+{
+	struct magpool_magazine *loaded = cache->loaded;
+	if (loaded->nobj > 0)
+		return loaded->objs[--loaded->nobj];
+	if (cache->prev->nobj > 0) {
+		cache->loaded = cache->prev;
+		cache->prev = loaded;
+		loaded = cache->loaded;
+		return loaded->objs[--loaded->nobj];
+	}
+	/*
+	 * Both magazines ran dry - try to swap the loaded one
+	 * for a stocked magazine from the depot.
+	 */
+	struct magpool *pool = cache->pool;
+	pthread_mutex_lock(&pool->mutex);
+	struct magpool_magazine *mag = pool->depot;
+	if (mag != NULL) {
+		pool->depot = mag->next;
+		pool->depot_hits++;
+		magpool_depot_put(pool, loaded);
+		pthread_mutex_unlock(&pool->mutex);
+		mag->next = NULL;
+		cache->loaded = mag;
+		return mag->objs[--mag->nobj];
+	}
+	pool->depot_misses++;
+	pthread_mutex_unlock(&pool->mutex);
+	/*
+	 * The depot is empty too - restock the loaded magazine
+	 * from the heap in one batch so the next allocations hit
+	 * the fast path again.
+	 */
+	while (loaded->nobj < MAGPOOL_MAGAZINE_SIZE) {
+		void *obj = malloc(pool->objsize);
+		if (obj == NULL)
+			break;
+		loaded->objs[loaded->nobj++] = obj;
+	}
+	if (loaded->nobj == 0)
+		return NULL;
+	return loaded->objs[--loaded->nobj];
+}
+
+void
+magpool_free(struct magpool_cache *cache, void *obj)
+{
+	struct magpool_magazine *loaded = cache->loaded;
+	if (loaded->nobj < MAGPOOL_MAGAZINE_SIZE) {
+		loaded->objs[loaded->nobj++] = obj;
+		return;
+	}
+	if (cache->prev->nobj < MAGPOOL_MAGAZINE_SIZE) {
+		cache->loaded = cache->prev;
+		cache->prev = loaded;
+		loaded = cache->loaded;
+		loaded->objs[loaded->nobj++] = obj;
+		return;
+	}
+	/*
+	 * Both magazines are full - get a fresh magazine first,
+	 * then flush the previous one to the depot and start
+	 * filling the fresh one.
+	 */
+	struct magpool *pool = cache->pool;
+	pthread_mutex_lock(&pool->mutex);
+	struct magpool_magazine *mag = pool->empty;
+	if (mag != NULL)
+		pool->empty = mag->next;
+	pthread_mutex_unlock(&pool->mutex);
+	if (mag == NULL)
+		mag = magpool_magazine_new();
+	if (mag == NULL) {
+		/*
+		 * No room to cache the object - objects are
+		 * plain heap allocations, so give it back to
+		 * the heap directly. The caches are unchanged.
+		 */
+		free(obj);
+		return;
+	}
+	struct magpool_magazine *full = cache->prev;
+	pthread_mutex_lock(&pool->mutex);
+	full->next = pool->depot;
+	pool->depot = full;
+	pthread_mutex_unlock(&pool->mutex);
+	mag->next = NULL;
+	cache->prev = cache->loaded;
+	cache->loaded = mag;
+	mag->objs[mag->nobj++] = obj;
+}
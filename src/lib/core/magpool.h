@@ -0,0 +1,153 @@
+#ifndef TARANTOOL_LIB_CORE_MAGPOOL_H_INCLUDED
+#define TARANTOOL_LIB_CORE_MAGPOOL_H_INCLUDED
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * Magazine-layer object pool.
+ *
+ * Unlike struct mempool, which is bound to the slab cache of one
+ * thread, a magpool lets any participating thread allocate and
+ * free fixed-size objects: an object may be freed on a different
+ * thread than the one which allocated it, without a message round
+ * trip to the owner.
+ *
+ * Each thread works through its own struct magpool_cache holding
+ * two magazines (fixed-size arrays of object pointers) and only
+ * touches the shared depot, under a mutex, when both magazines
+ * are empty on alloc or both are full on free - once per
+ * MAGPOOL_MAGAZINE_SIZE operations in the worst case, never on
+ * the fast path.
+ */
+
+enum {
+	/**
+	 * Objects moved between a thread cache and the depot in
+	 * one batch. Bounds the depot lock rate to one lock per
+	 * this many allocations or frees per thread.
+	 */
+	MAGPOOL_MAGAZINE_SIZE = 64,
+};
+
+/** A batch of cached free objects. */
+struct magpool_magazine {
+	/** Next magazine in a depot list. */
+	struct magpool_magazine *next;
+	/** Number of objects stored in objs. */
+	uint32_t nobj;
+	/** The cached objects. */
+	void *objs[MAGPOOL_MAGAZINE_SIZE];
+};
+
+/** The shared depot of a magazine pool. */
+struct magpool {
+	/** Protects the depot lists and counters. */
+	pthread_mutex_t mutex;
+	/** Size of one object in bytes. */
+	size_t objsize;
+	/** Magazines holding cached free objects. */
+	struct magpool_magazine *depot;
+	/** Recycled empty magazine headers. */
+	struct magpool_magazine *empty;
+	/** Times a thread cache got a magazine from the depot. */
+	uint64_t depot_hits;
+	/**
+	 * Times the depot was empty and objects were allocated
+	 * from the heap instead.
+	 */
+	uint64_t depot_misses;
+};
+
+/** A per-thread cache over a magpool depot. */
+struct magpool_cache {
+	/** The depot this cache works against. */
+	struct magpool *pool;
+	/** Magazine served by the fast path. */
+	struct magpool_magazine *loaded;
+	/** Previous magazine, swapped with loaded on demand. */
+	struct magpool_magazine *prev;
+};
+
+/** Create a pool of objects of @a objsize bytes. */
+void
+magpool_create(struct magpool *pool, size_t objsize);
+
+/**
+ * Destroy the pool and release all cached objects. All thread
+ * caches must have been destroyed and all allocated objects
+ * freed back before this call.
+ */
+void
+magpool_destroy(struct magpool *pool);
+
+/**
+ * Attach a thread cache to the pool. Must be called on the
+ * thread which will use the cache.
+ * @retval  0 on success.
+ * @retval -1 on memory allocation failure.
+ */
+int
+magpool_cache_create(struct magpool_cache *cache, struct magpool *pool);
+
+/**
+ * Detach a thread cache, returning its cached objects to the
+ * depot. Must be called on the owner thread.
+ */
+void
+magpool_cache_destroy(struct magpool_cache *cache);
+
+/**
+ * Allocate an object.
+ * @retval not NULL on success.
+ * @retval NULL on memory allocation failure.
+ */
+void *
+magpool_alloc(struct magpool_cache *cache);
+
+/**
+ * Free an object allocated from the same pool, possibly via a
+ * cache of another thread.
+ */
+void
+magpool_free(struct magpool_cache *cache, void *obj);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_LIB_CORE_MAGPOOL_H_INCLUDED */
@@ -0,0 +1,290 @@
+/*
+ * Copyright 2010-2021, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "mp_check_flat.h"
+
+#include <stdint.h>
+
+#include "msgpuck.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+enum {
+	/**
+	 * How deeply nested containers are still walked by the
+	 * fast checker. A typical request body is a map of keys
+	 * to tuples with at most one more level of nesting, so
+	 * anything deeper is handed over to mp_check(), which
+	 * tracks nesting without recursion.
+	 */
+	MP_CHECK_FLAT_DEPTH_MAX = 2,
+};
+
+static int
+mp_check_flat_slice(const char **data, const char *end, int depth)
+{
+	const char *pos = *data;
+	if (pos >= end)
+		return 1;
+	uint8_t c = (uint8_t) *pos;
+	uint64_t elems;
+	if (c >= 0x90 && c <= 0x9f) {
+		/* fixarray */
+		elems = c & 0xf;
+		pos += 1;
+	} else if (c >= 0x80 && c <= 0x8f) {
+		/* fixmap */
+		elems = 2 * (uint64_t) (c & 0xf);
+		pos += 1;
+	} else if (c == 0xdc || c == 0xde) {
+		/* array 16, map 16 */
+		if (end - pos < 3)
+			return 1;
+		elems = ((uint32_t) (uint8_t) pos[1] << 8) |
+			(uint8_t) pos[2];
+		if (c == 0xde)
+			elems *= 2;
+		pos += 3;
+	} else if (c == 0xdd || c == 0xdf) {
+		/* array 32, map 32 */
+		if (end - pos < 5)
+			return 1;
+		elems = ((uint32_t) (uint8_t) pos[1] << 24) |
+			((uint32_t) (uint8_t) pos[2] << 16) |
+			((uint32_t) (uint8_t) pos[3] << 8) |
+			(uint8_t) pos[4];
+		if (c == 0xdf)
+			elems *= 2;
+		pos += 5;
+	} else {
+		/* Not a container - bail out to the generic checker. */
+		return mp_check(data, end);
+	}
+	while (elems > 0) {
+#ifdef __SSE2__
+		/*
+		 * Positive fixints make up the bulk of real world
+		 * tuples. A 16 byte chunk with no high bit set is
+		 * 16 consecutive positive fixints, so classify
+		 * them all with a single movemask.
+		 */
+		if (elems >= 16 && end - pos >= 16) {
+			__m128i chunk =
+				_mm_loadu_si128((const __m128i *) pos);
+			if (_mm_movemask_epi8(chunk) == 0) {
+				pos += 16;
+				elems -= 16;
+				continue;
+			}
+		}
+#endif
+		if (pos >= end)
+			return 1;
+		c = (uint8_t) *pos;
+		uint64_t len;
+		if (c <= 0x7f || c >= 0xe0) {
+			/* Positive or negative fixint. */
+			len = 1;
+		} else if (c >= 0xa0 && c <= 0xbf) {
+			/* fixstr */
+			len = 1 + (c & 0x1f);
+		} else {
+			switch (c) {
+			case 0xc0: /* nil */
+			case 0xc2: /* false */
+			case 0xc3: /* true */
+				len = 1;
+				break;
+			case 0xcc: /* uint 8 */
+			case 0xd0: /* int 8 */
+				len = 2;
+				break;
+			case 0xcd: /* uint 16 */
+			case 0xd1: /* int 16 */
+				len = 3;
+				break;
+			case 0xca: /* float 32 */
+			case 0xce: /* uint 32 */
+			case 0xd2: /* int 32 */
+				len = 5;
+				break;
+			case 0xcb: /* float 64 */
+			case 0xcf: /* uint 64 */
+			case 0xd3: /* int 64 */
+				len = 9;
+				break;
+			case 0xc4: /* bin 8 */
+			case 0xd9: /* str 8 */
+				if (end - pos < 2)
+					return 1;
+				len = 2 + (uint64_t) (uint8_t) pos[1];
+				break;
+			case 0xc5: /* bin 16 */
+			case 0xda: /* str 16 */
+				if (end - pos < 3)
+					return 1;
+				len = 3 + (((uint64_t)
+					    (uint8_t) pos[1] << 8) |
+					   (uint8_t) pos[2]);
+				break;
+			default: {
+				/*
+				 * A nested container or a rare
+				 * type.
+				 */
+				const char *tmp = pos;
+				if (depth < MP_CHECK_FLAT_DEPTH_MAX &&
+				    ((c >= 0x80 && c <= 0x9f) ||
+				     (c >= 0xdc && c <= 0xdf))) {
+					if (mp_check_flat_slice(&tmp, end,
+								depth + 1))
+						return 1;
+				} else if (mp_check(&tmp, end) != 0) {
+					return 1;
+				}
+				pos = tmp;
+				len = 0;
+				break;
+			}
+			}
+		}
+		if (len > (uint64_t) (end - pos))
+			return 1;
+		pos += len;
+		elems -= 1;
+	}
+	*data = pos;
+	return 0;
+}
+
+int
+mp_check_flat(const char **data, const char *end)
+{
+	return mp_check_flat_slice(data, end, 0);
+}
+
+void
+mp_next_flat(const char **data, uint32_t count)
+{
+	const char *pos = *data;
+	uint64_t todo = count;
+	while (todo > 0) {
+#ifdef __SSE2__
+		/*
+		 * Every remaining object is at least one byte,
+		 * so with todo >= 16 the next 16 bytes are all
+		 * inside the data. A chunk with no high bit set
+		 * is 16 consecutive positive fixints.
+		 */
+		if (todo >= 16) {
+			__m128i chunk =
+				_mm_loadu_si128((const __m128i *) pos);
+			if (_mm_movemask_epi8(chunk) == 0) {
+				pos += 16;
+				todo -= 16;
+				continue;
+			}
+		}
+#endif
+		uint8_t c = (uint8_t) *pos;
+		if (c <= 0x7f || c >= 0xe0) {
+			/* Positive or negative fixint. */
+			pos += 1;
+		} else if (c >= 0xa0 && c <= 0xbf) {
+			/* fixstr */
+			pos += 1 + (c & 0x1f);
+		} else if (c >= 0x90 && c <= 0x9f) {
+			/* fixarray */
+			todo += c & 0xf;
+			pos += 1;
+		} else if (c >= 0x80 && c <= 0x8f) {
+			/* fixmap */
+			todo += 2 * (uint64_t) (c & 0xf);
+			pos += 1;
+		} else {
+			switch (c) {
+			case 0xc0: /* nil */
+			case 0xc2: /* false */
+			case 0xc3: /* true */
+				pos += 1;
+				break;
+			case 0xcc: /* uint 8 */
+			case 0xd0: /* int 8 */
+				pos += 2;
+				break;
+			case 0xcd: /* uint 16 */
+			case 0xd1: /* int 16 */
+				pos += 3;
+				break;
+			case 0xca: /* float 32 */
+			case 0xce: /* uint 32 */
+			case 0xd2: /* int 32 */
+				pos += 5;
+				break;
+			case 0xcb: /* float 64 */
+			case 0xcf: /* uint 64 */
+			case 0xd3: /* int 64 */
+				pos += 9;
+				break;
+			case 0xc4: /* bin 8 */
+			case 0xd9: /* str 8 */
+				pos += 2 + (uint64_t) (uint8_t) pos[1];
+				break;
+			case 0xc5: /* bin 16 */
+			case 0xda: /* str 16 */
+				pos += 3 + (((uint64_t)
+					     (uint8_t) pos[1] << 8) |
+					    (uint8_t) pos[2]);
+				break;
+			case 0xdc: /* array 16 */
+			case 0xde: /* map 16 */
+			{
+				uint64_t elems =
+					((uint32_t) (uint8_t) pos[1] << 8) |
+					(uint8_t) pos[2];
+				todo += c == 0xde ? 2 * elems : elems;
+				pos += 3;
+				break;
+			}
+			default:
+				/*
+				 * A rare type: ext, 32 bit
+				 * strings or containers.
+				 */
+				mp_next(&pos);
+				break;
+			}
+		}
+		todo -= 1;
+	}
+	*data = pos;
+}
@@ -0,0 +1,81 @@
+#ifndef TARANTOOL_LIB_CORE_MP_CHECK_FLAT_INCLUDED
+#define TARANTOOL_LIB_CORE_MP_CHECK_FLAT_INCLUDED
+/*
+ * Copyright 2010-2021, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * Check that a MessagePack object is well formed and advance
+ * \a data past it, like mp_check(). Optimized for the mostly
+ * flat maps and arrays of scalars which dominate the request
+ * decode path: runs of positive fixints are classified 16 bytes
+ * at a time with SSE2 and the remaining scalar types are
+ * skipped with a single length lookup. Deeply nested containers,
+ * non-container top level objects and rare types fall back to
+ * mp_check().
+ *
+ * Unlike mp_check(), it does not report how many bytes a
+ * truncated object is missing: both truncated and corrupt input
+ * simply make the return value non-zero.
+ *
+ * @param data Pointer to the object, advanced on success.
+ * @param end End of the buffer.
+ *
+ * @retval 0 The object is well formed.
+ * @retval != 0 The object is truncated or corrupt.
+ */
+int
+mp_check_flat(const char **data, const char *end);
+
+/**
+ * Skip \a count MessagePack objects, like calling mp_next()
+ * \a count times. Like mp_next(), it must only be used on
+ * trusted, well formed data - there is no bounds checking.
+ * Optimized the same way as mp_check_flat(): runs of positive
+ * fixints are classified 16 bytes at a time with SSE2 (safe
+ * because each of the remaining objects is at least one byte),
+ * common scalars are skipped with a single length computation,
+ * containers just add their element count to the counter, and
+ * rare types fall back to mp_next().
+ */
+void
+mp_next_flat(const char **data, uint32_t count);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_LIB_CORE_MP_CHECK_FLAT_INCLUDED */
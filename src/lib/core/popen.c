@@ -466,6 +466,157 @@ popen_read_timeout(struct popen_handle *handle, void *buf,
 					    timeout);
 }
 
+enum {
+	/** How many bytes one splice()/read() call may move. */
+	POPEN_COPY_CHUNK = 64 * 1024,
+};
+
+/**
+ * Copy a child's output to another file descriptor with timeout.
+ *
+ * Moves data from the child's stdout or stderr pipe straight to
+ * @a dst_fd until EOF, @a limit bytes (0 means no limit) or the
+ * timeout. On Linux the transfer goes through splice(), so the
+ * data never enters userspace; elsewhere, and for destinations
+ * splice() does not support, a read/write loop with a large
+ * buffer is used. Either way the fiber yields while an end is
+ * not ready, so the loop moves data at the speed of the slower
+ * side and the pipe provides the backpressure.
+ *
+ * Returns the number of copied bytes at success (zero means EOF
+ * right away), otherwise returns -1 and sets a diag.
+ *
+ * Possible errors:
+ *
+ * - IllegalParams: a parameter check fails:
+ *   - flags: stdout and stderr are both set or both missed.
+ *   - handle: handle does not support the requested IO operation.
+ *   - handle: attempt to operate on a closed fd.
+ * - SocketError: an IO error occurs at splice(), read() or
+ *   write().
+ * - TimedOut: @a timeout quota is exceeded.
+ * - FiberIsCancelled: cancelled by an outside code.
+ * - OutOfMemory: no memory space for the copy buffer.
+ */
+ssize_t
+popen_copy_to_fd(struct popen_handle *handle, int dst_fd, size_t limit,
+		 unsigned int flags, ev_tstamp timeout)
+{
+	assert(handle != NULL);
+
+	if (!(flags & (POPEN_FLAG_FD_STDOUT | POPEN_FLAG_FD_STDERR))) {
+		diag_set(IllegalParams,
+			 "popen: neither stdout nor stderr is set");
+		return -1;
+	}
+
+	if (flags & POPEN_FLAG_FD_STDOUT && flags & POPEN_FLAG_FD_STDERR) {
+		diag_set(IllegalParams, "popen: copying from both stdout and "
+			 "stderr at one call is not supported");
+		return -1;
+	}
+
+	int idx = flags & POPEN_FLAG_FD_STDOUT ?
+		STDOUT_FILENO : STDERR_FILENO;
+
+	if (popen_may_io(handle, idx, flags) != 0)
+		return -1;
+
+	int src_fd = handle->ios[idx].fd;
+
+	say_debug("popen: %d: copy idx [%s:%d] dst %d limit %zu "
+		  "timeout %.9g",
+		  handle->pid, stdX_str(idx), idx, dst_fd, limit, timeout);
+
+	ev_loop *loop = loop();
+	ev_tstamp start, delay;
+	evio_timeout_init(loop, &start, &delay, timeout);
+
+	char *buf = NULL;
+	size_t total = 0;
+#ifdef TARGET_OS_LINUX
+	bool use_splice = true;
+#else
+	bool use_splice = false;
+#endif
+	while (limit == 0 || total < limit) {
+		size_t chunk = POPEN_COPY_CHUNK;
+		if (limit != 0 && limit - total < chunk)
+			chunk = limit - total;
+		ssize_t rc;
+#ifdef TARGET_OS_LINUX
+		if (use_splice) {
+			rc = splice(src_fd, NULL, dst_fd, NULL, chunk,
+				    SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+			if (rc < 0 && errno == EINVAL) {
+				/*
+				 * The destination does not
+				 * support splice(), fall back to
+				 * the read/write loop.
+				 */
+				use_splice = false;
+				continue;
+			}
+		} else
+#endif
+		{
+			if (buf == NULL) {
+				buf = malloc(POPEN_COPY_CHUNK);
+				if (buf == NULL) {
+					diag_set(OutOfMemory,
+						 POPEN_COPY_CHUNK, "malloc",
+						 "popen copy buffer");
+					return -1;
+				}
+			}
+			rc = read(src_fd, buf, chunk);
+			if (rc > 0 &&
+			    coio_write_fd_timeout(dst_fd, buf, rc,
+						  delay) != 0) {
+				free(buf);
+				return -1;
+			}
+		}
+		if (rc > 0) {
+			total += rc;
+			evio_timeout_update(loop, &start, &delay);
+			continue;
+		}
+		if (rc == 0)
+			break;
+		if (errno == EINTR)
+			continue;
+		if (errno != EAGAIN && errno != EWOULDBLOCK) {
+			diag_set(SocketError, sio_socketname(src_fd),
+				 use_splice ? "splice" : "read");
+			free(buf);
+			return -1;
+		}
+		if (delay <= 0) {
+			diag_set(TimedOut);
+			free(buf);
+			return -1;
+		}
+		/*
+		 * Either the pipe is empty or the destination is
+		 * full: probe the source without waiting to learn
+		 * which end to wait for.
+		 */
+		if (coio_wait(src_fd, COIO_READ, 0) == 0)
+			coio_wait(src_fd, COIO_READ, delay);
+		else
+			coio_wait(dst_fd, COIO_WRITE, delay);
+		if (fiber_is_cancelled()) {
+			diag_set(FiberIsCancelled);
+			free(buf);
+			return -1;
+		}
+		evio_timeout_update(loop, &start, &delay);
+	}
+	free(buf);
+	return total;
+}
+
 /**
  * Close parent's ends of std* fds.
  *
@@ -853,6 +1004,18 @@ popen_delete(struct popen_handle *handle)
 	return rc;
 }
 
+enum {
+	/**
+	 * Preferred in-kernel pipe buffer capacity. The pipe is
+	 * the queue between the child and the parent: the deeper
+	 * it is, the fewer read wakeups a bulk transfer takes and
+	 * the longer a burst the child can write through without
+	 * blocking. Backpressure is kept: once the buffer is
+	 * full, the child blocks as usual.
+	 */
+	POPEN_PIPE_SIZE = 256 * 1024,
+};
+
 /**
  * Create O_CLOEXEC pipes.
  */
@@ -864,6 +1027,17 @@ make_pipe(int pfd[2])
 		diag_set(SystemError, "Can't create pipe2");
 		return -1;
 	}
+	/*
+	 * Try to enlarge the pipe buffer. Best effort: the
+	 * default size is kept when the fcntl is not permitted
+	 * (exceeds /proc/sys/fs/pipe-max-size for an unprivileged
+	 * caller) or not supported.
+	 */
+#ifdef F_SETPIPE_SZ
+	if (fcntl(pfd[1], F_SETPIPE_SZ, POPEN_PIPE_SIZE) < 0)
+		say_debug("popen: failed to set pipe size %d: %s",
+			  POPEN_PIPE_SIZE, strerror(errno));
+#endif
 #else
 	if (pipe(pfd)) {
 		diag_set(SystemError, "Can't create pipe");
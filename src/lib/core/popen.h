@@ -177,6 +177,10 @@ popen_read_timeout(struct popen_handle *handle, void *buf,
 		   size_t count, unsigned int flags,
 		   ev_tstamp timeout);
 
+extern ssize_t
+popen_copy_to_fd(struct popen_handle *handle, int dst_fd, size_t limit,
+		 unsigned int flags, ev_tstamp timeout);
+
 extern int
 popen_shutdown(struct popen_handle *handle, unsigned int flags);
 
@@ -0,0 +1,67 @@
+#ifndef TARANTOOL_LIB_CORE_PROBES_H_INCLUDED
+#define TARANTOOL_LIB_CORE_PROBES_H_INCLUDED
+/*
+ * Copyright 2010-2021, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "trivia/config.h"
+
+/**
+ * USDT static tracepoints.
+ *
+ * When systemtap's sys/sdt.h is available at configure time each
+ * TNT_PROBE*() expands to a DTRACE_PROBE*() under the common
+ * "tarantool" provider. A disarmed probe is a single nop plus an
+ * ELF note describing the argument locations, so the probes are
+ * compiled in unconditionally and cost nothing until a tracer
+ * (bpftrace, perf, systemtap) arms them. Without sys/sdt.h the
+ * macros expand to nothing.
+ *
+ * Probe names are part of the external tracing interface: once
+ * shipped, keep the name and argument list stable.
+ */
+#if defined(HAVE_SYS_SDT_H)
+
+#include <sys/sdt.h>
+
+#define TNT_PROBE(name) DTRACE_PROBE(tarantool, name)
+#define TNT_PROBE1(name, a1) DTRACE_PROBE1(tarantool, name, a1)
+#define TNT_PROBE2(name, a1, a2) DTRACE_PROBE2(tarantool, name, a1, a2)
+#define TNT_PROBE3(name, a1, a2, a3) DTRACE_PROBE3(tarantool, name, a1, a2, a3)
+
+#else /* !defined(HAVE_SYS_SDT_H) */
+
+#define TNT_PROBE(name)
+#define TNT_PROBE1(name, a1) ((void)(a1))
+#define TNT_PROBE2(name, a1, a2) ((void)(a1), (void)(a2))
+#define TNT_PROBE3(name, a1, a2, a3) ((void)(a1), (void)(a2), (void)(a3))
+
+#endif /* defined(HAVE_SYS_SDT_H) */
+
+#endif /* TARANTOOL_LIB_CORE_PROBES_H_INCLUDED */
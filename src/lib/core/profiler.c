@@ -0,0 +1,178 @@
+/*
+ * Copyright 2010-2021, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "profiler.h"
+
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <ucontext.h>
+
+#include "diag.h"
+#include "fiber.h"
+
+/**
+ * Ring capacity, a power of two. At the default low sampling
+ * frequency the window covers the last couple of minutes of CPU
+ * time of a busy thread.
+ */
+enum { PROFILER_SAMPLES = 8192 };
+
+struct profiler_sample {
+	/** Interrupted instruction pointer, NULL if unknown. */
+	void *ip;
+	/** Id of the fiber that was running, 0 if none. */
+	uint64_t fid;
+};
+
+static __thread struct profiler_sample *profiler_ring = NULL;
+static __thread uint64_t profiler_pos = 0;
+
+/** Sampling frequency, > 0 while the timer is armed. */
+static double profiler_freq = 0;
+
+/**
+ * The SIGPROF handler. Runs in whichever thread consumed the CPU
+ * time; must stay async-signal-safe: no allocation, no locks, no
+ * unwinding. Threads that never called profiler_thread_init()
+ * are not sampled.
+ */
+static void
+profiler_signal_cb(int signo, siginfo_t *info, void *context)
+{
+	(void)signo;
+	(void)info;
+	struct profiler_sample *ring = profiler_ring;
+	if (ring == NULL)
+		return;
+	void *ip = NULL;
+#if defined(__linux__) && defined(__x86_64__)
+	ip = (void *)((ucontext_t *)context)->uc_mcontext.gregs[REG_RIP];
+#elif defined(__linux__) && defined(__aarch64__)
+	ip = (void *)((ucontext_t *)context)->uc_mcontext.pc;
+#else
+	(void)context;
+#endif
+	struct profiler_sample *sample =
+		&ring[profiler_pos++ & (PROFILER_SAMPLES - 1)];
+	sample->ip = ip;
+	sample->fid = cord() != NULL && cord()->fiber != NULL ?
+		      cord()->fiber->fid : 0;
+}
+
+int
+profiler_start(double freq)
+{
+	assert(freq > 0);
+	struct sigaction sa;
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_sigaction = profiler_signal_cb;
+	sa.sa_flags = SA_RESTART | SA_SIGINFO;
+	sigemptyset(&sa.sa_mask);
+	if (sigaction(SIGPROF, &sa, NULL) != 0) {
+		diag_set(SystemError, "failed to install SIGPROF handler");
+		return -1;
+	}
+	struct itimerval timer;
+	timer.it_interval.tv_sec = 0;
+	timer.it_interval.tv_usec = (suseconds_t)(1000000 / freq);
+	if (timer.it_interval.tv_usec == 0)
+		timer.it_interval.tv_usec = 1;
+	timer.it_value = timer.it_interval;
+	if (setitimer(ITIMER_PROF, &timer, NULL) != 0) {
+		diag_set(SystemError, "failed to arm the profiling timer");
+		return -1;
+	}
+	profiler_freq = freq;
+	return 0;
+}
+
+void
+profiler_stop(void)
+{
+	if (profiler_freq == 0)
+		return;
+	struct itimerval timer;
+	memset(&timer, 0, sizeof(timer));
+	setitimer(ITIMER_PROF, &timer, NULL);
+	profiler_freq = 0;
+}
+
+bool
+profiler_is_enabled(void)
+{
+	return profiler_freq > 0;
+}
+
+void
+profiler_thread_init(void)
+{
+	if (profiler_ring != NULL)
+		return;
+	/*
+	 * A failure only means this thread goes unsampled; the
+	 * pages stay untouched until sampling actually begins.
+	 */
+	profiler_ring = calloc(PROFILER_SAMPLES, sizeof(*profiler_ring));
+	profiler_pos = 0;
+}
+
+void
+profiler_thread_free(void)
+{
+	free(profiler_ring);
+	profiler_ring = NULL;
+}
+
+int
+profiler_foreach(profiler_sample_cb cb, void *cb_ctx)
+{
+	struct profiler_sample *ring = profiler_ring;
+	if (ring == NULL)
+		return 0;
+	uint64_t pos = profiler_pos;
+	for (uint64_t i = 0; i < PROFILER_SAMPLES; i++) {
+		struct profiler_sample *sample =
+			&ring[(pos + i) & (PROFILER_SAMPLES - 1)];
+		if (sample->ip == NULL && sample->fid == 0)
+			continue;
+		int rc = cb(sample->fid, sample->ip, cb_ctx);
+		if (rc != 0)
+			return rc;
+	}
+	return 0;
+}
+
+uint64_t
+profiler_sample_count(void)
+{
+	return profiler_pos;
+}
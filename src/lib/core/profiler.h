@@ -0,0 +1,101 @@
+#ifndef TARANTOOL_LIB_CORE_PROFILER_H_INCLUDED
+#define TARANTOOL_LIB_CORE_PROFILER_H_INCLUDED
+/*
+ * Copyright 2010-2021, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * Cheap sampling CPU profiler.
+ *
+ * A profiling timer (setitimer(ITIMER_PROF)) delivers SIGPROF to
+ * whichever thread is consuming CPU. The handler appends the
+ * interrupted instruction pointer and the id of the currently
+ * running fiber to a per-thread ring, so each thread keeps a
+ * rolling window of its most recent samples. The handler does no
+ * allocation, locking or unwinding - a sample is two stores -
+ * which keeps the profiler cheap enough to leave running. Symbol
+ * resolution is deferred to the reader, see box.stat.profiler().
+ */
+
+/**
+ * Arm the profiling timer at the given sampling frequency, in
+ * samples per second of consumed CPU time. Restarting with a
+ * different frequency just rearms the timer.
+ *
+ * @retval  0 Success.
+ * @retval -1 System error, diagnostics area is set.
+ */
+int
+profiler_start(double freq);
+
+/** Disarm the profiling timer. Collected samples are kept. */
+void
+profiler_stop(void);
+
+/** True if the profiling timer is armed. */
+bool
+profiler_is_enabled(void);
+
+/**
+ * Allocate the sample ring of the calling thread. Called once
+ * per cord at startup; threads without a ring are not sampled.
+ */
+void
+profiler_thread_init(void);
+
+/** Free the sample ring of the calling thread. */
+void
+profiler_thread_free(void);
+
+typedef int (*profiler_sample_cb)(uint64_t fid, void *ip, void *cb_ctx);
+
+/**
+ * Iterate over the rolling sample window of the calling thread,
+ * oldest sample first. Stops and returns the callback's result
+ * if it is non-zero.
+ */
+int
+profiler_foreach(profiler_sample_cb cb, void *cb_ctx);
+
+/** Total samples taken in the calling thread since start. */
+uint64_t
+profiler_sample_count(void);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_LIB_CORE_PROFILER_H_INCLUDED */
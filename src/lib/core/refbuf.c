@@ -0,0 +1,66 @@
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "refbuf.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pmatomic.h>
+
+struct refbuf *
+refbuf_new(const char *data, size_t size)
+{
+	struct refbuf *buf = malloc(sizeof(*buf) + size);
+	if (buf == NULL)
+		return NULL;
+	buf->refs = 1;
+	buf->size = size;
+	if (data != NULL)
+		memcpy(buf->data, data, size);
+	return buf;
+}
+
+void
+refbuf_ref(struct refbuf *buf)
+{
+	uint32_t old = pm_atomic_fetch_add(&buf->refs, 1);
+	assert(old > 0);
+	(void)old;
+}
+
+void
+refbuf_unref(struct refbuf *buf)
+{
+	uint32_t old = pm_atomic_fetch_sub(&buf->refs, 1);
+	assert(old > 0);
+	if (old == 1)
+		free(buf);
+}
@@ -0,0 +1,90 @@
+#ifndef TARANTOOL_LIB_CORE_REFBUF_H_INCLUDED
+#define TARANTOOL_LIB_CORE_REFBUF_H_INCLUDED
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * Reference-counted immutable payload buffer.
+ *
+ * A refbuf holds one payload that many consumers reference
+ * instead of each holding a copy - e.g. an identical reply
+ * fanned out to thousands of connections, where every
+ * connection's iovec chain points at the same bytes and drops
+ * its reference once the bytes hit the socket.
+ *
+ * The counter is atomic: the owner thread may hand references to
+ * worker threads and each side releases on its own schedule. The
+ * payload itself is immutable after creation, so no other
+ * synchronization is needed.
+ */
+struct refbuf {
+	/** Reference counter, the buffer is freed at zero. */
+	uint32_t refs;
+	/** Payload size in bytes. */
+	size_t size;
+	/** The payload, immutable after creation. */
+	char data[];
+};
+
+/**
+ * Allocate a buffer holding a copy of @a data (@a size bytes)
+ * with one reference owned by the caller. @a data may be NULL to
+ * get an uninitialized payload the caller fills before sharing
+ * the buffer.
+ * @retval the buffer, or NULL on memory allocation error.
+ */
+struct refbuf *
+refbuf_new(const char *data, size_t size);
+
+/**
+ * Take one more reference.
+ */
+void
+refbuf_ref(struct refbuf *buf);
+
+/**
+ * Drop a reference, freeing the buffer when the last one is
+ * gone. Safe to call from a thread other than the creator's.
+ */
+void
+refbuf_unref(struct refbuf *buf);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_LIB_CORE_REFBUF_H_INCLUDED */
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "ringbuf.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+/**
+ * Create an anonymous memory file the buffer pages live in; both
+ * mappings are views of this file.
+ */
+static int
+ringbuf_memfd(size_t size)
+{
+	int fd = -1;
+#if defined(__linux__) && defined(SYS_memfd_create)
+	fd = syscall(SYS_memfd_create, "ringbuf", 0);
+#endif
+	if (fd < 0) {
+		/* POSIX fallback: an unlinked shared memory file. */
+		char name[64];
+		snprintf(name, sizeof(name), "/tt_ringbuf.%d.%p",
+			 (int)getpid(), (void *)&name);
+		fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+		if (fd < 0)
+			return -1;
+		shm_unlink(name);
+	}
+	if (ftruncate(fd, size) != 0) {
+		int save_errno = errno;
+		close(fd);
+		errno = save_errno;
+		return -1;
+	}
+	return fd;
+}
+
+int
+ringbuf_create(struct ringbuf *rb, size_t capacity)
+{
+	size_t page = sysconf(_SC_PAGESIZE);
+	size_t size = page;
+	while (size < capacity)
+		size *= 2;
+	int fd = ringbuf_memfd(size);
+	if (fd < 0)
+		return -1;
+	/*
+	 * Reserve one span of twice the capacity, then map the
+	 * memory file over both halves, so that offset i and
+	 * offset i + capacity address the same page.
+	 */
+	char *base = mmap(NULL, 2 * size, PROT_NONE,
+			  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (base == MAP_FAILED)
+		goto fail;
+	if (mmap(base, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+		 fd, 0) == MAP_FAILED ||
+	    mmap(base + size, size, PROT_READ | PROT_WRITE,
+		 MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+		int save_errno = errno;
+		munmap(base, 2 * size);
+		errno = save_errno;
+		goto fail;
+	}
+	close(fd);
+	rb->buf = base;
+	rb->capacity = size;
+	rb->rpos = 0;
+	rb->wpos = 0;
+	return 0;
+fail:
+	{
+		int save_errno = errno;
+		close(fd);
+		errno = save_errno;
+	}
+	return -1;
+}
+
+void
+ringbuf_destroy(struct ringbuf *rb)
+{
+	munmap(rb->buf, 2 * rb->capacity);
+	rb->buf = NULL;
+	rb->capacity = 0;
+	rb->rpos = 0;
+	rb->wpos = 0;
+}
@@ -0,0 +1,143 @@
+#ifndef TARANTOOL_LIB_CORE_RINGBUF_H_INCLUDED
+#define TARANTOOL_LIB_CORE_RINGBUF_H_INCLUDED
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <assert.h>
+#include <stddef.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * Mirrored-page ring buffer.
+ *
+ * The buffer memory is mapped twice back-to-back, so the bytes
+ * between the read and the write position are always visible as
+ * one contiguous range even when they wrap around the capacity
+ * boundary, and so is the free space. A reader parsing a
+ * partially received request never needs the unparsed tail
+ * compacted to the buffer start the way struct ibuf does it -
+ * data is written and consumed with zero copying.
+ *
+ * The price is a fixed, page-granular capacity: the mapping
+ * cannot be grown in place. Capacity is rounded up to a power of
+ * two of pages on creation.
+ */
+struct ringbuf {
+	/** Base of the first of the two adjacent mappings. */
+	char *buf;
+	/** Capacity in bytes, a power of two of pages. */
+	size_t capacity;
+	/**
+	 * Read and write offsets. Only the offsets move, the
+	 * mapping makes wrapping invisible; wpos - rpos is the
+	 * used byte count and never exceeds the capacity.
+	 */
+	size_t rpos;
+	size_t wpos;
+};
+
+/**
+ * Create a ring buffer of at least @a capacity bytes.
+ * @retval  0 on success.
+ * @retval -1 on failure, errno is set (mapping or memory fd
+ *            creation failed).
+ */
+int
+ringbuf_create(struct ringbuf *rb, size_t capacity);
+
+/**
+ * Unmap the buffer memory.
+ */
+void
+ringbuf_destroy(struct ringbuf *rb);
+
+/** Bytes written and not yet consumed. */
+static inline size_t
+ringbuf_used(const struct ringbuf *rb)
+{
+	return rb->wpos - rb->rpos;
+}
+
+/** Bytes that can be written before the buffer is full. */
+static inline size_t
+ringbuf_unused(const struct ringbuf *rb)
+{
+	return rb->capacity - ringbuf_used(rb);
+}
+
+/**
+ * All used bytes, contiguous thanks to the double mapping.
+ */
+static inline char *
+ringbuf_rpos(const struct ringbuf *rb)
+{
+	return rb->buf + (rb->rpos & (rb->capacity - 1));
+}
+
+/**
+ * Write position: ringbuf_unused() contiguous writable bytes.
+ */
+static inline char *
+ringbuf_wpos(const struct ringbuf *rb)
+{
+	return rb->buf + (rb->wpos & (rb->capacity - 1));
+}
+
+/** Account @a size bytes written at ringbuf_wpos(). */
+static inline void
+ringbuf_produce(struct ringbuf *rb, size_t size)
+{
+	assert(size <= ringbuf_unused(rb));
+	rb->wpos += size;
+}
+
+/** Discard @a size consumed bytes at ringbuf_rpos(). */
+static inline void
+ringbuf_consume(struct ringbuf *rb, size_t size)
+{
+	assert(size <= ringbuf_used(rb));
+	rb->rpos += size;
+}
+
+/** Discard everything. */
+static inline void
+ringbuf_reset(struct ringbuf *rb)
+{
+	rb->rpos = rb->wpos = 0;
+}
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_LIB_CORE_RINGBUF_H_INCLUDED */
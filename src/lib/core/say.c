@@ -32,6 +32,9 @@
 #include "fiber.h"
 #include "errinj.h"
 #include "tt_static.h"
+#include "tt_pthread.h"
+
+#include <pmatomic.h>
 
 #include <errno.h>
 #include <stdarg.h>
@@ -46,6 +49,7 @@
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <arpa/inet.h>
+#include <time.h>
 #include <coio_task.h>
 
 pid_t log_pid = 0;
@@ -750,6 +754,8 @@ fail:
 void
 say_logger_free(void)
 {
+	/* Stop the writer thread and drain the rings, if any. */
+	say_set_async(false);
 	if (say_logger_initialized())
 		log_destroy(&log_std);
 }
@@ -1006,6 +1012,283 @@ safe_write(int fd, const char *buf, int size)
 	return write(fd, buf, MIN(size, SAY_BUF_LEN_MAX - 1));
 }
 
+/** {{{ Asynchronous logging */
+
+enum {
+	/** Per-thread ring capacity in bytes, a power of two. */
+	SAY_ASYNC_RING_SIZE = 256 * 1024,
+	/** Backstop flush period of the writer thread, in msec. */
+	SAY_ASYNC_FLUSH_PERIOD = 100,
+};
+
+/**
+ * A single-producer single-consumer byte ring of length-prefixed
+ * preformatted records. The owning thread appends without locks,
+ * the writer thread drains. A record which does not fit is
+ * dropped and counted; the writer reports the count once the
+ * ring has space again.
+ */
+struct say_async_ring {
+	/** Producer position in bytes, grows forever. */
+	uint64_t tail;
+	/** Consumer position in bytes, grows forever. */
+	uint64_t head;
+	/** Records dropped on overflow since the last report. */
+	uint64_t dropped;
+	/** Set on the owner thread exit, the writer frees. */
+	int is_dead;
+	/** Link in say_async.rings. */
+	struct rlist in_rings;
+	char data[SAY_ASYNC_RING_SIZE];
+};
+
+static struct {
+	/** Whether the default logger writes asynchronously. */
+	int is_enabled;
+	/**
+	 * Whether the registry below was set up. It is created
+	 * on the first enable and is never destroyed: a producer
+	 * racing with a disable may still be appending to its
+	 * ring, so the rings must stay valid; leftovers are
+	 * drained on the next enable or say_flush().
+	 */
+	bool is_initialized;
+	/**
+	 * Set while the writer thread may be sleeping: tells the
+	 * producers an empty -> non-empty transition needs a
+	 * signal. The producers do not take the mutex otherwise.
+	 */
+	int is_sleeping;
+	/** All registered rings. Everything below is protected
+	 * by the mutex; the hot producer path touches none of it.
+	 */
+	struct rlist rings;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	pthread_t writer;
+	pthread_key_t ring_key;
+} say_async;
+
+/** Copy @a size bytes into the ring at byte position @a pos. */
+static void
+say_async_ring_copy_in(struct say_async_ring *ring, uint64_t pos,
+		       const void *src, uint32_t size)
+{
+	uint32_t off = pos & (SAY_ASYNC_RING_SIZE - 1);
+	uint32_t part = MIN(size, SAY_ASYNC_RING_SIZE - off);
+	memcpy(ring->data + off, src, part);
+	memcpy(ring->data, (const char *)src + part, size - part);
+}
+
+/** Copy @a size bytes out of the ring at byte position @a pos. */
+static void
+say_async_ring_copy_out(struct say_async_ring *ring, uint64_t pos,
+			void *dst, uint32_t size)
+{
+	uint32_t off = pos & (SAY_ASYNC_RING_SIZE - 1);
+	uint32_t part = MIN(size, SAY_ASYNC_RING_SIZE - off);
+	memcpy(dst, ring->data + off, part);
+	memcpy((char *)dst + part, ring->data, size - part);
+}
+
+/** Mark the exited thread's ring for reclamation by the writer. */
+static void
+say_async_ring_detach(void *arg)
+{
+	struct say_async_ring *ring = arg;
+	pm_atomic_store(&ring->is_dead, 1);
+}
+
+/** Register a ring for the calling thread. */
+static struct say_async_ring *
+say_async_ring_new(void)
+{
+	struct say_async_ring *ring = malloc(sizeof(*ring));
+	if (ring == NULL)
+		return NULL;
+	ring->tail = 0;
+	ring->head = 0;
+	ring->dropped = 0;
+	ring->is_dead = 0;
+	tt_pthread_mutex_lock(&say_async.mutex);
+	rlist_add_tail(&say_async.rings, &ring->in_rings);
+	tt_pthread_mutex_unlock(&say_async.mutex);
+	tt_pthread_setspecific(say_async.ring_key, ring);
+	return ring;
+}
+
+/**
+ * Write the oldest pending record of the ring to the default
+ * logger. Must be called under say_async.mutex - it is the only
+ * consumer-side exclusion. Returns false if the ring is empty.
+ */
+static bool
+say_async_ring_pop(struct say_async_ring *ring)
+{
+	static char record[SAY_BUF_LEN_MAX];
+	uint64_t tail = pm_atomic_load(&ring->tail);
+	uint64_t head = ring->head;
+	if (head == tail)
+		return false;
+	uint32_t len;
+	say_async_ring_copy_out(ring, head, &len, sizeof(len));
+	say_async_ring_copy_out(ring, head + sizeof(len), record, len);
+	pm_atomic_store(&ring->head, head + sizeof(len) + len);
+	ssize_t r = safe_write(log_default->fd, record, len);
+	(void) r;                               /* silence gcc warning */
+	return true;
+}
+
+/**
+ * Drain all rings. Must be called under say_async.mutex.
+ * Returns true if at least one record was written.
+ */
+static bool
+say_async_drain(void)
+{
+	bool did_work = false;
+	struct say_async_ring *ring, *next;
+	rlist_foreach_entry_safe(ring, next, &say_async.rings, in_rings) {
+		while (say_async_ring_pop(ring))
+			did_work = true;
+		uint64_t dropped = pm_atomic_load(&ring->dropped);
+		if (dropped > 0) {
+			pm_atomic_fetch_sub(&ring->dropped, dropped);
+			char notice[128];
+			int total = snprintf(notice, sizeof(notice),
+					     "say: %llu log messages dropped "
+					     "on ring overflow\n",
+					     (unsigned long long)dropped);
+			ssize_t r = safe_write(log_default->fd, notice, total);
+			(void) r;               /* silence gcc warning */
+			did_work = true;
+		}
+		if (pm_atomic_load(&ring->is_dead) &&
+		    ring->head == pm_atomic_load(&ring->tail)) {
+			rlist_del_entry(ring, in_rings);
+			free(ring);
+		}
+	}
+	return did_work;
+}
+
+static void *
+say_async_writer_f(void *arg)
+{
+	(void) arg;
+	tt_pthread_mutex_lock(&say_async.mutex);
+	while (pm_atomic_load(&say_async.is_enabled)) {
+		if (say_async_drain())
+			continue;
+		struct timespec timeout;
+		clock_gettime(CLOCK_REALTIME, &timeout);
+		timeout.tv_nsec += SAY_ASYNC_FLUSH_PERIOD * 1000000;
+		if (timeout.tv_nsec >= 1000000000) {
+			timeout.tv_nsec -= 1000000000;
+			timeout.tv_sec++;
+		}
+		pm_atomic_store(&say_async.is_sleeping, 1);
+		tt_pthread_cond_timedwait(&say_async.cond, &say_async.mutex,
+					  &timeout);
+		pm_atomic_store(&say_async.is_sleeping, 0);
+	}
+	/* Leave nothing behind on shutdown. */
+	say_async_drain();
+	tt_pthread_mutex_unlock(&say_async.mutex);
+	return NULL;
+}
+
+/**
+ * Append a preformatted record to the calling thread's ring.
+ * Returns false if the record must be written synchronously:
+ * the asynchronous mode is off or the ring can not be set up.
+ * An overflowed ring drops the record and counts it - blocking
+ * the producer would defeat the purpose of the mode.
+ */
+static bool
+say_async_append(struct log *log, const char *record, int len)
+{
+	if (!pm_atomic_load(&say_async.is_enabled))
+		return false;
+	/* Non-default loggers are rare and stay synchronous. */
+	if (log != log_default)
+		return false;
+	struct say_async_ring *ring =
+		tt_pthread_getspecific(say_async.ring_key);
+	if (ring == NULL && (ring = say_async_ring_new()) == NULL)
+		return false;
+	len = MIN(len, SAY_BUF_LEN_MAX - 1);
+	uint64_t head = pm_atomic_load(&ring->head);
+	uint64_t tail = ring->tail;
+	uint32_t len32 = len;
+	uint32_t need = sizeof(len32) + len32;
+	if (SAY_ASYNC_RING_SIZE - (tail - head) < need) {
+		pm_atomic_fetch_add(&ring->dropped, 1);
+		return true;
+	}
+	say_async_ring_copy_in(ring, tail, &len32, sizeof(len32));
+	say_async_ring_copy_in(ring, tail + sizeof(len32), record, len32);
+	pm_atomic_store(&ring->tail, tail + need);
+	if (pm_atomic_load(&say_async.is_sleeping)) {
+		tt_pthread_mutex_lock(&say_async.mutex);
+		tt_pthread_cond_signal(&say_async.cond);
+		tt_pthread_mutex_unlock(&say_async.mutex);
+	}
+	return true;
+}
+
+void
+say_flush(void)
+{
+	if (!pm_atomic_load(&say_async.is_enabled))
+		return;
+	/*
+	 * Drain in the calling thread instead of waiting for the
+	 * writer: the caller may be about to abort. The mutex
+	 * makes the consumer side exclusive.
+	 */
+	tt_pthread_mutex_lock(&say_async.mutex);
+	say_async_drain();
+	tt_pthread_mutex_unlock(&say_async.mutex);
+}
+
+void
+say_set_async(bool async)
+{
+	if (async == (pm_atomic_load(&say_async.is_enabled) != 0))
+		return;
+	if (async) {
+		if (!say_async.is_initialized) {
+			rlist_create(&say_async.rings);
+			tt_pthread_mutex_init(&say_async.mutex, NULL);
+			tt_pthread_cond_init(&say_async.cond, NULL);
+			tt_pthread_key_create(&say_async.ring_key,
+					      say_async_ring_detach);
+			say_async.is_initialized = true;
+		}
+		pm_atomic_store(&say_async.is_enabled, 1);
+		if (tt_pthread_create(&say_async.writer, NULL,
+				      say_async_writer_f, NULL) != 0) {
+			pm_atomic_store(&say_async.is_enabled, 0);
+			return;
+		}
+	} else {
+		/*
+		 * Producers turn synchronous right away; the writer
+		 * drains everything already appended before exiting.
+		 * The rings and the registry are kept, see the comment
+		 * next to is_initialized.
+		 */
+		pm_atomic_store(&say_async.is_enabled, 0);
+		tt_pthread_mutex_lock(&say_async.mutex);
+		tt_pthread_cond_signal(&say_async.cond);
+		tt_pthread_mutex_unlock(&say_async.mutex);
+		tt_pthread_join(say_async.writer, NULL);
+	}
+}
+
+/** Asynchronous logging }}} */
+
 static void
 say_default(int level, const char *filename, int line, const char *error,
 	    const char *format, ...)
@@ -1028,12 +1311,21 @@ say_default(int level, const char *filename, int line, const char *error,
  * File and pipe logger
  */
 static void
-write_to_file(struct log *log, int total)
+write_to_file(struct log *log, int total, int level)
 {
 	assert(log->type == SAY_LOGGER_FILE ||
 	       log->type == SAY_LOGGER_PIPE ||
 	       log->type == SAY_LOGGER_STDERR);
 	assert(total >= 0);
+	/*
+	 * A fatal record is never queued - the process is about to
+	 * exit and would not live to see the ring drained. Flush
+	 * whatever is pending first to keep the log in order.
+	 */
+	if (level != S_FATAL && say_async_append(log, buf, total))
+		return;
+	if (level == S_FATAL)
+		say_flush();
 	ssize_t r = safe_write(log->fd, buf, total);
 	(void) r;                               /* silence gcc warning */
 }
@@ -1244,7 +1536,7 @@ log_vsay(struct log *log, int level, const char *filename, int line,
 	case SAY_LOGGER_FILE:
 	case SAY_LOGGER_PIPE:
 	case SAY_LOGGER_STDERR:
-		write_to_file(log, total);
+		write_to_file(log, total, level);
 		break;
 	case SAY_LOGGER_SYSLOG:
 		write_to_syslog(log, total);
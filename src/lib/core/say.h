@@ -282,6 +282,25 @@ say_logger_initialized(void);
 void
 say_logger_free(void);
 
+/**
+ * Switch the default logger into the asynchronous mode and back.
+ * In the asynchronous mode each thread appends preformatted
+ * records to its own lock-free ring, and a dedicated writer
+ * thread drains the rings into the log file. When a ring
+ * overflows the record is dropped and the drop is counted and
+ * reported - a producer is never blocked by a slow disk.
+ */
+void
+say_set_async(bool async);
+
+/**
+ * Write out all records pending in the asynchronous rings from
+ * the calling thread. A no-op in the synchronous mode. Meant for
+ * the fatal error paths which can not wait for the writer thread.
+ */
+void
+say_flush(void);
+
 /** \cond public */
 typedef void (*sayfunc_t)(int, const char *, int, const char *,
 		    const char *, ...);
@@ -29,6 +29,8 @@
  * SUCH DAMAGE.
  */
 #include "sio.h"
+#include "trivia/config.h"
+#include <unistd.h>
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <sys/uio.h>
@@ -43,6 +45,11 @@
 #include "uri/uri.h"
 #include "errinj.h"
 
+#if defined(__linux__) && defined(MSG_ZEROCOPY) && defined(SO_ZEROCOPY)
+#define SIO_WITH_ZEROCOPY 1
+#include <linux/errqueue.h>
+#endif
+
 static_assert(SMALL_STATIC_SIZE > NI_MAXHOST + NI_MAXSERV,
 	      "static buffer should fit host name");
 
@@ -238,6 +245,24 @@ sio_accept(int fd, struct sockaddr *addr, socklen_t *addrlen)
 	return newfd;
 }
 
+int
+sio_accept_nonblock(int fd, struct sockaddr *addr, socklen_t *addrlen)
+{
+#ifdef HAVE_ACCEPT4
+	int newfd = accept4(fd, addr, addrlen, SOCK_NONBLOCK);
+	if (newfd < 0 && !sio_wouldblock(errno))
+		diag_set(SocketError, sio_socketname(fd), "accept4");
+	return newfd;
+#else
+	int newfd = sio_accept(fd, addr, addrlen);
+	if (newfd >= 0 && sio_setfl(newfd, O_NONBLOCK, 1) < 0) {
+		close(newfd);
+		return -1;
+	}
+	return newfd;
+#endif
+}
+
 ssize_t
 sio_read(int fd, void *buf, size_t count)
 {
@@ -284,6 +309,82 @@ sio_writev(int fd, const struct iovec *iov, int iovcnt)
 	return n;
 }
 
+#ifdef SIO_WITH_ZEROCOPY
+
+int
+sio_enable_zerocopy(int fd)
+{
+	int on = 1;
+	return setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &on, sizeof(on));
+}
+
+ssize_t
+sio_writev_zerocopy(int fd, const struct iovec *iov, int iovcnt)
+{
+	int cnt = iovcnt < IOV_MAX ? iovcnt : IOV_MAX;
+	struct msghdr msg;
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = (struct iovec *) iov;
+	msg.msg_iovlen = cnt;
+	ssize_t n = sendmsg(fd, &msg, MSG_ZEROCOPY);
+	if (n < 0 && errno != ENOBUFS && !sio_wouldblock(errno)) {
+		diag_set(SocketError, sio_socketname(fd), "sendmsg(%d)",
+			 iovcnt);
+	}
+	return n;
+}
+
+int
+sio_zerocopy_completion(int fd, uint32_t *lo, uint32_t *hi)
+{
+	struct msghdr msg;
+	char control[CMSG_SPACE(sizeof(struct sock_extended_err))];
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_control = control;
+	msg.msg_controllen = sizeof(control);
+	if (recvmsg(fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+		return 0;
+	for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL;
+	     cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+		struct sock_extended_err *serr =
+			(struct sock_extended_err *) CMSG_DATA(cmsg);
+		if (serr->ee_errno != 0 ||
+		    serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+			continue;
+		*lo = serr->ee_info;
+		*hi = serr->ee_data;
+		return 1;
+	}
+	return 0;
+}
+
+#else /* !defined(SIO_WITH_ZEROCOPY) */
+
+int
+sio_enable_zerocopy(int fd)
+{
+	(void) fd;
+	errno = ENOSYS;
+	return -1;
+}
+
+ssize_t
+sio_writev_zerocopy(int fd, const struct iovec *iov, int iovcnt)
+{
+	return sio_writev(fd, iov, iovcnt);
+}
+
+int
+sio_zerocopy_completion(int fd, uint32_t *lo, uint32_t *hi)
+{
+	(void) fd;
+	(void) lo;
+	(void) hi;
+	return 0;
+}
+
+#endif /* defined(SIO_WITH_ZEROCOPY) */
+
 ssize_t
 sio_sendto(int fd, const void *buf, size_t len, int flags,
 	   const struct sockaddr *dest_addr, socklen_t addrlen)
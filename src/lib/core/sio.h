@@ -186,6 +186,13 @@ int sio_listen(int fd);
  */
 int sio_accept(int fd, struct sockaddr *addr, socklen_t *addrlen);
 
+/**
+ * Like sio_accept(), but the accepted socket is returned already
+ * switched to non-blocking mode: a single accept4() call where
+ * the platform has it, an accept() + fcntl() pair elsewhere.
+ */
+int sio_accept_nonblock(int fd, struct sockaddr *addr, socklen_t *addrlen);
+
 /**
  * Read *up to* 'count' bytes from a socket.
  * The diagnostics is not set for sio_wouldblock() errors.
@@ -204,6 +211,34 @@ ssize_t sio_write(int fd, const void *buf, size_t count);
  */
 ssize_t sio_writev(int fd, const struct iovec *iov, int iovcnt);
 
+/**
+ * Enable MSG_ZEROCOPY sends on a socket. Returns -1 without
+ * setting the diagnostics when the platform or the socket does
+ * not support it - the caller is expected to fall back to plain
+ * writes.
+ */
+int sio_enable_zerocopy(int fd);
+
+/**
+ * Write to a socket with iovec, asking the kernel to transmit
+ * straight from the supplied buffers instead of copying them.
+ * The buffers must stay intact until the kernel reports the
+ * completion, see sio_zerocopy_completion(). May fail with
+ * ENOBUFS when the kernel can not pin the pages; the caller
+ * should then retry with plain sio_writev(). The diagnostics is
+ * not set for sio_wouldblock() errors and ENOBUFS.
+ */
+ssize_t sio_writev_zerocopy(int fd, const struct iovec *iov, int iovcnt);
+
+/**
+ * Pop a zerocopy send completion from the socket error queue.
+ * Completed sends are reported as an inclusive range [lo, hi] of
+ * send sequence numbers, which the kernel counts from 0 for each
+ * socket. Returns 1 if a range was popped, 0 if the queue is
+ * empty or on any error. Never sets the diagnostics.
+ */
+int sio_zerocopy_completion(int fd, uint32_t *lo, uint32_t *hi);
+
 /**
  * Send a message on a socket.
  * The diagnostics is not set for sio_wouldblock() errors.
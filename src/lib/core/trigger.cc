@@ -32,7 +32,7 @@
 #include "trigger.h"
 
 int
-trigger_run(struct rlist *list, void *event)
+trigger_run_list(struct rlist *list, void *event)
 {
 	struct trigger *trigger, *tmp;
 	rlist_foreach_entry_safe(trigger, list, link, tmp)
@@ -42,7 +42,7 @@ trigger_run(struct rlist *list, void *event)
 }
 
 int
-trigger_run_reverse(struct rlist *list, void *event)
+trigger_run_reverse_list(struct rlist *list, void *event)
 {
 	struct trigger *trigger, *tmp;
 	rlist_foreach_entry_safe_reverse(trigger, list, link, tmp)
@@ -113,23 +113,45 @@ trigger_destroy(struct rlist *list)
 	}
 }
 
+/** Out-of-line part of trigger_run(), @a list is not empty. */
+int
+trigger_run_list(struct rlist *list, void *event);
+
+/** Out-of-line part of trigger_run_reverse(), @a list is not empty. */
+int
+trigger_run_reverse_list(struct rlist *list, void *event);
+
 /**
  * Run registered triggers. Stop and return an error if
  * a trigger fails.
  *
  * Note, since triggers are added to the list head, this
- * function first runs triggers that were added last
+ * function first runs triggers that were added last.
+ *
+ * Most trigger lists on the DML path are extension points with
+ * nothing registered, so the empty-list case is handled right at
+ * the call site: a single load and compare, no function call.
  */
-int
-trigger_run(struct rlist *list, void *event);
+static inline int
+trigger_run(struct rlist *list, void *event)
+{
+	if (rlist_empty(list))
+		return 0;
+	return trigger_run_list(list, event);
+}
 
 /**
  * Same as trigger_run(), but runs triggers in the reverse
  * order, i.e. it runs triggers in the same order they were
  * added.
  */
-int
-trigger_run_reverse(struct rlist *list, void *event);
+static inline int
+trigger_run_reverse(struct rlist *list, void *event)
+{
+	if (rlist_empty(list))
+		return 0;
+	return trigger_run_reverse_list(list, event);
+}
 
 #if defined(__cplusplus)
 } /* extern "C" */
@@ -29,6 +29,7 @@
  * SUCH DAMAGE.
  */
 #include "http_parser.h"
+#include <stdint.h>
 #include <string.h>
 
 #define LF     (unsigned char) '\n'
@@ -217,6 +218,33 @@ done:
 	return HTTP_PARSE_OK;
 }
 
+/** Detect a zero byte in a 64-bit word (Mycroft's trick). */
+#define HASZERO(v) \
+	(((v) - 0x0101010101010101ULL) & ~(v) & 0x8080808080808080ULL)
+/** Broadcast a byte to all lanes of a 64-bit word. */
+#define BCAST(c) ((unsigned char)(c) * 0x0101010101010101ULL)
+
+/**
+ * Skip ordinary header value bytes a word at a time: advance @a p
+ * to the word containing the first byte the sw_value state reacts
+ * to (' ', CR, LF or NUL). The state machine then walks the last
+ * few bytes to the exact position. Long values (cookies, user
+ * agents) are scanned eight bytes per iteration instead of one.
+ */
+static inline char *
+http_scan_value(char *p, const char *end)
+{
+	while (p + sizeof(uint64_t) <= end) {
+		uint64_t w;
+		memcpy(&w, p, sizeof(w));
+		if ((HASZERO(w) | HASZERO(w ^ BCAST(' ')) |
+		     HASZERO(w ^ BCAST(CR)) | HASZERO(w ^ BCAST(LF))) != 0)
+			break;
+		p += sizeof(uint64_t);
+	}
+	return p;
+}
+
 int
 http_parse_header_line(struct http_parser *prsr, char **bufp,
 		       const char *end_buf, int max_hname_len)
@@ -254,6 +282,15 @@ http_parse_header_line(struct http_parser *prsr, char **bufp,
 			"\0\0\0\0\0\0\0\0\0\0";
 
 	for (; p < end_buf; p++) {
+		/*
+		 * The value state only reacts to ' ', CR, LF and
+		 * NUL; fast-forward over everything else.
+		 */
+		if (state == sw_value) {
+			p = http_scan_value(p, end_buf);
+			if (p >= end_buf)
+				break;
+		}
 		ch = *p;
 		switch (state) {
 		/* first char */
@@ -88,6 +88,17 @@ mpstream_flush(struct mpstream *stream)
 	stream->buf = stream->pos;
 }
 
+/**
+ * Make sure at least @a size bytes are available for writing at
+ * the returned position. Besides serving the per-value encoders
+ * below, this is the batching primitive: a caller which knows an
+ * upper bound of the encoded size of a group of values can
+ * reserve it once, encode the group with plain unchecked
+ * mp_encode_*() calls and hand the final position over to
+ * mpstream_advance(), paying one capacity check for the whole
+ * group. Returns NULL after invoking the stream error callback
+ * if the allocator fails.
+ */
 static inline char *
 mpstream_reserve(struct mpstream *stream, size_t size)
 {
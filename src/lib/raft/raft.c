@@ -73,6 +73,18 @@ raft_write(struct raft *raft, const struct raft_msg *req)
 	raft->vtab->write(raft, req);
 }
 
+/**
+ * Shortcut for vtab 'is_quorum_reachable' method. The method is optional -
+ * when it is not defined, a quorum is assumed to be reachable.
+ */
+static inline bool
+raft_is_quorum_reachable(struct raft *raft)
+{
+	if (raft->vtab->is_quorum_reachable == NULL)
+		return true;
+	return raft->vtab->is_quorum_reachable(raft);
+}
+
 /** Shortcut for vtab 'schedule_async' method. */
 static inline void
 raft_schedule_async(struct raft *raft)
@@ -701,6 +713,21 @@ raft_sm_schedule_new_election_cb(struct ev_loop *loop, struct ev_timer *timer,
 	struct raft *raft = timer->data;
 	assert(timer == &raft->timer);
 	raft_ev_timer_stop(loop, timer);
+	/*
+	 * Pre-vote check. Don't bump the term until there is a chance to
+	 * actually win the election. Otherwise a node having connectivity
+	 * issues would generate a new term on every timeout, and each time the
+	 * network heals it would stun the active leader with that term and
+	 * cause a completely unnecessary re-election.
+	 */
+	if (!raft_is_quorum_reachable(raft)) {
+		say_info("RAFT: election is postponed - no quorum of peers "
+			 "is reachable");
+		raft_ev_timer_set(timer, raft->death_timeout,
+				  raft->death_timeout);
+		raft_ev_timer_start(loop, timer);
+		return;
+	}
 	raft_sm_schedule_new_election(raft);
 }
 
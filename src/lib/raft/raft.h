@@ -121,6 +121,7 @@ struct raft_msg {
 typedef void (*raft_broadcast_f)(struct raft *raft, const struct raft_msg *req);
 typedef void (*raft_write_f)(struct raft *raft, const struct raft_msg *req);
 typedef void (*raft_schedule_async_f)(struct raft *raft);
+typedef bool (*raft_is_quorum_reachable_f)(struct raft *raft);
 
 /**
  * Raft connection to the environment, via which it talks to other nodes, to
@@ -136,6 +137,14 @@ struct raft_vtab {
 	 * right now.
 	 */
 	raft_schedule_async_f schedule_async;
+	/**
+	 * Check if a quorum of peers is reachable right now. Optional, can be
+	 * NULL. It is a pre-vote check - when a node can't reach a quorum, its
+	 * election is hopeless, and bumping the term would only disturb a
+	 * possibly healthy leader once the connectivity is restored. Such a
+	 * node keeps its term and retries when the timeout expires again.
+	 */
+	raft_is_quorum_reachable_f is_quorum_reachable;
 };
 
 struct raft {
@@ -0,0 +1,933 @@
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "art.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * The implementation follows "The Adaptive Radix Tree: ARTful
+ * Indexing for Main-Memory Databases" by Leis, Kemper and
+ * Neumann. Inner nodes come in four sizes and grow or shrink as
+ * children are added and removed. Single-child chains are
+ * collapsed into a per-node prefix; only the first
+ * ART_PREFIX_CACHE bytes of a prefix are stored inline, longer
+ * prefixes are recovered from any leaf under the node.
+ */
+
+enum art_node_type {
+	ART_NODE4,
+	ART_NODE16,
+	ART_NODE48,
+	ART_NODE256,
+};
+
+enum {
+	/** How many prefix bytes an inner node caches inline. */
+	ART_PREFIX_CACHE = 10,
+};
+
+/**
+ * Common inner node header.
+ */
+struct art_node
+{
+	/** Node kind, enum art_node_type. */
+	uint8_t type;
+	/** Number of children. */
+	uint8_t num_children;
+	/** Full length of the compressed path prefix. */
+	uint32_t prefix_len;
+	/** First bytes of the prefix. */
+	unsigned char prefix[ART_PREFIX_CACHE];
+};
+
+struct art_node4
+{
+	struct art_node base;
+	unsigned char keys[4];
+	struct art_node *children[4];
+};
+
+struct art_node16
+{
+	struct art_node base;
+	unsigned char keys[16];
+	struct art_node *children[16];
+};
+
+struct art_node48
+{
+	struct art_node base;
+	/** Byte to child slot map, 0 means no child. */
+	unsigned char child_index[256];
+	struct art_node *children[48];
+};
+
+struct art_node256
+{
+	struct art_node base;
+	struct art_node *children[256];
+};
+
+/**
+ * A leaf holds a full copy of its key so that long prefixes can
+ * be reconstructed and matches verified.
+ */
+struct art_leaf
+{
+	void *value;
+	uint32_t key_len;
+	unsigned char key[];
+};
+
+/*
+ * Leaves are distinguished from inner nodes by a tag in the
+ * low pointer bit.
+ */
+static inline bool
+art_is_leaf(const struct art_node *node)
+{
+	return ((uintptr_t)node & 1) != 0;
+}
+
+static inline struct art_node *
+art_leaf_tag(struct art_leaf *leaf)
+{
+	return (struct art_node *)((uintptr_t)leaf | 1);
+}
+
+static inline struct art_leaf *
+art_leaf_raw(const struct art_node *node)
+{
+	return (struct art_leaf *)((uintptr_t)node & ~(uintptr_t)1);
+}
+
+static struct art_leaf *
+art_leaf_new(const unsigned char *key, uint32_t key_len, void *value)
+{
+	struct art_leaf *leaf = malloc(sizeof(*leaf) + key_len);
+	if (leaf == NULL)
+		return NULL;
+	leaf->value = value;
+	leaf->key_len = key_len;
+	memcpy(leaf->key, key, key_len);
+	return leaf;
+}
+
+static inline bool
+art_leaf_matches(const struct art_leaf *leaf, const unsigned char *key,
+		 uint32_t key_len)
+{
+	return leaf->key_len == key_len &&
+	       memcmp(leaf->key, key, key_len) == 0;
+}
+
+static struct art_node *
+art_node_new(enum art_node_type type)
+{
+	size_t size;
+	switch (type) {
+	case ART_NODE4:
+		size = sizeof(struct art_node4);
+		break;
+	case ART_NODE16:
+		size = sizeof(struct art_node16);
+		break;
+	case ART_NODE48:
+		size = sizeof(struct art_node48);
+		break;
+	default:
+		assert(type == ART_NODE256);
+		size = sizeof(struct art_node256);
+		break;
+	}
+	struct art_node *node = calloc(1, size);
+	if (node == NULL)
+		return NULL;
+	node->type = type;
+	return node;
+}
+
+/**
+ * Find the slot of the child labelled with @a byte, NULL if the
+ * node has no such child. The returned slot stays valid until
+ * the node is modified.
+ */
+static struct art_node **
+art_find_child(struct art_node *node, unsigned char byte)
+{
+	switch (node->type) {
+	case ART_NODE4: {
+		struct art_node4 *n = (struct art_node4 *)node;
+		for (uint8_t i = 0; i < node->num_children; i++) {
+			if (n->keys[i] == byte)
+				return &n->children[i];
+		}
+		return NULL;
+	}
+	case ART_NODE16: {
+		struct art_node16 *n = (struct art_node16 *)node;
+		for (uint8_t i = 0; i < node->num_children; i++) {
+			if (n->keys[i] == byte)
+				return &n->children[i];
+		}
+		return NULL;
+	}
+	case ART_NODE48: {
+		struct art_node48 *n = (struct art_node48 *)node;
+		unsigned char slot = n->child_index[byte];
+		return slot != 0 ? &n->children[slot - 1] : NULL;
+	}
+	default: {
+		assert(node->type == ART_NODE256);
+		struct art_node256 *n = (struct art_node256 *)node;
+		return n->children[byte] != NULL ? &n->children[byte] : NULL;
+	}
+	}
+}
+
+/**
+ * The leftmost leaf under @a node - the source of truth for
+ * prefix bytes beyond the inline cache.
+ */
+static struct art_leaf *
+art_minimum(struct art_node *node)
+{
+	while (!art_is_leaf(node)) {
+		switch (node->type) {
+		case ART_NODE4:
+			node = ((struct art_node4 *)node)->children[0];
+			break;
+		case ART_NODE16:
+			node = ((struct art_node16 *)node)->children[0];
+			break;
+		case ART_NODE48: {
+			struct art_node48 *n = (struct art_node48 *)node;
+			int i = 0;
+			while (n->child_index[i] == 0)
+				i++;
+			node = n->children[n->child_index[i] - 1];
+			break;
+		}
+		default: {
+			assert(node->type == ART_NODE256);
+			struct art_node256 *n = (struct art_node256 *)node;
+			int i = 0;
+			while (n->children[i] == NULL)
+				i++;
+			node = n->children[i];
+			break;
+		}
+		}
+	}
+	return art_leaf_raw(node);
+}
+
+/**
+ * How many prefix bytes of @a node match @a key at @a depth,
+ * looking only at the inline prefix cache.
+ */
+static uint32_t
+art_check_prefix(const struct art_node *node, const unsigned char *key,
+		 uint32_t key_len, uint32_t depth)
+{
+	uint32_t max_cmp = node->prefix_len < ART_PREFIX_CACHE ?
+			   node->prefix_len : ART_PREFIX_CACHE;
+	if (max_cmp > key_len - depth)
+		max_cmp = key_len - depth;
+	uint32_t i;
+	for (i = 0; i < max_cmp; i++) {
+		if (node->prefix[i] != key[depth + i])
+			return i;
+	}
+	return i;
+}
+
+/**
+ * The position of the first mismatch between @a key and the full
+ * node prefix, consulting a leaf when the prefix is longer than
+ * the inline cache.
+ */
+static uint32_t
+art_prefix_mismatch(struct art_node *node, const unsigned char *key,
+		    uint32_t key_len, uint32_t depth)
+{
+	uint32_t max_cmp = node->prefix_len < ART_PREFIX_CACHE ?
+			   node->prefix_len : ART_PREFIX_CACHE;
+	if (max_cmp > key_len - depth)
+		max_cmp = key_len - depth;
+	uint32_t i;
+	for (i = 0; i < max_cmp; i++) {
+		if (node->prefix[i] != key[depth + i])
+			return i;
+	}
+	if (node->prefix_len <= ART_PREFIX_CACHE)
+		return i;
+	const struct art_leaf *leaf = art_minimum(node);
+	max_cmp = node->prefix_len;
+	if (max_cmp > key_len - depth)
+		max_cmp = key_len - depth;
+	for (; i < max_cmp; i++) {
+		if (leaf->key[depth + i] != key[depth + i])
+			return i;
+	}
+	return i;
+}
+
+/**
+ * Add a child to a node, growing the node to the next size when
+ * it is full. On success *ref may be updated to point to the
+ * grown copy. Does not modify anything on failure.
+ * @retval  0 on success.
+ * @retval -1 on memory allocation error.
+ */
+static int
+art_add_child(struct art_node *node, struct art_node **ref, unsigned char byte,
+	      struct art_node *child)
+{
+	switch (node->type) {
+	case ART_NODE4: {
+		struct art_node4 *n = (struct art_node4 *)node;
+		if (node->num_children < 4) {
+			uint8_t i;
+			for (i = 0; i < node->num_children; i++) {
+				if (byte < n->keys[i])
+					break;
+			}
+			memmove(&n->keys[i + 1], &n->keys[i],
+				node->num_children - i);
+			memmove(&n->children[i + 1], &n->children[i],
+				(node->num_children - i) *
+				sizeof(n->children[0]));
+			n->keys[i] = byte;
+			n->children[i] = child;
+			node->num_children++;
+			return 0;
+		}
+		struct art_node16 *grown =
+			(struct art_node16 *)art_node_new(ART_NODE16);
+		if (grown == NULL)
+			return -1;
+		grown->base.num_children = node->num_children;
+		grown->base.prefix_len = node->prefix_len;
+		memcpy(grown->base.prefix, node->prefix, ART_PREFIX_CACHE);
+		memcpy(grown->keys, n->keys, 4);
+		memcpy(grown->children, n->children, 4 *
+		       sizeof(n->children[0]));
+		*ref = &grown->base;
+		free(node);
+		return art_add_child(&grown->base, ref, byte, child);
+	}
+	case ART_NODE16: {
+		struct art_node16 *n = (struct art_node16 *)node;
+		if (node->num_children < 16) {
+			uint8_t i;
+			for (i = 0; i < node->num_children; i++) {
+				if (byte < n->keys[i])
+					break;
+			}
+			memmove(&n->keys[i + 1], &n->keys[i],
+				node->num_children - i);
+			memmove(&n->children[i + 1], &n->children[i],
+				(node->num_children - i) *
+				sizeof(n->children[0]));
+			n->keys[i] = byte;
+			n->children[i] = child;
+			node->num_children++;
+			return 0;
+		}
+		struct art_node48 *grown =
+			(struct art_node48 *)art_node_new(ART_NODE48);
+		if (grown == NULL)
+			return -1;
+		grown->base.num_children = node->num_children;
+		grown->base.prefix_len = node->prefix_len;
+		memcpy(grown->base.prefix, node->prefix, ART_PREFIX_CACHE);
+		for (uint8_t i = 0; i < 16; i++) {
+			grown->child_index[n->keys[i]] = i + 1;
+			grown->children[i] = n->children[i];
+		}
+		*ref = &grown->base;
+		free(node);
+		return art_add_child(&grown->base, ref, byte, child);
+	}
+	case ART_NODE48: {
+		struct art_node48 *n = (struct art_node48 *)node;
+		if (node->num_children < 48) {
+			uint8_t slot = 0;
+			while (n->children[slot] != NULL)
+				slot++;
+			n->children[slot] = child;
+			n->child_index[byte] = slot + 1;
+			node->num_children++;
+			return 0;
+		}
+		struct art_node256 *grown =
+			(struct art_node256 *)art_node_new(ART_NODE256);
+		if (grown == NULL)
+			return -1;
+		grown->base.num_children = node->num_children;
+		grown->base.prefix_len = node->prefix_len;
+		memcpy(grown->base.prefix, node->prefix, ART_PREFIX_CACHE);
+		for (int i = 0; i < 256; i++) {
+			if (n->child_index[i] != 0)
+				grown->children[i] =
+					n->children[n->child_index[i] - 1];
+		}
+		*ref = &grown->base;
+		free(node);
+		return art_add_child(&grown->base, ref, byte, child);
+	}
+	default: {
+		assert(node->type == ART_NODE256);
+		struct art_node256 *n = (struct art_node256 *)node;
+		assert(n->children[byte] == NULL);
+		n->children[byte] = child;
+		node->num_children++;
+		return 0;
+	}
+	}
+}
+
+/**
+ * Remove the child in @a slot, shrinking or collapsing the node
+ * when it gets underfull. Shrinking allocates; if the allocation
+ * fails the node is simply kept at its current size - the tree
+ * stays correct, only less compact.
+ */
+static void
+art_remove_child(struct art_node *node, struct art_node **ref,
+		 unsigned char byte, struct art_node **slot)
+{
+	switch (node->type) {
+	case ART_NODE4: {
+		struct art_node4 *n = (struct art_node4 *)node;
+		int i = slot - n->children;
+		memmove(&n->keys[i], &n->keys[i + 1],
+			node->num_children - i - 1);
+		memmove(&n->children[i], &n->children[i + 1],
+			(node->num_children - i - 1) * sizeof(n->children[0]));
+		node->num_children--;
+		if (node->num_children != 1)
+			return;
+		/*
+		 * A single-child inner node is merged into the
+		 * child by prepending this node's prefix and the
+		 * child's label byte to the child's prefix.
+		 */
+		struct art_node *child = n->children[0];
+		if (!art_is_leaf(child)) {
+			uint32_t prefix = node->prefix_len;
+			if (prefix < ART_PREFIX_CACHE)
+				node->prefix[prefix] = n->keys[0];
+			prefix++;
+			for (uint32_t j = 0; j < child->prefix_len &&
+			     prefix + j < ART_PREFIX_CACHE; j++)
+				node->prefix[prefix + j] = child->prefix[j];
+			uint32_t total = prefix + child->prefix_len;
+			memcpy(child->prefix, node->prefix,
+			       total < ART_PREFIX_CACHE ? total :
+			       ART_PREFIX_CACHE);
+			child->prefix_len = total;
+		}
+		*ref = child;
+		free(node);
+		return;
+	}
+	case ART_NODE16: {
+		struct art_node16 *n = (struct art_node16 *)node;
+		int i = slot - n->children;
+		memmove(&n->keys[i], &n->keys[i + 1],
+			node->num_children - i - 1);
+		memmove(&n->children[i], &n->children[i + 1],
+			(node->num_children - i - 1) * sizeof(n->children[0]));
+		node->num_children--;
+		if (node->num_children > 3)
+			return;
+		struct art_node4 *small =
+			(struct art_node4 *)art_node_new(ART_NODE4);
+		if (small == NULL)
+			return;
+		small->base.num_children = node->num_children;
+		small->base.prefix_len = node->prefix_len;
+		memcpy(small->base.prefix, node->prefix, ART_PREFIX_CACHE);
+		memcpy(small->keys, n->keys, node->num_children);
+		memcpy(small->children, n->children,
+		       node->num_children * sizeof(n->children[0]));
+		*ref = &small->base;
+		free(node);
+		return;
+	}
+	case ART_NODE48: {
+		struct art_node48 *n = (struct art_node48 *)node;
+		n->children[n->child_index[byte] - 1] = NULL;
+		n->child_index[byte] = 0;
+		node->num_children--;
+		if (node->num_children > 12)
+			return;
+		struct art_node16 *small =
+			(struct art_node16 *)art_node_new(ART_NODE16);
+		if (small == NULL)
+			return;
+		small->base.num_children = node->num_children;
+		small->base.prefix_len = node->prefix_len;
+		memcpy(small->base.prefix, node->prefix, ART_PREFIX_CACHE);
+		uint8_t pos = 0;
+		for (int i = 0; i < 256; i++) {
+			if (n->child_index[i] == 0)
+				continue;
+			small->keys[pos] = i;
+			small->children[pos] =
+				n->children[n->child_index[i] - 1];
+			pos++;
+		}
+		*ref = &small->base;
+		free(node);
+		return;
+	}
+	default: {
+		assert(node->type == ART_NODE256);
+		struct art_node256 *n = (struct art_node256 *)node;
+		n->children[byte] = NULL;
+		node->num_children--;
+		if (node->num_children > 40)
+			return;
+		struct art_node48 *small =
+			(struct art_node48 *)art_node_new(ART_NODE48);
+		if (small == NULL)
+			return;
+		small->base.num_children = node->num_children;
+		small->base.prefix_len = node->prefix_len;
+		memcpy(small->base.prefix, node->prefix, ART_PREFIX_CACHE);
+		uint8_t pos = 0;
+		for (int i = 0; i < 256; i++) {
+			if (n->children[i] == NULL)
+				continue;
+			small->children[pos] = n->children[i];
+			small->child_index[i] = pos + 1;
+			pos++;
+		}
+		*ref = &small->base;
+		free(node);
+		return;
+	}
+	}
+}
+
+void
+art_create(struct art *tree)
+{
+	tree->root = NULL;
+	tree->size = 0;
+}
+
+static void
+art_destroy_node(struct art_node *node)
+{
+	if (art_is_leaf(node)) {
+		free(art_leaf_raw(node));
+		return;
+	}
+	switch (node->type) {
+	case ART_NODE4: {
+		struct art_node4 *n = (struct art_node4 *)node;
+		for (uint8_t i = 0; i < node->num_children; i++)
+			art_destroy_node(n->children[i]);
+		break;
+	}
+	case ART_NODE16: {
+		struct art_node16 *n = (struct art_node16 *)node;
+		for (uint8_t i = 0; i < node->num_children; i++)
+			art_destroy_node(n->children[i]);
+		break;
+	}
+	case ART_NODE48: {
+		struct art_node48 *n = (struct art_node48 *)node;
+		for (int i = 0; i < 256; i++) {
+			if (n->child_index[i] != 0)
+				art_destroy_node(
+					n->children[n->child_index[i] - 1]);
+		}
+		break;
+	}
+	default: {
+		assert(node->type == ART_NODE256);
+		struct art_node256 *n = (struct art_node256 *)node;
+		for (int i = 0; i < 256; i++) {
+			if (n->children[i] != NULL)
+				art_destroy_node(n->children[i]);
+		}
+		break;
+	}
+	}
+	free(node);
+}
+
+void
+art_destroy(struct art *tree)
+{
+	if (tree->root != NULL)
+		art_destroy_node(tree->root);
+	tree->root = NULL;
+	tree->size = 0;
+}
+
+static int
+art_insert_impl(struct art_node *node, struct art_node **ref,
+		const unsigned char *key, uint32_t key_len, void *value,
+		void **old_value, uint32_t depth)
+{
+	if (art_is_leaf(node)) {
+		struct art_leaf *leaf = art_leaf_raw(node);
+		if (art_leaf_matches(leaf, key, key_len)) {
+			*old_value = leaf->value;
+			leaf->value = value;
+			return 0;
+		}
+		/*
+		 * Split: a new inner node holding the old leaf
+		 * and a leaf for the new key. Allocate both
+		 * before modifying anything.
+		 */
+		struct art_node4 *split =
+			(struct art_node4 *)art_node_new(ART_NODE4);
+		struct art_leaf *new_leaf = art_leaf_new(key, key_len, value);
+		if (split == NULL || new_leaf == NULL) {
+			free(split);
+			free(new_leaf);
+			return -1;
+		}
+		uint32_t common = depth;
+		uint32_t max_common = key_len < leaf->key_len ?
+				      key_len : leaf->key_len;
+		while (common < max_common && key[common] == leaf->key[common])
+			common++;
+		split->base.prefix_len = common - depth;
+		uint32_t cached = common - depth < ART_PREFIX_CACHE ?
+				  common - depth : ART_PREFIX_CACHE;
+		memcpy(split->base.prefix, key + depth, cached);
+		/* Prefix-free keys cannot run out at the fork. */
+		assert(common < key_len && common < leaf->key_len);
+		int rc = art_add_child(&split->base, ref, leaf->key[common],
+				       node);
+		assert(rc == 0);
+		rc = art_add_child(&split->base, ref, key[common],
+				   art_leaf_tag(new_leaf));
+		assert(rc == 0);
+		(void)rc;
+		*ref = &split->base;
+		return 1;
+	}
+	if (node->prefix_len > 0) {
+		uint32_t mismatch = art_prefix_mismatch(node, key, key_len,
+							depth);
+		if (mismatch < node->prefix_len) {
+			/*
+			 * Fork inside the compressed path: a new
+			 * inner node takes the matched part of
+			 * the prefix, the old node keeps the
+			 * rest.
+			 */
+			struct art_node4 *split =
+				(struct art_node4 *)art_node_new(ART_NODE4);
+			struct art_leaf *new_leaf =
+				art_leaf_new(key, key_len, value);
+			if (split == NULL || new_leaf == NULL) {
+				free(split);
+				free(new_leaf);
+				return -1;
+			}
+			split->base.prefix_len = mismatch;
+			uint32_t cached = mismatch < ART_PREFIX_CACHE ?
+					  mismatch : ART_PREFIX_CACHE;
+			memcpy(split->base.prefix, node->prefix, cached);
+			unsigned char node_byte;
+			if (node->prefix_len <= ART_PREFIX_CACHE) {
+				node_byte = node->prefix[mismatch];
+				node->prefix_len -= mismatch + 1;
+				memmove(node->prefix,
+					node->prefix + mismatch + 1,
+					node->prefix_len < ART_PREFIX_CACHE ?
+					node->prefix_len : ART_PREFIX_CACHE);
+			} else {
+				const struct art_leaf *min = art_minimum(node);
+				node_byte = min->key[depth + mismatch];
+				node->prefix_len -= mismatch + 1;
+				uint32_t copy = node->prefix_len <
+						ART_PREFIX_CACHE ?
+						node->prefix_len :
+						ART_PREFIX_CACHE;
+				memcpy(node->prefix,
+				       min->key + depth + mismatch + 1, copy);
+			}
+			assert(depth + mismatch < key_len);
+			int rc = art_add_child(&split->base, ref, node_byte,
+					       node);
+			assert(rc == 0);
+			rc = art_add_child(&split->base, ref,
+					   key[depth + mismatch],
+					   art_leaf_tag(new_leaf));
+			assert(rc == 0);
+			(void)rc;
+			*ref = &split->base;
+			return 1;
+		}
+		depth += node->prefix_len;
+	}
+	assert(depth < key_len);
+	struct art_node **child = art_find_child(node, key[depth]);
+	if (child != NULL)
+		return art_insert_impl(*child, child, key, key_len, value,
+				       old_value, depth + 1);
+	struct art_leaf *new_leaf = art_leaf_new(key, key_len, value);
+	if (new_leaf == NULL)
+		return -1;
+	if (art_add_child(node, ref, key[depth],
+			  art_leaf_tag(new_leaf)) != 0) {
+		free(new_leaf);
+		return -1;
+	}
+	return 1;
+}
+
+int
+art_insert(struct art *tree, const unsigned char *key, uint32_t key_len,
+	   void *value, void **old_value)
+{
+	*old_value = NULL;
+	if (tree->root == NULL) {
+		struct art_leaf *leaf = art_leaf_new(key, key_len, value);
+		if (leaf == NULL)
+			return -1;
+		tree->root = art_leaf_tag(leaf);
+		tree->size++;
+		return 0;
+	}
+	int rc = art_insert_impl(tree->root, &tree->root, key, key_len, value,
+				 old_value, 0);
+	if (rc < 0)
+		return -1;
+	tree->size += rc;
+	return 0;
+}
+
+void *
+art_find(const struct art *tree, const unsigned char *key, uint32_t key_len)
+{
+	struct art_node *node = tree->root;
+	uint32_t depth = 0;
+	while (node != NULL) {
+		if (art_is_leaf(node)) {
+			struct art_leaf *leaf = art_leaf_raw(node);
+			if (art_leaf_matches(leaf, key, key_len))
+				return leaf->value;
+			return NULL;
+		}
+		if (node->prefix_len > 0) {
+			/*
+			 * The optimistic check looks only at the
+			 * cached bytes; the final leaf
+			 * comparison catches false matches on
+			 * longer prefixes.
+			 */
+			uint32_t cached = node->prefix_len < ART_PREFIX_CACHE ?
+					  node->prefix_len : ART_PREFIX_CACHE;
+			if (art_check_prefix(node, key, key_len, depth) !=
+			    cached)
+				return NULL;
+			depth += node->prefix_len;
+		}
+		if (depth >= key_len)
+			return NULL;
+		struct art_node **child = art_find_child(node, key[depth]);
+		node = child != NULL ? *child : NULL;
+		depth++;
+	}
+	return NULL;
+}
+
+static void *
+art_remove_impl(struct art_node *node, struct art_node **ref,
+		const unsigned char *key, uint32_t key_len, uint32_t depth)
+{
+	if (art_is_leaf(node)) {
+		struct art_leaf *leaf = art_leaf_raw(node);
+		if (!art_leaf_matches(leaf, key, key_len))
+			return NULL;
+		*ref = NULL;
+		void *value = leaf->value;
+		free(leaf);
+		return value;
+	}
+	if (node->prefix_len > 0) {
+		uint32_t cached = node->prefix_len < ART_PREFIX_CACHE ?
+				  node->prefix_len : ART_PREFIX_CACHE;
+		if (art_check_prefix(node, key, key_len, depth) != cached)
+			return NULL;
+		depth += node->prefix_len;
+	}
+	if (depth >= key_len)
+		return NULL;
+	struct art_node **child = art_find_child(node, key[depth]);
+	if (child == NULL)
+		return NULL;
+	struct art_node *child_node = *child;
+	if (art_is_leaf(child_node)) {
+		struct art_leaf *leaf = art_leaf_raw(child_node);
+		if (!art_leaf_matches(leaf, key, key_len))
+			return NULL;
+		art_remove_child(node, ref, key[depth], child);
+		void *value = leaf->value;
+		free(leaf);
+		return value;
+	}
+	return art_remove_impl(child_node, child, key, key_len, depth + 1);
+}
+
+void *
+art_remove(struct art *tree, const unsigned char *key, uint32_t key_len)
+{
+	if (tree->root == NULL)
+		return NULL;
+	void *value;
+	if (art_is_leaf(tree->root)) {
+		struct art_leaf *leaf = art_leaf_raw(tree->root);
+		if (!art_leaf_matches(leaf, key, key_len))
+			return NULL;
+		value = leaf->value;
+		free(leaf);
+		tree->root = NULL;
+		tree->size--;
+		return value;
+	}
+	value = art_remove_impl(tree->root, &tree->root, key, key_len, 0);
+	if (value != NULL)
+		tree->size--;
+	return value;
+}
+
+static int
+art_iter_node(struct art_node *node, art_cb cb, void *ctx)
+{
+	if (art_is_leaf(node)) {
+		struct art_leaf *leaf = art_leaf_raw(node);
+		return cb(ctx, leaf->key, leaf->key_len, leaf->value);
+	}
+	int rc = 0;
+	switch (node->type) {
+	case ART_NODE4: {
+		struct art_node4 *n = (struct art_node4 *)node;
+		for (uint8_t i = 0; i < node->num_children && rc == 0; i++)
+			rc = art_iter_node(n->children[i], cb, ctx);
+		break;
+	}
+	case ART_NODE16: {
+		struct art_node16 *n = (struct art_node16 *)node;
+		for (uint8_t i = 0; i < node->num_children && rc == 0; i++)
+			rc = art_iter_node(n->children[i], cb, ctx);
+		break;
+	}
+	case ART_NODE48: {
+		struct art_node48 *n = (struct art_node48 *)node;
+		for (int i = 0; i < 256 && rc == 0; i++) {
+			if (n->child_index[i] != 0)
+				rc = art_iter_node(
+					n->children[n->child_index[i] - 1],
+					cb, ctx);
+		}
+		break;
+	}
+	default: {
+		assert(node->type == ART_NODE256);
+		struct art_node256 *n = (struct art_node256 *)node;
+		for (int i = 0; i < 256 && rc == 0; i++) {
+			if (n->children[i] != NULL)
+				rc = art_iter_node(n->children[i], cb, ctx);
+		}
+		break;
+	}
+	}
+	return rc;
+}
+
+int
+art_iter(const struct art *tree, art_cb cb, void *ctx)
+{
+	if (tree->root == NULL)
+		return 0;
+	return art_iter_node(tree->root, cb, ctx);
+}
+
+int
+art_iter_prefix(const struct art *tree, const unsigned char *prefix,
+		uint32_t prefix_len, art_cb cb, void *ctx)
+{
+	struct art_node *node = tree->root;
+	uint32_t depth = 0;
+	while (node != NULL) {
+		if (art_is_leaf(node)) {
+			struct art_leaf *leaf = art_leaf_raw(node);
+			if (leaf->key_len >= prefix_len &&
+			    memcmp(leaf->key, prefix, prefix_len) == 0)
+				return cb(ctx, leaf->key, leaf->key_len,
+					  leaf->value);
+			return 0;
+		}
+		if (depth + node->prefix_len >= prefix_len) {
+			/*
+			 * The rest of the prefix lies inside
+			 * this node's compressed path. Verify it
+			 * against a leaf and dump the subtree.
+			 */
+			const struct art_leaf *min = art_minimum(node);
+			if (min->key_len < prefix_len ||
+			    memcmp(min->key + depth, prefix + depth,
+				   prefix_len - depth) != 0)
+				return 0;
+			return art_iter_node(node, cb, ctx);
+		}
+		if (node->prefix_len > 0) {
+			const struct art_leaf *min = art_minimum(node);
+			if (memcmp(min->key + depth, prefix + depth,
+				   node->prefix_len) != 0)
+				return 0;
+			depth += node->prefix_len;
+		}
+		struct art_node **child = art_find_child(node, prefix[depth]);
+		node = child != NULL ? *child : NULL;
+		depth++;
+	}
+	return 0;
+}
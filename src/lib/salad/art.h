@@ -0,0 +1,133 @@
+#ifndef TARANTOOL_LIB_SALAD_ART_H_INCLUDED
+#define TARANTOOL_LIB_SALAD_ART_H_INCLUDED
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * Adaptive radix tree (ART), an ordered map from byte string
+ * keys to opaque pointers.
+ *
+ * Unlike a comparison-based tree, lookup cost is proportional to
+ * the key length, not to log(n) full key comparisons: a shared
+ * key prefix is traversed once instead of being re-compared on
+ * every tree level. Inner nodes adapt their fan-out (4, 16, 48
+ * or 256 children) to the actual byte distribution and compress
+ * single-child paths into node prefixes, which keeps the tree
+ * shallow and memory proportional to the stored keys.
+ *
+ * Keys must be prefix-free: no stored key may be a proper prefix
+ * of another stored key. A caller storing arbitrary strings gets
+ * this by including a terminating zero byte in the key.
+ *
+ * Iteration visits keys in lexicographic byte order, so the
+ * structure can serve ordered scans and prefix scans.
+ */
+
+struct art_node;
+
+struct art
+{
+	/** Tree root, NULL for an empty tree. */
+	struct art_node *root;
+	/** Number of stored keys. */
+	uint64_t size;
+};
+
+/**
+ * Iteration callback. A non-zero return value stops the
+ * iteration and is passed through to the caller.
+ */
+typedef int
+(*art_cb)(void *ctx, const unsigned char *key, uint32_t key_len, void *value);
+
+/**
+ * Initialize an empty tree.
+ */
+void
+art_create(struct art *tree);
+
+/**
+ * Free all tree nodes. Stored values are not touched.
+ */
+void
+art_destroy(struct art *tree);
+
+/**
+ * Insert a key with a value. If the key is already stored, its
+ * value is replaced and the old value is returned in @a
+ * old_value (set to NULL for a new key).
+ * @retval  0 on success.
+ * @retval -1 on memory allocation error, the tree is unchanged.
+ */
+int
+art_insert(struct art *tree, const unsigned char *key, uint32_t key_len,
+	   void *value, void **old_value);
+
+/**
+ * Find a key.
+ * @retval the stored value, or NULL if the key is not stored.
+ */
+void *
+art_find(const struct art *tree, const unsigned char *key, uint32_t key_len);
+
+/**
+ * Delete a key.
+ * @retval the removed value, or NULL if the key is not stored.
+ */
+void *
+art_remove(struct art *tree, const unsigned char *key, uint32_t key_len);
+
+/**
+ * Call @a cb for every stored key in lexicographic order.
+ * @retval 0, or the first non-zero callback return value.
+ */
+int
+art_iter(const struct art *tree, art_cb cb, void *ctx);
+
+/**
+ * Call @a cb for every stored key beginning with @a prefix, in
+ * lexicographic order.
+ * @retval 0, or the first non-zero callback return value.
+ */
+int
+art_iter_prefix(const struct art *tree, const unsigned char *prefix,
+		uint32_t prefix_len, art_cb cb, void *ctx);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_LIB_SALAD_ART_H_INCLUDED */
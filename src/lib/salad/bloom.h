@@ -120,6 +120,18 @@ bloom_add(struct bloom *bloom, bloom_hash_t hash);
 static bool
 bloom_maybe_has(const struct bloom *bloom, bloom_hash_t hash);
 
+/**
+ * Prefetch the cache line that bloom_maybe_has() with the same
+ * hash is going to access. All bits of a value live in one
+ * block, so a single prefetch hides the whole miss. Useful when
+ * several filters are probed one after another: prefetch the
+ * blocks of all of them first, then do the probes.
+ * @param bloom - the bloom filter
+ * @param hash - hash of the value
+ */
+static void
+bloom_prefetch(const struct bloom *bloom, bloom_hash_t hash);
+
 /**
  * Return the expected false positive rate of a bloom filter.
  * @param bloom - the bloom filter
@@ -182,6 +194,13 @@ bloom_add(struct bloom *bloom, bloom_hash_t hash)
 	}
 }
 
+static inline void
+bloom_prefetch(const struct bloom *bloom, bloom_hash_t hash)
+{
+	bloom_hash_t pos = hash % bloom->table_size;
+	__builtin_prefetch(bloom->table + pos, 0);
+}
+
 static inline bool
 bloom_maybe_has(const struct bloom *bloom, bloom_hash_t hash)
 {
@@ -136,6 +136,7 @@
  *                      alloc_ctx);
  * void bps_tree_destroy(tree);
  * int bps_tree_build(tree, sorted_array, array_size);
+ * int bps_tree_build_filled(tree, sorted_array, array_size, fill_percent);
  * bps_tree_elem_t *bps_tree_find(tree, key);
  * int bps_tree_insert(tree, new_elem, replaced_elem);
  * int bps_tree_insert_get_iterator(tree, new_elem, replaced_elem,
@@ -293,6 +294,30 @@
 #error "BPS_TREE_IS_IDENTICAL must be defined"
 #endif
 
+/**
+ * Optional support for inline comparison hints. If elements and
+ * keys carry a fixed-size binary-comparable prefix of the value
+ * (a hint), define BPS_TREE_ELEM_HINT(elem) and
+ * BPS_TREE_KEY_HINT(key) to extract it and BPS_TREE_HINT_NONE
+ * to the value meaning "no hint". Block search then orders a
+ * probe by the inline hints alone and calls the comparator only
+ * when the hints tie, so most descent comparisons never touch
+ * the data behind the element. The hints must agree with the
+ * comparator: whenever two distinct hints are compared, the
+ * comparator must give the same order. If that only holds for
+ * some tree instances, define BPS_TREE_HINTS_ORDERED(arg) to
+ * test it at runtime (it defaults to always true).
+ */
+#if defined(BPS_TREE_ELEM_HINT) != defined(BPS_TREE_KEY_HINT)
+#error "BPS_TREE_ELEM_HINT and BPS_TREE_KEY_HINT come together"
+#endif
+#if defined(BPS_TREE_ELEM_HINT) && !defined(BPS_TREE_HINT_NONE)
+#error "BPS_TREE_HINT_NONE must be defined along with BPS_TREE_ELEM_HINT"
+#endif
+#if defined(BPS_TREE_ELEM_HINT) && !defined(BPS_TREE_HINTS_ORDERED)
+#define BPS_TREE_HINTS_ORDERED(arg) true
+#endif
+
 /**
  * A switch to define the type of search in an array elements.
  * By default, bps_tree uses binary search to find a particular
@@ -370,6 +395,7 @@ typedef uint32_t bps_tree_block_id_t;
 
 #define bps_tree_create _api_name(create)
 #define bps_tree_build _api_name(build)
+#define bps_tree_build_filled _api_name(build_filled)
 #define bps_tree_destroy _api_name(destroy)
 #define bps_tree_find _api_name(find)
 #define bps_tree_insert _api_name(insert)
@@ -607,6 +633,24 @@ static inline int
 bps_tree_build(struct bps_tree *tree, bps_tree_elem_t *sorted_array,
 	       size_t array_size);
 
+/**
+ * @brief Same as bps_tree_build(), but packs blocks up to the
+ *  given fill factor instead of as tightly as possible. Leaving
+ *  some free room in the blocks makes inserts right after the
+ *  build cheaper - a tightly packed tree splits a block on
+ *  nearly every insert.
+ * @param tree - pointer to a tree
+ * @param sorted_array - pointer to the sorted array
+ * @param array_size - size of the array (count of elements)
+ * @param fill_percent - target block fill factor, in percent,
+ *  must be in range [75, 100] so that the blocks stay above
+ *  the 2/3 occupancy invariant checked by bps_tree_debug_check()
+ * @return 0 on success, -1 on memory error
+ */
+static inline int
+bps_tree_build_filled(struct bps_tree *tree, bps_tree_elem_t *sorted_array,
+		      size_t array_size, unsigned fill_percent);
+
 /**
  * @brief Tree destruction. Frees allocated memory.
  * @param tree - pointer to a tree
@@ -1116,21 +1160,38 @@ bps_tree_create(struct bps_tree *tree, bps_tree_arg_t arg,
 static inline int
 bps_tree_build(struct bps_tree *tree, bps_tree_elem_t *sorted_array,
 	       size_t array_size)
+{
+	return bps_tree_build_filled(tree, sorted_array, array_size, 100);
+}
+
+static inline int
+bps_tree_build_filled(struct bps_tree *tree, bps_tree_elem_t *sorted_array,
+		      size_t array_size, unsigned fill_percent)
 {
 	assert(tree->size == 0);
 	assert(tree->root_id == (bps_tree_block_id_t)(-1));
 	assert(tree->garbage_head_id == (bps_tree_block_id_t)(-1));
 	assert(tree->matras.head.block_count == 0);
+	assert(fill_percent >= 75 && fill_percent <= 100);
 	if (array_size == 0)
 		return 0;
-	bps_tree_block_id_t leaf_count = (array_size +
-		BPS_TREE_MAX_COUNT_IN_LEAF - 1) / BPS_TREE_MAX_COUNT_IN_LEAF;
+	/*
+	 * Target block capacities. The elements are distributed
+	 * between the blocks of a level evenly, so these only
+	 * determine the block count of each level; no block may
+	 * end up packed above the target.
+	 */
+	bps_tree_block_id_t leaf_fill = BPS_TREE_MAX_COUNT_IN_LEAF *
+					fill_percent / 100;
+	bps_tree_block_id_t inner_fill = BPS_TREE_MAX_COUNT_IN_INNER *
+					 fill_percent / 100;
+	bps_tree_block_id_t leaf_count = (array_size + leaf_fill - 1) /
+					 leaf_fill;
 
 	bps_tree_block_id_t depth = 1;
 	bps_tree_block_id_t level_count = leaf_count;
 	while (level_count > 1) {
-		level_count = (level_count + BPS_TREE_MAX_COUNT_IN_INNER - 1)
-			      / BPS_TREE_MAX_COUNT_IN_INNER;
+		level_count = (level_count + inner_fill - 1) / inner_fill;
 		depth++;
 	}
 
@@ -1141,8 +1202,7 @@ bps_tree_build(struct bps_tree *tree, bps_tree_elem_t *sorted_array,
 	level_count = leaf_count;
 	for (bps_tree_block_id_t i = 0; i < depth - 1; i++) {
 		level_child_count[i] = level_count;
-		level_count = (level_count + BPS_TREE_MAX_COUNT_IN_INNER - 1)
-			      / BPS_TREE_MAX_COUNT_IN_INNER;
+		level_count = (level_count + inner_fill - 1) / inner_fill;
 		level_block_count[i] = level_count;
 		parents[i] = 0;
 	}
@@ -1372,9 +1432,24 @@ bps_tree_find_ins_point_key(const struct bps_tree *tree, bps_tree_elem_t *arr,
 	}
 	return (bps_tree_pos_t)(begin - arr);
 #else
+#ifdef BPS_TREE_ELEM_HINT
+	uint64_t target_hint = BPS_TREE_KEY_HINT(key);
+	bool hinted = BPS_TREE_HINTS_ORDERED(tree->arg) &&
+		      target_hint != BPS_TREE_HINT_NONE;
+#endif
 	while (begin != end) {
 		bps_tree_elem_t *mid = begin + (end - begin) / 2;
-		int res = BPS_TREE_COMPARE_KEY(*mid, key, tree->arg);
+		int res;
+#ifdef BPS_TREE_ELEM_HINT
+		uint64_t mid_hint = BPS_TREE_ELEM_HINT(*mid);
+		if (hinted && mid_hint != BPS_TREE_HINT_NONE &&
+		    mid_hint != target_hint)
+			res = mid_hint < target_hint ? -1 : 1;
+		else
+			res = BPS_TREE_COMPARE_KEY(*mid, key, tree->arg);
+#else
+		res = BPS_TREE_COMPARE_KEY(*mid, key, tree->arg);
+#endif
 		if (res > 0) {
 			end = mid;
 		} else if (res < 0) {
@@ -1417,9 +1492,24 @@ bps_tree_find_ins_point_elem(const struct bps_tree *tree, bps_tree_elem_t *arr,
 	}
 	return (bps_tree_pos_t)(begin - arr);
 #else
+#ifdef BPS_TREE_ELEM_HINT
+	uint64_t target_hint = BPS_TREE_ELEM_HINT(elem);
+	bool hinted = BPS_TREE_HINTS_ORDERED(tree->arg) &&
+		      target_hint != BPS_TREE_HINT_NONE;
+#endif
 	while (begin != end) {
 		bps_tree_elem_t *mid = begin + (end - begin) / 2;
-		int res = BPS_TREE_COMPARE(*mid, elem, tree->arg);
+		int res;
+#ifdef BPS_TREE_ELEM_HINT
+		uint64_t mid_hint = BPS_TREE_ELEM_HINT(*mid);
+		if (hinted && mid_hint != BPS_TREE_HINT_NONE &&
+		    mid_hint != target_hint)
+			res = mid_hint < target_hint ? -1 : 1;
+		else
+			res = BPS_TREE_COMPARE(*mid, elem, tree->arg);
+#else
+		res = BPS_TREE_COMPARE(*mid, elem, tree->arg);
+#endif
 		if (res > 0) {
 			end = mid;
 		} else if (res < 0) {
@@ -1464,9 +1554,24 @@ bps_tree_find_after_ins_point_key(const struct bps_tree *tree,
 	}
 	return (bps_tree_pos_t)(begin - arr);
 #else
+#ifdef BPS_TREE_ELEM_HINT
+	uint64_t target_hint = BPS_TREE_KEY_HINT(key);
+	bool hinted = BPS_TREE_HINTS_ORDERED(tree->arg) &&
+		      target_hint != BPS_TREE_HINT_NONE;
+#endif
 	while (begin != end) {
 		bps_tree_elem_t *mid = begin + (end - begin) / 2;
-		int res = BPS_TREE_COMPARE_KEY(*mid, key, tree->arg);
+		int res;
+#ifdef BPS_TREE_ELEM_HINT
+		uint64_t mid_hint = BPS_TREE_ELEM_HINT(*mid);
+		if (hinted && mid_hint != BPS_TREE_HINT_NONE &&
+		    mid_hint != target_hint)
+			res = mid_hint < target_hint ? -1 : 1;
+		else
+			res = BPS_TREE_COMPARE_KEY(*mid, key, tree->arg);
+#else
+		res = BPS_TREE_COMPARE_KEY(*mid, key, tree->arg);
+#endif
 		if (res > 0) {
 			end = mid;
 		} else if (res < 0) {
@@ -1510,9 +1615,24 @@ bps_tree_find_after_ins_point_elem(const struct bps_tree *tree,
 	}
 	return (bps_tree_pos_t)(begin - arr);
 #else
+#ifdef BPS_TREE_ELEM_HINT
+	uint64_t target_hint = BPS_TREE_ELEM_HINT(elem);
+	bool hinted = BPS_TREE_HINTS_ORDERED(tree->arg) &&
+		      target_hint != BPS_TREE_HINT_NONE;
+#endif
 	while (begin != end) {
 		bps_tree_elem_t *mid = begin + (end - begin) / 2;
-		int res = BPS_TREE_COMPARE(*mid, elem, tree->arg);
+		int res;
+#ifdef BPS_TREE_ELEM_HINT
+		uint64_t mid_hint = BPS_TREE_ELEM_HINT(*mid);
+		if (hinted && mid_hint != BPS_TREE_HINT_NONE &&
+		    mid_hint != target_hint)
+			res = mid_hint < target_hint ? -1 : 1;
+		else
+			res = BPS_TREE_COMPARE(*mid, elem, tree->arg);
+#else
+		res = BPS_TREE_COMPARE(*mid, elem, tree->arg);
+#endif
 		if (res > 0) {
 			end = mid;
 		} else if (res < 0) {
@@ -2258,6 +2378,17 @@ bps_tree_collect_path(struct bps_tree *tree, bps_tree_elem_t new_elem,
 {
 	*exact = false;
 
+	/*
+	 * Append fast path: when the new element is greater than
+	 * the tree maximum, the insertion point is the rightmost
+	 * position of every level and no per-level search is
+	 * needed. A single comparison thus replaces the whole
+	 * comparison-driven descent, which makes bulk loading in
+	 * key order nearly descent-free.
+	 */
+	bool is_append = tree->size > 0 &&
+		BPS_TREE_COMPARE(new_elem, tree->max_elem, tree->arg) > 0;
+
 	struct bps_inner_path_elem *prev_ext = 0;
 	bps_tree_pos_t prev_pos = 0;
 	struct bps_block *block = bps_tree_root(tree);
@@ -2268,7 +2399,7 @@ bps_tree_collect_path(struct bps_tree *tree, bps_tree_elem_t new_elem,
 	for (bps_tree_block_id_t i = 0; i < tree->depth - 1; i++) {
 		struct bps_inner *inner = (struct bps_inner *)block;
 		bps_tree_pos_t pos;
-		if (*exact)
+		if (is_append || *exact)
 			pos = inner->header.size - 1;
 		else
 			pos = bps_tree_find_ins_point_elem(tree, inner->elems,
@@ -2297,7 +2428,9 @@ bps_tree_collect_path(struct bps_tree *tree, bps_tree_elem_t new_elem,
 
 	struct bps_leaf *leaf = (struct bps_leaf *)block;
 	bps_tree_pos_t pos;
-	if (*exact)
+	if (is_append)
+		pos = leaf->header.size;
+	else if (*exact)
 		pos = leaf->header.size - 1;
 	else
 		pos = bps_tree_find_ins_point_elem(tree, leaf->elems,
@@ -6095,6 +6228,7 @@ bps_tree_debug_check_internal_functions(bool assertme)
 
 #undef bps_tree_create
 #undef bps_tree_build
+#undef bps_tree_build_filled
 #undef bps_tree_destroy
 #undef bps_tree_find
 #undef bps_tree_insert
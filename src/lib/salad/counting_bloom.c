@@ -0,0 +1,158 @@
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "counting_bloom.h"
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+
+enum {
+	/* Number of counters in a block */
+	COUNTING_BLOOM_BLOCK_COUNTERS = COUNTING_BLOOM_CACHE_LINE *
+		CHAR_BIT / COUNTING_BLOOM_COUNTER_BITS,
+};
+
+static inline unsigned
+counter_get(const struct counting_bloom_block *block, bloom_hash_t no)
+{
+	unsigned char byte = block->counters[no / 2];
+	return no % 2 == 0 ? byte & 0xf : byte >> 4;
+}
+
+static inline void
+counter_set(struct counting_bloom_block *block, bloom_hash_t no, unsigned val)
+{
+	assert(val <= COUNTING_BLOOM_COUNTER_MAX);
+	unsigned char *byte = &block->counters[no / 2];
+	if (no % 2 == 0)
+		*byte = (*byte & 0xf0) | val;
+	else
+		*byte = (*byte & 0x0f) | (val << 4);
+}
+
+int
+counting_bloom_create(struct counting_bloom *bloom, uint32_t number_of_values,
+		      double false_positive_rate)
+{
+	/* Optimal hash_count and counter count calculation */
+	uint16_t hash_count = ceil(log(false_positive_rate) / log(0.5));
+	uint64_t counter_count = ceil(number_of_values * hash_count / log(2));
+	uint32_t block_count = (counter_count + COUNTING_BLOOM_BLOCK_COUNTERS
+				- 1) / COUNTING_BLOOM_BLOCK_COUNTERS;
+
+	bloom->table = calloc(block_count, sizeof(*bloom->table));
+	if (bloom->table == NULL)
+		return -1;
+
+	bloom->table_size = block_count;
+	bloom->hash_count = hash_count;
+	return 0;
+}
+
+void
+counting_bloom_destroy(struct counting_bloom *bloom)
+{
+	free(bloom->table);
+}
+
+void
+counting_bloom_add(struct counting_bloom *bloom, bloom_hash_t hash)
+{
+	/* Using lower part of the hash for finding a block */
+	bloom_hash_t pos = hash % bloom->table_size;
+	struct counting_bloom_block *block = &bloom->table[pos];
+	hash = hash / bloom->table_size;
+	/* Split the given hash into independent lower and high parts. */
+	bloom_hash_t hash2 = hash / COUNTING_BLOOM_BLOCK_COUNTERS + 1;
+	for (bloom_hash_t i = 0; i < bloom->hash_count; i++) {
+		bloom_hash_t no = hash % COUNTING_BLOOM_BLOCK_COUNTERS;
+		unsigned val = counter_get(block, no);
+		/* A saturated counter sticks at the maximum. */
+		if (val < COUNTING_BLOOM_COUNTER_MAX)
+			counter_set(block, no, val + 1);
+		/* Combine two hashes to create required number of hashes */
+		/* Add i**2 for better distribution */
+		hash += hash2 + i * i;
+	}
+}
+
+void
+counting_bloom_remove(struct counting_bloom *bloom, bloom_hash_t hash)
+{
+	bloom_hash_t pos = hash % bloom->table_size;
+	struct counting_bloom_block *block = &bloom->table[pos];
+	hash = hash / bloom->table_size;
+	bloom_hash_t hash2 = hash / COUNTING_BLOOM_BLOCK_COUNTERS + 1;
+	for (bloom_hash_t i = 0; i < bloom->hash_count; i++) {
+		bloom_hash_t no = hash % COUNTING_BLOOM_BLOCK_COUNTERS;
+		unsigned val = counter_get(block, no);
+		/* The value must have been added before. */
+		assert(val > 0);
+		/*
+		 * A saturated counter cannot be decremented: it is
+		 * unknown how many values hashed into it.
+		 */
+		if (val > 0 && val < COUNTING_BLOOM_COUNTER_MAX)
+			counter_set(block, no, val - 1);
+		hash += hash2 + i * i;
+	}
+}
+
+bool
+counting_bloom_maybe_has(const struct counting_bloom *bloom, bloom_hash_t hash)
+{
+	bloom_hash_t pos = hash % bloom->table_size;
+	const struct counting_bloom_block *block = &bloom->table[pos];
+	hash = hash / bloom->table_size;
+	bloom_hash_t hash2 = hash / COUNTING_BLOOM_BLOCK_COUNTERS + 1;
+	for (bloom_hash_t i = 0; i < bloom->hash_count; i++) {
+		bloom_hash_t no = hash % COUNTING_BLOOM_BLOCK_COUNTERS;
+		if (counter_get(block, no) == 0)
+			return false;
+		hash += hash2 + i * i;
+	}
+	return true;
+}
+
+double
+counting_bloom_fpr(const struct counting_bloom *bloom,
+		   uint32_t number_of_values)
+{
+	/* Number of hash functions. */
+	uint16_t k = bloom->hash_count;
+	/* Number of counters. */
+	uint64_t m = (uint64_t)bloom->table_size *
+		COUNTING_BLOOM_BLOCK_COUNTERS;
+	/* Number of elements. */
+	uint32_t n = number_of_values;
+	/* False positive rate. */
+	return pow(1 - exp((double) -k * n / m), k);
+}
@@ -0,0 +1,164 @@
+#ifndef TARANTOOL_LIB_SALAD_COUNTING_BLOOM_H_INCLUDED
+#define TARANTOOL_LIB_SALAD_COUNTING_BLOOM_H_INCLUDED
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Counting variant of the bloom filter from bloom.h: every bit is
+ * replaced with a 4-bit saturating counter, which makes deletion
+ * possible and so lets the filter be maintained incrementally
+ * instead of being rebuilt from scratch whenever the data set
+ * shrinks.
+ *
+ * The layout and hashing scheme are the same as in bloom.h: all
+ * counters of a value live in one cache-line-sized block, and the
+ * per-value counter positions are derived from a single 32-bit
+ * hash. A filter created with the same number_of_values and
+ * false_positive_rate as a plain bloom filter has the same false
+ * positive rate, at four times the memory cost.
+ *
+ * A counter that reaches its maximum value sticks there forever:
+ * it is never decremented, because it is unknown how many values
+ * actually hashed into it. Sticky counters can only inflate the
+ * false positive rate, never cause a false negative, and with
+ * 4-bit counters the probability of saturation is negligible for
+ * any realistic load.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <limits.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+enum {
+	/* Expected cache line of target processor */
+	COUNTING_BLOOM_CACHE_LINE = 64,
+	/* Counter width, bits */
+	COUNTING_BLOOM_COUNTER_BITS = 4,
+	/* Maximal (sticky) counter value */
+	COUNTING_BLOOM_COUNTER_MAX =
+		(1 << COUNTING_BLOOM_COUNTER_BITS) - 1,
+};
+
+typedef uint32_t bloom_hash_t;
+
+/**
+ * Cache-line-size block of counters
+ */
+struct counting_bloom_block {
+	unsigned char counters[COUNTING_BLOOM_CACHE_LINE];
+};
+
+/**
+ * Counting bloom filter data structure
+ */
+struct counting_bloom {
+	/* Number of buckets (blocks) in the table */
+	uint32_t table_size;
+	/* Number of hash function per value */
+	uint16_t hash_count;
+	/* Counter table */
+	struct counting_bloom_block *table;
+};
+
+/* {{{ API declaration */
+
+/**
+ * Allocate and initialize an instance of counting bloom filter
+ *
+ * @param bloom - structure to initialize
+ * @param number_of_values - estimated number of values to be added
+ * @param false_positive_rate - desired false positive rate
+ * @return 0 - OK, -1 - memory error
+ */
+int
+counting_bloom_create(struct counting_bloom *bloom, uint32_t number_of_values,
+		      double false_positive_rate);
+
+/**
+ * Free resources of the counting bloom filter
+ *
+ * @param bloom - the bloom filter
+ */
+void
+counting_bloom_destroy(struct counting_bloom *bloom);
+
+/**
+ * Add a value into the data set
+ * @param bloom - the bloom filter
+ * @param hash - hash of the value
+ */
+void
+counting_bloom_add(struct counting_bloom *bloom, bloom_hash_t hash);
+
+/**
+ * Remove a value from the data set. The value must have been
+ * added before: removing a value that is not in the data set can
+ * introduce false negatives for other values.
+ * @param bloom - the bloom filter
+ * @param hash - hash of the value
+ */
+void
+counting_bloom_remove(struct counting_bloom *bloom, bloom_hash_t hash);
+
+/**
+ * Query for presence of a value in the data set
+ * @param bloom - the bloom filter
+ * @param hash - hash of the value
+ * @return true - the value could be in data set; false - the value is
+ *  definitively not in data set
+ */
+bool
+counting_bloom_maybe_has(const struct counting_bloom *bloom,
+			 bloom_hash_t hash);
+
+/**
+ * Return the expected false positive rate of a counting bloom
+ * filter.
+ * @param bloom - the bloom filter
+ * @param number_of_values - number of values stored in the filter
+ * @return - expected false positive rate
+ */
+double
+counting_bloom_fpr(const struct counting_bloom *bloom,
+		   uint32_t number_of_values);
+
+/* }}} API declaration */
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_LIB_SALAD_COUNTING_BLOOM_H_INCLUDED */
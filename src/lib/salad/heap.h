@@ -92,6 +92,16 @@
 #error "HEAP_LESS must be defined"
 #endif
 
+/**
+ * Number of children per heap node. Optional, defaults to 2.
+ * Must be a power of two. With 4 or 8 all children of a node fit
+ * into one cache line of the node pointer array, trading more
+ * comparisons per level for fewer cache misses on large heaps.
+ */
+#ifndef HEAP_ARITY
+#define HEAP_ARITY 2
+#endif
+
 /** Structure, stored in the heap. */
 #ifndef heap_value_t
 #error "heap_value_t must be defined"
@@ -290,6 +300,7 @@ HEAP(check)(heap_t *heap);
 static inline void
 HEAP(create)(heap_t *heap)
 {
+	assert((HEAP_ARITY & (HEAP_ARITY - 1)) == 0);
 	heap->size = 0;
 	heap->capacity = 0;
 	heap->harr = NULL;
@@ -326,7 +337,7 @@ HEAP(update_link)(heap_t *heap, heap_off_t pos)
 static inline void
 HEAP(sift_up)(heap_t *heap, struct heap_node *node)
 {
-	heap_off_t curr_pos = node->pos, parent = (curr_pos - 1) / 2;
+	heap_off_t curr_pos = node->pos, parent = (curr_pos - 1) / HEAP_ARITY;
 
 	while (curr_pos > 0 && HEAP_LESS(heap, node_to_value(node),
 					 node_to_value(heap->harr[parent]))) {
@@ -338,7 +349,7 @@ HEAP(sift_up)(heap_t *heap, struct heap_node *node)
 		HEAP(update_link)(heap, parent);
 
 		curr_pos = parent;
-		parent = (curr_pos - 1) / 2;
+		parent = (curr_pos - 1) / HEAP_ARITY;
 		/* here overflow can occure, but that won't affect */
 	}
 }
@@ -349,20 +360,24 @@ HEAP(sift_up)(heap_t *heap, struct heap_node *node)
 static inline void
 HEAP(sift_down)(heap_t *heap, struct heap_node *node)
 {
-	heap_off_t curr_pos = node->pos, left, right;
-	heap_off_t min_child;
+	heap_off_t curr_pos = node->pos;
 
 	while (true) {
-		left = 2 * curr_pos + 1;
-		right = 2 * curr_pos + 2;
-		min_child = left;
-		if (right < heap->size &&
-		    HEAP_LESS(heap, node_to_value(heap->harr[right]),
-			      node_to_value(heap->harr[left])))
-			min_child = right;
-
-		if (left >= heap->size ||
-		    HEAP_LESS(heap, node_to_value(heap->harr[curr_pos]),
+		heap_off_t first_child = HEAP_ARITY * curr_pos + 1;
+		if (first_child >= heap->size)
+			return;
+		heap_off_t child_end = first_child + HEAP_ARITY;
+		if (child_end > heap->size)
+			child_end = heap->size;
+		heap_off_t min_child = first_child;
+		for (heap_off_t child = first_child + 1;
+		     child < child_end; child++) {
+			if (HEAP_LESS(heap, node_to_value(heap->harr[child]),
+				      node_to_value(heap->harr[min_child])))
+				min_child = child;
+		}
+
+		if (HEAP_LESS(heap, node_to_value(heap->harr[curr_pos]),
 			      node_to_value(heap->harr[min_child])))
 			return;
 
@@ -474,7 +489,7 @@ HEAP(update_all)(heap_t *heap)
 		return;
 
 	/* Find the parent of the last element. */
-	heap_off_t curr_pos = (heap->size - 2) / 2;
+	heap_off_t curr_pos = (heap->size - 2) / HEAP_ARITY;
 
 	do {
 		HEAP(sift_down)(heap, heap->harr[curr_pos]);
@@ -508,22 +523,21 @@ HEAP(iterator_next)(struct heap_iterator *it)
 static inline int
 HEAP(check)(heap_t *heap)
 {
-	heap_off_t left, right, min_child;
 	for (heap_off_t curr_pos = 0;
-	     2 * curr_pos + 1 < heap->size;
+	     HEAP_ARITY * curr_pos + 1 < heap->size;
 	     ++curr_pos) {
 
-		left = 2 * curr_pos + 1;
-		right = 2 * curr_pos + 2;
-		min_child = left;
-		if (right < heap->size &&
-		    HEAP_LESS(heap, node_to_value(heap->harr[right]),
-			      node_to_value(heap->harr[left])))
-			min_child = right;
-
-		if (HEAP_LESS(heap, node_to_value(heap->harr[min_child]),
-			      node_to_value(heap->harr[curr_pos])))
-			return -1;
+		heap_off_t first_child = HEAP_ARITY * curr_pos + 1;
+		heap_off_t child_end = first_child + HEAP_ARITY;
+		if (child_end > heap->size)
+			child_end = heap->size;
+
+		for (heap_off_t child = first_child;
+		     child < child_end; child++) {
+			if (HEAP_LESS(heap, node_to_value(heap->harr[child]),
+				      node_to_value(heap->harr[curr_pos])))
+				return -1;
+		}
 	}
 
 	return 0;
@@ -533,6 +547,7 @@ HEAP(check)(heap_t *heap)
 #undef value_to_node
 #undef heap_value_t
 #undef heap_value_attr
+#undef HEAP_ARITY
 
 #endif /* HEAP_FORWARD_DECLARATION */
 
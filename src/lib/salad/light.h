@@ -236,6 +236,17 @@ LIGHT(find_key)(const struct LIGHT(core) *ht, uint32_t hash, LIGHT_KEY_TYPE data
 static inline uint32_t
 LIGHT(insert)(struct LIGHT(core) *ht, uint32_t hash, LIGHT_DATA_TYPE data);
 
+/**
+ * @brief Grow the hash table up front to fit the given count of records,
+ * splitting all affected chains right away. Subsequent insertions do not
+ * trigger incremental growth until the count is exceeded.
+ * @param ht - pointer to a hash table struct
+ * @param count - expected count of records
+ * @return 0 if ok, -1 on memory error
+ */
+static inline int
+LIGHT(reserve)(struct LIGHT(core) *ht, uint32_t count);
+
 /**
  * @brief Replace a record with given hash and value
  * @param ht - pointer to a hash table struct
@@ -406,10 +417,17 @@ LIGHT(find)(const struct LIGHT(core) *ht, uint32_t hash, LIGHT_DATA_TYPE value)
 	if (record->next == slot)
 		return LIGHT(end);
 	while (1) {
+		uint32_t next = record->next;
+		/*
+		 * Overlap the value dereference of the equality
+		 * check with the fetch of the next chain record.
+		 */
+		if (next != LIGHT(end))
+			__builtin_prefetch(matras_get(&ht->mtable, next));
 		if (record->hash == hash
 		    && LIGHT_EQUAL((record->value), (value), (ht->arg)))
 			return slot;
-		slot = record->next;
+		slot = next;
 		if (slot == LIGHT(end))
 			return LIGHT(end);
 		record = (struct LIGHT(record) *)
@@ -437,10 +455,14 @@ LIGHT(find_key)(const struct LIGHT(core) *ht, uint32_t hash, LIGHT_KEY_TYPE key)
 	if (record->next == slot)
 		return LIGHT(end);
 	while (1) {
+		uint32_t next = record->next;
+		/* See the comment in LIGHT(find). */
+		if (next != LIGHT(end))
+			__builtin_prefetch(matras_get(&ht->mtable, next));
 		if (record->hash == hash &&
 		    LIGHT_EQUAL_KEY((record->value), (key), (ht->arg)))
 			return slot;
-		slot = record->next;
+		slot = next;
 		if (slot == LIGHT(end))
 			return LIGHT(end);
 		record = (struct LIGHT(record) *)
@@ -650,12 +672,14 @@ LIGHT(prepare_first_insert)(struct LIGHT(core) *ht)
 }
 
 /*
- * Enlarge hash table to store more values
+ * Enlarge hash table to store more values.
+ * Usually called when the empty record list is exhausted, but may also
+ * be called with free records present, e.g. from LIGHT(reserve): the
+ * chain split does not depend on the state of the empty list.
  */
 static inline int
 LIGHT(grow)(struct LIGHT(core) *ht)
 {
-	assert(ht->empty_slot == LIGHT(end));
 	uint32_t new_slot;
 	struct LIGHT(record) *new_record = (struct LIGHT(record) *)
 		matras_alloc_range(&ht->mtable, &new_slot, LIGHT_GROW_INCREMENT);
@@ -749,6 +773,28 @@ LIGHT(grow)(struct LIGHT(core) *ht)
 	return 0;
 }
 
+/**
+ * @brief Grow the hash table up front to fit the given count of records,
+ * splitting all affected chains right away. Subsequent insertions do not
+ * trigger incremental growth until the count is exceeded.
+ * @param ht - pointer to a hash table struct
+ * @param count - expected count of records
+ * @return 0 if ok, -1 on memory error
+ */
+static inline int
+LIGHT(reserve)(struct LIGHT(core) *ht, uint32_t count)
+{
+	if (count == 0)
+		return 0;
+	if (ht->table_size == 0)
+		if (LIGHT(prepare_first_insert)(ht))
+			return -1;
+	while (ht->table_size < count)
+		if (LIGHT(grow)(ht))
+			return -1;
+	return 0;
+}
+
 /**
  * @brief Insert a record with given hash and value
  * @param ht - pointer to a hash table struct
@@ -186,6 +186,14 @@ struct rope_node {
 struct rope {
 	/** Top of the tree */
 	struct rope_node *root;
+	/**
+	 * Nodes detached by erase, linked via link[0] and reused
+	 * by the next insert or split instead of going to the
+	 * allocator. Makes erase/insert sequences allocation-free,
+	 * which matters for region-backed ropes where detached
+	 * nodes could not be returned to the allocator at all.
+	 */
+	struct rope_node *free_list;
 	/** Rope context. */
 	rope_ctx_t ctx;
 };
@@ -234,6 +242,7 @@ static inline void
 rope_create(struct rope *rope, rope_ctx_t ctx)
 {
 	rope->root = NULL;
+	rope->free_list = NULL;
 	rope->ctx = ctx;
 }
 
@@ -278,8 +287,15 @@ rope_clear(struct rope *rope)
 		}
 		it = save;
 	}
+	it = rope->free_list;
+	while (it != NULL) {
+		save = it->link[0];
+		ROPE_FREE(rope->ctx, it);
+		it = save;
+	}
 #endif /* ROPE_FREE_F */
 	rope->root = NULL;
+	rope->free_list = NULL;
 }
 
 /** Delete a rope allocated with rope_new() */
@@ -293,8 +309,12 @@ rope_delete(struct rope *rope)
 static inline struct rope_node *
 rope_node_new(struct rope *rope, rope_data_t data, rope_size_t size)
 {
-	struct rope_node *node =
-		(struct rope_node *) ROPE_ALLOC_F(rope->ctx, sizeof(*node));
+	struct rope_node *node = rope->free_list;
+	if (node != NULL)
+		rope->free_list = node->link[0];
+	else
+		node = (struct rope_node *)
+			ROPE_ALLOC_F(rope->ctx, sizeof(*node));
 	if (node == NULL)
 		return NULL;
 	node->height = 1;
@@ -544,7 +564,9 @@ rope_erase(struct rope *rope, rope_size_t offset)
 		direction = node->link[0] == NULL;
 	}
 	**p_end = node->link[direction];
-	ROPE_FREE(rope->ctx, node);
+	/* Keep the node for reuse by the next insert or split. */
+	node->link[0] = rope->free_list;
+	rope->free_list = node;
 	avl_rebalance_after_delete((struct avl_node ***) path,
 				   (struct avl_node ***) p_end);
 	return 0;
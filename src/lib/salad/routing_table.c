@@ -0,0 +1,168 @@
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "routing_table.h"
+#include "guava.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+	/** An unassigned slot marker used during rebalance. */
+	ROUTING_SLOT_FREE = UINT32_MAX,
+};
+
+/**
+ * Sum up backend weights - the virtual slot count of the map.
+ */
+static uint32_t
+routing_weight_sum(const uint32_t *weights, uint32_t backend_count)
+{
+	uint32_t sum = 0;
+	for (uint32_t i = 0; i < backend_count; i++)
+		sum += weights[i];
+	return sum;
+}
+
+/**
+ * Hand out unassigned slots to backends that still have weight
+ * quota left, one slot per backend per round, so that every
+ * backend's slots end up spread over the slot array.
+ */
+static void
+routing_assign_free(uint32_t *slots, uint32_t slot_count, uint32_t *quota,
+		    uint32_t backend_count)
+{
+	uint32_t backend = 0;
+	for (uint32_t s = 0; s < slot_count; s++) {
+		if (slots[s] != ROUTING_SLOT_FREE)
+			continue;
+		while (quota[backend] == 0)
+			backend = (backend + 1) % backend_count;
+		slots[s] = backend;
+		quota[backend]--;
+		backend = (backend + 1) % backend_count;
+	}
+}
+
+int
+routing_table_create(struct routing_table *table, const uint32_t *weights,
+		     uint32_t backend_count)
+{
+	assert(backend_count > 0);
+	uint32_t slot_count = routing_weight_sum(weights, backend_count);
+	assert(slot_count > 0);
+	uint32_t *slots = malloc(slot_count * sizeof(*slots));
+	uint32_t *own_weights = malloc(backend_count * sizeof(*own_weights));
+	uint32_t *quota = malloc(backend_count * sizeof(*quota));
+	if (slots == NULL || own_weights == NULL || quota == NULL) {
+		free(slots);
+		free(own_weights);
+		free(quota);
+		return -1;
+	}
+	memcpy(own_weights, weights, backend_count * sizeof(*own_weights));
+	memcpy(quota, weights, backend_count * sizeof(*quota));
+	memset(slots, 0xff, slot_count * sizeof(*slots));
+	routing_assign_free(slots, slot_count, quota, backend_count);
+	free(quota);
+	table->backend_count = backend_count;
+	table->slot_count = slot_count;
+	table->generation = 0;
+	table->slots = slots;
+	table->weights = own_weights;
+	return 0;
+}
+
+void
+routing_table_destroy(struct routing_table *table)
+{
+	free(table->slots);
+	free(table->weights);
+}
+
+uint32_t
+routing_table_route(const struct routing_table *table, uint64_t hash)
+{
+	return table->slots[guava(hash, (int32_t)table->slot_count)];
+}
+
+int64_t
+routing_table_rebalance(struct routing_table *table, const uint32_t *weights,
+			uint32_t backend_count)
+{
+	assert(backend_count > 0);
+	uint32_t slot_count = routing_weight_sum(weights, backend_count);
+	assert(slot_count > 0);
+	uint32_t *slots = malloc(slot_count * sizeof(*slots));
+	uint32_t *own_weights = malloc(backend_count * sizeof(*own_weights));
+	uint32_t *quota = malloc(backend_count * sizeof(*quota));
+	if (slots == NULL || own_weights == NULL || quota == NULL) {
+		free(slots);
+		free(own_weights);
+		free(quota);
+		return -1;
+	}
+	memcpy(own_weights, weights, backend_count * sizeof(*own_weights));
+	memcpy(quota, weights, backend_count * sizeof(*quota));
+	/*
+	 * Keep a surviving slot on its old backend while the
+	 * backend still exists and has quota under the new
+	 * weights. Everything else is handed out below.
+	 */
+	uint32_t common = table->slot_count < slot_count ?
+			  table->slot_count : slot_count;
+	for (uint32_t s = 0; s < slot_count; s++) {
+		uint32_t old = s < common ? table->slots[s] :
+			       ROUTING_SLOT_FREE;
+		if (old != ROUTING_SLOT_FREE && old < backend_count &&
+		    quota[old] > 0) {
+			slots[s] = old;
+			quota[old]--;
+		} else {
+			slots[s] = ROUTING_SLOT_FREE;
+		}
+	}
+	routing_assign_free(slots, slot_count, quota, backend_count);
+	free(quota);
+	int64_t moved = 0;
+	for (uint32_t s = 0; s < common; s++)
+		moved += slots[s] != table->slots[s];
+	moved += slot_count > common ? slot_count - common : 0;
+	free(table->slots);
+	free(table->weights);
+	table->backend_count = backend_count;
+	table->slot_count = slot_count;
+	table->slots = slots;
+	table->weights = own_weights;
+	table->generation++;
+	return moved;
+}
@@ -0,0 +1,110 @@
+#ifndef TARANTOOL_LIB_SALAD_ROUTING_TABLE_H_INCLUDED
+#define TARANTOOL_LIB_SALAD_ROUTING_TABLE_H_INCLUDED
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * Weighted consistent-hash routing table.
+ *
+ * A table maps a key hash to one of N backends via jump
+ * consistent hash (see guava.h) over an array of virtual slots.
+ * Every backend owns as many slots as its integer weight, so
+ * routing a key costs one guava() call plus one array load - no
+ * allocation and no tree walk on the hot path.
+ *
+ * On rebalance the slot array is recomputed to match the new
+ * weights while keeping as many slots as possible on their old
+ * backend, so only the minimal share of keys changes ownership.
+ * Every rebalance bumps @a generation, which lets a consumer
+ * detect a stale copy of the map.
+ *
+ * The structure is plain flat arrays of fixed-width integers on
+ * purpose: it can be read directly from Lua through FFI without
+ * callbacks or accessors.
+ */
+struct routing_table {
+	/** Number of backends. */
+	uint32_t backend_count;
+	/** Number of virtual slots, the sum of all weights. */
+	uint32_t slot_count;
+	/** Map version, incremented by every rebalance. */
+	uint64_t generation;
+	/** Slot to backend id map, slot_count entries. */
+	uint32_t *slots;
+	/** Backend weights, backend_count entries. */
+	uint32_t *weights;
+};
+
+/**
+ * Create a routing table over @a backend_count backends with the
+ * given integer @a weights. The weight sum must be positive; a
+ * zero weight is allowed and means a drained backend.
+ * @retval  0 on success.
+ * @retval -1 on memory allocation error.
+ */
+int
+routing_table_create(struct routing_table *table, const uint32_t *weights,
+		     uint32_t backend_count);
+
+/**
+ * Free a routing table.
+ */
+void
+routing_table_destroy(struct routing_table *table);
+
+/**
+ * Route a key @a hash to a backend id. Stable for a given
+ * generation of the map.
+ */
+uint32_t
+routing_table_route(const struct routing_table *table, uint64_t hash);
+
+/**
+ * Recompute the table for a new backend/weight set. Slots that can
+ * stay on their old backend do, so the number of reassigned slots -
+ * and hence the share of keys that move - is minimal.
+ * @retval >= 0 the number of slots whose backend changed.
+ * @retval -1 on memory allocation error, the table is unchanged.
+ */
+int64_t
+routing_table_rebalance(struct routing_table *table, const uint32_t *weights,
+			uint32_t backend_count);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_LIB_SALAD_ROUTING_TABLE_H_INCLUDED */
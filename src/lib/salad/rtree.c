@@ -33,6 +33,7 @@
 #include <assert.h>
 #include <limits.h>
 #include <stddef.h>
+#include <stdlib.h>
 #include <sys/types.h>
 
 /*------------------------------------------------------------------------- */
@@ -1006,6 +1007,170 @@ rtree_insert(struct rtree *tree, struct rtree_rect *rect, record_t obj)
 	tree->n_records++;
 }
 
+/* Reference to a bulk loaded item, used to order a tree level */
+struct rtree_bulk_key {
+	/* Center of the item rectangle along the sort axis (doubled) */
+	coord_t center;
+	/* Position of the item in the level arrays */
+	uint32_t pos;
+};
+
+static int
+rtree_bulk_key_cmp(const void *a, const void *b)
+{
+	coord_t ca = ((const struct rtree_bulk_key *)a)->center;
+	coord_t cb = ((const struct rtree_bulk_key *)b)->center;
+	return ca < cb ? -1 : ca > cb ? 1 : 0;
+}
+
+int
+rtree_bulk_load(struct rtree *tree, const coord_t *coords, record_t *records,
+		unsigned count)
+{
+	assert(tree->root == NULL && tree->n_records == 0);
+	if (count == 0)
+		return 0;
+	unsigned d2 = tree->dimension * 2;
+	unsigned max_fill = tree->page_max_fill;
+	unsigned min_fill = tree->page_min_fill;
+	int rc = -1;
+	/*
+	 * The order of items within a level is tracked by an index
+	 * array, so the (potentially large) caller arrays are never
+	 * moved around.
+	 */
+	struct rtree_bulk_key *keys = malloc(count * sizeof(*keys));
+	/*
+	 * Covers and pointers of the pages packed on the previous
+	 * level become the items of the next one. A level contains
+	 * at most ceil(count / max_fill) pages; two buffers are
+	 * enough since a level only reads the previous one.
+	 */
+	unsigned level_max = (count + max_fill - 1) / max_fill;
+	coord_t *covers[2] = {NULL, NULL};
+	void **pages[2] = {NULL, NULL};
+	covers[0] = malloc(level_max * d2 * sizeof(coord_t));
+	covers[1] = malloc(level_max * d2 * sizeof(coord_t));
+	pages[0] = malloc(level_max * sizeof(void *));
+	pages[1] = malloc(level_max * sizeof(void *));
+	if (keys == NULL || covers[0] == NULL || covers[1] == NULL ||
+	    pages[0] == NULL || pages[1] == NULL)
+		goto cleanup;
+
+	const coord_t *cur_coords = coords;
+	void *const *cur_data = (void *const *)records;
+	unsigned cur_n = count;
+	unsigned height = 0;
+	int buf = 0;
+	for (;;) {
+		/* Order the level by center along the first axis. */
+		for (unsigned i = 0; i < cur_n; i++) {
+			const coord_t *r = &cur_coords[i * d2];
+			keys[i].center = r[0] + r[1];
+			keys[i].pos = i;
+		}
+		qsort(keys, cur_n, sizeof(*keys), rtree_bulk_key_cmp);
+		unsigned n_pages = (cur_n + max_fill - 1) / max_fill;
+		if (tree->dimension > 1 && n_pages > 1) {
+			/*
+			 * Tile the first axis into about
+			 * sqrt(n_pages) slices and order each slice
+			 * along the second axis, so page covers come
+			 * out roughly square rather than long thin
+			 * stripes.
+			 */
+			unsigned n_slices = 1;
+			while (n_slices * n_slices < n_pages)
+				n_slices++;
+			unsigned slice_len = n_slices * max_fill;
+			for (unsigned s = 0; s < cur_n; s += slice_len) {
+				unsigned len = cur_n - s < slice_len ?
+					       cur_n - s : slice_len;
+				for (unsigned i = s; i < s + len; i++) {
+					const coord_t *r =
+						&cur_coords[keys[i].pos * d2];
+					keys[i].center = r[2] + r[3];
+				}
+				qsort(&keys[s], len, sizeof(*keys),
+				      rtree_bulk_key_cmp);
+			}
+		}
+		/* Pack the level into pages in the chosen order. */
+		coord_t *next_coords = covers[buf];
+		void **next_data = pages[buf];
+		buf ^= 1;
+		unsigned next_n = 0;
+		unsigned i = 0;
+		while (i < cur_n) {
+			unsigned left = cur_n - i;
+			/*
+			 * Take max_fill items per page, but never
+			 * leave the last page of a level with less
+			 * than min_fill items.
+			 */
+			unsigned fill = left <= max_fill ? left :
+					left - max_fill < min_fill ?
+					left - min_fill : max_fill;
+			struct rtree_page *pg = rtree_page_alloc(tree);
+			if (pg == NULL) {
+				/*
+				 * Free the subtrees built so far so
+				 * that the tree is left empty.
+				 */
+				for (unsigned j = 0; j < next_n; j++)
+					rtree_page_purge(tree, next_data[j],
+							 height + 1);
+				if (height > 0) {
+					for (; i < cur_n; i++)
+						rtree_page_purge(tree,
+							cur_data[keys[i].pos],
+							height);
+				}
+				tree->n_pages = 0;
+				goto cleanup;
+			}
+			tree->n_pages++;
+			pg->n = fill;
+			for (unsigned j = 0; j < fill; j++, i++) {
+				struct rtree_page_branch *b =
+					rtree_branch_get(tree, pg, j);
+				unsigned pos = keys[i].pos;
+				rtree_rect_copy(&b->rect,
+						(const struct rtree_rect *)
+						&cur_coords[pos * d2],
+						tree->dimension);
+				if (height == 0)
+					b->data.record = cur_data[pos];
+				else
+					b->data.page = cur_data[pos];
+			}
+			rtree_page_cover(tree, pg, (struct rtree_rect *)
+					 &next_coords[next_n * d2]);
+			next_data[next_n++] = pg;
+		}
+		height++;
+		if (next_n == 1) {
+			tree->root = next_data[0];
+			break;
+		}
+		cur_coords = next_coords;
+		cur_data = next_data;
+		cur_n = next_n;
+	}
+	assert(height <= RTREE_MAX_HEIGHT);
+	tree->height = height;
+	tree->n_records = count;
+	tree->version++;
+	rc = 0;
+cleanup:
+	free(keys);
+	free(covers[0]);
+	free(covers[1]);
+	free(pages[0]);
+	free(pages[1]);
+	return rc;
+}
+
 bool
 rtree_remove(struct rtree *tree, const struct rtree_rect *rect, record_t obj)
 {
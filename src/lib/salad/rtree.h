@@ -275,6 +275,26 @@ rtree_search(const struct rtree *tree, const struct rtree_rect *rect,
 void
 rtree_insert(struct rtree *tree, struct rtree_rect *rect, record_t obj);
 
+/**
+ * @brief Load records into an empty tree with sort-tile-recursive packing
+ *
+ * Orders the records spatially, packs them into full leaf pages and
+ * builds the upper levels on top of those, which is much faster than
+ * a sequence of rtree_insert() calls and produces a tree with better
+ * page utilization and less overlap between page covers.
+ *
+ * @return 0 on success, -1 on memory allocation error; on error the
+ *  tree is left empty
+ * @param tree - pointer to an empty tree
+ * @param coords - coordinates of the record rectangles, 2 * dimension
+ *  per record, laid out as in rtree_rect
+ * @param records - array of records to load
+ * @param count - number of records to load
+ */
+int
+rtree_bulk_load(struct rtree *tree, const coord_t *coords, record_t *records,
+		unsigned count);
+
 /**
  * @brief Remove the record from a tree
  * @return true if the record deleted (false otherwise)
@@ -47,6 +47,15 @@ enum {
 	 * round.
 	 */
 	TASKS_PER_SCHEDULER = 16,
+	/**
+	 * How many packets a scheduler is allowed to send or
+	 * receive per one event loop wakeup. One packet per wakeup
+	 * is too slow on big clusters - each wakeup costs a whole
+	 * loop iteration with all its watchers. On the other hand
+	 * the batch can't be unlimited, or a long output queue
+	 * would starve the rest of the loop.
+	 */
+	PACKETS_PER_WAKEUP = 8,
 };
 
 /**
@@ -526,19 +535,21 @@ static void
 swim_on_encrypted_output(struct ev_loop *loop, struct ev_io *io, int events)
 {
 	struct swim_scheduler *scheduler = (struct swim_scheduler *) io->data;
-	const struct sockaddr_in *dst;
-	struct swim_task *task = swim_begin_send(scheduler, loop, io, events,
-						 &dst);
-	if (task == NULL)
-		return;
-	char *buf = static_alloc(UDP_PACKET_SIZE);
-	assert(buf != NULL);
-	ssize_t size = swim_encrypt(scheduler->codec, task->packet.buf,
-				    task->packet.pos - task->packet.buf,
-				    buf, UDP_PACKET_SIZE);
-	if (size > 0)
-		size = swim_do_send(scheduler, buf, size, dst);
-	swim_complete_send(scheduler, task, size);
+	for (int i = 0; i < PACKETS_PER_WAKEUP; ++i) {
+		const struct sockaddr_in *dst;
+		struct swim_task *task = swim_begin_send(scheduler, loop, io,
+							 events, &dst);
+		if (task == NULL)
+			return;
+		char *buf = static_alloc(UDP_PACKET_SIZE);
+		assert(buf != NULL);
+		ssize_t size = swim_encrypt(scheduler->codec, task->packet.buf,
+					    task->packet.pos - task->packet.buf,
+					    buf, UDP_PACKET_SIZE);
+		if (size > 0)
+			size = swim_do_send(scheduler, buf, size, dst);
+		swim_complete_send(scheduler, task, size);
+	}
 }
 
 /**
@@ -548,14 +559,17 @@ static void
 swim_on_plain_output(struct ev_loop *loop, struct ev_io *io, int events)
 {
 	struct swim_scheduler *scheduler = (struct swim_scheduler *) io->data;
-	const struct sockaddr_in *dst;
-	struct swim_task *task = swim_begin_send(scheduler, loop, io, events,
-						 &dst);
-	if (task == NULL)
-		return;
-	ssize_t size = swim_do_send(scheduler, task->packet.buf,
-				    task->packet.pos - task->packet.buf, dst);
-	swim_complete_send(scheduler, task, size);
+	for (int i = 0; i < PACKETS_PER_WAKEUP; ++i) {
+		const struct sockaddr_in *dst;
+		struct swim_task *task = swim_begin_send(scheduler, loop, io,
+							 events, &dst);
+		if (task == NULL)
+			return;
+		ssize_t size = swim_do_send(scheduler, task->packet.buf,
+					    task->packet.pos - task->packet.buf,
+					    dst);
+		swim_complete_send(scheduler, task, size);
+	}
 }
 
 /**
@@ -664,14 +678,18 @@ swim_on_encrypted_input(struct ev_loop *loop, struct ev_io *io, int events)
 	char buf[UDP_PACKET_SIZE];
 	swim_begin_recv(scheduler, loop, io, events);
 
-	char *ibuf = static_alloc(UDP_PACKET_SIZE);
-	assert(ibuf != NULL);
-	ssize_t size = swim_do_recv(scheduler, ibuf, UDP_PACKET_SIZE);
-	if (size > 0) {
-		size = swim_decrypt(scheduler->codec, ibuf, size,
-				    buf, UDP_PACKET_SIZE);
+	for (int i = 0; i < PACKETS_PER_WAKEUP; ++i) {
+		char *ibuf = static_alloc(UDP_PACKET_SIZE);
+		assert(ibuf != NULL);
+		ssize_t size = swim_do_recv(scheduler, ibuf, UDP_PACKET_SIZE);
+		if (size > 0) {
+			size = swim_decrypt(scheduler->codec, ibuf, size,
+					    buf, UDP_PACKET_SIZE);
+		}
+		swim_complete_recv(scheduler, buf, size);
+		if (size <= 0)
+			return;
 	}
-	swim_complete_recv(scheduler, buf, size);
 }
 
 /** On a new EV_READ event receive a packet from the network. */
@@ -681,8 +699,12 @@ swim_on_plain_input(struct ev_loop *loop, struct ev_io *io, int events)
 	struct swim_scheduler *scheduler = (struct swim_scheduler *) io->data;
 	char buf[UDP_PACKET_SIZE];
 	swim_begin_recv(scheduler, loop, io, events);
-	ssize_t size = swim_do_recv(scheduler, buf, UDP_PACKET_SIZE);
-	swim_complete_recv(scheduler, buf, size);
+	for (int i = 0; i < PACKETS_PER_WAKEUP; ++i) {
+		ssize_t size = swim_do_recv(scheduler, buf, UDP_PACKET_SIZE);
+		swim_complete_recv(scheduler, buf, size);
+		if (size <= 0)
+			return;
+	}
 }
 
 int
@@ -40,6 +40,17 @@
 extern "C" {
 #endif /* defined(__cplusplus) */
 
+/**
+ * A parsed URI. Deliberately non-allocating: every component is a
+ * (pointer, length) pair referencing the string given to
+ * uri_parse(), so parsing costs no heap traffic and the struct can
+ * live on the stack or in static buffers on per-request paths.
+ * Consequently the caller must keep the source string alive for as
+ * long as the struct is in use, components are not NUL-terminated,
+ * and percent-encoded octets are left as-is - decode or copy only
+ * when a component is actually consumed. Use uri_format() when a
+ * materialized, NUL-terminated representation is needed.
+ */
 struct uri {
 	const char *scheme;
 	size_t scheme_len;
@@ -64,9 +75,24 @@ struct uri {
 #define URI_MAXHOST NI_MAXHOST
 #define URI_MAXSERVICE _POSIX_PATH_MAX /* _POSIX_PATH_MAX always > NI_MAXSERV */
 
+/**
+ * Parse @a str into @a uri without copying: the components point
+ * into @a str, see the struct uri comment for the lifetime rules.
+ *
+ * @retval 0  success
+ * @retval -1 @a str is not a valid URI
+ */
 int
 uri_parse(struct uri *uri, const char *str);
 
+/**
+ * Write a NUL-terminated textual representation of @a uri into
+ * the buffer @a str of size @a len. The only materializing
+ * counterpart of uri_parse().
+ *
+ * @return the number of bytes the full representation needs,
+ *         not counting the terminating NUL (snprintf semantics).
+ */
 int
 uri_format(char *str, int len, const struct uri *uri, bool write_password);
 
@@ -31,6 +31,7 @@
 #include "tt_uuid.h"
 
 #include <msgpuck.h>
+#include <clock.h>
 #include <random.h>
 #include <trivia/config.h>
 #include "tt_static.h"
@@ -41,6 +42,35 @@ const struct tt_uuid uuid_nil;
 #define CT_ASSERT(e) typedef char __ct_assert_##__LINE__[(e) ? 1 : -1]
 CT_ASSERT(sizeof(struct tt_uuid) == UUID_LEN);
 
+enum {
+	/** How many UUIDs worth of entropy to buffer per refill. */
+	UUID_RAND_POOL_SIZE = 64 * UUID_LEN,
+};
+
+/**
+ * Entropy pool: one random_bytes() call refills 64 UUIDs worth
+ * of bytes instead of going to the entropy source per UUID. Used
+ * from the tx thread only, the same assumption the global state
+ * in lib/core/random.c makes.
+ */
+static char uuid_rand_pool[UUID_RAND_POOL_SIZE];
+static size_t uuid_rand_pos = UUID_RAND_POOL_SIZE;
+
+static void
+uuid_rand_bytes(char *buf, size_t size)
+{
+	if (size > UUID_RAND_POOL_SIZE) {
+		random_bytes(buf, size);
+		return;
+	}
+	if (uuid_rand_pos + size > UUID_RAND_POOL_SIZE) {
+		random_bytes(uuid_rand_pool, UUID_RAND_POOL_SIZE);
+		uuid_rand_pos = 0;
+	}
+	memcpy(buf, uuid_rand_pool + uuid_rand_pos, size);
+	uuid_rand_pos += size;
+}
+
 #if defined(HAVE_UUIDGEN)
 #include <sys/uuid.h>
 
@@ -51,20 +81,52 @@ tt_uuid_create(struct tt_uuid *uu)
 {
 	uuidgen((struct uuid *) uu, 1); /* syscall */
 }
+
+void
+tt_uuid_create_batch(struct tt_uuid *uu, uint32_t count)
+{
+	uuidgen((struct uuid *) uu, count); /* one syscall per batch */
+}
 #else
 
 void
 tt_uuid_create(struct tt_uuid *uu)
 {
-	random_bytes((char *) uu, sizeof(*uu));
+	uuid_rand_bytes((char *) uu, sizeof(*uu));
 
 	uu->clock_seq_hi_and_reserved &= 0x3f;
 	uu->clock_seq_hi_and_reserved |= 0x80; /* variant 1 = RFC4122 */
 	uu->time_hi_and_version &= 0x0FFF;
 	uu->time_hi_and_version |= (4 << 12);  /* version 4 = random */
 }
+
+void
+tt_uuid_create_batch(struct tt_uuid *uu, uint32_t count)
+{
+	uuid_rand_bytes((char *) uu, (size_t) count * UUID_LEN);
+	for (uint32_t i = 0; i < count; i++) {
+		uu[i].clock_seq_hi_and_reserved &= 0x3f;
+		uu[i].clock_seq_hi_and_reserved |= 0x80;
+		uu[i].time_hi_and_version &= 0x0FFF;
+		uu[i].time_hi_and_version |= (4 << 12);
+	}
+}
 #endif
 
+void
+tt_uuid_create_v7(struct tt_uuid *uu)
+{
+	uuid_rand_bytes((char *) uu, sizeof(*uu));
+
+	uint64_t ms = clock_realtime64() / 1000000;
+	uu->time_low = ms >> 16;
+	uu->time_mid = ms & 0xffff;
+	uu->clock_seq_hi_and_reserved &= 0x3f;
+	uu->clock_seq_hi_and_reserved |= 0x80; /* variant 1 = RFC4122 */
+	uu->time_hi_and_version &= 0x0FFF;
+	uu->time_hi_and_version |= (7 << 12);  /* version 7 = time-ordered */
+}
+
 extern inline int
 tt_uuid_validate(struct tt_uuid *uu);
 
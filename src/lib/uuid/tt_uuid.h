@@ -62,6 +62,27 @@ struct tt_uuid {
 void
 tt_uuid_create(struct tt_uuid *uu);
 
+/**
+ * \brief Generate a batch of new UUIDs with one draw from the
+ * entropy source instead of one per UUID.
+ * \param uu[out] array of \a count UUIDs
+ * \param count number of UUIDs to generate
+ */
+void
+tt_uuid_create_batch(struct tt_uuid *uu, uint32_t count);
+
+/**
+ * \brief Generate a time-ordered UUID (RFC 9562 version 7): the
+ * top 48 bits are a millisecond Unix timestamp, the rest is
+ * random. Such UUIDs generated on one instance are ordered by
+ * creation time under tt_uuid_compare(), so using them as a
+ * primary key turns random index inserts into append-ordered
+ * ones.
+ * \param uu[out] UUID
+ */
+void
+tt_uuid_create_v7(struct tt_uuid *uu);
+
 inline int
 tt_uuid_validate(struct tt_uuid *uu)
 {
@@ -72,6 +93,21 @@ tt_uuid_validate(struct tt_uuid *uu)
 	return 0;
 }
 
+/**
+ * \brief Decode a hex digit, -1 if \a c is not one.
+ */
+static inline int
+tt_uuid_hex_digit(char c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
+
 /**
  * \brief Parse UUID from string.
  * \param in string
@@ -81,14 +117,32 @@ tt_uuid_validate(struct tt_uuid *uu)
 inline int
 tt_uuid_from_string(const char *in, struct tt_uuid *uu)
 {
-	if (strlen(in) != UUID_STR_LEN ||
-	    sscanf(in, "%8x-%4hx-%4hx-%2hhx%2hhx-%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx",
-		   &uu->time_low, &uu->time_mid, &uu->time_hi_and_version,
-		   &uu->clock_seq_hi_and_reserved, &uu->clock_seq_low,
-		   &uu->node[0], &uu->node[1], &uu->node[2], &uu->node[3],
-		   &uu->node[4], &uu->node[5]) != 11)
+	/*
+	 * A single pass over the string instead of strlen() +
+	 * sscanf(): two hex digits per byte with dashes at the
+	 * RFC 4122 positions.
+	 */
+	unsigned char b[UUID_LEN];
+	int pos = 0;
+	for (int i = 0; i < UUID_LEN; i++) {
+		if ((i == 4 || i == 6 || i == 8 || i == 10) &&
+		    in[pos++] != '-')
+			return 1;
+		int hi = tt_uuid_hex_digit(in[pos]);
+		int lo = tt_uuid_hex_digit(in[pos + 1]);
+		if (hi < 0 || lo < 0)
+			return 1;
+		b[i] = hi << 4 | lo;
+		pos += 2;
+	}
+	if (in[pos] != '\0')
 		return 1;
-
+	uu->time_low = (uint32_t)b[0] << 24 | b[1] << 16 | b[2] << 8 | b[3];
+	uu->time_mid = b[4] << 8 | b[5];
+	uu->time_hi_and_version = b[6] << 8 | b[7];
+	uu->clock_seq_hi_and_reserved = b[8];
+	uu->clock_seq_low = b[9];
+	memcpy(uu->node, &b[10], 6);
 	return tt_uuid_validate(uu);
 }
 
@@ -130,11 +184,28 @@ tt_uuid_compare(const struct tt_uuid *a, const struct tt_uuid *b)
 inline void
 tt_uuid_to_string(const struct tt_uuid *uu, char *out)
 {
-	snprintf(out, UUID_STR_LEN + 1,
-		"%08x-%04x-%04x-%02x%02x-%02x%02x%02x%02x%02x%02x",
-		uu->time_low, uu->time_mid, uu->time_hi_and_version,
-		uu->clock_seq_hi_and_reserved, uu->clock_seq_low, uu->node[0],
-		uu->node[1], uu->node[2], uu->node[3], uu->node[4], uu->node[5]);
+	/* Two table lookups per byte beat snprintf() formatting. */
+	const char *hex = "0123456789abcdef";
+	unsigned char b[UUID_LEN];
+	b[0] = uu->time_low >> 24;
+	b[1] = uu->time_low >> 16;
+	b[2] = uu->time_low >> 8;
+	b[3] = uu->time_low;
+	b[4] = uu->time_mid >> 8;
+	b[5] = uu->time_mid;
+	b[6] = uu->time_hi_and_version >> 8;
+	b[7] = uu->time_hi_and_version;
+	b[8] = uu->clock_seq_hi_and_reserved;
+	b[9] = uu->clock_seq_low;
+	memcpy(&b[10], uu->node, 6);
+	int pos = 0;
+	for (int i = 0; i < UUID_LEN; i++) {
+		if (i == 4 || i == 6 || i == 8 || i == 10)
+			out[pos++] = '-';
+		out[pos++] = hex[b[i] >> 4];
+		out[pos++] = hex[b[i] & 0xf];
+	}
+	out[pos] = '\0';
 }
 
 /**
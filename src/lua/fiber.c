@@ -297,6 +297,17 @@ lbox_fiber_statof(struct fiber *f, void *cb_ctx, bool backtrace)
 	lua_pushnumber(L, region_total(&f->gc) + f->stack_size +
 		       sizeof(struct fiber));
 	lua_settable(L, -3);
+	/*
+	 * Hit stats of the region slab retention policy, see
+	 * fiber_gc(): gc cycles which kept the slabs vs cycles
+	 * which released them to the thread slab cache.
+	 */
+	lua_pushstring(L, "gc_retained");
+	lua_pushnumber(L, f->gc_retain_count);
+	lua_settable(L, -3);
+	lua_pushstring(L, "gc_released");
+	lua_pushnumber(L, f->gc_release_count);
+	lua_settable(L, -3);
 	lua_settable(L, -3);
 
 	if (backtrace) {
@@ -439,6 +450,24 @@ lbox_fiber_info(struct lua_State *L)
 	return 1;
 }
 
+/**
+ * Return fiber stack pool statistics of the tx thread.
+ */
+static int
+lbox_fiber_stack_stat(struct lua_State *L)
+{
+	lua_createtable(L, 0, 4);
+	lua_pushnumber(L, cord()->stack_created);
+	lua_setfield(L, -2, "created");
+	lua_pushnumber(L, cord()->stack_reused);
+	lua_setfield(L, -2, "reused");
+	lua_pushnumber(L, cord()->stack_reclaimed);
+	lua_setfield(L, -2, "reclaimed");
+	lua_pushnumber(L, cord()->dead_size);
+	lua_setfield(L, -2, "cached");
+	return 1;
+}
+
 static int
 lua_fiber_run_f(MAYBE_UNUSED va_list ap)
 {
@@ -608,6 +637,58 @@ lbox_fiber_name(struct lua_State *L)
 	}
 }
 
+static const char *fiber_priority_strs[] = {"low", "normal", "high", NULL};
+
+/**
+ * Get or set the scheduling class of a fiber. Works both as a
+ * module function for the current fiber and as a fiber object
+ * method: fiber.priority('high'), fiber_object:priority().
+ */
+static int
+lbox_fiber_priority(struct lua_State *L)
+{
+	struct fiber *f = fiber();
+	int prio_index = 1;
+	if (lua_type(L, 1) == LUA_TUSERDATA) {
+		f = lbox_checkfiber(L, 1);
+		prio_index = 2;
+	}
+	if (lua_gettop(L) >= prio_index) {
+		/* Set priority. */
+		int prio = luaL_checkoption(L, prio_index, NULL,
+					    fiber_priority_strs);
+		fiber_set_priority(f, (enum fiber_priority)prio);
+		return 0;
+	} else {
+		lua_pushstring(L, fiber_priority_strs[f->priority]);
+		return 1;
+	}
+}
+
+/**
+ * Return per-class scheduling delay histograms of the tx thread.
+ * A class table maps a bucket lower bound in microseconds to the
+ * number of wakeup-to-run delays which hit the bucket.
+ */
+static int
+lbox_fiber_sched_stat(struct lua_State *L)
+{
+	lua_createtable(L, 0, FIBER_PRIO_MAX);
+	for (int prio = 0; prio < FIBER_PRIO_MAX; prio++) {
+		lua_newtable(L);
+		for (int i = 0; i < FIBER_SCHED_DELAY_BUCKETS; i++) {
+			int64_t count = cord()->sched_delay[prio][i];
+			if (count == 0)
+				continue;
+			lua_pushnumber(L, (double)(1ULL << i));
+			lua_pushnumber(L, count);
+			lua_settable(L, -3);
+		}
+		lua_setfield(L, -2, fiber_priority_strs[prio]);
+	}
+	return 1;
+}
+
 /**
  * Trigger invoked when the fiber has stopped execution of its
  * current request. Only purpose - delete storage.lua.ref keeping
@@ -851,6 +932,7 @@ lbox_fiber_stall(struct lua_State *L)
 static const struct luaL_Reg lbox_fiber_meta [] = {
 	{"id", lbox_fiber_id},
 	{"name", lbox_fiber_name},
+	{"priority", lbox_fiber_priority},
 	{"cancel", lbox_fiber_cancel},
 	{"status", lbox_fiber_status},
 	{"testcancel", lbox_fiber_testcancel},
@@ -865,6 +947,7 @@ static const struct luaL_Reg lbox_fiber_meta [] = {
 
 static const struct luaL_Reg fiberlib[] = {
 	{"info", lbox_fiber_info},
+	{"stack_stat", lbox_fiber_stack_stat},
 #if ENABLE_FIBER_TOP
 	{"top", lbox_fiber_top},
 	{"top_enable", lbox_fiber_top_enable},
@@ -885,6 +968,8 @@ static const struct luaL_Reg fiberlib[] = {
 	{"new", lbox_fiber_new},
 	{"status", lbox_fiber_status},
 	{"name", lbox_fiber_name},
+	{"priority", lbox_fiber_priority},
+	{"sched_stat", lbox_fiber_sched_stat},
 	/* Internal functions, to hide in fiber.lua. */
 	{"stall", lbox_fiber_stall},
 	{NULL, NULL}
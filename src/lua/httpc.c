@@ -388,6 +388,8 @@ luaT_httpc_stat(lua_State *L)
 			ctx->stat.http_other_responses);
 	lua_add_key_u64(L, "failed_requests",
 			(uint64_t) ctx->stat.failed_requests);
+	lua_add_key_u64(L, "total_connections",
+			ctx->stat.total_connections);
 
 	return 1;
 }
@@ -402,7 +404,9 @@ luaT_httpc_new(lua_State *L)
 
 	long max_conns = luaL_checklong(L, 1);
 	long max_total_conns = luaL_checklong(L, 2);
-	if (httpc_env_create(ctx, max_conns, max_total_conns) != 0)
+	long max_host_conns = luaL_checklong(L, 3);
+	if (httpc_env_create(ctx, max_conns, max_total_conns,
+			     max_host_conns) != 0)
 		return luaT_error(L);
 
 	luaL_getmetatable(L, DRIVER_LUA_UDATA_NAME);
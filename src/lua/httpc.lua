@@ -32,6 +32,8 @@
 local driver = package.loaded.http.client
 package.loaded.http = nil
 
+local fiber = require('fiber')
+
 local curl_mt
 
 --
@@ -41,6 +43,8 @@ local curl_mt
 --
 --  max_connections -  Maximum number of entries in the connection cache
 --  max_total_connections -  Maximum number of active connections
+--  max_host_connections -  Maximum number of active connections
+--                          to a single host
 --
 --  Returns:
 --  curl object or raise error()
@@ -52,8 +56,10 @@ local http_new = function(opts)
 
     opts.max_connections = opts.max_connections or -1
     opts.max_total_connections = opts.max_total_connections or 0
+    opts.max_host_connections = opts.max_host_connections or 0
 
-    local curl = driver.new(opts.max_connections, opts.max_total_connections)
+    local curl = driver.new(opts.max_connections, opts.max_total_connections,
+                            opts.max_host_connections)
     return setmetatable({ curl = curl, }, curl_mt )
 end
 
@@ -327,6 +333,50 @@ curl_mt = {
             return resp
         end,
 
+        --
+        --  <batch_request> - run several requests concurrently.
+        --
+        --  Parameters:
+        --
+        --  requests - an array of requests, each one an array of
+        --      the request() arguments: {method, url[, body[,
+        --      opts]]}.
+        --
+        --  The requests are issued in parallel fibers, so
+        --  requests to the same host share its keepalive
+        --  connections and multiplex over HTTP/2 where the
+        --  server supports it, instead of running one after
+        --  another.
+        --
+        --  Returns an array of the same size as <requests>:
+        --  response tables in the matching order. An error
+        --  raised by a request is reported in its response slot
+        --  as {status = 595, reason = <error message>}.
+        --
+        batch_request = function(self, requests)
+            check_args(self, 'batch_request')
+            if type(requests) ~= 'table' then
+                error('batch_request({{method, url[, body[, options]]}, ...})')
+            end
+            local responses = {}
+            local channel = fiber.channel(#requests)
+            for i, req in ipairs(requests) do
+                fiber.create(function()
+                    local ok, resp = pcall(self.request, self, req[1], req[2],
+                                           req[3], req[4])
+                    if not ok then
+                        resp = {status = 595, reason = tostring(resp)}
+                    end
+                    responses[i] = resp
+                    channel:put(true)
+                end)
+            end
+            for _ = 1, #requests do
+                channel:get()
+            end
+            return responses
+        end,
+
         --
         -- <get> - see <request>
         --
@@ -425,6 +475,11 @@ curl_mt = {
         --  failed_requests - this is a total number of requests which have
         --      failed (included systeme erros, curl errors, HTTP
         --      errors and so on)
+        --
+        --  total_connections -
+        --      this is a total number of connections libcurl had
+        --      to open; compare with total_requests to see how
+        --      well the keepalive connection cache performs
         --  }
         --  or error()
         --
@@ -446,7 +501,8 @@ local function http_default_wrap(fname)
 end
 
 for _, name in ipairs({ 'get', 'delete', 'trace', 'options', 'head',
-                     'connect', 'post', 'put', 'patch', 'request'}) do
+                     'connect', 'post', 'put', 'patch', 'request',
+                     'batch_request'}) do
     this_module[name] = http_default_wrap(name)
 end
 
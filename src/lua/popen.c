@@ -52,7 +52,7 @@
 static const char *popen_handle_uname = "popen_handle";
 static const char *popen_handle_closed_uname = "popen_handle_closed";
 
-#define POPEN_LUA_READ_BUF_SIZE        4096
+#define POPEN_LUA_READ_BUF_SIZE        65536
 #define POPEN_LUA_WAIT_DELAY           0.1
 #define POPEN_LUA_ENV_CAPACITY_DEFAULT 256
 
@@ -1810,6 +1810,138 @@ err:
 	return luaT_push_nil_and_error(L);
 }
 
+/**
+ * Copy a child's output stream to a file descriptor.
+ *
+ * @param handle        a handle of a child process
+ * @param fd            destination file descriptor, e.g.
+ *                      socket:fd() or fio handle's fh
+ * @param opts          table of options
+ * @param opts.stdout   whether to copy stdout (default: true)
+ * @param opts.stderr   whether to copy stderr (default: false)
+ * @param opts.limit    stop after copying the given amount of
+ *                      bytes (default: copy until EOF)
+ * @param opts.timeout  time quota in seconds
+ *                      (default: 100 years)
+ *
+ * Move data from the child's stdout or stderr to @a fd until
+ * EOF, @a opts.limit bytes or the timeout. On Linux the data is
+ * spliced between the descriptors inside the kernel without
+ * passing through userspace or the Lua GC, so a popen pipeline
+ * moves data at pipe speed.
+ *
+ * @param opts.stdout and @a opts.stderr are mutually exclusive.
+ *
+ * Raise an error on incorrect parameters or when the fiber is
+ * cancelled:
+ *
+ * - IllegalParams:    incorrect type or value of a parameter.
+ * - IllegalParams:    called on a closed handle.
+ * - IllegalParams:    opts.stdout and opts.stderr are set both.
+ * - IllegalParams:    a requested IO operation is not supported
+ *                     by the handle (stdout / stderr is not
+ *                     piped).
+ * - IllegalParams:    attempt to operate on a closed file
+ *                     descriptor.
+ * - FiberIsCancelled: cancelled by an outside code.
+ *
+ * Return the number of copied bytes on success (zero means EOF
+ * right at the call).
+ *
+ * Return `nil, err` on a failure. Possible reasons:
+ *
+ * - SocketError: an IO error occurs at splice(), read() or
+ *   write().
+ * - TimedOut:    @a opts.timeout quota is exceeded.
+ * - OutOfMemory: no memory space for a copy buffer.
+ */
+static int
+lbox_popen_copy_output(struct lua_State *L)
+{
+	struct popen_handle *handle;
+	bool is_closed;
+	unsigned int flags = POPEN_FLAG_NONE;
+	ev_tstamp timeout = TIMEOUT_INFINITY;
+	size_t limit = 0;
+
+	/* Extract handle and destination fd. */
+	if ((handle = luaT_check_popen_handle(L, 1, &is_closed)) == NULL ||
+	    lua_type(L, 2) != LUA_TNUMBER)
+		goto usage;
+	if (is_closed)
+		return luaT_popen_handle_closed_error(L);
+	int dst_fd = lua_tointeger(L, 2);
+	if (dst_fd < 0)
+		goto usage;
+
+	/* Extract options. */
+	if (!lua_isnoneornil(L, 3)) {
+		if (lua_type(L, 3) != LUA_TTABLE)
+			goto usage;
+
+		lua_getfield(L, 3, "stdout");
+		if (!lua_isnil(L, -1)) {
+			if (lua_type(L, -1) != LUA_TBOOLEAN)
+				goto usage;
+			if (lua_toboolean(L, -1) == 0)
+				flags &= ~POPEN_FLAG_FD_STDOUT;
+			else
+				flags |= POPEN_FLAG_FD_STDOUT;
+		}
+		lua_pop(L, 1);
+
+		lua_getfield(L, 3, "stderr");
+		if (!lua_isnil(L, -1)) {
+			if (lua_type(L, -1) != LUA_TBOOLEAN)
+				goto usage;
+			if (lua_toboolean(L, -1) == 0)
+				flags &= ~POPEN_FLAG_FD_STDERR;
+			else
+				flags |= POPEN_FLAG_FD_STDERR;
+		}
+		lua_pop(L, 1);
+
+		lua_getfield(L, 3, "limit");
+		if (!lua_isnil(L, -1)) {
+			if (lua_type(L, -1) != LUA_TNUMBER ||
+			    lua_tonumber(L, -1) < 0)
+				goto usage;
+			limit = (size_t)lua_tonumber(L, -1);
+		}
+		lua_pop(L, 1);
+
+		lua_getfield(L, 3, "timeout");
+		if (!lua_isnil(L, -1) &&
+		    (timeout = luaT_check_timeout(L, -1)) < 0.0)
+			goto usage;
+		lua_pop(L, 1);
+	}
+
+	/* Copy from stdout by default. */
+	if (!(flags & (POPEN_FLAG_FD_STDOUT | POPEN_FLAG_FD_STDERR)))
+		flags |= POPEN_FLAG_FD_STDOUT;
+
+	ssize_t rc = popen_copy_to_fd(handle, dst_fd, limit, flags, timeout);
+	if (rc < 0)
+		goto err;
+	luaL_pushint64(L, rc);
+	return 1;
+
+usage:
+	diag_set(IllegalParams, "Bad params, use: ph:copy_output(fd[, {"
+		 "stdout = <boolean>, "
+		 "stderr = <boolean>, "
+		 "limit = <number>, "
+		 "timeout = <number>}])");
+	return luaT_error(L);
+err:;
+	struct error *e = diag_last_error(diag_get());
+	if (e->type == &type_IllegalParams ||
+	    e->type == &type_FiberIsCancelled)
+		return luaT_error(L);
+	return luaT_push_nil_and_error(L);
+}
+
 /**
  * Write data to a child peer.
  *
@@ -2503,6 +2635,7 @@ tarantool_lua_popen_init(struct lua_State *L)
 		{"kill",		lbox_popen_kill,	},
 		{"wait",		lbox_popen_wait,	},
 		{"read",		lbox_popen_read,	},
+		{"copy_output",		lbox_popen_copy_output,	},
 		{"write",		lbox_popen_write,	},
 		{"shutdown",		lbox_popen_shutdown,	},
 		{"info",		lbox_popen_info,	},
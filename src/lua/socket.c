@@ -824,7 +824,8 @@ lbox_socket_getaddrinfo(struct lua_State *L)
 	}
 
 	int dns_res = 0;
-	dns_res = coio_getaddrinfo(host, port, &hints, &result, timeout);
+	dns_res = coio_getaddrinfo_cached(host, port, &hints, &result,
+					  timeout);
 	lua_pop(L, 2);	/* host, port */
 
 	if (dns_res != 0) {
@@ -845,7 +846,7 @@ lbox_socket_getaddrinfo(struct lua_State *L)
 
 	int rc = luaT_call(L, 1, 1);
 
-	freeaddrinfo(result);
+	coio_freeaddrinfo(result);
 	if (rc != 0)
 		return luaT_error(L);
 	return 1;
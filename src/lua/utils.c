@@ -35,6 +35,7 @@
 #include <errno.h>
 
 #include <trivia/util.h>
+#include <clock.h>
 #include <diag.h>
 #include <fiber.h>
 
@@ -1325,6 +1326,65 @@ tarantool_lua_utils_init(struct lua_State *L)
  */
 #undef panic
 
+/**
+ * Lua GC pacing at fiber yield points.
+ *
+ * An incremental GC step is normally triggered by an allocation
+ * crossing the memory penalty threshold, so a fiber which
+ * allocates a lot may be charged a multi-millisecond step at an
+ * arbitrary point of its request. Instead, a bounded step is run
+ * each time a fiber yields the tx thread and its allocations
+ * since the previous paced step exceed a quantum: the debt is
+ * paid by the fiber which created it, in small portions, and the
+ * allocation threshold is rarely reached in-between.
+ */
+enum {
+	/** Do not bother stepping for less than this debt, KB. */
+	GC_PACE_DEBT_MIN_KB = 32,
+	/** Upper bound of debt paid by a single step, KB. */
+	GC_PACE_STEP_MAX_KB = 128,
+};
+
+/** Allocated byte count observed at the previous paced step. */
+static GCSize gc_pace_last_total;
+/** Counters behind box.stat.gc(). */
+static uint64_t gc_pace_steps;
+static uint64_t gc_pace_step_time;
+static uint64_t gc_pace_step_time_max;
+
+void
+luaT_gc_pace_stat(uint64_t *steps, uint64_t *step_time,
+		  uint64_t *step_time_max)
+{
+	*steps = gc_pace_steps;
+	*step_time = gc_pace_step_time;
+	*step_time_max = gc_pace_step_time_max;
+}
+
+static void
+gc_pace_step(struct global_State *g)
+{
+	GCSize total = g->gc.total;
+	if (total < gc_pace_last_total) {
+		/* A completed cycle has freed memory, resync. */
+		gc_pace_last_total = total;
+		return;
+	}
+	GCSize debt_kb = (total - gc_pace_last_total) >> 10;
+	if (debt_kb < GC_PACE_DEBT_MIN_KB)
+		return;
+	if (debt_kb > GC_PACE_STEP_MAX_KB)
+		debt_kb = GC_PACE_STEP_MAX_KB;
+	uint64_t start = clock_monotonic64();
+	lua_gc(tarantool_L, LUA_GCSTEP, (int) debt_kb);
+	uint64_t elapsed = clock_monotonic64() - start;
+	gc_pace_steps++;
+	gc_pace_step_time += elapsed;
+	if (elapsed > gc_pace_step_time_max)
+		gc_pace_step_time_max = elapsed;
+	gc_pace_last_total = g->gc.total;
+}
+
 /**
  * This routine encloses the checks and actions to be done when
  * the running fiber yields the execution.
@@ -1385,4 +1445,11 @@ void cord_on_yield(void)
 			g->panic(L);
 		exit(EXIT_FAILURE);
 	}
+
+	/*
+	 * The fiber is known to be neither on a trace nor in a GC
+	 * finalizer here, so this is a safe point to pay its
+	 * share of the collector's work.
+	 */
+	gc_pace_step(g);
 }
@@ -557,6 +557,15 @@ luaT_toibuf(struct lua_State *L, int idx);
 int
 luaT_toerror(lua_State *L);
 
+/**
+ * Retrieve the counters of the incremental Lua GC steps run at
+ * fiber yield points: the total step count, the total time spent
+ * in them and the longest single step, both in nanoseconds.
+ */
+void
+luaT_gc_pace_stat(uint64_t *steps, uint64_t *step_time,
+		  uint64_t *step_time_max);
+
 /**
  * Push Lua Table with __serialize = 'map' hint onto the stack.
  * Tables with __serialize hint are properly handled by all serializers.
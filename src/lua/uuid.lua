@@ -7,6 +7,8 @@ local builtin = ffi.C
 ffi.cdef[[
 void
 tt_uuid_create(struct tt_uuid *uu);
+void
+tt_uuid_create_v7(struct tt_uuid *uu);
 int
 tt_uuid_from_string(const char *in, struct tt_uuid *uu);
 void
@@ -137,6 +139,12 @@ local uuid_new = function()
     return uu
 end
 
+local uuid_new_v7 = function()
+    local uu = ffi.new(uuid_t)
+    builtin.tt_uuid_create_v7(uu)
+    return uu
+end
+
 local uuid_new_bin = function(byteorder)
     local uuidbuf = static_alloc('struct tt_uuid')
     builtin.tt_uuid_create(uuidbuf)
@@ -177,6 +185,7 @@ ffi.metatype(uuid_t, uuid_mt)
 return setmetatable({
     NULL        = builtin.uuid_nil;
     new         = uuid_new;
+    new_v7      = uuid_new_v7; -- time-ordered, for primary keys
     fromstr     = uuid_fromstr;
     frombin     = uuid_frombin;
     bin         = uuid_new_bin;   -- optimized shortcut for new():bin()
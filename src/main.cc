@@ -54,6 +54,8 @@
 #include "cbus.h"
 #include "coio_task.h"
 #include <crc32.h>
+#include <cpu_feature.h>
+#include <third_party/sha1.h>
 #include "memory.h"
 #include <say.h>
 #include <rmean.h>
@@ -61,6 +63,7 @@
 #include "coll/coll.h"
 #include "trivia/util.h"
 #include "backtrace.h"
+#include "profiler.h"
 #include "tt_pthread.h"
 #include "lua/init.h"
 #include "box/box.h"
@@ -693,6 +696,10 @@ main(int argc, char **argv)
 	random_init();
 
 	crc32_init();
+#if defined(HAVE_CPUID) && (defined(__x86_64__) || defined(__i386__))
+	if (sha_ni_enabled_cpu())
+		sha1_transform = sha1_transform_hw;
+#endif
 	memory_init();
 
 	main_argc = argc;
@@ -705,6 +712,13 @@ main(int argc, char **argv)
 	coio_init();
 	coio_enable();
 	signal_init();
+	/*
+	 * The sampling CPU profiler is cheap enough to leave on,
+	 * see box.stat.profiler(). 49 Hz stays out of lockstep
+	 * with common periodic timers.
+	 */
+	if (profiler_start(49) != 0)
+		diag_log();
 	cbus_init();
 	coll_init();
 	memtx_tx_manager_init();
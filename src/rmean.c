@@ -32,6 +32,63 @@
 
 #include "fiber.h"
 
+#include <pmatomic.h>
+#include "small/slab_arena.h"
+
+enum {
+	/**
+	 * The most shard rows an rmean keeps. Threads beyond the
+	 * capacity share the last row with atomic increments - a
+	 * degraded but correct mode no deployment is expected to
+	 * hit.
+	 */
+	RMEAN_SHARD_MAX = 64,
+	/** Shard row alignment, to keep one writer per line. */
+	RMEAN_SHARD_ALIGN = 64,
+};
+
+/**
+ * The shard row index of the calling thread, common for all
+ * rmeans so that a row is assigned once per thread.
+ */
+static __thread int rmean_shard_id = -1;
+static int rmean_shard_count = 0;
+
+static int
+rmean_self_shard(void)
+{
+	if (rmean_shard_id < 0)
+		rmean_shard_id = pm_atomic_fetch_add(&rmean_shard_count, 1);
+	return MIN(rmean_shard_id, RMEAN_SHARD_MAX - 1);
+}
+
+/**
+ * Fold everything the other threads have collected since the
+ * last call into the current second and the totals. Only the
+ * owner cord reads the window, so only it harvests.
+ */
+static void
+rmean_harvest(struct rmean *rmean)
+{
+	assert(cord() == rmean->owner);
+	int rows = MIN(pm_atomic_load(&rmean_shard_count),
+		       (int) RMEAN_SHARD_MAX);
+	for (int s = 0; s < rows; s++) {
+		int64_t *row = rmean->shards + s * rmean->shard_stride;
+		int64_t *mark = rmean->harvested + s * rmean->stats_n;
+		for (size_t i = 0; i < rmean->stats_n; i++) {
+			int64_t count = pm_atomic_load_explicit(
+				&row[i], pm_memory_order_relaxed);
+			int64_t delta = count - mark[i];
+			if (delta == 0)
+				continue;
+			mark[i] = count;
+			rmean->stats[i].value[0] += delta;
+			rmean->stats[i].total += delta;
+		}
+	}
+}
+
 void
 rmean_roll(int64_t *value, double dt)
 {
@@ -56,13 +113,37 @@ rmean_mean(struct rmean *rmean, size_t name)
 	return mean / RMEAN_WINDOW;
 }
 
+int64_t
+rmean_total(struct rmean *rmean, size_t name)
+{
+	rmean_harvest(rmean);
+	return rmean->stats[name].total;
+}
+
 void
 rmean_collect(struct rmean *rmean, size_t name, int64_t value)
 {
 	assert(name < rmean->stats_n);
 
-	rmean->stats[name].value[0] += value;
-	rmean->stats[name].total += value;
+	if (cord() == rmean->owner) {
+		rmean->stats[name].value[0] += value;
+		rmean->stats[name].total += value;
+		return;
+	}
+	int id = rmean_self_shard();
+	int64_t *cell = &rmean->shards[id * rmean->shard_stride + name];
+	if (unlikely(rmean_shard_id >= RMEAN_SHARD_MAX - 1)) {
+		/* The overflow row is shared, see RMEAN_SHARD_MAX. */
+		pm_atomic_fetch_add(cell, value);
+	} else {
+		/*
+		 * This thread is the only writer of the row, a
+		 * plain read is enough; the store has to be atomic
+		 * for the harvesting owner.
+		 */
+		pm_atomic_store_explicit(cell, *cell + value,
+					 pm_memory_order_relaxed);
+	}
 }
 
 int
@@ -92,6 +173,7 @@ rmean_age(ev_loop *loop,
 	double dt = rmean->prev_ts;
 	rmean->prev_ts = ev_monotonic_now(loop);
 	dt = rmean->prev_ts - dt;
+	rmean_harvest(rmean);
 	for (size_t i = 0; i < rmean->stats_n; i++) {
 		if (rmean->stats[i].name == NULL)
 			continue;
@@ -110,6 +192,24 @@ rmean_new(const char **name, size_t n)
 		return NULL;
 	memset(rmean, 0, sizeof(struct rmean) + sizeof(struct stats) * n);
 	rmean->stats_n = n;
+	rmean->owner = cord();
+	rmean->shard_stride = small_align(n * sizeof(int64_t),
+					  RMEAN_SHARD_ALIGN) /
+			      sizeof(int64_t);
+	size_t shards_size = rmean->shard_stride * sizeof(int64_t) *
+			     RMEAN_SHARD_MAX;
+	rmean->shards_alloc = calloc(1, shards_size + RMEAN_SHARD_ALIGN - 1);
+	rmean->harvested = (int64_t *)
+		calloc(RMEAN_SHARD_MAX * n, sizeof(int64_t));
+	if (rmean->shards_alloc == NULL || rmean->harvested == NULL) {
+		free(rmean->shards_alloc);
+		free(rmean->harvested);
+		free(rmean);
+		return NULL;
+	}
+	rmean->shards = (int64_t *)
+		small_align((uintptr_t) rmean->shards_alloc,
+			    RMEAN_SHARD_ALIGN);
 	rmean->timer.data = (void *)rmean;
 	for (size_t i = 0; i < n; i++, name++) {
 		rmean->stats[i].name = *name;
@@ -124,6 +224,8 @@ void
 rmean_delete(struct rmean *rmean)
 {
 	ev_timer_stop(loop(), &rmean->timer);
+	free(rmean->shards_alloc);
+	free(rmean->harvested);
 	free(rmean);
 	rmean = 0;
 }
@@ -131,6 +233,13 @@ rmean_delete(struct rmean *rmean)
 void
 rmean_cleanup(struct rmean *rmean)
 {
+	/*
+	 * The shard counters can not be reset - the collecting
+	 * threads own them. Advancing the watermarks to the
+	 * current counts restarts the totals from zero without
+	 * touching the writers.
+	 */
+	rmean_harvest(rmean);
 	for (size_t i = 0; i < rmean->stats_n; i++) {
 		for (size_t j = 0; j < RMEAN_WINDOW + 1; j++)
 			rmean->stats[i].value[j] = 0;
@@ -43,6 +43,8 @@ extern "C" {
 /** Rolling mean time window, in seconds. */
 enum { RMEAN_WINDOW = 5 };
 
+struct cord;
+
 struct stats {
 	const char *name;
 	int64_t value[RMEAN_WINDOW + 1];
@@ -51,19 +53,41 @@ struct stats {
 
 /**
  * Rolling average.
+ *
+ * The owner cord - the one which created the rmean - collects,
+ * rolls and reads directly. Collectors from other threads append
+ * to per-thread shards of plain monotonic counters, each on its
+ * own cache line, which the owner folds into the window on every
+ * roll and on every total read. This keeps the hot collection
+ * path free of atomics and shared cache lines no matter how many
+ * threads report into one rmean.
  */
 struct rmean {
 	ev_timer timer;
 	unsigned stats_n;
 	double prev_ts;
+	/** The cord which created the rmean and reads it. */
+	struct cord *owner;
+	/**
+	 * Shards of stats_n monotonic counters, one cache-line
+	 * aligned row per collecting thread. Only the owning
+	 * thread of a row writes it.
+	 */
+	int64_t *shards;
+	/** The unaligned allocation behind the shards. */
+	void *shards_alloc;
+	/** Row stride of the shards, in counters. */
+	unsigned shard_stride;
+	/**
+	 * Owner-side watermarks: how much of each shard counter
+	 * has been folded into value[0] and total already.
+	 */
+	int64_t *harvested;
 	struct stats stats[0];
 };
 
-static inline int64_t
-rmean_total(struct rmean *rmean, size_t name)
-{
-	return rmean->stats[name].total;
-}
+int64_t
+rmean_total(struct rmean *rmean, size_t name);
 
 void
 rmean_roll(int64_t *value, double dt);
@@ -61,6 +61,12 @@
  * showing fiber call stack.
  */
 #cmakedefine ENABLE_BACKTRACE 1
+/*
+ * Defined if configured with ENABLE_HEAP_AUDIT: heap allocations
+ * made inside allocation-budgeted scopes are counted and
+ * reported, see lib/core/heap_audit.h.
+ */
+#cmakedefine ENABLE_HEAP_AUDIT 1
 /*
  * Set if the system has bfd.h header and GNU bfd library.
  */
@@ -76,6 +82,7 @@
 #define MAP_ANONYMOUS MAP_ANON
 #endif
 #cmakedefine HAVE_MADV_DONTNEED 1
+#cmakedefine HAVE_MADV_FREE 1
 /*
  * Defined if O_DSYNC mode exists for open(2).
  */
@@ -107,6 +114,10 @@
  * Defined if this platform has GNU specific memrchr().
  */
 #cmakedefine HAVE_MEMRCHR 1
+/*
+ * Defined if this platform has accept4(..).
+ */
+#cmakedefine HAVE_ACCEPT4 1
 /*
  * Defined if this platform has sendfile(..).
  */
@@ -181,6 +192,15 @@
 
 #cmakedefine HAVE_PRCTL_H 1
 
+/** Defined if linux/io_uring.h exists, see lib/core/iouring.h */
+#cmakedefine HAVE_LINUX_IO_URING_H 1
+
+/** Defined if sys/sdt.h exists, see lib/core/probes.h */
+#cmakedefine HAVE_SYS_SDT_H 1
+
+/** Defined if sys/inotify.h exists, see hot standby in box/recovery.cc */
+#cmakedefine HAVE_SYS_INOTIFY_H 1
+
 #cmakedefine HAVE_UUIDGEN 1
 #cmakedefine HAVE_CLOCK_GETTIME 1
 #cmakedefine HAVE_CLOCK_GETTIME_DECL 1
@@ -0,0 +1,43 @@
+test_run = require('test_run').new()
+
+s = box.schema.space.create('src')
+_ = s:create_index('pk')
+_ = s:create_index('grp', {unique = false, parts = {{2, 'unsigned'}}})
+agg = box.schema.aggregate.register('agg', {source = 'src', key = {2}, aggregates = {{'count'}, {'sum', 3}, {'min', 3}, {'max', 3}}})
+
+--
+-- Target layout: group key, group row count, then the values:
+-- count, sum, min, max of field 3.
+--
+s:insert{1, 10, 5}
+s:insert{2, 10, 7}
+s:insert{3, 20, 1}
+agg:select{}
+-- Updating the row holding the extremum recomputes it from the
+-- group: the max drops from 7 to 5, the min becomes 4.
+s:update(2, {{'=', 3, 4}})
+agg:get(10)
+-- So does deleting it: the max drops from 5 to 4.
+s:delete{1}
+agg:get(10)
+-- An update moving a row across groups empties group 10 (its
+-- target row goes away) and folds the row into group 20.
+s:update(2, {{'=', 2, 20}})
+agg:select{}
+-- A rollback takes the target updates down with the source DML.
+box.begin() s:insert{4, 20, 100} box.rollback()
+agg:select{}
+
+--
+-- Definitions are runtime objects: after a restart the target
+-- keeps its rows and register() re-attaches the trigger to the
+-- preserved state.
+--
+test_run:cmd('restart server default')
+agg = box.schema.aggregate.register('agg', {source = 'src', key = {2}, aggregates = {{'count'}, {'sum', 3}, {'min', 3}, {'max', 3}}})
+agg:select{}
+box.space.src:insert{5, 20, 0}
+agg:get(20)
+box.schema.aggregate.unregister('agg')
+box.space.agg:drop()
+box.space.src:drop()
@@ -0,0 +1,75 @@
+test_run = require('test_run').new()
+fio = require('fio')
+yaml = require('yaml')
+
+path = fio.pathjoin(fio.cwd(), 'csv_bulk_in.csv')
+f = fio.open(path, {'O_CREAT', 'O_TRUNC', 'O_WRONLY'}, tonumber('644', 8))
+data = '1,hello,3.5\n2,"with,comma",x\n3,"multi\nline",y\n4,"quoted ""deep""",z\n'
+_ = f:write(data)
+_ = f:close()
+
+--
+-- Import: quoting, embedded separators and newlines, doubled
+-- quotes, numeric coercion of integer and float fields.
+--
+s = box.schema.space.create('csv')
+_ = s:create_index('pk', {parts = {{1, 'scalar'}}})
+s:import_csv(path)
+s:get(1)
+s:get(2)[2] == 'with,comma'
+s:get(3)[2] == 'multi\nline'
+s:get(4)[2] == 'quoted "deep"'
+s:truncate()
+-- Without coercion every field stays a string.
+s:import_csv(path, {numeric = false})
+s:get('1')
+s:truncate()
+
+--
+-- A DML error aborts the import, but batches committed before
+-- it stay: with batch_size = 2 the first two rows survive the
+-- duplicate in the second batch.
+--
+_ = s:import_csv(path)
+dup = fio.pathjoin(fio.cwd(), 'csv_bulk_dup.csv')
+f = fio.open(dup, {'O_CREAT', 'O_TRUNC', 'O_WRONLY'}, tonumber('644', 8))
+_ = f:write('10,a\n11,b\n12,c\n10,dup\n13,d\n')
+_ = f:close()
+s2 = box.schema.space.create('csvdup')
+_ = s2:create_index('pk')
+s2:import_csv(dup, {batch_size = 2})
+s2:select{}
+s2:drop()
+
+--
+-- Round trip: export, re-import, compare.
+--
+out = fio.pathjoin(fio.cwd(), 'csv_bulk_out.csv')
+s:export_csv(out)
+s3 = box.schema.space.create('csvcopy')
+_ = s3:create_index('pk', {parts = {{1, 'scalar'}}})
+s3:import_csv(out)
+yaml.encode(s3:select{}) == yaml.encode(s:select{})
+s3:drop()
+s:drop()
+
+--
+-- A file larger than the 512KB read chunk: the import must
+-- survive the buffer refills in the middle of a batch.
+--
+big = fio.pathjoin(fio.cwd(), 'csv_bulk_big.csv')
+f = fio.open(big, {'O_CREAT', 'O_TRUNC', 'O_WRONLY'}, tonumber('644', 8))
+pad = string.rep('x', 64)
+lines = {}
+for i = 1, 16384 do lines[i] = i .. ',' .. pad end
+_ = f:write(table.concat(lines, '\n') .. '\n')
+_ = f:close()
+s4 = box.schema.space.create('csvbig')
+_ = s4:create_index('pk')
+s4:import_csv(big, {batch_size = 500})
+s4.index.pk:len()
+s4:drop()
+_ = fio.unlink(big)
+_ = fio.unlink(path)
+_ = fio.unlink(dup)
+_ = fio.unlink(out)
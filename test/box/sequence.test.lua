@@ -812,3 +812,48 @@ sq:current()
 sq:reset()
 sq:current()
 sq:drop()
+
+--
+-- Batched value preallocation: cache > 1.
+--
+sq = box.schema.sequence.create('test', {cache = 5})
+sq:next() -- 1
+-- The whole range is persisted at once...
+box.space._sequence_data:get(sq.id)[2] -- 5
+-- ...and served without any further WAL writes.
+sq:next() -- 2
+sq:next() -- 3
+box.space._sequence_data:get(sq.id)[2] -- still 5
+-- An explicit set() discards the unserved part of the range.
+sq:set(100)
+sq:next() -- 101
+box.space._sequence_data:get(sq.id)[2] -- 105, a new range
+sq:drop()
+
+-- The range is cut at the max boundary.
+sq = box.schema.sequence.create('test', {cache = 10, max = 3})
+sq:next() -- 1
+box.space._sequence_data:get(sq.id)[2] -- 3
+sq:next() -- 2
+sq:next() -- 3
+sq:next() -- error
+sq:drop()
+
+-- A range cut at INT64_MAX must not overflow while serving its
+-- last value.
+INT64_MAX = tonumber64('9223372036854775807')
+sq = box.schema.sequence.create('test', {cache = 10, start = INT64_MAX - 2})
+sq:next() -- 9223372036854775805
+sq:next() -- 9223372036854775806
+sq:next() -- 9223372036854775807
+sq:next() -- error
+sq:drop()
+
+-- Restart skips the values that were preallocated but not
+-- issued.
+sq = box.schema.sequence.create('test', {cache = 5})
+sq:next() -- 1
+test_run:cmd('restart server default')
+sq = box.sequence.test
+sq:next() -- 6
+sq:drop()
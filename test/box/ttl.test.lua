@@ -0,0 +1,32 @@
+test_run = require('test_run').new()
+fiber = require('fiber')
+
+--
+-- Expired tuples are hidden from reads right away and physically
+-- reclaimed by the background purge fiber.
+--
+s = box.schema.space.create('ttl', {expire_field = 2})
+_ = s:create_index('pk')
+s:insert{1, 0} -- zero means the tuple never expires
+_ = s:insert{2, fiber.time() + 1000}
+_ = s:insert{3, fiber.time() - 1}
+s:get{3} -- expired: hidden from reads
+#s:select{}
+-- The purge fiber eventually deletes the expired tuple. Index
+-- length is not filtered, so it reflects physical storage.
+test_run:wait_cond(function() return s.index.pk:len() == 2 end)
+s:drop()
+
+--
+-- The purge makes progress through a long alive prefix. One
+-- wakeup scans at most 1000 tuples, so expired tuples sitting
+-- deeper in the primary key are only reachable if the scan
+-- resumes where the previous wakeup stopped.
+--
+s = box.schema.space.create('ttl', {expire_field = 2})
+_ = s:create_index('pk')
+box.begin() for i = 1, 1500 do s:insert{i, 0} end box.commit()
+for i = 1501, 1510 do s:insert{i, fiber.time() - 1} end
+#s:select{}
+test_run:wait_cond(function() return s.index.pk:len() == 1500 end)
+s:drop()
@@ -0,0 +1,123 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "perf.h"
+
+typedef int64_t type_t;
+
+static int
+compare(type_t a, type_t b)
+{
+	return a < b ? -1 : a > b ? 1 : 0;
+}
+
+#define BPS_TREE_NAME bench
+#define BPS_TREE_BLOCK_SIZE 512
+#define BPS_TREE_EXTENT_SIZE 16 * 1024
+#define BPS_TREE_IS_IDENTICAL(a, b) (a == b)
+#define BPS_TREE_COMPARE(a, b, arg) compare(a, b)
+#define BPS_TREE_COMPARE_KEY(a, b, arg) compare(a, b)
+#define bps_tree_elem_t type_t
+#define bps_tree_key_t type_t
+#define bps_tree_arg_t int
+#include "salad/bps_tree.h"
+
+enum {
+	BPS_BENCH_ITEMS = 1 << 22,
+};
+
+static int extents_count = 0;
+
+static void *
+extent_alloc(void *ctx)
+{
+	int *p_extents_count = (int *)ctx;
+	++*p_extents_count;
+	return malloc(BPS_TREE_EXTENT_SIZE);
+}
+
+static void
+extent_free(void *ctx, void *extent)
+{
+	int *p_extents_count = (int *)ctx;
+	--*p_extents_count;
+	free(extent);
+}
+
+/** Key sequence shuffled with a multiplicative hash. */
+static inline type_t
+shuffle_key(uint64_t i)
+{
+	return (type_t)((i * 2654435761ULL) & (BPS_BENCH_ITEMS - 1));
+}
+
+static uint64_t
+run_insert_sequential(void *ctx)
+{
+	(void)ctx;
+	bench tree;
+	bench_create(&tree, 0, extent_alloc, extent_free, &extents_count);
+	for (uint64_t i = 0; i < BPS_BENCH_ITEMS; i++)
+		bench_insert(&tree, (type_t)i, NULL);
+	perf_consume(bench_size(&tree));
+	bench_destroy(&tree);
+	return BPS_BENCH_ITEMS;
+}
+
+static uint64_t
+run_insert_random(void *ctx)
+{
+	(void)ctx;
+	bench tree;
+	bench_create(&tree, 0, extent_alloc, extent_free, &extents_count);
+	for (uint64_t i = 0; i < BPS_BENCH_ITEMS; i++)
+		bench_insert(&tree, shuffle_key(i), NULL);
+	perf_consume(bench_size(&tree));
+	bench_destroy(&tree);
+	return BPS_BENCH_ITEMS;
+}
+
+/** The tree under lookup, built once for all lookup runs. */
+static bench lookup_tree;
+
+static uint64_t
+run_find(void *ctx)
+{
+	(void)ctx;
+	uint64_t found = 0;
+	for (uint64_t i = 0; i < BPS_BENCH_ITEMS; i++)
+		found += bench_find(&lookup_tree, shuffle_key(i)) != NULL;
+	perf_consume(found);
+	return BPS_BENCH_ITEMS;
+}
+
+static uint64_t
+run_iterate(void *ctx)
+{
+	(void)ctx;
+	uint64_t sum = 0;
+	struct bench_iterator it = bench_iterator_first(&lookup_tree);
+	while (!bench_iterator_is_invalid(&it)) {
+		sum += *bench_iterator_get_elem(&lookup_tree, &it);
+		bench_iterator_next(&lookup_tree, &it);
+	}
+	perf_consume(sum);
+	return bench_size(&lookup_tree);
+}
+
+int
+main(void)
+{
+	perf_run("bps_tree.insert.sequential", run_insert_sequential, NULL);
+	perf_run("bps_tree.insert.random", run_insert_random, NULL);
+	bench_create(&lookup_tree, 0, extent_alloc, extent_free,
+		     &extents_count);
+	for (uint64_t i = 0; i < BPS_BENCH_ITEMS; i++)
+		bench_insert(&lookup_tree, shuffle_key(i), NULL);
+	perf_run("bps_tree.find", run_find, NULL);
+	perf_run("bps_tree.iterate", run_iterate, NULL);
+	bench_destroy(&lookup_tree);
+	return 0;
+}
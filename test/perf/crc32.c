@@ -0,0 +1,55 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "perf.h"
+#include "crc32.h"
+
+enum {
+	/** Typical xrow body. */
+	CRC_SMALL_SIZE = 512,
+	/** Large snapshot read chunk. */
+	CRC_LARGE_SIZE = 64 * 1024,
+	CRC_SMALL_LOOPS = 1 << 20,
+	CRC_LARGE_LOOPS = 1 << 13,
+};
+
+static char small_buf[CRC_SMALL_SIZE];
+static char large_buf[CRC_LARGE_SIZE];
+
+static uint64_t
+run_small(void *ctx)
+{
+	(void)ctx;
+	uint32_t crc = 0;
+	for (uint64_t i = 0; i < CRC_SMALL_LOOPS; i++)
+		crc = crc32_calc(crc, small_buf, sizeof(small_buf));
+	perf_consume(crc);
+	return (uint64_t)CRC_SMALL_LOOPS * CRC_SMALL_SIZE;
+}
+
+static uint64_t
+run_large(void *ctx)
+{
+	(void)ctx;
+	uint32_t crc = 0;
+	for (uint64_t i = 0; i < CRC_LARGE_LOOPS; i++)
+		crc = crc32_calc(crc, large_buf, sizeof(large_buf));
+	perf_consume(crc);
+	return (uint64_t)CRC_LARGE_LOOPS * CRC_LARGE_SIZE;
+}
+
+int
+main(void)
+{
+	crc32_init();
+	for (unsigned i = 0; i < sizeof(small_buf); i++)
+		small_buf[i] = (char)(i * 131);
+	for (unsigned i = 0; i < sizeof(large_buf); i++)
+		large_buf[i] = (char)(i * 131);
+	/* Items are bytes here, so ns_per_item is ns per byte. */
+	perf_run("crc32.small", run_small, NULL);
+	perf_run("crc32.large", run_large, NULL);
+	return 0;
+}
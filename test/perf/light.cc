@@ -0,0 +1,127 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "perf.h"
+
+typedef uint64_t hash_value_t;
+typedef uint32_t hash_t;
+
+static const size_t light_extent_size = 16 * 1024;
+
+static bool
+equal(hash_value_t v1, hash_value_t v2)
+{
+	return v1 == v2;
+}
+
+static bool
+equal_key(hash_value_t v1, hash_value_t v2)
+{
+	return v1 == v2;
+}
+
+#define LIGHT_NAME
+#define LIGHT_DATA_TYPE uint64_t
+#define LIGHT_KEY_TYPE uint64_t
+#define LIGHT_CMP_ARG_TYPE int
+#define LIGHT_EQUAL(a, b, arg) equal(a, b)
+#define LIGHT_EQUAL_KEY(a, b, arg) equal_key(a, b)
+#include "salad/light.h"
+
+enum {
+	LIGHT_BENCH_ITEMS = 1 << 22,
+};
+
+static size_t extents_count = 0;
+
+static void *
+extent_alloc(void *ctx)
+{
+	size_t *p_extents_count = (size_t *)ctx;
+	++*p_extents_count;
+	return malloc(light_extent_size);
+}
+
+static void
+extent_free(void *ctx, void *p)
+{
+	size_t *p_extents_count = (size_t *)ctx;
+	--*p_extents_count;
+	free(p);
+}
+
+/** Key sequence shuffled with a multiplicative hash. */
+static inline uint64_t
+shuffle_key(uint64_t i)
+{
+	return (i * 2654435761ULL) & (LIGHT_BENCH_ITEMS - 1);
+}
+
+static inline hash_t
+hash(hash_value_t value)
+{
+	return (hash_t)value;
+}
+
+static uint64_t
+run_insert(void *ctx)
+{
+	(void)ctx;
+	struct light_core ht;
+	light_create(&ht, light_extent_size, extent_alloc, extent_free,
+		     &extents_count, 0);
+	for (uint64_t i = 0; i < LIGHT_BENCH_ITEMS; i++) {
+		uint64_t v = shuffle_key(i);
+		light_insert(&ht, hash(v), v);
+	}
+	perf_consume(ht.count);
+	light_destroy(&ht);
+	return LIGHT_BENCH_ITEMS;
+}
+
+/** The table under lookup, built once for all lookup runs. */
+static struct light_core lookup_table;
+
+static uint64_t
+run_find(void *ctx)
+{
+	(void)ctx;
+	uint64_t found = 0;
+	for (uint64_t i = 0; i < LIGHT_BENCH_ITEMS; i++) {
+		uint64_t v = shuffle_key(i);
+		found += light_find(&lookup_table, hash(v), v) != light_end;
+	}
+	perf_consume(found);
+	return LIGHT_BENCH_ITEMS;
+}
+
+static uint64_t
+run_find_miss(void *ctx)
+{
+	(void)ctx;
+	uint64_t found = 0;
+	for (uint64_t i = 0; i < LIGHT_BENCH_ITEMS; i++) {
+		uint64_t v = shuffle_key(i) + LIGHT_BENCH_ITEMS;
+		found += light_find(&lookup_table, hash(v), v) != light_end;
+	}
+	perf_consume(found);
+	return LIGHT_BENCH_ITEMS;
+}
+
+int
+main(void)
+{
+	perf_run("light.insert", run_insert, NULL);
+	light_create(&lookup_table, light_extent_size, extent_alloc,
+		     extent_free, &extents_count, 0);
+	for (uint64_t i = 0; i < LIGHT_BENCH_ITEMS; i++) {
+		uint64_t v = shuffle_key(i);
+		light_insert(&lookup_table, hash(v), v);
+	}
+	perf_run("light.find.hit", run_find, NULL);
+	perf_run("light.find.miss", run_find_miss, NULL);
+	light_destroy(&lookup_table);
+	return 0;
+}
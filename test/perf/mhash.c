@@ -0,0 +1,95 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "perf.h"
+
+#define MH_SOURCE 1
+
+#define mh_name _i32
+struct mh_i32_node_t {
+	int32_t key;
+	int32_t val;
+};
+#define mh_key_t int32_t
+#define mh_node_t struct mh_i32_node_t
+#define mh_arg_t void *
+#define mh_hash(a, arg) (a->key)
+#define mh_hash_key(a, arg) (a)
+#define mh_cmp(a, b, arg) ((a->key) != (b->key))
+#define mh_cmp_key(a, b, arg) ((a) != (b->key))
+#define mh_bytemap 0
+#include "salad/mhash.h"
+
+enum {
+	MHASH_BENCH_ITEMS = 1 << 22,
+};
+
+/** Key sequence shuffled with a multiplicative hash. */
+static inline int32_t
+bench_key(uint64_t i)
+{
+	return (int32_t)((i * 2654435761ULL) & (MHASH_BENCH_ITEMS - 1));
+}
+
+static uint64_t
+bench_put(void *ctx)
+{
+	(void)ctx;
+	struct mh_i32_t *h = mh_i32_new();
+	for (uint64_t i = 0; i < MHASH_BENCH_ITEMS; i++) {
+		struct mh_i32_node_t node = {bench_key(i), (int32_t)i};
+		mh_i32_put(h, &node, NULL, NULL);
+	}
+	perf_consume(mh_size(h));
+	mh_i32_delete(h);
+	return MHASH_BENCH_ITEMS;
+}
+
+/** The table under lookup, built once for all lookup runs. */
+static struct mh_i32_t *lookup_table;
+
+static uint64_t
+bench_get_hit(void *ctx)
+{
+	(void)ctx;
+	uint64_t found = 0;
+	for (uint64_t i = 0; i < MHASH_BENCH_ITEMS; i++) {
+		struct mh_i32_node_t node = {bench_key(i), 0};
+		mh_int_t k = mh_i32_get(lookup_table, &node, NULL);
+		found += k != mh_end(lookup_table);
+	}
+	perf_consume(found);
+	return MHASH_BENCH_ITEMS;
+}
+
+static uint64_t
+bench_get_miss(void *ctx)
+{
+	(void)ctx;
+	uint64_t found = 0;
+	for (uint64_t i = 0; i < MHASH_BENCH_ITEMS; i++) {
+		struct mh_i32_node_t node = {
+			bench_key(i) + MHASH_BENCH_ITEMS, 0};
+		mh_int_t k = mh_i32_get(lookup_table, &node, NULL);
+		found += k != mh_end(lookup_table);
+	}
+	perf_consume(found);
+	return MHASH_BENCH_ITEMS;
+}
+
+int
+main(void)
+{
+	perf_run("mhash.put", bench_put, NULL);
+	lookup_table = mh_i32_new();
+	for (uint64_t i = 0; i < MHASH_BENCH_ITEMS; i++) {
+		struct mh_i32_node_t node = {bench_key(i), (int32_t)i};
+		mh_i32_put(lookup_table, &node, NULL, NULL);
+	}
+	perf_run("mhash.get.hit", bench_get_hit, NULL);
+	perf_run("mhash.get.miss", bench_get_miss, NULL);
+	mh_i32_delete(lookup_table);
+	return 0;
+}
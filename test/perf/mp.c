@@ -0,0 +1,77 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "perf.h"
+#include "msgpuck.h"
+
+enum {
+	/** Tuples in the encoded batch. */
+	MP_BENCH_ROWS = 100000,
+};
+
+/** The encoded batch, built once in main(). */
+static char *batch;
+static char *batch_end;
+
+/**
+ * Encode one batch of tuples shaped like a typical small
+ * user-space row: [id, name, flag, score, payload map].
+ */
+static char *
+encode_batch(char *data)
+{
+	for (uint32_t i = 0; i < MP_BENCH_ROWS; i++) {
+		data = mp_encode_array(data, 5);
+		data = mp_encode_uint(data, i);
+		data = mp_encode_str(data, "abcdefghijklmnop", 16);
+		data = mp_encode_bool(data, (i & 1) != 0);
+		data = mp_encode_double(data, i * 0.5);
+		data = mp_encode_map(data, 2);
+		data = mp_encode_str(data, "seq", 3);
+		data = mp_encode_uint(data, i);
+		data = mp_encode_str(data, "neg", 3);
+		data = mp_encode_int(data, -(int64_t)i);
+	}
+	return data;
+}
+
+static uint64_t
+run_next(void *ctx)
+{
+	(void)ctx;
+	const char *pos = batch;
+	while (pos < batch_end)
+		mp_next(&pos);
+	perf_consume((uint64_t)(uintptr_t)pos);
+	return MP_BENCH_ROWS;
+}
+
+static uint64_t
+run_check(void *ctx)
+{
+	(void)ctx;
+	const char *pos = batch;
+	while (pos < batch_end) {
+		if (mp_check(&pos, batch_end) != 0)
+			abort();
+	}
+	perf_consume((uint64_t)(uintptr_t)pos);
+	return MP_BENCH_ROWS;
+}
+
+int
+main(void)
+{
+	/* Generous upper bound: every row fits in 64 bytes. */
+	batch = malloc(MP_BENCH_ROWS * 64);
+	if (batch == NULL)
+		abort();
+	batch_end = encode_batch(batch);
+	perf_run("mp.next", run_next, NULL);
+	perf_run("mp.check", run_check, NULL);
+	free(batch);
+	return 0;
+}
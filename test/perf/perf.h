@@ -0,0 +1,105 @@
+#ifndef INCLUDES_TARANTOOL_TEST_PERF_H
+#define INCLUDES_TARANTOOL_TEST_PERF_H
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * Minimal microbenchmark harness, shared by the executables in
+ * test/perf. Results are printed one JSON object per line so
+ * that runs of two builds can be diffed or tracked by a script:
+ *
+ *   {"benchmark": "name", "items": N, "ns_per_item": X,
+ *    "items_per_sec": Y}
+ */
+
+enum {
+	/** Timed repetitions of every benchmark, best one wins. */
+	PERF_RUNS = 5,
+};
+
+static inline uint64_t
+perf_time_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Keep a computed value alive so the benchmarked work is not
+ * optimized away.
+ */
+static inline void
+perf_consume(uint64_t value)
+{
+	__asm__ volatile("" : : "r"(value) : "memory");
+}
+
+/**
+ * Run @a func once for warmup and then PERF_RUNS times timed,
+ * reporting the best run. @a func must be repeatable: it owns
+ * its setup and teardown and returns the number of items it
+ * processed.
+ */
+static inline void
+perf_run(const char *name, uint64_t (*func)(void *), void *ctx)
+{
+	uint64_t items = func(ctx);
+	uint64_t best = UINT64_MAX;
+	for (int run = 0; run < PERF_RUNS; run++) {
+		uint64_t start = perf_time_ns();
+		items = func(ctx);
+		uint64_t time = perf_time_ns() - start;
+		if (time < best)
+			best = time;
+	}
+	if (best == 0)
+		best = 1;
+	printf("{\"benchmark\": \"%s\", \"items\": %" PRIu64
+	       ", \"ns_per_item\": %.3f, \"items_per_sec\": %.0f}\n",
+	       name, items, (double)best / (double)items,
+	       (double)items * 1e9 / (double)best);
+	fflush(stdout);
+}
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* INCLUDES_TARANTOOL_TEST_PERF_H */
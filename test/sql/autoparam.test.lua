@@ -0,0 +1,47 @@
+test_run = require('test_run').new()
+engine = test_run:get_cfg('engine')
+_ = box.space._session_settings:update('sql_default_engine', {{'=', 2, engine}})
+
+box.execute('CREATE TABLE t (id INT PRIMARY KEY, a INT, s STRING);')
+box.execute('INSERT INTO t VALUES (1, 10, \'x\'), (2, 20, \'y\'), (3, 30, \'z\');')
+
+--
+-- Literals used as comparison operands are lifted into bound
+-- parameters; the results must be the same as with inline
+-- literals.
+--
+box.execute('SELECT id FROM t WHERE a = 10;')
+box.execute('SELECT id FROM t WHERE s = \'y\';')
+box.execute('SELECT id FROM t WHERE a > 15 AND a < 25;')
+
+--
+-- Queries differing only in the literal values share one cached
+-- statement: two more executions of the first shape are two
+-- cache hits and no new miss.
+--
+info = box.info.sql().cache
+box.execute('SELECT id FROM t WHERE a = 30;')
+box.execute('SELECT id FROM t WHERE a = 40;')
+d = box.info.sql().cache
+{d.hits - info.hits, d.misses - info.misses}
+
+--
+-- No lift: literals outside comparisons, hex literals and
+-- statements with explicit parameters are not rewritten and do
+-- not touch the cache.
+--
+info = box.info.sql().cache
+box.execute('SELECT id FROM t ORDER BY id LIMIT 1;')
+box.execute('SELECT id FROM t WHERE a = 0x14;')
+box.execute('SELECT id FROM t WHERE a = ? AND id < 3;', {10})
+d = box.info.sql().cache
+{d.hits - info.hits, d.misses - info.misses}
+
+--
+-- With the cache disabled a rewritten statement can not be
+-- cached; it must fall back to private execution, not fail.
+--
+box.cfg{sql_cache_size = 0}
+box.execute('SELECT s FROM t WHERE id = 2;')
+box.cfg{sql_cache_size = 5 * 1024 * 1024}
+box.execute('DROP TABLE t;')
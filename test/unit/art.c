@@ -0,0 +1,200 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unit.h"
+#include "salad/art.h"
+
+/*
+ * Keys are zero-terminated strings stored with the terminator,
+ * which keeps the key set prefix-free as the structure requires.
+ */
+static uint32_t
+key_len(const char *key)
+{
+	return strlen(key) + 1;
+}
+
+static void
+basic_check(void)
+{
+	header();
+	struct art tree;
+	art_create(&tree);
+	const char *keys[] = {
+		"http://example.com/a/b/c",
+		"http://example.com/a/b/d",
+		"http://example.com/a",
+		"http://example.org/",
+		"ftp://example.com/a/b/c",
+		"",
+	};
+	uint32_t count = sizeof(keys) / sizeof(keys[0]);
+	for (uint32_t i = 0; i < count; i++) {
+		void *old;
+		fail_if(art_insert(&tree, (const unsigned char *)keys[i],
+				   key_len(keys[i]), (void *)keys[i],
+				   &old) != 0);
+		fail_if(old != NULL);
+	}
+	fail_if(tree.size != count);
+	for (uint32_t i = 0; i < count; i++) {
+		fail_if(art_find(&tree, (const unsigned char *)keys[i],
+				 key_len(keys[i])) != keys[i]);
+	}
+	fail_if(art_find(&tree, (const unsigned char *)"http://example.com/",
+			 key_len("http://example.com/")) != NULL);
+	/* Replace keeps the size and returns the old value. */
+	void *old;
+	fail_if(art_insert(&tree, (const unsigned char *)keys[0],
+			   key_len(keys[0]), &tree, &old) != 0);
+	fail_if(old != keys[0]);
+	fail_if(tree.size != count);
+	fail_if(art_remove(&tree, (const unsigned char *)"missing",
+			   key_len("missing")) != NULL);
+	fail_if(art_remove(&tree, (const unsigned char *)keys[1],
+			   key_len(keys[1])) != keys[1]);
+	fail_if(tree.size != count - 1);
+	fail_if(art_find(&tree, (const unsigned char *)keys[1],
+			 key_len(keys[1])) != NULL);
+	art_destroy(&tree);
+	footer();
+}
+
+struct order_ctx {
+	char prev[64];
+	uint32_t visited;
+	uint32_t disorder;
+};
+
+static int
+order_cb(void *arg, const unsigned char *key, uint32_t len, void *value)
+{
+	(void)len;
+	(void)value;
+	struct order_ctx *ctx = arg;
+	if (ctx->visited > 0 && strcmp(ctx->prev, (const char *)key) >= 0)
+		ctx->disorder++;
+	snprintf(ctx->prev, sizeof(ctx->prev), "%s", key);
+	ctx->visited++;
+	return 0;
+}
+
+static void
+massive_check(void)
+{
+	header();
+	struct art tree;
+	art_create(&tree);
+	const uint32_t count = 10000;
+	char key[64];
+	for (uint32_t i = 0; i < count; i++) {
+		/* Shared prefix, shuffled insertion order. */
+		uint32_t v = (i * 7919) % count;
+		snprintf(key, sizeof(key),
+			 "http://service.local/user/%08u/profile", v);
+		void *old;
+		fail_if(art_insert(&tree, (const unsigned char *)key,
+				   key_len(key), (void *)(uintptr_t)(v + 1),
+				   &old) != 0);
+		fail_if(old != NULL);
+	}
+	fail_if(tree.size != count);
+	for (uint32_t i = 0; i < count; i++) {
+		snprintf(key, sizeof(key),
+			 "http://service.local/user/%08u/profile", i);
+		void *value = art_find(&tree, (const unsigned char *)key,
+				       key_len(key));
+		fail_if(value != (void *)(uintptr_t)(i + 1));
+	}
+	struct order_ctx ctx;
+	memset(&ctx, 0, sizeof(ctx));
+	fail_if(art_iter(&tree, order_cb, &ctx) != 0);
+	fail_if(ctx.visited != count);
+	fail_if(ctx.disorder != 0);
+	/* Remove odd keys, check even ones survive. */
+	for (uint32_t i = 1; i < count; i += 2) {
+		snprintf(key, sizeof(key),
+			 "http://service.local/user/%08u/profile", i);
+		fail_if(art_remove(&tree, (const unsigned char *)key,
+				   key_len(key)) !=
+			(void *)(uintptr_t)(i + 1));
+	}
+	fail_if(tree.size != count / 2);
+	for (uint32_t i = 0; i < count; i++) {
+		snprintf(key, sizeof(key),
+			 "http://service.local/user/%08u/profile", i);
+		void *value = art_find(&tree, (const unsigned char *)key,
+				       key_len(key));
+		if (i % 2 == 0) {
+			fail_if(value != (void *)(uintptr_t)(i + 1));
+		} else {
+			fail_if(value != NULL);
+		}
+	}
+	for (uint32_t i = 0; i < count; i += 2) {
+		snprintf(key, sizeof(key),
+			 "http://service.local/user/%08u/profile", i);
+		fail_if(art_remove(&tree, (const unsigned char *)key,
+				   key_len(key)) ==  NULL);
+	}
+	fail_if(tree.size != 0);
+	fail_if(tree.root != NULL);
+	art_destroy(&tree);
+	footer();
+}
+
+static int
+count_cb(void *arg, const unsigned char *key, uint32_t len, void *value)
+{
+	(void)key;
+	(void)len;
+	(void)value;
+	uint32_t *counter = arg;
+	(*counter)++;
+	return 0;
+}
+
+static void
+prefix_iter_check(void)
+{
+	header();
+	struct art tree;
+	art_create(&tree);
+	char key[64];
+	for (uint32_t user = 0; user < 100; user++) {
+		for (uint32_t doc = 0; doc < 10; doc++) {
+			snprintf(key, sizeof(key), "/user/%03u/doc/%02u",
+				 user, doc);
+			void *old;
+			fail_if(art_insert(&tree,
+					   (const unsigned char *)key,
+					   key_len(key), &tree, &old) != 0);
+		}
+	}
+	uint32_t counter = 0;
+	snprintf(key, sizeof(key), "/user/042/");
+	fail_if(art_iter_prefix(&tree, (const unsigned char *)key,
+				strlen(key), count_cb, &counter) != 0);
+	fail_if(counter != 10);
+	counter = 0;
+	snprintf(key, sizeof(key), "/user/");
+	fail_if(art_iter_prefix(&tree, (const unsigned char *)key,
+				strlen(key), count_cb, &counter) != 0);
+	fail_if(counter != 1000);
+	counter = 0;
+	snprintf(key, sizeof(key), "/group/");
+	fail_if(art_iter_prefix(&tree, (const unsigned char *)key,
+				strlen(key), count_cb, &counter) != 0);
+	fail_if(counter != 0);
+	art_destroy(&tree);
+	footer();
+}
+
+int
+main(void)
+{
+	basic_check();
+	massive_check();
+	prefix_iter_check();
+}
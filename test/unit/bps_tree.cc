@@ -624,6 +624,34 @@ loading_test()
 		test_destroy(&tree);
 	}
 
+	const unsigned fills[] = {75, 90, 100};
+	for (size_t f = 0; f < sizeof(fills) / sizeof(fills[0]); f++) {
+		for (type_t i = 0; i <= test_count; i += 17) {
+			test_create(&tree, 0, extent_alloc, extent_free,
+				    &extents_count);
+
+			if (test_build_filled(&tree, arr, i, fills[f]))
+				fail("filled building failed", "true");
+
+			if (test_debug_check(&tree))
+				fail("debug check nonzero", "true");
+
+			struct test_iterator iterator;
+			iterator = test_iterator_first(&tree);
+			for (type_t j = 0; j < i; j++) {
+				type_t *v = test_iterator_get_elem(&tree,
+								   &iterator);
+				if (!v || *v != j)
+					fail("wrong build result", "true");
+				test_iterator_next(&tree, &iterator);
+			}
+			if (!test_iterator_is_invalid(&iterator))
+				fail("wrong build result", "true");
+
+			test_destroy(&tree);
+		}
+	}
+
 	footer();
 }
 
@@ -14,13 +14,12 @@ struct cpipe pipe_from_main_to_hang;
 /*
  * We want to cancel canceled thread in the moment of cpipe_flush_cb
  * will be processing.
- * A Linux specific dirty hack will be used for reproduce the bug.
- * We need to synchronize the main thread and the canceled worker thread.
- * So, do it using the endpoint's mutex internal field(__data.__lock).
- * __lock == 0 - unlock
- * __lock == 1 - lock
- * __lock == 2 - possible waiters exists
- * After pthred create - __lock change state from 1 to 2
+ * The endpoint handoff is lock-free, so there is no endpoint lock
+ * to catch the worker on: ev_async_send() (write() is a cancellation
+ * point) is the only blocking spot left and both cpipe_flush_cb and
+ * cpipe_destroy() disable cancellation around it. Cancel the worker
+ * while it is inside the push/destroy window and check that the hang
+ * worker stays stoppable wherever the cancel lands.
 */
 
 pthread_mutex_t endpoint_hack_mutex_1;
@@ -106,37 +105,32 @@ main_f(va_list ap)
 {
 	(void) ap;
 
-	/* Start the endpoint's mutex hack */
-
-	/* Initialize the endpoint mutex */
+	/* Wait for the endpoint to be created */
 	tt_pthread_mutex_lock(&endpoint_hack_mutex_1);
 	hang_worker_start();
 	tt_pthread_cond_wait(&endpoint_hack_cond_1, &endpoint_hack_mutex_1);
 	tt_pthread_mutex_unlock(&endpoint_hack_mutex_1);
 
 	/*
-	 * Create (only create) the canceled worker before the endpoint mutex will be locked
-	 * for the hack work correctly
+	 * Create (only create) the canceled worker and wait until it
+	 * is parked on the start command.
 	*/
 	tt_pthread_mutex_lock(&endpoint_hack_mutex_1);
 	canceled_worker_start();
 	tt_pthread_cond_wait(&endpoint_hack_cond_1, &endpoint_hack_mutex_1);
 	tt_pthread_mutex_unlock(&endpoint_hack_mutex_1);
 
-	tt_pthread_mutex_lock(&(hang_endpoint.mutex));
-
 	/* Start canceled worker */
 	tt_pthread_mutex_lock(&endpoint_hack_mutex_2);
 	tt_pthread_cond_signal(&endpoint_hack_cond_2);
 	tt_pthread_mutex_unlock(&endpoint_hack_mutex_2);
 
-	while(hang_endpoint.mutex.__data.__lock < 2) {
-		usleep(200);
-	}
-
+	/*
+	 * Give the worker a moment to reach the push/destroy window
+	 * and cancel it there.
+	 */
+	usleep(200);
 	tt_pthread_cancel(canceled_worker.id);
-	tt_pthread_mutex_unlock(&(hang_endpoint.mutex));
-	/* Hack end */
 
 	tt_pthread_join(canceled_worker.id, NULL);
 
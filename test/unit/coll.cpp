@@ -184,6 +184,47 @@ cache_test()
 	footer();
 }
 
+void
+sort_key_cache_test()
+{
+	header();
+	plan(3);
+
+	struct coll_def def;
+	memset(&def, 0, sizeof(def));
+	snprintf(def.locale, sizeof(def.locale), "%s", "ru_RU");
+	def.type = COLL_TYPE_ICU;
+	struct coll *coll = coll_new(&def);
+	assert(coll != NULL);
+
+	/*
+	 * The first comparison builds the sort keys, the second
+	 * one is served from the per-thread cache.
+	 */
+	const char *s = "абв";
+	const char *t = "абг";
+	int first = coll->cmp(s, strlen(s), t, strlen(t), coll);
+	int second = coll->cmp(s, strlen(s), t, strlen(t), coll);
+	ok(first < 0 && second < 0,
+	   "a cached comparison agrees with the first one");
+	is(coll->cmp(s, strlen(s), s, strlen(s), coll), 0,
+	   "equal strings compare equal through the cache");
+
+	/*
+	 * A string too long for a cache slot falls back to
+	 * ucol_strcoll() while the other operand is cached.
+	 */
+	char long_str[128];
+	memset(long_str, 'b', sizeof(long_str));
+	ok(coll->cmp("a", 1, long_str, sizeof(long_str), coll) < 0 &&
+	   coll->cmp(long_str, sizeof(long_str), "a", 1, coll) > 0,
+	   "mixed cached and uncached operands order consistently");
+	coll_unref(coll);
+
+	check_plan();
+	footer();
+}
+
 int
 main(int, const char**)
 {
@@ -193,6 +234,7 @@ main(int, const char**)
 	manual_test();
 	hash_test();
 	cache_test();
+	sort_key_cache_test();
 	fiber_free();
 	memory_free();
 	coll_free();
@@ -0,0 +1,125 @@
+#include "salad/counting_bloom.h"
+#include <unordered_set>
+#include <vector>
+#include <iostream>
+
+using namespace std;
+
+uint32_t h(uint32_t i)
+{
+	return i * 2654435761;
+}
+
+void
+add_remove_test()
+{
+	cout << "*** " << __func__ << " ***" << endl;
+	srand(time(0));
+	uint32_t error_count = 0;
+	uint32_t fp_rate_too_big = 0;
+	for (double p = 0.001; p < 0.5; p *= 1.3) {
+		uint64_t tests = 0;
+		uint64_t false_positive = 0;
+		for (uint32_t count = 1000; count <= 10000; count *= 2) {
+			struct counting_bloom bloom;
+			counting_bloom_create(&bloom, count, p);
+			unordered_set<uint32_t> check;
+			for (uint32_t i = 0; i < count; i++) {
+				uint32_t val = rand() % (count * 10);
+				if (check.find(val) != check.end())
+					continue;
+				check.insert(val);
+				counting_bloom_add(&bloom, h(val));
+			}
+			/* Remove every second value ever added. */
+			unordered_set<uint32_t> removed;
+			for (auto val : check) {
+				if (removed.size() * 2 >= check.size())
+					break;
+				counting_bloom_remove(&bloom, h(val));
+				removed.insert(val);
+			}
+			for (auto val : removed)
+				check.erase(val);
+			for (uint32_t i = 0; i < count * 10; i++) {
+				bool has = check.find(i) != check.end();
+				bool bloom_possible =
+					counting_bloom_maybe_has(&bloom, h(i));
+				tests++;
+				if (has && !bloom_possible)
+					error_count++;
+				if (!has && bloom_possible)
+					false_positive++;
+			}
+			counting_bloom_destroy(&bloom);
+		}
+		double fp_rate = (double)false_positive / tests;
+		if (fp_rate > p + 0.001)
+			fp_rate_too_big++;
+	}
+	cout << "error_count = " << error_count << endl;
+	cout << "fp_rate_too_big = " << fp_rate_too_big << endl;
+}
+
+void
+churn_test()
+{
+	cout << "*** " << __func__ << " ***" << endl;
+	srand(time(0));
+	uint32_t error_count = 0;
+	uint32_t fp_rate_too_big = 0;
+	const double p = 0.01;
+	const uint32_t count = 5000;
+	struct counting_bloom bloom;
+	counting_bloom_create(&bloom, count, p);
+	unordered_set<uint32_t> check;
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t val = rand() % (count * 10);
+		if (check.find(val) != check.end())
+			continue;
+		check.insert(val);
+		counting_bloom_add(&bloom, h(val));
+	}
+	/*
+	 * Replace the whole data set several times over. An
+	 * additive filter would saturate; a counting filter must
+	 * keep the false positive rate of a single generation.
+	 */
+	for (uint32_t gen = 0; gen < 10; gen++) {
+		unordered_set<uint32_t> next;
+		for (uint32_t i = 0; i < count; i++) {
+			uint32_t val = rand() % (count * 10);
+			if (next.find(val) != next.end())
+				continue;
+			next.insert(val);
+			counting_bloom_add(&bloom, h(val));
+		}
+		for (auto val : check)
+			counting_bloom_remove(&bloom, h(val));
+		check = next;
+	}
+	uint64_t tests = 0;
+	uint64_t false_positive = 0;
+	for (uint32_t i = 0; i < count * 10; i++) {
+		bool has = check.find(i) != check.end();
+		bool bloom_possible = counting_bloom_maybe_has(&bloom, h(i));
+		tests++;
+		if (has && !bloom_possible)
+			error_count++;
+		if (!has && bloom_possible)
+			false_positive++;
+	}
+	counting_bloom_destroy(&bloom);
+	double fp_rate = (double)false_positive / tests;
+	if (fp_rate > p + 0.001)
+		fp_rate_too_big++;
+	cout << "error_count = " << error_count << endl;
+	cout << "fp_rate_too_big = " << fp_rate_too_big << endl;
+}
+
+int
+main(void)
+{
+	add_remove_test();
+	churn_test();
+}
@@ -333,7 +333,7 @@ test_mp_print(void)
 int
 main(void)
 {
-	plan(304);
+	plan(324);
 
 	dectest(314, 271, uint64, uint64_t);
 	dectest(65535, 23456, uint64, uint64_t);
@@ -413,5 +413,16 @@ main(void)
 	dectest_is(is_int, 1.0000, true);
 	dectest_is(is_int, 1.0000001, false);
 
+	/*
+	 * Exercise the integer fast path of add/sub and its
+	 * borders: a carry within 18 digits, a zero result, a
+	 * carry into the 19th digit and a too large exponent
+	 * difference. The latter three fall back to decNumber.
+	 */
+	dectest_op(add, 9.99, 0.01, 10.00);
+	dectest_op(sub, 1.50, 1.50, 0.00);
+	dectest_op(add, 999999999999999999, 1, 1000000000000000000);
+	dectest_op(sub, 0.001, 1e19, -9999999999999999999.999);
+
 	return check_plan();
 }
@@ -0,0 +1,116 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "hdr_histogram.h"
+#include "unit.h"
+#include "trivia/util.h"
+
+static int
+int64_cmp(const void *p1, const void *p2)
+{
+	int64_t v1 = *(int64_t *)p1;
+	int64_t v2 = *(int64_t *)p2;
+	if (v1 > v2)
+		return 1;
+	if (v1 < v2)
+		return -1;
+	return 0;
+}
+
+/**
+ * The recorded value and any value the histogram reports for it
+ * must agree in the configured number of significant digits.
+ */
+static void
+test_precision(void)
+{
+	header();
+
+	for (int digits = 1; digits <= 4; digits++) {
+		struct hdr_histogram *hdr =
+			hdr_histogram_new(1, 100000000, digits);
+		fail_if(hdr == NULL);
+		double max_err = 1.0;
+		for (int i = 0; i < digits; i++)
+			max_err /= 10;
+		for (int64_t value = 1; value <= 10000000; value *= 7) {
+			hdr_histogram_reset(hdr);
+			hdr_histogram_record(hdr, value);
+			int64_t result = hdr_histogram_percentile(hdr, 100);
+			fail_if(result < value);
+			fail_if(result > value + value * max_err + 1);
+		}
+		hdr_histogram_delete(hdr);
+	}
+
+	footer();
+}
+
+static void
+test_percentile(void)
+{
+	header();
+
+	struct hdr_histogram *hdr = hdr_histogram_new(1, 10000000, 2);
+	fail_if(hdr == NULL);
+
+	size_t data_len = 900 + rand() % 200;
+	int64_t *data = calloc(data_len, sizeof(*data));
+	for (size_t i = 0; i < data_len; i++) {
+		data[i] = 1 + rand() % 1000000;
+		hdr_histogram_record(hdr, data[i]);
+	}
+	fail_if(hdr_histogram_total(hdr) != (int64_t)data_len);
+
+	qsort(data, data_len, sizeof(*data), int64_cmp);
+	int64_t prev = 0;
+	for (int pct = 5; pct <= 100; pct += 5) {
+		int64_t val = data[(data_len * pct + 99) / 100 - 1];
+		int64_t result = hdr_histogram_percentile(hdr, pct);
+		/* Within 1% of the exact sample percentile. */
+		fail_if(result < val);
+		fail_if(result > val + val / 100 + 1);
+		/* Percentiles are monotonic. */
+		fail_if(result < prev);
+		prev = result;
+	}
+
+	hdr_histogram_delete(hdr);
+	free(data);
+
+	footer();
+}
+
+static void
+test_clamp_and_reset(void)
+{
+	header();
+
+	struct hdr_histogram *hdr = hdr_histogram_new(1, 1000000, 2);
+	fail_if(hdr == NULL);
+
+	fail_if(hdr_histogram_percentile(hdr, 99) != 0);
+
+	hdr_histogram_record(hdr, -5);
+	hdr_histogram_record(hdr, INT64_MAX);
+	fail_if(hdr_histogram_total(hdr) != 2);
+	fail_if(hdr_histogram_percentile(hdr, 100) < 1000000);
+
+	hdr_histogram_reset(hdr);
+	fail_if(hdr_histogram_total(hdr) != 0);
+	fail_if(hdr_histogram_percentile(hdr, 99) != 0);
+
+	hdr_histogram_delete(hdr);
+
+	footer();
+}
+
+int
+main()
+{
+	srand(time(NULL));
+	test_precision();
+	test_percentile();
+	test_clamp_and_reset();
+}
@@ -37,6 +37,14 @@ test_type_less(const struct test_type *left, const struct test_type *right)
 
 #include "salad/heap.h"
 
+#define HEAP_NAME test4_heap
+#define HEAP_LESS(h, a, b) test_type_less(a, b)
+#define HEAP_ARITY 4
+#define heap_value_t struct test_type
+#define heap_value_attr node
+
+#include "salad/heap.h"
+
 void free_all_nodes(heap_t *p_heap)
 {
 	struct test_type *value;
@@ -530,6 +538,60 @@ test_heapify()
 	footer();
 }
 
+static void
+test_4ary_insert_pop_many_random()
+{
+	header();
+	uint32_t ans = UINT_MAX;
+	struct test_type *value, *root_value;
+	heap_t heap;
+	test4_heap_create(&heap);
+
+	uint32_t *keys = (uint32_t *)malloc(sizeof(uint32_t) * TEST_CASE_SIZE);
+	if (keys == NULL) {
+		fail("keys == NULL", "fail to alloc memory for keys array");
+	}
+
+	for (uint32_t i = 0; i < TEST_CASE_SIZE; ++i) {
+		value = (struct test_type *)malloc(sizeof(struct test_type));
+		keys[i] = value->val1 = rand();
+		ans = (value->val1 < ans ? value->val1 : ans);
+
+		test4_heap_insert(&heap, value);
+
+		root_value = test4_heap_top(&heap);
+		if (root_value->val1 != ans) {
+			fail("check that min.val1 is correct failed",
+			     "root_value->val1 != ans");
+		}
+		if (test4_heap_check(&heap)) {
+			fail("check heap invariants failed",
+			     "test4_heap_check(&heap)");
+		}
+	}
+
+	qsort(keys, TEST_CASE_SIZE, sizeof(uint32_t), uint32_compare);
+	for (uint32_t i = 0; i < TEST_CASE_SIZE; ++i) {
+		root_value = test4_heap_top(&heap);
+
+		test4_heap_pop(&heap);
+
+		if (root_value->val1 != keys[i]) {
+			fail("check that min.val1 is correct failed",
+			     "root_value->val1 != keys[i]");
+		}
+		if (test4_heap_check(&heap)) {
+			fail("check heap invariants failed",
+			     "test4_heap_check(&heap)");
+		}
+		free(root_value);
+	}
+	test4_heap_destroy(&heap);
+
+	free(keys);
+	footer();
+}
+
 int
 main(int argc, const char** argv)
 {
@@ -546,4 +608,5 @@ main(int argc, const char** argv)
 	test_random_delete_workload();
 	test_delete_last_node();
 	test_heapify();
+	test_4ary_insert_pop_many_random();
 }
@@ -317,6 +317,38 @@ iterator_freeze_check()
 	footer();
 }
 
+static void
+reserve_test()
+{
+	header();
+
+	struct light_core ht;
+	light_create(&ht, light_extent_size,
+		     my_light_alloc, my_light_free, &extents_count, 0);
+	const size_t count = 5000;
+	if (light_reserve(&ht, count))
+		fail("reserve failed!", "true");
+	if (ht.table_size < count)
+		fail("reserved table is too small!", "true");
+	if (light_selfcheck(&ht))
+		fail("selfcheck after reserve failed!", "true");
+
+	size_t extents_after_reserve = extents_count;
+	for (hash_value_t val = 0; val < count; val++)
+		light_insert(&ht, hash(val), val);
+	if (extents_count != extents_after_reserve)
+		fail("insertion into reserved table allocated!", "true");
+	if (light_selfcheck(&ht))
+		fail("selfcheck after fill failed!", "true");
+	for (hash_value_t val = 0; val < count; val++) {
+		if (light_find(&ht, hash(val), val) == light_end)
+			fail("find in reserved table failed!", "true");
+	}
+	light_destroy(&ht);
+
+	footer();
+}
+
 int
 main(int, const char**)
 {
@@ -325,6 +357,7 @@ main(int, const char**)
 	collision_test();
 	iterator_test();
 	iterator_freeze_check();
+	reserve_test();
 	if (extents_count != 0)
 		fail("memory leak!", "true");
 }
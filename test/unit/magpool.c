@@ -0,0 +1,143 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unit.h"
+#include "core/magpool.h"
+
+static void
+basic_check(void)
+{
+	header();
+	struct magpool pool;
+	magpool_create(&pool, 48);
+	struct magpool_cache cache;
+	fail_if(magpool_cache_create(&cache, &pool) != 0);
+	/*
+	 * Cycle more objects than fit into the two magazines so
+	 * both the heap-restock and the depot paths run.
+	 */
+	enum { OBJS = 3 * MAGPOOL_MAGAZINE_SIZE };
+	void *objs[OBJS];
+	for (int i = 0; i < OBJS; i++) {
+		objs[i] = magpool_alloc(&cache);
+		fail_if(objs[i] == NULL);
+		memset(objs[i], i & 0xff, 48);
+	}
+	for (int i = 0; i < OBJS; i++)
+		magpool_free(&cache, objs[i]);
+	/* The second pass must be served from the caches. */
+	uint64_t misses = pool.depot_misses;
+	for (int i = 0; i < OBJS; i++) {
+		objs[i] = magpool_alloc(&cache);
+		fail_if(objs[i] == NULL);
+	}
+	fail_if(pool.depot_misses != misses);
+	for (int i = 0; i < OBJS; i++)
+		magpool_free(&cache, objs[i]);
+	magpool_cache_destroy(&cache);
+	magpool_destroy(&pool);
+	footer();
+}
+
+enum {
+	XTHREAD_OBJS = 10000,
+	XTHREAD_QUEUE = 256,
+};
+
+struct xthread_arg {
+	struct magpool *pool;
+	/** Single-producer single-consumer handoff queue. */
+	void *queue[XTHREAD_QUEUE];
+	unsigned qhead;
+	unsigned qtail;
+	pthread_mutex_t qmutex;
+};
+
+static void *
+xthread_consumer(void *arg)
+{
+	struct xthread_arg *x = arg;
+	struct magpool_cache cache;
+	if (magpool_cache_create(&cache, x->pool) != 0)
+		return (void *)1;
+	long freed = 0;
+	while (freed < XTHREAD_OBJS) {
+		void *obj = NULL;
+		pthread_mutex_lock(&x->qmutex);
+		if (x->qhead != x->qtail)
+			obj = x->queue[x->qhead++ % XTHREAD_QUEUE];
+		pthread_mutex_unlock(&x->qmutex);
+		if (obj == NULL)
+			continue;
+		if (*(unsigned char *)obj != (unsigned char)(freed & 0xff))
+			return (void *)1;
+		magpool_free(&cache, obj);
+		freed++;
+	}
+	magpool_cache_destroy(&cache);
+	return NULL;
+}
+
+static void
+xthread_check(void)
+{
+	header();
+	struct magpool pool;
+	magpool_create(&pool, 64);
+	struct xthread_arg x;
+	x.pool = &pool;
+	x.qhead = 0;
+	x.qtail = 0;
+	pthread_mutex_init(&x.qmutex, NULL);
+	pthread_t consumer;
+	fail_if(pthread_create(&consumer, NULL, xthread_consumer, &x) != 0);
+
+	struct magpool_cache cache;
+	fail_if(magpool_cache_create(&cache, &pool) != 0);
+	long sent = 0;
+	while (sent < XTHREAD_OBJS) {
+		void *obj = magpool_alloc(&cache);
+		fail_if(obj == NULL);
+		*(unsigned char *)obj = (unsigned char)(sent & 0xff);
+		bool queued = false;
+		while (!queued) {
+			pthread_mutex_lock(&x.qmutex);
+			if (x.qtail - x.qhead < XTHREAD_QUEUE) {
+				x.queue[x.qtail++ % XTHREAD_QUEUE] = obj;
+				queued = true;
+			}
+			pthread_mutex_unlock(&x.qmutex);
+		}
+		sent++;
+	}
+	void *res;
+	pthread_join(consumer, &res);
+	fail_if(res != NULL);
+	/*
+	 * Everything the consumer freed must be allocatable again
+	 * without going back to the heap.
+	 */
+	uint64_t misses = pool.depot_misses;
+	void *objs[2 * MAGPOOL_MAGAZINE_SIZE];
+	for (unsigned i = 0; i < 2 * MAGPOOL_MAGAZINE_SIZE; i++) {
+		objs[i] = magpool_alloc(&cache);
+		fail_if(objs[i] == NULL);
+	}
+	fail_if(pool.depot_misses != misses);
+	for (unsigned i = 0; i < 2 * MAGPOOL_MAGAZINE_SIZE; i++)
+		magpool_free(&cache, objs[i]);
+	magpool_cache_destroy(&cache);
+	magpool_destroy(&pool);
+	pthread_mutex_destroy(&x.qmutex);
+	footer();
+}
+
+int
+main(void)
+{
+	basic_check();
+	xthread_check();
+}
@@ -0,0 +1,137 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "unit.h"
+#include "core/mp_check_flat.h"
+#include "msgpuck/msgpuck.h"
+
+static char buf[1024];
+
+/**
+ * Run mp_check_flat() over buf and make sure that on success it
+ * stops exactly at the end of the encoded data.
+ */
+static int
+check(const char *end)
+{
+	const char *pos = buf;
+	int rc = mp_check_flat(&pos, end);
+	if (rc == 0 && pos != end)
+		return -1;
+	return rc;
+}
+
+/**
+ * Check that mp_next_flat() over @a count objects stops exactly
+ * where @a count mp_next() calls do.
+ */
+static bool
+next_flat_matches(const char *end, uint32_t count)
+{
+	const char *fast = buf;
+	const char *slow = buf;
+	mp_next_flat(&fast, count);
+	for (uint32_t i = 0; i < count; i++)
+		mp_next(&slow);
+	return fast == slow && fast == end;
+}
+
+int
+main(void)
+{
+	header();
+	plan(11);
+
+	char *w = buf;
+	w = mp_encode_array(w, 40);
+	for (int i = 0; i < 40; i++)
+		w = mp_encode_uint(w, i);
+	is(check(w), 0, "long array of positive fixints");
+
+	char long_str[40];
+	memset(long_str, 'x', sizeof(long_str));
+	w = buf;
+	w = mp_encode_array(w, 12);
+	w = mp_encode_int(w, -5);
+	w = mp_encode_uint(w, 200);
+	w = mp_encode_uint(w, 70000);
+	w = mp_encode_uint(w, 0xffffffffffffffffULL);
+	w = mp_encode_int(w, -200);
+	w = mp_encode_double(w, 3.14);
+	w = mp_encode_float(w, 1.5f);
+	w = mp_encode_nil(w);
+	w = mp_encode_bool(w, true);
+	w = mp_encode_bool(w, false);
+	w = mp_encode_str(w, "short", 5);
+	w = mp_encode_str(w, long_str, sizeof(long_str));
+	is(check(w), 0, "array of mixed scalars");
+
+	/* A DML-like body: a map of keys to scalars and tuples. */
+	w = buf;
+	w = mp_encode_map(w, 2);
+	w = mp_encode_uint(w, 16);
+	w = mp_encode_uint(w, 512);
+	w = mp_encode_uint(w, 33);
+	w = mp_encode_array(w, 3);
+	w = mp_encode_uint(w, 1);
+	w = mp_encode_str(w, "abc", 3);
+	w = mp_encode_uint(w, 100000);
+	is(check(w), 0, "map body with a tuple");
+
+	/* Deep nesting is handed over to mp_check(). */
+	w = buf;
+	for (int i = 0; i < 5; i++)
+		w = mp_encode_array(w, 1);
+	w = mp_encode_uint(w, 7);
+	is(check(w), 0, "deeply nested array");
+
+	/* So are scalar top level objects. */
+	w = buf;
+	w = mp_encode_uint(w, 100500);
+	is(check(w), 0, "scalar top level object");
+
+	/* Five elements declared, three present. */
+	w = buf;
+	w = mp_encode_array(w, 5);
+	for (int i = 0; i < 3; i++)
+		w = mp_encode_uint(w, i);
+	isnt(check(w), 0, "truncated array");
+
+	/* A string payload which does not fit into the buffer. */
+	w = buf;
+	w = mp_encode_array(w, 1);
+	w = mp_encode_str(w, long_str, sizeof(long_str));
+	isnt(check(w - 10), 0, "truncated string");
+
+	w = buf;
+	w = mp_encode_array(w, 1);
+	*w++ = (char) 0xc1;
+	isnt(check(w), 0, "invalid type byte");
+
+	w = buf;
+	for (int i = 0; i < 40; i++)
+		w = mp_encode_uint(w, i);
+	ok(next_flat_matches(w, 40), "next over a fixint run");
+
+	w = buf;
+	w = mp_encode_uint(w, 100500);
+	w = mp_encode_int(w, -100500);
+	w = mp_encode_str(w, long_str, sizeof(long_str));
+	w = mp_encode_double(w, 3.14);
+	w = mp_encode_map(w, 2);
+	w = mp_encode_str(w, "k", 1);
+	w = mp_encode_array(w, 3);
+	for (int i = 0; i < 3; i++)
+		w = mp_encode_uint(w, i);
+	w = mp_encode_str(w, "kk", 2);
+	w = mp_encode_nil(w);
+	w = mp_encode_bool(w, true);
+	ok(next_flat_matches(w, 6), "next over mixed objects");
+
+	ok(next_flat_matches(buf, 0), "next over nothing");
+
+	int rc = check_plan();
+	footer();
+	return rc;
+}
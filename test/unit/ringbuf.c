@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unit.h"
+#include "core/ringbuf.h"
+
+static void
+mirror_check(void)
+{
+	header();
+	struct ringbuf rb;
+	fail_if(ringbuf_create(&rb, 1) != 0);
+	/* Capacity is page-granular. */
+	fail_if(rb.capacity < 4096);
+	fail_if(ringbuf_used(&rb) != 0);
+	fail_if(ringbuf_unused(&rb) != rb.capacity);
+	/* A byte is visible at the same offset in both halves. */
+	rb.buf[0] = 42;
+	fail_if(rb.buf[rb.capacity] != 42);
+	rb.buf[rb.capacity + 1] = 43;
+	fail_if(rb.buf[1] != 43);
+	ringbuf_destroy(&rb);
+	footer();
+}
+
+static void
+wrap_check(void)
+{
+	header();
+	struct ringbuf rb;
+	fail_if(ringbuf_create(&rb, 4096) != 0);
+	size_t cap = rb.capacity;
+	/*
+	 * Move a 100-byte window far enough to wrap the capacity
+	 * boundary many times; the window must stay contiguous
+	 * and intact at every step.
+	 */
+	unsigned char seq = 0;
+	size_t chunk = 100;
+	for (size_t step = 0; step < 100 * cap / chunk; step++) {
+		fail_if(ringbuf_unused(&rb) < chunk);
+		unsigned char *w = (unsigned char *)ringbuf_wpos(&rb);
+		for (size_t i = 0; i < chunk; i++)
+			w[i] = seq + i;
+		ringbuf_produce(&rb, chunk);
+		fail_if(ringbuf_used(&rb) != chunk);
+		unsigned char *r = (unsigned char *)ringbuf_rpos(&rb);
+		for (size_t i = 0; i < chunk; i++)
+			fail_if(r[i] != (unsigned char)(seq + i));
+		ringbuf_consume(&rb, chunk);
+		seq += chunk;
+	}
+	fail_if(ringbuf_used(&rb) != 0);
+	ringbuf_destroy(&rb);
+	footer();
+}
+
+static void
+full_check(void)
+{
+	header();
+	struct ringbuf rb;
+	fail_if(ringbuf_create(&rb, 4096) != 0);
+	size_t cap = rb.capacity;
+	/* Shift the window so the full buffer spans the seam. */
+	ringbuf_produce(&rb, cap / 2 + 123);
+	ringbuf_consume(&rb, cap / 2 + 123);
+	char *w = ringbuf_wpos(&rb);
+	for (size_t i = 0; i < cap; i++)
+		w[i] = (char)(i * 31);
+	ringbuf_produce(&rb, cap);
+	fail_if(ringbuf_unused(&rb) != 0);
+	char *r = ringbuf_rpos(&rb);
+	for (size_t i = 0; i < cap; i++)
+		fail_if(r[i] != (char)(i * 31));
+	/* Partial consume opens exactly that much space. */
+	ringbuf_consume(&rb, 1000);
+	fail_if(ringbuf_unused(&rb) != 1000);
+	fail_if(ringbuf_used(&rb) != cap - 1000);
+	r = ringbuf_rpos(&rb);
+	for (size_t i = 0; i < cap - 1000; i++)
+		fail_if(r[i] != (char)((i + 1000) * 31));
+	ringbuf_reset(&rb);
+	fail_if(ringbuf_used(&rb) != 0);
+	ringbuf_destroy(&rb);
+	footer();
+}
+
+int
+main(void)
+{
+	mirror_check();
+	wrap_check();
+	full_check();
+}
@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "unit.h"
+#include "salad/routing_table.h"
+
+static uint64_t
+key_hash(uint64_t i)
+{
+	return i * 2654435761ULL + 12345;
+}
+
+static void
+distribution_check(void)
+{
+	header();
+	uint32_t weights[] = {1, 2, 3, 4};
+	struct routing_table table;
+	fail_if(routing_table_create(&table, weights, 4) != 0);
+	fail_if(table.slot_count != 10);
+	fail_if(table.generation != 0);
+	uint64_t per_backend[4] = {0, 0, 0, 0};
+	const uint64_t keys = 100000;
+	for (uint64_t i = 0; i < keys; i++) {
+		uint32_t backend = routing_table_route(&table, key_hash(i));
+		fail_if(backend >= 4);
+		per_backend[backend]++;
+	}
+	/*
+	 * Each backend must get a share of keys roughly
+	 * proportional to its weight.
+	 */
+	for (uint32_t b = 0; b < 4; b++) {
+		double share = (double)per_backend[b] / keys;
+		double expect = (double)weights[b] / table.slot_count;
+		fail_if(share < expect * 0.8 || share > expect * 1.2);
+	}
+	routing_table_destroy(&table);
+	footer();
+}
+
+static void
+rebalance_add_check(void)
+{
+	header();
+	uint32_t weights[] = {10, 10, 10};
+	struct routing_table table;
+	fail_if(routing_table_create(&table, weights, 3) != 0);
+	const uint64_t keys = 100000;
+	uint32_t *before = malloc(keys * sizeof(*before));
+	fail_if(before == NULL);
+	for (uint64_t i = 0; i < keys; i++)
+		before[i] = routing_table_route(&table, key_hash(i));
+	/* Add a backend of the same weight. */
+	uint32_t new_weights[] = {10, 10, 10, 10};
+	int64_t moved = routing_table_rebalance(&table, new_weights, 4);
+	/* Old slots keep their backend, only the new ones move. */
+	fail_if(moved != 10);
+	fail_if(table.generation != 1);
+	uint64_t changed = 0;
+	for (uint64_t i = 0; i < keys; i++) {
+		uint32_t backend = routing_table_route(&table, key_hash(i));
+		if (backend == before[i])
+			continue;
+		/* A moved key may only land on the new backend. */
+		fail_if(backend != 3);
+		changed++;
+	}
+	/*
+	 * The moved share must be close to the minimal 1/4 and
+	 * nowhere near a full reshuffle.
+	 */
+	fail_if(changed < keys / 5 || changed > keys / 3);
+	free(before);
+	routing_table_destroy(&table);
+	footer();
+}
+
+static void
+rebalance_drain_check(void)
+{
+	header();
+	uint32_t weights[] = {10, 10, 10};
+	struct routing_table table;
+	fail_if(routing_table_create(&table, weights, 3) != 0);
+	const uint64_t keys = 100000;
+	uint32_t *before = malloc(keys * sizeof(*before));
+	fail_if(before == NULL);
+	for (uint64_t i = 0; i < keys; i++)
+		before[i] = routing_table_route(&table, key_hash(i));
+	/* Drain the middle backend. */
+	uint32_t new_weights[] = {10, 0, 10};
+	int64_t moved = routing_table_rebalance(&table, new_weights, 3);
+	fail_if(moved < 0);
+	fail_if(table.generation != 1);
+	uint64_t changed = 0;
+	for (uint64_t i = 0; i < keys; i++) {
+		uint32_t backend = routing_table_route(&table, key_hash(i));
+		fail_if(backend == 1);
+		if (backend != before[i])
+			changed++;
+	}
+	/*
+	 * At least the drained third of the keys moves, but a key
+	 * staying on backend 0 or 2 mostly stays put.
+	 */
+	fail_if(changed < keys / 4 || changed > keys * 2 / 3);
+	free(before);
+	routing_table_destroy(&table);
+	footer();
+}
+
+static void
+sameresult_check(void)
+{
+	header();
+	uint32_t weights[] = {3, 1, 4, 1, 5};
+	struct routing_table a, b;
+	fail_if(routing_table_create(&a, weights, 5) != 0);
+	fail_if(routing_table_create(&b, weights, 5) != 0);
+	for (uint64_t i = 0; i < 10000; i++) {
+		fail_if(routing_table_route(&a, key_hash(i)) !=
+			routing_table_route(&b, key_hash(i)));
+	}
+	routing_table_destroy(&a);
+	routing_table_destroy(&b);
+	footer();
+}
+
+int
+main(void)
+{
+	distribution_check();
+	rebalance_add_check();
+	rebalance_drain_check();
+	sameresult_check();
+}
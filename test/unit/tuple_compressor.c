@@ -0,0 +1,162 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fiber.h"
+#include "memory.h"
+#include "tuple_compressor.h"
+#include "unit.h"
+
+/**
+ * A JSON-ish repetitive payload: the kind of data per-space
+ * dictionaries are meant for.
+ */
+static uint32_t
+make_payload(char *buf, uint32_t copies, uint32_t salt)
+{
+	uint32_t size = 0;
+	for (uint32_t i = 0; i < copies; i++) {
+		size += sprintf(buf + size,
+				"{\"user_id\":%u,\"status\":\"active\","
+				"\"balance\":%u,\"currency\":\"USD\"}",
+				salt + i, salt * 31 + i);
+	}
+	return size;
+}
+
+static void
+test_roundtrip(void)
+{
+	header();
+
+	struct region *region = &fiber()->gc;
+	struct tuple_compressor *compressor = tuple_compressor_new(3);
+	fail_if(compressor == NULL);
+	fail_if(tuple_compressor_is_trained(compressor));
+
+	char payload[4096];
+	uint32_t size = make_payload(payload, 16, 1);
+	uint32_t zip_size, raw_size;
+	char *zip = tuple_compressor_compress(compressor, payload, size,
+					      region, &zip_size);
+	fail_if(zip == NULL);
+	fail_if(zip_size >= size);
+	char *raw = tuple_compressor_decompress(compressor, zip, zip_size,
+						region, &raw_size);
+	fail_if(raw == NULL);
+	fail_if(raw_size != size);
+	fail_if(memcmp(raw, payload, size) != 0);
+
+	tuple_compressor_delete(compressor);
+	region_truncate(region, 0);
+
+	footer();
+}
+
+static void
+test_incompressible(void)
+{
+	header();
+
+	struct region *region = &fiber()->gc;
+	struct tuple_compressor *compressor = tuple_compressor_new(3);
+	fail_if(compressor == NULL);
+
+	char payload[256];
+	srand(42);
+	for (uint32_t i = 0; i < sizeof(payload); i++)
+		payload[i] = rand();
+	uint32_t zip_size;
+	diag_clear(diag_get());
+	char *zip = tuple_compressor_compress(compressor, payload,
+					      sizeof(payload), region,
+					      &zip_size);
+	/* Not an error, the caller should store the original. */
+	fail_if(zip != NULL);
+	fail_if(zip_size != 0);
+	fail_if(!diag_is_empty(diag_get()));
+
+	tuple_compressor_delete(compressor);
+	region_truncate(region, 0);
+
+	footer();
+}
+
+static void
+test_dictionary(void)
+{
+	header();
+
+	struct region *region = &fiber()->gc;
+	struct tuple_compressor *trained = tuple_compressor_new(3);
+	struct tuple_compressor *plain = tuple_compressor_new(3);
+	fail_if(trained == NULL || plain == NULL);
+
+	/*
+	 * A single record is too small for zstd to exploit the
+	 * cross-tuple repetition on its own.
+	 */
+	char payload[512];
+	uint32_t size = make_payload(payload, 1, 100500);
+
+	/*
+	 * An image compressed before training must stay readable
+	 * after it.
+	 */
+	uint32_t old_size;
+	char *old = tuple_compressor_compress(trained, payload, size,
+					      region, &old_size);
+	bool old_exists = old != NULL;
+
+	char sample[4096];
+	for (int i = 0; !tuple_compressor_is_trained(trained); i++) {
+		fail_if(i > 1000);
+		uint32_t sample_size = make_payload(sample, 8, i);
+		tuple_compressor_sample(trained, sample, sample_size);
+	}
+
+	uint32_t dict_size, plain_size;
+	char *dict_zip = tuple_compressor_compress(trained, payload, size,
+						   region, &dict_size);
+	char *plain_zip = tuple_compressor_compress(plain, payload, size,
+						    region, &plain_size);
+	fail_if(dict_zip == NULL);
+	/* The dictionary must beat dictionary-less compression. */
+	fail_if(plain_zip != NULL && dict_size >= plain_size);
+
+	uint32_t raw_size;
+	char *raw = tuple_compressor_decompress(trained, dict_zip, dict_size,
+						region, &raw_size);
+	fail_if(raw == NULL);
+	fail_if(raw_size != size);
+	fail_if(memcmp(raw, payload, size) != 0);
+
+	if (old_exists) {
+		raw = tuple_compressor_decompress(trained, old, old_size,
+						  region, &raw_size);
+		fail_if(raw == NULL);
+		fail_if(raw_size != size);
+		fail_if(memcmp(raw, payload, size) != 0);
+	}
+
+	tuple_compressor_delete(trained);
+	tuple_compressor_delete(plain);
+	region_truncate(region, 0);
+
+	footer();
+}
+
+int
+main(void)
+{
+	memory_init();
+	fiber_init(fiber_c_invoke);
+
+	test_roundtrip();
+	test_incompressible();
+	test_dictionary();
+
+	fiber_free();
+	memory_free();
+	return 0;
+}
@@ -109,10 +109,63 @@ mp_print_test(void)
         check_plan();
 }
 
+static void
+uuid_v7_test(void)
+{
+        plan(7);
+        header();
+
+        struct tt_uuid fixed = {.time_low = 1712399963,
+                                .time_mid = 34898,
+                                .time_hi_and_version = 18482,
+                                .clock_seq_hi_and_reserved = 175,
+                                .clock_seq_low = 139,
+                                .node = "Ad\325,b\353"};
+        char str[UUID_STR_LEN + 1];
+        tt_uuid_to_string(&fixed, str);
+        is(strcmp(str, "6611265b-8852-4832-af8b-4164d52c62eb"), 0,
+           "tt_uuid_to_string format");
+        struct tt_uuid parsed;
+        int rc = tt_uuid_from_string(str, &parsed);
+        is(rc == 0 && tt_uuid_is_equal(&fixed, &parsed), 1,
+           "tt_uuid_from_string roundtrip");
+        is(tt_uuid_from_string("6611265b-8852-4832-af8b-4164d52c62e",
+                               &parsed), 1,
+           "tt_uuid_from_string rejects a short string");
+        is(tt_uuid_from_string("6611265b-8852-4832-af8b-4164d52c62eg",
+                               &parsed), 1,
+           "tt_uuid_from_string rejects a non-hex string");
+
+        struct tt_uuid v7_first, v7_second;
+        tt_uuid_create_v7(&v7_first);
+        tt_uuid_create_v7(&v7_second);
+        is(v7_first.time_hi_and_version >> 12 == 7 &&
+           tt_uuid_validate(&v7_first) == 0, 1,
+           "uuid v7 version and variant");
+        uint64_t ms_first = (uint64_t)v7_first.time_low << 16 |
+                            v7_first.time_mid;
+        uint64_t ms_second = (uint64_t)v7_second.time_low << 16 |
+                             v7_second.time_mid;
+        ok(ms_second >= ms_first, "uuid v7 timestamps are non-decreasing");
+
+        struct tt_uuid batch[8];
+        tt_uuid_create_batch(batch, 8);
+        int bad = 0;
+        for (int i = 0; i < 8; i++) {
+                if (tt_uuid_validate(&batch[i]) != 0 ||
+                    tt_uuid_is_nil(&batch[i]))
+                        bad++;
+        }
+        is(bad, 0, "batch generation makes valid uuids");
+
+        footer();
+        check_plan();
+}
+
 int
 main(void)
 {
-        plan(4);
+        plan(5);
 
         uuid_test(
                 (struct tt_uuid){.time_low = 1712399963,
@@ -147,6 +200,7 @@ main(void)
 
         mp_uuid_test();
         mp_print_test();
+        uuid_v7_test();
 
         return check_plan();
 }
@@ -44,7 +44,12 @@ A million repetitions of "a"
 #define R4(v,w,x,y,z,i) z+=(w^x^y)+blk(i)+0xCA62C1D6+rol(v,5);w=rol(w,30);
 
 
-/* Hash a single 512-bit block. This is the core of the algorithm. */
+/* Hash a single 512-bit block. This is the core of the algorithm.
+ * Called through sha1_transform, which may be repointed to a
+ * hardware implementation at startup (see cpu_feature.h). */
+
+void (*sha1_transform)(uint32_t state[5], const unsigned char buffer[64]) =
+    SHA1Transform;
 
 void SHA1Transform(uint32_t state[5], const unsigned char buffer[64])
 {
@@ -132,9 +137,9 @@ void SHA1Update(SHA1_CTX* context, const unsigned char* data, uint32_t len)
     j = (j >> 3) & 63;
     if ((j + len) > 63) {
         memcpy(&context->buffer[j], data, (i = 64-j));
-        SHA1Transform(context->state, context->buffer);
+        sha1_transform(context->state, context->buffer);
         for ( ; i + 63 < len; i += 64) {
-            SHA1Transform(context->state, &data[i]);
+            sha1_transform(context->state, &data[i]);
         }
         j = 0;
     }
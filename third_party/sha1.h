@@ -3,6 +3,10 @@
 
 #include <stdint.h>
 
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
 /* ================ sha1.h ================ */
 /*
 SHA-1 in C
@@ -17,8 +21,17 @@ typedef struct {
 } SHA1_CTX;
 
 void SHA1Transform(uint32_t state[5], const unsigned char buffer[64]);
+/* Indirection for the block function: points at SHA1Transform by
+ * default, repointed to a hardware implementation at startup when
+ * the CPU supports one. */
+extern void (*sha1_transform)(uint32_t state[5],
+                              const unsigned char buffer[64]);
 void SHA1Init(SHA1_CTX* context);
 void SHA1Update(SHA1_CTX* context, const unsigned char* data, uint32_t len);
 void SHA1Final(unsigned char digest[20], SHA1_CTX* context);
 
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif
+
 #endif